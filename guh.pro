@@ -6,7 +6,7 @@ SUBDIRS += libguh server plugins
 
 server.depends = libguh plugins
 plugins.depends = libguh
-tests.depends = libguh
+tests.depends = libguh plugins
 
 doc.depends = libguh server
 # Note: some how extraimages in qdocconf did not the trick
@@ -18,7 +18,11 @@ licensecheck.commands = $$top_srcdir/tests/auto/checklicenseheaders.sh $$top_src
 test.depends = licensecheck
 test.commands = LD_LIBRARY_PATH=$$top_builddir/libguh:$$top_builddir/tests/libguh-core make check
 
-QMAKE_EXTRA_TARGETS += licensecheck doc test
+benchmark.commands = export LD_LIBRARY_PATH=$$top_builddir/libguh:$$top_builddir/tests/libguh-core; \
+                     $$top_builddir/tests/benchmarks/rules/benchmarkrules; \
+                     $$top_builddir/tests/benchmarks/jsonrpc/benchmarkjsonrpc
+
+QMAKE_EXTRA_TARGETS += licensecheck doc test benchmark
 
 # Inform about guh build
 message(============================================)
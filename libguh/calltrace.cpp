@@ -0,0 +1,168 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class CallTrace
+    \brief Measures the duration of a call into a component of the guh server.
+
+    \ingroup devices
+    \inmodule libguh
+
+    The guh server runs plugins, rules, the log database and the JSON-RPC handlers on one thread, so a single
+    slow call delays everything else. A CallTrace gets created on the stack around such a call and measures it
+    until it goes out of scope:
+
+    \code
+        CallTrace trace(plugin->pluginName(), "executeAction");
+        plugin->executeAction(device, action);
+    \endcode
+
+    Each call site, named "component: entry", gets its own \l{MetricHistogram} \tt guh_call_duration_microseconds.
+    Calls which take longer than the \l{slowCallThreshold()} are logged and the slowest of them are kept
+    in \l{slowestCalls()}.
+
+    The traces which are active on the main thread form the \l{context()}, which tells the \l{guhserver::StallWatchdog}{StallWatchdog}
+    who is blocking the event loop.
+*/
+
+/*!
+    \class CallTrace::Record
+    \brief Describes a single slow call or stall.
+
+    The \tt site is the innermost call site, the \tt context holds all call sites which were active at that
+    time starting with the outermost one. The \tt duration is given in milliseconds.
+*/
+
+#include "calltrace.h"
+#include "metrics.h"
+#include "loggingcategories.h"
+
+#include <QThread>
+#include <QCoreApplication>
+
+static const int s_maxSlowestCalls = 20;
+
+// the mutex guards the context of the main thread and the slowest calls
+QMutex CallTrace::s_mutex;
+QStringList CallTrace::s_context;
+QList<CallTrace::Record> CallTrace::s_slowestCalls;
+
+// every thread caches the histograms of its call sites, so a fast call takes no lock
+QThreadStorage<QHash<QString, MetricHistogram *> > CallTrace::s_histograms;
+QAtomicInt CallTrace::s_slowCallThreshold(100);
+
+/*! Constructs a CallTrace for the \a entry point of the given \a component and starts measuring. */
+CallTrace::CallTrace(const QString &component, const QString &entry) :
+    m_site(component + ": " + entry),
+    m_mainThread(isMainThread())
+{
+    if (m_mainThread) {
+        QMutexLocker locker(&s_mutex);
+        s_context.append(m_site);
+    }
+
+    m_timer.start();
+}
+
+/*! Stops measuring and records the duration of this CallTrace. */
+CallTrace::~CallTrace()
+{
+    qint64 duration = m_timer.nsecsElapsed() / 1000;
+    bool slow = duration >= (qint64)s_slowCallThreshold.load() * 1000;
+
+    QStringList context(m_site);
+    if (m_mainThread) {
+        QMutexLocker locker(&s_mutex);
+        if (slow)
+            context = s_context;
+        s_context.removeLast();
+    }
+
+    QHash<QString, MetricHistogram *> &histograms = s_histograms.localData();
+    MetricHistogram *histogram = histograms.value(m_site);
+    if (!histogram) {
+        histogram = Metrics::histogram("guh_call_duration_microseconds", "Duration of the calls into plugins, handlers and engines.", Metrics::durationBounds(), "site", m_site);
+        histograms.insert(m_site, histogram);
+    }
+    histogram->observe(duration);
+
+    if (!slow)
+        return;
+
+    Record record;
+    record.site = m_site;
+    record.context = context;
+    record.duration = duration / 1000;
+    record.timestamp = QDateTime::currentDateTime();
+
+    // keep the slowest calls sorted, the slowest one first
+    QMutexLocker locker(&s_mutex);
+    int index = 0;
+    while (index < s_slowestCalls.count() && s_slowestCalls.at(index).duration >= record.duration)
+        index++;
+
+    if (index < s_maxSlowestCalls) {
+        s_slowestCalls.insert(index, record);
+        if (s_slowestCalls.count() > s_maxSlowestCalls)
+            s_slowestCalls.removeLast();
+    }
+
+    locker.unlock();
+    qCWarning(dcWatchdog) << "Slow call:" << m_site << "took" << record.duration << "ms in" << context.join(" > ");
+}
+
+/*! Returns the call sites which are currently active on the main thread, starting with the outermost one.
+ *  This method can be called from any thread. */
+QStringList CallTrace::context()
+{
+    QMutexLocker locker(&s_mutex);
+    return s_context;
+}
+
+/*! Returns the slowest calls which took longer than the \l{slowCallThreshold()}, the slowest one first. */
+QList<CallTrace::Record> CallTrace::slowestCalls()
+{
+    QMutexLocker locker(&s_mutex);
+    return s_slowestCalls;
+}
+
+/*! Forgets the recorded \l{slowestCalls()}. */
+void CallTrace::clearSlowestCalls()
+{
+    QMutexLocker locker(&s_mutex);
+    s_slowestCalls.clear();
+}
+
+/*! Returns the duration [ms] from which on a call will be reported as slow. The default is 100 ms. */
+int CallTrace::slowCallThreshold()
+{
+    return s_slowCallThreshold.load();
+}
+
+/*! Sets the duration [ms] from which on a call will be reported as slow to the given \a threshold. */
+void CallTrace::setSlowCallThreshold(const int &threshold)
+{
+    s_slowCallThreshold.store(threshold);
+}
+
+bool CallTrace::isMainThread()
+{
+    return QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread();
+}
@@ -0,0 +1,79 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef CALLTRACE_H
+#define CALLTRACE_H
+
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QThreadStorage>
+#include <QString>
+#include <QDateTime>
+#include <QStringList>
+#include <QElapsedTimer>
+
+#include "libguh.h"
+
+class MetricHistogram;
+
+class LIBGUH_EXPORT CallTrace
+{
+public:
+    class Record
+    {
+    public:
+        Record() : duration(0) {}
+
+        QString site;
+        QStringList context;
+        qint64 duration;
+        QDateTime timestamp;
+    };
+
+    CallTrace(const QString &component, const QString &entry);
+    ~CallTrace();
+
+    static QStringList context();
+
+    static QList<Record> slowestCalls();
+    static void clearSlowestCalls();
+
+    static int slowCallThreshold();
+    static void setSlowCallThreshold(const int &threshold);
+
+private:
+    Q_DISABLE_COPY(CallTrace)
+
+    QString m_site;
+    QElapsedTimer m_timer;
+    bool m_mainThread;
+
+    static QMutex s_mutex;
+    static QStringList s_context;
+    static QList<Record> s_slowestCalls;
+    static QThreadStorage<QHash<QString, MetricHistogram *> > s_histograms;
+    static QAtomicInt s_slowCallThreshold;
+
+    static bool isMainThread();
+};
+
+#endif // CALLTRACE_H
@@ -0,0 +1,176 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class ChangeJournal
+    \brief Records a monotonic change sequence for a set of objects.
+
+    \ingroup types
+    \inmodule libguh
+
+    The ChangeJournal assigns a sequence number to every change (add, edit, state change or removal) of
+    the objects it tracks. Clients remember the \l{sequence()} of their last synchronisation and ask for the
+    changes since then instead of downloading all objects again.
+
+    The journal only keeps the latest change of each object, so frequent state changes of the same device
+    don't consume the journal. If more than \l{capacity()} objects changed, the oldest entries will be
+    dropped and \l{changesSince()} reports a gap for the sequences before them. The client has to fetch
+    the complete set again in that case.
+
+    Each journal gets a random instance id, which makes up the upper bits of every sequence it hands
+    out. A sequence of another journal, for example from before a restart of the server or from the
+    journal of a different set of objects, never matches the instance and requires a complete
+    synchronisation. The sequences stay below 2^53, so they can be passed as JSON numbers.
+
+    \sa DeviceManager::changeJournal()
+*/
+
+/*! \enum ChangeJournal::ChangeType
+
+    This enum type specifies the type of a change.
+
+    \value ChangeTypeAdded
+        The object was added.
+    \value ChangeTypeChanged
+        The object or one of its states changed.
+    \value ChangeTypeRemoved
+        The object was removed.
+*/
+
+/*! \class ChangeJournal::Change
+    \brief Holds the \l{ChangeJournal::ChangeType}{type} and the sequence of the latest change of an object.
+*/
+
+#include "changejournal.h"
+
+#include <QSet>
+#include <QMutex>
+
+// 20 bits of instance id and 32 bits of counter fit into the 53 bit mantissa of a JSON number
+static const int s_counterBits = 32;
+static const qint64 s_instanceMask = 0xfffff;
+
+/*! Constructs a ChangeJournal which keeps the changes of up to \a capacity objects. */
+ChangeJournal::ChangeJournal(const int &capacity) :
+    m_capacity(capacity),
+    m_instance(0)
+{
+    startInstance();
+}
+
+/*! Returns the maximal number of objects this journal keeps changes for. */
+int ChangeJournal::capacity() const
+{
+    return m_capacity;
+}
+
+/*! Returns the number of objects with a recorded change. */
+int ChangeJournal::count() const
+{
+    return m_changes.count();
+}
+
+/*! Returns the sequence of the latest change. */
+qint64 ChangeJournal::sequence() const
+{
+    return m_sequence;
+}
+
+/*! Returns the first sequence from which on the journal is complete. */
+qint64 ChangeJournal::firstSequence() const
+{
+    return m_firstSequence;
+}
+
+/*! Records a change of the given \a type for the object with the given \a id and returns the new sequence. */
+qint64 ChangeJournal::record(const QUuid &id, const ChangeJournal::ChangeType &type)
+{
+    // the counter would run into the instance bits, the clients have to start over with a new instance
+    if (((m_sequence + 1) >> s_counterBits) != m_instance)
+        startInstance();
+
+    m_sequence++;
+
+    // only the latest change of an object is relevant
+    QHash<QUuid, qint64>::iterator latest = m_latestChanges.find(id);
+    if (latest != m_latestChanges.end()) {
+        m_changes.remove(latest.value());
+        latest.value() = m_sequence;
+    } else {
+        m_latestChanges.insert(id, m_sequence);
+    }
+
+    Change change;
+    change.sequence = m_sequence;
+    change.id = id;
+    change.type = type;
+    m_changes.insert(m_sequence, change);
+
+    while (m_changes.count() > m_capacity) {
+        QMap<qint64, Change>::iterator oldest = m_changes.begin();
+        m_firstSequence = oldest.key();
+        m_latestChanges.remove(oldest.value().id);
+        m_changes.erase(oldest);
+    }
+
+    return m_sequence;
+}
+
+/*! Appends the latest change of every object which changed after the given \a sequence to \a changes,
+ *  ordered by their sequence. Returns false if the journal does not reach back to the given \a sequence,
+ *  the \a sequence is unknown or it has been handed out by another journal instance. In that case the client
+ *  has to fetch the complete set of objects.
+ */
+bool ChangeJournal::changesSince(const qint64 &sequence, QList<ChangeJournal::Change> *changes) const
+{
+    // a sequence of another journal instance
+    if ((sequence >> s_counterBits) != m_instance)
+        return false;
+
+    if (sequence < m_firstSequence || sequence > m_sequence)
+        return false;
+
+    QMap<qint64, Change>::const_iterator i;
+    for (i = m_changes.upperBound(sequence); i != m_changes.constEnd(); ++i)
+        changes->append(i.value());
+
+    return true;
+}
+
+void ChangeJournal::startInstance()
+{
+    // journals of the same process must never share an instance
+    static QMutex mutex;
+    static QSet<qint64> instances;
+    QMutexLocker locker(&mutex);
+
+    qint64 instance = 0;
+    while (instance == 0 || instance == m_instance || instances.contains(instance))
+        instance = QUuid::createUuid().data1 & s_instanceMask;
+
+    instances.remove(m_instance);
+    instances.insert(instance);
+    m_instance = instance;
+
+    m_sequence = m_instance << s_counterBits;
+    m_firstSequence = m_sequence;
+    m_changes.clear();
+    m_latestChanges.clear();
+}
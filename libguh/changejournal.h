@@ -0,0 +1,73 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef CHANGEJOURNAL_H
+#define CHANGEJOURNAL_H
+
+#include <QMap>
+#include <QHash>
+#include <QList>
+#include <QUuid>
+
+#include "libguh.h"
+
+class LIBGUH_EXPORT ChangeJournal
+{
+public:
+    enum ChangeType {
+        ChangeTypeAdded,
+        ChangeTypeChanged,
+        ChangeTypeRemoved
+    };
+
+    class Change
+    {
+    public:
+        Change() : sequence(0), type(ChangeTypeChanged) {}
+
+        qint64 sequence;
+        QUuid id;
+        ChangeType type;
+    };
+
+    explicit ChangeJournal(const int &capacity = 1024);
+
+    int capacity() const;
+    int count() const;
+
+    qint64 sequence() const;
+    qint64 firstSequence() const;
+
+    qint64 record(const QUuid &id, const ChangeType &type);
+    bool changesSince(const qint64 &sequence, QList<Change> *changes) const;
+
+private:
+    int m_capacity;
+    qint64 m_instance;
+    qint64 m_sequence;
+    qint64 m_firstSequence;
+
+    QMap<qint64, Change> m_changes;
+    QHash<QUuid, qint64> m_latestChanges;
+
+    void startInstance();
+};
+
+#endif // CHANGEJOURNAL_H
@@ -68,11 +68,21 @@
 /*! \fn void Coap::notificationReceived(const CoapObserveResource &resource, const int &notificationNumber, const QByteArray &payload);
     This signal is emitted when a value of an observed \a resource changed. The \a notificationNumber specifies the the count of the notification
     to keep the correct order. The value can be parsed from the \a payload.
+
+    The response to a (re-)registration of an observation counts as notification as well, so every received
+    notification also tells that the server of the \a resource is still alive.
+*/
+
+/*! \fn void Coap::observationLost(const CoapObserveResource &resource);
+    This signal is emitted when the server of the observed \a resource did not send a notification within
+    the max age of the last one and could not be reached for registering the observation again. The
+    observation stays registered and will be tried again after the next max age.
 */
 
 #include "coap.h"
 #include "coappdu.h"
 #include "coapoption.h"
+#include "metrics.h"
 
 Q_LOGGING_CATEGORY(dcCoap, "Coap")
 
@@ -83,6 +93,11 @@ Coap::Coap(QObject *parent, const quint16 &port) :
 {
     m_socket = new QUdpSocket(this);
 
+    // Check the age of the observed resources
+    m_observeTimer = new QTimer(this);
+    m_observeTimer->setInterval(5000);
+    connect(m_observeTimer, &QTimer::timeout, this, &Coap::onObserveTimeout);
+
     if (!m_socket->bind(QHostAddress::Any, port, QAbstractSocket::ShareAddress))
         qCWarning(dcCoap) << "Could not bind to port" << port << m_socket->errorString();
 
@@ -306,21 +321,34 @@ void Coap::sendRequest(CoapReply *reply, const bool &lookedUp)
         pdu.addOption(CoapOption::UriHost, reply->request().url().host().toUtf8());
 
     if (reply->observation() && reply->requestMethod() == CoapPdu::Get) {
+        QString url = reply->request().url().toString();
         if (reply->observationEnable()) {
+            // an already observed resource gets registered again with the same token
+            if (m_observeTokens.contains(url)) {
+                pdu.setToken(m_observeTokens.value(url));
+            } else {
+                m_observeTokens.insert(url, pdu.token());
+                m_observeResources.insert(pdu.token(), CoapObserveResource(reply->request().url(), pdu.token()));
+            }
+
             // Option number 6
             pdu.addOption(CoapOption::Observe, 0);
-            m_observeResources.insert(pdu.token(), CoapObserveResource(reply->request().url(), pdu.token()));
+
+            if (!m_observeTimer->isActive())
+                m_observeTimer->start();
+
         } else {
-            // if disable, we should use the sam token as the notifications
-            foreach (const CoapObserveResource &resource, m_observeResources.values()) {
-                if (resource.url() == reply->request().url()) {
-                    pdu.setToken(resource.token());
-                }
+            // if disable, we should use the same token as the notifications
+            if (m_observeTokens.contains(url)) {
+                pdu.setToken(m_observeTokens.take(url));
+                m_observeResources.remove(pdu.token());
             }
+
             // Option number 6
             pdu.addOption(CoapOption::Observe, QByteArray::number(1));
-            if (m_observeResources.contains(pdu.token()))
-                m_observeResources.remove(pdu.token());
+
+            if (m_observeResources.isEmpty())
+                m_observeTimer->stop();
         }
     }
 
@@ -416,11 +444,15 @@ void Coap::processResponse(const CoapPdu &pdu, const QHostAddress &address, cons
     }
 
     // check if this is a notification
-    if (m_observeResources.keys().contains(pdu.token())) {
+    if (m_observeResources.contains(pdu.token())) {
         processNotification(pdu, address, port);
         return;
     }
 
+    // ACK and RST messages must not be rejected
+    if (pdu.messageType() == CoapPdu::Acknowledgement || pdu.messageType() == CoapPdu::Reset)
+        return;
+
     qCDebug(dcCoap) << "Got message without request or registered observe resource." << endl << "<---" << pdu;
     CoapPdu responsePdu;
     responsePdu.setMessageType(CoapPdu::Reset);
@@ -451,6 +483,9 @@ void Coap::processIdBasedResponse(CoapReply *reply, const CoapPdu &pdu)
     }
 
     // Piggybacked response
+    if (reply->observation() && reply->observationEnable())
+        updateObserveResource(pdu, true);
+
     reply->setStatusCode(pdu.statusCode());
     reply->setContentType(pdu.contentType());
     reply->appendPayloadData(pdu.payload());
@@ -466,6 +501,9 @@ void Coap::processTokenBasedResponse(CoapReply *reply, const CoapPdu &pdu)
     responsePdu.setMessageId(pdu.messageId());
     sendCoapPdu(reply->hostAddress(), reply->port(), responsePdu);
 
+    if (reply->observation() && reply->observationEnable())
+        updateObserveResource(pdu, true);
+
     reply->setStatusCode(pdu.statusCode());
     reply->setContentType(pdu.contentType());
     reply->appendPayloadData(pdu.payload());
@@ -474,26 +512,32 @@ void Coap::processTokenBasedResponse(CoapReply *reply, const CoapPdu &pdu)
 
 void Coap::processNotification(const CoapPdu &pdu, const QHostAddress &address, const quint16 &port)
 {
-    CoapObserveResource resource = m_observeResources.value(pdu.token());
     qCDebug(dcCoap) << "<--- Notification" << endl << pdu;
 
+    // confirmable notifications have to be acknowledged, even if they are outdated
+    if (pdu.messageType() == CoapPdu::Confirmable) {
+        CoapPdu responsePdu;
+        responsePdu.setMessageType(CoapPdu::Acknowledgement);
+        responsePdu.setStatusCode(CoapPdu::Empty);
+        responsePdu.setMessageId(pdu.messageId());
+
+        qCDebug(dcCoap) << "---> Notification" << endl << responsePdu;
+        sendCoapPdu(address, port, responsePdu);
+    }
+
+    if (!updateObserveResource(pdu)) {
+        qCDebug(dcCoap) << "Dropping outdated notification";
+        return;
+    }
+
+    CoapObserveResource resource = m_observeResources.value(pdu.token());
+
     // check if it is a blockwise notification
     if (pdu.hasOption(CoapOption::Block2)) {
         if (!m_observeReplyResource.values().contains(resource)) {
 
             qCDebug(dcCoap) << "Got first part of blocked notification";
 
-            // First part of the blocked notification
-            // respond with ACK
-            CoapPdu responsePdu;
-            responsePdu.setMessageType(CoapPdu::Acknowledgement);
-            responsePdu.setStatusCode(CoapPdu::Empty);
-            responsePdu.setMessageId(pdu.messageId());
-            responsePdu.setToken(pdu.token());
-
-            qCDebug(dcCoap) << "---> Notification" << endl << responsePdu;
-            sendCoapPdu(address, port, responsePdu);
-
             // create reply for blockwise transfere
             if (!m_observerReply.isNull()) {
                 m_observeBlockwise.remove(m_observerReply);
@@ -505,15 +549,8 @@ void Coap::processNotification(const CoapPdu &pdu, const QHostAddress &address,
             m_observerReply->appendPayloadData(pdu.payload());
 
             // Lets store the observation number
-            int notificationNumber = 0;
-            foreach (const CoapOption &option, pdu.options()) {
-                if (option.option() == CoapOption::Observe) {
-                    notificationNumber = option.data().toHex().toInt(0, 16);
-                }
-            }
-
             m_observeReplyResource.insert(m_observerReply, resource);
-            m_observeBlockwise.insert(m_observerReply, notificationNumber);
+            m_observeBlockwise.insert(m_observerReply, resource.notificationNumber());
 
             connect(m_observerReply.data(), &CoapReply::timeout, this, &Coap::onReplyTimeout);
             connect(m_observerReply.data(), &CoapReply::finished, this, &Coap::onReplyFinished);
@@ -555,24 +592,70 @@ void Coap::processNotification(const CoapPdu &pdu, const QHostAddress &address,
         }
     }
 
-    // respond with ACK
-    CoapPdu responsePdu;
-    responsePdu.setMessageType(CoapPdu::Acknowledgement);
-    responsePdu.setStatusCode(CoapPdu::Empty);
-    responsePdu.setMessageId(pdu.messageId());
-    responsePdu.setToken(pdu.token());
+    emit notificationReceived(resource, resource.notificationNumber(), pdu.payload());
+}
 
-    qCDebug(dcCoap) << "---> Notification" << endl << responsePdu;
-    sendCoapPdu(address, port, responsePdu);
+bool Coap::updateObserveResource(const CoapPdu &pdu, const bool &registration)
+{
+    if (!m_observeResources.contains(pdu.token()))
+        return false;
+
+    CoapObserveResource &resource = m_observeResources[pdu.token()];
+    QDateTime now = QDateTime::currentDateTimeUtc();
 
-    int notificationNumber = 0;
+    int notificationNumber = -1;
+    int maxAge = 60;
     foreach (const CoapOption &option, pdu.options()) {
         if (option.option() == CoapOption::Observe) {
             notificationNumber = option.data().toHex().toInt(0, 16);
+        } else if (option.option() == CoapOption::MaxAge) {
+            maxAge = option.data().isEmpty() ? 0 : option.data().toHex().toInt(0, 16);
         }
     }
 
-    emit notificationReceived(resource, notificationNumber, pdu.payload());
+    // Reordering (RFC 7641, section 3.4): the 24 bit sequence number has to be newer than the last one,
+    // unless the last notification is older than 128 seconds or this is the response of a registration
+    if (!registration && notificationNumber >= 0 && resource.m_notificationNumber >= 0 && resource.m_lastNotification.secsTo(now) <= 128) {
+        int last = resource.m_notificationNumber;
+        bool newer = (last < notificationNumber && notificationNumber - last < (1 << 23)) || (last > notificationNumber && last - notificationNumber > (1 << 23));
+        if (!newer)
+            return false;
+    }
+
+    if (notificationNumber >= 0)
+        resource.m_notificationNumber = notificationNumber;
+
+    resource.m_maxAge = maxAge;
+    resource.m_lastNotification = now;
+    return true;
+}
+
+void Coap::registerObservation(const QByteArray &token)
+{
+    CoapObserveResource resource = m_observeResources.value(token);
+    qCDebug(dcCoap) << "Register observation of" << resource.url().toString() << "again";
+
+    CoapReply *reply = new CoapReply(CoapRequest(resource.url()), this);
+    reply->setRequestMethod(CoapPdu::Get);
+    reply->setObservation(true);
+    reply->setObservationEnable(true);
+
+    connect(reply, &CoapReply::timeout, this, &Coap::onReplyTimeout);
+    connect(reply, &CoapReply::finished, this, &Coap::onReplyFinished);
+
+    m_observeRegistrations.insert(reply, token);
+    enqueueReply(reply);
+}
+
+void Coap::enqueueReply(CoapReply *reply)
+{
+    // check if there is a request running
+    if (m_reply.isNull()) {
+        m_reply = reply;
+        lookupHost();
+    } else {
+        m_replyQueue.enqueue(reply);
+    }
 }
 
 void Coap::processBlock1Response(CoapReply *reply, const CoapPdu &pdu)
@@ -704,14 +787,15 @@ void Coap::processBlock2Notification(CoapReply *reply, const CoapPdu &pdu)
     // check if this was the last block
     if (!pdu.block().moreFlag()) {
         // respond with ACK
-        CoapPdu responsePdu;
-        responsePdu.setMessageType(CoapPdu::Acknowledgement);
-        responsePdu.setStatusCode(CoapPdu::Empty);
-        responsePdu.setMessageId(pdu.messageId());
-        responsePdu.setToken(pdu.token());
+        if (pdu.messageType() == CoapPdu::Confirmable) {
+            CoapPdu responsePdu;
+            responsePdu.setMessageType(CoapPdu::Acknowledgement);
+            responsePdu.setStatusCode(CoapPdu::Empty);
+            responsePdu.setMessageId(pdu.messageId());
 
-        qCDebug(dcCoap) << "---> Notification" << endl << responsePdu;
-        sendCoapPdu(reply->hostAddress(), reply->port(), responsePdu);
+            qCDebug(dcCoap) << "---> Notification" << endl << responsePdu;
+            sendCoapPdu(reply->hostAddress(), reply->port(), responsePdu);
+        }
 
         reply->appendPayloadData(pdu.payload());
 
@@ -805,11 +889,19 @@ void Coap::onReadyRead()
 
 void Coap::onReplyTimeout()
 {
+    static MetricCounter *retransmissionMetric = Metrics::counter("guh_coap_retransmissions_total", "CoAP requests which have been resent after a reply timeout.");
+
     CoapReply *reply = qobject_cast<CoapReply *>(sender());
     if (reply->m_retransmissions < 5) {
         qCDebug(dcCoap) << QString("Reply timeout: resending message %1/4").arg(reply->m_retransmissions);
+        retransmissionMetric->increment();
     }
+
+    // the last timeout finishes the reply with a TimeoutError, nothing gets resent any more
     reply->resend();
+    if (reply->isFinished())
+        return;
+
     m_socket->writeDatagram(reply->requestData(), reply->hostAddress(), reply->port());
 }
 
@@ -828,7 +920,24 @@ void Coap::onReplyFinished()
     if (reply != m_reply)
         qCWarning(dcCoap) << "This should never happen!! Please report a bug if you get this message!";
 
-    emit replyFinished(reply);
+    if (m_observeRegistrations.contains(reply)) {
+        // internal re-registration of an observed resource
+        QByteArray token = m_observeRegistrations.take(reply);
+        if (m_observeResources.contains(token)) {
+            CoapObserveResource &resource = m_observeResources[token];
+            if (reply->error() != CoapReply::NoError || reply->statusCode() != CoapPdu::Content) {
+                qCWarning(dcCoap) << "Could not register observation of" << resource.url().toString() << "again:" << reply->errorString();
+                // try again after the next max age
+                resource.m_lastNotification = QDateTime::currentDateTimeUtc();
+                emit observationLost(resource);
+            } else {
+                emit notificationReceived(resource, resource.notificationNumber(), reply->payload());
+            }
+        }
+        reply->deleteLater();
+    } else {
+        emit replyFinished(reply);
+    }
     m_reply.clear();
 
     // check if there is a request in the queue
@@ -838,3 +947,18 @@ void Coap::onReplyFinished()
             lookupHost();
     }
 }
+
+void Coap::onObserveTimeout()
+{
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    QList<QByteArray> pendingTokens = m_observeRegistrations.values();
+
+    // register observations again, which did not get a fresh representation within the max age
+    foreach (const CoapObserveResource &resource, m_observeResources) {
+        if (pendingTokens.contains(resource.token()))
+            continue;
+
+        if (resource.lastNotification().secsTo(now) > resource.maxAge())
+            registerObservation(resource.token());
+    }
+}
@@ -28,6 +28,7 @@
 #include <QLoggingCategory>
 #include <QPointer>
 #include <QQueue>
+#include <QTimer>
 
 #include "libguh.h"
 #include "coaprequest.h"
@@ -72,6 +73,9 @@ private:
     QHash<int, CoapReply *> m_runningHostLookups;
 
     QHash<QByteArray, CoapObserveResource> m_observeResources;          // token | resource
+    QHash<QString, QByteArray> m_observeTokens;                         // url | token
+    QHash<CoapReply *, QByteArray> m_observeRegistrations;              // re-registration reply | token
+    QTimer *m_observeTimer;
 
     // Blockwise notifications
     QPointer<CoapReply> m_observerReply;
@@ -88,6 +92,9 @@ private:
     void processTokenBasedResponse(CoapReply *reply, const CoapPdu &pdu);
 
     void processNotification(const CoapPdu &pdu, const QHostAddress &address, const quint16 &port);
+    bool updateObserveResource(const CoapPdu &pdu, const bool &registration = false);
+    void registerObservation(const QByteArray &token);
+    void enqueueReply(CoapReply *reply);
 
     void processBlock1Response(CoapReply *reply, const CoapPdu &pdu);
     void processBlock2Response(CoapReply *reply, const CoapPdu &pdu);
@@ -97,12 +104,14 @@ private:
 signals:
     void replyFinished(CoapReply *reply);
     void notificationReceived(const CoapObserveResource &resource, const int &notificationNumber, const QByteArray &payload);
+    void observationLost(const CoapObserveResource &resource);
 
 private slots:
     void hostLookupFinished(const QHostInfo &hostInfo);
     void onReadyRead();
     void onReplyTimeout();
     void onReplyFinished();
+    void onObserveTimeout();
 
 };
 
@@ -25,7 +25,10 @@
     \ingroup coap
     \inmodule libguh
 
-    The CoapObserveResource class holds information about an observed resource.
+    The CoapObserveResource class holds information about an observed resource. Besides the \l{url()} and
+    the \l{token()} of the observation, it remembers the number and the time of the last received notification
+    and the \l{maxAge()} the server announced for the last representation. The \l{Coap} registers the
+    observation again as soon as the representation is older than its max age.
 
     \sa Coap::notificationReceived()
 
@@ -34,14 +37,19 @@
 #include "coapobserveresource.h"
 
 /*! Constructs a CoapObserveResource. */
-CoapObserveResource::CoapObserveResource()
+CoapObserveResource::CoapObserveResource() :
+    m_notificationNumber(-1),
+    m_maxAge(60)
 {
 }
 
 /*! Constructs a CoapObserveResource with the given \a url and \a token. */
 CoapObserveResource::CoapObserveResource(const QUrl &url, const QByteArray &token):
     m_url(url),
-    m_token(token)
+    m_token(token),
+    m_notificationNumber(-1),
+    m_maxAge(60),
+    m_lastNotification(QDateTime::currentDateTimeUtc())
 {
 }
 
@@ -50,6 +58,9 @@ CoapObserveResource::CoapObserveResource(const CoapObserveResource &other)
 {
     m_url = other.url();
     m_token = other.token();
+    m_notificationNumber = other.notificationNumber();
+    m_maxAge = other.maxAge();
+    m_lastNotification = other.lastNotification();
 }
 
 /*! Returns the url of this \l{CoapObserveResource}. */
@@ -63,3 +74,21 @@ QByteArray CoapObserveResource::token() const
 {
     return m_token;
 }
+
+/*! Returns the number of the last notification of this \l{CoapObserveResource}, or -1 if there was none yet. */
+int CoapObserveResource::notificationNumber() const
+{
+    return m_notificationNumber;
+}
+
+/*! Returns the max age [s] of the last notification of this \l{CoapObserveResource}. The default is 60 seconds. */
+int CoapObserveResource::maxAge() const
+{
+    return m_maxAge;
+}
+
+/*! Returns the time of the last notification (or registration) of this \l{CoapObserveResource}. */
+QDateTime CoapObserveResource::lastNotification() const
+{
+    return m_lastNotification;
+}
@@ -24,6 +24,7 @@
 #include <QObject>
 #include <QHash>
 #include <QUrl>
+#include <QDateTime>
 
 #include "libguh.h"
 
@@ -37,10 +38,20 @@ public:
     QUrl url() const;
     QByteArray token() const;
 
+    int notificationNumber() const;
+    int maxAge() const;
+    QDateTime lastNotification() const;
+
 private:
+    friend class Coap;
+
     QUrl m_url;
     QByteArray m_token;
 
+    int m_notificationNumber;
+    int m_maxAge;
+    QDateTime m_lastNotification;
+
 };
 
 inline bool operator==(const CoapObserveResource &r1, const CoapObserveResource &r2)
@@ -30,6 +30,13 @@
 
     It is also responsible for loading Plugins and managing common hardware resources between
     \l{DevicePlugin}{device plugins}.
+
+    Plugins which declare a \tt workerThread in their metadata run on a \l{PluginThread}. The DeviceManager
+    itself and the hardware resources stay on the main thread. Calls into such a plugin get posted to its thread
+    and return \l{DeviceManager::DeviceErrorAsync}{DeviceErrorAsync} or
+    \l{DeviceManager::DeviceSetupStatusAsync}{DeviceSetupStatusAsync}, the results arrive with the signals of the plugin.
+    The lists of configured devices and device classes can be read from any thread. Worker threads can be disabled
+    with the setting \tt workerThreads in the \tt Plugins group of the global settings.
 */
 
 /*! \enum DeviceManager::HardwareResource
@@ -178,11 +185,17 @@
 #include "loggingcategories.h"
 
 #include "hardware/radio433/radio433.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
 
 #include "plugin/devicepairinginfo.h"
 #include "plugin/deviceplugin.h"
+#include "plugin/pluginthread.h"
 #include "typeutils.h"
 #include "guhsettings.h"
+#include "startupprofiler.h"
+#include "metrics.h"
+#include "calltrace.h"
 
 #include <QPluginLoader>
 #include <QStaticPlugin>
@@ -192,27 +205,72 @@
 #include <QCoreApplication>
 #include <QStandardPaths>
 #include <QDir>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+// Represents a plugin by its metadata until the library gets loaded on first use
+class InactivePlugin : public DevicePlugin
+{
+public:
+    DeviceManager::HardwareResources requiredHardware() const override { return DeviceManager::HardwareResourceNone; }
+};
 
 /*! Constructs the DeviceManager with the given \a locale and \a parent. There should only be one DeviceManager in the system created by \l{guhserver::GuhCore}.
  *  Use \c guhserver::GuhCore::instance()->deviceManager() instead to access the DeviceManager. */
 DeviceManager::DeviceManager(const QLocale &locale, QObject *parent) :
     QObject(parent),
     m_locale(locale),
+    m_catalogVersion(0),
+    m_mailbox(new PluginMailbox(this)),
     m_radio433(0)
 {
     qRegisterMetaType<DeviceClassId>();
     qRegisterMetaType<DeviceDescriptor>();
+    qRegisterMetaType<DeviceManager::DeviceSetupStatus>();
 
     m_pluginTimer.setInterval(10000);
     connect(&m_pluginTimer, &QTimer::timeout, this, &DeviceManager::timerEvent);
 
+    // Journal every change of the configured devices before anybody else gets notified
+    connect(this, &DeviceManager::deviceAdded, this, [this](Device *device) {
+        m_changeJournal.record(device->id(), ChangeJournal::ChangeTypeAdded);
+    });
+    connect(this, &DeviceManager::deviceChanged, this, [this](Device *device) {
+        m_changeJournal.record(device->id(), ChangeJournal::ChangeTypeChanged);
+    });
+    connect(this, &DeviceManager::deviceStateChanged, this, [this](Device *device, const QUuid &stateTypeId, const QVariant &value) {
+        Q_UNUSED(stateTypeId)
+        Q_UNUSED(value)
+        m_changeJournal.record(device->id(), ChangeJournal::ChangeTypeChanged);
+    });
+    connect(this, &DeviceManager::deviceRemoved, this, [this](const DeviceId &deviceId) {
+        m_changeJournal.record(deviceId, ChangeJournal::ChangeTypeRemoved);
+    });
+
+    // Sysfs roots of the hardware resources, configurable for boards with other layouts
+    GuhSettings hardwareSettings(GuhSettings::SettingsRoleGlobal);
+    hardwareSettings.beginGroup("GPIO");
+    Gpio::setSysfsDirectory(hardwareSettings.value("sysfs", Gpio::sysfsDirectory()).toString());
+    Pwm::setSysfsDirectory(hardwareSettings.value("pwmsysfs", Pwm::sysfsDirectory()).toString());
+    hardwareSettings.endGroup();
+
     m_radio433 = new Radio433(this);
+    connect(m_radio433, &Radio433::dataReceived, this, &DeviceManager::radio433SignalReceived);
     m_radio433->enable();
 
     // Network manager
     m_networkManager = new NetworkAccessManager(this);
     connect(m_networkManager, &NetworkAccessManager::replyReady, this, &DeviceManager::replyReady);
 
+    GuhSettings networkSettings(GuhSettings::SettingsRoleGlobal);
+    networkSettings.beginGroup("NetworkManager");
+    m_networkManager->setMaximumPluginRequests(networkSettings.value("maxPluginRequests", m_networkManager->maximumPluginRequests()).toInt());
+    m_networkManager->setMaximumHostRequests(networkSettings.value("maxHostRequests", m_networkManager->maximumHostRequests()).toInt());
+    m_networkManager->setRequestTimeout(networkSettings.value("timeout", m_networkManager->requestTimeout()).toInt());
+    m_networkManager->setCacheSize(networkSettings.value("cacheSize", m_networkManager->cacheSize()).toInt());
+    networkSettings.endGroup();
+
     // UPnP discovery
     m_upnpDiscovery = new UpnpDiscovery(this);
     connect(m_upnpDiscovery, &UpnpDiscovery::discoveryFinished, this, &DeviceManager::upnpDiscoveryFinished);
@@ -245,6 +303,13 @@ DeviceManager::DeviceManager(const QLocale &locale, QObject *parent) :
 DeviceManager::~DeviceManager()
 {
     qCDebug(dcApplication) << "Shutting down \"Device Manager\"";
+
+    // Plugins have to be deleted on the main thread
+    foreach (PluginThread *thread, m_pluginThreads) {
+        thread->shutdown(m_mailbox);
+        delete thread;
+    }
+
     foreach (DevicePlugin *plugin, m_devicePlugins) {
         delete plugin;
     }
@@ -284,6 +349,12 @@ QList<QJsonObject> DeviceManager::pluginsMetadata()
     return pluginList;
 }
 
+/*! Returns the locale of the plugins. */
+QLocale DeviceManager::locale() const
+{
+    return m_locale;
+}
+
 /*! Set the \a locale of all plugins and reload the translated strings. */
 void DeviceManager::setLocale(const QLocale &locale)
 {
@@ -297,7 +368,7 @@ void DeviceManager::setLocale(const QLocale &locale)
     // Reload all plugin meta data
 
     m_supportedVendors.clear();
-    m_supportedDevices.clear();
+    QHash<DeviceClassId, DeviceClass> supportedDevices;
 
     foreach (DevicePlugin *plugin, m_devicePlugins.values()) {
 
@@ -313,10 +384,15 @@ void DeviceManager::setLocale(const QLocale &locale)
                 qCWarning(dcDeviceManager) << "Vendor not found. Ignoring device. VendorId:" << deviceClass.vendorId() << "DeviceClass:" << deviceClass.name() << deviceClass.id();
                 continue;
             }
-            m_supportedDevices.insert(deviceClass.id(), deviceClass);
+            supportedDevices.insert(deviceClass.id(), deviceClass);
         }
     }
 
+    m_devicesLock.lockForWrite();
+    m_supportedDevices = supportedDevices;
+    m_devicesLock.unlock();
+
+    m_catalogVersion++;
     emit languageUpdated();
 }
 
@@ -336,7 +412,7 @@ DevicePlugin *DeviceManager::plugin(const PluginId &id) const
  *  and the given \a pluginConfig. */
 DeviceManager::DeviceError DeviceManager::setPluginConfig(const PluginId &pluginId, const ParamList &pluginConfig)
 {
-    DevicePlugin *plugin = m_devicePlugins.value(pluginId);
+    DevicePlugin *plugin = activatePlugin(pluginId);
     if (!plugin) {
         qCWarning(dcDeviceManager()) << "Could not set plugin configuration. There is no plugin with id" << pluginId.toString();
         return DeviceErrorPluginNotFound;
@@ -359,9 +435,28 @@ DeviceManager::DeviceError DeviceManager::setPluginConfig(const PluginId &plugin
     }
     settings.endGroup();
     settings.endGroup();
+
+    m_catalogVersion++;
     return result;
 }
 
+/*! Returns the version of the plugin catalog (\l{Vendor}{Vendors}, \l{DeviceClass}{DeviceClasses} and
+ *  \l{DevicePlugin}{DevicePlugins}). The version changes whenever the plugins get loaded, the locale changes
+ *  or a plugin configuration changes, so cached representations of the catalog can be invalidated.
+ */
+int DeviceManager::catalogVersion() const
+{
+    return m_catalogVersion;
+}
+
+/*! Returns the \l{ChangeJournal} of the configured \l{Device}{Devices}. Every add, edit, state change and
+ *  removal of a configured device gets a new sequence in this journal.
+ */
+const ChangeJournal &DeviceManager::changeJournal() const
+{
+    return m_changeJournal;
+}
+
 /*! Returns all the \l{Vendor}s loaded in the system. */
 QList<Vendor> DeviceManager::supportedVendors() const
 {
@@ -400,14 +495,30 @@ DeviceManager::DeviceError DeviceManager::discoverDevices(const DeviceClassId &d
     if (result != DeviceErrorNoError) {
         return result;
     }
-    DevicePlugin *plugin = m_devicePlugins.value(deviceClass.pluginId());
+    DevicePlugin *plugin = activatePlugin(deviceClass.pluginId());
     if (!plugin) {
         return DeviceErrorPluginNotFound;
     }
     m_discoveringPlugins.append(plugin);
+    updateHardwareRoutes();
+    if (isThreaded(plugin)) {
+        // An error finishes the discovery without results
+        callPlugin(plugin, "discoverDevices", [plugin, deviceClassId, effectiveParams]() {
+            DeviceError ret = plugin->discoverDevices(deviceClassId, effectiveParams);
+            if (ret != DeviceErrorAsync) {
+                if (ret != DeviceErrorNoError)
+                    qCWarning(dcDeviceManager) << "Discovery failed in" << plugin->pluginName() << ret;
+                emit plugin->devicesDiscovered(deviceClassId, QList<DeviceDescriptor>());
+            }
+        });
+        return DeviceErrorAsync;
+    }
+
+    CallTrace trace(plugin->metaObject()->className(), "discoverDevices");
     DeviceError ret = plugin->discoverDevices(deviceClassId, effectiveParams);
     if (ret != DeviceErrorAsync) {
         m_discoveringPlugins.removeOne(plugin);
+        updateHardwareRoutes();
     }
     return ret;
 }
@@ -494,7 +605,9 @@ DeviceManager::DeviceError DeviceManager::reconfigureDevice(const DeviceId &devi
     }
 
     // first remove the device in the plugin
-    plugin->deviceRemoved(device);
+    callPlugin(plugin, "deviceRemoved", [plugin, device]() {
+        plugin->deviceRemoved(device);
+    });
 
     // mark setup as incomplete
     device->setSetupComplete(false);
@@ -505,7 +618,7 @@ DeviceManager::DeviceError DeviceManager::reconfigureDevice(const DeviceId &devi
     }
 
     // try to setup the device with the new params
-    DeviceSetupStatus status = plugin->setupDevice(device);
+    DeviceSetupStatus status = setupDeviceInPlugin(plugin, device);
     switch (status) {
     case DeviceSetupStatusFailure:
         qCWarning(dcDeviceManager) << "Device reconfiguration failed. Not saving changes of device paramters. Device setup incomplete.";
@@ -628,12 +741,21 @@ DeviceManager::DeviceError DeviceManager::pairDevice(const PairingTransactionId
     if (deviceClass.setupMethod() == DeviceClass::SetupMethodDisplayPin) {
         DeviceDescriptor deviceDescriptor = m_discoveredDevices.value(deviceDescriptorId);
 
-        DevicePlugin *plugin = m_devicePlugins.value(m_supportedDevices.value(deviceClassId).pluginId());
+        DevicePlugin *plugin = activatePlugin(m_supportedDevices.value(deviceClassId).pluginId());
         if (!plugin) {
             qCWarning(dcDeviceManager()) << "Can't find a plugin for this device class";
             return DeviceErrorPluginNotFound;
         }
 
+        if (isThreaded(plugin)) {
+            callPlugin(plugin, "displayPin", [plugin, pairingTransactionId, deviceDescriptor]() {
+                DeviceError error = plugin->displayPin(pairingTransactionId, deviceDescriptor);
+                if (error != DeviceErrorNoError)
+                    qCWarning(dcDeviceManager) << "Could not display the pin in" << plugin->pluginName() << error;
+            });
+            return DeviceErrorNoError;
+        }
+
         return plugin->displayPin(pairingTransactionId, deviceDescriptor);
     }
 
@@ -655,13 +777,22 @@ DeviceManager::DeviceError DeviceManager::confirmPairing(const PairingTransactio
         DeviceClassId deviceClassId = pairingInfo.deviceClassId();
         DeviceDescriptor deviceDescriptor = m_discoveredDevices.value(pairingInfo.deviceDescriptorId());
 
-        DevicePlugin *plugin = m_devicePlugins.value(m_supportedDevices.value(deviceClassId).pluginId());
+        DevicePlugin *plugin = activatePlugin(m_supportedDevices.value(deviceClassId).pluginId());
 
         if (!plugin) {
             qCWarning(dcDeviceManager) << "Can't find a plugin for this device class";
             return DeviceErrorPluginNotFound;
         }
 
+        if (isThreaded(plugin)) {
+            callPlugin(plugin, "confirmPairing", [plugin, pairingTransactionId, deviceClassId, deviceDescriptor, secret]() {
+                DeviceSetupStatus status = plugin->confirmPairing(pairingTransactionId, deviceClassId, deviceDescriptor.params(), secret);
+                if (status != DeviceSetupStatusAsync)
+                    emit plugin->pairingFinished(pairingTransactionId, status);
+            });
+            return DeviceErrorAsync;
+        }
+
         DeviceSetupStatus status = plugin->confirmPairing(pairingTransactionId, deviceClassId, deviceDescriptor.params(), secret);
         switch (status) {
         case DeviceSetupStatusSuccess:
@@ -704,7 +835,7 @@ DeviceManager::DeviceError DeviceManager::addConfiguredDeviceInternal(const Devi
         }
     }
 
-    DevicePlugin *plugin = m_devicePlugins.value(deviceClass.pluginId());
+    DevicePlugin *plugin = activatePlugin(deviceClass.pluginId());
     if (!plugin) {
         return DeviceErrorPluginNotFound;
     }
@@ -730,7 +861,8 @@ DeviceManager::DeviceError DeviceManager::addConfiguredDeviceInternal(const Devi
         break;
     }
 
-    m_configuredDevices.append(device);
+    appendConfiguredDevice(device);
+    updateHardwareRoutes();
     storeConfiguredDevices();
     postSetupDevice(device);
 
@@ -749,8 +881,26 @@ DeviceManager::DeviceError DeviceManager::removeConfiguredDevice(const DeviceId
         return DeviceErrorDeviceNotFound;
     }
 
+    m_devicesLock.lockForWrite();
     m_configuredDevices.removeAll(device);
-    m_devicePlugins.value(device->pluginId())->deviceRemoved(device);
+    m_devicesLock.unlock();
+
+    // A setup still running on a worker thread reports back before the device gets deleted.
+    // If the plugin drops the setup instead, the entry goes away together with the device.
+    if (m_pendingPostSetups.removeAll(device) > 0) {
+        m_abandonedSetups.append(deviceId);
+        connect(device, &Device::destroyed, this, [this, deviceId]() {
+            m_abandonedSetups.removeAll(deviceId);
+        });
+    }
+
+    // Plugins on a worker thread see the removal later, so the device has to stay valid until then
+    DevicePlugin *plugin = m_devicePlugins.value(device->pluginId());
+    callPlugin(plugin, "deviceRemoved", [plugin, device]() {
+        plugin->deviceRemoved(device);
+        device->deleteLater();
+    });
+    updateHardwareRoutes();
 
     // check if this plugin still needs the guhTimer call
     bool pluginNeedsTimer = false;
@@ -763,12 +913,11 @@ DeviceManager::DeviceError DeviceManager::removeConfiguredDevice(const DeviceId
 
     // if this plugin doesn't need any longer the guhTimer call
     if (!pluginNeedsTimer) {
-        m_pluginTimerUsers.removeAll(plugin(device->pluginId()));
+        m_pluginTimerUsers.removeAll(plugin);
         if (m_pluginTimerUsers.isEmpty()) {
             m_pluginTimer.stop();
         }
     }
-    device->deleteLater();
 
     GuhSettings settings(GuhSettings::SettingsRoleDevices);
     settings.beginGroup("DeviceConfig");
@@ -784,6 +933,7 @@ DeviceManager::DeviceError DeviceManager::removeConfiguredDevice(const DeviceId
 /*! Returns the \l{Device} with the given \a id. Null if the id couldn't be found. */
 Device *DeviceManager::findConfiguredDevice(const DeviceId &id) const
 {
+    QReadLocker locker(&m_devicesLock);
     foreach (Device *device, m_configuredDevices) {
         if (device->id() == id) {
             return device;
@@ -795,12 +945,14 @@ Device *DeviceManager::findConfiguredDevice(const DeviceId &id) const
 /*! Returns all configured \{Device}{Devices} in the system. */
 QList<Device *> DeviceManager::configuredDevices() const
 {
+    QReadLocker locker(&m_devicesLock);
     return m_configuredDevices;
 }
 
 /*! Returns all \l{Device}{Devices} matching the \l{DeviceClass} referred by \a deviceClassId. */
 QList<Device *> DeviceManager::findConfiguredDevices(const DeviceClassId &deviceClassId) const
 {
+    QReadLocker locker(&m_devicesLock);
     QList<Device*> ret;
     foreach (Device *device, m_configuredDevices) {
         if (device->deviceClassId() == deviceClassId) {
@@ -813,6 +965,7 @@ QList<Device *> DeviceManager::findConfiguredDevices(const DeviceClassId &device
 /*! Returns all child \l{Device}{Devices} of the given \a device. */
 QList<Device *> DeviceManager::findChildDevices(Device *device) const
 {
+    QReadLocker locker(&m_devicesLock);
     QList<Device *> ret;
     foreach (Device *d, m_configuredDevices) {
         if (d->parentId() == device->id()) {
@@ -826,6 +979,7 @@ QList<Device *> DeviceManager::findChildDevices(Device *device) const
  *  Note: The returned \l{DeviceClass} may be invalid. */
 DeviceClass DeviceManager::findDeviceClass(const DeviceClassId &deviceClassId) const
 {
+    QReadLocker locker(&m_devicesLock);
     foreach (const DeviceClass &deviceClass, m_supportedDevices) {
         if (deviceClass.id() == deviceClassId) {
             return deviceClass;
@@ -984,7 +1138,22 @@ DeviceManager::DeviceError DeviceManager::executeAction(const Action &action)
                 return DeviceErrorActionTypeNotFound;
             }
 
-            return m_devicePlugins.value(device->pluginId())->executeAction(device, finalAction);
+            DevicePlugin *plugin = m_devicePlugins.value(device->pluginId());
+            if (isThreaded(plugin)) {
+                callPlugin(plugin, "executeAction", [plugin, device, finalAction]() {
+                    DeviceError result = plugin->executeAction(device, finalAction);
+                    if (result != DeviceErrorAsync)
+                        emit plugin->actionExecutionFinished(finalAction.id(), result);
+                });
+                return DeviceErrorAsync;
+            }
+
+            // requests sent while executing an action overtake the polling requests
+            m_networkManager->setContextPriority(QNetworkRequest::HighPriority);
+            CallTrace trace(plugin->metaObject()->className(), "executeAction");
+            DeviceError result = plugin->executeAction(device, finalAction);
+            m_networkManager->setContextPriority(QNetworkRequest::NormalPriority);
+            return result;
         }
     }
     return DeviceErrorDeviceNotFound;
@@ -998,6 +1167,32 @@ void DeviceManager::timeTick()
 
 void DeviceManager::loadPlugins()
 {
+    StartupProfiler::beginPhase("Load plugins");
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+
+    // Only the plugins of configured devices and plugins creating auto devices get loaded right away,
+    // all other plugins are represented by their metadata until they get used the first time.
+    GuhSettings globalSettings(GuhSettings::SettingsRoleGlobal);
+    globalSettings.beginGroup("Plugins");
+    bool lazyLoading = globalSettings.value("lazyLoading", true).toBool();
+    globalSettings.endGroup();
+
+    QStringList requiredPlugins;
+    GuhSettings deviceSettings(GuhSettings::SettingsRoleDevices);
+    deviceSettings.beginGroup("DeviceConfig");
+    foreach (const QString &idString, deviceSettings.childGroups()) {
+        QString pluginId = deviceSettings.value(idString + "/pluginid").toString();
+        if (!requiredPlugins.contains(pluginId))
+            requiredPlugins.append(pluginId);
+    }
+    deviceSettings.endGroup();
+
+    GuhSettings pluginSettings(GuhSettings::SettingsRolePlugins);
+    pluginSettings.beginGroup("PluginConfig");
+    QStringList configuredPlugins = pluginSettings.childGroups();
+
+    QList<QPair<qint64, QString> > loadTimes;
     foreach (const QString &path, pluginSearchDirs()) {
         QDir dir(path);
         qCDebug(dcDeviceManager) << "Loading plugins from:" << dir.absolutePath();
@@ -1012,33 +1207,42 @@ void DeviceManager::loadPlugins()
             if (!fi.exists())
                 continue;
 
+            qint64 pluginStart = StartupProfiler::elapsed();
+            QElapsedTimer pluginTimer;
+            pluginTimer.start();
 
-            QPluginLoader loader;
-            loader.setFileName(fi.absoluteFilePath());
-            loader.setLoadHints(QLibrary::ResolveAllSymbolsHint);
-
-            if (!loader.load()) {
-                qCWarning(dcDeviceManager) << "Could not load plugin data of" << entry;
+            // Reading the metadata does not load the library
+            QPluginLoader loader(fi.absoluteFilePath());
+            QJsonObject metaData = loader.metaData().value("MetaData").toObject();
+            if (!verifyPluginMetadata(metaData))
                 continue;
-            }
 
-            DevicePlugin *pluginIface = qobject_cast<DevicePlugin *>(loader.instance());
-            if (!pluginIface) {
-                qCWarning(dcDeviceManager) << "Could not get plugin instance of" << entry;
+            PluginId pluginId(metaData.value("id").toString());
+            if (m_devicePlugins.contains(pluginId)) {
+                qCWarning(dcDeviceManager) << "Plugin" << pluginId.toString() << "already loaded. Ignoring" << fi.absoluteFilePath();
                 continue;
             }
 
-            if (!verifyPluginMetadata(loader.metaData().value("MetaData").toObject()))
-                continue;
+            bool activate = !lazyLoading || requiredPlugins.contains(pluginId.toString()) || createsAutoDevices(metaData);
+
+            DevicePlugin *pluginIface = 0;
+            if (activate) {
+                pluginIface = loadPluginLibrary(fi.absoluteFilePath());
+                if (!pluginIface)
+                    continue;
+            } else {
+                pluginIface = new InactivePlugin();
+                m_inactivePlugins.insert(pluginId, fi.absoluteFilePath());
+            }
 
-            pluginIface->setMetaData(loader.metaData().value("MetaData").toObject());
+            pluginIface->setMetaData(metaData);
 
             pluginIface->setLocale(m_locale);
             qApp->installTranslator(pluginIface->translator());
 
             pluginIface->initPlugin(this);
 
-            qCDebug(dcDeviceManager) << "**** Loaded plugin" << pluginIface->pluginName();
+            qCDebug(dcDeviceManager) << "****" << (activate ? "Loaded" : "Registered inactive") << "plugin" << pluginIface->pluginName();
             foreach (const Vendor &vendor, pluginIface->supportedVendors()) {
                 qCDebug(dcDeviceManager) << "* Loaded vendor:" << vendor.name();
                 if (m_supportedVendors.contains(vendor.id()))
@@ -1053,20 +1257,20 @@ void DeviceManager::loadPlugins()
                     continue;
                 }
                 m_vendorDeviceMap[deviceClass.vendorId()].append(deviceClass.id());
+                m_devicesLock.lockForWrite();
                 m_supportedDevices.insert(deviceClass.id(), deviceClass);
+                m_devicesLock.unlock();
                 qCDebug(dcDeviceManager) << "* Loaded device class:" << deviceClass.name();
             }
 
-            GuhSettings settings(GuhSettings::SettingsRolePlugins);
-            settings.beginGroup("PluginConfig");
             ParamList params;
-            if (settings.childGroups().contains(pluginIface->pluginId().toString())) {
-                settings.beginGroup(pluginIface->pluginId().toString());
-                foreach (const QString &paramTypeIdString, settings.allKeys()) {
-                    Param param(ParamTypeId(paramTypeIdString), settings.value(paramTypeIdString));
+            if (configuredPlugins.contains(pluginIface->pluginId().toString())) {
+                pluginSettings.beginGroup(pluginIface->pluginId().toString());
+                foreach (const QString &paramTypeIdString, pluginSettings.allKeys()) {
+                    Param param(ParamTypeId(paramTypeIdString), pluginSettings.value(paramTypeIdString));
                     params.append(param);
                 }
-                settings.endGroup();
+                pluginSettings.endGroup();
             } else if (!pluginIface->configurationDescription().isEmpty()){
                 // plugin requires config but none stored. Init with defaults
                 foreach (const ParamType &paramType, pluginIface->configurationDescription()) {
@@ -1074,7 +1278,6 @@ void DeviceManager::loadPlugins()
                     params.append(param);
                 }
             }
-            settings.endGroup();
 
             if (params.count() > 0) {
                 DeviceError status = pluginIface->setConfiguration(params);
@@ -1085,18 +1288,167 @@ void DeviceManager::loadPlugins()
 
             m_devicePlugins.insert(pluginIface->pluginId(), pluginIface);
 
-            connect(pluginIface, &DevicePlugin::emitEvent, this, &DeviceManager::eventTriggered);
-            connect(pluginIface, &DevicePlugin::devicesDiscovered, this, &DeviceManager::slotDevicesDiscovered, Qt::QueuedConnection);
-            connect(pluginIface, &DevicePlugin::deviceSetupFinished, this, &DeviceManager::slotDeviceSetupFinished);
-            connect(pluginIface, &DevicePlugin::actionExecutionFinished, this, &DeviceManager::actionExecutionFinished);
-            connect(pluginIface, &DevicePlugin::pairingFinished, this, &DeviceManager::slotPairingFinished);
-            connect(pluginIface, &DevicePlugin::autoDevicesAppeared, this, &DeviceManager::autoDevicesAppeared);
+            if (activate) {
+                connectPlugin(pluginIface);
+                assignPluginThread(pluginIface);
+            }
+
+            QString pluginName = pluginIface->pluginName() + (activate ? QString() : QString(" (inactive)"));
+            loadTimes.append(qMakePair(pluginTimer.elapsed(), pluginName));
+            StartupProfiler::addPhase(pluginName, "Load plugins", pluginStart, pluginTimer.elapsed());
         }
     }
+    pluginSettings.endGroup();
+
+    // Report the slowest plugins first
+    std::sort(loadTimes.begin(), loadTimes.end(), [](const QPair<qint64, QString> &a, const QPair<qint64, QString> &b) {
+        return a.first > b.first;
+    });
+    qCDebug(dcDeviceManager) << "Loaded" << m_devicePlugins.count() - m_inactivePlugins.count() << "of" << m_devicePlugins.count() << "plugins in" << loadTimer.elapsed() << "ms";
+    for (int i = 0; i < loadTimes.count(); i++) {
+        qCDebug(dcDeviceManager) << "*" << loadTimes.at(i).first << "ms" << loadTimes.at(i).second;
+    }
+    m_catalogVersion++;
+    StartupProfiler::endPhase("Load plugins");
+}
+
+DevicePlugin *DeviceManager::loadPluginLibrary(const QString &fileName)
+{
+    QPluginLoader loader(fileName);
+    if (!loader.load()) {
+        qCWarning(dcDeviceManager) << "Could not load plugin data of" << fileName << loader.errorString();
+        return 0;
+    }
+
+    DevicePlugin *pluginIface = qobject_cast<DevicePlugin *>(loader.instance());
+    if (!pluginIface) {
+        qCWarning(dcDeviceManager) << "Could not get plugin instance of" << fileName;
+        return 0;
+    }
+    return pluginIface;
+}
+
+void DeviceManager::connectPlugin(DevicePlugin *plugin)
+{
+    QString pluginLabel = plugin->pluginId().toString().remove('{').remove('}');
+    MetricCounter *eventMetric = Metrics::counter("guh_plugin_events_total", "Events and state changes emitted by the plugin.", "plugin", pluginLabel);
+    m_eventMetrics.insert(plugin->pluginId(), eventMetric);
+
+    connect(plugin, &DevicePlugin::emitEvent, this, [this, eventMetric](const Event &event) {
+        eventMetric->increment();
+        emit eventTriggered(event);
+    });
+    connect(plugin, &DevicePlugin::devicesDiscovered, this, &DeviceManager::slotDevicesDiscovered, Qt::QueuedConnection);
+    connect(plugin, &DevicePlugin::deviceSetupFinished, this, &DeviceManager::slotDeviceSetupFinished);
+    connect(plugin, &DevicePlugin::actionExecutionFinished, this, &DeviceManager::actionExecutionFinished);
+    connect(plugin, &DevicePlugin::pairingFinished, this, &DeviceManager::slotPairingFinished);
+    connect(plugin, &DevicePlugin::autoDevicesAppeared, this, &DeviceManager::autoDevicesAppeared);
+}
+
+// Moves the plugin to the worker thread named in its metadata, plugins naming the same thread share it
+void DeviceManager::assignPluginThread(DevicePlugin *plugin)
+{
+    QString threadName = plugin->m_metaData.value("workerThread").toString();
+    if (threadName.isEmpty())
+        return;
+
+    GuhSettings globalSettings(GuhSettings::SettingsRoleGlobal);
+    globalSettings.beginGroup("Plugins");
+    bool workerThreads = globalSettings.value("workerThreads", true).toBool();
+    globalSettings.endGroup();
+    if (!workerThreads)
+        return;
+
+    PluginThread *thread = m_pluginThreads.value(threadName);
+    if (!thread) {
+        thread = new PluginThread(threadName);
+        thread->start();
+        m_pluginThreads.insert(threadName, thread);
+    }
+
+    thread->adopt(plugin);
+    m_threadedPlugins.insert(plugin->pluginId(), thread);
+    qCDebug(dcDeviceManager) << "Plugin" << plugin->pluginName() << "runs on worker thread" << threadName;
+}
+
+bool DeviceManager::isThreaded(DevicePlugin *plugin) const
+{
+    return m_threadedPlugins.contains(plugin->pluginId());
+}
+
+// Calls into the plugin on its own thread. Calls of plugins on a worker thread get queued, so they can't return anything.
+void DeviceManager::callPlugin(DevicePlugin *plugin, const char *entry, const std::function<void()> &call)
+{
+    PluginThread *thread = m_threadedPlugins.value(plugin->pluginId());
+    if (!thread) {
+        CallTrace trace(plugin->metaObject()->className(), entry);
+        call();
+        return;
+    }
+
+    QString component = plugin->metaObject()->className();
+    thread->post([component, entry, call]() {
+        CallTrace trace(component, entry);
+        call();
+    });
+}
+
+// Returns the plugin with the given pluginId and loads its library if it has not been used yet
+DevicePlugin *DeviceManager::activatePlugin(const PluginId &pluginId)
+{
+    DevicePlugin *inactivePlugin = m_devicePlugins.value(pluginId);
+    if (!inactivePlugin || !m_inactivePlugins.contains(pluginId))
+        return inactivePlugin;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    DevicePlugin *pluginIface = loadPluginLibrary(m_inactivePlugins.value(pluginId));
+    if (!pluginIface)
+        return 0;
+
+    m_inactivePlugins.remove(pluginId);
+
+    pluginIface->setMetaData(inactivePlugin->m_metaData);
+
+    QCoreApplication::removeTranslator(inactivePlugin->translator());
+    pluginIface->setLocale(m_locale);
+    qApp->installTranslator(pluginIface->translator());
+
+    pluginIface->initPlugin(this);
+
+    if (!inactivePlugin->configuration().isEmpty()) {
+        DeviceError status = pluginIface->setConfiguration(inactivePlugin->configuration());
+        if (status != DeviceErrorNoError) {
+            qCWarning(dcDeviceManager) << "Error setting params to plugin. Broken configuration?";
+        }
+    }
+
+    m_devicePlugins.insert(pluginId, pluginIface);
+    connectPlugin(pluginIface);
+    assignPluginThread(pluginIface);
+    delete inactivePlugin;
+
+    qCDebug(dcDeviceManager) << "Activated plugin" << pluginIface->pluginName() << "in" << timer.elapsed() << "ms";
+    return pluginIface;
+}
+
+bool DeviceManager::createsAutoDevices(const QJsonObject &metaData)
+{
+    foreach (const QJsonValue &vendorJson, metaData.value("vendors").toArray()) {
+        foreach (const QJsonValue &deviceClassJson, vendorJson.toObject().value("deviceClasses").toArray()) {
+            if (deviceClassJson.toObject().value("createMethods").toArray().contains(QJsonValue("auto")))
+                return true;
+        }
+    }
+    return false;
 }
 
 void DeviceManager::loadConfiguredDevices()
 {
+    StartupProfiler::beginPhase("Setup devices");
+    QHash<PluginId, StartupProfiler::Phase> setupPhases;
+
     GuhSettings settings(GuhSettings::SettingsRoleDevices);
     settings.beginGroup("DeviceConfig");
     qCDebug(dcDeviceManager) << "loading devices from" << settings.fileName();
@@ -1115,16 +1467,34 @@ void DeviceManager::loadConfiguredDevices()
         settings.endGroup();
         settings.endGroup();
 
+        // Accumulate the setup time of the devices of each plugin
+        if (!setupPhases.contains(device->pluginId()))
+            setupPhases[device->pluginId()].start = StartupProfiler::elapsed();
+
+        QElapsedTimer setupTimer;
+        setupTimer.start();
+
         // We always add the device to the list in this case. If its in the storedDevices
         // it means that it was working at some point so lets still add it as there might
         // be rules associated with this device. Device::setupCompleted() will be false.
         DeviceSetupStatus status = setupDevice(device);
-        m_configuredDevices.append(device);
+        appendConfiguredDevice(device);
 
         if (status == DeviceSetupStatus::DeviceSetupStatusSuccess)
             postSetupDevice(device);
+
+        setupPhases[device->pluginId()].duration += setupTimer.elapsed();
     }
     settings.endGroup();
+
+    updateHardwareRoutes();
+
+    foreach (const PluginId &pluginId, setupPhases.keys()) {
+        DevicePlugin *plugin = m_devicePlugins.value(pluginId);
+        QString name = plugin ? plugin->pluginName() : pluginId.toString();
+        StartupProfiler::addPhase(name, "Setup devices", setupPhases.value(pluginId).start, setupPhases.value(pluginId).duration);
+    }
+    StartupProfiler::endPhase("Setup devices");
 }
 
 void DeviceManager::storeConfiguredDevices()
@@ -1151,15 +1521,20 @@ void DeviceManager::storeConfiguredDevices()
 
 void DeviceManager::startMonitoringAutoDevices()
 {
+    StartupProfiler::beginPhase("Start monitoring auto devices");
     foreach (DevicePlugin *plugin, m_devicePlugins) {
-        plugin->startMonitoringAutoDevices();
+        callPlugin(plugin, "startMonitoringAutoDevices", [plugin]() {
+            plugin->startMonitoringAutoDevices();
+        });
     }
+    StartupProfiler::endPhase("Start monitoring auto devices");
 }
 
 void DeviceManager::slotDevicesDiscovered(const DeviceClassId &deviceClassId, const QList<DeviceDescriptor> deviceDescriptors)
 {
     DevicePlugin *plugin = static_cast<DevicePlugin*>(sender());
     m_discoveringPlugins.removeOne(plugin);
+    updateHardwareRoutes();
 
     foreach (const DeviceDescriptor &descriptor, deviceDescriptors) {
         m_discoveredDevices.insert(descriptor.id(), descriptor);
@@ -1175,6 +1550,12 @@ void DeviceManager::slotDeviceSetupFinished(Device *device, DeviceManager::Devic
         return;
     }
 
+    // The device has been removed while a worker thread was setting it up
+    if (m_abandonedSetups.removeAll(device->id()) > 0)
+        return;
+
+    bool postSetup = m_pendingPostSetups.removeAll(device) > 0;
+
     if (device->setupComplete()) {
         qCWarning(dcDeviceManager) << "Received a deviceSetupFinished event, but this Device has been set up before... ignoring...";
         return;
@@ -1212,7 +1593,8 @@ void DeviceManager::slotDeviceSetupFinished(Device *device, DeviceManager::Devic
     // A device might be in here already if loaded from storedDevices. If it's not in the configuredDevices,
     // lets add it now.
     if (!m_configuredDevices.contains(device)) {
-        m_configuredDevices.append(device);
+        appendConfiguredDevice(device);
+        updateHardwareRoutes();
         emit deviceAdded(device);
         storeConfiguredDevices();
     }
@@ -1233,6 +1615,9 @@ void DeviceManager::slotDeviceSetupFinished(Device *device, DeviceManager::Devic
     if (m_asyncDeviceReconfiguration.contains(device)) {
         m_asyncDeviceReconfiguration.removeAll(device);
         storeConfiguredDevices();
+        if (postSetup)
+            postSetupDevice(device);
+
         device->setupCompleted();
         emit deviceChanged(device);
         emit deviceReconfigurationFinished(device, DeviceManager::DeviceErrorNoError);
@@ -1243,6 +1628,10 @@ void DeviceManager::slotDeviceSetupFinished(Device *device, DeviceManager::Devic
 
     device->setupCompleted();
     emit deviceSetupFinished(device, DeviceManager::DeviceErrorNoError);
+
+    // Plugins on a worker thread always finish the setup here
+    if (postSetup)
+        postSetupDevice(device);
 }
 
 void DeviceManager::slotPairingFinished(const PairingTransactionId &pairingTransactionId, DeviceManager::DeviceSetupStatus status)
@@ -1320,7 +1709,8 @@ void DeviceManager::slotPairingFinished(const PairingTransactionId &pairingTrans
         break;
     }
 
-    m_configuredDevices.append(device);
+    appendConfiguredDevice(device);
+    updateHardwareRoutes();
     emit deviceAdded(device);
     storeConfiguredDevices();
     emit deviceSetupFinished(device, DeviceError::DeviceErrorNoError);
@@ -1355,7 +1745,8 @@ void DeviceManager::autoDevicesAppeared(const DeviceClassId &deviceClassId, cons
             break;
         case DeviceSetupStatusSuccess:
             qCDebug(dcDeviceManager) << "Device setup complete.";
-            m_configuredDevices.append(device);
+            appendConfiguredDevice(device);
+            updateHardwareRoutes();
             storeConfiguredDevices();
             emit deviceSetupFinished(device, DeviceError::DeviceErrorNoError);
             emit deviceAdded(device);
@@ -1373,39 +1764,46 @@ void DeviceManager::slotDeviceStateValueChanged(const QUuid &stateTypeId, const
     }
     emit deviceStateChanged(device, stateTypeId, value);
 
+    MetricCounter *eventMetric = m_eventMetrics.value(device->pluginId());
+    if (eventMetric)
+        eventMetric->increment();
+
     Param valueParam(ParamTypeId(stateTypeId.toString()), value);
     Event event(EventTypeId(stateTypeId.toString()), device->id(), ParamList() << valueParam, true);
     emit eventTriggered(event);
 }
 
-void DeviceManager::radio433SignalReceived(QList<int> rawData)
+void DeviceManager::radio433SignalReceived(const QList<int> &rawData)
 {
-    QList<DevicePlugin*> targetPlugins;
-
-    foreach (Device *device, m_configuredDevices) {
-        DeviceClass deviceClass = m_supportedDevices.value(device->deviceClassId());
-        DevicePlugin *plugin = m_devicePlugins.value(deviceClass.pluginId());
-        if (plugin->requiredHardware().testFlag(HardwareResourceRadio433) && !targetPlugins.contains(plugin)) {
-            targetPlugins.append(plugin);
-        }
-    }
-    foreach (DevicePlugin *plugin, m_discoveringPlugins) {
-        if (plugin->requiredHardware().testFlag(HardwareResourceRadio433) && !targetPlugins.contains(plugin)) {
-            targetPlugins.append(plugin);
-        }
+    // Plugins without a protocol declaration get the undecoded timings
+    foreach (DevicePlugin *plugin, m_radio433Routes.value(Radio433CodeWord::ProtocolRaw)) {
+        callPlugin(plugin, "radioData", [plugin, rawData]() {
+            plugin->radioData(rawData);
+        });
     }
 
-    foreach (DevicePlugin *plugin, targetPlugins) {
-        plugin->radioData(rawData);
+    // Only decode if somebody is interested in a decoded code word
+    if (m_radio433Routes.isEmpty() || (m_radio433Routes.count() == 1 && m_radio433Routes.contains(Radio433CodeWord::ProtocolRaw)))
+        return;
+
+    Radio433CodeWord codeWord = Radio433CodeWord::decode(rawData);
+    if (!codeWord.isValid())
+        return;
+
+    foreach (DevicePlugin *plugin, m_radio433Routes.value(codeWord.protocol())) {
+        callPlugin(plugin, "radioCodeReceived", [plugin, codeWord]() {
+            plugin->radioCodeReceived(codeWord);
+        });
     }
 }
 
 void DeviceManager::replyReady(const PluginId &pluginId, QNetworkReply *reply)
 {
-    foreach (DevicePlugin *devicePlugin, m_devicePlugins) {
-        if (devicePlugin->requiredHardware().testFlag(HardwareResourceNetworkManager) && devicePlugin->pluginId() == pluginId) {
+    DevicePlugin *devicePlugin = m_devicePlugins.value(pluginId);
+    if (devicePlugin && devicePlugin->requiredHardware().testFlag(HardwareResourceNetworkManager)) {
+        callPlugin(devicePlugin, "networkManagerReplyReady", [devicePlugin, reply]() {
             devicePlugin->networkManagerReplyReady(reply);
-        }
+        });
     }
 }
 
@@ -1413,18 +1811,47 @@ void DeviceManager::upnpDiscoveryFinished(const QList<UpnpDeviceDescriptor> &dev
 {
     foreach (DevicePlugin *devicePlugin, m_devicePlugins) {
         if (devicePlugin->requiredHardware().testFlag(HardwareResourceUpnpDisovery) && devicePlugin->pluginId() == pluginId) {
-            devicePlugin->upnpDiscoveryFinished(deviceDescriptorList);
+            callPlugin(devicePlugin, "upnpDiscoveryFinished", [devicePlugin, deviceDescriptorList]() {
+                devicePlugin->upnpDiscoveryFinished(deviceDescriptorList);
+            });
         }
     }
 }
 
-void DeviceManager::upnpNotifyReceived(const QByteArray &notifyData)
+void DeviceManager::upnpNotifyReceived(const SsdpMessage &notification)
 {
-    foreach (DevicePlugin *devicePlugin, m_devicePlugins) {
-        if (devicePlugin->requiredHardware().testFlag(HardwareResourceUpnpDisovery)) {
-            devicePlugin->upnpNotifyReceived(notifyData);
+    if (m_upnpNotifyRoutes.isEmpty() && m_upnpNotifyPatterns.isEmpty())
+        return;
+
+    QList<DevicePlugin *> plugins;
+    QList<QByteArray> keys;
+    keys << notification.notificationType() << notification.usn() << notification.uuid();
+    foreach (const QByteArray &key, keys) {
+        foreach (DevicePlugin *plugin, m_upnpNotifyRoutes.value(key.toLower())) {
+            if (!plugins.contains(plugin)) {
+                plugins.append(plugin);
+            }
         }
     }
+
+    QString notificationType = QString::fromUtf8(notification.notificationType());
+    QString usn = QString::fromUtf8(notification.usn());
+    for (int i = 0; i < m_upnpNotifyPatterns.count(); i++) {
+        DevicePlugin *plugin = m_upnpNotifyPatterns.at(i).second;
+        if (plugins.contains(plugin))
+            continue;
+
+        const QRegExp &pattern = m_upnpNotifyPatterns.at(i).first;
+        if (pattern.exactMatch(notificationType) || pattern.exactMatch(usn)) {
+            plugins.append(plugin);
+        }
+    }
+
+    foreach (DevicePlugin *plugin, plugins) {
+        callPlugin(plugin, "upnpNotifyReceived", [plugin, notification]() {
+            plugin->upnpNotifyReceived(notification);
+        });
+    }
 }
 
 #ifdef BLUETOOTH_LE
@@ -1432,7 +1859,9 @@ void DeviceManager::bluetoothDiscoveryFinished(const PluginId &pluginId, const Q
 {
     foreach (DevicePlugin *devicePlugin, m_devicePlugins) {
         if (devicePlugin->requiredHardware().testFlag(HardwareResourceBluetoothLE) && devicePlugin->pluginId() == pluginId) {
-            devicePlugin->bluetoothDiscoveryFinished(deviceInfos);
+            callPlugin(devicePlugin, "bluetoothDiscoveryFinished", [devicePlugin, deviceInfos]() {
+                devicePlugin->bluetoothDiscoveryFinished(deviceInfos);
+            });
         }
     }
 }
@@ -1440,11 +1869,16 @@ void DeviceManager::bluetoothDiscoveryFinished(const PluginId &pluginId, const Q
 
 void DeviceManager::timerEvent()
 {
+    // polling requests must not delay the requests of actions
+    m_networkManager->setContextPriority(QNetworkRequest::LowPriority);
     foreach (DevicePlugin *plugin, m_pluginTimerUsers) {
         if (plugin->requiredHardware().testFlag(HardwareResourceTimer)) {
-            plugin->guhTimer();
+            callPlugin(plugin, "guhTimer", [plugin]() {
+                plugin->guhTimer();
+            });
         }
     }
+    m_networkManager->setContextPriority(QNetworkRequest::NormalPriority);
 }
 
 bool DeviceManager::verifyPluginMetadata(const QJsonObject &data)
@@ -1465,7 +1899,7 @@ bool DeviceManager::verifyPluginMetadata(const QJsonObject &data)
 DeviceManager::DeviceSetupStatus DeviceManager::setupDevice(Device *device)
 {
     DeviceClass deviceClass = findDeviceClass(device->deviceClassId());
-    DevicePlugin *plugin = m_devicePlugins.value(deviceClass.pluginId());
+    DevicePlugin *plugin = activatePlugin(deviceClass.pluginId());
 
     if (!plugin) {
         qCWarning(dcDeviceManager) << "Can't find a plugin for this device" << device->id();
@@ -1480,7 +1914,7 @@ DeviceManager::DeviceSetupStatus DeviceManager::setupDevice(Device *device)
     }
     device->setStates(states);
 
-    DeviceSetupStatus status = plugin->setupDevice(device);
+    DeviceSetupStatus status = setupDeviceInPlugin(plugin, device);
     if (status != DeviceSetupStatusSuccess) {
         return status;
     }
@@ -1507,6 +1941,88 @@ void DeviceManager::postSetupDevice(Device *device)
     DeviceClass deviceClass = findDeviceClass(device->deviceClassId());
     DevicePlugin *plugin = m_devicePlugins.value(deviceClass.pluginId());
 
-    plugin->postSetupDevice(device);
+    callPlugin(plugin, "postSetupDevice", [plugin, device]() {
+        plugin->postSetupDevice(device);
+    });
+}
+
+// Plugins on a worker thread always set the device up asynchronously, the result arrives in slotDeviceSetupFinished()
+DeviceManager::DeviceSetupStatus DeviceManager::setupDeviceInPlugin(DevicePlugin *plugin, Device *device)
+{
+    if (!isThreaded(plugin)) {
+        CallTrace trace(plugin->metaObject()->className(), "setupDevice");
+        return plugin->setupDevice(device);
+    }
+
+    m_pendingPostSetups.append(device);
+    callPlugin(plugin, "setupDevice", [plugin, device]() {
+        DeviceSetupStatus status = plugin->setupDevice(device);
+        if (status != DeviceSetupStatusAsync)
+            emit plugin->deviceSetupFinished(device, status);
+    });
+    return DeviceSetupStatusAsync;
+}
+
+// Plugins on a worker thread read the configured devices, so the list must only be changed while holding the lock
+void DeviceManager::appendConfiguredDevice(Device *device)
+{
+    QWriteLocker locker(&m_devicesLock);
+    m_configuredDevices.append(device);
+}
+
+void DeviceManager::updateHardwareRoutes()
+{
+    updateRadio433Routes();
+    updateUpnpNotifyRoutes();
+}
+
+void DeviceManager::updateRadio433Routes()
+{
+    // Rebuild the protocol -> plugin table, only plugins with configured or discovering devices are interested
+    QList<DevicePlugin *> radioPlugins;
+    foreach (Device *device, m_configuredDevices) {
+        DevicePlugin *plugin = m_devicePlugins.value(device->pluginId());
+        if (plugin && plugin->requiredHardware().testFlag(HardwareResourceRadio433) && !radioPlugins.contains(plugin)) {
+            radioPlugins.append(plugin);
+        }
+    }
+    foreach (DevicePlugin *plugin, m_discoveringPlugins) {
+        if (plugin->requiredHardware().testFlag(HardwareResourceRadio433) && !radioPlugins.contains(plugin)) {
+            radioPlugins.append(plugin);
+        }
+    }
+
+    QList<Radio433CodeWord::Protocol> protocols;
+    protocols << Radio433CodeWord::ProtocolRaw << Radio433CodeWord::ProtocolTristate48 << Radio433CodeWord::ProtocolPwm64;
+
+    m_radio433Routes.clear();
+    foreach (DevicePlugin *plugin, radioPlugins) {
+        Radio433CodeWord::Protocols pluginProtocols = plugin->radio433Protocols();
+        foreach (Radio433CodeWord::Protocol protocol, protocols) {
+            if (pluginProtocols.testFlag(protocol)) {
+                m_radio433Routes[protocol].append(plugin);
+            }
+        }
+    }
+}
+
+void DeviceManager::updateUpnpNotifyRoutes()
+{
+    // Rebuild the NT/USN -> plugin table, the filters of a plugin may depend on its devices
+    m_upnpNotifyRoutes.clear();
+    m_upnpNotifyPatterns.clear();
+    foreach (DevicePlugin *plugin, m_devicePlugins) {
+        if (!plugin->requiredHardware().testFlag(HardwareResourceUpnpDisovery))
+            continue;
+
+        foreach (const QString &filter, plugin->upnpNotifyFilter()) {
+            if (filter.contains('*') || filter.contains('?') || filter.contains('[')) {
+                m_upnpNotifyPatterns.append(qMakePair(QRegExp(filter, Qt::CaseInsensitive, QRegExp::Wildcard), plugin));
+            } else if (!m_upnpNotifyRoutes.value(filter.toLower().toUtf8()).contains(plugin)) {
+                // NT and USN values are compared case insensitive like the wildcard filters
+                m_upnpNotifyRoutes[filter.toLower().toUtf8()].append(plugin);
+            }
+        }
+    }
 }
 
@@ -23,6 +23,7 @@
 #define DEVICEMANAGER_H
 
 #include "libguh.h"
+#include "changejournal.h"
 
 #include "plugin/deviceclass.h"
 #include "plugin/device.h"
@@ -35,22 +36,32 @@
 #include "network/networkaccessmanager.h"
 #include "network/upnp/upnpdiscovery.h"
 #include "network/upnp/upnpdevicedescriptor.h"
+#include "network/upnp/ssdpmessage.h"
 #include "network/avahi/qtavahiservicebrowser.h"
 
+#include "hardware/radio433/radio433codeword.h"
+
 #ifdef BLUETOOTH_LE
 #include "bluetooth/bluetoothscanner.h"
 #endif
 
 #include <QObject>
 #include <QTimer>
+#include <QRegExp>
 #include <QLocale>
 #include <QPluginLoader>
+#include <QReadWriteLock>
+
+#include <functional>
 
 class Device;
 class DevicePlugin;
+class MetricCounter;
 class DevicePairingInfo;
 class Radio433;
 class UpnpDiscovery;
+class PluginThread;
+class PluginMailbox;
 
 class LIBGUH_EXPORT DeviceManager : public QObject
 {
@@ -109,12 +120,16 @@ public:
     static QStringList pluginSearchDirs();
     static QList<QJsonObject> pluginsMetadata();
 
+    QLocale locale() const;
     void setLocale(const QLocale &locale);
 
     QList<DevicePlugin*> plugins() const;
     DevicePlugin* plugin(const PluginId &id) const;
     DeviceError setPluginConfig(const PluginId &pluginId, const ParamList &pluginConfig);
 
+    int catalogVersion() const;
+    const ChangeJournal &changeJournal() const;
+
     QList<Vendor> supportedVendors() const;
     QList<DeviceClass> supportedDevices(const VendorId &vendorId = VendorId()) const;
     DeviceError discoverDevices(const DeviceClassId &deviceClassId, const ParamList &params);
@@ -174,12 +189,12 @@ private slots:
     // Only connect this to Devices. It will query the sender()
     void slotDeviceStateValueChanged(const QUuid &stateTypeId, const QVariant &value);
 
-    void radio433SignalReceived(QList<int> rawData);
+    void radio433SignalReceived(const QList<int> &rawData);
 
     void replyReady(const PluginId &pluginId, QNetworkReply *reply);
 
     void upnpDiscoveryFinished(const QList<UpnpDeviceDescriptor> &deviceDescriptorList, const PluginId &pluginId);
-    void upnpNotifyReceived(const QByteArray &notifyData);
+    void upnpNotifyReceived(const SsdpMessage &notification);
 
     #ifdef BLUETOOTH_LE
     void bluetoothDiscoveryFinished(const PluginId &pluginId, const QList<QBluetoothDeviceInfo> &deviceInfos);
@@ -189,26 +204,51 @@ private slots:
 
 private:
     bool verifyPluginMetadata(const QJsonObject &data);
+    bool createsAutoDevices(const QJsonObject &metaData);
+    DevicePlugin *loadPluginLibrary(const QString &fileName);
+    DevicePlugin *activatePlugin(const PluginId &pluginId);
+    void connectPlugin(DevicePlugin *plugin);
+    void assignPluginThread(DevicePlugin *plugin);
+    bool isThreaded(DevicePlugin *plugin) const;
+    void callPlugin(DevicePlugin *plugin, const char *entry, const std::function<void()> &call);
     DeviceError addConfiguredDeviceInternal(const DeviceClassId &deviceClassId, const QString &name, const ParamList &params, const DeviceId id = DeviceId::createDeviceId());
     DeviceSetupStatus setupDevice(Device *device);
+    DeviceSetupStatus setupDeviceInPlugin(DevicePlugin *plugin, Device *device);
+    void appendConfiguredDevice(Device *device);
     void postSetupDevice(Device *device);
+    void updateHardwareRoutes();
+    void updateRadio433Routes();
+    void updateUpnpNotifyRoutes();
 
 private:
     QLocale m_locale;
+    int m_catalogVersion;
     QHash<VendorId, Vendor> m_supportedVendors;
     QHash<VendorId, QList<DeviceClassId> > m_vendorDeviceMap;
     QHash<DeviceClassId, DeviceClass> m_supportedDevices;
     QList<Device *> m_configuredDevices;
+    mutable QReadWriteLock m_devicesLock;
+    ChangeJournal m_changeJournal;
     QHash<DeviceDescriptorId, DeviceDescriptor> m_discoveredDevices;
 
     QHash<PluginId, DevicePlugin*> m_devicePlugins;
+    QHash<PluginId, QString> m_inactivePlugins;
+    QHash<PluginId, MetricCounter *> m_eventMetrics;
+    PluginMailbox *m_mailbox;
+    QHash<QString, PluginThread *> m_pluginThreads;
+    QHash<PluginId, PluginThread *> m_threadedPlugins;
+    QList<Device *> m_pendingPostSetups;
+    QList<DeviceId> m_abandonedSetups;
 
     // Hardware Resources
     Radio433* m_radio433;
+    QHash<Radio433CodeWord::Protocol, QList<DevicePlugin *> > m_radio433Routes;
     QTimer m_pluginTimer;
     QList<DevicePlugin *> m_pluginTimerUsers;
     NetworkAccessManager *m_networkManager;
     UpnpDiscovery* m_upnpDiscovery;
+    QHash<QByteArray, QList<DevicePlugin *> > m_upnpNotifyRoutes;
+    QList<QPair<QRegExp, DevicePlugin *> > m_upnpNotifyPatterns;
     QtAvahiServiceBrowser *m_avahiBrowser;
 
     #ifdef BLUETOOTH_LE
@@ -224,5 +264,6 @@ private:
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(DeviceManager::HardwareResources)
 Q_DECLARE_METATYPE(DeviceManager::DeviceError)
+Q_DECLARE_METATYPE(DeviceManager::DeviceSetupStatus)
 
 #endif // DEVICEMANAGER_H
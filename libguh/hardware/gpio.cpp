@@ -129,14 +129,18 @@
 
 #include <QDebug>
 
+static QString s_sysfsDirectory = "/sys/class/gpio";
+
 /*! Constructs a \l{Gpio} object to represent a GPIO with the given \a gpio number and \a parent. */
 Gpio::Gpio(const int &gpio, QObject *parent) :
     QObject(parent),
     m_gpio(gpio),
     m_direction(Gpio::DirectionInvalid),
-    m_gpioDirectory(QDir(QString("/sys/class/gpio/gpio%1/").arg(QString::number(gpio))))
+    m_gpioDirectory(QDir(QString("%1/gpio%2/").arg(s_sysfsDirectory).arg(QString::number(gpio)))),
+    m_attributes(m_gpioDirectory.path())
 {
-    m_direction = direction();
+    if (m_gpioDirectory.exists())
+        m_direction = direction();
 }
 
 /*! Destroys and unexports the \l{Gpio}. */
@@ -161,7 +165,20 @@ int Gpio::gpioNumber() const
 /*! Returns true if the directories \tt {/sys/class/gpio} and \tt {/sys/class/gpio/export} do exist. */
 bool Gpio::isAvailable()
 {
-    return QFile("/sys/class/gpio/export").exists();
+    return QFile(s_sysfsDirectory + "/export").exists();
+}
+
+/*! Returns the sysfs GPIO directory. By default this is \tt {/sys/class/gpio}. */
+QString Gpio::sysfsDirectory()
+{
+    return s_sysfsDirectory;
+}
+
+/*! Sets the sysfs GPIO \a directory. This allows to run GPIO based code against a fake sysfs tree.
+ *  Only \l{Gpio}{Gpios} created afterwards will use the new directory. */
+void Gpio::setSysfsDirectory(const QString &directory)
+{
+    s_sysfsDirectory = directory;
 }
 
 /*! Returns true if this \l{Gpio} could be exported in the system file \tt {/sys/class/gpio/export}. If this Gpio is already exported, this function will return true. */
@@ -171,30 +188,22 @@ bool Gpio::exportGpio()
     if (m_gpioDirectory.exists())
         return true;
 
-    QFile exportFile("/sys/class/gpio/export");
-    if (!exportFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qCWarning(dcHardware()) << "Gpio: Could not open GPIO export file:" << exportFile.errorString();
+    if (!SysfsAttributes::writeFile(s_sysfsDirectory + "/export", QByteArray::number(m_gpio))) {
+        qCWarning(dcHardware()) << "Gpio: Could not export GPIO" << m_gpio;
         return false;
     }
-
-    QTextStream out(&exportFile);
-    out << m_gpio;
-    exportFile.close();
     return true;
 }
 
 /*! Returns true if this \l{Gpio} could be unexported in the system file \tt {/sys/class/gpio/unexport}. */
 bool Gpio::unexportGpio()
 {
-    QFile unexportFile("/sys/class/gpio/unexport");
-    if (!unexportFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qCWarning(dcHardware()) << "Gpio: Could not open GPIO unexport file:" << unexportFile.errorString();
+    m_attributes.close();
+
+    if (!SysfsAttributes::writeFile(s_sysfsDirectory + "/unexport", QByteArray::number(m_gpio))) {
+        qCWarning(dcHardware()) << "Gpio: Could not unexport GPIO" << m_gpio;
         return false;
     }
-
-    QTextStream out(&unexportFile);
-    out << m_gpio;
-    unexportFile.close();
     return true;
 }
 
@@ -206,44 +215,19 @@ bool Gpio::setDirection(Gpio::Direction direction)
         return false;
     }
 
-    QFile directionFile(m_gpioDirectory.path() + "/direction");
-    if (!directionFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qCWarning(dcHardware()) << "Gpio: Could not open GPIO" << m_gpio << "direction file:" << directionFile.errorString();
+    if (!m_attributes.write("direction", direction == DirectionInput ? "in" : "out")) {
+        qCWarning(dcHardware()) << "Gpio: Could not set direction of GPIO" << m_gpio;
         return false;
     }
 
     m_direction = direction;
-
-    QTextStream out(&directionFile);
-    switch (m_direction) {
-    case DirectionInput:
-        out << "in";
-        break;
-    case DirectionOutput:
-        out << "out";
-        break;
-    default:
-        break;
-    }
-
-    directionFile.close();
     return true;
 }
 
 /*! Returns the direction of this \l{Gpio}. */
 Gpio::Direction Gpio::direction()
 {
-    QFile directionFile(m_gpioDirectory.path() + "/direction");
-    if (!directionFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qCWarning(dcHardware()) << "Gpio: Could not open GPIO" << m_gpio << "direction file:" << directionFile.errorString();
-        return Gpio::DirectionInvalid;
-    }
-
-    QString direction;
-    QTextStream in(&directionFile);
-    in >> direction;
-    directionFile.close();
-
+    QByteArray direction = m_attributes.read("direction");
     if (direction == "in") {
         m_direction = DirectionInput;
         return Gpio::DirectionInput;
@@ -275,43 +259,13 @@ bool Gpio::setValue(Gpio::Value value)
         return false;
     }
 
-    QFile valueFile(m_gpioDirectory.path() + "/value");
-    if (!valueFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qCWarning(dcHardware()) << "Gpio: Could not open GPIO" << m_gpio << "value file:" << valueFile.errorString();
-        return false;
-    }
-
-    QTextStream out(&valueFile);
-    switch (value) {
-    case ValueLow:
-        out << "0";
-        break;
-    case ValueHigh:
-        out << "1";
-        break;
-    default:
-        valueFile.close();
-        return false;
-    }
-
-    valueFile.close();
-    return true;
+    return m_attributes.write("value", value == ValueHigh ? "1" : "0");
 }
 
 /*! Returns the current digital value of this \l{Gpio}. */
 Gpio::Value Gpio::value()
 {
-    QFile valueFile(m_gpioDirectory.path() + "/value");
-    if (!valueFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qCWarning(dcHardware()) << "Gpio: Could not open GPIO" << m_gpio << "value file:" << valueFile.errorString();
-        return Gpio::ValueInvalid;
-    }
-
-    QString value;
-    QTextStream in(&valueFile);
-    in >> value;
-    valueFile.close();
-
+    QByteArray value = m_attributes.read("value");
     if (value == "0") {
         return Gpio::ValueLow;
     } else if (value == "1") {
@@ -324,41 +278,13 @@ Gpio::Value Gpio::value()
 /*! This method allows to invert the logic of this \l{Gpio}. Returns true, if the GPIO could be set \a activeLow. */
 bool Gpio::setActiveLow(bool activeLow)
 {
-    QFile activeLowFile(m_gpioDirectory.path() + "/active_low");
-    if (!activeLowFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qCWarning(dcHardware()) << "Gpio: Could not open GPIO" << m_gpio << "active_low file:" << activeLowFile.errorString();
-        return false;
-    }
-
-    QTextStream out(&activeLowFile);
-    if (activeLow) {
-        out << "0";
-    } else {
-        out << "1";
-    }
-
-    activeLowFile.close();
-    return true;
+    return m_attributes.write("active_low", activeLow ? "0" : "1");
 }
 
 /*! Returns true if the logic of this \l{Gpio} is inverted (1 = low, 0 = high). */
 bool Gpio::activeLow()
 {
-    QFile activeLowFile(m_gpioDirectory.path() + "/active_low");
-    if (!activeLowFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qCWarning(dcHardware()) << "Gpio: Could not open GPIO" << m_gpio << "active_low file:" << activeLowFile.errorString();
-        return false;
-    }
-
-    QString value;
-    QTextStream in(&activeLowFile);
-    in >> value;
-    activeLowFile.close();
-
-    if (value == "0")
-        return true;
-
-    return false;
+    return m_attributes.read("active_low") == "0";
 }
 
 /*! Returns true if the \a edge of this GPIO could be set correctly. The \a edge parameter specifies,
@@ -370,48 +296,26 @@ bool Gpio::setEdgeInterrupt(Gpio::Edge edge)
         return false;
     }
 
-    QFile edgeFile(m_gpioDirectory.path() + "/edge");
-    if (!edgeFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qCWarning(dcHardware()) << "Gpio: Could not open GPIO" << m_gpio << "edge file:" << edgeFile.errorString();
-        return false;
-    }
-
-    QTextStream out(&edgeFile);
     switch (edge) {
     case EdgeFalling:
-        out << "falling";
-        break;
+        return m_attributes.write("edge", "falling");
     case EdgeRising:
-        out << "rising";
-        break;
+        return m_attributes.write("edge", "rising");
     case EdgeBoth:
-        out << "both";
-        break;
+        return m_attributes.write("edge", "both");
     case EdgeNone:
-        out << "none";
-        break;
+        return m_attributes.write("edge", "none");
     default:
-        return false;
+        break;
     }
 
-    edgeFile.close();
-    return true;
+    return false;
 }
 
 /*! Returns the edge interrupt of this \l{Gpio}. */
 Gpio::Edge Gpio::edgeInterrupt()
 {
-    QFile edgeFile(m_gpioDirectory.path() + "/edge");
-    if (!edgeFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qCWarning(dcHardware()) << "Gpio: Could not open GPIO" << m_gpio << "edge file:" << edgeFile.errorString();
-        return Gpio::EdgeNone;
-    }
-
-    QString edge;
-    QTextStream in(&edgeFile);
-    in >> edge;
-    edgeFile.close();
-
+    QByteArray edge = m_attributes.read("edge");
     if (edge.contains("falling")) {
         return Gpio::EdgeFalling;
     } else if (edge.contains("rising")) {
@@ -425,7 +329,13 @@ Gpio::Edge Gpio::edgeInterrupt()
     return Gpio::EdgeNone;
 }
 
-
+/*! Returns the open file descriptor of the value file of this \l{Gpio}, or -1 if the file could not be opened.
+ *  The file descriptor is owned by the Gpio and stays open until the Gpio gets unexported. It can be used to poll
+ *  for edge interrupts or to write edges without any additional overhead. */
+int Gpio::valueFileDescriptor()
+{
+    return m_attributes.fileDescriptor("value");
+}
 
 QDebug operator<<(QDebug debug, Gpio *gpio)
 {
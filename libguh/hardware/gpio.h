@@ -28,6 +28,7 @@
 #include <QTextStream>
 
 #include "libguh.h"
+#include "sysfsattributes.h"
 
 class LIBGUH_EXPORT Gpio : public QObject
 {
@@ -60,6 +61,9 @@ public:
 
     static bool isAvailable();
 
+    static QString sysfsDirectory();
+    static void setSysfsDirectory(const QString &directory);
+
     bool exportGpio();
     bool unexportGpio();
 
@@ -76,10 +80,13 @@ public:
     Gpio::Edge edgeInterrupt();
 
 
+    int valueFileDescriptor();
+
 private:
     int m_gpio;
     Gpio::Direction m_direction;
     QDir m_gpioDirectory;
+    SysfsAttributes m_attributes;
 
 };
 
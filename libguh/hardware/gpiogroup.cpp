@@ -0,0 +1,291 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+  \class GpioGroup
+  \brief The GpioGroup class allows to set and get the values of multiple GPIOs in one call.
+
+  \ingroup hardware
+  \inmodule libguh
+
+  If all GPIOs of the group belong to the same GPIO chip and the kernel provides the GPIO character
+  device (\tt{/dev/gpiochipN}), the lines get requested together and all values are set or read with
+  one single ioctl. Otherwise the group falls back to one sysfs \l{Gpio} per line, which keeps its
+  value file open.
+
+  \code
+    GpioGroup *leds = new GpioGroup(QList<int>() << 17 << 18 << 27, this);
+    if (!leds->enable(Gpio::DirectionOutput)) {
+        qWarning() << "Could not enable GPIOs" << leds->gpioNumbers();
+        return;
+    }
+
+    leds->setValues(QList<Gpio::Value>() << Gpio::ValueHigh << Gpio::ValueLow << Gpio::ValueHigh);
+  \endcode
+
+  \sa Gpio
+*/
+
+#include "gpiogroup.h"
+#include "sysfsattributes.h"
+#include "loggingcategories.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/ioctl.h>
+
+#if defined(__has_include)
+#if __has_include(<linux/gpio.h>)
+#include <linux/gpio.h>
+#endif
+#endif
+
+/*! Constructs a GpioGroup with the given \a parent for the given list of \a gpios numbers. */
+GpioGroup::GpioGroup(const QList<int> &gpios, QObject *parent) :
+    QObject(parent),
+    m_gpioNumbers(gpios),
+    m_direction(Gpio::DirectionInvalid),
+    m_lineHandleFd(-1)
+{
+}
+
+/*! Destroys this GpioGroup and releases all lines. */
+GpioGroup::~GpioGroup()
+{
+    disable();
+}
+
+/*! Returns the GPIO numbers of this group. */
+QList<int> GpioGroup::gpioNumbers() const
+{
+    return m_gpioNumbers;
+}
+
+/*! Returns true if this group has been enabled successfully. */
+bool GpioGroup::isEnabled() const
+{
+    return m_lineHandleFd >= 0 || !m_gpios.isEmpty();
+}
+
+/*! Returns true if the lines of this group are requested over the GPIO character device. */
+bool GpioGroup::usesCharacterDevice() const
+{
+    return m_lineHandleFd >= 0;
+}
+
+/*! Returns true if all GPIOs of this group could be configured with the given \a direction. */
+bool GpioGroup::enable(Gpio::Direction direction)
+{
+    if (direction == Gpio::DirectionInvalid || m_gpioNumbers.isEmpty())
+        return false;
+
+    disable();
+
+    if (requestLines(direction)) {
+        m_direction = direction;
+        return true;
+    }
+
+    // Fallback to sysfs
+    foreach (int gpioNumber, m_gpioNumbers) {
+        Gpio *gpio = new Gpio(gpioNumber, this);
+        m_gpios.append(gpio);
+        if (!gpio->exportGpio() || !gpio->setDirection(direction)) {
+            qCWarning(dcHardware()) << "GpioGroup: Could not configure GPIO" << gpioNumber;
+            disable();
+            return false;
+        }
+    }
+
+    m_direction = direction;
+    return true;
+}
+
+/*! Releases all lines of this group. */
+void GpioGroup::disable()
+{
+    if (m_lineHandleFd >= 0) {
+        close(m_lineHandleFd);
+        m_lineHandleFd = -1;
+    }
+
+    qDeleteAll(m_gpios);
+    m_gpios.clear();
+    m_direction = Gpio::DirectionInvalid;
+}
+
+/*! Returns true if the given \a values could be set. The values have to be in the same order as the \l{gpioNumbers()}. */
+bool GpioGroup::setValues(const QList<Gpio::Value> &values)
+{
+    if (values.count() != m_gpioNumbers.count()) {
+        qCWarning(dcHardware()) << "GpioGroup: Got" << values.count() << "values for" << m_gpioNumbers.count() << "GPIOs.";
+        return false;
+    }
+
+    if (m_direction != Gpio::DirectionOutput) {
+        qCWarning(dcHardware()) << "GpioGroup: Setting the values of input GPIOs is forbidden.";
+        return false;
+    }
+
+    if (values.contains(Gpio::ValueInvalid)) {
+        qCWarning(dcHardware()) << "GpioGroup: Setting an invalid value is forbidden.";
+        return false;
+    }
+
+#ifdef GPIOHANDLE_SET_LINE_VALUES_IOCTL
+    if (m_lineHandleFd >= 0) {
+        struct gpiohandle_data data;
+        memset(&data, 0, sizeof(data));
+        for (int i = 0; i < values.count(); i++)
+            data.values[i] = values.at(i) == Gpio::ValueHigh ? 1 : 0;
+
+        if (ioctl(m_lineHandleFd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0) {
+            qCWarning(dcHardware()) << "GpioGroup: Could not set line values:" << strerror(errno);
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    bool success = !m_gpios.isEmpty();
+    for (int i = 0; i < m_gpios.count(); i++) {
+        if (!m_gpios.at(i)->setValue(values.at(i)))
+            success = false;
+    }
+    return success;
+}
+
+/*! Returns the current values of all GPIOs of this group in the same order as the \l{gpioNumbers()}. */
+QList<Gpio::Value> GpioGroup::values()
+{
+    QList<Gpio::Value> values;
+
+#ifdef GPIOHANDLE_GET_LINE_VALUES_IOCTL
+    if (m_lineHandleFd >= 0) {
+        struct gpiohandle_data data;
+        memset(&data, 0, sizeof(data));
+        if (ioctl(m_lineHandleFd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data) < 0) {
+            qCWarning(dcHardware()) << "GpioGroup: Could not get line values:" << strerror(errno);
+            for (int i = 0; i < m_gpioNumbers.count(); i++)
+                values.append(Gpio::ValueInvalid);
+
+            return values;
+        }
+
+        for (int i = 0; i < m_gpioNumbers.count(); i++)
+            values.append(data.values[i] ? Gpio::ValueHigh : Gpio::ValueLow);
+
+        return values;
+    }
+#endif
+
+    foreach (Gpio *gpio, m_gpios) {
+        values.append(gpio->value());
+    }
+    return values;
+}
+
+QString GpioGroup::findCharacterDevice(QList<int> *lineOffsets) const
+{
+    QDir sysfsDirectory(Gpio::sysfsDirectory());
+    foreach (const QString &chipName, sysfsDirectory.entryList(QStringList() << "gpiochip*", QDir::Dirs | QDir::NoDotAndDotDot)) {
+        QString chipPath = sysfsDirectory.absoluteFilePath(chipName);
+
+        bool baseOk = false;
+        bool countOk = false;
+        int base = SysfsAttributes::readFile(chipPath + "/base").toInt(&baseOk);
+        int count = SysfsAttributes::readFile(chipPath + "/ngpio").toInt(&countOk);
+        if (!baseOk || !countOk)
+            continue;
+
+        bool allLinesOnChip = true;
+        foreach (int gpioNumber, m_gpioNumbers) {
+            if (gpioNumber < base || gpioNumber >= base + count) {
+                allLinesOnChip = false;
+                break;
+            }
+        }
+
+        if (!allLinesOnChip)
+            continue;
+
+        // The name of the character device is listed in the parent device of the chip
+        QStringList deviceNames = QDir(chipPath + "/device").entryList(QStringList() << "gpiochip*", QDir::Dirs | QDir::NoDotAndDotDot);
+        if (deviceNames.isEmpty())
+            return QString();
+
+        QString devicePath = "/dev/" + deviceNames.first();
+        if (!QFileInfo(devicePath).exists())
+            return QString();
+
+        lineOffsets->clear();
+        foreach (int gpioNumber, m_gpioNumbers) {
+            lineOffsets->append(gpioNumber - base);
+        }
+        return devicePath;
+    }
+
+    return QString();
+}
+
+bool GpioGroup::requestLines(Gpio::Direction direction)
+{
+#ifdef GPIO_GET_LINEHANDLE_IOCTL
+    QList<int> lineOffsets;
+    QString devicePath = findCharacterDevice(&lineOffsets);
+    if (devicePath.isEmpty() || lineOffsets.count() > GPIOHANDLES_MAX)
+        return false;
+
+    int chipFd = open(devicePath.toLocal8Bit().constData(), O_RDWR | O_CLOEXEC);
+    if (chipFd < 0) {
+        qCDebug(dcHardware()) << "GpioGroup: Could not open" << devicePath << ":" << strerror(errno);
+        return false;
+    }
+
+    struct gpiohandle_request request;
+    memset(&request, 0, sizeof(request));
+    for (int i = 0; i < lineOffsets.count(); i++)
+        request.lineoffsets[i] = lineOffsets.at(i);
+
+    request.lines = lineOffsets.count();
+    request.flags = (direction == Gpio::DirectionInput) ? GPIOHANDLE_REQUEST_INPUT : GPIOHANDLE_REQUEST_OUTPUT;
+    strncpy(request.consumer_label, "guhd", sizeof(request.consumer_label) - 1);
+
+    int result = ioctl(chipFd, GPIO_GET_LINEHANDLE_IOCTL, &request);
+    close(chipFd);
+
+    if (result < 0) {
+        // The lines might be exported over sysfs already
+        qCDebug(dcHardware()) << "GpioGroup: Could not request lines from" << devicePath << ":" << strerror(errno);
+        return false;
+    }
+
+    m_lineHandleFd = request.fd;
+    return true;
+#else
+    Q_UNUSED(direction)
+    return false;
+#endif
+}
@@ -0,0 +1,57 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GPIOGROUP_H
+#define GPIOGROUP_H
+
+#include <QObject>
+#include <QList>
+
+#include "libguh.h"
+#include "gpio.h"
+
+class LIBGUH_EXPORT GpioGroup : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GpioGroup(const QList<int> &gpios, QObject *parent = 0);
+    ~GpioGroup();
+
+    QList<int> gpioNumbers() const;
+    bool isEnabled() const;
+    bool usesCharacterDevice() const;
+
+    bool enable(Gpio::Direction direction);
+    void disable();
+
+    bool setValues(const QList<Gpio::Value> &values);
+    QList<Gpio::Value> values();
+
+private:
+    QList<int> m_gpioNumbers;
+    QList<Gpio *> m_gpios;
+    Gpio::Direction m_direction;
+    int m_lineHandleFd;
+
+    QString findCharacterDevice(QList<int> *lineOffsets) const;
+    bool requestLines(Gpio::Direction direction);
+};
+
+#endif // GPIOGROUP_H
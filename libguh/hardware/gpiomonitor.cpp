@@ -75,9 +75,11 @@
 /*! Constructs a \l{GpioMonitor} object with the given \a gpio number and \a parent. */
 GpioMonitor::GpioMonitor(int gpio, QObject *parent) :
     QObject(parent),
-    m_gpioNumber(gpio)
+    m_gpioNumber(gpio),
+    m_gpio(0),
+    m_notifier(0),
+    m_currentValue(false)
 {
-    m_valueFile.setFileName("/sys/class/gpio/gpio" + QString::number(m_gpioNumber) + "/value");
 }
 
 /*! Returns true if this \l{GpioMonitor} could be enabled successfully. With the \a activeLow parameter the values can be inverted.
@@ -96,12 +98,14 @@ bool GpioMonitor::enable(bool activeLow, Gpio::Edge edgeInterrupt)
         return false;
     }
 
-    if (!m_valueFile.open(QFile::ReadOnly)) {
+    // The value file stays open in the Gpio, reading the value through it acknowledges the interrupt
+    int valueFd = m_gpio->valueFileDescriptor();
+    if (valueFd < 0) {
         qWarning(dcHardware()) << "GpioMonitor: Could not open value file for gpio monitor" << m_gpio->gpioNumber();
         return false;
     }
 
-    m_notifier = new QSocketNotifier(m_valueFile.handle(), QSocketNotifier::Exception);
+    m_notifier = new QSocketNotifier(valueFd, QSocketNotifier::Exception);
     connect(m_notifier, &QSocketNotifier::activated, this, &GpioMonitor::readyReady);
 
     m_notifier->setEnabled(true);
@@ -116,8 +120,6 @@ void GpioMonitor::disable()
 
     m_notifier = 0;
     m_gpio = 0;
-
-    m_valueFile.close();
 }
 
 /*! Returns true if this \l{GpioMonitor} is running. */
@@ -145,15 +147,15 @@ void GpioMonitor::readyReady(const int &ready)
 {
     Q_UNUSED(ready)
 
-    m_valueFile.seek(0);
-    QByteArray data = m_valueFile.readAll();
-
     bool value = false;
-    if (data[0] == '1') {
+    switch (m_gpio->value()) {
+    case Gpio::ValueHigh:
         value = true;
-    } else if (data[0] == '0') {
+        break;
+    case Gpio::ValueLow:
         value = false;
-    } else {
+        break;
+    default:
         return;
     }
 
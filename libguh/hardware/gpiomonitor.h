@@ -48,7 +48,6 @@ private:
     int m_gpioNumber;
     Gpio *m_gpio;
     QSocketNotifier *m_notifier;
-    QFile m_valueFile;
     bool m_currentValue;
 
 signals:
@@ -21,13 +21,16 @@
 #include "pwm.h"
 #include "loggingcategories.h"
 
+static QString s_sysfsDirectory = "/sys/class/pwm";
+
 Pwm::Pwm(int chipNumber, QObject *parent) :
     QObject(parent),
     m_chipNumber(chipNumber),
     m_period(0),
     m_dutyCycle(0)
 {
-    m_pwmDirectory = QDir("/sys/class/pwm/pwmchip" + QString::number(chipNumber) + "/");
+    m_pwmDirectory = QDir(s_sysfsDirectory + "/pwmchip" + QString::number(chipNumber) + "/");
+    m_attributes.setDirectory(m_pwmDirectory.path() + "/pwm0");
 }
 
 Pwm::~Pwm()
@@ -37,68 +40,50 @@ Pwm::~Pwm()
 
 bool Pwm::isAvailable()
 {
-    QDir pwmDirectory("/sys/class/pwm");
-    return pwmDirectory.exists() && !pwmDirectory.entryList().isEmpty();
+    QDir pwmDirectory(s_sysfsDirectory);
+    return pwmDirectory.exists() && !pwmDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot).isEmpty();
+}
+
+QString Pwm::sysfsDirectory()
+{
+    return s_sysfsDirectory;
+}
+
+void Pwm::setSysfsDirectory(const QString &directory)
+{
+    s_sysfsDirectory = directory;
 }
 
 bool Pwm::exportPwm()
 {
-    QFile exportFile(m_pwmDirectory.path() + "/export");
-    if (!exportFile.open(QIODevice::WriteOnly)) {
+    if (!SysfsAttributes::writeFile(m_pwmDirectory.path() + "/export", "0")) {
         qCWarning(dcHardware()) << "ERROR: could not export PWM" << m_chipNumber;
         return false;
     }
-
-    QTextStream out(&exportFile);
-    out << 0;
-    exportFile.close();
     return true;
 }
 
 bool Pwm::enable()
 {
-    QFile enableFile(m_pwmDirectory.path() + "/pwm0/enable");
-    if (!enableFile.open(QIODevice::WriteOnly)) {
+    if (!m_attributes.write("enable", "1")) {
         qCWarning(dcHardware()) << "ERROR: could not enable PWM" << m_chipNumber;
         return false;
     }
-
-    QTextStream out(&enableFile);
-    out << 1;
-    enableFile.close();
     return true;
 }
 
 bool Pwm::disable()
 {
-    QFile enableFile(m_pwmDirectory.path() + "/pwm0/enable");
-    if (!enableFile.open(QIODevice::WriteOnly)) {
+    if (!m_attributes.write("enable", "0")) {
         qCWarning(dcHardware()) << "ERROR: could not disable PWM" << m_chipNumber;
         return false;
     }
-
-    QTextStream out(&enableFile);
-    out << 0;
-    enableFile.close();
     return true;
 }
 
 bool Pwm::isEnabled()
 {
-    QFile enableFile(m_pwmDirectory.path() + "/pwm0/enable");
-    if (!enableFile.open(QIODevice::ReadOnly)) {
-        qCWarning(dcHardware()) << "ERROR: could not read" << enableFile.fileName();
-        return false;
-    }
-    QString value;
-    QTextStream in(&enableFile);
-    in >> value;
-    enableFile.close();
-
-    if (value == "1")
-        return true;
-
-    return false;
+    return m_attributes.read("enable") == "1";
 }
 
 int Pwm::chipNumber()
@@ -109,17 +94,7 @@ int Pwm::chipNumber()
 long Pwm::period()
 {
     // period = active + inactive time
-    QFile periodFile(m_pwmDirectory.path() + "/pwm0/period");
-    if (!periodFile.open(QIODevice::ReadOnly)) {
-        qCWarning(dcHardware()) << "ERROR: could not open" << periodFile.fileName();
-        return false;
-    }
-
-    QString value;
-    QTextStream in(&periodFile);
-    in >> value;
-    periodFile.close();
-    m_period = value.toLong();
+    m_period = m_attributes.read("period").toLong();
     return m_period;
 }
 
@@ -130,14 +105,9 @@ bool Pwm::setPeriod(long nanoSeconds)
         return false;
 
     // period = active + inactive time
-    QFile periodFile(m_pwmDirectory.path() + "/pwm0/period");
-    if (!periodFile.open(QIODevice::WriteOnly)) {
-        qCWarning(dcHardware()) << "ERROR: could not open" << periodFile.fileName();
+    if (!m_attributes.write("period", QByteArray::number((qlonglong)nanoSeconds)))
         return false;
-    }
-    QTextStream out(&periodFile);
-    out << QString::number(nanoSeconds);
-    periodFile.close();
+
     m_period = nanoSeconds;
     return true;
 }
@@ -157,17 +127,7 @@ bool Pwm::setFrequency(double kHz)
 // active time
 long Pwm::dutyCycle()
 {
-    QFile dutyCycleFile(m_pwmDirectory.path() + "/pwm0/duty_cycle");
-    if (!dutyCycleFile.open(QIODevice::ReadOnly)) {
-        qCWarning(dcHardware()) << "ERROR: could not open" << dutyCycleFile.fileName();
-        return false;
-    }
-
-    QString value;
-    QTextStream in(&dutyCycleFile);
-    in >> value;
-    dutyCycleFile.close();
-    m_dutyCycle = value.toLong();
+    m_dutyCycle = m_attributes.read("duty_cycle").toLong();
     return m_dutyCycle;
 }
 
@@ -179,31 +139,16 @@ bool Pwm::setDutyCycle(long nanoSeconds)
         return false;
     }
 
-    QFile dutyCycleFile(m_pwmDirectory.path() + "/pwm0/duty_cycle");
-    if (!dutyCycleFile.open(QIODevice::WriteOnly)) {
-        qCWarning(dcHardware()) << "ERROR: could not open" << dutyCycleFile.fileName();
+    if (!m_attributes.write("duty_cycle", QByteArray::number((qlonglong)nanoSeconds)))
         return false;
-    }
-    QTextStream out(&dutyCycleFile);
-    out << QString::number(nanoSeconds);
-    dutyCycleFile.close();
+
     m_dutyCycle = nanoSeconds;
     return true;
 }
 
 Pwm::Polarity Pwm::polarity()
 {
-    QFile polarityFile(m_pwmDirectory.path() + "/pwm0/polarity");
-    if (!polarityFile.open(QIODevice::ReadOnly)) {
-        qCWarning(dcHardware()) << "ERROR: could not open" << polarityFile.fileName();
-        return PolarityInvalid;
-    }
-
-    QString value;
-    QTextStream in(&polarityFile);
-    in >> value;
-    polarityFile.close();
-
+    QByteArray value = m_attributes.read("polarity");
     if (value == "normal") {
         return PolarityNormal;
     } else if(value == "inversed") {
@@ -223,24 +168,8 @@ bool Pwm::setPolarity(Pwm::Polarity polarity)
     if (wasEnabled && !disable())
         return false;
 
-    QFile polarityFile(m_pwmDirectory.path() + "/pwm0/polarity");
-    if (!polarityFile.open(QIODevice::WriteOnly)) {
-        qCWarning(dcHardware()) << "ERROR: could not open" << polarityFile.fileName();
+    if (!m_attributes.write("polarity", polarity == PolarityNormal ? "normal" : "inversed"))
         return false;
-    }
-
-    QTextStream out(&polarityFile);
-    switch (polarity) {
-    case PolarityNormal:
-        out << "normal";
-        break;
-    case PolarityInversed:
-        out << "inversed";
-        break;
-    default:
-        break;
-    }
-    polarityFile.close();
 
     if (wasEnabled)
         enable();
@@ -261,15 +190,12 @@ bool Pwm::setPercentage(int percentage)
 
 bool Pwm::unexportPwm()
 {
-    QFile unexportFile(m_pwmDirectory.path() + "/unexport");
-    if (!unexportFile.open(QIODevice::WriteOnly)) {
+    m_attributes.close();
+
+    if (!SysfsAttributes::writeFile(m_pwmDirectory.path() + "/unexport", "0")) {
         qCWarning(dcHardware()) << "ERROR: could not unexport PWM" << m_chipNumber;
         return false;
     }
-
-    QTextStream out(&unexportFile);
-    out << 0;
-    unexportFile.close();
     return true;
 }
 
@@ -27,6 +27,7 @@
 #include <QDir>
 
 #include "libguh.h"
+#include "sysfsattributes.h"
 
 /* i.MX6 PWMs
  *
@@ -70,6 +71,9 @@ public:
 
     static bool isAvailable();
 
+    static QString sysfsDirectory();
+    static void setSysfsDirectory(const QString &directory);
+
     bool exportPwm();
 
     bool enable();
@@ -99,6 +103,7 @@ private:
     long m_period;
     long m_dutyCycle;
     QDir m_pwmDirectory;
+    SysfsAttributes m_attributes;
 
     bool unexportPwm();
 };
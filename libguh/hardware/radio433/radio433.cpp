@@ -44,6 +44,11 @@
 
 */
 
+/*! \fn void Radio433::dataReceived(const QList<int> &rawData);
+    This signal is emitted whenever a complete 433 MHz frame with the given \a rawData timings was received.
+    The \l{DeviceManager} decodes the frame once into a \l{Radio433CodeWord} and routes it to the interested \l{DevicePlugin}{DevicePlugins}.
+*/
+
 
 #include "radio433.h"
 #include "loggingcategories.h"
@@ -61,9 +66,17 @@ Radio433::Radio433(QObject *parent) :
     qCDebug(dcHardware) << "Loading GPIO settings from:" << settings.fileName();
     settings.beginGroup("GPIO");
     int transmitterGpioNumber = settings.value("rf433tx",22).toInt();
+    int transmitterPriority = settings.value("rf433txpriority", 0).toInt();
+    int receiverGpioNumber = settings.value("rf433rx", 27).toInt();
     settings.endGroup();
 
     m_transmitter = new Radio433Trasmitter(this, transmitterGpioNumber);
+    m_transmitter->setRealtimePriority(transmitterPriority);
+
+    // the receiver emits from its own thread
+    qRegisterMetaType<QList<int> >();
+    m_receiver = new Radio433Receiver(this, receiverGpioNumber);
+    connect(m_receiver, &Radio433Receiver::dataReceived, this, &Radio433::dataReceived, Qt::QueuedConnection);
     #endif
 
     m_brennenstuhlTransmitter = new Radio433BrennenstuhlGateway(this);
@@ -75,6 +88,8 @@ Radio433::~Radio433()
 {
     #ifdef GPIO433
     m_transmitter->quit();
+    m_receiver->stopReceiver();
+    m_receiver->wait();
     #endif
 }
 
@@ -93,6 +108,10 @@ bool Radio433::enable()
             //qCWarning(dcHardware) << "ERROR: radio 433 MHz transmitter not available on GPIO's";
         }
 
+        // receiving is optional, the transmitter alone keeps the resource usable
+        if (!m_receiver->startReceiver())
+            qCWarning(dcHardware) << "--> Radio 433 MHz receiver not available on GPIO's";
+
         if (!transmitterAvailable) {
             qCWarning(dcHardware) << "--> Radio 433 MHz GPIO's not available.";
             return false;
@@ -25,6 +25,7 @@
 
 #ifdef GPIO433
 #include "radio433transmitter.h"
+#include "radio433receiver.h"
 #endif
 
 #include "libguh.h"
@@ -43,6 +44,7 @@ public:
 private:
     #ifdef GPIO433
     Radio433Trasmitter *m_transmitter;
+    Radio433Receiver *m_receiver;
     #endif
 
     Radio433BrennenstuhlGateway *m_brennenstuhlTransmitter;
@@ -50,6 +52,9 @@ private:
 private slots:
     void brennenstuhlAvailableChanged(const bool &available);
 
+signals:
+    void dataReceived(const QList<int> &rawData);
+
 public slots:
     bool sendData(int delay, QList<int> rawData, int repetitions);
 
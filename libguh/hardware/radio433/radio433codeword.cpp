@@ -0,0 +1,160 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class Radio433CodeWord
+    \brief Holds a decoded 433 MHz code word.
+
+    \ingroup hardware
+    \inmodule libguh
+
+    The \l{DeviceManager} decodes every received 433 MHz frame exactly once into a Radio433CodeWord
+    and delivers it only to the \l{DevicePlugin}{DevicePlugins} which declared the matching
+    \l{Radio433CodeWord::Protocol}{Protocol} in \l{DevicePlugin::radio433Protocols()}.
+
+    \sa DevicePlugin::radioCodeReceived()
+*/
+
+/*! \enum Radio433CodeWord::Protocol
+
+    This enum type specifies the pulse protocol of a received 433 MHz frame.
+
+    \value ProtocolNone
+        The frame could not be decoded.
+    \value ProtocolRaw
+        The undecoded timings of every frame. Plugins declaring this protocol will receive the
+        frame in \l{DevicePlugin::radioData()}.
+    \value ProtocolTristate48
+        One sync pulse (1:31) followed by 24 symbol pairs with a pulse ratio of 1:3 (Intertechno, Elro).
+    \value ProtocolPwm64
+        One sync pulse (1:10) followed by 32 symbol pairs with a pulse ratio of 1:2 (Conrad).
+*/
+
+#include "radio433codeword.h"
+
+/*! Constructs an invalid Radio433CodeWord. */
+Radio433CodeWord::Radio433CodeWord() :
+    m_protocol(ProtocolNone),
+    m_delay(0),
+    m_value(0)
+{
+}
+
+/*! Returns the Radio433CodeWord decoded from the given \a rawData timings. If the timings do not match
+ *  any known \l{Radio433CodeWord::Protocol}{Protocol}, the returned code word is invalid. */
+Radio433CodeWord Radio433CodeWord::decode(const QList<int> &rawData)
+{
+    if (rawData.isEmpty())
+        return Radio433CodeWord();
+
+    // 1 sync + 48 data timings, average delay 314
+    if (rawData.length() == 49) {
+        int delay = rawData.first() / 31;
+        if (delay > 290 && delay < 400)
+            return decodeSymbols(rawData, ProtocolTristate48, delay, 700);
+
+        return Radio433CodeWord();
+    }
+
+    // 1 sync + 64 data timings, average delay 650
+    if (rawData.length() == 65) {
+        int delay = rawData.first() / 10;
+        if (delay > 600 && delay < 750)
+            return decodeSymbols(rawData, ProtocolPwm64, delay, 900);
+
+        return Radio433CodeWord();
+    }
+
+    return Radio433CodeWord();
+}
+
+/*! Returns true if this code word could be decoded. */
+bool Radio433CodeWord::isValid() const
+{
+    return m_protocol != ProtocolNone;
+}
+
+/*! Returns the \l{Radio433CodeWord::Protocol}{Protocol} of this code word. */
+Radio433CodeWord::Protocol Radio433CodeWord::protocol() const
+{
+    return m_protocol;
+}
+
+/*! Returns the base delay [us] measured from the sync pulse of this code word. */
+int Radio433CodeWord::delay() const
+{
+    return m_delay;
+}
+
+/*! Returns the number of bits of this code word. */
+int Radio433CodeWord::bitCount() const
+{
+    return m_binCode.length();
+}
+
+/*! Returns the bits of this code word as integer. The first received bit is the most significant one. */
+quint64 Radio433CodeWord::value() const
+{
+    return m_value;
+}
+
+/*! Returns the bits of this code word as string of '0' and '1' characters. */
+QByteArray Radio433CodeWord::binCode() const
+{
+    return m_binCode;
+}
+
+Radio433CodeWord Radio433CodeWord::decodeSymbols(const QList<int> &rawData, Radio433CodeWord::Protocol protocol, int delay, int threshold)
+{
+    Radio433CodeWord codeWord;
+    codeWord.m_binCode.reserve(rawData.length() / 2);
+
+    // go trough all timings (without sync signal)
+    for (int i = 1; i + 1 < rawData.length(); i += 2) {
+        bool shortPulse = rawData.at(i) <= threshold;
+        bool shortPause = rawData.at(i + 1) < threshold;
+
+        //      _
+        //     | |___   = 0
+        //      ___
+        //     |   |_   = 1
+
+        if (shortPulse && !shortPause) {
+            codeWord.m_binCode.append('0');
+            codeWord.m_value <<= 1;
+        } else if (!shortPulse && shortPause) {
+            codeWord.m_binCode.append('1');
+            codeWord.m_value = (codeWord.m_value << 1) | 1;
+        } else {
+            return Radio433CodeWord();
+        }
+    }
+
+    codeWord.m_protocol = protocol;
+    codeWord.m_delay = delay;
+    return codeWord;
+}
+
+/*! Writes the given \a codeWord to the given \a debug. This method gets used just for debugging. */
+QDebug operator<<(QDebug debug, const Radio433CodeWord &codeWord)
+{
+    debug.nospace() << "Radio433CodeWord(" << codeWord.protocol() << ", delay: " << codeWord.delay() << ", " << codeWord.binCode() << ")";
+    return debug.space();
+}
@@ -0,0 +1,66 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef RADIO433CODEWORD_H
+#define RADIO433CODEWORD_H
+
+#include <QList>
+#include <QDebug>
+#include <QByteArray>
+
+#include "libguh.h"
+
+class LIBGUH_EXPORT Radio433CodeWord
+{
+public:
+    enum Protocol {
+        ProtocolNone = 0x00,
+        ProtocolRaw = 0x01,
+        ProtocolTristate48 = 0x02,
+        ProtocolPwm64 = 0x04
+    };
+    Q_DECLARE_FLAGS(Protocols, Protocol)
+
+    Radio433CodeWord();
+
+    static Radio433CodeWord decode(const QList<int> &rawData);
+
+    bool isValid() const;
+
+    Protocol protocol() const;
+    int delay() const;
+    int bitCount() const;
+
+    quint64 value() const;
+    QByteArray binCode() const;
+
+private:
+    Protocol m_protocol;
+    int m_delay;
+    quint64 m_value;
+    QByteArray m_binCode;
+
+    static Radio433CodeWord decodeSymbols(const QList<int> &rawData, Protocol protocol, int delay, int threshold);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(Radio433CodeWord::Protocols)
+QDebug operator<<(QDebug debug, const Radio433CodeWord &codeWord);
+
+#endif // RADIO433CODEWORD_H
@@ -1,6 +1,6 @@
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  *                                                                         *
- *  Copyright (C) 2015 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
  *                                                                         *
  *  This file is part of guh.                                              *
  *                                                                         *
@@ -18,107 +18,59 @@
  *                                                                         *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
-#include <QFile>
-#include <QFileSystemWatcher>
-#include <QDebug>
-#include <sys/time.h>
+/*!
+  \class Radio433Receiver
+  \brief Receives 433 MHz frames from a receiver connected to a \l{Gpio}.
 
-#include "radio433receiver.h"
-#include "loggingcategories.h"
+  \ingroup hardware
+  \inmodule libguh
 
-Radio433Receiver::Radio433Receiver(QObject *parent, int gpio) :
-    QThread(parent),m_gpioPin(gpio)
-{
-    m_timings.clear();
-    m_available = false;
+  The receiver runs in its own thread and waits for edges on the value file of the \l{Gpio}. The time
+  between two edges gets measured on the monotonic clock and passed to processTiming(). A sync pulse
+  announces the length of the following frame: 1:31 for 48 data timings, 1:10 for 64 data timings.
+  Once a frame is complete, the dataReceived() signal gets emitted with the sync pulse and the data
+  timings. Decoding the frame is left to the \l{DeviceManager}.
 
-    m_mutex.lock();
-    m_enabled = false;
-    m_mutex.unlock();
+  \sa Radio433, Radio433CodeWord
+*/
 
-    connect(this, &Radio433Receiver::timingReady, this, &Radio433Receiver::handleTiming, Qt::DirectConnection);
-}
+/*! \fn void Radio433Receiver::dataReceived(const QList<int> &rawData);
+    This signal is emitted from the receiver thread whenever a complete frame with the given \a rawData timings was received.
+*/
 
-Radio433Receiver::~Radio433Receiver()
-{
-    quit();
-    wait();
-    deleteLater();
-}
+#include "radio433receiver.h"
+#include "loggingcategories.h"
 
-bool Radio433Receiver::stopReceiver()
-{
-    m_mutex.lock();
-    m_enabled = false;
-    m_mutex.unlock();
-    return true;
-}
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
 
-bool Radio433Receiver::available()
+/*! Constructs a Radio433Receiver with the given \a parent for the receiver connected to the given \a gpio number. */
+Radio433Receiver::Radio433Receiver(QObject *parent, int gpio) :
+    QThread(parent),
+    m_gpioPin(gpio),
+    m_gpio(0),
+    m_valueFd(-1),
+    m_enabled(false),
+    m_available(false),
+    m_frameLength(0)
 {
-    return m_available;
 }
 
-void Radio433Receiver::run()
-{
-    struct pollfd fdset[2];
-    int gpio_fd = m_gpio->openGpio();
-    char buf[1];
-
-    bool enabled = true;
-    m_mutex.lock();
-    m_enabled = true;
-    m_mutex.unlock();
-
-    int lastTime = micros();
-    // poll the gpio file, if something changes...emit the signal with the current pulse length
-    while(enabled){
-        memset((void*)fdset, 0, sizeof(fdset));
-        fdset[0].fd = STDIN_FILENO;
-        fdset[0].events = POLLIN;
-
-        fdset[1].fd = gpio_fd;
-        fdset[1].events = POLLPRI;
-        int rc = poll(fdset, 2, 1000);
-
-        if (rc < 0) {
-            qCWarning(dcHardware) << "ERROR: poll failed";
-            return;
-        }
-        if(rc == 0){
-            //timeout
-        }
-        if (fdset[1].revents & POLLPRI){
-            if(read(fdset[1].fd, buf, 1) != 1){
-                qCWarning(dcHardware) << "could not read GPIO";
-            }
-            int currentTime = micros();
-            int duration = currentTime - lastTime;
-            lastTime = currentTime;
-            emit timingReady(duration);
-        }
-
-        m_mutex.lock();
-        enabled = m_enabled;
-        m_mutex.unlock();
-    }
-}
-
-bool Radio433Receiver::setUpGpio()
+/*! Destroys this Radio433Receiver. Stops the receiver thread. */
+Radio433Receiver::~Radio433Receiver()
 {
-    if(!m_gpio){
-        m_gpio = new Gpio(this,m_gpioPin);
-    }
-
-    if(!m_gpio->exportGpio() || !m_gpio->setDirection(INPUT) || !m_gpio->setEdgeInterrupt(EDGE_BOTH)){
-        return false;
-    }
-    return true;
+    stopReceiver();
+    wait();
 }
 
+/*! Returns true if the \l{Gpio} of this receiver could be exported, configured as input with an interrupt on
+ *  both edges and the receiver thread has been started. */
 bool Radio433Receiver::startReceiver()
 {
-    if(!setUpGpio()){
+    if (!setUpGpio()) {
         m_available = false;
         return false;
     }
@@ -132,139 +84,117 @@ bool Radio433Receiver::startReceiver()
     return true;
 }
 
-int Radio433Receiver::micros()
+/*! Stops the receiver thread within one second. Returns true if the receiver was running. */
+bool Radio433Receiver::stopReceiver()
 {
-    struct timeval tv ;
-    int now ;
-    gettimeofday (&tv, NULL) ;
-    now  = (int)tv.tv_sec * (int)1000000 + (int)tv.tv_usec ;
-
-    return (int)(now - m_epochMicro) ;
+    m_mutex.lock();
+    bool enabled = m_enabled;
+    m_enabled = false;
+    m_mutex.unlock();
+    return enabled;
 }
 
-bool Radio433Receiver::valueInTolerance(int value, int correctValue)
+/*! Returns true if the receiver is listening for frames. */
+bool Radio433Receiver::available()
 {
-    // in in range of +- 200 [us] of sollValue return true, eles return false
-    if(value >= (double)correctValue - 200 && value <= (double)correctValue + 200){
-        return true;
-    }
-    return false;
+    return m_available;
 }
 
-bool Radio433Receiver::checkValue(int value)
+/*! Processes one measured pulse \a duration [us]. This gets called from the receiver thread for each edge,
+ *  but can also be used to feed recorded timings into the receiver. */
+void Radio433Receiver::processTiming(int duration)
 {
-    if(valueInTolerance(value,m_pulseProtocolOne) || valueInTolerance(value,2*m_pulseProtocolOne) || valueInTolerance(value,3*m_pulseProtocolOne) || valueInTolerance(value,4*m_pulseProtocolOne) || valueInTolerance(value,8*m_pulseProtocolOne)){
-        return true;
-    }
-    if(valueInTolerance(value,m_pulseProtocolTwo) || valueInTolerance(value,2*m_pulseProtocolTwo) || valueInTolerance(value,3*m_pulseProtocolTwo) || valueInTolerance(value,4*m_pulseProtocolTwo) || valueInTolerance(value,8*m_pulseProtocolTwo)){
-        return true;
+    // too short for any protocol, this is noise
+    if (duration < 60) {
+        m_timings.clear();
+        return;
     }
-    return false;
-}
 
-bool Radio433Receiver::checkValues(Protocol protocol)
-{
-    switch (protocol) {
-    case Protocol48:
-        for(int i = 1; i < m_timings.count(); i++){
-            if(!(valueInTolerance(m_timings.at(i),m_pulseProtocolOne) || valueInTolerance(m_timings.at(i),2*m_pulseProtocolOne) || valueInTolerance(m_timings.at(i),3*m_pulseProtocolOne) || valueInTolerance(m_timings.at(i),4*m_pulseProtocolOne) || valueInTolerance(m_timings.at(i),8*m_pulseProtocolOne))){
-                break;
-            }
-        }
-        return true;
-    case Protocol64:
-        for(int i = 1; i < m_timings.count(); i++){
-            if(!(valueInTolerance(m_timings.at(i),m_pulseProtocolTwo) || valueInTolerance(m_timings.at(i),2*m_pulseProtocolTwo) || valueInTolerance(m_timings.at(i),3*m_pulseProtocolTwo) || valueInTolerance(m_timings.at(i),4*m_pulseProtocolTwo) || valueInTolerance(m_timings.at(i),8*m_pulseProtocolTwo))){
-                break;
-            }
-        }
-        return true;
-    default:
-        break;
+    int length = frameLength(duration);
+    if (length > 0) {
+        // a sync pulse starts a new frame
+        m_timings.clear();
+        m_timings.append(duration);
+        m_frameLength = length;
+        return;
     }
-    return false;
-}
 
-void Radio433Receiver::changeReading(bool reading)
-{
-    if(reading != m_reading){
-        m_reading = reading;
-
-        //TODO: create colission detection
+    if (m_timings.isEmpty())
+        return;
 
-        //emit readingChanged(reading);
+    m_timings.append(duration);
+    if (m_timings.count() == m_frameLength) {
+        emit dataReceived(m_timings);
+        m_timings.clear();
     }
 }
 
-void Radio433Receiver::handleTiming(int duration)
+void Radio433Receiver::run()
 {
-    // to short...
-    if(duration < 60){
-        changeReading(false);
-        m_timings.clear();
-        return;
-    }
-
-    // could by a sync signal...
-    bool sync = false;
-    if(duration > 2400 && duration < 14000){
-        changeReading(false);
-        sync = true;
-    }
+    struct timespec lastEdge;
+    clock_gettime(CLOCK_MONOTONIC, &lastEdge);
 
-    // got sync signal and list is not empty...
-    if(!m_timings.isEmpty() && sync){
-        // 1 sync bit + 48 data bit
-        if(m_timings.count() == 49 && checkValues(Protocol48)){
-            //qCWarning(dcHardware) << "48 bit ->" << m_timings << "\n--------------------------";
-            changeReading(false);
-            emit dataReceived(m_timings);
+    char buffer[8];
+    bool enabled = true;
+    while (enabled) {
+        struct pollfd fdset;
+        memset(&fdset, 0, sizeof(fdset));
+        fdset.fd = m_valueFd;
+        fdset.events = POLLPRI | POLLERR;
+
+        int rc = poll(&fdset, 1, 1000);
+        if (rc < 0 && errno != EINTR) {
+            qCWarning(dcHardware) << "Radio433: Polling the receiver value file failed:" << strerror(errno);
+            return;
         }
 
-        // 1 sync bit + 64 data bit
-        if(m_timings.count() == 65 && checkValues(Protocol64)){
-            //qCWarning(dcHardware) << "64 bit ->" << m_timings << "\n--------------------------";
-            changeReading(false);
-            emit dataReceived(m_timings);
+        if (rc > 0 && (fdset.revents & POLLPRI)) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+
+            // the value has to be read again to acknowledge the interrupt
+            lseek(m_valueFd, 0, SEEK_SET);
+            if (read(m_valueFd, buffer, sizeof(buffer)) <= 0)
+                qCWarning(dcHardware) << "Radio433: Could not read receiver value:" << strerror(errno);
+
+            int duration = (now.tv_sec - lastEdge.tv_sec) * 1000000 + (now.tv_nsec - lastEdge.tv_nsec) / 1000;
+            lastEdge = now;
+            processTiming(duration);
         }
-        m_timings.clear();
-        m_pulseProtocolOne = 0;
-        m_pulseProtocolTwo = 0;
-        changeReading(false);
-    }
 
-    // got sync signal and list is empty...
-    if(m_timings.isEmpty() && sync){
-        m_timings.append(duration);
-        m_pulseProtocolOne = (int)((double)m_timings.first()/31);
-        m_pulseProtocolTwo = (int)((double)m_timings.first()/10);
-        changeReading(false);
-        return;
+        m_mutex.lock();
+        enabled = m_enabled;
+        m_mutex.unlock();
     }
+}
 
-    // list not empty and this is a possible value
-    if(!m_timings.isEmpty() && checkValue(duration)){
-        m_timings.append(duration);
-
-        // check if it could be a signal -> if we have a sync and 15 valid values
-        // set reading true to prevent a collision from own transmitter
-        if(m_timings.count() == 20 && (checkValues(Protocol48) || checkValues(Protocol64))){
-            changeReading(true);
-        }
+bool Radio433Receiver::setUpGpio()
+{
+    if (!m_gpio)
+        m_gpio = new Gpio(m_gpioPin, this);
 
-        // check if we have already a vallid protocol
-        // 1 sync bit + 48 data bit
-        if(m_timings.count() == 49 && checkValues(Protocol48)){
-            //qCWarning(dcHardware) << "48 bit -> " << m_timings << "\n--------------------------";
-            emit dataReceived(m_timings);
-        }
+    if (!m_gpio->exportGpio() || !m_gpio->setDirection(Gpio::DirectionInput) || !m_gpio->setEdgeInterrupt(Gpio::EdgeBoth))
+        return false;
 
-        // 1 sync bit + 64 data bit
-        if(m_timings.count() == 65 && checkValues(Protocol64)){
-            //qCWarning(dcHardware) << "64 bit -> " << m_timings << "\n--------------------------";
-            changeReading(false);
-            emit dataReceived(m_timings);
-            m_timings.clear();
-        }
+    m_valueFd = m_gpio->valueFileDescriptor();
+    if (m_valueFd < 0) {
+        qCWarning(dcHardware) << "Radio433: Could not open receiver value file of" << m_gpio;
+        return false;
     }
+    return true;
+}
+
+int Radio433Receiver::frameLength(int syncDuration)
+{
+    // 1 sync + 48 data timings, delay 290 - 400 us
+    int delay = syncDuration / 31;
+    if (delay > 290 && delay < 400)
+        return 49;
+
+    // 1 sync + 64 data timings, delay 600 - 750 us
+    delay = syncDuration / 10;
+    if (delay > 600 && delay < 750)
+        return 65;
+
+    return 0;
 }
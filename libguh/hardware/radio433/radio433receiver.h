@@ -1,6 +1,6 @@
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
  *                                                                         *
- *  Copyright (C) 2015 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
  *                                                                         *
  *  This file is part of guh.                                              *
  *                                                                         *
@@ -22,9 +22,11 @@
 #define RADIO433RECEIVER_H
 
 #include <QThread>
+#include <QMutex>
+#include <QList>
 
 #include "libguh.h"
-#include "../gpio.h"
+#include "hardware/gpio.h"
 
 class LIBGUH_EXPORT Radio433Receiver : public QThread
 {
@@ -33,50 +35,33 @@ public:
     explicit Radio433Receiver(QObject *parent = 0, int gpio = 27);
     ~Radio433Receiver();
 
-    enum Protocol{
-        Protocol48,
-        Protocol64,
-        ProtocolNone
-    };
-
     bool startReceiver();
     bool stopReceiver();
     bool available();
 
+    void processTiming(int duration);
+
 protected:
     void run() override;
 
 private:
     int m_gpioPin;
     Gpio *m_gpio;
-    unsigned int m_epochMicro;
-
-    unsigned int m_pulseProtocolOne;
-    unsigned int m_pulseProtocolTwo;
-
-    QList<int> m_timings;
+    int m_valueFd;
 
     QMutex m_mutex;
     bool m_enabled;
     bool m_available;
-    bool m_reading;
 
-    bool setUpGpio();
-    int micros();
-    bool valueInTolerance(int value, int correctValue);
-    bool checkValue(int value);
-    bool checkValues(Protocol protocol);
-    void changeReading(bool reading);
+    QList<int> m_timings;
+    int m_frameLength;
 
-private slots:
-    void handleTiming(int duration);
+    bool setUpGpio();
+    static int frameLength(int syncDuration);
 
 signals:
-    void timingReady(int duration);
-    void dataReceived(QList<int> rawData);
-    void readingChanged(const bool &reading);
+    void dataReceived(const QList<int> &rawData);
 
-public slots:
 };
 
 #endif // RADIO433RECEIVER_H
@@ -18,52 +18,155 @@
  *                                                                         *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+/*!
+  \class Radio433Trasmitter
+  \brief Sends 433 MHz frames over a transmitter connected to a \l{Gpio}.
+
+  \ingroup hardware
+  \inmodule libguh
+
+  The transmitter runs in its own thread. The timings of each code get expanded once into a flat
+  edge schedule and are sent with absolute deadlines on the monotonic clock. The thread sleeps with
+  \tt clock_nanosleep until shortly before each edge and spins for the last microseconds, so the
+  jitter stays well below the 300 - 400 us symbols of the common 433 MHz protocols. The value file
+  of the \l{Gpio} stays open as long as the transmitter is available.
+
+  \sa Radio433
+*/
+
 #include "radio433transmitter.h"
+#include "loggingcategories.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+// Sleep until this amount of nano seconds before an edge, spin for the rest
+static const long spinWindow = 80000;
+
+static void addMicroseconds(struct timespec *time, int microSeconds)
+{
+    time->tv_nsec += (long)microSeconds * 1000;
+    while (time->tv_nsec >= 1000000000) {
+        time->tv_nsec -= 1000000000;
+        time->tv_sec++;
+    }
+}
+
+static bool timeReached(const struct timespec &now, const struct timespec &deadline)
+{
+    if (now.tv_sec != deadline.tv_sec)
+        return now.tv_sec > deadline.tv_sec;
+
+    return now.tv_nsec >= deadline.tv_nsec;
+}
 
+/*! Constructs a Radio433Trasmitter with the given \a parent for the transmitter connected to the given \a gpio number. */
 Radio433Trasmitter::Radio433Trasmitter(QObject *parent, int gpio) :
-    QThread(parent),m_gpioPin(gpio)
+    QThread(parent),
+    m_gpioPin(gpio),
+    m_gpio(0),
+    m_valueFd(-1),
+    m_realtimePriority(0),
+    m_enabled(false),
+    m_allowSending(true),
+    m_available(false)
 {
 }
 
+/*! Destroys this Radio433Trasmitter. Waits until all queued frames are sent and closes the value file. */
 Radio433Trasmitter::~Radio433Trasmitter()
 {
     quit();
     wait();
-    deleteLater();
+
+    if (m_valueFd >= 0)
+        close(m_valueFd);
 }
 
+/*! Returns true if the \l{Gpio} of this transmitter could be exported, configured as output and the value file could be opened. */
 bool Radio433Trasmitter::startTransmitter()
 {
     return setUpGpio();
 }
 
+/*! Returns true if the given \a valueFileName could be opened as value file of the transmitter. This allows to
+ *  record the emitted edges with a fake \l{Gpio}, for example a named pipe. */
+bool Radio433Trasmitter::startTransmitter(const QString &valueFileName)
+{
+    m_available = openValueFile(valueFileName);
+    return m_available;
+}
+
+/*! Returns true if the transmitter is ready to send data. */
 bool Radio433Trasmitter::available()
 {
     return m_available;
 }
 
+/*! Sets the real-time (SCHED_FIFO) \a priority of the transmitter thread. A priority of 0 disables the
+ *  real-time scheduling. The priority will be applied on the next transmission. */
+void Radio433Trasmitter::setRealtimePriority(int priority)
+{
+    m_mutex.lock();
+    m_realtimePriority = priority;
+    m_mutex.unlock();
+}
+
+/*! Returns the real-time priority of the transmitter thread. 0 means real-time scheduling is disabled. */
+int Radio433Trasmitter::realtimePriority() const
+{
+    return m_realtimePriority;
+}
+
 void Radio433Trasmitter::run()
 {
-    QList<int> rawData;
+    m_mutex.lock();
+    int priority = m_realtimePriority;
+    m_mutex.unlock();
+
+    if (priority > 0) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = priority;
+        int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (error != 0) {
+            qCWarning(dcHardware) << "Radio433: Could not set real-time priority" << priority << "for transmitter:" << strerror(error);
+        }
+    }
+
+    Transmission transmission;
 
     m_queueMutex.lock();
-    while(!m_rawDataQueue.isEmpty()){
+    while (!m_transmissionQueue.isEmpty()) {
 
-        rawData = m_rawDataQueue.dequeue();
+        transmission = m_transmissionQueue.dequeue();
         m_queueMutex.unlock();
 
-        m_gpio->setValue(Gpio::ValueLow);
-        int flag=1;
+        writeValue(false);
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
 
-        foreach (int delay, rawData) {
-            // 1 = High, 0 = Low
-            int value = flag %2;
-            m_gpio->setValue((Gpio::Value)value);
-            flag++;
-            usleep(delay);
+        // 1 = High, 0 = Low
+        bool high = true;
+        const int *timings = transmission.timings.constData();
+        const int count = transmission.timings.count();
+        for (int repetition = 0; repetition < transmission.repetitions; repetition++) {
+            for (int i = 0; i < count; i++) {
+                writeValue(high);
+                high = !high;
+                addMicroseconds(&deadline, timings[i]);
+                waitUntil(deadline);
+            }
         }
 
-        m_gpio->setValue(Gpio::ValueLow);
+        writeValue(false);
+
+        m_queueMutex.lock();
     }
     m_queueMutex.unlock();
 }
@@ -77,30 +180,77 @@ void Radio433Trasmitter::allowSending(bool sending)
 
 bool Radio433Trasmitter::setUpGpio()
 {
-    m_gpio = new Gpio(m_gpioPin, this);
+    if (!m_gpio)
+        m_gpio = new Gpio(m_gpioPin, this);
 
-    if(!m_gpio->exportGpio() || !m_gpio->setDirection(Gpio::DirectionOutput) || !m_gpio->setValue(Gpio::ValueLow)){
+    if (!m_gpio->exportGpio() || !m_gpio->setDirection(Gpio::DirectionOutput) || !m_gpio->setValue(Gpio::ValueLow)) {
         m_available = false;
         return false;
     }
-    m_available = true;
+
+    m_available = openValueFile(m_gpio->gpioDirectory() + "/value");
+    return m_available;
+}
+
+bool Radio433Trasmitter::openValueFile(const QString &valueFileName)
+{
+    if (m_valueFd >= 0)
+        close(m_valueFd);
+
+    m_valueFd = open(valueFileName.toLocal8Bit().constData(), O_WRONLY | O_CLOEXEC);
+    if (m_valueFd < 0) {
+        qCWarning(dcHardware) << "Radio433: Could not open transmitter value file" << valueFileName << ":" << strerror(errno);
+        return false;
+    }
     return true;
 }
 
+void Radio433Trasmitter::writeValue(bool high)
+{
+    // sysfs attributes ignore the file offset, so the fd can be written over and over again
+    if (write(m_valueFd, high ? "1" : "0", 1) != 1) {
+        qCWarning(dcHardware) << "Radio433: Could not write transmitter value:" << strerror(errno);
+    }
+}
+
+void Radio433Trasmitter::waitUntil(const timespec &deadline)
+{
+    struct timespec sleepDeadline = deadline;
+    sleepDeadline.tv_nsec -= spinWindow;
+    if (sleepDeadline.tv_nsec < 0) {
+        sleepDeadline.tv_nsec += 1000000000;
+        sleepDeadline.tv_sec--;
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &sleepDeadline, 0) == EINTR) { }
+
+    // spin the last micro seconds
+    struct timespec now;
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while (!timeReached(now, deadline));
+}
+
+/*! Queues the given \a rawData timings for sending. Each timing gets multiplied with the given \a delay [us] and the
+ *  whole frame will be sent \a repetitions times. */
 void Radio433Trasmitter::sendData(int delay, QList<int> rawData, int repetitions)
 {
-    QList<int> timings;
-    for (int i = 0; i < repetitions; i++) {
-        foreach (int data, rawData) {
-            timings.append(delay*data);
-        }
+    if (!m_available || repetitions <= 0)
+        return;
+
+    // expand the edge schedule only once per code
+    Transmission transmission;
+    transmission.repetitions = repetitions;
+    transmission.timings.reserve(rawData.count());
+    foreach (int data, rawData) {
+        transmission.timings.append(delay * data);
     }
 
     m_queueMutex.lock();
-    m_rawDataQueue.enqueue(timings);
+    m_transmissionQueue.enqueue(transmission);
     m_queueMutex.unlock();
 
-    if(!isRunning()){
+    if (!isRunning()) {
         start();
     }
 }
@@ -25,8 +25,11 @@
 #include <QThread>
 #include <QMutex>
 #include <QQueue>
+#include <QVector>
 #include <QDebug>
 
+#include <time.h>
+
 #include "libguh.h"
 #include "hardware/gpio.h"
 
@@ -39,16 +42,31 @@ public:
     ~Radio433Trasmitter();
 
     bool startTransmitter();
+    bool startTransmitter(const QString &valueFileName);
     bool available();
 
+    void setRealtimePriority(int priority);
+    int realtimePriority() const;
+
     void sendData(int delay, QList<int> rawData, int repetitions);
 
 protected:
     void run();
 
+    // write one edge and wait for the absolute deadline of the next one, tests can record the schedule
+    virtual void writeValue(bool high);
+    virtual void waitUntil(const struct timespec &deadline);
+
 private:
+    struct Transmission {
+        QVector<int> timings;
+        int repetitions;
+    };
+
     int m_gpioPin;
     Gpio *m_gpio;
+    int m_valueFd;
+    int m_realtimePriority;
 
     QMutex m_mutex;
     bool m_enabled;
@@ -57,11 +75,12 @@ private:
     bool m_allowSending;
 
     QMutex m_queueMutex;
-    QQueue<QList<int> > m_rawDataQueue;
+    QQueue<Transmission> m_transmissionQueue;
 
     bool m_available;
 
     bool setUpGpio();
+    bool openValueFile(const QString &valueFileName);
 
 signals:
 
@@ -0,0 +1,190 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+  \class SysfsAttributes
+  \brief Keeps the attribute files of a sysfs directory open.
+
+  \ingroup hardware
+  \inmodule libguh
+
+  Each attribute file of the directory gets opened on first access and the file descriptor stays
+  open until the directory changes or the object gets destroyed. Attributes are always read and
+  written at offset 0, which is what sysfs expects. The same code works with a regular directory,
+  so \l{Gpio} and \l{Pwm} can be tested against a fake sysfs tree.
+
+  \sa Gpio::setSysfsDirectory(), Pwm::setSysfsDirectory()
+*/
+
+#include "sysfsattributes.h"
+#include "loggingcategories.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+static int openAttribute(const QString &fileName)
+{
+    QByteArray path = fileName.toLocal8Bit();
+
+    // Try read/write first, some attributes are only readable (base, ngpio) or writable (export)
+    int fd = ::open(path.constData(), O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+        fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        fd = ::open(path.constData(), O_WRONLY | O_CLOEXEC);
+
+    return fd;
+}
+
+static QByteArray readAttribute(int fd)
+{
+    char buffer[64];
+    ssize_t size = pread(fd, buffer, sizeof(buffer), 0);
+    if (size < 0)
+        return QByteArray();
+
+    // Only the first line is the value, a fake file could contain left overs from a longer value
+    QByteArray value(buffer, size);
+    int lineEnd = value.indexOf('\n');
+    if (lineEnd >= 0)
+        value.truncate(lineEnd);
+
+    return value.trimmed();
+}
+
+static bool writeAttribute(int fd, const QByteArray &value)
+{
+    QByteArray data = value + '\n';
+    return pwrite(fd, data.constData(), data.size(), 0) == data.size();
+}
+
+/*! Constructs a SysfsAttributes object for the given \a directory. */
+SysfsAttributes::SysfsAttributes(const QString &directory) :
+    m_directory(directory)
+{
+}
+
+/*! Destroys this SysfsAttributes object and closes all open attribute files. */
+SysfsAttributes::~SysfsAttributes()
+{
+    close();
+}
+
+/*! Returns the directory of the attributes. */
+QString SysfsAttributes::directory() const
+{
+    return m_directory;
+}
+
+/*! Sets the \a directory of the attributes. All open attribute files will be closed. */
+void SysfsAttributes::setDirectory(const QString &directory)
+{
+    if (m_directory == directory)
+        return;
+
+    close();
+    m_directory = directory;
+}
+
+/*! Returns the cached file descriptor of the given \a attribute file. The file will be opened on first access.
+ *  Returns -1 if the file could not be opened. */
+int SysfsAttributes::fileDescriptor(const QString &attribute)
+{
+    int fd = m_fileDescriptors.value(attribute, -1);
+    if (fd >= 0)
+        return fd;
+
+    fd = openAttribute(m_directory + "/" + attribute);
+    if (fd >= 0)
+        m_fileDescriptors.insert(attribute, fd);
+
+    return fd;
+}
+
+/*! Returns the value of the given \a attribute. Returns an empty QByteArray if the attribute could not be read. */
+QByteArray SysfsAttributes::read(const QString &attribute)
+{
+    int fd = fileDescriptor(attribute);
+    if (fd < 0) {
+        qCWarning(dcHardware()) << "Sysfs: Could not open" << m_directory + "/" + attribute << ":" << strerror(errno);
+        return QByteArray();
+    }
+
+    return readAttribute(fd);
+}
+
+/*! Returns true if the given \a value could be written to the given \a attribute. */
+bool SysfsAttributes::write(const QString &attribute, const QByteArray &value)
+{
+    int fd = fileDescriptor(attribute);
+    if (fd < 0) {
+        qCWarning(dcHardware()) << "Sysfs: Could not open" << m_directory + "/" + attribute << ":" << strerror(errno);
+        return false;
+    }
+
+    if (!writeAttribute(fd, value)) {
+        qCWarning(dcHardware()) << "Sysfs: Could not write" << value << "to" << m_directory + "/" + attribute << ":" << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+/*! Closes all open attribute files. */
+void SysfsAttributes::close()
+{
+    foreach (int fd, m_fileDescriptors) {
+        ::close(fd);
+    }
+    m_fileDescriptors.clear();
+}
+
+/*! Returns the value of the file with the given \a fileName without keeping it open. Use this for files like
+ *  \tt export, which will be accessed only once. */
+QByteArray SysfsAttributes::readFile(const QString &fileName)
+{
+    int fd = openAttribute(fileName);
+    if (fd < 0)
+        return QByteArray();
+
+    QByteArray value = readAttribute(fd);
+    ::close(fd);
+    return value;
+}
+
+/*! Returns true if the given \a value could be written to the file with the given \a fileName without keeping it open.
+ *  Use this for files like \tt export, which will be accessed only once. */
+bool SysfsAttributes::writeFile(const QString &fileName, const QByteArray &value)
+{
+    int fd = openAttribute(fileName);
+    if (fd < 0) {
+        qCWarning(dcHardware()) << "Sysfs: Could not open" << fileName << ":" << strerror(errno);
+        return false;
+    }
+
+    bool success = writeAttribute(fd, value);
+    if (!success)
+        qCWarning(dcHardware()) << "Sysfs: Could not write" << value << "to" << fileName << ":" << strerror(errno);
+
+    ::close(fd);
+    return success;
+}
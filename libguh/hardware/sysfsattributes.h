@@ -0,0 +1,56 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SYSFSATTRIBUTES_H
+#define SYSFSATTRIBUTES_H
+
+#include <QHash>
+#include <QString>
+#include <QByteArray>
+
+#include "libguh.h"
+
+class LIBGUH_EXPORT SysfsAttributes
+{
+public:
+    explicit SysfsAttributes(const QString &directory = QString());
+    ~SysfsAttributes();
+
+    QString directory() const;
+    void setDirectory(const QString &directory);
+
+    int fileDescriptor(const QString &attribute);
+
+    QByteArray read(const QString &attribute);
+    bool write(const QString &attribute, const QByteArray &value);
+
+    void close();
+
+    static QByteArray readFile(const QString &fileName);
+    static bool writeFile(const QString &fileName, const QByteArray &value);
+
+private:
+    Q_DISABLE_COPY(SysfsAttributes)
+
+    QString m_directory;
+    QHash<QString, int> m_fileDescriptors;
+};
+
+#endif // SYSFSATTRIBUTES_H
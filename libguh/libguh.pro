@@ -29,22 +29,35 @@ HEADERS += devicemanager.h \
            typeutils.h \
            loggingcategories.h \
            guhsettings.h \
+           startupprofiler.h \
+           changejournal.h \
+           metrics.h \
+           calltrace.h \
            plugin/device.h \
            plugin/deviceclass.h \
            plugin/deviceplugin.h \
            plugin/devicedescriptor.h \
            plugin/devicepairinginfo.h \
+           plugin/pluginthread.h \
            hardware/gpio.h \
            hardware/gpiomonitor.h \
+           hardware/gpiogroup.h \
+           hardware/sysfsattributes.h \
            hardware/pwm.h \
            hardware/radio433/radio433.h \
+           hardware/radio433/radio433codeword.h \
            hardware/radio433/radio433transmitter.h \
+           hardware/radio433/radio433receiver.h \
            hardware/radio433/radio433brennenstuhlgateway.h \
            network/upnp/upnpdiscovery.h \
            network/upnp/upnpdevice.h \
            network/upnp/upnpdevicedescriptor.h \
            network/upnp/upnpdiscoveryrequest.h \
+           network/upnp/ssdpmessage.h \
+           network/upnp/upnpdescriptorcache.h \
            network/networkaccessmanager.h \
+           network/queuednetworkreply.h \
+           network/jsonstreamframer.h \
            network/oauth2.h \
            network/avahi/qt-watch.h \
            network/avahi/avahiserviceentry.h \
@@ -80,22 +93,35 @@ HEADERS += devicemanager.h \
 SOURCES += devicemanager.cpp \
            loggingcategories.cpp \
            guhsettings.cpp \
+           startupprofiler.cpp \
+           changejournal.cpp \
+           metrics.cpp \
+           calltrace.cpp \
            plugin/device.cpp \
            plugin/deviceclass.cpp \
            plugin/deviceplugin.cpp \
            plugin/devicedescriptor.cpp \
            plugin/devicepairinginfo.cpp \
+           plugin/pluginthread.cpp \
            hardware/gpio.cpp \
            hardware/gpiomonitor.cpp \
+           hardware/gpiogroup.cpp \
+           hardware/sysfsattributes.cpp \
            hardware/pwm.cpp \
            hardware/radio433/radio433.cpp \
+           hardware/radio433/radio433codeword.cpp \
            hardware/radio433/radio433transmitter.cpp \
+           hardware/radio433/radio433receiver.cpp \
            hardware/radio433/radio433brennenstuhlgateway.cpp \
            network/upnp/upnpdiscovery.cpp \
            network/upnp/upnpdevice.cpp \
            network/upnp/upnpdevicedescriptor.cpp \
            network/upnp/upnpdiscoveryrequest.cpp \
+           network/upnp/ssdpmessage.cpp \
+           network/upnp/upnpdescriptorcache.cpp \
            network/networkaccessmanager.cpp \
+           network/queuednetworkreply.cpp \
+           network/jsonstreamframer.cpp \
            network/oauth2.cpp \
            network/avahi/qt-watch.cpp \
            network/avahi/avahiserviceentry.cpp \
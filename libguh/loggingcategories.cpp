@@ -36,3 +36,4 @@ Q_LOGGING_CATEGORY(dcOAuth2, "OAuth2")
 Q_LOGGING_CATEGORY(dcAvahi, "Avahi")
 Q_LOGGING_CATEGORY(dcCloud, "Cloud")
 Q_LOGGING_CATEGORY(dcNetworkManager, "NetworkManager")
+Q_LOGGING_CATEGORY(dcWatchdog, "Watchdog")
@@ -44,5 +44,6 @@ Q_DECLARE_LOGGING_CATEGORY(dcOAuth2)
 Q_DECLARE_LOGGING_CATEGORY(dcAvahi)
 Q_DECLARE_LOGGING_CATEGORY(dcCloud)
 Q_DECLARE_LOGGING_CATEGORY(dcNetworkManager)
+Q_DECLARE_LOGGING_CATEGORY(dcWatchdog)
 
 #endif // LOGGINGCATEGORYS_H
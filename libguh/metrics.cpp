@@ -0,0 +1,419 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class Metrics
+    \brief Registry of the runtime metrics of the guh server.
+
+    \ingroup devices
+    \inmodule libguh
+
+    The Metrics registry holds counters, gauges and histograms which describe the runtime behaviour of guhd,
+    like the number of events per plugin or the time needed to evaluate the rules. Each metric is identified by
+    its name and an optional label, for example \tt{guh_plugin_events_total{plugin="..."}}.
+
+    Metrics get registered once and live until the process ends, so the returned pointers can be kept by the
+    caller. Registering takes a lock, updating a metric only uses atomic operations and can be done from any
+    thread without further synchronisation.
+
+    The values are available with \l{metrics()} or in the Prometheus text format with \l{prometheusText()}.
+*/
+
+/*!
+    \class Metric
+    \brief The base class of the \l{MetricCounter}, \l{MetricGauge} and \l{MetricHistogram}.
+
+    \ingroup devices
+    \inmodule libguh
+*/
+
+/*! \enum Metric::MetricType
+
+    This enum type specifies the type of a \l{Metric}.
+
+    \value MetricTypeCounter
+        A value which only increases, like the number of received events.
+    \value MetricTypeGauge
+        A value which can go up and down, like the number of connected clients.
+    \value MetricTypeHistogram
+        The distribution of observed values in fixed buckets, like durations.
+*/
+
+/*!
+    \class MetricCounter
+    \brief A \l{Metric} which only increases.
+
+    \ingroup devices
+    \inmodule libguh
+*/
+
+/*!
+    \class MetricGauge
+    \brief A \l{Metric} which can be set to any value.
+
+    \ingroup devices
+    \inmodule libguh
+*/
+
+/*!
+    \class MetricHistogram
+    \brief A \l{Metric} which counts the observed values in buckets with fixed upper bounds.
+
+    \ingroup devices
+    \inmodule libguh
+*/
+
+#include "metrics.h"
+#include "loggingcategories.h"
+
+#include <algorithm>
+
+QMutex Metrics::s_mutex;
+QList<Metric *> Metrics::s_metrics;
+
+/*! Constructs a \l{Metric} with the given \a type, \a name, \a help text and optional label \a labelName and \a labelValue. */
+Metric::Metric(const MetricType &type, const QString &name, const QString &help, const QString &labelName, const QString &labelValue) :
+    m_type(type),
+    m_name(name),
+    m_help(help),
+    m_labelName(labelName),
+    m_labelValue(labelValue)
+{
+}
+
+/*! Destroys this \l{Metric}. */
+Metric::~Metric()
+{
+}
+
+/*! Returns the type of this \l{Metric}. */
+Metric::MetricType Metric::type() const
+{
+    return m_type;
+}
+
+/*! Returns the name of this \l{Metric}. */
+QString Metric::name() const
+{
+    return m_name;
+}
+
+/*! Returns the help text of this \l{Metric}. */
+QString Metric::help() const
+{
+    return m_help;
+}
+
+/*! Returns the name of the label of this \l{Metric}, or an empty string if it has no label. */
+QString Metric::labelName() const
+{
+    return m_labelName;
+}
+
+/*! Returns the value of the label of this \l{Metric}. */
+QString Metric::labelValue() const
+{
+    return m_labelValue;
+}
+
+/*! Constructs a \l{MetricCounter} with the given \a name, \a help text and optional label \a labelName and \a labelValue. */
+MetricCounter::MetricCounter(const QString &name, const QString &help, const QString &labelName, const QString &labelValue) :
+    Metric(MetricTypeCounter, name, help, labelName, labelValue),
+    m_value(0)
+{
+}
+
+/*! Increases the counter by \a value. */
+void MetricCounter::increment(const qint64 &value)
+{
+    m_value.fetchAndAddRelaxed(value);
+}
+
+/*! Returns the current value of the counter. */
+qint64 MetricCounter::value() const
+{
+    return m_value.load();
+}
+
+/*! Constructs a \l{MetricGauge} with the given \a name, \a help text and optional label \a labelName and \a labelValue. */
+MetricGauge::MetricGauge(const QString &name, const QString &help, const QString &labelName, const QString &labelValue) :
+    Metric(MetricTypeGauge, name, help, labelName, labelValue),
+    m_value(0)
+{
+}
+
+/*! Sets the gauge to \a value. */
+void MetricGauge::set(const qint64 &value)
+{
+    m_value.store(value);
+}
+
+/*! Increases the gauge by \a value. */
+void MetricGauge::increment(const qint64 &value)
+{
+    m_value.fetchAndAddRelaxed(value);
+}
+
+/*! Decreases the gauge by \a value. */
+void MetricGauge::decrement(const qint64 &value)
+{
+    m_value.fetchAndAddRelaxed(-value);
+}
+
+/*! Returns the current value of the gauge. */
+qint64 MetricGauge::value() const
+{
+    return m_value.load();
+}
+
+/*! Constructs a \l{MetricHistogram} with the given \a name, \a help text, bucket \a bounds and optional
+ *  label \a labelName and \a labelValue. Values above the largest bound are counted in an additional bucket. */
+MetricHistogram::MetricHistogram(const QString &name, const QString &help, const QList<qint64> &bounds, const QString &labelName, const QString &labelValue) :
+    Metric(MetricTypeHistogram, name, help, labelName, labelValue),
+    m_bounds(bounds),
+    m_sum(0)
+{
+    std::sort(m_bounds.begin(), m_bounds.end());
+    m_buckets = new QAtomicInteger<qint64>[m_bounds.count() + 1];
+    for (int i = 0; i <= m_bounds.count(); i++)
+        m_buckets[i].store(0);
+}
+
+/*! Destroys this \l{MetricHistogram}. */
+MetricHistogram::~MetricHistogram()
+{
+    delete[] m_buckets;
+}
+
+/*! Counts the given \a value in the first bucket with an upper bound greater or equal to it. */
+void MetricHistogram::observe(const qint64 &value)
+{
+    int bucket = 0;
+    while (bucket < m_bounds.count() && value > m_bounds.at(bucket))
+        bucket++;
+
+    m_buckets[bucket].fetchAndAddRelaxed(1);
+    m_sum.fetchAndAddRelaxed(value);
+}
+
+/*! Returns the sorted upper bounds of the buckets. */
+QList<qint64> MetricHistogram::bounds() const
+{
+    return m_bounds;
+}
+
+/*! Returns the cumulative count of each bucket, like Prometheus does. The last entry counts all observed values. */
+QList<qint64> MetricHistogram::bucketCounts() const
+{
+    QList<qint64> counts;
+    qint64 count = 0;
+    for (int i = 0; i <= m_bounds.count(); i++) {
+        count += m_buckets[i].load();
+        counts.append(count);
+    }
+    return counts;
+}
+
+/*! Returns the number of observed values. */
+qint64 MetricHistogram::count() const
+{
+    return bucketCounts().last();
+}
+
+/*! Returns the sum of all observed values. */
+qint64 MetricHistogram::sum() const
+{
+    return m_sum.load();
+}
+
+/*! Returns the \l{MetricCounter} with the given \a name and label \a labelName and \a labelValue. The
+ *  counter will be created with the given \a help text if it does not exist yet. Returns 0 if a metric with
+ *  the same name and label but a different type exists. */
+MetricCounter *Metrics::counter(const QString &name, const QString &help, const QString &labelName, const QString &labelValue)
+{
+    QMutexLocker locker(&s_mutex);
+    Metric *metric = findMetric(name, labelName, labelValue);
+    if (!metric) {
+        metric = new MetricCounter(name, help, labelName, labelValue);
+        s_metrics.append(metric);
+    }
+
+    if (metric->type() != Metric::MetricTypeCounter) {
+        qCWarning(dcApplication) << "Metric" << name << "is not a counter";
+        return 0;
+    }
+    return static_cast<MetricCounter *>(metric);
+}
+
+/*! Returns the \l{MetricGauge} with the given \a name and label \a labelName and \a labelValue. The gauge
+ *  will be created with the given \a help text if it does not exist yet. Returns 0 if a metric with the same
+ *  name and label but a different type exists. */
+MetricGauge *Metrics::gauge(const QString &name, const QString &help, const QString &labelName, const QString &labelValue)
+{
+    QMutexLocker locker(&s_mutex);
+    Metric *metric = findMetric(name, labelName, labelValue);
+    if (!metric) {
+        metric = new MetricGauge(name, help, labelName, labelValue);
+        s_metrics.append(metric);
+    }
+
+    if (metric->type() != Metric::MetricTypeGauge) {
+        qCWarning(dcApplication) << "Metric" << name << "is not a gauge";
+        return 0;
+    }
+    return static_cast<MetricGauge *>(metric);
+}
+
+/*! Returns the \l{MetricHistogram} with the given \a name and label \a labelName and \a labelValue. The
+ *  histogram will be created with the given \a help text and bucket \a bounds if it does not exist yet.
+ *  Returns 0 if a metric with the same name and label but a different type exists.
+ *
+ *  \sa durationBounds()
+ */
+MetricHistogram *Metrics::histogram(const QString &name, const QString &help, const QList<qint64> &bounds, const QString &labelName, const QString &labelValue)
+{
+    QMutexLocker locker(&s_mutex);
+    Metric *metric = findMetric(name, labelName, labelValue);
+    if (!metric) {
+        metric = new MetricHistogram(name, help, bounds, labelName, labelValue);
+        s_metrics.append(metric);
+    }
+
+    if (metric->type() != Metric::MetricTypeHistogram) {
+        qCWarning(dcApplication) << "Metric" << name << "is not a histogram";
+        return 0;
+    }
+    return static_cast<MetricHistogram *>(metric);
+}
+
+/*! Returns the bucket bounds used for durations in microseconds, from 10 us up to 5 s. */
+QList<qint64> Metrics::durationBounds()
+{
+    return QList<qint64>() << 10 << 50 << 100 << 500 << 1000 << 5000 << 10000 << 50000 << 100000 << 500000 << 1000000 << 5000000;
+}
+
+/*! Returns all registered metrics in the order of their registration. */
+QList<Metric *> Metrics::metrics()
+{
+    QMutexLocker locker(&s_mutex);
+    return s_metrics;
+}
+
+/*! Returns all registered metrics in the Prometheus text exposition format (version 0.0.4). */
+QByteArray Metrics::prometheusText()
+{
+    QList<Metric *> allMetrics = metrics();
+
+    // all series of one metric name have to follow each other
+    QStringList names;
+    foreach (Metric *metric, allMetrics) {
+        if (!names.contains(metric->name()))
+            names.append(metric->name());
+    }
+
+    QByteArray text;
+    foreach (const QString &name, names) {
+        bool headerWritten = false;
+        foreach (Metric *metric, allMetrics) {
+            if (metric->name() != name)
+                continue;
+
+            if (!headerWritten) {
+                text.append("# HELP " + name.toUtf8() + " " + escape(metric->help(), false) + "\n");
+                switch (metric->type()) {
+                case Metric::MetricTypeCounter:
+                    text.append("# TYPE " + name.toUtf8() + " counter\n");
+                    break;
+                case Metric::MetricTypeGauge:
+                    text.append("# TYPE " + name.toUtf8() + " gauge\n");
+                    break;
+                case Metric::MetricTypeHistogram:
+                    text.append("# TYPE " + name.toUtf8() + " histogram\n");
+                    break;
+                }
+                headerWritten = true;
+            }
+
+            switch (metric->type()) {
+            case Metric::MetricTypeCounter:
+                text.append(name.toUtf8() + prometheusLabels(metric) + " " + QByteArray::number(static_cast<MetricCounter *>(metric)->value()) + "\n");
+                break;
+            case Metric::MetricTypeGauge:
+                text.append(name.toUtf8() + prometheusLabels(metric) + " " + QByteArray::number(static_cast<MetricGauge *>(metric)->value()) + "\n");
+                break;
+            case Metric::MetricTypeHistogram: {
+                MetricHistogram *histogram = static_cast<MetricHistogram *>(metric);
+                QList<qint64> bounds = histogram->bounds();
+                QList<qint64> counts = histogram->bucketCounts();
+                for (int i = 0; i < counts.count(); i++) {
+                    QString bound = i < bounds.count() ? QString::number(bounds.at(i)) : QString("+Inf");
+                    text.append(name.toUtf8() + "_bucket" + prometheusLabels(metric, "le", bound) + " " + QByteArray::number(counts.at(i)) + "\n");
+                }
+                text.append(name.toUtf8() + "_sum" + prometheusLabels(metric) + " " + QByteArray::number(histogram->sum()) + "\n");
+                text.append(name.toUtf8() + "_count" + prometheusLabels(metric) + " " + QByteArray::number(counts.last()) + "\n");
+                break;
+            }
+            }
+        }
+    }
+    return text;
+}
+
+Metric *Metrics::findMetric(const QString &name, const QString &labelName, const QString &labelValue)
+{
+    foreach (Metric *metric, s_metrics) {
+        if (metric->name() == name && metric->labelName() == labelName && metric->labelValue() == labelValue)
+            return metric;
+    }
+    return 0;
+}
+
+QByteArray Metrics::prometheusLabels(const Metric *metric, const QString &extraName, const QString &extraValue)
+{
+    QList<QByteArray> labels;
+    if (!metric->labelName().isEmpty())
+        labels.append(metric->labelName().toUtf8() + "=\"" + escape(metric->labelValue(), true) + "\"");
+
+    if (!extraName.isEmpty())
+        labels.append(extraName.toUtf8() + "=\"" + escape(extraValue, true) + "\"");
+
+    if (labels.isEmpty())
+        return QByteArray();
+
+    QByteArray result = "{";
+    for (int i = 0; i < labels.count(); i++) {
+        if (i > 0)
+            result.append(',');
+        result.append(labels.at(i));
+    }
+    result.append('}');
+    return result;
+}
+
+QByteArray Metrics::escape(const QString &text, const bool &quotes)
+{
+    QByteArray escaped = text.toUtf8();
+    escaped.replace('\\', "\\\\");
+    escaped.replace('\n', "\\n");
+    if (quotes)
+        escaped.replace('"', "\\\"");
+
+    return escaped;
+}
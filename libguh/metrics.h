@@ -0,0 +1,132 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QAtomicInteger>
+
+#include "libguh.h"
+
+class LIBGUH_EXPORT Metric
+{
+    Q_GADGET
+    Q_ENUMS(MetricType)
+
+public:
+    enum MetricType {
+        MetricTypeCounter,
+        MetricTypeGauge,
+        MetricTypeHistogram
+    };
+
+    virtual ~Metric();
+
+    MetricType type() const;
+    QString name() const;
+    QString help() const;
+    QString labelName() const;
+    QString labelValue() const;
+
+protected:
+    Metric(const MetricType &type, const QString &name, const QString &help, const QString &labelName, const QString &labelValue);
+
+private:
+    Q_DISABLE_COPY(Metric)
+
+    MetricType m_type;
+    QString m_name;
+    QString m_help;
+    QString m_labelName;
+    QString m_labelValue;
+};
+
+class LIBGUH_EXPORT MetricCounter : public Metric
+{
+public:
+    MetricCounter(const QString &name, const QString &help, const QString &labelName = QString(), const QString &labelValue = QString());
+
+    void increment(const qint64 &value = 1);
+    qint64 value() const;
+
+private:
+    QAtomicInteger<qint64> m_value;
+};
+
+class LIBGUH_EXPORT MetricGauge : public Metric
+{
+public:
+    MetricGauge(const QString &name, const QString &help, const QString &labelName = QString(), const QString &labelValue = QString());
+
+    void set(const qint64 &value);
+    void increment(const qint64 &value = 1);
+    void decrement(const qint64 &value = 1);
+    qint64 value() const;
+
+private:
+    QAtomicInteger<qint64> m_value;
+};
+
+class LIBGUH_EXPORT MetricHistogram : public Metric
+{
+public:
+    MetricHistogram(const QString &name, const QString &help, const QList<qint64> &bounds, const QString &labelName = QString(), const QString &labelValue = QString());
+    ~MetricHistogram();
+
+    void observe(const qint64 &value);
+
+    QList<qint64> bounds() const;
+    QList<qint64> bucketCounts() const;
+    qint64 count() const;
+    qint64 sum() const;
+
+private:
+    QList<qint64> m_bounds;
+    QAtomicInteger<qint64> *m_buckets;
+    QAtomicInteger<qint64> m_sum;
+};
+
+class LIBGUH_EXPORT Metrics
+{
+public:
+    static MetricCounter *counter(const QString &name, const QString &help, const QString &labelName = QString(), const QString &labelValue = QString());
+    static MetricGauge *gauge(const QString &name, const QString &help, const QString &labelName = QString(), const QString &labelValue = QString());
+    static MetricHistogram *histogram(const QString &name, const QString &help, const QList<qint64> &bounds, const QString &labelName = QString(), const QString &labelValue = QString());
+
+    static QList<qint64> durationBounds();
+
+    static QList<Metric *> metrics();
+    static QByteArray prometheusText();
+
+private:
+    static QMutex s_mutex;
+    static QList<Metric *> s_metrics;
+
+    static Metric *findMetric(const QString &name, const QString &labelName, const QString &labelValue);
+    static QByteArray prometheusLabels(const Metric *metric, const QString &extraName = QString(), const QString &extraValue = QString());
+    static QByteArray escape(const QString &text, const bool &quotes);
+};
+
+#endif // METRICS_H
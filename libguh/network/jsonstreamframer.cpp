@@ -0,0 +1,194 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+  \class JsonStreamFramer
+  \brief Splits a stream of bytes into complete JSON documents.
+
+  \ingroup hardware
+  \inmodule libguh
+
+  JSON-RPC peers on a TCP connection send their documents back to back, with or without a
+  newline in between, and a single read can contain a part of a document or several of them.
+  The JsonStreamFramer keeps the received bytes of one connection together with the brace
+  depth and the string and escape state of the scanner, so every byte gets scanned only once,
+  no matter in how many pieces a document arrives.
+
+  Bytes outside of a JSON object or array are treated as one message terminated by a newline,
+  in order to let the receiver report the parse error to the peer.
+
+  \code
+    m_framer.append(m_socket->readAll());
+    while (m_framer.hasMessage())
+        processMessage(m_framer.takeMessage());
+  \endcode
+*/
+
+#include "jsonstreamframer.h"
+
+/*! Constructs a JsonStreamFramer which accepts documents up to \a maximumMessageSize bytes. */
+JsonStreamFramer::JsonStreamFramer(const int &maximumMessageSize) :
+    m_maximumMessageSize(maximumMessageSize),
+    m_scanPosition(0),
+    m_messageStart(0),
+    m_depth(0),
+    m_inMessage(false),
+    m_inString(false),
+    m_escaped(false),
+    m_discarding(false)
+{
+}
+
+/*! Returns the maximum size of a single message in bytes. */
+int JsonStreamFramer::maximumMessageSize() const
+{
+    return m_maximumMessageSize;
+}
+
+/*! Sets the maximum size of a single message to \a maximumMessageSize bytes. */
+void JsonStreamFramer::setMaximumMessageSize(const int &maximumMessageSize)
+{
+    m_maximumMessageSize = maximumMessageSize;
+}
+
+/*! Appends the received \a data to the stream and frames all documents completed by it.
+ *  Returns false if a message exceeded the \l{maximumMessageSize()}. The rest of that message
+ *  gets discarded while it arrives, the following messages will be framed again. */
+bool JsonStreamFramer::append(const QByteArray &data)
+{
+    m_buffer.append(data);
+
+    const char *buffer = m_buffer.constData();
+    int consumed = 0;
+    bool overflow = false;
+
+    for (; m_scanPosition < m_buffer.length(); m_scanPosition++) {
+        char c = buffer[m_scanPosition];
+
+        // outside of a message
+        if (!m_inMessage) {
+            if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+                consumed = m_scanPosition + 1;
+                continue;
+            }
+
+            m_inMessage = true;
+            m_messageStart = m_scanPosition;
+            m_depth = 0;
+            m_inString = false;
+            m_escaped = false;
+        }
+
+        if (!m_discarding && m_scanPosition - m_messageStart >= m_maximumMessageSize) {
+            m_discarding = true;
+            overflow = true;
+        }
+
+        // an oversized message does not get buffered any more
+        if (m_discarding)
+            consumed = m_scanPosition + 1;
+
+        if (m_inString) {
+            if (m_escaped) {
+                m_escaped = false;
+            } else if (c == '\\') {
+                m_escaped = true;
+            } else if (c == '"') {
+                m_inString = false;
+            }
+            continue;
+        }
+
+        bool complete = false;
+        switch (c) {
+        case '"':
+            m_inString = m_depth > 0;
+            break;
+        case '{':
+        case '[':
+            m_depth++;
+            break;
+        case '}':
+        case ']':
+            m_depth--;
+            complete = m_depth <= 0;
+            break;
+        case '\n':
+            // not a JSON object or array
+            complete = m_depth <= 0;
+            break;
+        default:
+            break;
+        }
+
+        if (complete) {
+            if (!m_discarding)
+                m_messages.append(m_buffer.mid(m_messageStart, m_scanPosition - m_messageStart + 1));
+
+            m_inMessage = false;
+            m_discarding = false;
+            consumed = m_scanPosition + 1;
+        }
+    }
+
+    // drop everything which belongs to the framed messages
+    if (consumed > 0) {
+        m_buffer.remove(0, consumed);
+        m_scanPosition -= consumed;
+        m_messageStart -= consumed;
+    }
+
+    return !overflow;
+}
+
+/*! Returns true if there is at least one complete message available. */
+bool JsonStreamFramer::hasMessage() const
+{
+    return !m_messages.isEmpty();
+}
+
+/*! Returns the oldest complete message and removes it from the framer. */
+QByteArray JsonStreamFramer::takeMessage()
+{
+    if (m_messages.isEmpty())
+        return QByteArray();
+
+    return m_messages.takeFirst();
+}
+
+/*! Returns the number of received bytes which do not belong to a complete message yet. */
+int JsonStreamFramer::bufferedSize() const
+{
+    return m_buffer.length();
+}
+
+/*! Drops all buffered data and messages, i.e. when the connection got closed. */
+void JsonStreamFramer::clear()
+{
+    m_buffer.clear();
+    m_messages.clear();
+    m_scanPosition = 0;
+    m_messageStart = 0;
+    m_depth = 0;
+    m_inMessage = false;
+    m_inString = false;
+    m_escaped = false;
+    m_discarding = false;
+}
@@ -0,0 +1,61 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef JSONSTREAMFRAMER_H
+#define JSONSTREAMFRAMER_H
+
+#include <QList>
+#include <QByteArray>
+
+#include "libguh.h"
+
+class LIBGUH_EXPORT JsonStreamFramer
+{
+public:
+    explicit JsonStreamFramer(const int &maximumMessageSize = 1024 * 1024);
+
+    int maximumMessageSize() const;
+    void setMaximumMessageSize(const int &maximumMessageSize);
+
+    bool append(const QByteArray &data);
+
+    bool hasMessage() const;
+    QByteArray takeMessage();
+
+    int bufferedSize() const;
+    void clear();
+
+private:
+    int m_maximumMessageSize;
+
+    QByteArray m_buffer;
+    QList<QByteArray> m_messages;
+
+    // scanner state, kept between the append() calls
+    int m_scanPosition;
+    int m_messageStart;
+    int m_depth;
+    bool m_inMessage;
+    bool m_inString;
+    bool m_escaped;
+    bool m_discarding;
+};
+
+#endif // JSONSTREAMFRAMER_H
@@ -25,8 +25,21 @@
   \ingroup hardware
   \inmodule libguh
 
-  The network manager class is a reimplementation of the \l{http://doc-snapshot.qt-project.org/qt5-5.4/qnetworkaccessmanager.html}{QNetworkAccessManager}
-  and allows plugins to send network requests and receive replies.
+  The network manager class wraps one \l{http://doc-snapshot.qt-project.org/qt5-5.4/qnetworkaccessmanager.html}{QNetworkAccessManager}
+  shared by all plugins and allows them to send network requests and receive replies.
+
+  Each request returns a \l{QueuedNetworkReply} immediately, but the request itself waits in a queue
+  until the plugin has less than \l{maximumPluginRequests()} and the target host less than
+  \l{maximumHostRequests()} requests running. The queue is ordered by the QNetworkRequest::Priority
+  of the requests. Requests without an explicit priority get the \l{contextPriority()}, which is raised
+  while an action gets executed and lowered while the plugin timer runs, so actions beat polls.
+
+  Running requests get aborted with QNetworkReply::TimeoutError after \l{requestTimeout()} milliseconds.
+  Successful GET responses with an \c ETag or \c Last-Modified header are cached; the next GET of the same
+  URL is sent as conditional request and a \c{304 Not Modified} response gets answered from the cache.
+  Responses which are still fresh according to their \c{Cache-Control: max-age} will not be requested again.
+
+  The number of requests, cache hits, errors, timeouts and the latency of each plugin can be read with \l{statistics()}.
 */
 
 /*!
@@ -39,16 +52,31 @@
 #include "networkaccessmanager.h"
 #include "loggingcategories.h"
 
+#include <QTimer>
+
 /*! Construct the hardware resource NetworkAccessManager with the given \a parent. */
 NetworkAccessManager::NetworkAccessManager(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_maximumPluginRequests(6),
+    m_maximumHostRequests(4),
+    m_requestTimeout(30000),
+    m_contextPriority(QNetworkRequest::NormalPriority)
 {
+    m_cache.setMaxCost(4 * 1024 * 1024);
+
     m_manager = new QNetworkAccessManager(this);
     connect(m_manager, &QNetworkAccessManager::finished, this, &NetworkAccessManager::replyFinished);
 
     qCDebug(dcDeviceManager) << "--> Network manager created successfully.";
 }
 
+/*! Destroys this NetworkAccessManager and all replies. */
+NetworkAccessManager::~NetworkAccessManager()
+{
+    foreach (QueuedNetworkReply *reply, findChildren<QueuedNetworkReply *>())
+        disconnect(reply, 0, this, 0);
+}
+
 /*! Posts a request to obtain the contents of the target \a request from the plugin with the given \a pluginId
  * and returns a new QNetworkReply object opened for reading which emits the replyReady() signal whenever new
  * data arrives.
@@ -60,8 +88,21 @@ NetworkAccessManager::NetworkAccessManager(QObject *parent) :
  */
 QNetworkReply *NetworkAccessManager::get(const PluginId &pluginId, const QNetworkRequest &request)
 {
-    QNetworkReply  *reply = m_manager->get(request);
-    m_replies.insert(reply, pluginId);
+    QueuedNetworkReply *reply = createReply(pluginId, QNetworkAccessManager::GetOperation, request);
+
+    // fresh cache entries do not need a request at all
+    CacheEntry *entry = m_cache.object(cacheKey(reply));
+    if (entry && entry->expirationTime.isValid() && entry->expirationTime > QDateTime::currentDateTimeUtc()) {
+        // keep it out of the queue, otherwise startRequests() would send it until serveFromCache() runs
+        m_queue.removeAll(reply);
+        if (m_cacheHits.isEmpty())
+            QTimer::singleShot(0, this, SLOT(serveFromCache()));
+
+        m_cacheHits.append(reply);
+        return reply;
+    }
+
+    startRequests();
     return reply;
 }
 
@@ -75,8 +116,8 @@ QNetworkReply *NetworkAccessManager::get(const PluginId &pluginId, const QNetwor
  */
 QNetworkReply *NetworkAccessManager::post(const PluginId &pluginId, const QNetworkRequest &request, const QByteArray &data)
 {
-    QNetworkReply  *reply = m_manager->post(request, data);
-    m_replies.insert(reply, pluginId);
+    QueuedNetworkReply *reply = createReply(pluginId, QNetworkAccessManager::PostOperation, request, data);
+    startRequests();
     return reply;
 }
 
@@ -89,15 +130,312 @@ QNetworkReply *NetworkAccessManager::post(const PluginId &pluginId, const QNetwo
  */
 QNetworkReply *NetworkAccessManager::put(const PluginId &pluginId, const QNetworkRequest &request, const QByteArray &data)
 {
-    QNetworkReply  *reply = m_manager->put(request, data);
-    m_replies.insert(reply, pluginId);
+    QueuedNetworkReply *reply = createReply(pluginId, QNetworkAccessManager::PutOperation, request, data);
+    startRequests();
     return reply;
 }
 
-void NetworkAccessManager::replyFinished(QNetworkReply *reply)
+/*! Returns the maximum number of concurrently running requests of one plugin. */
+int NetworkAccessManager::maximumPluginRequests() const
+{
+    return m_maximumPluginRequests;
+}
+
+/*! Sets the maximum number of concurrently running requests of one plugin to \a maximumPluginRequests. */
+void NetworkAccessManager::setMaximumPluginRequests(const int &maximumPluginRequests)
+{
+    m_maximumPluginRequests = qMax(1, maximumPluginRequests);
+    startRequests();
+}
+
+/*! Returns the maximum number of concurrently running requests to one host. */
+int NetworkAccessManager::maximumHostRequests() const
+{
+    return m_maximumHostRequests;
+}
+
+/*! Sets the maximum number of concurrently running requests to one host to \a maximumHostRequests. */
+void NetworkAccessManager::setMaximumHostRequests(const int &maximumHostRequests)
+{
+    m_maximumHostRequests = qMax(1, maximumHostRequests);
+    startRequests();
+}
+
+/*! Returns the timeout of a running request in milliseconds. */
+int NetworkAccessManager::requestTimeout() const
+{
+    return m_requestTimeout;
+}
+
+/*! Sets the timeout of a running request to \a requestTimeout milliseconds. A value of 0 disables the timeout. */
+void NetworkAccessManager::setRequestTimeout(const int &requestTimeout)
+{
+    m_requestTimeout = requestTimeout;
+}
+
+/*! Returns the maximum size of the response cache in bytes. */
+int NetworkAccessManager::cacheSize() const
+{
+    return m_cache.maxCost();
+}
+
+/*! Sets the maximum size of the response cache to \a cacheSize bytes. A value of 0 disables the cache. */
+void NetworkAccessManager::setCacheSize(const int &cacheSize)
+{
+    m_cache.setMaxCost(cacheSize);
+}
+
+/*! Returns the priority of the requests without an explicit QNetworkRequest::Priority. */
+QNetworkRequest::Priority NetworkAccessManager::contextPriority() const
+{
+    return m_contextPriority;
+}
+
+/*! Sets the \a priority of the requests without an explicit QNetworkRequest::Priority. The \l{DeviceManager}
+ *  raises it while a plugin executes an action and lowers it while the plugins get the timer event. */
+void NetworkAccessManager::setContextPriority(const QNetworkRequest::Priority &priority)
+{
+    m_contextPriority = priority;
+}
+
+/*! Returns the number of requests waiting in the queue. */
+int NetworkAccessManager::queuedRequests() const
 {
+    return m_queue.count();
+}
+
+/*! Returns the number of running requests. */
+int NetworkAccessManager::runningRequests() const
+{
+    return m_replies.count();
+}
+
+/*! Returns the request statistics of the plugin with the given \a pluginId. */
+NetworkAccessManager::Statistics NetworkAccessManager::statistics(const PluginId &pluginId) const
+{
+    return m_statistics.value(pluginId);
+}
+
+/*! Returns the request statistics of all plugins which sent requests. */
+QHash<PluginId, NetworkAccessManager::Statistics> NetworkAccessManager::statistics() const
+{
+    return m_statistics;
+}
+
+QueuedNetworkReply *NetworkAccessManager::createReply(const PluginId &pluginId, QNetworkAccessManager::Operation operation, const QNetworkRequest &request, const QByteArray &data)
+{
+    QNetworkRequest::Priority priority = request.priority();
+    if (priority == QNetworkRequest::NormalPriority)
+        priority = m_contextPriority;
+
+    QueuedNetworkReply *reply = new QueuedNetworkReply(pluginId, operation, request, data, priority, this);
+    connect(reply, &QueuedNetworkReply::abortRequested, this, &NetworkAccessManager::onAbortRequested);
+    connect(reply, &QueuedNetworkReply::released, this, &NetworkAccessManager::onReplyReleased);
+    connect(reply->timeoutTimer(), &QTimer::timeout, this, &NetworkAccessManager::onRequestTimeout);
+
+    // insert behind all requests with the same or a higher priority (lower value)
+    int index = m_queue.count();
+    for (int i = 0; i < m_queue.count(); i++) {
+        if (m_queue.at(i)->priority() > priority) {
+            index = i;
+            break;
+        }
+    }
+    m_queue.insert(index, reply);
+    return reply;
+}
+
+void NetworkAccessManager::startRequests()
+{
+    int i = 0;
+    while (i < m_queue.count()) {
+        QueuedNetworkReply *reply = m_queue.at(i);
+        if (m_pluginRequests.value(reply->pluginId()) >= m_maximumPluginRequests || m_hostRequests.value(reply->hostKey()) >= m_maximumHostRequests) {
+            i++;
+            continue;
+        }
+
+        m_queue.removeAt(i);
+        startRequest(reply);
+    }
+}
+
+void NetworkAccessManager::startRequest(QueuedNetworkReply *reply)
+{
+    QNetworkRequest request = reply->request();
+
+    // revalidate cached responses
+    if (reply->operation() == QNetworkAccessManager::GetOperation) {
+        CacheEntry *entry = m_cache.object(cacheKey(reply));
+        if (entry && !entry->eTag.isEmpty())
+            request.setRawHeader("If-None-Match", entry->eTag);
+
+        if (entry && !entry->lastModified.isEmpty())
+            request.setRawHeader("If-Modified-Since", entry->lastModified);
+    }
+
+    QNetworkReply *networkReply = 0;
+    switch (reply->operation()) {
+    case QNetworkAccessManager::PostOperation:
+        networkReply = m_manager->post(request, reply->outgoingData());
+        break;
+    case QNetworkAccessManager::PutOperation:
+        networkReply = m_manager->put(request, reply->outgoingData());
+        break;
+    default:
+        networkReply = m_manager->get(request);
+        break;
+    }
+
+    reply->setNetworkReply(networkReply);
+    m_replies.insert(networkReply, reply);
+    m_pluginRequests[reply->pluginId()]++;
+    m_hostRequests[reply->hostKey()]++;
+
+    if (m_requestTimeout > 0)
+        reply->timeoutTimer()->start(m_requestTimeout);
+}
+
+void NetworkAccessManager::finishReply(QueuedNetworkReply *reply)
+{
+    Statistics &statistics = m_statistics[reply->pluginId()];
+    statistics.requests++;
+    statistics.totalLatency += reply->elapsed();
+    statistics.maximumLatency = qMax(statistics.maximumLatency, reply->elapsed());
+    if (reply->error() == QNetworkReply::TimeoutError) {
+        statistics.timeouts++;
+    } else if (reply->error() != QNetworkReply::NoError && reply->error() != QNetworkReply::OperationCanceledError) {
+        statistics.errors++;
+    }
+
+    if (reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool())
+        statistics.cacheHits++;
+
     // NOTE: Each plugin has to delete his own replys with deleteLater()!!
     // NOTE: also the reply->error() has to be handled in each plugin!!
-    PluginId pluginId = m_replies.take(reply);
-    emit replyReady(pluginId, reply);
+    emit replyReady(reply->pluginId(), reply);
+}
+
+QString NetworkAccessManager::cacheKey(QueuedNetworkReply *reply)
+{
+    return reply->pluginId().toString() + reply->url().toString();
+}
+
+void NetworkAccessManager::updateCache(QueuedNetworkReply *reply, QNetworkReply *networkReply)
+{
+    QByteArray cacheControl = networkReply->rawHeader("Cache-Control");
+    QByteArray eTag = networkReply->rawHeader("ETag");
+    QByteArray lastModified = networkReply->rawHeader("Last-Modified");
+    if ((eTag.isEmpty() && lastModified.isEmpty()) || cacheControl.contains("no-store") || m_cache.maxCost() <= 0)
+        return;
+
+    CacheEntry *entry = new CacheEntry();
+    entry->eTag = eTag;
+    entry->lastModified = lastModified;
+    entry->headers = networkReply->rawHeaderPairs();
+
+    int maxAgeIndex = cacheControl.indexOf("max-age=");
+    if (maxAgeIndex >= 0 && !cacheControl.contains("no-cache")) {
+        int maxAge = cacheControl.mid(maxAgeIndex + 8).split(',').first().trimmed().toInt();
+        if (maxAge > 0)
+            entry->expirationTime = QDateTime::currentDateTimeUtc().addSecs(maxAge);
+    }
+
+    // peek at the content without consuming it for the plugin
+    entry->content = networkReply->peek(networkReply->bytesAvailable());
+    m_cache.insert(cacheKey(reply), entry, qMax(1, entry->content.size()));
+}
+
+void NetworkAccessManager::replyFinished(QNetworkReply *networkReply)
+{
+    QueuedNetworkReply *reply = m_replies.take(networkReply);
+    networkReply->deleteLater();
+    if (!reply)
+        return;
+
+    m_pluginRequests[reply->pluginId()]--;
+    m_hostRequests[reply->hostKey()]--;
+
+    int status = networkReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    CacheEntry *entry = 0;
+    if (reply->operation() == QNetworkAccessManager::GetOperation)
+        entry = m_cache.object(cacheKey(reply));
+
+    if (entry && status == 304) {
+        reply->finish(entry->headers, entry->content);
+    } else {
+        if (reply->operation() == QNetworkAccessManager::GetOperation && status == 200 && networkReply->error() == QNetworkReply::NoError)
+            updateCache(reply, networkReply);
+
+        reply->finish(networkReply);
+    }
+
+    finishReply(reply);
+    startRequests();
+}
+
+void NetworkAccessManager::onAbortRequested()
+{
+    QueuedNetworkReply *reply = static_cast<QueuedNetworkReply *>(sender());
+
+    // a running request finishes through replyFinished()
+    if (reply->networkReply()) {
+        reply->networkReply()->abort();
+        return;
+    }
+
+    m_queue.removeAll(reply);
+    m_cacheHits.removeAll(reply);
+    reply->finishWithError(QNetworkReply::OperationCanceledError, "Operation canceled");
+    finishReply(reply);
+}
+
+void NetworkAccessManager::onRequestTimeout()
+{
+    QTimer *timer = static_cast<QTimer *>(sender());
+    foreach (QueuedNetworkReply *reply, m_replies) {
+        if (reply->timeoutTimer() == timer) {
+            qCWarning(dcDeviceManager) << "Network request timed out:" << reply->url().toString();
+            reply->setTimedOut(true);
+            reply->networkReply()->abort();
+            return;
+        }
+    }
+}
+
+void NetworkAccessManager::onReplyReleased()
+{
+    // the plugin deleted the reply, maybe before it finished
+    QueuedNetworkReply *reply = static_cast<QueuedNetworkReply *>(sender());
+    m_queue.removeAll(reply);
+    m_cacheHits.removeAll(reply);
+
+    QNetworkReply *networkReply = m_replies.key(reply);
+    if (networkReply) {
+        m_replies.remove(networkReply);
+        m_pluginRequests[reply->pluginId()]--;
+        m_hostRequests[reply->hostKey()]--;
+        networkReply->abort();
+        networkReply->deleteLater();
+        startRequests();
+    }
+}
+
+void NetworkAccessManager::serveFromCache()
+{
+    while (!m_cacheHits.isEmpty()) {
+        QueuedNetworkReply *reply = m_cacheHits.takeFirst();
+        m_queue.removeAll(reply);
+
+        CacheEntry *entry = m_cache.object(cacheKey(reply));
+        if (!entry) {
+            // evicted in the meantime
+            m_queue.prepend(reply);
+            continue;
+        }
+
+        reply->finish(entry->headers, entry->content);
+        finishReply(reply);
+    }
+    startRequests();
 }
@@ -23,11 +23,14 @@
 
 #include "libguh.h"
 #include "typeutils.h"
+#include "queuednetworkreply.h"
 
 #include <QObject>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <QDateTime>
+#include <QCache>
 #include <QDebug>
 #include <QUrl>
 
@@ -35,21 +38,94 @@ class LIBGUH_EXPORT NetworkAccessManager : public QObject
 {
     Q_OBJECT
 public:
+    class Statistics
+    {
+    public:
+        Statistics() : requests(0), cacheHits(0), errors(0), timeouts(0), totalLatency(0), maximumLatency(0) {}
+
+        int requests;
+        int cacheHits;
+        int errors;
+        int timeouts;
+        qint64 totalLatency;
+        qint64 maximumLatency;
+
+        qint64 averageLatency() const { return requests > 0 ? totalLatency / requests : 0; }
+    };
+
     explicit NetworkAccessManager(QObject *parent = 0);
+    ~NetworkAccessManager();
 
     QNetworkReply *get(const PluginId &pluginId, const QNetworkRequest &request);
     QNetworkReply *post(const PluginId &pluginId, const QNetworkRequest &request, const QByteArray &data);
     QNetworkReply *put(const PluginId &pluginId, const QNetworkRequest &request, const QByteArray &data);
 
+    int maximumPluginRequests() const;
+    void setMaximumPluginRequests(const int &maximumPluginRequests);
+
+    int maximumHostRequests() const;
+    void setMaximumHostRequests(const int &maximumHostRequests);
+
+    int requestTimeout() const;
+    void setRequestTimeout(const int &requestTimeout);
+
+    int cacheSize() const;
+    void setCacheSize(const int &cacheSize);
+
+    QNetworkRequest::Priority contextPriority() const;
+    void setContextPriority(const QNetworkRequest::Priority &priority);
+
+    int queuedRequests() const;
+    int runningRequests() const;
+
+    Statistics statistics(const PluginId &pluginId) const;
+    QHash<PluginId, Statistics> statistics() const;
+
 private:
+    class CacheEntry
+    {
+    public:
+        QByteArray eTag;
+        QByteArray lastModified;
+        QDateTime expirationTime;
+        QList<QNetworkReply::RawHeaderPair> headers;
+        QByteArray content;
+    };
+
     QNetworkAccessManager *m_manager;
-    QHash<QNetworkReply *, PluginId> m_replies;
+
+    int m_maximumPluginRequests;
+    int m_maximumHostRequests;
+    int m_requestTimeout;
+    QNetworkRequest::Priority m_contextPriority;
+
+    // queued replies ordered by priority, running replies by their real reply
+    QList<QueuedNetworkReply *> m_queue;
+    QHash<QNetworkReply *, QueuedNetworkReply *> m_replies;
+    QHash<PluginId, int> m_pluginRequests;
+    QHash<QString, int> m_hostRequests;
+
+    QHash<PluginId, Statistics> m_statistics;
+    QCache<QString, CacheEntry> m_cache;
+    QList<QueuedNetworkReply *> m_cacheHits;
+
+    QueuedNetworkReply *createReply(const PluginId &pluginId, QNetworkAccessManager::Operation operation, const QNetworkRequest &request, const QByteArray &data = QByteArray());
+    void startRequests();
+    void startRequest(QueuedNetworkReply *reply);
+    void finishReply(QueuedNetworkReply *reply);
+
+    static QString cacheKey(QueuedNetworkReply *reply);
+    void updateCache(QueuedNetworkReply *reply, QNetworkReply *networkReply);
 
 signals:
     void replyReady(const PluginId &pluginId, QNetworkReply *reply);
 
 private slots:
-    void replyFinished(QNetworkReply *reply);
+    void replyFinished(QNetworkReply *networkReply);
+    void onAbortRequested();
+    void onRequestTimeout();
+    void onReplyReleased();
+    void serveFromCache();
 
 };
 
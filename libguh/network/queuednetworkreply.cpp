@@ -0,0 +1,217 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+  \class QueuedNetworkReply
+  \brief The QNetworkReply handed out by the \l{NetworkAccessManager} to the plugins.
+
+  \ingroup hardware
+  \inmodule libguh
+
+  The \l{NetworkAccessManager} returns a QueuedNetworkReply immediately, even if the request
+  still waits in the queue of the manager. Once the request was sent and the real reply
+  finished (or the response was taken from the cache), the status, headers and content get
+  copied into this reply and the \l{NetworkAccessManager::replyReady()} signal will be emitted.
+*/
+
+/*! \fn void QueuedNetworkReply::abortRequested();
+    This signal is emitted when the owner of this reply called \l{abort()}.
+*/
+
+/*! \fn void QueuedNetworkReply::released();
+    This signal is emitted when the owner deletes this reply, while all members are still valid.
+*/
+
+#include "queuednetworkreply.h"
+
+#include <string.h>
+
+/*! Constructs a QueuedNetworkReply for the given \a request of the plugin with the given \a pluginId.
+ *  The \a outgoingData will be uploaded for the \a operation, the \a priority defines the position in the queue. */
+QueuedNetworkReply::QueuedNetworkReply(const PluginId &pluginId, QNetworkAccessManager::Operation operation, const QNetworkRequest &request, const QByteArray &outgoingData, const QNetworkRequest::Priority &priority, QObject *parent) :
+    QNetworkReply(parent),
+    m_pluginId(pluginId),
+    m_outgoingData(outgoingData),
+    m_priority(priority),
+    m_networkReply(0),
+    m_timedOut(false),
+    m_offset(0)
+{
+    setRequest(request);
+    setOperation(operation);
+    setUrl(request.url());
+    open(QIODevice::ReadOnly);
+
+    m_timeoutTimer.setSingleShot(true);
+    m_elapsedTimer.start();
+}
+
+/*! Destroys this QueuedNetworkReply. A request which is still queued or running will be dropped. */
+QueuedNetworkReply::~QueuedNetworkReply()
+{
+    emit released();
+}
+
+/*! Returns the id of the plugin which sent the request of this reply. */
+PluginId QueuedNetworkReply::pluginId() const
+{
+    return m_pluginId;
+}
+
+/*! Returns the data which will be uploaded with the request of this reply. */
+QByteArray QueuedNetworkReply::outgoingData() const
+{
+    return m_outgoingData;
+}
+
+/*! Returns the priority of the request of this reply. */
+QNetworkRequest::Priority QueuedNetworkReply::priority() const
+{
+    return m_priority;
+}
+
+/*! Returns the host and port of the request, used to limit the concurrent requests to one host. */
+QString QueuedNetworkReply::hostKey() const
+{
+    return url().host() + ":" + QString::number(url().port(url().scheme() == "https" ? 443 : 80));
+}
+
+/*! Returns the real reply of the sent request, or 0 if the request is still queued. */
+QNetworkReply *QueuedNetworkReply::networkReply() const
+{
+    return m_networkReply;
+}
+
+/*! Sets the real reply of the sent request to \a networkReply. */
+void QueuedNetworkReply::setNetworkReply(QNetworkReply *networkReply)
+{
+    m_networkReply = networkReply;
+}
+
+/*! Returns the timer which aborts the request of this reply. */
+QTimer *QueuedNetworkReply::timeoutTimer()
+{
+    return &m_timeoutTimer;
+}
+
+/*! Returns true if the request of this reply has been aborted because it timed out. */
+bool QueuedNetworkReply::timedOut() const
+{
+    return m_timedOut;
+}
+
+/*! Sets the \a timedOut flag of this reply. */
+void QueuedNetworkReply::setTimedOut(const bool &timedOut)
+{
+    m_timedOut = timedOut;
+}
+
+/*! Returns the milliseconds since this reply has been created, including the time in the queue. */
+qint64 QueuedNetworkReply::elapsed() const
+{
+    return m_elapsedTimer.elapsed();
+}
+
+/*! Copies the status, headers and content of the finished \a networkReply into this reply. */
+void QueuedNetworkReply::finish(QNetworkReply *networkReply)
+{
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, networkReply->attribute(QNetworkRequest::HttpStatusCodeAttribute));
+    setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, networkReply->attribute(QNetworkRequest::HttpReasonPhraseAttribute));
+    setAttribute(QNetworkRequest::RedirectionTargetAttribute, networkReply->attribute(QNetworkRequest::RedirectionTargetAttribute));
+
+    foreach (const RawHeaderPair &header, networkReply->rawHeaderPairs())
+        setRawHeader(header.first, header.second);
+
+    if (m_timedOut) {
+        setError(QNetworkReply::TimeoutError, "The request timed out");
+    } else if (networkReply->error() != QNetworkReply::NoError) {
+        setError(networkReply->error(), networkReply->errorString());
+    }
+
+    m_content = networkReply->readAll();
+    complete();
+}
+
+/*! Finishes this reply with the cached \a headers and \a content. */
+void QueuedNetworkReply::finish(const QList<RawHeaderPair> &headers, const QByteArray &content)
+{
+    setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
+    setAttribute(QNetworkRequest::HttpReasonPhraseAttribute, QByteArray("OK"));
+    setAttribute(QNetworkRequest::SourceIsFromCacheAttribute, true);
+
+    foreach (const RawHeaderPair &header, headers)
+        setRawHeader(header.first, header.second);
+
+    m_content = content;
+    complete();
+}
+
+/*! Finishes this reply without a response and with the given \a error and \a errorString. */
+void QueuedNetworkReply::finishWithError(const QNetworkReply::NetworkError &error, const QString &errorString)
+{
+    setError(error, errorString);
+    complete();
+}
+
+/*! Aborts the request of this reply. A queued request will not be sent any more. */
+void QueuedNetworkReply::abort()
+{
+    if (isFinished())
+        return;
+
+    emit abortRequested();
+}
+
+/*! Returns true, the content of a reply can only be read sequentially. */
+bool QueuedNetworkReply::isSequential() const
+{
+    return true;
+}
+
+/*! Returns the number of bytes of the content which have not been read yet. */
+qint64 QueuedNetworkReply::bytesAvailable() const
+{
+    return m_content.size() - m_offset + QNetworkReply::bytesAvailable();
+}
+
+/*! Reads up to \a maxSize bytes of the content into \a data and returns the number of bytes read. */
+qint64 QueuedNetworkReply::readData(char *data, qint64 maxSize)
+{
+    if (m_offset >= m_content.size())
+        return isFinished() ? -1 : 0;
+
+    qint64 count = qMin(maxSize, m_content.size() - m_offset);
+    memcpy(data, m_content.constData() + m_offset, count);
+    m_offset += count;
+    return count;
+}
+
+void QueuedNetworkReply::complete()
+{
+    m_timeoutTimer.stop();
+    m_networkReply = 0;
+    setFinished(true);
+
+    emit metaDataChanged();
+    if (!m_content.isEmpty())
+        emit readyRead();
+
+    emit finished();
+}
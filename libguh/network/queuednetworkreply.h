@@ -0,0 +1,85 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef QUEUEDNETWORKREPLY_H
+#define QUEUEDNETWORKREPLY_H
+
+#include <QObject>
+#include <QNetworkReply>
+#include <QNetworkAccessManager>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "libguh.h"
+#include "typeutils.h"
+
+class LIBGUH_EXPORT QueuedNetworkReply : public QNetworkReply
+{
+    Q_OBJECT
+public:
+    QueuedNetworkReply(const PluginId &pluginId, QNetworkAccessManager::Operation operation, const QNetworkRequest &request, const QByteArray &outgoingData, const QNetworkRequest::Priority &priority, QObject *parent = 0);
+    ~QueuedNetworkReply();
+
+    PluginId pluginId() const;
+    QByteArray outgoingData() const;
+    QNetworkRequest::Priority priority() const;
+    QString hostKey() const;
+
+    QNetworkReply *networkReply() const;
+    void setNetworkReply(QNetworkReply *networkReply);
+
+    QTimer *timeoutTimer();
+    bool timedOut() const;
+    void setTimedOut(const bool &timedOut);
+
+    qint64 elapsed() const;
+
+    void finish(QNetworkReply *networkReply);
+    void finish(const QList<RawHeaderPair> &headers, const QByteArray &content);
+    void finishWithError(const NetworkError &error, const QString &errorString);
+
+    void abort() override;
+    bool isSequential() const override;
+    qint64 bytesAvailable() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+
+private:
+    PluginId m_pluginId;
+    QByteArray m_outgoingData;
+    QNetworkRequest::Priority m_priority;
+    QNetworkReply *m_networkReply;
+    QTimer m_timeoutTimer;
+    bool m_timedOut;
+    QElapsedTimer m_elapsedTimer;
+
+    QByteArray m_content;
+    qint64 m_offset;
+
+    void complete();
+
+signals:
+    void abortRequested();
+    void released();
+
+};
+
+#endif // QUEUEDNETWORKREPLY_H
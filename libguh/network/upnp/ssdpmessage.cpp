@@ -0,0 +1,183 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+  \class SsdpMessage
+  \brief Holds the start line type and the headers of a parsed SSDP datagram.
+
+  \ingroup hardware
+  \inmodule libguh
+
+  Each datagram received by the \l{UpnpDiscovery} gets parsed exactly once into a SsdpMessage. The header
+  names are stored in upper case, so \l{header()} can be used without caring about the spelling of the sender.
+
+  \sa UpnpDiscovery
+*/
+
+/*! \enum SsdpMessage::Type
+
+    This enum type specifies the start line of a SSDP message.
+
+    \value TypeInvalid
+        The datagram is not a valid SSDP message.
+    \value TypeSearch
+        A \tt{M-SEARCH * HTTP/1.1} request.
+    \value TypeNotify
+        A \tt{NOTIFY * HTTP/1.1} advertisement.
+    \value TypeResponse
+        A \tt{HTTP/1.1 200 OK} response to a search request.
+*/
+
+#include "ssdpmessage.h"
+
+/*! Constructs an invalid SsdpMessage. */
+SsdpMessage::SsdpMessage() :
+    m_type(TypeInvalid)
+{
+}
+
+/*! Returns the SsdpMessage parsed from the given datagram \a data. */
+SsdpMessage SsdpMessage::parse(const QByteArray &data)
+{
+    SsdpMessage message;
+
+    int lineEnd = data.indexOf('\n');
+    QByteArray startLine = (lineEnd < 0 ? data : data.left(lineEnd)).trimmed();
+    if (startLine.startsWith("M-SEARCH")) {
+        message.m_type = TypeSearch;
+    } else if (startLine.startsWith("NOTIFY")) {
+        message.m_type = TypeNotify;
+    } else if (startLine.startsWith("HTTP/1.1 200")) {
+        message.m_type = TypeResponse;
+    } else {
+        return message;
+    }
+
+    int position = lineEnd + 1;
+    while (lineEnd >= 0 && position < data.length()) {
+        lineEnd = data.indexOf('\n', position);
+        QByteArray line = data.mid(position, lineEnd < 0 ? -1 : lineEnd - position);
+        position = lineEnd + 1;
+
+        int separatorIndex = line.indexOf(':');
+        if (separatorIndex <= 0) {
+            // the empty line terminates the header
+            if (line.trimmed().isEmpty())
+                break;
+
+            continue;
+        }
+
+        message.m_headers.insert(line.left(separatorIndex).trimmed().toUpper(), line.mid(separatorIndex + 1).trimmed());
+    }
+
+    return message;
+}
+
+/*! Returns true if this message has a known start line. */
+bool SsdpMessage::isValid() const
+{
+    return m_type != TypeInvalid;
+}
+
+/*! Returns the \l{SsdpMessage::Type}{Type} of this message. */
+SsdpMessage::Type SsdpMessage::type() const
+{
+    return m_type;
+}
+
+/*! Returns the value of the header with the given upper case \a name. */
+QByteArray SsdpMessage::header(const QByteArray &name) const
+{
+    return m_headers.value(name);
+}
+
+/*! Returns all headers of this message. The keys are upper case. */
+QHash<QByteArray, QByteArray> SsdpMessage::headers() const
+{
+    return m_headers;
+}
+
+/*! Returns the LOCATION header of this message. */
+QUrl SsdpMessage::location() const
+{
+    return QUrl(QString::fromUtf8(header("LOCATION")));
+}
+
+/*! Returns the unique service name (USN header) of this message. */
+QByteArray SsdpMessage::usn() const
+{
+    return header("USN");
+}
+
+/*! Returns the \tt{uuid:...} part of the USN of this message. */
+QByteArray SsdpMessage::uuid() const
+{
+    QByteArray usn = header("USN");
+    int separatorIndex = usn.indexOf("::");
+    return separatorIndex < 0 ? usn : usn.left(separatorIndex);
+}
+
+/*! Returns the notification type (NT header) of this message. */
+QByteArray SsdpMessage::notificationType() const
+{
+    return header("NT");
+}
+
+/*! Returns the notification sub type (NTS header, \tt{ssdp:alive}, \tt{ssdp:byebye} or \tt{ssdp:update}) of this message. */
+QByteArray SsdpMessage::notificationSubType() const
+{
+    return header("NTS");
+}
+
+/*! Returns the search target (ST header) of this message. */
+QByteArray SsdpMessage::searchTarget() const
+{
+    return header("ST");
+}
+
+/*! Returns the max-age [s] of the CACHE-CONTROL header or 1800, which is the minimum recommended by the specification. */
+int SsdpMessage::maxAge() const
+{
+    QByteArray cacheControl = header("CACHE-CONTROL");
+    int index = cacheControl.toLower().indexOf("max-age");
+    if (index < 0)
+        return 1800;
+
+    QByteArray value = cacheControl.mid(index + 7).trimmed();
+    if (!value.startsWith('='))
+        return 1800;
+
+    value = value.mid(1).trimmed();
+    int end = 0;
+    while (end < value.length() && value.at(end) >= '0' && value.at(end) <= '9')
+        end++;
+
+    bool ok = false;
+    int maxAge = value.left(end).toInt(&ok);
+    return ok ? maxAge : 1800;
+}
+
+/*! Writes the given \a message to the given \a debug. This method gets used just for debugging. */
+QDebug operator<<(QDebug debug, const SsdpMessage &message)
+{
+    debug.nospace() << "SsdpMessage(" << message.type() << ", " << message.usn() << ", " << message.location().toString() << ")";
+    return debug.space();
+}
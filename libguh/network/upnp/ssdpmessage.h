@@ -0,0 +1,69 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SSDPMESSAGE_H
+#define SSDPMESSAGE_H
+
+#include <QHash>
+#include <QUrl>
+#include <QDebug>
+#include <QByteArray>
+
+#include "libguh.h"
+
+// reference: http://upnp.org/specs/arch/UPnP-arch-DeviceArchitecture-v1.1.pdf
+
+class LIBGUH_EXPORT SsdpMessage
+{
+public:
+    enum Type {
+        TypeInvalid,
+        TypeSearch,
+        TypeNotify,
+        TypeResponse
+    };
+
+    SsdpMessage();
+
+    static SsdpMessage parse(const QByteArray &data);
+
+    bool isValid() const;
+    Type type() const;
+
+    QByteArray header(const QByteArray &name) const;
+    QHash<QByteArray, QByteArray> headers() const;
+
+    QUrl location() const;
+    QByteArray usn() const;
+    QByteArray uuid() const;
+    QByteArray notificationType() const;
+    QByteArray notificationSubType() const;
+    QByteArray searchTarget() const;
+    int maxAge() const;
+
+private:
+    Type m_type;
+    QHash<QByteArray, QByteArray> m_headers;
+};
+
+Q_DECLARE_METATYPE(SsdpMessage)
+QDebug operator<<(QDebug debug, const SsdpMessage &message);
+
+#endif // SSDPMESSAGE_H
@@ -0,0 +1,122 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+  \class UpnpDescriptorCache
+  \brief Caches the device descriptions fetched by the \l{UpnpDiscovery}.
+
+  \ingroup hardware
+  \inmodule libguh
+
+  A description stays valid for the max-age of the announcement it was fetched for and gets extended by each
+  \tt{ssdp:alive} message of the device. The cache remembers the location of each USN, so a device which moved
+  to a new location or said \tt{ssdp:byebye} will be fetched again. All times are milliseconds since epoch.
+
+  \sa UpnpDiscovery, SsdpMessage
+*/
+
+#include "upnpdescriptorcache.h"
+
+/*! Constructs an empty UpnpDescriptorCache. */
+UpnpDescriptorCache::UpnpDescriptorCache()
+{
+}
+
+/*! Remembers the \a location announced for the given \a usn. If the device was known with a different
+ *  location, the description of the old location gets dropped. */
+void UpnpDescriptorCache::updateLocation(const QByteArray &usn, const QUrl &location)
+{
+    if (usn.isEmpty())
+        return;
+
+    QUrl knownLocation = m_usnLocations.value(usn);
+    if (knownLocation.isValid() && knownLocation != location)
+        m_descriptors.remove(knownLocation);
+
+    m_usnLocations.insert(usn, location);
+}
+
+/*! Adds the \a descriptor, which will be valid for \a maxAge seconds starting at \a currentTime. */
+void UpnpDescriptorCache::insert(const UpnpDeviceDescriptor &descriptor, int maxAge, qint64 currentTime)
+{
+    CachedDescriptor cachedDescriptor;
+    cachedDescriptor.descriptor = descriptor;
+    cachedDescriptor.expirationTime = currentTime + maxAge * 1000;
+    m_descriptors.insert(descriptor.location(), cachedDescriptor);
+}
+
+/*! Updates the cache with the NOTIFY \a message received at \a currentTime. */
+void UpnpDescriptorCache::processNotification(const SsdpMessage &message, qint64 currentTime)
+{
+    QUrl location = m_usnLocations.value(message.usn());
+    if (!location.isValid())
+        return;
+
+    if (message.notificationSubType() == "ssdp:byebye") {
+        m_descriptors.remove(location);
+        m_usnLocations.remove(message.usn());
+        return;
+    }
+
+    // an alive message of a known device extends the lifetime of the description
+    if (message.notificationSubType() == "ssdp:alive" && message.location() == location && m_descriptors.contains(location))
+        m_descriptors[location].expirationTime = currentTime + message.maxAge() * 1000;
+}
+
+/*! Removes the descriptions which are expired at \a currentTime. The USN of a device is forgotten together with
+ *  its description, unless its location is one of the \a pendingLocations which are still being fetched. */
+void UpnpDescriptorCache::purge(qint64 currentTime, const QList<QUrl> &pendingLocations)
+{
+    QHash<QUrl, CachedDescriptor>::iterator it = m_descriptors.begin();
+    while (it != m_descriptors.end()) {
+        if (it.value().expirationTime <= currentTime) {
+            it = m_descriptors.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    QHash<QByteArray, QUrl>::iterator usnIt = m_usnLocations.begin();
+    while (usnIt != m_usnLocations.end()) {
+        if (!m_descriptors.contains(usnIt.value()) && !pendingLocations.contains(usnIt.value())) {
+            usnIt = m_usnLocations.erase(usnIt);
+        } else {
+            ++usnIt;
+        }
+    }
+}
+
+/*! Returns true if a description of the given \a location is cached and still valid at \a currentTime. */
+bool UpnpDescriptorCache::contains(const QUrl &location, qint64 currentTime) const
+{
+    return m_descriptors.contains(location) && m_descriptors.value(location).expirationTime > currentTime;
+}
+
+/*! Returns the cached description of the given \a location. */
+UpnpDeviceDescriptor UpnpDescriptorCache::descriptor(const QUrl &location) const
+{
+    return m_descriptors.value(location).descriptor;
+}
+
+/*! Returns the number of cached descriptions, including the expired ones which have not been purged yet. */
+int UpnpDescriptorCache::count() const
+{
+    return m_descriptors.count();
+}
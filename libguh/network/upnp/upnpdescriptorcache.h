@@ -0,0 +1,58 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef UPNPDESCRIPTORCACHE_H
+#define UPNPDESCRIPTORCACHE_H
+
+#include <QHash>
+#include <QUrl>
+#include <QList>
+#include <QByteArray>
+
+#include "upnpdevicedescriptor.h"
+#include "ssdpmessage.h"
+#include "libguh.h"
+
+class LIBGUH_EXPORT UpnpDescriptorCache
+{
+public:
+    UpnpDescriptorCache();
+
+    void updateLocation(const QByteArray &usn, const QUrl &location);
+    void insert(const UpnpDeviceDescriptor &descriptor, int maxAge, qint64 currentTime);
+    void processNotification(const SsdpMessage &message, qint64 currentTime);
+    void purge(qint64 currentTime, const QList<QUrl> &pendingLocations = QList<QUrl>());
+
+    bool contains(const QUrl &location, qint64 currentTime) const;
+    UpnpDeviceDescriptor descriptor(const QUrl &location) const;
+    int count() const;
+
+private:
+    struct CachedDescriptor {
+        UpnpDeviceDescriptor descriptor;
+        qint64 expirationTime;
+    };
+
+    // Device descriptions by location, valid for the max-age of the announcement
+    QHash<QUrl, CachedDescriptor> m_descriptors;
+    QHash<QByteArray, QUrl> m_usnLocations;
+};
+
+#endif // UPNPDESCRIPTORCACHE_H
@@ -28,6 +28,10 @@
   This resource allows plugins to discover UPnP devices in the network and receive notification messages. The resource
   will bind a UDP socket to the multicast 239.255.255.250 on port 1900.
 
+  Every received datagram gets parsed once into a \l{SsdpMessage}. The device descriptions of the responding
+  devices are cached by their location for the max-age of the announcement, so repeated responses and
+  overlapping discoveries do not fetch the same description again.
+
   The communication was implementet using following documentation: \l{http://upnp.org/specs/arch/UPnP-arch-DeviceArchitecture-v1.1.pdf}
 
   \sa UpnpDevice, UpnpDeviceDescriptor
@@ -41,8 +45,9 @@
  */
 
 /*!
- \fn UpnpDiscovery::upnpNotify(const QByteArray &notifyMessage)
- This signal will be emitted when a UPnP NOTIFY message \a notifyMessage will be recognized.
+ \fn UpnpDiscovery::upnpNotify(const SsdpMessage &notification)
+ This signal will be emitted when a UPnP NOTIFY message from another host was received. The \a notification
+ contains the parsed headers of the message.
  \sa DevicePlugin::upnpNotifyReceived()
  */
 
@@ -51,12 +56,15 @@
 #include "guhsettings.h"
 
 #include <QNetworkInterface>
+#include <QDateTime>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
 /*! Construct the hardware resource UpnpDiscovery with the given \a parent. */
 UpnpDiscovery::UpnpDiscovery(QObject *parent) :
-    QUdpSocket(parent)
+    QUdpSocket(parent),
+    m_serverPort(3333),
+    m_useSsl(false)
 {
     // bind udp socket and join multicast group
     m_port = 1900;
@@ -90,6 +98,9 @@ UpnpDiscovery::UpnpDiscovery(QObject *parent) :
 
     m_notificationTimer->start();
 
+    loadSettings();
+    updateInterfaces();
+
     qCDebug(dcDeviceManager) << "--> UPnP discovery created successfully.";
     sendAliveMessage();
     sendAliveMessage();
@@ -125,63 +136,161 @@ bool UpnpDiscovery::discoverDevices(const QString &searchTarget, const QString &
 }
 
 
-void UpnpDiscovery::requestDeviceInformation(const QNetworkRequest &networkRequest, const UpnpDeviceDescriptor &upnpDeviceDescriptor)
-{
-    QNetworkReply *replay;
-    replay = m_networkAccessManager->get(networkRequest);
-    m_informationRequestList.insert(replay, upnpDeviceDescriptor);
-}
-
-void UpnpDiscovery::respondToSearchRequest(QHostAddress host, int port)
+void UpnpDiscovery::loadSettings()
 {
     GuhSettings settings(GuhSettings::SettingsRoleDevices);
     settings.beginGroup("guhd");
-    QByteArray uuid = settings.value("uuid", QVariant()).toByteArray();
-    if (uuid.isEmpty()) {
-        uuid = QUuid::createUuid().toByteArray().replace("{", "").replace("}","");
-        settings.setValue("uuid", uuid);
+    m_uuid = settings.value("uuid", QVariant()).toByteArray();
+    if (m_uuid.isEmpty()) {
+        m_uuid = QUuid::createUuid().toByteArray().replace("{", "").replace("}","");
+        settings.setValue("uuid", m_uuid);
     }
     settings.endGroup();
 
     GuhSettings globalSettings(GuhSettings::SettingsRoleGlobal);
     globalSettings.beginGroup("WebServer");
-    int serverPort = settings.value("port", 3333).toInt();
-    bool useSsl = settings.value("https", false).toBool();
+    m_serverPort = globalSettings.value("port", 3333).toInt();
+    m_useSsl = globalSettings.value("https", false).toBool();
     globalSettings.endGroup();
+}
+
+void UpnpDiscovery::updateInterfaces()
+{
+    m_localAddresses = QNetworkInterface::allAddresses();
+    m_locations.clear();
+    m_searchResponses.clear();
 
     foreach (const QNetworkInterface &interface,  QNetworkInterface::allInterfaces()) {
-        foreach (QNetworkAddressEntry entry, interface.addressEntries()) {
-            // check IPv4
-            if (entry.ip().protocol() == QAbstractSocket::IPv4Protocol) {
-                // check subnet
-                if (host.isInSubnet(QHostAddress::parseSubnet(entry.ip().toString() + "/24"))) {
-                    QString locationString;
-                    if (useSsl) {
-                        locationString = "https://" + entry.ip().toString() + ":" + QString::number(serverPort) + "/server.xml";
-                    } else {
-                        locationString = "http://" + entry.ip().toString() + ":" + QString::number(serverPort) + "/server.xml";
-                    }
+        // listen only on IPv4
+        foreach (const QNetworkAddressEntry &entry, interface.addressEntries()) {
+            if (entry.ip().protocol() != QAbstractSocket::IPv4Protocol)
+                continue;
 
-                    // http://upnp.org/specs/basic/UPnP-basic-Basic-v1-Device.pdf
-                    QByteArray rootdeviceResponseMessage = QByteArray("HTTP/1.1 200 OK\r\n"
-                                                                      "CACHE-CONTROL: max-age=1900\r\n"
-                                                                      "DATE: " + QDateTime::currentDateTime().toString("ddd, dd MMM yyyy hh:mm:ss").toUtf8() + " GMT\r\n"
-                                                                      "EXT:\r\n"
-                                                                      "CONTENT-LENGTH:0\r\n"
-                                                                      "LOCATION: " + locationString.toUtf8() + "\r\n"
-                                                                      "SERVER: guh/" + QByteArray(GUH_VERSION_STRING) + " UPnP/1.1 \r\n"
-                                                                      "ST:upnp:rootdevice\r\n"
-                                                                      "USN:uuid:" + uuid + "::urn:schemas-upnp-org:device:Basic:1\r\n"
-                                                                      "\r\n");
-
-                    //qCDebug(dcHardware) << QString("Sending response to %1:%2\n").arg(host.toString()).arg(port);
-                    writeDatagram(rootdeviceResponseMessage, host, port);
-                }
+            QString locationString;
+            if (m_useSsl) {
+                locationString = "https://" + entry.ip().toString() + ":" + QString::number(m_serverPort) + "/server.xml";
+            } else {
+                locationString = "http://" + entry.ip().toString() + ":" + QString::number(m_serverPort) + "/server.xml";
             }
+            m_locations.append(locationString.toUtf8());
+
+            // http://upnp.org/specs/basic/UPnP-basic-Basic-v1-Device.pdf
+            SearchResponse response;
+            response.subnet = QHostAddress::parseSubnet(entry.ip().toString() + "/24");
+            response.messageHead = QByteArray("HTTP/1.1 200 OK\r\n"
+                                              "CACHE-CONTROL: max-age=1900\r\n"
+                                              "DATE: ");
+            response.messageTail = QByteArray(" GMT\r\n"
+                                              "EXT:\r\n"
+                                              "CONTENT-LENGTH:0\r\n"
+                                              "LOCATION: " + locationString.toUtf8() + "\r\n"
+                                              "SERVER: guh/" + QByteArray(GUH_VERSION_STRING) + " UPnP/1.1 \r\n"
+                                              "ST:upnp:rootdevice\r\n"
+                                              "USN:uuid:" + m_uuid + "::urn:schemas-upnp-org:device:Basic:1\r\n"
+                                              "\r\n");
+            m_searchResponses.append(response);
         }
     }
 }
 
+void UpnpDiscovery::processDatagram(const QByteArray &data, const QHostAddress &hostAddress, quint16 port)
+{
+    SsdpMessage message = SsdpMessage::parse(data);
+    switch (message.type()) {
+    case SsdpMessage::TypeSearch:
+        if (!m_localAddresses.contains(hostAddress))
+            respondToSearchRequest(hostAddress, port);
+
+        break;
+    case SsdpMessage::TypeNotify:
+        if (m_localAddresses.contains(hostAddress))
+            break;
+
+        m_descriptorCache.processNotification(message, QDateTime::currentMSecsSinceEpoch());
+        emit upnpNotify(message);
+        break;
+    case SsdpMessage::TypeResponse:
+        processSearchResponse(message, hostAddress);
+        break;
+    default:
+        break;
+    }
+}
+
+void UpnpDiscovery::processSearchResponse(const SsdpMessage &message, const QHostAddress &hostAddress)
+{
+    if (m_discoverRequests.isEmpty())
+        return;
+
+    QUrl location = message.location();
+    if (!location.isValid())
+        return;
+
+    // a device which got a new location has to be fetched again
+    m_descriptorCache.updateLocation(message.usn(), location);
+
+    if (m_descriptorCache.contains(location, QDateTime::currentMSecsSinceEpoch())) {
+        deliverDeviceDescriptor(m_descriptorCache.descriptor(location));
+        return;
+    }
+
+    // each service of a device responds with the same location, fetch it only once
+    if (m_pendingLocations.contains(location))
+        return;
+
+    UpnpDeviceDescriptor upnpDeviceDescriptor;
+    upnpDeviceDescriptor.setLocation(location);
+    upnpDeviceDescriptor.setHostAddress(hostAddress);
+    upnpDeviceDescriptor.setPort(location.port());
+
+    m_pendingLocations.insert(location, message.maxAge());
+    requestDeviceInformation(m_discoverRequests.first()->createNetworkRequest(upnpDeviceDescriptor), upnpDeviceDescriptor);
+}
+
+void UpnpDiscovery::deliverDeviceDescriptor(const UpnpDeviceDescriptor &upnpDeviceDescriptor)
+{
+    foreach (UpnpDiscoveryRequest *upnpDiscoveryRequest, m_discoverRequests) {
+        upnpDiscoveryRequest->addDeviceDescriptor(upnpDeviceDescriptor);
+    }
+}
+
+void UpnpDiscovery::requestDeviceInformation(const QNetworkRequest &networkRequest, const UpnpDeviceDescriptor &upnpDeviceDescriptor)
+{
+    QNetworkReply *replay;
+    replay = m_networkAccessManager->get(networkRequest);
+    m_informationRequestList.insert(replay, upnpDeviceDescriptor);
+}
+
+void UpnpDiscovery::respondToSearchRequest(QHostAddress host, int port)
+{
+    QByteArray date;
+    foreach (const SearchResponse &response, m_searchResponses) {
+        // check subnet
+        if (!host.isInSubnet(response.subnet))
+            continue;
+
+        if (date.isEmpty())
+            date = QDateTime::currentDateTimeUtc().toString("ddd, dd MMM yyyy hh:mm:ss").toUtf8();
+
+        //qCDebug(dcHardware) << QString("Sending response to %1:%2\n").arg(host.toString()).arg(port);
+        writeDatagram(response.messageHead + date + response.messageTail, host, port);
+    }
+}
+
+QByteArray UpnpDiscovery::createNotifyMessage(const QByteArray &location, const QByteArray &notificationSubType) const
+{
+    // http://upnp.org/specs/basic/UPnP-basic-Basic-v1-Device.pdf
+    return QByteArray("NOTIFY * HTTP/1.1\r\n"
+                      "HOST:239.255.255.250:1900\r\n"
+                      "CACHE-CONTROL: max-age=1900\r\n"
+                      "LOCATION: " + location + "\r\n"
+                      "NT:urn:schemas-upnp-org:device:Basic:1\r\n"
+                      "USN:uuid:" + m_uuid + "::urn:schemas-upnp-org:device:Basic:1\r\n"
+                      "NTS: " + notificationSubType + "\r\n"
+                      "SERVER: guh/" + QByteArray(GUH_VERSION_STRING) + " UPnP/1.1 \r\n"
+                      "\r\n");
+}
+
 /*! This method will be called to send the SSDP message \a data to the UPnP multicast.*/
 void UpnpDiscovery::sendToMulticast(const QByteArray &data)
 {
@@ -195,50 +304,17 @@ void UpnpDiscovery::error(QAbstractSocket::SocketError error)
 
 void UpnpDiscovery::readData()
 {
-    QByteArray data;
-    quint16 port;
-    QHostAddress hostAddress;
-    QUrl location;
-
-    // read the answere from the multicast
+    // process every datagram of a burst
     while (hasPendingDatagrams()) {
-        data.resize(pendingDatagramSize());
-        readDatagram(data.data(), data.size(), &hostAddress, &port);
-    }
-
-    if (data.contains("M-SEARCH") && !QNetworkInterface::allAddresses().contains(hostAddress)) {
-        respondToSearchRequest(hostAddress, port);
-        return;
-    }
+        QByteArray data;
+        quint16 port = 0;
+        QHostAddress hostAddress;
 
-    if (data.contains("NOTIFY") && !QNetworkInterface::allAddresses().contains(hostAddress)) {
-        emit upnpNotify(data);
-        return;
-    }
-
-    // if the data contains the HTTP OK header...
-    if (data.contains("HTTP/1.1 200 OK")) {
-        const QStringList lines = QString(data).split("\r\n");
-        foreach (const QString& line, lines) {
-            int separatorIndex = line.indexOf(':');
-            QString key = line.left(separatorIndex).toUpper();
-            QString value = line.mid(separatorIndex+1).trimmed();
-
-            // get location
-            if (key.contains("LOCATION") || key.contains("location") || key.contains("Location")) {
-                location = QUrl(value);
-            }
-        }
-
-        UpnpDeviceDescriptor upnpDeviceDescriptor;
-        upnpDeviceDescriptor.setLocation(location);
-        upnpDeviceDescriptor.setHostAddress(hostAddress);
-        upnpDeviceDescriptor.setPort(location.port());
+        data.resize(pendingDatagramSize());
+        if (readDatagram(data.data(), data.size(), &hostAddress, &port) < 0)
+            continue;
 
-        foreach (UpnpDiscoveryRequest *upnpDiscoveryRequest, m_discoverRequests) {
-            QNetworkRequest networkRequest = upnpDiscoveryRequest->createNetworkRequest(upnpDeviceDescriptor);
-            requestDeviceInformation(networkRequest, upnpDeviceDescriptor);
-        }
+        processDatagram(data, hostAddress, port);
     }
 }
 
@@ -250,6 +326,7 @@ void UpnpDiscovery::replyFinished(QNetworkReply *reply)
     case(200):{
         QByteArray data = reply->readAll();
         UpnpDeviceDescriptor upnpDeviceDescriptor = m_informationRequestList.take(reply);
+        int maxAge = m_pendingLocations.take(upnpDeviceDescriptor.location());
 
         // parse XML data
         QXmlStreamReader xml(data);
@@ -304,14 +381,14 @@ void UpnpDiscovery::replyFinished(QNetworkReply *reply)
             }
         }
 
-        foreach (UpnpDiscoveryRequest *upnpDiscoveryRequest, m_discoverRequests) {
-            upnpDiscoveryRequest->addDeviceDescriptor(upnpDeviceDescriptor);
-        }
+        m_descriptorCache.insert(upnpDeviceDescriptor, maxAge, QDateTime::currentMSecsSinceEpoch());
+
+        deliverDeviceDescriptor(upnpDeviceDescriptor);
         break;
     }
     default:
         qCWarning(dcHardware) << "HTTP request error" << reply->request().url().toString() << status;
-        m_informationRequestList.remove(reply);
+        m_pendingLocations.remove(m_informationRequestList.take(reply).location());
     }
 
     reply->deleteLater();
@@ -319,96 +396,23 @@ void UpnpDiscovery::replyFinished(QNetworkReply *reply)
 
 void UpnpDiscovery::notificationTimeout()
 {
+    loadSettings();
+    updateInterfaces();
+    m_descriptorCache.purge(QDateTime::currentMSecsSinceEpoch(), m_pendingLocations.keys());
     sendAliveMessage();
 }
 
 void UpnpDiscovery::sendByeByeMessage()
 {
-    GuhSettings settings(GuhSettings::SettingsRoleDevices);
-    settings.beginGroup("guhd");
-    QByteArray uuid = settings.value("uuid", QVariant()).toByteArray();
-    if (uuid.isEmpty()) {
-        uuid = QUuid::createUuid().toByteArray().replace("{", "").replace("}","");
-        settings.setValue("uuid", uuid);
-    }
-    settings.endGroup();
-
-    GuhSettings globalSettings(GuhSettings::SettingsRoleGlobal);
-    globalSettings.beginGroup("WebServer");
-    int port = settings.value("port", 3333).toInt();
-    bool useSsl = settings.value("https", false).toBool();
-    globalSettings.endGroup();
-
-    foreach (const QNetworkInterface &interface,  QNetworkInterface::allInterfaces()) {
-        // listen only on IPv4
-        foreach (QNetworkAddressEntry entry, interface.addressEntries()) {
-            if (entry.ip().protocol() == QAbstractSocket::IPv4Protocol) {
-                QString locationString;
-                if (useSsl) {
-                    locationString = "https://" + entry.ip().toString() + ":" + QString::number(port) + "/server.xml";
-                } else {
-                    locationString = "http://" + entry.ip().toString() + ":" + QString::number(port) + "/server.xml";
-                }
-
-                // http://upnp.org/specs/basic/UPnP-basic-Basic-v1-Device.pdf
-                QByteArray byebyeMessage = QByteArray("NOTIFY * HTTP/1.1\r\n"
-                                                                  "HOST:239.255.255.250:1900\r\n"
-                                                                  "CACHE-CONTROL: max-age=1900\r\n"
-                                                                  "LOCATION: " + locationString.toUtf8() + "\r\n"
-                                                                  "NT:urn:schemas-upnp-org:device:Basic:1\r\n"
-                                                                  "USN:uuid:" + uuid + "::urn:schemas-upnp-org:device:Basic:1\r\n"
-                                                                  "NTS: ssdp:byebye\r\n"
-                                                                  "SERVER: guh/" + QByteArray(GUH_VERSION_STRING) + " UPnP/1.1 \r\n"
-                                                                  "\r\n");
-
-                sendToMulticast(byebyeMessage);
-            }
-        }
+    foreach (const QByteArray &location, m_locations) {
+        sendToMulticast(createNotifyMessage(location, "ssdp:byebye"));
     }
 }
 
 void UpnpDiscovery::sendAliveMessage()
 {
-    GuhSettings settings(GuhSettings::SettingsRoleDevices);
-    settings.beginGroup("guhd");
-    QByteArray uuid = settings.value("uuid", QVariant()).toByteArray();
-    if (uuid.isEmpty()) {
-        uuid = QUuid::createUuid().toByteArray().replace("{", "").replace("}","");
-        settings.setValue("uuid", uuid);
-    }
-    settings.endGroup();
-
-    GuhSettings globalSettings(GuhSettings::SettingsRoleGlobal);
-    globalSettings.beginGroup("WebServer");
-    int port = settings.value("port", 3333).toInt();
-    bool useSsl = settings.value("https", false).toBool();
-    globalSettings.endGroup();
-
-    foreach (const QNetworkInterface &interface,  QNetworkInterface::allInterfaces()) {
-        // listen only on IPv4
-        foreach (QNetworkAddressEntry entry, interface.addressEntries()) {
-            if (entry.ip().protocol() == QAbstractSocket::IPv4Protocol) {
-                QString locationString;
-                if (useSsl) {
-                    locationString = "https://" + entry.ip().toString() + ":" + QString::number(port) + "/server.xml";
-                } else {
-                    locationString = "http://" + entry.ip().toString() + ":" + QString::number(port) + "/server.xml";
-                }
-
-                // http://upnp.org/specs/basic/UPnP-basic-Basic-v1-Device.pdf
-                QByteArray aliveMessage = QByteArray("NOTIFY * HTTP/1.1\r\n"
-                                                                  "HOST:239.255.255.250:1900\r\n"
-                                                                  "CACHE-CONTROL: max-age=1900\r\n"
-                                                                  "LOCATION: " + locationString.toUtf8() + "\r\n"
-                                                                  "NT:urn:schemas-upnp-org:device:Basic:1\r\n"
-                                                                  "USN:uuid:" + uuid + "::urn:schemas-upnp-org:device:Basic:1\r\n"
-                                                                  "NTS: ssdp:alive\r\n"
-                                                                  "SERVER: guh/" + QByteArray(GUH_VERSION_STRING) + " UPnP/1.1 \r\n"
-                                                                  "\r\n");
-
-                sendToMulticast(aliveMessage);
-            }
-        }
+    foreach (const QByteArray &location, m_locations) {
+        sendToMulticast(createNotifyMessage(location, "ssdp:alive"));
     }
 }
 
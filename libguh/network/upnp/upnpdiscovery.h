@@ -31,6 +31,8 @@
 
 #include "upnpdiscoveryrequest.h"
 #include "upnpdevicedescriptor.h"
+#include "upnpdescriptorcache.h"
+#include "ssdpmessage.h"
 #include "devicemanager.h"
 #include "libguh.h"
 
@@ -50,6 +52,12 @@ public:
     void sendToMulticast(const QByteArray &data);
 
 private:
+    struct SearchResponse {
+        QPair<QHostAddress, int> subnet;
+        QByteArray messageHead;
+        QByteArray messageTail;
+    };
+
     QHostAddress m_host;
     qint16 m_port;
 
@@ -60,12 +68,31 @@ private:
     QList<UpnpDiscoveryRequest *> m_discoverRequests;
     QHash<QNetworkReply*,UpnpDeviceDescriptor> m_informationRequestList;
 
+    UpnpDescriptorCache m_descriptorCache;
+    QHash<QUrl, int> m_pendingLocations;
+
+    // Settings and interfaces, refreshed with each alive message
+    QByteArray m_uuid;
+    int m_serverPort;
+    bool m_useSsl;
+    QList<QHostAddress> m_localAddresses;
+    QList<QByteArray> m_locations;
+    QList<SearchResponse> m_searchResponses;
+
+    void loadSettings();
+    void updateInterfaces();
+
+    void processDatagram(const QByteArray &data, const QHostAddress &hostAddress, quint16 port);
+    void processSearchResponse(const SsdpMessage &message, const QHostAddress &hostAddress);
+    void deliverDeviceDescriptor(const UpnpDeviceDescriptor &upnpDeviceDescriptor);
+
     void requestDeviceInformation(const QNetworkRequest &networkRequest, const UpnpDeviceDescriptor &upnpDeviceDescriptor);
     void respondToSearchRequest(QHostAddress host, int port);
+    QByteArray createNotifyMessage(const QByteArray &location, const QByteArray &notificationSubType) const;
 
 signals:
     void discoveryFinished(const QList<UpnpDeviceDescriptor> &deviceDescriptorList, const PluginId & pluginId);
-    void upnpNotify(const QByteArray &notifyMessage);
+    void upnpNotify(const SsdpMessage &notification);
 
 private slots:
     void error(QAbstractSocket::SocketError error);
@@ -50,17 +50,12 @@ void UpnpDiscoveryRequest::discover()
 
 void UpnpDiscoveryRequest::addDeviceDescriptor(const UpnpDeviceDescriptor &deviceDescriptor)
 {
-
     // check if we allready have the device in the list
-    bool isAlreadyInList = false;
-    foreach (UpnpDeviceDescriptor upnpDeviceDescriptor, m_deviceList) {
-        if (upnpDeviceDescriptor.uuid() == deviceDescriptor.uuid()) {
-            isAlreadyInList = true;
-        }
-    }
-    if (!isAlreadyInList) {
-        m_deviceList.append(deviceDescriptor);
-    }
+    if (m_deviceUuids.contains(deviceDescriptor.uuid()))
+        return;
+
+    m_deviceUuids.insert(deviceDescriptor.uuid());
+    m_deviceList.append(deviceDescriptor);
 }
 
 QNetworkRequest UpnpDiscoveryRequest::createNetworkRequest(UpnpDeviceDescriptor deviveDescriptor)
@@ -23,6 +23,7 @@
 
 #include <QObject>
 #include <QDebug>
+#include <QSet>
 
 #include "upnpdiscovery.h"
 #include "upnpdevicedescriptor.h"
@@ -54,6 +55,7 @@ private:
     QString m_userAgent;
 
     QList<UpnpDeviceDescriptor> m_deviceList;
+    QSet<QString> m_deviceUuids;
 
 signals:
     void discoveryTimeout();
@@ -29,6 +29,10 @@
   This class holds the values for configured devices. It is associated with a \{DeviceClass} which
   can be used to get more details about the device.
 
+  The name, params, states and setup status of a Device can be accessed from any thread, so a \l{DevicePlugin} running on a
+  \l{PluginThread} can update them while the main thread reads them. The stateValueChanged() signal gets
+  delivered to the \l{DeviceManager} on the main thread.
+
   \sa DeviceClass, DeviceDescriptor
 */
 
@@ -67,6 +71,7 @@ Device::Device(const PluginId &pluginId, const DeviceClassId &deviceClassId, QOb
 
 void Device::setupCompleted()
 {
+    QMutexLocker locker(&m_mutex);
     m_setupComplete = true;
 }
 
@@ -91,30 +96,35 @@ PluginId Device::pluginId() const
 /*! Returns the name of this Device. This is visible to the user. */
 QString Device::name() const
 {
+    QMutexLocker locker(&m_mutex);
     return m_name;
 }
 
 /*! Set the \a name for this Device. This is visible to the user.*/
 void Device::setName(const QString &name)
 {
+    QMutexLocker locker(&m_mutex);
     m_name = name;
 }
 
 /*! Returns the parameter of this Device. It must match the parameter description in the associated \l{DeviceClass}. */
 ParamList Device::params() const
 {
+    QMutexLocker locker(&m_mutex);
     return m_params;
 }
 
 /*! Sets the \a params of this Device. It must match the parameter description in the associated \l{DeviceClass}. */
 void Device::setParams(const ParamList &params)
 {
+    QMutexLocker locker(&m_mutex);
     m_params = params;
 }
 
 /*! Returns the value of the \l{Param} of this Device with the given \a paramTypeId. */
 QVariant Device::paramValue(const ParamTypeId &paramTypeId) const
 {
+    QMutexLocker locker(&m_mutex);
     foreach (const Param &param, m_params) {
         if (param.paramTypeId() == paramTypeId) {
             return param.value();
@@ -126,6 +136,7 @@ QVariant Device::paramValue(const ParamTypeId &paramTypeId) const
 /*! Sets the \a value of the \l{Param} with the given \a paramTypeId. */
 void Device::setParamValue(const ParamTypeId &paramTypeId, const QVariant &value)
 {
+    QMutexLocker locker(&m_mutex);
     ParamList params;
     foreach (Param param, m_params) {
         if (param.paramTypeId() == paramTypeId) {
@@ -139,24 +150,28 @@ void Device::setParamValue(const ParamTypeId &paramTypeId, const QVariant &value
 /*! Returns the states of this Device. It must match the \l{StateType} description in the associated \l{DeviceClass}. */
 QList<State> Device::states() const
 {
+    QMutexLocker locker(&m_mutex);
     return m_states;
 }
 
 /*! Returns true, a \l{Param} with the given \a paramTypeId exists for this Device. */
 bool Device::hasParam(const ParamTypeId &paramTypeId) const
 {
+    QMutexLocker locker(&m_mutex);
     return m_params.hasParam(paramTypeId);
 }
 
 /*! Set the \l{State}{States} of this \l{Device} to the given \a states.*/
 void Device::setStates(const QList<State> &states)
 {
+    QMutexLocker locker(&m_mutex);
     m_states = states;
 }
 
 /*! Returns true, a \l{State} with the given \a stateTypeId exists for this Device. */
 bool Device::hasState(const StateTypeId &stateTypeId) const
 {
+    QMutexLocker locker(&m_mutex);
     foreach (const State &state, m_states) {
         if (state.stateTypeId() == stateTypeId) {
             return true;
@@ -168,6 +183,7 @@ bool Device::hasState(const StateTypeId &stateTypeId) const
 /*! For convenience, this finds the \l{State} matching the given \a stateTypeId and returns the current valie in this Device. */
 QVariant Device::stateValue(const StateTypeId &stateTypeId) const
 {
+    QMutexLocker locker(&m_mutex);
     foreach (const State &state, m_states) {
         if (state.stateTypeId() == stateTypeId) {
             return state.value();
@@ -179,6 +195,7 @@ QVariant Device::stateValue(const StateTypeId &stateTypeId) const
 /*! For convenience, this finds the \l{State} matching the given \a stateTypeId in this Device and sets the current value to \a value. */
 void Device::setStateValue(const StateTypeId &stateTypeId, const QVariant &value)
 {
+    QMutexLocker locker(&m_mutex);
     for (int i = 0; i < m_states.count(); ++i) {
         if (m_states.at(i).stateTypeId() == stateTypeId) {
             if (m_states.at(i).value() == value)
@@ -191,16 +208,21 @@ void Device::setStateValue(const StateTypeId &stateTypeId, const QVariant &value
             State newState(stateTypeId, m_id);
             newState.setValue(value);
             m_states[i] = newState;
+
+            // The receivers may read the states again
+            locker.unlock();
             emit stateValueChanged(stateTypeId, value);
             return;
         }
     }
-    qCWarning(dcDeviceManager) << "Failed setting state for" << m_name << value;
+    locker.unlock();
+    qCWarning(dcDeviceManager) << "Failed setting state for" << name() << value;
 }
 
 /*! Returns the \l{State} with the given \a stateTypeId of this Device. */
 State Device::state(const StateTypeId &stateTypeId) const
 {
+    QMutexLocker locker(&m_mutex);
     for (int i = 0; i < m_states.count(); ++i) {
         if (m_states.at(i).stateTypeId() == stateTypeId) {
             return m_states.at(i);
@@ -228,10 +250,12 @@ void Device::setParentId(const DeviceId &parentId)
 /*! Returns true, if setup of this Device is already completed. */
 bool Device::setupComplete() const
 {
+    QMutexLocker locker(&m_mutex);
     return m_setupComplete;
 }
 
 void Device::setSetupComplete(const bool &complete)
 {
+    QMutexLocker locker(&m_mutex);
     m_setupComplete = complete;
 }
@@ -29,6 +29,7 @@
 #include "types/state.h"
 #include "types/param.h"
 
+#include <QMutex>
 #include <QObject>
 #include <QUuid>
 #include <QVariant>
@@ -87,6 +88,8 @@ private:
     ParamList m_params;
     QList<State> m_states;
     bool m_setupComplete;
+
+    mutable QMutex m_mutex;
 };
 
 #endif
@@ -28,6 +28,12 @@
 
   When implementing a new plugin, start by subclassing this and implementing the following
   pure virtual method \l{DevicePlugin::requiredHardware()}
+
+  A plugin which declares a \tt workerThread in its JSON file runs on a \l{PluginThread}. Such a plugin must create
+  its objects as children of the plugin, so they get moved to the thread with it, and report results of setupDevice(),
+  executeAction(), discoverDevices() and confirmPairing() with the corresponding signals, as the \l{DeviceManager}
+  treats every call into it as asynchronous. The QNetworkReply objects of the network manager stay on the main thread,
+  the plugin gets them in networkManagerReplyReady() once they are finished.
 */
 
 /*!
@@ -38,12 +44,30 @@
  \sa DeviceManager::HardwareResource
  */
 
+/*!
+ \fn Radio433CodeWord::Protocols DevicePlugin::radio433Protocols() const
+ Return the 433 MHz \l{Radio433CodeWord::Protocol}{Protocols} this plugin understands. Received frames get
+ decoded once by the \l{DeviceManager} and only frames matching one of these protocols will be delivered
+ to \l{DevicePlugin::radioCodeReceived()}. The default implementation returns
+ \l{Radio433CodeWord}{ProtocolRaw}, which delivers every undecoded frame to \l{DevicePlugin::radioData()}.
+ Plugins which only transmit should return \l{Radio433CodeWord}{ProtocolNone}.
+
+ \sa DeviceManager::HardwareResourceRadio433
+ */
+
 /*!
  \fn void DevicePlugin::radioData(const QList<int> &rawData)
- If the plugin has requested any radio device using \l{DevicePlugin::requiredHardware()}, this slot will
+ If the plugin has requested any radio device using \l{DevicePlugin::requiredHardware()} and declared
+ \l{Radio433CodeWord}{ProtocolRaw} in \l{DevicePlugin::radio433Protocols()}, this slot will
  be called when there is \a rawData available from that device.
  */
 
+/*!
+ \fn void DevicePlugin::radioCodeReceived(const Radio433CodeWord &codeWord)
+ If the plugin has requested any radio device using \l{DevicePlugin::requiredHardware()}, this slot will
+ be called with the decoded \a codeWord of each received frame matching one of the \l{DevicePlugin::radio433Protocols()}.
+ */
+
 /*!
  \fn void DevicePlugin::guhTimer()
  If the plugin has requested the timer using \l{DevicePlugin::requiredHardware()}, this slot will be called
@@ -60,9 +84,21 @@
  */
 
 /*!
- \fn void DevicePlugin::upnpNotifyReceived(const QByteArray &notifyData)
- If a UPnP device will notify a NOTIFY message in the network, the \l{UpnpDiscovery} will catch the
- notification data and call this method with the \a notifyData.
+ \fn QStringList DevicePlugin::upnpNotifyFilter() const
+ Return the NT or USN values of the UPnP NOTIFY messages this plugin wants to receive in
+ \l{DevicePlugin::upnpNotifyReceived()}. A filter may contain the wildcards \tt{*} and \tt{?}, for example
+ \tt{urn:Belkin:service:*}. To receive only the notifications of its own devices, a plugin can return the
+ \tt{uuid:...} of each of its devices. The filters are matched case insensitive and will be requested again whenever
+ devices get added or removed.
+ The default implementation returns an empty list, which means the plugin does not receive any notification.
+
+ \sa SsdpMessage
+ */
+
+/*!
+ \fn void DevicePlugin::upnpNotifyReceived(const SsdpMessage &notification)
+ If a UPnP device will notify a NOTIFY message in the network, the \l{UpnpDiscovery} will parse it once
+ and call this method with the \a notification if it matches one of the \l{DevicePlugin::upnpNotifyFilter()}.
 
  \note Only if if the plugin has requested the \l{DeviceManager::HardwareResourceUpnpDisovery} resource
  using \l{DevicePlugin::requiredHardware()}, this slot will be called.
@@ -138,6 +174,7 @@
 
 #include "devicemanager.h"
 #include "guhsettings.h"
+#include "plugin/pluginthread.h"
 #include "hardware/radio433/radio433.h"
 #include "network/upnp/upnpdiscovery.h"
 
@@ -688,6 +725,7 @@ QPair<bool, QList<ParamType> > DevicePlugin::parseParamTypes(const QJsonArray &a
  */
 ParamList DevicePlugin::configuration() const
 {
+    QMutexLocker locker(&m_configMutex);
     return m_config;
 }
 
@@ -700,6 +738,7 @@ ParamList DevicePlugin::configuration() const
  */
 QVariant DevicePlugin::configValue(const ParamTypeId &paramTypeId) const
 {
+    QMutexLocker locker(&m_configMutex);
     return m_config.paramValue(paramTypeId);
 }
 
@@ -736,6 +775,8 @@ DeviceManager::DeviceError DevicePlugin::setConfigValue(const ParamTypeId &param
         return DeviceManager::DeviceErrorInvalidParameter;
     }
 
+    // The configuration can be set from the main thread while the plugin runs on a worker thread
+    QMutexLocker locker(&m_configMutex);
     if (m_config.hasParam(paramTypeId)) {
         if (!m_config.setParamValue(paramTypeId, value)) {
             qCWarning(dcDeviceManager()) << "Could not set param value" << value << "for param with id" << paramTypeId.toString();
@@ -744,6 +785,7 @@ DeviceManager::DeviceError DevicePlugin::setConfigValue(const ParamTypeId &param
     } else {
         m_config.append(Param(paramTypeId, value));
     }
+    locker.unlock();
 
     emit configValueChanged(paramTypeId, value);
     return DeviceManager::DeviceErrorNoError;
@@ -805,8 +847,13 @@ Device *DevicePlugin::findDeviceByParams(const ParamList &params) const
 bool DevicePlugin::transmitData(int delay, QList<int> rawData, int repetitions)
 {
     switch (requiredHardware()) {
-    case DeviceManager::HardwareResourceRadio433:
-        return deviceManager()->m_radio433->sendData(delay, rawData, repetitions);
+    case DeviceManager::HardwareResourceRadio433: {
+        bool sent = false;
+        deviceManager()->m_mailbox->call([this, &sent, delay, rawData, repetitions]() {
+            sent = deviceManager()->m_radio433->sendData(delay, rawData, repetitions);
+        });
+        return sent;
+    }
     default:
         qCWarning(dcDeviceManager) << "Unknown harware type. Cannot send.";
     }
@@ -823,7 +870,11 @@ bool DevicePlugin::transmitData(int delay, QList<int> rawData, int repetitions)
 QNetworkReply *DevicePlugin::networkManagerGet(const QNetworkRequest &request)
 {
     if (requiredHardware().testFlag(DeviceManager::HardwareResourceNetworkManager)) {
-        return deviceManager()->m_networkManager->get(pluginId(), request);
+        QNetworkReply *reply = nullptr;
+        deviceManager()->m_mailbox->call([this, &reply, &request]() {
+            reply = deviceManager()->m_networkManager->get(pluginId(), request);
+        });
+        return reply;
     } else {
         qCWarning(dcDeviceManager) << "Network manager hardware resource not set for plugin" << pluginName();
     }
@@ -840,7 +891,11 @@ QNetworkReply *DevicePlugin::networkManagerGet(const QNetworkRequest &request)
 QNetworkReply *DevicePlugin::networkManagerPost(const QNetworkRequest &request, const QByteArray &data)
 {
     if (requiredHardware().testFlag(DeviceManager::HardwareResourceNetworkManager)) {
-        return deviceManager()->m_networkManager->post(pluginId(), request, data);
+        QNetworkReply *reply = nullptr;
+        deviceManager()->m_mailbox->call([this, &reply, &request, &data]() {
+            reply = deviceManager()->m_networkManager->post(pluginId(), request, data);
+        });
+        return reply;
     } else {
         qCWarning(dcDeviceManager) << "Network manager hardware resource not set for plugin" << pluginName();
     }
@@ -856,7 +911,11 @@ QNetworkReply *DevicePlugin::networkManagerPost(const QNetworkRequest &request,
 QNetworkReply *DevicePlugin::networkManagerPut(const QNetworkRequest &request, const QByteArray &data)
 {
     if (requiredHardware().testFlag(DeviceManager::HardwareResourceNetworkManager)) {
-        return deviceManager()->m_networkManager->put(pluginId(), request, data);
+        QNetworkReply *reply = nullptr;
+        deviceManager()->m_mailbox->call([this, &reply, &request, &data]() {
+            reply = deviceManager()->m_networkManager->put(pluginId(), request, data);
+        });
+        return reply;
     } else {
         qCWarning(dcDeviceManager) << "Network manager hardware resource not set for plugin" << pluginName();
     }
@@ -878,13 +937,18 @@ void DevicePlugin::setMetaData(const QJsonObject &metaData)
 void DevicePlugin::upnpDiscover(QString searchTarget, QString userAgent)
 {
     if(requiredHardware().testFlag(DeviceManager::HardwareResourceUpnpDisovery)){
-        deviceManager()->m_upnpDiscovery->discoverDevices(searchTarget, userAgent, pluginId());
+        deviceManager()->m_mailbox->call([this, &searchTarget, &userAgent]() {
+            deviceManager()->m_upnpDiscovery->discoverDevices(searchTarget, userAgent, pluginId());
+        });
     } else {
         qCWarning(dcDeviceManager) << "UPnP discovery resource not set for plugin" << pluginName();
     }
 }
 
-/*! Returns the pointer to the central \l{QtAvahiService}{service} browser. */
+/*! Returns the pointer to the central \l{QtAvahiService}{service} browser.
+
+    \note The browser lives on the main thread. Plugins running on a \l{PluginThread} should only connect to its signals.
+*/
 QtAvahiServiceBrowser *DevicePlugin::avahiServiceBrowser() const
 {
     return deviceManager()->m_avahiBrowser;
@@ -894,7 +958,11 @@ QtAvahiServiceBrowser *DevicePlugin::avahiServiceBrowser() const
 bool DevicePlugin::discoverBluetooth()
 {
     if(requiredHardware().testFlag(DeviceManager::HardwareResourceBluetoothLE)){
-        return deviceManager()->m_bluetoothScanner->discover(pluginId());
+        bool started = false;
+        deviceManager()->m_mailbox->call([this, &started]() {
+            started = deviceManager()->m_bluetoothScanner->discover(pluginId());
+        });
+        return started;
     } else {
         qCWarning(dcDeviceManager) << "Bluetooth LE resource not set for plugin" << pluginName();
     }
@@ -33,10 +33,13 @@
 #include "types/vendor.h"
 #include "types/param.h"
 
+#include "hardware/radio433/radio433codeword.h"
+
 #ifdef BLUETOOTH_LE
 #include <QBluetoothDeviceInfo>
 #endif
 
+#include <QMutex>
 #include <QObject>
 #include <QMetaEnum>
 #include <QJsonObject>
@@ -79,10 +82,13 @@ public:
     virtual DeviceManager::DeviceError executeAction(Device *device, const Action &action);
 
     // Hardware input
+    virtual Radio433CodeWord::Protocols radio433Protocols() const { return Radio433CodeWord::ProtocolRaw; }
     virtual void radioData(const QList<int> &rawData) {Q_UNUSED(rawData)}
+    virtual void radioCodeReceived(const Radio433CodeWord &codeWord) {Q_UNUSED(codeWord)}
     virtual void guhTimer() {}
     virtual void upnpDiscoveryFinished(const QList<UpnpDeviceDescriptor> &upnpDeviceDescriptorList) { Q_UNUSED(upnpDeviceDescriptorList) }
-    virtual void upnpNotifyReceived(const QByteArray &notifyData) {Q_UNUSED(notifyData)}
+    virtual QStringList upnpNotifyFilter() const { return QStringList(); }
+    virtual void upnpNotifyReceived(const SsdpMessage &notification) {Q_UNUSED(notification)}
 
     virtual void networkManagerReplyReady(QNetworkReply *reply) {Q_UNUSED(reply)}
 
@@ -152,6 +158,7 @@ private:
 
     QList<ParamType> m_configurationDescription;
     ParamList m_config;
+    mutable QMutex m_configMutex;
 
     QJsonObject m_metaData;
 
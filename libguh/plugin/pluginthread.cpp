@@ -0,0 +1,179 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class PluginThread
+    \brief Runs \l{DevicePlugin}{DevicePlugins} on their own event loop.
+
+    \ingroup devices
+    \inmodule libguh
+
+    By default every \l{DevicePlugin} lives on the main thread together with the rules, the log database and the
+    JSON-RPC handlers. A plugin which declares a \tt workerThread in its \l{The plugin JSON File}{JSON file} gets
+    moved to a PluginThread with that name once it has been initialized. Plugins declaring the same name share
+    the thread:
+
+    \code
+        {
+            "name": "Name of the plugin",
+            "idName": "PluginName",
+            "id": "uuid",
+            "workerThread": "network",
+            ...
+        }
+    \endcode
+
+    The \l{DeviceManager} never waits for a plugin on a worker thread. Every call into such a plugin gets
+    \l{post()}{posted} to the thread and results are reported back with the signals of the \l{DevicePlugin}, which
+    arrive as queued connections on the main thread. Calls of the plugin into the hardware resources of the
+    \l{DeviceManager} get executed on the main thread with \l{PluginMailbox::call()}.
+
+    \sa PluginMailbox
+*/
+
+/*!
+    \class PluginMailbox
+    \brief Executes calls on the thread of the mailbox.
+
+    \ingroup devices
+    \inmodule libguh
+
+    The calls get delivered in the order they have been posted with the event loop of the thread the mailbox
+    lives in.
+
+    \sa PluginThread
+*/
+
+#include "pluginthread.h"
+#include "plugin/deviceplugin.h"
+
+#include <QSemaphore>
+#include <QCoreApplication>
+
+static const QEvent::Type s_callEventType = static_cast<QEvent::Type>(QEvent::registerEventType());
+
+class CallEvent : public QEvent
+{
+public:
+    CallEvent(const std::function<void()> &call) :
+        QEvent(s_callEventType),
+        call(call)
+    {
+    }
+
+    std::function<void()> call;
+};
+
+/*! Constructs a PluginMailbox with the given \a parent. */
+PluginMailbox::PluginMailbox(QObject *parent) :
+    QObject(parent)
+{
+}
+
+/*! Queues the given \a call for the thread of this mailbox and returns immediately. This method can be called from any thread. */
+void PluginMailbox::post(const std::function<void()> &call)
+{
+    QCoreApplication::postEvent(this, new CallEvent(call));
+}
+
+/*! Executes the given \a call on the thread of this mailbox and returns once it has finished. The \a call gets executed
+ *  directly if this method gets called on the thread of this mailbox.
+
+    \note The thread of this mailbox must never wait for the calling thread, otherwise they will block each other.
+*/
+void PluginMailbox::call(const std::function<void()> &call)
+{
+    if (QThread::currentThread() == thread()) {
+        call();
+        return;
+    }
+
+    QSemaphore finished;
+    post([&call, &finished]() {
+        call();
+        finished.release();
+    });
+    finished.acquire();
+}
+
+/*! Executes all pending calls of this mailbox right away. This method must be called on the thread of this mailbox. */
+void PluginMailbox::deliver()
+{
+    QCoreApplication::sendPostedEvents(this, s_callEventType);
+}
+
+/*! Executes the call of the given \a event. */
+bool PluginMailbox::event(QEvent *event)
+{
+    if (event->type() == s_callEventType) {
+        static_cast<CallEvent *>(event)->call();
+        return true;
+    }
+    return QObject::event(event);
+}
+
+/*! Constructs a PluginThread with the given \a name and \a parent. */
+PluginThread::PluginThread(const QString &name, QObject *parent) :
+    QThread(parent),
+    m_mailbox(new PluginMailbox())
+{
+    setObjectName(name);
+    m_mailbox->moveToThread(this);
+}
+
+/*! Returns the \l{DevicePlugin}{DevicePlugins} running on this thread. */
+QList<DevicePlugin *> PluginThread::plugins() const
+{
+    return m_plugins;
+}
+
+/*! Moves the given \a plugin together with all of its children to this thread. This method must be called on the thread
+ *  the \a plugin lives in. */
+void PluginThread::adopt(DevicePlugin *plugin)
+{
+    m_plugins.append(plugin);
+    plugin->moveToThread(this);
+}
+
+/*! Queues the given \a call for this thread. The calls get executed in the order they have been posted. */
+void PluginThread::post(const std::function<void()> &call)
+{
+    m_mailbox->post(call);
+}
+
+/*! Moves the plugins back to the calling thread and stops this thread. The pending calls of the plugins into the
+ *  given \a mailbox of the calling thread get delivered while waiting, so the plugins can finish their work. */
+void PluginThread::shutdown(PluginMailbox *mailbox)
+{
+    QThread *target = QThread::currentThread();
+    QList<DevicePlugin *> plugins = m_plugins;
+    post([this, plugins, target]() {
+        foreach (DevicePlugin *plugin, plugins)
+            plugin->moveToThread(target);
+
+        m_mailbox->deleteLater();
+        quit();
+    });
+
+    while (!wait(10))
+        mailbox->deliver();
+
+    m_plugins.clear();
+}
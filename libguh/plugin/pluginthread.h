@@ -0,0 +1,68 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef PLUGINTHREAD_H
+#define PLUGINTHREAD_H
+
+#include <QList>
+#include <QEvent>
+#include <QThread>
+#include <QObject>
+
+#include <functional>
+
+#include "libguh.h"
+
+class DevicePlugin;
+
+class LIBGUH_EXPORT PluginMailbox : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PluginMailbox(QObject *parent = 0);
+
+    void post(const std::function<void()> &call);
+    void call(const std::function<void()> &call);
+
+    void deliver();
+
+protected:
+    bool event(QEvent *event) override;
+};
+
+class LIBGUH_EXPORT PluginThread : public QThread
+{
+    Q_OBJECT
+public:
+    explicit PluginThread(const QString &name, QObject *parent = 0);
+
+    QList<DevicePlugin *> plugins() const;
+    void adopt(DevicePlugin *plugin);
+
+    void post(const std::function<void()> &call);
+
+    void shutdown(PluginMailbox *mailbox);
+
+private:
+    PluginMailbox *m_mailbox;
+    QList<DevicePlugin *> m_plugins;
+};
+
+#endif // PLUGINTHREAD_H
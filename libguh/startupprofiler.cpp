@@ -0,0 +1,220 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class StartupProfiler
+    \brief Measures the phases of the guh server startup.
+
+    \ingroup devices
+    \inmodule libguh
+
+    The StartupProfiler records monotonic timestamps of the phases passed while the guh server boots, beginning
+    with \l{StartupProfiler::start()}{start()} and ending with \l{StartupProfiler::finish()}{finish()} once the
+    \l{DeviceManager} has loaded all plugins and devices. All times are milliseconds since the start.
+
+    Top level phases run one after the other in the main thread, so together with the time spent in the event
+    loop between them they form the \l{StartupProfiler::criticalPath()}{critical path} of the boot. Phases with a
+    parent, like the load time of each plugin, break a top level phase down.
+
+    Phases begun or added after the startup finished will be ignored.
+*/
+
+/*!
+    \class StartupProfiler::Phase
+    \brief Holds the name, the parent name, the start time and the duration of a startup phase.
+
+    \inmodule libguh
+*/
+
+#include "startupprofiler.h"
+
+#include <algorithm>
+
+QElapsedTimer StartupProfiler::s_timer;
+QList<StartupProfiler::Phase> StartupProfiler::s_phases;
+QHash<QString, StartupProfiler::Phase> StartupProfiler::s_openPhases;
+qint64 StartupProfiler::s_bootTime = 0;
+bool StartupProfiler::s_finished = false;
+bool StartupProfiler::s_reportEnabled = false;
+
+/*! Starts a new profile and discards all phases of a previous one. */
+void StartupProfiler::start()
+{
+    s_phases.clear();
+    s_openPhases.clear();
+    s_bootTime = 0;
+    s_finished = false;
+    s_timer.start();
+}
+
+/*! Finishes the profile. Phases still open will be closed at this point. */
+void StartupProfiler::finish()
+{
+    if (!isRunning())
+        return;
+
+    foreach (const QString &name, s_openPhases.keys())
+        endPhase(name);
+
+    s_bootTime = s_timer.elapsed();
+    s_finished = true;
+}
+
+/*! Returns true if the profile was started and is not finished yet. */
+bool StartupProfiler::isRunning()
+{
+    return s_timer.isValid() && !s_finished;
+}
+
+/*! Returns true if the startup has finished. */
+bool StartupProfiler::isFinished()
+{
+    return s_finished;
+}
+
+/*! Returns the milliseconds since the profile was started. */
+qint64 StartupProfiler::elapsed()
+{
+    if (!s_timer.isValid())
+        return 0;
+
+    return s_timer.elapsed();
+}
+
+/*! Returns the total boot time in milliseconds, or the time elapsed so far while the startup is still running. */
+qint64 StartupProfiler::bootTime()
+{
+    return s_finished ? s_bootTime : elapsed();
+}
+
+/*! Begins the phase with the given \a name. The optional \a parent names the phase this phase belongs to. */
+void StartupProfiler::beginPhase(const QString &name, const QString &parent)
+{
+    if (!isRunning())
+        return;
+
+    Phase phase;
+    phase.name = name;
+    phase.parent = parent;
+    phase.start = s_timer.elapsed();
+    s_openPhases.insert(name, phase);
+}
+
+/*! Ends the phase with the given \a name which was begun with \l{beginPhase()}. */
+void StartupProfiler::endPhase(const QString &name)
+{
+    if (!isRunning() || !s_openPhases.contains(name))
+        return;
+
+    Phase phase = s_openPhases.take(name);
+    phase.duration = s_timer.elapsed() - phase.start;
+    s_phases.append(phase);
+}
+
+/*! Adds an already measured phase with the given \a name, \a parent, \a start and \a duration. */
+void StartupProfiler::addPhase(const QString &name, const QString &parent, const qint64 &start, const qint64 &duration)
+{
+    if (!isRunning())
+        return;
+
+    Phase phase;
+    phase.name = name;
+    phase.parent = parent;
+    phase.start = start;
+    phase.duration = duration;
+    s_phases.append(phase);
+}
+
+/*! Returns all finished phases ordered by their start time. */
+QList<StartupProfiler::Phase> StartupProfiler::phases()
+{
+    QList<Phase> phases = s_phases;
+    std::stable_sort(phases.begin(), phases.end(), [](const Phase &a, const Phase &b) {
+        return a.start < b.start;
+    });
+    return phases;
+}
+
+/*! Returns the top level phases in the order they were passed. The time spent in the event loop between
+    two phases, i.e. by queued calls and other events, is listed as \e {Event loop} phase. */
+QList<StartupProfiler::Phase> StartupProfiler::criticalPath()
+{
+    QList<Phase> criticalPath;
+    qint64 end = 0;
+    foreach (const Phase &phase, phases()) {
+        if (!phase.parent.isEmpty())
+            continue;
+
+        if (phase.start > end) {
+            Phase idle;
+            idle.name = "Event loop";
+            idle.start = end;
+            idle.duration = phase.start - end;
+            criticalPath.append(idle);
+        }
+        criticalPath.append(phase);
+        end = qMax(end, phase.start + phase.duration);
+    }
+
+    if (s_finished && s_bootTime > end) {
+        Phase idle;
+        idle.name = "Event loop";
+        idle.start = end;
+        idle.duration = s_bootTime - end;
+        criticalPath.append(idle);
+    }
+    return criticalPath;
+}
+
+/*! Returns the human readable lines of the critical path, each phase followed by its slowest sub phases. */
+QStringList StartupProfiler::report()
+{
+    QList<Phase> allPhases = phases();
+
+    QStringList lines;
+    lines.append(QString("Startup %1 in %2 ms").arg(s_finished ? "finished" : "running").arg(bootTime()));
+    foreach (const Phase &phase, criticalPath()) {
+        lines.append(QString("%1 ms +%2 ms %3").arg(phase.start, 6).arg(phase.duration, -6).arg(phase.name));
+
+        QList<Phase> children;
+        foreach (const Phase &child, allPhases) {
+            if (child.parent == phase.name)
+                children.append(child);
+        }
+        std::stable_sort(children.begin(), children.end(), [](const Phase &a, const Phase &b) {
+            return a.duration > b.duration;
+        });
+        foreach (const Phase &child, children)
+            lines.append(QString("%1    +%2 ms %3").arg(QString(), 6).arg(child.duration, -6).arg(child.name));
+    }
+    return lines;
+}
+
+/*! Returns true if the startup report should be printed once the startup has finished. */
+bool StartupProfiler::reportEnabled()
+{
+    return s_reportEnabled;
+}
+
+/*! Sets whether the startup report should be printed once the startup has finished to \a enabled. */
+void StartupProfiler::setReportEnabled(const bool &enabled)
+{
+    s_reportEnabled = enabled;
+}
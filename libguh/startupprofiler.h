@@ -0,0 +1,74 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QElapsedTimer>
+
+#include "libguh.h"
+
+class LIBGUH_EXPORT StartupProfiler
+{
+public:
+    class Phase
+    {
+    public:
+        Phase() : start(0), duration(0) {}
+
+        QString name;
+        QString parent;
+        qint64 start;
+        qint64 duration;
+    };
+
+    static void start();
+    static void finish();
+
+    static bool isRunning();
+    static bool isFinished();
+    static qint64 elapsed();
+    static qint64 bootTime();
+
+    static void beginPhase(const QString &name, const QString &parent = QString());
+    static void endPhase(const QString &name);
+    static void addPhase(const QString &name, const QString &parent, const qint64 &start, const qint64 &duration);
+
+    static QList<Phase> phases();
+    static QList<Phase> criticalPath();
+    static QStringList report();
+
+    static bool reportEnabled();
+    static void setReportEnabled(const bool &enabled);
+
+private:
+    static QElapsedTimer s_timer;
+    static QList<Phase> s_phases;
+    static QHash<QString, Phase> s_openPhases;
+    static qint64 s_bootTime;
+    static bool s_finished;
+    static bool s_reportEnabled;
+};
+
+#endif // STARTUPPROFILER_H
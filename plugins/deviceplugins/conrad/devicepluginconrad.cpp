@@ -126,55 +126,14 @@ DeviceManager::DeviceError DevicePluginConrad::executeAction(Device *device, con
     }
 }
 
-void DevicePluginConrad::radioData(const QList<int> &rawData)
+Radio433CodeWord::Protocols DevicePluginConrad::radio433Protocols() const
 {
-    // filter right here a wrong signal length
-    if(rawData.length() != 65){
-        return;
-    }
-
-    qCDebug(dcConrad) << rawData;
-
-    int delay = rawData.first()/10;
-    QByteArray binCode;
+    return Radio433CodeWord::ProtocolPwm64;
+}
 
-    // =======================================
-    // average 650
-    if(delay > 600 && delay < 750){
-        // go trough all 64 timings (without sync signal)
-        for(int i = 1; i <= 64; i+=2 ){
-            int div;
-            int divNext;
-
-            // if short
-            if(rawData.at(i) <= 900){
-                div = 1;
-            }else{
-                div = 2;
-            }
-            // if long
-            if(rawData.at(i+1) < 900){
-                divNext = 1;
-            }else{
-                divNext = 2;
-            }
-
-            //              _
-            // if we have  | |__ = 0 -> in 4 delays => 100
-            //              __
-            // if we have  |  |_ = 1 -> in 4 delays => 110
-
-            if(div == 1 && divNext == 2){
-                binCode.append('0');
-            }else if(div == 2 && divNext == 1){
-                binCode.append('1');
-            }else{
-                return;
-            }
-        }
-    }else{
-        return;
-    }
+void DevicePluginConrad::radioCodeReceived(const Radio433CodeWord &codeWord)
+{
+    QByteArray binCode = codeWord.binCode();
 
     qCDebug(dcConrad) << binCode.left(binCode.length() - 24) << "  ID = " << binCode.right(24);
 }
@@ -36,7 +36,8 @@ public:
 
     DeviceManager::HardwareResources requiredHardware() const override;
     DeviceManager::DeviceSetupStatus setupDevice(Device *device) override;
-    void radioData(const QList<int> &rawData) override;
+    Radio433CodeWord::Protocols radio433Protocols() const override;
+    void radioCodeReceived(const Radio433CodeWord &codeWord) override;
 
 
 public slots:
@@ -4,6 +4,7 @@ SUBDIRS += elro         \
     networkdetector     \
     conrad              \
     mock                \
+    mockthreaded        \
     openweathermap      \
     lircd               \
     wakeonlan           \
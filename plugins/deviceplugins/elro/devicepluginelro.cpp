@@ -153,52 +153,14 @@ DeviceManager::DeviceError DevicePluginElro::executeAction(Device *device, const
     }
 }
 
-void DevicePluginElro::radioData(const QList<int> &rawData)
-{    
-    // filter right here a wrong signal length
-    if (rawData.length() != 49) {
-        return;
-    }
+Radio433CodeWord::Protocols DevicePluginElro::radio433Protocols() const
+{
+    return Radio433CodeWord::ProtocolTristate48;
+}
 
-    int delay = rawData.first()/31;
-    QByteArray binCode;
-    
-    // average 314
-    if (delay > 290 && delay < 400) {
-        // go trough all 48 timings (without sync signal)
-        for (int i = 1; i <= 48; i+=2 ) {
-            int div;
-            int divNext;
-            
-            // if short
-            if (rawData.at(i) <= 700) {
-                div = 1;
-            } else {
-                div = 3;
-            }
-            // if long
-            if (rawData.at(i+1) < 700) {
-                divNext = 1;
-            } else {
-                divNext = 3;
-            }
-
-             //      _
-             //     | |___   = 0 -> in 4 delays => 1000
-             //         _
-             //     ___| |   = 1 -> in 4 delays => 0001
-
-            if (div == 1 && divNext == 3) {
-                binCode.append('0');
-            } else if(div == 3 && divNext == 1) {
-                binCode.append('1');
-            } else {
-                return;
-            }
-        }
-    } else {
-        return;
-    }
+void DevicePluginElro::radioCodeReceived(const Radio433CodeWord &codeWord)
+{
+    QByteArray binCode = codeWord.binCode();
 
     qCDebug(dcElro) << "Understands this protocol: " << binCode;
 
@@ -115,9 +115,9 @@ DeviceManager::DeviceSetupStatus DevicePluginEQ3::setupDevice(Device *device)
         connect(cube,SIGNAL(commandActionFinished(bool,ActionId)),this,SLOT(commandActionFinished(bool,ActionId)));
         connect(cube,SIGNAL(cubeConfigReady()),this,SLOT(updateCubeConfig()));
         connect(cube,SIGNAL(wallThermostatFound()),this,SLOT(wallThermostatFound()));
-        connect(cube,SIGNAL(wallThermostatDataUpdated()),this,SLOT(wallThermostatDataUpdated()));
+        connect(cube,SIGNAL(wallThermostatDataUpdated(WallThermostat*)),this,SLOT(wallThermostatDataUpdated(WallThermostat*)));
         connect(cube,SIGNAL(radiatorThermostatFound()),this,SLOT(radiatorThermostatFound()));
-        connect(cube,SIGNAL(radiatorThermostatDataUpdated()),this,SLOT(radiatorThermostatDataUpdated()));
+        connect(cube,SIGNAL(radiatorThermostatDataUpdated(RadiatorThermostat*)),this,SLOT(radiatorThermostatDataUpdated(RadiatorThermostat*)));
 
         cube->connectToCube();
 
@@ -310,64 +310,58 @@ void DevicePluginEQ3::updateCubeConfig()
     }
 }
 
-void DevicePluginEQ3::wallThermostatDataUpdated()
+void DevicePluginEQ3::wallThermostatDataUpdated(WallThermostat *wallThermostat)
 {
-    MaxCube *cube = static_cast<MaxCube*>(sender());
-
-    foreach (WallThermostat *wallThermostat, cube->wallThermostatList()) {
-        foreach (Device *device, deviceManager()->findConfiguredDevices(wallThermostateDeviceClassId)){
-            if(device->paramValue(serialParamTypeId).toString() == wallThermostat->serialNumber()){
-                device->setStateValue(comfortTempStateTypeId, wallThermostat->comfortTemp());
-                device->setStateValue(ecoTempStateTypeId, wallThermostat->ecoTemp());
-                device->setStateValue(maxSetpointTempStateTypeId, wallThermostat->maxSetPointTemp());
-                device->setStateValue(minSetpointTempStateTypeId, wallThermostat->minSetPointTemp());
-                device->setStateValue(errorOccurredStateTypeId, wallThermostat->errorOccured());
-                device->setStateValue(initializedStateTypeId, wallThermostat->initialized());
-                device->setStateValue(batteryLowStateTypeId, wallThermostat->batteryLow());
-                device->setStateValue(linkStatusOKStateTypeId, wallThermostat->linkStatusOK());
-                device->setStateValue(panelLockedStateTypeId, wallThermostat->panelLocked());
-                device->setStateValue(gatewayKnownStateTypeId, wallThermostat->gatewayKnown());
-                device->setStateValue(dtsActiveStateTypeId, wallThermostat->dtsActive());
-                device->setStateValue(deviceModeStateTypeId, wallThermostat->deviceMode());
-                device->setStateValue(deviceModeStringStateTypeId, wallThermostat->deviceModeString());
-                device->setStateValue(desiredTemperatureStateTypeId, wallThermostat->setpointTemperature());
-                device->setStateValue(currentTemperatureStateTypeId, wallThermostat->currentTemperature());
-            }
+    // only the thermostat with changed live data gets updated
+    foreach (Device *device, deviceManager()->findConfiguredDevices(wallThermostateDeviceClassId)){
+        if(device->paramValue(serialParamTypeId).toString() == wallThermostat->serialNumber()){
+            device->setStateValue(comfortTempStateTypeId, wallThermostat->comfortTemp());
+            device->setStateValue(ecoTempStateTypeId, wallThermostat->ecoTemp());
+            device->setStateValue(maxSetpointTempStateTypeId, wallThermostat->maxSetPointTemp());
+            device->setStateValue(minSetpointTempStateTypeId, wallThermostat->minSetPointTemp());
+            device->setStateValue(errorOccurredStateTypeId, wallThermostat->errorOccured());
+            device->setStateValue(initializedStateTypeId, wallThermostat->initialized());
+            device->setStateValue(batteryLowStateTypeId, wallThermostat->batteryLow());
+            device->setStateValue(linkStatusOKStateTypeId, wallThermostat->linkStatusOK());
+            device->setStateValue(panelLockedStateTypeId, wallThermostat->panelLocked());
+            device->setStateValue(gatewayKnownStateTypeId, wallThermostat->gatewayKnown());
+            device->setStateValue(dtsActiveStateTypeId, wallThermostat->dtsActive());
+            device->setStateValue(deviceModeStateTypeId, wallThermostat->deviceMode());
+            device->setStateValue(deviceModeStringStateTypeId, wallThermostat->deviceModeString());
+            device->setStateValue(desiredTemperatureStateTypeId, wallThermostat->setpointTemperature());
+            device->setStateValue(currentTemperatureStateTypeId, wallThermostat->currentTemperature());
         }
     }
 }
 
-void DevicePluginEQ3::radiatorThermostatDataUpdated()
+void DevicePluginEQ3::radiatorThermostatDataUpdated(RadiatorThermostat *radiatorThermostat)
 {
-    MaxCube *cube = static_cast<MaxCube*>(sender());
-
-    foreach (RadiatorThermostat *radiatorThermostat, cube->radiatorThermostatList()) {
-        foreach (Device *device, deviceManager()->findConfiguredDevices(radiatorThermostateDeviceClassId)){
-            if(device->paramValue(serialParamTypeId).toString() == radiatorThermostat->serialNumber()){
-                device->setStateValue(comfortTempStateTypeId, radiatorThermostat->comfortTemp());
-                device->setStateValue(ecoTempStateTypeId, radiatorThermostat->ecoTemp());
-                device->setStateValue(maxSetpointTempStateTypeId, radiatorThermostat->maxSetPointTemp());
-                device->setStateValue(minSetpointTempStateTypeId, radiatorThermostat->minSetPointTemp());
-                device->setStateValue(errorOccurredStateTypeId, radiatorThermostat->errorOccured());
-                device->setStateValue(initializedStateTypeId, radiatorThermostat->initialized());
-                device->setStateValue(batteryLowStateTypeId, radiatorThermostat->batteryLow());
-                device->setStateValue(linkStatusOKStateTypeId, radiatorThermostat->linkStatusOK());
-                device->setStateValue(panelLockedStateTypeId, radiatorThermostat->panelLocked());
-                device->setStateValue(gatewayKnownStateTypeId, radiatorThermostat->gatewayKnown());
-                device->setStateValue(dtsActiveStateTypeId, radiatorThermostat->dtsActive());
-                device->setStateValue(deviceModeStateTypeId, radiatorThermostat->deviceMode());
-                device->setStateValue(deviceModeStringStateTypeId, radiatorThermostat->deviceModeString());
-                device->setStateValue(desiredTemperatureStateTypeId, radiatorThermostat->setpointTemperature());
-                device->setStateValue(offsetTempStateTypeId, radiatorThermostat->offsetTemp());
-                device->setStateValue(windowOpenDurationStateTypeId, radiatorThermostat->windowOpenDuration());
-                device->setStateValue(boostValveValueStateTypeId, radiatorThermostat->boostValveValue());
-                device->setStateValue(boostDurationStateTypeId, radiatorThermostat->boostDuration());
-                device->setStateValue(discalcWeekDayStateTypeId, radiatorThermostat->discalcingWeekDay());
-                device->setStateValue(discalcTimeStateTypeId, radiatorThermostat->discalcingTime().toString("HH:mm"));
-                device->setStateValue(valveMaximumSettingsStateTypeId, radiatorThermostat->valveMaximumSettings());
-                device->setStateValue(valveOffsetStateTypeId, radiatorThermostat->valveOffset());
-                device->setStateValue(valvePositionStateTypeId, radiatorThermostat->valvePosition());
-            }
+    // only the thermostat with changed live data gets updated
+    foreach (Device *device, deviceManager()->findConfiguredDevices(radiatorThermostateDeviceClassId)){
+        if(device->paramValue(serialParamTypeId).toString() == radiatorThermostat->serialNumber()){
+            device->setStateValue(comfortTempStateTypeId, radiatorThermostat->comfortTemp());
+            device->setStateValue(ecoTempStateTypeId, radiatorThermostat->ecoTemp());
+            device->setStateValue(maxSetpointTempStateTypeId, radiatorThermostat->maxSetPointTemp());
+            device->setStateValue(minSetpointTempStateTypeId, radiatorThermostat->minSetPointTemp());
+            device->setStateValue(errorOccurredStateTypeId, radiatorThermostat->errorOccured());
+            device->setStateValue(initializedStateTypeId, radiatorThermostat->initialized());
+            device->setStateValue(batteryLowStateTypeId, radiatorThermostat->batteryLow());
+            device->setStateValue(linkStatusOKStateTypeId, radiatorThermostat->linkStatusOK());
+            device->setStateValue(panelLockedStateTypeId, radiatorThermostat->panelLocked());
+            device->setStateValue(gatewayKnownStateTypeId, radiatorThermostat->gatewayKnown());
+            device->setStateValue(dtsActiveStateTypeId, radiatorThermostat->dtsActive());
+            device->setStateValue(deviceModeStateTypeId, radiatorThermostat->deviceMode());
+            device->setStateValue(deviceModeStringStateTypeId, radiatorThermostat->deviceModeString());
+            device->setStateValue(desiredTemperatureStateTypeId, radiatorThermostat->setpointTemperature());
+            device->setStateValue(offsetTempStateTypeId, radiatorThermostat->offsetTemp());
+            device->setStateValue(windowOpenDurationStateTypeId, radiatorThermostat->windowOpenDuration());
+            device->setStateValue(boostValveValueStateTypeId, radiatorThermostat->boostValveValue());
+            device->setStateValue(boostDurationStateTypeId, radiatorThermostat->boostDuration());
+            device->setStateValue(discalcWeekDayStateTypeId, radiatorThermostat->discalcingWeekDay());
+            device->setStateValue(discalcTimeStateTypeId, radiatorThermostat->discalcingTime().toString("HH:mm"));
+            device->setStateValue(valveMaximumSettingsStateTypeId, radiatorThermostat->valveMaximumSettings());
+            device->setStateValue(valveOffsetStateTypeId, radiatorThermostat->valveOffset());
+            device->setStateValue(valvePositionStateTypeId, radiatorThermostat->valvePosition());
         }
     }
 }
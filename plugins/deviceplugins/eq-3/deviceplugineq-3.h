@@ -64,8 +64,8 @@ private slots:
     void radiatorThermostatFound();
 
     void updateCubeConfig();
-    void wallThermostatDataUpdated();
-    void radiatorThermostatDataUpdated();
+    void wallThermostatDataUpdated(WallThermostat *wallThermostat);
+    void radiatorThermostatDataUpdated(RadiatorThermostat *radiatorThermostat);
 
 };
 
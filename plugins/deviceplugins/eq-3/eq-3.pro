@@ -10,6 +10,7 @@ SOURCES += \
     deviceplugineq-3.cpp    \
     maxcubediscovery.cpp    \
     maxcube.cpp             \
+    maxcubedecoder.cpp      \
     maxdevice.cpp           \
     room.cpp \
     wallthermostat.cpp \
@@ -19,6 +20,7 @@ HEADERS += \
     deviceplugineq-3.h      \
     maxcubediscovery.h      \
     maxcube.h               \
+    maxcubedecoder.h        \
     maxdevice.h             \
     room.h \
     wallthermostat.h \
@@ -25,11 +25,9 @@
 #include <QTcpSocket>
 #include <QDateTime>
 #include <QHostAddress>
+#include <QHash>
 
-#include "maxdevice.h"
-#include "room.h"
-#include "wallthermostat.h"
-#include "radiatorthermostat.h"
+#include "maxcubedecoder.h"
 #include "plugin/deviceplugin.h"
 
 class MaxCube : public QTcpSocket
@@ -38,16 +36,6 @@ class MaxCube : public QTcpSocket
 public:
     MaxCube(QObject *parent = 0, QString serialNumber = QString(), QHostAddress hostAdress = QHostAddress(), quint16 port = 0);
 
-    enum WeekDay{
-        Saturday = 0,
-        Sunday = 1,
-        Monday = 2,
-        Tuesday = 3,
-        Wednesday = 4,
-        Thursday = 5,
-        Friday = 6
-    };
-
     // cube data access functions
     QString serialNumber() const;
     void setSerialNumber(const QString &serialNumber);
@@ -89,34 +77,12 @@ private:
     QHostAddress m_hostAddress;
     quint16 m_port;
     QDateTime m_cubeDateTime;
-    bool m_portalEnabeld;
-
-    QList<Room*> m_roomList;
-    QList<WallThermostat*> m_wallThermostatList;
-    QList<RadiatorThermostat*> m_radiatorThermostatList;
-
-    bool m_cubeInitialized;
-
-    void decodeHelloMessage(QByteArray data);
-    void decodeMetadataMessage(QByteArray data);
-    void decodeConfigMessage(QByteArray data);
-    void decodeDevicelistMessage(QByteArray data);
-    void decodeCommandMessage(QByteArray data);
-    void parseWeeklyProgram(QByteArray data);
-    void decodeNewDeviceFoundMessage(QByteArray data);
-
-    QDateTime calculateDateTime(QByteArray dateRaw, QByteArray timeRaw);
-    QString deviceTypeString(int deviceType);
-    QString weekDayString(int weekDay);
 
-    QByteArray fillBin(QByteArray data, int dataLength);
-    QList<QByteArray> splitMessage(QByteArray data);
-    int deviceTypeFromRFAddress(QByteArray rfAddress);
+    MaxCubeDecoder *m_decoder;
 
     ActionId m_actionId;
 
 signals:
-    void cubeDataAvailable(const QByteArray &data);
     void cubeACK();
     void cubeConnectionStatusChanged(const bool &connected);
 
@@ -125,8 +91,8 @@ signals:
     void wallThermostatFound();
     void radiatorThermostatFound();
 
-    void wallThermostatDataUpdated();
-    void radiatorThermostatDataUpdated();
+    void wallThermostatDataUpdated(WallThermostat *wallThermostat);
+    void radiatorThermostatDataUpdated(RadiatorThermostat *radiatorThermostat);
 
     void commandActionFinished(const bool &succeeded, const ActionId &actionId);
 
@@ -134,7 +100,8 @@ private slots:
     void connectionStateChanged(const QAbstractSocket::SocketState &socketState);
     void error(QAbstractSocket::SocketError error);
     void readData();
-    void processCubeData(const QByteArray &data);
+    void onHelloReceived();
+    void onCommandFinished(const bool &succeeded);
 
 
 public slots:
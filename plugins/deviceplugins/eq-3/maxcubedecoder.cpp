@@ -0,0 +1,696 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "maxcubedecoder.h"
+#include "extern-plugininfo.h"
+
+MaxCubeDecoder::MaxCubeDecoder(QObject *parent) :
+    QObject(parent),
+    m_scanPosition(0),
+    m_metadataIndex(0),
+    m_firmware(0),
+    m_portalEnabled(false),
+    m_initialized(false)
+{
+}
+
+void MaxCubeDecoder::reset()
+{
+    // the cube starts over with the hello message after each connect
+    m_receiveBuffer.clear();
+    m_scanPosition = 0;
+    m_metadata.clear();
+    m_metadataIndex = 0;
+    m_initialized = false;
+}
+
+bool MaxCubeDecoder::isInitialized() const
+{
+    return m_initialized;
+}
+
+QByteArray MaxCubeDecoder::rfAddress() const
+{
+    return m_rfAddress;
+}
+
+int MaxCubeDecoder::firmware() const
+{
+    return m_firmware;
+}
+
+QDateTime MaxCubeDecoder::cubeDateTime() const
+{
+    return m_cubeDateTime;
+}
+
+bool MaxCubeDecoder::portalEnabled() const
+{
+    return m_portalEnabled;
+}
+
+QList<Room *> MaxCubeDecoder::roomList() const
+{
+    return m_roomList;
+}
+
+QList<WallThermostat *> MaxCubeDecoder::wallThermostatList() const
+{
+    return m_wallThermostatList;
+}
+
+QList<RadiatorThermostat *> MaxCubeDecoder::radiatorThermostatList() const
+{
+    return m_radiatorThermostatList;
+}
+
+void MaxCubeDecoder::decodeHelloMessage(const QByteArray &data)
+{
+    QList<QByteArray> list = data.split(',');
+    if(list.count() < 11){
+        qCWarning(dcEQ3) << "invalid HELLO message" << data;
+        return;
+    }
+    m_cubeDateTime = calculateDateTime(list.at(7),list.at(8));
+
+    m_rfAddress = list.at(1);
+    m_firmware = list.at(2).toInt();
+
+    qCDebug(dcEQ3) << "====================================================";
+    qCDebug(dcEQ3) << "               HELLO message:";
+    qCDebug(dcEQ3) << "====================================================";
+    qCDebug(dcEQ3) << "           serial number | " << list.at(0);
+    qCDebug(dcEQ3) << "        RF address (hex) | " << m_rfAddress;
+    qCDebug(dcEQ3) << "                firmware | " << m_firmware;
+    qCDebug(dcEQ3) << "               Cube date | " << m_cubeDateTime.date().toString("dd.MM.yyyy");
+    qCDebug(dcEQ3) << "               Cube time | " << m_cubeDateTime.time().toString("HH:mm");
+    qCDebug(dcEQ3) << "         State Cube Time | " << list.at(9);
+    qCDebug(dcEQ3) << "             NTP counter | " << list.at(10);
+    emit helloReceived();
+}
+
+void MaxCubeDecoder::decodeMetadataMessage(const QByteArray &data)
+{
+    QList<QByteArray> list = data.split(',');
+    if(list.count() < 3){
+        qCWarning(dcEQ3) << "invalid METADATA message" << data;
+        return;
+    }
+
+    // M:index,count,data -> the base64 data of all parts has to be joined before it can be decoded
+    int index = list.at(0).toInt(0,16);
+    int count = list.at(1).toInt(0,16);
+    if(index == 0){
+        m_metadata.clear();
+        m_metadataIndex = 0;
+    }
+    if(index != m_metadataIndex || index >= count){
+        qCWarning(dcEQ3) << "unexpected METADATA part" << index << "of" << count;
+        m_metadata.clear();
+        m_metadataIndex = 0;
+        return;
+    }
+    m_metadata.append(list.at(2));
+    m_metadataIndex++;
+
+    if(index < count - 1){
+        return;
+    }
+
+    decodeBase64(m_metadata, m_decodeBuffer);
+    m_metadata.clear();
+    m_metadataIndex = 0;
+    decodeMetadata(m_decodeBuffer);
+}
+
+void MaxCubeDecoder::decodeMetadata(const QByteArray &dataDecoded)
+{
+    // the cube sends the metadata again after each reconnect
+    qDeleteAll(m_roomList);
+    qDeleteAll(m_wallThermostatList);
+    qDeleteAll(m_radiatorThermostatList);
+    m_roomList.clear();
+    m_wallThermostatList.clear();
+    m_radiatorThermostatList.clear();
+    m_devices.clear();
+    qCDebug(dcEQ3) << "====================================================";
+    qCDebug(dcEQ3) << "               METADATA message:";
+    qCDebug(dcEQ3) << "====================================================";
+
+    // parse room list
+    int roomCount = dataDecoded.toHex().mid(4,2).toInt(0,16);
+
+    QByteArray roomRawData = dataDecoded.toHex();
+    roomRawData = roomRawData.right(roomRawData.length()-6);
+
+    for(int i = 0; i < roomCount; i++){
+        Room *room = new Room(this);
+        room->setRoomId(roomRawData.left(2).toInt(0,16));
+        int roomNameLength = roomRawData.mid(2,2).toInt(0,16);
+        room->setRoomName(QByteArray::fromHex(roomRawData.mid(4,roomNameLength*2)));
+        room->setGroupRfAddress(roomRawData.mid(roomNameLength*2 + 4, 6));
+        m_roomList.append(room);
+        roomRawData = roomRawData.right(roomRawData.length() - ((roomNameLength*2) + 10));
+    }
+    qCDebug(dcEQ3) << "-------------------------|-------------------------";
+    qCDebug(dcEQ3) << "found " << m_roomList.count() << "rooms";
+    qCDebug(dcEQ3) << "-------------------------|-------------------------";
+
+    foreach (Room *room, m_roomList) {
+        qCDebug(dcEQ3) << "               Room Name | " << room->roomName();
+        qCDebug(dcEQ3) << "                 Room ID | " << room->roomId();
+        qCDebug(dcEQ3) << "        Group RF Address | " << room->groupRfAddress();
+        qCDebug(dcEQ3) << "-------------------------|-------------------------";
+    }
+
+    // parse device list
+    int deviceCount = roomRawData.left(2).toInt(0,16);
+    QByteArray deviceRawData = roomRawData.right(roomRawData.length() - 2);
+
+    qCDebug(dcEQ3) << "-------------------------|-------------------------";
+    qCDebug(dcEQ3) << "found " << deviceCount << "devices";
+    qCDebug(dcEQ3) << "-------------------------|-------------------------";
+
+    for(int i = 0; i < deviceCount; i++){
+        // every device entry has the same layout, also the ones which are not handled here
+        int deviceType = deviceRawData.left(2).toInt(0,16);
+        QByteArray rfAddress = deviceRawData.mid(2,6);
+        QByteArray serialNumber = QByteArray::fromHex(deviceRawData.mid(8,20));
+        int deviceNameLenght = deviceRawData.mid(28,2).toInt(0,16);
+        QByteArray deviceName = QByteArray::fromHex(deviceRawData.mid(30,deviceNameLenght*2));
+        int roomId = deviceRawData.mid(30 + deviceNameLenght*2,2).toInt(0,16);
+        deviceRawData = deviceRawData.right(deviceRawData.length() - (32 + deviceNameLenght*2));
+
+        MaxDevice *device = 0;
+        switch (deviceType) {
+        case MaxDevice::DeviceRadiatorThermostat:{
+            RadiatorThermostat *radiatorThermostat = new RadiatorThermostat(this);
+            m_radiatorThermostatList.append(radiatorThermostat);
+            device = radiatorThermostat;
+            break;
+        }
+        case MaxDevice::DeviceWallThermostat:{
+            WallThermostat *wallThermostat = new WallThermostat(this);
+            m_wallThermostatList.append(wallThermostat);
+            device = wallThermostat;
+            break;
+        }
+        default:
+            qCDebug(dcEQ3) << "skipping" << deviceTypeString(deviceType) << deviceName << rfAddress;
+            continue;
+        }
+
+        device->setDeviceType(deviceType);
+        device->setRfAddress(rfAddress);
+        device->setSerialNumber(serialNumber);
+        device->setDeviceName(deviceName);
+        device->setRoomId(roomId);
+
+        // set room data for each device
+        foreach (Room * room, m_roomList) {
+            if(device->roomId() == room->roomId()){
+                device->setRoomName(room->roomName());
+            }
+        }
+        m_devices.insert(device->rfAddress(), device);
+
+        qCDebug(dcEQ3) << "             Device Name | " << device->deviceName();
+        qCDebug(dcEQ3) << "            Serial Number| " << device->serialNumber();
+        qCDebug(dcEQ3) << "      Device Type String | " << device->deviceTypeString();
+        qCDebug(dcEQ3) << "        RF address (hex) | " << device->rfAddress();
+        qCDebug(dcEQ3) << "                 Room ID | " << device->roomId();
+        qCDebug(dcEQ3) << "               Room Name | " << device->roomName();
+        qCDebug(dcEQ3) << "-------------------------|-------------------------";
+    }
+
+    m_initialized = true;
+}
+
+void MaxCubeDecoder::decodeConfigMessage(const QByteArray &data)
+{
+    QList<QByteArray> list = data.split(',');
+    if(list.count() < 2){
+        return;
+    }
+    QByteArray rfAddress = list.at(0);
+    decodeBase64(list.at(1), m_decodeBuffer);
+    QByteArray dataRaw = m_decodeBuffer.toHex();
+    int lengthData = dataRaw.left(2).toInt(0,16);
+    if(rfAddress != dataRaw.mid(2,6)){
+        qCWarning(dcEQ3) << "RF addresses not equal!";
+    }
+    int deviceType = dataRaw.mid(8,2).toInt(0,16);
+    //QByteArray unknown = dataRaw.mid(12,6);
+
+    QByteArray serialNumber = QByteArray::fromHex(dataRaw.mid(16,20));
+    qCDebug(dcEQ3) << "====================================================";
+    qCDebug(dcEQ3) << "               CONFIG message:";
+    qCDebug(dcEQ3) << "====================================================";
+    qCDebug(dcEQ3) << "           Serial Number | " << serialNumber;
+    qCDebug(dcEQ3) << "             device Type | " << deviceTypeString(deviceType);
+    qCDebug(dcEQ3) << "        RF address (hex) | " << rfAddress;
+    qCDebug(dcEQ3) << "             data length | " << lengthData;
+    qCDebug(dcEQ3) << "-------------------------|-------------------------";
+
+    switch (deviceType) {
+    case MaxDevice::DeviceCube:{
+
+        m_portalEnabled = (bool)dataRaw.mid(36,2).toInt(0,16);
+
+        qCDebug(dcEQ3) << "          portal enabled | " << m_portalEnabled;
+        qCDebug(dcEQ3) << "              portal URL | " << QString(QByteArray::fromHex(dataRaw.mid(170,68)));
+        qCDebug(dcEQ3) << "               time zone | " << QString(QByteArray::fromHex(dataRaw.mid(428,6)));
+        qCDebug(dcEQ3) << "      summer/winter time | " << QString(QByteArray::fromHex(dataRaw.mid(452,8)));
+        emit cubeConfigReady();
+        break;
+    }
+    case MaxDevice::DeviceRadiatorThermostat:{
+        foreach (RadiatorThermostat* device, m_radiatorThermostatList) {
+            if(device->rfAddress() == rfAddress){
+
+                //int roomId = dataRaw.mid(10,2).toInt(0,16);
+                int firmware = dataRaw.mid(12,2).toInt(0,16);
+                device->setComfortTemp((double)dataRaw.mid(36,2).toInt(0,16) / 2.0);
+                device->setEcoTemp((double)dataRaw.mid(38,2).toInt(0,16) / 2.0);
+                device->setMaxSetPointTemp((double)dataRaw.mid(40,2).toInt(0,16) / 2.0);
+                device->setMinSetPointTemp((double)dataRaw.mid(42,2).toInt(0,16) / 2.0);
+                device->setOffsetTemp((double)(dataRaw.mid(44,2).toInt(0,16) / 2.0 ) - 3.5);
+                device->setWindowOpenTemp((double)dataRaw.mid(46,2).toInt(0,16)/2.0);
+                device->setWindowOpenDuration(dataRaw.mid(48,2).toInt(0,16));
+                // boost code
+                QByteArray boostDurationCode = fillBin(QByteArray::number(dataRaw.mid(50,2).toInt(0,16),2),8);
+                device->setBoostDuration(boostDurationCode.left(3).toInt(0,2) * 5);
+                device->setBoostValveValue(boostDurationCode.right(5).toInt(0,2) * 5);
+
+                // day of week an time
+                QByteArray dowTime = fillBin(QByteArray::number(dataRaw.mid(52,2).toInt(0,16),2),8);
+                device->setDiscalcingWeekDay(weekDayString(dowTime.left(3).toInt(0,2)));
+                device->setDiscalcingTime(QTime(dowTime.right(5).toInt(0,2),0));
+
+                device->setValveMaximumSettings((double)dataRaw.mid(54,2).toInt(0,16)*(double)100.0/255.0);
+                device->setValveOffset((double)dataRaw.mid(56,2).toInt(0,16)*100.0/255.0);
+
+                qCDebug(dcEQ3) << "                 Room ID | " << device->roomId();
+                qCDebug(dcEQ3) << "                firmware | " << firmware;
+                //qCDebug(dcEQ3) << "           Confort Temp. | " << device->confortTemp() << "C";
+                qCDebug(dcEQ3) << "               Eco Temp. | " << device->ecoTemp() << "C";
+                qCDebug(dcEQ3) << "    Max. Set Point Temp. | " << device->maxSetPointTemp() << "C";
+                qCDebug(dcEQ3) << "    Min. Set Point Temp. | " << device->minSetPointTemp() << "C";
+                qCDebug(dcEQ3) << "            Temp. Offset | " << device->offsetTemp() << "C";
+                qCDebug(dcEQ3) << "       Window Open Temp. | " << device->windowOpenTemp() << "C";
+                qCDebug(dcEQ3) << "   Window Open Duration  | " << device->windowOpenDuration() << "min";
+                qCDebug(dcEQ3) << "         Boost Duration  | " << device->boostDuration() << "min";
+                qCDebug(dcEQ3) << "             Valve value | " << device->boostValveValue() << "%";
+                qCDebug(dcEQ3) << "     disclaiming run day | " << device->discalcingWeekDay();
+                qCDebug(dcEQ3) << "    disclaiming run time | " << device->discalcingTime().toString("HH:mm");
+                qCDebug(dcEQ3) << "  Valve Maximum Settings | " << device->valveMaximumSettings() << "%";
+                qCDebug(dcEQ3) << "            Valve Offset | " << device->valveOffset() << "%";
+                parseWeeklyProgram(dataRaw.right(dataRaw.length() - 58));
+                emit radiatorThermostatFound();
+            }
+        }
+        break;
+    }
+    case MaxDevice::DeviceRadiatorThermostatPlus:
+        break;
+    case MaxDevice::DeviceWallThermostat:{
+        foreach (WallThermostat* device, m_wallThermostatList) {
+            if(device->rfAddress() == rfAddress){
+                //int roomId = dataRaw.mid(10,2).toInt(0,16);
+                int firmware = dataRaw.mid(12,2).toInt(0,16);
+                device->setComfortTemp((double)dataRaw.mid(36,2).toInt(0,16) / 2.0);
+                device->setEcoTemp((double)dataRaw.mid(38,2).toInt(0,16)/2.0);
+                device->setMaxSetPointTemp((double)dataRaw.mid(40,2).toInt(0,16)/2.0);
+                device->setMinSetPointTemp((double)dataRaw.mid(42,2).toInt(0,16)/2.0);
+
+                qCDebug(dcEQ3) << "                 Room ID | " << device->roomId();
+                qCDebug(dcEQ3) << "                firmware | " << firmware;
+                //qCDebug(dcEQ3) << "           Confort Temp. | " << device->confortTemp();
+                qCDebug(dcEQ3) << "               Eco Temp. | " << device->ecoTemp();
+                qCDebug(dcEQ3) << "    Max. Set Point Temp. | " << device->maxSetPointTemp();
+                qCDebug(dcEQ3) << "    Min. Set Point Temp. | " << device->minSetPointTemp();
+
+                parseWeeklyProgram(dataRaw.right(dataRaw.length() - 44));
+                emit wallThermostatFound();
+            }
+        }
+        break;
+    }
+    case MaxDevice::DeviceEcoButton:
+        break;
+    case MaxDevice::DeviceWindowContact:
+        break;
+    default:
+        qCWarning(dcEQ3) << "unknown device type: " << deviceType;
+        break;
+    }
+}
+
+void MaxCubeDecoder::decodeDevicelistMessage(const QByteArray &data)
+{
+    decodeBase64(data, m_decodeBuffer);
+
+    // the live data is a sequence of records: length byte, RF address (3 bytes), unknown,
+    // init flags, status flags [, valve position, setpoint temperature [, date, time, current temperature]].
+    // Window contacts and eco buttons only send the first 6 bytes.
+    const uchar *buffer = reinterpret_cast<const uchar *>(m_decodeBuffer.constData());
+    int position = 0;
+    while(position < m_decodeBuffer.length()){
+        int length = buffer[position];
+        if(length < 6 || position + 1 + length > m_decodeBuffer.length()){
+            qCWarning(dcEQ3) << "invalid LIVE record in message" << data;
+            return;
+        }
+
+        const uchar *record = buffer + position + 1;
+        position += length + 1;
+
+        QByteArray rfAddress = QByteArray(reinterpret_cast<const char *>(record), 3).toHex();
+        MaxDevice *maxDevice = m_devices.value(rfAddress);
+        if(!maxDevice){
+            continue;
+        }
+
+        // only records which changed since the last refresh get decoded
+        if(!maxDevice->updateLiveData(reinterpret_cast<const char *>(record), length)){
+            continue;
+        }
+
+        uchar initCode = record[4];
+        uchar statusCode = record[5];
+
+        switch (maxDevice->deviceType()) {
+        case MaxDevice::DeviceWallThermostat:{
+            if(length < 8){
+                qCWarning(dcEQ3) << "LIVE record too short for" << maxDevice->deviceTypeString() << maxDevice->rfAddress();
+                continue;
+            }
+            WallThermostat *device = static_cast<WallThermostat *>(maxDevice);
+            device->setInformationValid(initCode & 0x10);
+            device->setErrorOccured(initCode & 0x08);
+            device->setIsAnswereToCommand(initCode & 0x04);
+            device->setInitialized(initCode & 0x02);
+
+            device->setBatteryLow(statusCode & 0x80);
+            device->setLinkStatusOK(!(statusCode & 0x40));
+            device->setPanelLocked(statusCode & 0x20);
+            device->setGatewayKnown(statusCode & 0x10);
+            device->setDtsActive(statusCode & 0x08);
+            device->setDeviceMode(statusCode & 0x03);
+
+            // calculate current temperature and setpoint temperature
+            uchar tempCode = record[7];
+            device->setSetpointTemperatre((double)(tempCode & 0x3f) / 2.0);
+            if((tempCode & 0xc0) == 0x80){
+                device->setCurrentTemperatre(((double)record[length - 1] / 10.0) + 25.6);
+            }else{
+                device->setCurrentTemperatre((double)record[length - 1] / 10.0);
+            }
+
+            qCDebug(dcEQ3) << "LIVE" << device->deviceTypeString() << device->deviceName() << device->rfAddress()
+                           << "mode:" << device->deviceModeString()
+                           << "setpoint:" << device->setpointTemperature()
+                           << "current:" << device->currentTemperature();
+
+            emit wallThermostatDataUpdated(device);
+            break;
+        }
+        case MaxDevice::DeviceRadiatorThermostat:{
+            if(length < 8){
+                qCWarning(dcEQ3) << "LIVE record too short for" << maxDevice->deviceTypeString() << maxDevice->rfAddress();
+                continue;
+            }
+            RadiatorThermostat *device = static_cast<RadiatorThermostat *>(maxDevice);
+            device->setInformationValid(initCode & 0x10);
+            device->setErrorOccured(initCode & 0x08);
+            device->setIsAnswereToCommand(initCode & 0x04);
+            device->setInitialized(initCode & 0x02);
+
+            device->setBatteryLow(statusCode & 0x80);
+            device->setLinkStatusOK(!(statusCode & 0x40));
+            device->setPanelLocked(statusCode & 0x20);
+            device->setGatewayKnown(statusCode & 0x10);
+            device->setDtsActive(statusCode & 0x08);
+            device->setDeviceMode(statusCode & 0x03);
+
+            device->setValvePosition(record[6]);
+            device->setSetpointTemperatre((double)record[7] / 2.0);
+
+            qCDebug(dcEQ3) << "LIVE" << device->deviceTypeString() << device->deviceName() << device->rfAddress()
+                           << "mode:" << device->deviceModeString()
+                           << "valve:" << device->valvePosition() << "%"
+                           << "setpoint:" << device->setpointTemperature();
+
+            emit radiatorThermostatDataUpdated(device);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+void MaxCubeDecoder::decodeCommandMessage(const QByteArray &data)
+{
+    QList<QByteArray> list = data.split(',');
+
+    if(list.count() < 3){
+        return;
+    }
+    bool succeeded = !(bool)list.at(2).toInt(0,10);
+    emit commandFinished(succeeded);
+}
+
+void MaxCubeDecoder::parseWeeklyProgram(QByteArray data)
+{
+    for(int i=0; i < 7; i++){
+        QByteArray dayData = data.left(52);
+        //qCDebug(dcEQ3) << weekDayString(i);
+        for(int i = 0; i < 52; i+=4){
+            QByteArray element = fillBin(QByteArray::number(dayData.mid(i,4).toInt(0,16),2),16);
+            //int minutes = element.right(9).toInt(0,2) * 5;
+            //int hours = (minutes / 60) % 24;
+            //minutes = minutes % 60;
+            //QTime time = QTime(hours,minutes);
+            //qCDebug(dcEQ3) << (double)element.left(7).toInt(0,2) / 2 << "\t" << "deg. until" << "\t" << time.toString("HH:mm");
+        }
+        data = data.right(data.length() - 52);
+    }
+    if(!data.isEmpty()){
+        //qCDebug(dcEQ3) << "                       ? | " << data;
+    }
+}
+
+void MaxCubeDecoder::decodeNewDeviceFoundMessage(const QByteArray &data)
+{
+    if(data.isEmpty()){
+        return;
+    }
+
+    qCDebug(dcEQ3) << "====================================================";
+    qCDebug(dcEQ3) << "               NEW DEVICE message:";
+    qCDebug(dcEQ3) << "====================================================";
+    qCDebug(dcEQ3) << "           Serial Number | " << QByteArray::fromBase64(data);
+
+}
+
+QDateTime MaxCubeDecoder::calculateDateTime(QByteArray dateRaw, QByteArray timeRaw)
+{
+    QDate date;
+    QTime time;
+    date.setDate(dateRaw.left(2).toInt(0,16) + 2000, dateRaw.mid(2,2).toInt(0,16), dateRaw.right(2).toInt(0,16));
+    time.setHMS(timeRaw.left(2).toInt(0,16), timeRaw.right(2).toInt(0,16), 0);
+
+    return QDateTime(date,time);
+}
+
+QString MaxCubeDecoder::deviceTypeString(int deviceType)
+{
+    QString deviceTypeString;
+
+    switch (deviceType) {
+    case MaxDevice::DeviceCube:
+        deviceTypeString = "Cube";
+        break;
+    case MaxDevice::DeviceRadiatorThermostat:
+        deviceTypeString = "Radiator Thermostat";
+        break;
+    case MaxDevice::DeviceRadiatorThermostatPlus:
+        deviceTypeString = "Radiator Thermostat Plus";
+        break;
+    case MaxDevice::DeviceEcoButton:
+        deviceTypeString = "Eco Button";
+        break;
+    case MaxDevice::DeviceWindowContact:
+        deviceTypeString = "Window Contact";
+        break;
+    case MaxDevice::DeviceWallThermostat:
+        deviceTypeString = "Wall Thermostat";
+        break;
+    default:
+        deviceTypeString = "-";
+        break;
+    }
+
+    return deviceTypeString;
+}
+
+QString MaxCubeDecoder::weekDayString(int weekDay)
+{
+    QString weekDayString;
+
+    switch (weekDay) {
+    case Monday:
+        weekDayString = "Monday";
+        break;
+    case Tuesday:
+        weekDayString = "Tuesday";
+        break;
+    case Wednesday:
+        weekDayString = "Wednesday";
+        break;
+    case Thursday:
+        weekDayString = "Thursday";
+        break;
+    case Friday:
+        weekDayString = "Friday";
+        break;
+    case Saturday:
+        weekDayString = "Saturday";
+        break;
+    case Sunday:
+        weekDayString = "Sunday";
+        break;
+    default:
+        weekDayString = "-";
+        break;
+    }
+
+    return weekDayString;
+}
+
+QByteArray MaxCubeDecoder::fillBin(QByteArray data, int dataLength)
+{
+    QByteArray zeros;
+    for(int i = 0; i < dataLength - data.length(); i++){
+        zeros.append("0");
+    }
+    data = zeros.append(data);
+    return data;
+}
+
+void MaxCubeDecoder::decodeBase64(const QByteArray &data, QByteArray &output)
+{
+    // decodes into the given buffer, which keeps its capacity between the messages
+    output.resize(data.length() * 3 / 4);
+    char *out = output.data();
+    int outputLength = 0;
+    uint bits = 0;
+    int bitCount = 0;
+
+    const char *in = data.constData();
+    for(int i = 0; i < data.length(); i++){
+        char c = in[i];
+        int value;
+        if(c >= 'A' && c <= 'Z'){
+            value = c - 'A';
+        }else if(c >= 'a' && c <= 'z'){
+            value = c - 'a' + 26;
+        }else if(c >= '0' && c <= '9'){
+            value = c - '0' + 52;
+        }else if(c == '+'){
+            value = 62;
+        }else if(c == '/'){
+            value = 63;
+        }else{
+            continue;
+        }
+
+        bits = (bits << 6) | value;
+        bitCount += 6;
+        if(bitCount >= 8){
+            bitCount -= 8;
+            out[outputLength++] = (char)((bits >> bitCount) & 0xff);
+        }
+    }
+    output.resize(outputLength);
+}
+
+void MaxCubeDecoder::processData(const QByteArray &data)
+{
+    m_receiveBuffer.append(data);
+
+    // every message ends with \r\n, but a message can be split over several TCP segments
+    int lineStart = 0;
+    int lineEnd = m_receiveBuffer.indexOf('\n', m_scanPosition);
+    while(lineEnd >= 0){
+        int length = lineEnd - lineStart;
+        if(length > 0 && m_receiveBuffer.at(lineEnd - 1) == '\r'){
+            length--;
+        }
+        if(length > 0){
+            processMessage(m_receiveBuffer.constData() + lineStart, length);
+        }
+        lineStart = lineEnd + 1;
+        lineEnd = m_receiveBuffer.indexOf('\n', lineStart);
+    }
+
+    m_receiveBuffer.remove(0, lineStart);
+    m_scanPosition = m_receiveBuffer.length();
+}
+
+void MaxCubeDecoder::processMessage(const char *data, int length)
+{
+    if(length < 2 || data[1] != ':'){
+        qCWarning(dcEQ3) << "  -> unknown message!!!!!!! from cube:" << QByteArray(data, length);
+        return;
+    }
+
+    // the payload references the receive buffer, the decoders have to copy what they keep
+    QByteArray payload = QByteArray::fromRawData(data + 2, length - 2);
+
+    switch (data[0]) {
+    case 'H':
+        decodeHelloMessage(payload);
+        break;
+    case 'M':
+        decodeMetadataMessage(payload);
+        break;
+    case 'C':
+        decodeConfigMessage(payload);
+        break;
+    case 'L':
+        decodeDevicelistMessage(payload);
+        break;
+    case 'N':
+        decodeNewDeviceFoundMessage(payload);
+        break;
+    case 'S':
+        decodeCommandMessage(payload);
+        break;
+    case 'A':
+        qCDebug(dcEQ3) << "cube ACK!";
+        emit cubeACK();
+        break;
+    default:
+        qCWarning(dcEQ3) << "  -> unknown message!!!!!!! from cube:" << QByteArray(data, length);
+        break;
+    }
+}
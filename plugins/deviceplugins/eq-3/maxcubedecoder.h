@@ -0,0 +1,116 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef MAXCUBEDECODER_H
+#define MAXCUBEDECODER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+
+#include "maxdevice.h"
+#include "room.h"
+#include "wallthermostat.h"
+#include "radiatorthermostat.h"
+
+// Frames the data received from a cube into messages and decodes them
+class MaxCubeDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MaxCubeDecoder(QObject *parent = 0);
+
+    enum WeekDay{
+        Saturday = 0,
+        Sunday = 1,
+        Monday = 2,
+        Tuesday = 3,
+        Wednesday = 4,
+        Thursday = 5,
+        Friday = 6
+    };
+
+    void processData(const QByteArray &data);
+    void reset();
+
+    bool isInitialized() const;
+
+    QByteArray rfAddress() const;
+    int firmware() const;
+    QDateTime cubeDateTime() const;
+    bool portalEnabled() const;
+
+    QList<Room*> roomList() const;
+    QList<WallThermostat*> wallThermostatList() const;
+    QList<RadiatorThermostat*> radiatorThermostatList() const;
+
+    static QByteArray fillBin(QByteArray data, int dataLength);
+    static void decodeBase64(const QByteArray &data, QByteArray &output);
+
+private:
+    // receive buffer of the connection and reused buffer for the decoded base64 payloads
+    QByteArray m_receiveBuffer;
+    int m_scanPosition;
+    QByteArray m_decodeBuffer;
+
+    // large metadata is split over several M: messages
+    QByteArray m_metadata;
+    int m_metadataIndex;
+
+    QByteArray m_rfAddress;
+    int m_firmware;
+    QDateTime m_cubeDateTime;
+    bool m_portalEnabled;
+    bool m_initialized;
+
+    QList<Room*> m_roomList;
+    QList<WallThermostat*> m_wallThermostatList;
+    QList<RadiatorThermostat*> m_radiatorThermostatList;
+    QHash<QByteArray, MaxDevice*> m_devices;
+
+    void processMessage(const char *data, int length);
+
+    void decodeHelloMessage(const QByteArray &data);
+    void decodeMetadataMessage(const QByteArray &data);
+    void decodeMetadata(const QByteArray &dataDecoded);
+    void decodeConfigMessage(const QByteArray &data);
+    void decodeDevicelistMessage(const QByteArray &data);
+    void decodeCommandMessage(const QByteArray &data);
+    void parseWeeklyProgram(QByteArray data);
+    void decodeNewDeviceFoundMessage(const QByteArray &data);
+
+    QDateTime calculateDateTime(QByteArray dateRaw, QByteArray timeRaw);
+    QString deviceTypeString(int deviceType);
+    QString weekDayString(int weekDay);
+
+signals:
+    void helloReceived();
+    void cubeACK();
+    void cubeConfigReady();
+    void wallThermostatFound();
+    void radiatorThermostatFound();
+
+    void wallThermostatDataUpdated(WallThermostat *wallThermostat);
+    void radiatorThermostatDataUpdated(RadiatorThermostat *radiatorThermostat);
+
+    void commandFinished(const bool &succeeded);
+};
+
+#endif // MAXCUBEDECODER_H
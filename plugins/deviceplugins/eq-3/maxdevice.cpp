@@ -21,6 +21,8 @@
 #include "maxdevice.h"
 #include "extern-plugininfo.h"
 
+#include <string.h>
+
 MaxDevice::MaxDevice(QObject *parent) :
     QObject(parent)
 {
@@ -115,3 +117,12 @@ void MaxDevice::setRoomName(const QString &roomName)
     m_roomName = roomName;
 }
 
+bool MaxDevice::updateLiveData(const char *data, int length)
+{
+    // most live records of a refresh are identical to the previous one
+    if (m_liveData.length() == length && memcmp(m_liveData.constData(), data, length) == 0)
+        return false;
+
+    m_liveData = QByteArray(data, length);
+    return true;
+}
@@ -67,6 +67,8 @@ public:
     QString roomName() const;
     void setRoomName(const QString &roomName);
 
+    bool updateLiveData(const char *data, int length);
+
 private:
     int m_deviceType;
     QString m_deviceTypeString;
@@ -76,6 +78,7 @@ private:
     int m_roomId;
     QString m_roomName;
     bool m_batteryOk;
+    QByteArray m_liveData;
 
 signals:
 
@@ -182,58 +182,18 @@ DeviceManager::DeviceError DevicePluginIntertechno::executeAction(Device *device
     }
 }
 
-void DevicePluginIntertechno::radioData(const QList<int> &rawData)
+Radio433CodeWord::Protocols DevicePluginIntertechno::radio433Protocols() const
 {
-    // filter right here a wrong signal length
-    if (rawData.length() != 49) {
-        return;
-    }
-    
-    //    QList<Device*> deviceList = deviceManager()->findConfiguredDevices(intertechnoRemoteDeviceClassId);
-    //    if (deviceList.isEmpty()) {
-    //        return;
-    //    }
+    return Radio433CodeWord::ProtocolTristate48;
+}
 
-    int delay = rawData.first()/31;
-    QByteArray binCode;
-    
-    // =======================================
+void DevicePluginIntertechno::radioCodeReceived(const Radio433CodeWord &codeWord)
+{
     // average 314
-    if (delay > 300 && delay < 400) {
-        // go trough all 48 timings (without sync signal)
-        for (int i = 1; i <= 48; i+=2 ) {
-            int div;
-            int divNext;
-            
-            // if short
-            if (rawData.at(i) <= 700) {
-                div = 1;
-            } else {
-                div = 3;
-            }
-            // if long
-            if (rawData.at(i+1) < 700) {
-                divNext = 1;
-            } else {
-                divNext = 3;
-            }
-            
-            //              _
-            // if we have  | |___ = 0 -> in 4 delays => 1000
-            //                 _
-            // if we have  ___| | = 1 -> in 4 delays => 0001
-            
-            if (div == 1 && divNext == 3) {
-                binCode.append('0');
-            } else if (div == 3 && divNext == 1) {
-                binCode.append('1');
-            } else {
-                return;
-            }
-        }
-    } else {
+    if (codeWord.delay() <= 300)
         return;
-    }
+
+    QByteArray binCode = codeWord.binCode();
 
     // =======================================
     // Check nibble 16-19, must be 0001
@@ -34,7 +34,8 @@ public:
     explicit DevicePluginIntertechno();
 
     DeviceManager::HardwareResources requiredHardware() const override;
-    void radioData(const QList<int> &rawData) override;
+    Radio433CodeWord::Protocols radio433Protocols() const override;
+    void radioCodeReceived(const Radio433CodeWord &codeWord) override;
 
 public slots:
     DeviceManager::DeviceError executeAction(Device *device, const Action &action) override;
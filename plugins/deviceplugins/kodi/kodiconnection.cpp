@@ -28,7 +28,8 @@ KodiConnection::KodiConnection(const QHostAddress &hostAddress, const int &port,
     QObject(parent),
     m_hostAddress(hostAddress),
     m_port(port),
-    m_connected(false)
+    m_connected(false),
+    m_framer(16 * 1024 * 1024)  // library notifications can be several megabytes
 {
     m_socket = new QTcpSocket(this);
 
@@ -70,6 +71,7 @@ void KodiConnection::onConnected()
 {
     qCDebug(dcKodi) << "connected successfully to" << hostAddress().toString() << port();
     m_connected = true;
+    m_framer.clear();
     emit connectionStatusChanged();
 }
 
@@ -89,22 +91,11 @@ void KodiConnection::onError(QAbstractSocket::SocketError socketError)
 
 void KodiConnection::readData()
 {
-    QByteArray data = m_socket->readAll();
-
-    QStringList commandList = QString(data).split("}{");
-    for(int i = 0; i < commandList.count(); ++i) {
-        QString command = commandList.at(i);
-        if(command.isEmpty()) {
-            continue;
-        }
-        if(i < commandList.count() - 1) {
-            command.append("}");
-        }
-        if(i > 0) {
-            command.prepend("{");
-        }
-        emit dataReady(command.toUtf8());
-    }
+    if (!m_framer.append(m_socket->readAll()))
+        qCWarning(dcKodi) << "message from" << hostAddress().toString() << "exceeds the maximum size of" << m_framer.maximumMessageSize() << "bytes";
+
+    while (m_framer.hasMessage())
+        emit dataReady(m_framer.takeMessage());
 }
 
 void KodiConnection::sendData(const QByteArray &message)
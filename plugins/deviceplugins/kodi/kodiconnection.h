@@ -26,6 +26,8 @@
 #include <QHostAddress>
 #include <QJsonDocument>
 
+#include "network/jsonstreamframer.h"
+
 class KodiConnection : public QObject
 {
     Q_OBJECT
@@ -46,6 +48,7 @@ private:
     QHostAddress m_hostAddress;
     int m_port;
     bool m_connected;
+    JsonStreamFramer m_framer;
 
 private slots:
     void onConnected();
@@ -67,6 +67,12 @@ DeviceManager::HardwareResources DevicePluginLeynew::requiredHardware() const
     return DeviceManager::HardwareResourceRadio433;
 }
 
+Radio433CodeWord::Protocols DevicePluginLeynew::radio433Protocols() const
+{
+    // Only transmitting
+    return Radio433CodeWord::ProtocolNone;
+}
+
 DeviceManager::DeviceError DevicePluginLeynew::executeAction(Device *device, const Action &action)
 {   
 
@@ -35,6 +35,7 @@ public:
 
     DeviceManager::DeviceSetupStatus setupDevice(Device *device) override;
     DeviceManager::HardwareResources requiredHardware() const override;
+    Radio433CodeWord::Protocols radio433Protocols() const override;
 
 public slots:
     DeviceManager::DeviceError executeAction(Device *device, const Action &action) override;
@@ -61,7 +61,29 @@ DevicePluginMock::~DevicePluginMock()
 
 DeviceManager::HardwareResources DevicePluginMock::requiredHardware() const
 {
-    return DeviceManager::HardwareResourceTimer;
+    return DeviceManager::HardwareResourceTimer | DeviceManager::HardwareResourceRadio433 | DeviceManager::HardwareResourceUpnpDisovery;
+}
+
+Radio433CodeWord::Protocols DevicePluginMock::radio433Protocols() const
+{
+    return Radio433CodeWord::ProtocolTristate48;
+}
+
+void DevicePluginMock::radioCodeReceived(const Radio433CodeWord &codeWord)
+{
+    qCDebug(dcMockDevice) << "Radio code received" << codeWord.binCode();
+    emit radioCodeHandled(codeWord.binCode());
+}
+
+QStringList DevicePluginMock::upnpNotifyFilter() const
+{
+    return QStringList() << "urn:guh-io:device:Mock:1" << "uuid:mock-*";
+}
+
+void DevicePluginMock::upnpNotifyReceived(const SsdpMessage &notification)
+{
+    qCDebug(dcMockDevice) << "UPnP notification received" << notification.usn();
+    emit upnpNotifyHandled(notification.usn());
 }
 
 DeviceManager::DeviceError DevicePluginMock::discoverDevices(const DeviceClassId &deviceClassId, const ParamList &params)
@@ -40,6 +40,10 @@ public:
     ~DevicePluginMock();
 
     DeviceManager::HardwareResources requiredHardware() const override;
+    Radio433CodeWord::Protocols radio433Protocols() const override;
+    void radioCodeReceived(const Radio433CodeWord &codeWord) override;
+    QStringList upnpNotifyFilter() const override;
+    void upnpNotifyReceived(const SsdpMessage &notification) override;
     DeviceManager::DeviceError discoverDevices(const DeviceClassId &deviceClassId, const ParamList &params) override;
 
     DeviceManager::DeviceSetupStatus setupDevice(Device *device) override;
@@ -51,6 +55,13 @@ public:
     DeviceManager::DeviceSetupStatus confirmPairing(const PairingTransactionId &pairingTransactionId, const DeviceClassId &deviceClassId, const ParamList &params, const QString &secret) override;
     DeviceManager::DeviceError displayPin(const PairingTransactionId &pairingTransactionId, const DeviceDescriptor &deviceDescriptor) override;
 
+signals:
+    // lets tests observe which radio codes got routed to this plugin
+    void radioCodeHandled(const QByteArray &binCode);
+
+    // lets tests observe which UPnP notifications got routed to this plugin
+    void upnpNotifyHandled(const QByteArray &usn);
+
 public slots:
     DeviceManager::DeviceError executeAction(Device *device, const Action &action) override;
 
@@ -0,0 +1,144 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \page mockthreadeddevices.html
+    \title Threaded mock devices
+    \brief Devices for testing plugins on a worker thread.
+
+    \ingroup plugins
+    \ingroup guh-tests
+
+    The threaded mock devices run on the \l{PluginThread} "mock" and are used to test the calls of the
+    \l{DeviceManager} into a plugin living on a worker thread. The plugin creates no auto devices, so it
+    also gets used to test the lazy loading of plugins.
+
+    \chapter Plugin properties
+    Following JSON file contains the definition and the description of all available \l{DeviceClass}{DeviceClasses}
+    and \l{Vendor}{Vendors} of this \l{DevicePlugin}.
+
+    For more details how to read this JSON file please check out the documentation for \l{The plugin JSON File}.
+
+    \quotefile plugins/deviceplugins/mockthreaded/devicepluginmockthreaded.json
+*/
+
+#include "devicepluginmockthreaded.h"
+
+#include "plugin/device.h"
+#include "devicemanager.h"
+#include "plugininfo.h"
+
+#include <QThread>
+#include <QTimer>
+#include <QCoreApplication>
+
+DevicePluginMockThreaded::DevicePluginMockThreaded()
+{
+}
+
+DeviceManager::HardwareResources DevicePluginMockThreaded::requiredHardware() const
+{
+    return DeviceManager::HardwareResourceNone;
+}
+
+DeviceManager::DeviceError DevicePluginMockThreaded::discoverDevices(const DeviceClassId &deviceClassId, const ParamList &params)
+{
+    Q_UNUSED(params)
+
+    if (deviceClassId != mockThreadedDeviceClassId)
+        return DeviceManager::DeviceErrorDeviceClassNotFound;
+
+    QTimer::singleShot(200, this, SLOT(emitDevicesDiscovered()));
+    return DeviceManager::DeviceErrorAsync;
+}
+
+DeviceManager::DeviceSetupStatus DevicePluginMockThreaded::setupDevice(Device *device)
+{
+    bool workerThread = QThread::currentThread() != QCoreApplication::instance()->thread();
+    qCDebug(dcMockThreaded) << "Setup threaded mock device" << device->params() << "on worker thread:" << workerThread;
+    device->setStateValue(workerThreadStateTypeId, workerThread);
+
+    if (device->paramValue(asyncParamTypeId).toBool()) {
+        m_asyncSetupDevices.append(device);
+        QTimer::singleShot(500, this, SLOT(emitDeviceSetupFinished()));
+        return DeviceManager::DeviceSetupStatusAsync;
+    }
+    return DeviceManager::DeviceSetupStatusSuccess;
+}
+
+void DevicePluginMockThreaded::postSetupDevice(Device *device)
+{
+    qCDebug(dcMockThreaded) << "Postsetup threaded mock device" << device->name();
+    device->setStateValue(postSetupStateTypeId, true);
+}
+
+void DevicePluginMockThreaded::deviceRemoved(Device *device)
+{
+    // a removed device must not be reported any more
+    m_asyncSetupDevices.removeAll(device);
+    for (int i = m_asyncActions.count() - 1; i >= 0; i--) {
+        if (m_asyncActions.at(i).second == device)
+            m_asyncActions.removeAt(i);
+    }
+}
+
+DeviceManager::DeviceError DevicePluginMockThreaded::executeAction(Device *device, const Action &action)
+{
+    if (device->deviceClassId() != mockThreadedDeviceClassId)
+        return DeviceManager::DeviceErrorDeviceClassNotFound;
+
+    if (action.actionTypeId() == syncActionTypeId) {
+        return DeviceManager::DeviceErrorNoError;
+    } else if (action.actionTypeId() == valueActionTypeId) {
+        device->setStateValue(valueStateTypeId, action.param(valueStateParamTypeId).value().toInt());
+        return DeviceManager::DeviceErrorNoError;
+    } else if (action.actionTypeId() == failingActionTypeId) {
+        return DeviceManager::DeviceErrorSetupFailed;
+    } else if (action.actionTypeId() == asyncActionTypeId) {
+        m_asyncActions.append(qMakePair<Action, Device *>(action, device));
+        QTimer::singleShot(200, this, SLOT(emitActionExecuted()));
+        return DeviceManager::DeviceErrorAsync;
+    }
+    return DeviceManager::DeviceErrorActionTypeNotFound;
+}
+
+void DevicePluginMockThreaded::emitDevicesDiscovered()
+{
+    DeviceDescriptor descriptor(mockThreadedDeviceClassId, "Threaded mock device (discovered)");
+    descriptor.setParams(ParamList() << Param(asyncParamTypeId, false));
+    emit devicesDiscovered(mockThreadedDeviceClassId, QList<DeviceDescriptor>() << descriptor);
+}
+
+void DevicePluginMockThreaded::emitDeviceSetupFinished()
+{
+    if (m_asyncSetupDevices.isEmpty())
+        return;
+
+    qCDebug(dcMockThreaded) << "Emitting setup finished";
+    emit deviceSetupFinished(m_asyncSetupDevices.takeFirst(), DeviceManager::DeviceSetupStatusSuccess);
+}
+
+void DevicePluginMockThreaded::emitActionExecuted()
+{
+    if (m_asyncActions.isEmpty())
+        return;
+
+    emit actionExecutionFinished(m_asyncActions.takeFirst().first.id(), DeviceManager::DeviceErrorNoError);
+}
@@ -0,0 +1,56 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef DEVICEPLUGINMOCKTHREADED_H
+#define DEVICEPLUGINMOCKTHREADED_H
+
+#include "plugin/deviceplugin.h"
+
+class DevicePluginMockThreaded : public DevicePlugin
+{
+    Q_OBJECT
+
+    Q_PLUGIN_METADATA(IID "guru.guh.DevicePlugin" FILE "devicepluginmockthreaded.json")
+    Q_INTERFACES(DevicePlugin)
+
+public:
+    explicit DevicePluginMockThreaded();
+
+    DeviceManager::HardwareResources requiredHardware() const override;
+
+    DeviceManager::DeviceError discoverDevices(const DeviceClassId &deviceClassId, const ParamList &params) override;
+    DeviceManager::DeviceSetupStatus setupDevice(Device *device) override;
+    void postSetupDevice(Device *device) override;
+    void deviceRemoved(Device *device) override;
+
+public slots:
+    DeviceManager::DeviceError executeAction(Device *device, const Action &action) override;
+
+private slots:
+    void emitDevicesDiscovered();
+    void emitDeviceSetupFinished();
+    void emitActionExecuted();
+
+private:
+    QList<Device *> m_asyncSetupDevices;
+    QList<QPair<Action, Device *> > m_asyncActions;
+};
+
+#endif // DEVICEPLUGINMOCKTHREADED_H
@@ -0,0 +1,13 @@
+TRANSLATIONS = translations/en_US.ts \
+               translations/de_DE.ts
+
+# Note: include after the TRANSLATIONS definition
+include(../../plugins.pri)
+
+TARGET = $$qtLibraryTarget(guh_devicepluginmockthreaded)
+
+SOURCES += \
+    devicepluginmockthreaded.cpp
+
+HEADERS += \
+    devicepluginmockthreaded.h
@@ -0,0 +1,22 @@
+<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE TS>
+<TS version="2.1" language="en_US">
+<context>
+    <name>MockThreaded</name>
+    <message>
+        <source>Threaded Mock Devices</source>
+        <extracomment>The name of the plugin Threaded Mock Devices (4d56bb36-7b6b-4a8e-a5aa-fe363b23f5c3)</extracomment>
+        <translation type="unfinished"></translation>
+    </message>
+    <message>
+        <source>guh</source>
+        <extracomment>The name of the vendor (2062d64d-3232-433c-88bc-0d33c0ba2ba6)</extracomment>
+        <translation type="unfinished"></translation>
+    </message>
+    <message>
+        <source>Threaded Mock Device</source>
+        <extracomment>The name of the DeviceClass (72cb1038-d893-4624-84bc-d915a1f8e5f9)</extracomment>
+        <translation type="unfinished"></translation>
+    </message>
+</context>
+</TS>
@@ -30,7 +30,9 @@
 
     This plugin allows to find and monitor network devices in your local network by using the hostname of the devices.
 
-    \underline{NOTE}: the application \c nmap has to be installed and guh has to run as root.
+    The presence of the configured hosts is read from the neighbor table of the kernel (\c /proc/net/arp).
+    Only the configured hosts get probed with a single unicast datagram on every poll, and a host has
+    to be missing for several polls before it is marked as out of range.
 
     \chapter Plugin properties
     Following JSON file contains the definition and the description of all available \l{DeviceClass}{DeviceClasses}
@@ -49,55 +51,55 @@
 #include "plugininfo.h"
 
 #include <QDebug>
+#include <QTimer>
 #include <QStringList>
 #include <QNetworkInterface>
 
 DevicePluginNetworkDetector::DevicePluginNetworkDetector():
-    m_discoveryProcess(0),
-    m_scanProcess(0),
-    m_aboutToQuit(false)
+    m_presenceEngine(new PresenceEngine(new ProcNeighborTable(), this)),
+    m_discoveryRunning(false)
 {
-
-}
-
-DevicePluginNetworkDetector::~DevicePluginNetworkDetector()
-{
-    // Stop running processes
-    m_aboutToQuit = true;
-
-    if (m_scanProcess && m_scanProcess->state() == QProcess::Running) {
-        qCDebug(dcNetworkDetector()) << "Kill running scan process";
-        m_scanProcess->kill();
-        m_scanProcess->waitForFinished(5000);
-    }
-
-    if (m_discoveryProcess && m_discoveryProcess->state() == QProcess::Running) {
-        qCDebug(dcNetworkDetector()) << "Kill running discovery process";
-        m_discoveryProcess->terminate();
-        m_discoveryProcess->waitForFinished(5000);
-    }
+    connect(m_presenceEngine, &PresenceEngine::hostStateChanged, this, &DevicePluginNetworkDetector::onHostStateChanged);
 }
 
 DeviceManager::DeviceSetupStatus DevicePluginNetworkDetector::setupDevice(Device *device)
 {
     qCDebug(dcNetworkDetector()) << "Setup" << device->name() << device->params();
+    m_presenceEngine->addHost(device->paramValue(hostnameParamTypeId).toString());
     return DeviceManager::DeviceSetupStatusSuccess;
 }
 
+void DevicePluginNetworkDetector::deviceRemoved(Device *device)
+{
+    QString hostName = device->paramValue(hostnameParamTypeId).toString();
+    foreach (Device *d, myDevices()) {
+        if (d != device && d->paramValue(hostnameParamTypeId).toString() == hostName)
+            return;
+    }
+
+    m_presenceEngine->removeHost(hostName);
+}
+
 DeviceManager::DeviceError DevicePluginNetworkDetector::discoverDevices(const DeviceClassId &deviceClassId, const ParamList &params)
 {
     Q_UNUSED(params)
 
-
     if (deviceClassId != networkDeviceClassId)
         return DeviceManager::DeviceErrorDeviceClassNotFound;
 
-    if (m_discoveryProcess) {
+    if (m_discoveryRunning) {
         qCWarning(dcNetworkDetector()) << "Network discovery already running";
         return DeviceManager::DeviceErrorDeviceInUse;
     }
 
-    m_discoveryProcess = startScanProcesses();
+    // fill the neighbor table once, the answers will be collected after the kernel resolved them
+    QList<QHostAddress> targets = getDefaultTargets();
+    qCDebug(dcNetworkDetector()) << "Start network discovery for" << targets.count() << "addresses";
+    foreach (const QHostAddress &address, targets)
+        m_presenceEngine->probe(address);
+
+    m_discoveryRunning = true;
+    QTimer::singleShot(3000, this, SLOT(onDiscoveryProbesFinished()));
     return DeviceManager::DeviceErrorAsync;
 }
 
@@ -108,159 +110,77 @@ DeviceManager::HardwareResources DevicePluginNetworkDetector::requiredHardware()
 
 void DevicePluginNetworkDetector::guhTimer()
 {
-    if (!myDevices().isEmpty() && !m_scanProcess)
-        m_scanProcess = startScanProcesses();
-
-}
-
-QProcess * DevicePluginNetworkDetector::startScanProcesses()
-{
-    QStringList targets = getDefaultTargets();
-    qCDebug(dcNetworkDetector()) << "Start network discovery" << targets;
-    QProcess *process = new QProcess(this);
-    connect(process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(processFinished(int,QProcess::ExitStatus)));
-
-    QStringList arguments;
-    arguments << "-R" << "-oX" << "-" << "-v" << "--stats-every" << "1" << "-sn";
-    arguments << targets;
-
-    process->start(QStringLiteral("nmap"), arguments);
-    return process;
+    m_presenceEngine->poll();
 }
 
-
-QStringList DevicePluginNetworkDetector::getDefaultTargets()
+QList<QHostAddress> DevicePluginNetworkDetector::getDefaultTargets()
 {
-    QStringList targets;
+    QList<QHostAddress> targets;
     foreach (const QHostAddress &interface, QNetworkInterface::allAddresses()) {
-        if (!interface.isLoopback() && interface.scopeId().isEmpty()) {
-            QPair<QHostAddress, int> pair = QHostAddress::parseSubnet(interface.toString() + "/24");
-            targets << QString("%1/%2").arg(pair.first.toString()).arg(pair.second);
+        if (interface.isLoopback() || interface.protocol() != QAbstractSocket::IPv4Protocol)
+            continue;
+
+        QPair<QHostAddress, int> subnet = QHostAddress::parseSubnet(interface.toString() + "/24");
+        quint32 network = subnet.first.toIPv4Address();
+        for (quint32 i = 1; i < 255; i++) {
+            QHostAddress address(network + i);
+            if (address != interface)
+                targets.append(address);
         }
     }
     return targets;
 }
 
-QList<Host> DevicePluginNetworkDetector::parseProcessOutput(const QByteArray &processData)
+void DevicePluginNetworkDetector::finishDiscovery()
 {
-    m_reader.clear();
-    m_reader.addData(processData);
-
-    QList<Host> hosts;
+    QList<DeviceDescriptor> deviceDescriptors;
+    foreach (const Host &host, m_discoveredHosts) {
+        DeviceDescriptor descriptor(networkDeviceClassId, host.hostName(), host.adderss());
+        descriptor.setParams(ParamList() << Param(hostnameParamTypeId, host.hostName()));
+        deviceDescriptors.append(descriptor);
+    }
 
-    while (!m_reader.atEnd() && !m_reader.hasError()) {
+    m_discoveredHosts.clear();
+    m_discoveryRunning = false;
 
-        QXmlStreamReader::TokenType token = m_reader.readNext();
-        if(token == QXmlStreamReader::StartDocument)
-            continue;
+    qCDebug(dcNetworkDetector()) << "Network discovery finished:" << deviceDescriptors.count() << "hosts";
+    emit devicesDiscovered(networkDeviceClassId, deviceDescriptors);
+}
 
-        if(token == QXmlStreamReader::StartElement && m_reader.name() == "host") {
-            Host host = parseHost();
-            if (host.isValid()) {
-                hosts.append(host);
-            }
-        }
+void DevicePluginNetworkDetector::onHostStateChanged(const QString &hostName, const bool &present)
+{
+    qCDebug(dcNetworkDetector()) << hostName << (present ? "is in range" : "is out of range");
+    foreach (Device *device, myDevices()) {
+        if (device->paramValue(hostnameParamTypeId).toString() == hostName)
+            device->setStateValue(inRangeStateTypeId, present);
     }
-    return hosts;
 }
 
-Host DevicePluginNetworkDetector::parseHost()
+void DevicePluginNetworkDetector::onDiscoveryProbesFinished()
 {
-    if (!m_reader.isStartElement() || m_reader.name() != "host")
-        return Host();
-
-    QString address; QString hostName; QString status;
-    while(!(m_reader.tokenType() == QXmlStreamReader::EndElement && m_reader.name() == "host")){
-
-        m_reader.readNext();
-
-        if (m_reader.isStartElement() && m_reader.name() == "hostname") {
-            QString name = m_reader.attributes().value("name").toString();
-            if (!name.isEmpty())
-                hostName = name;
-
-            m_reader.readNext();
-        }
-
-        if (m_reader.name() == "address") {
-            QString addr = m_reader.attributes().value("addr").toString();
-            if (!addr.isEmpty())
-                address = addr;
-        }
+    foreach (const NeighborEntry &entry, m_presenceEngine->neighbors()) {
+        if (!entry.complete())
+            continue;
 
-        if (m_reader.name() == "status") {
-            QString state = m_reader.attributes().value("state").toString();
-            if (!state.isEmpty())
-                status = state;
-        }
+        m_discoveryLookups.append(QHostInfo::lookupHost(entry.address().toString(), this, SLOT(onDiscoveryLookupFinished(QHostInfo))));
     }
 
-    return Host(hostName, address, (status == "up" ? true : false));
+    if (m_discoveryLookups.isEmpty())
+        finishDiscovery();
 }
 
-void DevicePluginNetworkDetector::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void DevicePluginNetworkDetector::onDiscoveryLookupFinished(const QHostInfo &hostInfo)
 {
-    QProcess *process = static_cast<QProcess*>(sender());
-
-    // If the process was killed because guhd is shutting down...we dont't care any more about the result
-    if (m_aboutToQuit)
+    if (!m_discoveryLookups.removeOne(hostInfo.lookupId()))
         return;
 
-    // Discovery
-    if (process == m_discoveryProcess) {
-
-        qCDebug(dcNetworkDetector()) << "Discovery process finished";
-
-        process->deleteLater();
-        m_discoveryProcess = 0;
-
-        QList<DeviceDescriptor> deviceDescriptors;
-        if (exitCode != 0 || exitStatus != QProcess::NormalExit) {
-            qCWarning(dcNetworkDetector) << "Network scan error:" << process->readAllStandardError();
-            emit devicesDiscovered(networkDeviceClassId, deviceDescriptors);
-            return;
-        }
-
-        QByteArray outputData = process->readAllStandardOutput();
-        foreach (const Host &host, parseProcessOutput(outputData)) {
-            DeviceDescriptor descriptor(networkDeviceClassId, host.hostName(), host.adderss());
-            descriptor.setParams( ParamList() << Param(hostnameParamTypeId, host.hostName()));
-            deviceDescriptors.append(descriptor);
-        }
-
-        emit devicesDiscovered(networkDeviceClassId, deviceDescriptors);
-
-    } else if (process == m_scanProcess) {
-        // Scan
-        qCDebug(dcNetworkDetector()) << "Network scan process finished";
-
-        process->deleteLater();
-        m_scanProcess = 0;
-
-        if (exitCode != 0 || exitStatus != QProcess::NormalExit) {
-            qCWarning(dcNetworkDetector) << "Network scan error:" << process->readAllStandardError();
-            return;
-        }
-
-        if (myDevices().isEmpty()) {
-            process->deleteLater();
-            return;
-        }
-
-        QStringList upHosts;
-        QByteArray outputData = process->readAllStandardOutput();
-        foreach (const Host &host, parseProcessOutput(outputData)) {
-            if (host.isValid() && host.reachable())
-                upHosts.append(host.hostName());
-
-        }
-
-        foreach (Device *device, myDevices()) {
-            if (upHosts.contains(device->paramValue(hostnameParamTypeId).toString())) {
-                device->setStateValue(inRangeStateTypeId, true);
-            } else {
-                device->setStateValue(inRangeStateTypeId, false);
-            }
-        }
+    if (!hostInfo.addresses().isEmpty()) {
+        // hosts without a reverse DNS entry can still be monitored by address
+        QString address = hostInfo.addresses().first().toString();
+        QString hostName = hostInfo.error() == QHostInfo::NoError ? hostInfo.hostName() : address;
+        m_discoveredHosts.append(Host(hostName, address, true));
     }
+
+    if (m_discoveryLookups.isEmpty())
+        finishDiscovery();
 }
@@ -23,10 +23,10 @@
 #define DEVICEPLUGINNETWORKDETECTOR_H
 
 #include "plugin/deviceplugin.h"
+#include "presenceengine.h"
 #include "host.h"
 
-#include <QProcess>
-#include <QXmlStreamReader>
+#include <QHostInfo>
 
 class DevicePluginNetworkDetector : public DevicePlugin
 {
@@ -37,31 +37,28 @@ class DevicePluginNetworkDetector : public DevicePlugin
 
 public:
     explicit DevicePluginNetworkDetector();
-    ~DevicePluginNetworkDetector();
 
     DeviceManager::DeviceSetupStatus setupDevice(Device *device) override;
+    void deviceRemoved(Device *device) override;
     DeviceManager::DeviceError discoverDevices(const DeviceClassId &deviceClassId, const ParamList &params) override;
     DeviceManager::HardwareResources requiredHardware() const override;
 
     void guhTimer() override;
 
 private:
-    QProcess * m_discoveryProcess;
-    QProcess * m_scanProcess;
+    PresenceEngine *m_presenceEngine;
 
-    QXmlStreamReader m_reader;
+    bool m_discoveryRunning;
+    QList<int> m_discoveryLookups;
+    QList<Host> m_discoveredHosts;
 
-    bool m_aboutToQuit;
-
-    QStringList getDefaultTargets();
-    QProcess *startScanProcesses();
-
-    // Process parsing
-    QList<Host> parseProcessOutput(const QByteArray &processData);
-    Host parseHost();
+    QList<QHostAddress> getDefaultTargets();
+    void finishDiscovery();
 
 private slots:
-    void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onHostStateChanged(const QString &hostName, const bool &present);
+    void onDiscoveryProbesFinished();
+    void onDiscoveryLookupFinished(const QHostInfo &hostInfo);
 
 };
 
@@ -0,0 +1,119 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "neighbortable.h"
+#include "extern-plugininfo.h"
+
+#include <QFile>
+
+// ATF_COM from <net/if_arp.h>: the hardware address of the entry is resolved
+static const int completeFlag = 0x02;
+
+// the discard port, the datagram is only needed to make the kernel resolve the address
+static const quint16 probePort = 9;
+
+NeighborEntry::NeighborEntry() :
+    m_complete(false)
+{
+
+}
+
+NeighborEntry::NeighborEntry(const QHostAddress &address, const QString &macAddress, const QString &interface, const bool &complete) :
+    m_address(address),
+    m_macAddress(macAddress),
+    m_interface(interface),
+    m_complete(complete)
+{
+
+}
+
+QHostAddress NeighborEntry::address() const
+{
+    return m_address;
+}
+
+QString NeighborEntry::macAddress() const
+{
+    return m_macAddress;
+}
+
+QString NeighborEntry::interface() const
+{
+    return m_interface;
+}
+
+bool NeighborEntry::complete() const
+{
+    return m_complete;
+}
+
+ProcNeighborTable::ProcNeighborTable(const QString &fileName) :
+    m_fileName(fileName)
+{
+
+}
+
+QList<NeighborEntry> ProcNeighborTable::readEntries()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(dcNetworkDetector()) << "Could not open neighbor table" << m_fileName << file.errorString();
+        return QList<NeighborEntry>();
+    }
+
+    return parse(file.readAll());
+}
+
+void ProcNeighborTable::probe(const QHostAddress &address)
+{
+    // a unicast datagram makes the kernel (re)validate the neighbor entry of this address
+    m_probeSocket.writeDatagram(QByteArray(1, '\0'), address, probePort);
+}
+
+QList<NeighborEntry> ProcNeighborTable::parse(const QByteArray &data)
+{
+    // IP address       HW type     Flags       HW address            Mask     Device
+    // 10.10.10.1       0x1         0x2         00:11:22:33:44:55     *        eth0
+    QList<NeighborEntry> entries;
+    QList<QByteArray> lines = data.split('\n');
+    for (int i = 1; i < lines.count(); i++) {
+        QList<QByteArray> columns = lines.at(i).simplified().split(' ');
+        if (columns.count() < 6)
+            continue;
+
+        QHostAddress address(QString::fromLatin1(columns.at(0)));
+        if (address.isNull())
+            continue;
+
+        bool ok = false;
+        int flags = columns.at(2).toInt(&ok, 16);
+        if (!ok)
+            continue;
+
+        entries.append(NeighborEntry(address, QString::fromLatin1(columns.at(3)).toLower(), QString::fromLatin1(columns.at(5)), flags & completeFlag));
+    }
+    return entries;
+}
+
+QDebug operator<<(QDebug dbg, const NeighborEntry &entry)
+{
+    dbg.nospace() << "NeighborEntry(" << entry.address().toString() << ", " << entry.macAddress() << ", " << entry.interface() << ", " << (entry.complete() ? "complete" : "incomplete") << ")";
+    return dbg.space();
+}
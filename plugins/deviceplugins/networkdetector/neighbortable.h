@@ -0,0 +1,75 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef NEIGHBORTABLE_H
+#define NEIGHBORTABLE_H
+
+#include <QList>
+#include <QDebug>
+#include <QString>
+#include <QUdpSocket>
+#include <QHostAddress>
+
+class NeighborEntry
+{
+public:
+    NeighborEntry();
+    NeighborEntry(const QHostAddress &address, const QString &macAddress, const QString &interface, const bool &complete);
+
+    QHostAddress address() const;
+    QString macAddress() const;
+    QString interface() const;
+    bool complete() const;
+
+private:
+    QHostAddress m_address;
+    QString m_macAddress;
+    QString m_interface;
+    bool m_complete;
+};
+
+// Source of the kernel neighbor table and of the probes which keep it up to date
+class NeighborTable
+{
+public:
+    virtual ~NeighborTable() {}
+
+    virtual QList<NeighborEntry> readEntries() = 0;
+    virtual void probe(const QHostAddress &address) = 0;
+};
+
+class ProcNeighborTable : public NeighborTable
+{
+public:
+    explicit ProcNeighborTable(const QString &fileName = "/proc/net/arp");
+
+    QList<NeighborEntry> readEntries() override;
+    void probe(const QHostAddress &address) override;
+
+    static QList<NeighborEntry> parse(const QByteArray &data);
+
+private:
+    QString m_fileName;
+    QUdpSocket m_probeSocket;
+};
+
+QDebug operator<<(QDebug dbg, const NeighborEntry &entry);
+
+#endif // NEIGHBORTABLE_H
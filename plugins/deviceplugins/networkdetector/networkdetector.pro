@@ -8,10 +8,14 @@ TARGET = $$qtLibraryTarget(guh_devicepluginnetworkdetector)
 
 SOURCES += \
     devicepluginnetworkdetector.cpp \
-    host.cpp
+    host.cpp \
+    neighbortable.cpp \
+    presenceengine.cpp
 
 HEADERS += \
     devicepluginnetworkdetector.h \
-    host.h
+    host.h \
+    neighbortable.h \
+    presenceengine.h
 
 
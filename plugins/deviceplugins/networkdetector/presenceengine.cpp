@@ -0,0 +1,177 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "presenceengine.h"
+#include "extern-plugininfo.h"
+
+PresenceEngine::PresenceEngine(NeighborTable *neighborTable, QObject *parent) :
+    QObject(parent),
+    m_neighborTable(neighborTable),
+    m_absentThreshold(3)
+{
+
+}
+
+PresenceEngine::~PresenceEngine()
+{
+    foreach (int lookupId, m_lookups.keys())
+        QHostInfo::abortHostLookup(lookupId);
+
+    delete m_neighborTable;
+}
+
+int PresenceEngine::absentThreshold() const
+{
+    return m_absentThreshold;
+}
+
+void PresenceEngine::setAbsentThreshold(const int &absentThreshold)
+{
+    m_absentThreshold = qMax(1, absentThreshold);
+}
+
+void PresenceEngine::addHost(const QString &hostName)
+{
+    if (m_hosts.contains(hostName))
+        return;
+
+    TrackedHost host;
+    host.address = QHostAddress(hostName);
+    m_hosts.insert(hostName, host);
+
+    if (m_hosts.value(hostName).address.isNull())
+        lookupHost(hostName);
+}
+
+void PresenceEngine::removeHost(const QString &hostName)
+{
+    m_hosts.remove(hostName);
+}
+
+QStringList PresenceEngine::hosts() const
+{
+    return m_hosts.keys();
+}
+
+PresenceEngine::HostState PresenceEngine::hostState(const QString &hostName) const
+{
+    return m_hosts.value(hostName).state;
+}
+
+QHostAddress PresenceEngine::hostAddress(const QString &hostName) const
+{
+    return m_hosts.value(hostName).address;
+}
+
+QList<NeighborEntry> PresenceEngine::neighbors() const
+{
+    return m_neighborTable->readEntries();
+}
+
+void PresenceEngine::probe(const QHostAddress &address)
+{
+    m_neighborTable->probe(address);
+}
+
+void PresenceEngine::poll()
+{
+    if (m_hosts.isEmpty())
+        return;
+
+    // read the neighbor table once per poll and look up every tracked host in it
+    QHash<QHostAddress, NeighborEntry> addressTable;
+    QHash<QString, NeighborEntry> macTable;
+    foreach (const NeighborEntry &entry, m_neighborTable->readEntries()) {
+        if (!entry.complete())
+            continue;
+
+        addressTable.insert(entry.address(), entry);
+        macTable.insert(entry.macAddress(), entry);
+    }
+
+    for (QHash<QString, TrackedHost>::iterator it = m_hosts.begin(); it != m_hosts.end(); ++it) {
+        TrackedHost &host = it.value();
+
+        NeighborEntry entry = addressTable.value(host.address);
+
+        // the host could have received a new address (DHCP), but the hardware address stays the same
+        if (!entry.complete() && !host.macAddress.isEmpty() && macTable.contains(host.macAddress)) {
+            entry = macTable.value(host.macAddress);
+            host.address = entry.address();
+        }
+
+        if (entry.complete()) {
+            host.missedPolls = 0;
+            host.macAddress = entry.macAddress();
+            setHostState(it.key(), host, HostStatePresent);
+        } else {
+            // hysteresis: a host has to be missing for several polls before it counts as absent
+            host.missedPolls++;
+            if (host.missedPolls >= m_absentThreshold && host.state != HostStateAbsent) {
+                setHostState(it.key(), host, HostStateAbsent);
+
+                if (QHostAddress(it.key()).isNull() && !host.lookupPending)
+                    lookupHost(it.key());
+            }
+        }
+
+        // only the tracked hosts get probed, the answers show up in the table of the next poll
+        if (!host.address.isNull())
+            m_neighborTable->probe(host.address);
+    }
+}
+
+void PresenceEngine::lookupHost(const QString &hostName)
+{
+    m_hosts[hostName].lookupPending = true;
+    int lookupId = QHostInfo::lookupHost(hostName, this, SLOT(onHostLookupFinished(QHostInfo)));
+    m_lookups.insert(lookupId, hostName);
+}
+
+void PresenceEngine::setHostState(const QString &hostName, TrackedHost &host, const HostState &state)
+{
+    if (host.state == state)
+        return;
+
+    host.state = state;
+    emit hostStateChanged(hostName, state == HostStatePresent);
+}
+
+void PresenceEngine::onHostLookupFinished(const QHostInfo &hostInfo)
+{
+    QString hostName = m_lookups.take(hostInfo.lookupId());
+    if (!m_hosts.contains(hostName))
+        return;
+
+    TrackedHost &host = m_hosts[hostName];
+    host.lookupPending = false;
+
+    if (hostInfo.error() != QHostInfo::NoError) {
+        qCWarning(dcNetworkDetector()) << "Could not resolve host" << hostName << hostInfo.errorString();
+        return;
+    }
+
+    foreach (const QHostAddress &address, hostInfo.addresses()) {
+        if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+            host.address = address;
+            return;
+        }
+    }
+}
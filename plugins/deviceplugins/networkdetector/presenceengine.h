@@ -0,0 +1,92 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef PRESENCEENGINE_H
+#define PRESENCEENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QHostInfo>
+#include <QStringList>
+
+#include "neighbortable.h"
+
+class PresenceEngine : public QObject
+{
+    Q_OBJECT
+    Q_ENUMS(HostState)
+
+public:
+    enum HostState {
+        HostStateUnknown,
+        HostStatePresent,
+        HostStateAbsent
+    };
+
+    explicit PresenceEngine(NeighborTable *neighborTable, QObject *parent = 0);
+    ~PresenceEngine();
+
+    int absentThreshold() const;
+    void setAbsentThreshold(const int &absentThreshold);
+
+    void addHost(const QString &hostName);
+    void removeHost(const QString &hostName);
+    QStringList hosts() const;
+
+    HostState hostState(const QString &hostName) const;
+    QHostAddress hostAddress(const QString &hostName) const;
+
+    QList<NeighborEntry> neighbors() const;
+    void probe(const QHostAddress &address);
+
+public slots:
+    void poll();
+
+private:
+    class TrackedHost
+    {
+    public:
+        TrackedHost() : state(HostStateUnknown), missedPolls(0), lookupPending(false) {}
+
+        QHostAddress address;
+        QString macAddress;
+        HostState state;
+        int missedPolls;
+        bool lookupPending;
+    };
+
+    NeighborTable *m_neighborTable;
+    int m_absentThreshold;
+
+    QHash<QString, TrackedHost> m_hosts;
+    QHash<int, QString> m_lookups;
+
+    void lookupHost(const QString &hostName);
+    void setHostState(const QString &hostName, TrackedHost &host, const HostState &state);
+
+private slots:
+    void onHostLookupFinished(const QHostInfo &hostInfo);
+
+signals:
+    void hostStateChanged(const QString &hostName, const bool &present);
+
+};
+
+#endif // PRESENCEENGINE_H
@@ -49,6 +49,8 @@ DevicePluginOsdomotics::DevicePluginOsdomotics()
 {
     m_coap = new Coap(this);
     connect(m_coap, SIGNAL(replyFinished(CoapReply*)), this, SLOT(coapReplyFinished(CoapReply*)));
+    connect(m_coap, SIGNAL(notificationReceived(CoapObserveResource,int,QByteArray)), this, SLOT(onNotificationReceived(CoapObserveResource,int,QByteArray)));
+    connect(m_coap, SIGNAL(observationLost(CoapObserveResource)), this, SLOT(onObservationLost(CoapObserveResource)));
 }
 
 DeviceManager::HardwareResources DevicePluginOsdomotics::requiredHardware() const
@@ -86,7 +88,14 @@ DeviceManager::DeviceSetupStatus DevicePluginOsdomotics::setupDevice(Device *dev
 
 void DevicePluginOsdomotics::deviceRemoved(Device *device)
 {
-    Q_UNUSED(device)
+    if (device->deviceClassId() != merkurNodeDeviceClassId)
+        return;
+
+    QUrl url;
+    url.setScheme("coap");
+    url.setHost(device->paramValue(hostParamTypeId).toString());
+    url.setPath("/sensors/battery");
+    m_coap->disableNotifications(CoapRequest(url));
 }
 
 void DevicePluginOsdomotics::networkManagerReplyReady(QNetworkReply *reply)
@@ -128,15 +137,15 @@ void DevicePluginOsdomotics::networkManagerReplyReady(QNetworkReply *reply)
 
 void DevicePluginOsdomotics::postSetupDevice(Device *device)
 {
-    updateNode(device);
+    if (device->deviceClassId() == merkurNodeDeviceClassId)
+        updateNode(device);
 }
 
 void DevicePluginOsdomotics::guhTimer()
 {
+    // The nodes notify battery changes, only the routers have to be scanned for new nodes
     foreach (Device *device, myDevices()) {
-        if (device->deviceClassId() == merkurNodeDeviceClassId) {
-            updateNode(device);
-        } else if(device->deviceClassId() == rplRouterDeviceClassId) {
+        if (device->deviceClassId() == rplRouterDeviceClassId) {
             scanNodes(device);
         }
     }
@@ -228,14 +237,15 @@ void DevicePluginOsdomotics::parseNodes(Device *device, const QByteArray &data)
 
 void DevicePluginOsdomotics::updateNode(Device *device)
 {
-    qCDebug(dcOsdomotics) << "Update node" << device->paramValue(hostParamTypeId).toString() << "battery value";
+    qCDebug(dcOsdomotics) << "Observe node" << device->paramValue(hostParamTypeId).toString() << "battery value";
 
     QUrl url;
     url.setScheme("coap");
     url.setHost(device->paramValue(hostParamTypeId).toString());
     url.setPath("/sensors/battery");
 
-    CoapReply *reply = m_coap->get(CoapRequest(url));
+    // The response of the registration contains the current value, the changes will be notified
+    CoapReply *reply = m_coap->enableResourceNotifications(CoapRequest(url));
 
     if (reply->isFinished()) {
         if (reply->error() != CoapReply::NoError) {
@@ -303,4 +313,18 @@ void DevicePluginOsdomotics::coapReplyFinished(CoapReply *reply)
     reply->deleteLater();
 }
 
+void DevicePluginOsdomotics::onNotificationReceived(const CoapObserveResource &resource, const int &notificationNumber, const QByteArray &payload)
+{
+    Device *device = findDevice(QHostAddress(resource.url().host()));
+    if (!device)
+        return;
+
+    qCDebug(dcOsdomotics) << "Node notification nr." << notificationNumber << resource.url().path() << payload;
+    if (resource.url().path() == "/sensors/battery")
+        device->setStateValue(batteryStateTypeId, payload.toInt());
+}
 
+void DevicePluginOsdomotics::onObservationLost(const CoapObserveResource &resource)
+{
+    qCWarning(dcOsdomotics) << "Lost connection to node" << resource.url().host();
+}
@@ -64,6 +64,8 @@ private:
 
 private slots:
     void coapReplyFinished(CoapReply *reply);
+    void onNotificationReceived(const CoapObserveResource &resource, const int &notificationNumber, const QByteArray &payload);
+    void onObservationLost(const CoapObserveResource &resource);
 
 };
 
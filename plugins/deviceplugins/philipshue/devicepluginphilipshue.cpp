@@ -50,6 +50,8 @@
 #include <QStringList>
 #include <QColor>
 #include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
 
 DevicePluginPhilipsHue::DevicePluginPhilipsHue()
 {
@@ -89,7 +91,7 @@ DeviceManager::DeviceSetupStatus DevicePluginPhilipsHue::setupDevice(Device *dev
                 device->setParamValue(bridgeZigbeeChannelParamTypeId, b->zigbeeChannel());
                 device->setParamValue(bridgeIdParamTypeId, b->id());
                 device->setParamValue(bridgeMacParamTypeId, b->macAddress());
-                m_bridges.insert(b, device);
+                addBridge(b, device);
                 device->setStateValue(bridgeReachableStateTypeId, true);
                 discoverBridgeDevices(b);
                 m_timer->start();
@@ -108,7 +110,8 @@ DeviceManager::DeviceSetupStatus DevicePluginPhilipsHue::setupDevice(Device *dev
         bridge->setMacAddress(device->paramValue(bridgeMacParamTypeId).toString());
         bridge->setZigbeeChannel(device->paramValue(bridgeZigbeeChannelParamTypeId).toInt());
 
-        m_bridges.insert(bridge, device);
+        addBridge(bridge, device);
+        refreshBridge(device);
         m_timer->start();
         return DeviceManager::DeviceSetupStatusSuccess;
     }
@@ -130,10 +133,10 @@ DeviceManager::DeviceSetupStatus DevicePluginPhilipsHue::setupDevice(Device *dev
 
         connect(hueLight, &HueLight::stateChanged, this, &DevicePluginPhilipsHue::lightStateChanged);
         m_lights.insert(hueLight, device);
+        m_bridgeLights[hueLight->bridgeId()].insert(hueLight->id(), hueLight);
 
         device->setName(hueLight->name());
 
-        refreshLight(device);
         setLightName(device, device->paramValue(nameParamTypeId).toString());
 
         return DeviceManager::DeviceSetupStatusSuccess;
@@ -159,7 +162,7 @@ DeviceManager::DeviceSetupStatus DevicePluginPhilipsHue::setupDevice(Device *dev
         device->setName(hueLight->name());
 
         m_lights.insert(hueLight, device);
-        refreshLight(device);
+        m_bridgeLights[hueLight->bridgeId()].insert(hueLight->id(), hueLight);
 
         setLightName(device, device->paramValue(nameParamTypeId).toString());
         return DeviceManager::DeviceSetupStatusSuccess;
@@ -186,6 +189,7 @@ DeviceManager::DeviceSetupStatus DevicePluginPhilipsHue::setupDevice(Device *dev
         connect(hueRemote, &HueRemote::buttonPressed, this, &DevicePluginPhilipsHue::onRemoteButtonEvent);
 
         m_remotes.insert(hueRemote, device);
+        m_bridgeRemotes[hueRemote->bridgeId()].insert(hueRemote->id(), hueRemote);
         return DeviceManager::DeviceSetupStatusSuccess;
     }
 
@@ -196,6 +200,21 @@ void DevicePluginPhilipsHue::deviceRemoved(Device *device)
 {
     if (device->deviceClassId() == hueBridgeDeviceClassId) {
         HueBridge *bridge = m_bridges.key(device);
+
+        // finish the actions which will never reach the bridge
+        HueCommandQueue *commandQueue = m_commandQueues.take(bridge);
+        foreach (const ActionId &actionId, commandQueue->clear()) {
+            emit actionExecutionFinished(actionId, DeviceManager::DeviceErrorHardwareNotAvailable);
+        }
+
+        foreach (QNetworkReply *reply, m_commandRequests.keys()) {
+            if (m_commandRequests.value(reply).first == bridge) {
+                foreach (const ActionId &actionId, m_commandRequests.take(reply).second.actionIds) {
+                    emit actionExecutionFinished(actionId, DeviceManager::DeviceErrorHardwareNotAvailable);
+                }
+            }
+        }
+
         m_bridges.remove(bridge);
         bridge->deleteLater();
     }
@@ -203,12 +222,14 @@ void DevicePluginPhilipsHue::deviceRemoved(Device *device)
     if (device->deviceClassId() == hueLightDeviceClassId || device->deviceClassId() == hueWhiteLightDeviceClassId) {
         HueLight *light = m_lights.key(device);
         m_lights.remove(light);
+        m_bridgeLights[light->bridgeId()].remove(light->id());
         light->deleteLater();
     }
 
     if (device->deviceClassId() == hueRemoteDeviceClassId) {
         HueRemote *remote = m_remotes.key(device);
         m_remotes.remove(remote);
+        m_bridgeRemotes[remote->bridgeId()].remove(remote->id());
         remote->deleteLater();
     }
 
@@ -359,45 +380,20 @@ void DevicePluginPhilipsHue::networkManagerReplyReady(QNetworkReply *reply)
         }
         processBridgeRefreshResponse(device, reply->readAll());
 
-    } else if (m_lightRefreshRequests.keys().contains(reply)) {
-        Device *device = m_lightRefreshRequests.take(reply);
+    } else if (m_commandRequests.contains(reply)) {
+        QPair<HueBridge *, HueCommand> commandInfo = m_commandRequests.take(reply);
 
         // check HTTP status code
         if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            qCWarning(dcPhilipsHue) << "Refresh Hue Light request error:" << status << reply->errorString();
-            bridgeReachableChanged(device, false);
-            reply->deleteLater();
-            return;
-        }
-        processLightRefreshResponse(device, reply->readAll());
-
-    } else if (m_lightsRefreshRequests.keys().contains(reply)) {
-        Device *device = m_lightsRefreshRequests.take(reply);
-
-        // check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (device->stateValue(bridgeReachableStateTypeId).toBool()) {
-                qCWarning(dcPhilipsHue) << "Refresh Hue lights request error:" << status << reply->errorString();
-                bridgeReachableChanged(device, false);
-            }
-            reply->deleteLater();
-            return;
-        }
-        processLightsRefreshResponse(device, reply->readAll());
-
-    } else if (m_sensorsRefreshRequests.keys().contains(reply)) {
-        Device *device = m_sensorsRefreshRequests.take(reply);
-
-        // check HTTP status code
-        if (status != 200 || reply->error() != QNetworkReply::NoError) {
-            if (device->stateValue(bridgeReachableStateTypeId).toBool()) {
-                qCWarning(dcPhilipsHue) << "Refresh Hue sensors request error:" << status << reply->errorString();
-                bridgeReachableChanged(device, false);
+            qCWarning(dcPhilipsHue) << "Execute Hue Light action request error:" << status << reply->errorString();
+            bridgeReachableChanged(m_bridges.value(commandInfo.first), false);
+            foreach (const ActionId &actionId, commandInfo.second.actionIds) {
+                emit actionExecutionFinished(actionId, DeviceManager::DeviceErrorHardwareNotAvailable);
             }
             reply->deleteLater();
             return;
         }
-        processSensorsRefreshResponse(device, reply->readAll());
+        processCommandResponse(commandInfo.first, commandInfo.second, reply->readAll());
 
     } else if (m_asyncActions.keys().contains(reply)) {
         QPair<Device *, ActionId> actionInfo = m_asyncActions.take(reply);
@@ -431,66 +427,42 @@ DeviceManager::DeviceError DevicePluginPhilipsHue::executeAction(Device *device,
 {
     qCDebug(dcPhilipsHue) << "Execute action" << action.actionTypeId() << action.params();
 
-    // color light
-    if (device->deviceClassId() == hueLightDeviceClassId) {
+    // lights, the state writes get merged and paced by the command queue of the bridge
+    if (device->deviceClassId() == hueLightDeviceClassId || device->deviceClassId() == hueWhiteLightDeviceClassId) {
         HueLight *light = m_lights.key(device);
 
         if (!light->reachable()) {
-            return DeviceManager::DeviceErrorHardwareNotAvailable;
             qCWarning(dcPhilipsHue) << "Light" << light->name() << "not reachable";
+            return DeviceManager::DeviceErrorHardwareNotAvailable;
         }
 
-        if (action.actionTypeId() == huePowerActionTypeId) {
-            QPair<QNetworkRequest, QByteArray> request = light->createSetPowerRequest(action.param(huePowerStateParamTypeId).value().toBool());
-            m_asyncActions.insert(networkManagerPut(request.first, request.second),QPair<Device *, ActionId>(device, action.id()));
-            return DeviceManager::DeviceErrorAsync;
-        } else if (action.actionTypeId() == hueColorActionTypeId) {
-            QPair<QNetworkRequest, QByteArray> request = light->createSetColorRequest(action.param(hueColorStateParamTypeId).value().value<QColor>());
-            m_asyncActions.insert(networkManagerPut(request.first, request.second),QPair<Device *, ActionId>(device, action.id()));
-            return DeviceManager::DeviceErrorAsync;
-        } else if (action.actionTypeId() == hueBrightnessActionTypeId) {
-            QPair<QNetworkRequest, QByteArray> request = light->createSetBrightnessRequest(percentageToBrightness(action.param(hueBrightnessStateParamTypeId).value().toInt()));
-            m_asyncActions.insert(networkManagerPut(request.first, request.second),QPair<Device *, ActionId>(device, action.id()));
-            return DeviceManager::DeviceErrorAsync;
-        } else if (action.actionTypeId() == hueEffectActionTypeId) {
-            QPair<QNetworkRequest, QByteArray> request = light->createSetEffectRequest(action.param(hueEffectStateParamTypeId).value().toString());
-            m_asyncActions.insert(networkManagerPut(request.first, request.second),QPair<Device *, ActionId>(device, action.id()));
-            return DeviceManager::DeviceErrorAsync;
-        } else if (action.actionTypeId() == hueAlertActionTypeId) {
-            QPair<QNetworkRequest, QByteArray> request = light->createFlashRequest(action.param(alertParamTypeId).value().toString());
-            m_asyncActions.insert(networkManagerPut(request.first, request.second),QPair<Device *, ActionId>(device, action.id()));
-            return DeviceManager::DeviceErrorAsync;
-        } else if (action.actionTypeId() == hueTemperatureActionTypeId) {
-            QPair<QNetworkRequest, QByteArray> request = light->createSetTemperatureRequest(action.param(hueTemperatureStateParamTypeId).value().toInt());
-            m_asyncActions.insert(networkManagerPut(request.first, request.second),QPair<Device *, ActionId>(device, action.id()));
-            return DeviceManager::DeviceErrorAsync;
-        }
-        return DeviceManager::DeviceErrorActionTypeNotFound;
-    }
-
-    // white light
-    if (device->deviceClassId() == hueWhiteLightDeviceClassId) {
-        HueLight *light = m_lights.key(device);
-
-        if (!light->reachable()) {
+        HueBridge *bridge = bridgeForLight(light);
+        if (!bridge) {
+            qCWarning(dcPhilipsHue) << "Could not find bridge of light" << light->name();
             return DeviceManager::DeviceErrorHardwareNotAvailable;
-            qCWarning(dcPhilipsHue) << "Light" << light->name() << "not reachable";
         }
 
+        bool colorLight = device->deviceClassId() == hueLightDeviceClassId;
+
+        QVariantMap state;
         if (action.actionTypeId() == huePowerActionTypeId) {
-            QPair<QNetworkRequest, QByteArray> request = light->createSetPowerRequest(action.param(huePowerStateParamTypeId).value().toBool());
-            m_asyncActions.insert(networkManagerPut(request.first, request.second),QPair<Device *, ActionId>(device, action.id()));
-            return DeviceManager::DeviceErrorAsync;
+            state = light->createSetPowerState(action.param(huePowerStateParamTypeId).value().toBool());
         } else if (action.actionTypeId() == hueBrightnessActionTypeId) {
-            QPair<QNetworkRequest, QByteArray> request = light->createSetBrightnessRequest(percentageToBrightness(action.param(hueBrightnessStateParamTypeId).value().toInt()));
-            m_asyncActions.insert(networkManagerPut(request.first, request.second),QPair<Device *, ActionId>(device, action.id()));
-            return DeviceManager::DeviceErrorAsync;
+            state = light->createSetBrightnessState(percentageToBrightness(action.param(hueBrightnessStateParamTypeId).value().toInt()));
         } else if (action.actionTypeId() == hueAlertActionTypeId) {
-            QPair<QNetworkRequest, QByteArray> request = light->createFlashRequest(action.param(alertParamTypeId).value().toString());
-            m_asyncActions.insert(networkManagerPut(request.first, request.second),QPair<Device *, ActionId>(device, action.id()));
-            return DeviceManager::DeviceErrorAsync;
+            state = light->createFlashState(action.param(alertParamTypeId).value().toString());
+        } else if (colorLight && action.actionTypeId() == hueColorActionTypeId) {
+            state = light->createSetColorState(action.param(hueColorStateParamTypeId).value().value<QColor>());
+        } else if (colorLight && action.actionTypeId() == hueEffectActionTypeId) {
+            state = light->createSetEffectState(action.param(hueEffectStateParamTypeId).value().toString());
+        } else if (colorLight && action.actionTypeId() == hueTemperatureActionTypeId) {
+            state = light->createSetTemperatureState(action.param(hueTemperatureStateParamTypeId).value().toInt());
+        } else {
+            return DeviceManager::DeviceErrorActionTypeNotFound;
         }
-        return DeviceManager::DeviceErrorActionTypeNotFound;
+
+        m_commandQueues.value(bridge)->enqueue(light->id(), state, action.id());
+        return DeviceManager::DeviceErrorAsync;
     }
 
     if (device->deviceClassId() == hueBridgeDeviceClassId) {
@@ -596,21 +568,21 @@ void DevicePluginPhilipsHue::onTimeout()
     }
 }
 
-void DevicePluginPhilipsHue::refreshLight(Device *device)
+void DevicePluginPhilipsHue::onCommandReady(const HueCommand &command)
 {
-    HueLight *light = m_lights.key(device);
+    HueCommandQueue *commandQueue = static_cast<HueCommandQueue *>(sender());
+    HueBridge *bridge = m_commandQueues.key(commandQueue);
 
-    QNetworkRequest request(QUrl("http://" + light->hostAddress().toString() + "/api/" + light->apiKey() + "/lights/" + QString::number(light->id())));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    QNetworkReply *reply = networkManagerGet(request);
-
-    m_lightRefreshRequests.insert(reply, device);
+    QByteArray body = QJsonDocument::fromVariant(command.state).toJson(QJsonDocument::Compact);
+    QNetworkReply *reply = networkManagerPut(commandQueue->createRequest(command), body);
+    m_commandRequests.insert(reply, QPair<HueBridge *, HueCommand>(bridge, command));
 }
 
 void DevicePluginPhilipsHue::refreshBridge(Device *device)
 {
-    if (!m_bridgeRefreshRequests.isEmpty()) {
-        QNetworkReply *reply = m_bridgeRefreshRequests.key(device);
+    // the previous snapshot of this bridge did not arrive within one poll interval
+    QNetworkReply *reply = m_bridgeRefreshRequests.key(device);
+    if (reply) {
         reply->abort();
         m_bridgeRefreshRequests.remove(reply);
         reply->deleteLater();
@@ -620,35 +592,14 @@ void DevicePluginPhilipsHue::refreshBridge(Device *device)
 
     HueBridge *bridge = m_bridges.key(device);
 
-    QNetworkRequest request(QUrl("http://" + bridge->hostAddress().toString() + "/api/" + bridge->apiKey() + "/config"));
+    // the full state contains config, lights, groups and sensors of the bridge in one response
+    QNetworkRequest request(QUrl("http://" + bridge->hostAddress().toString() + "/api/" + bridge->apiKey()));
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    QNetworkReply *reply = networkManagerGet(request);
+    reply = networkManagerGet(request);
 
     m_bridgeRefreshRequests.insert(reply, device);
 }
 
-void DevicePluginPhilipsHue::refreshLights(HueBridge *bridge)
-{
-    Device *device = m_bridges.value(bridge);
-
-    QNetworkRequest request(QUrl("http://" + bridge->hostAddress().toString() + "/api/" + bridge->apiKey() + "/lights"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    QNetworkReply *reply = networkManagerGet(request);
-
-    m_lightsRefreshRequests.insert(reply, device);
-}
-
-void DevicePluginPhilipsHue::refreshSensors(HueBridge *bridge)
-{
-    Device *device = m_bridges.value(bridge);
-
-    QNetworkRequest request(QUrl("http://" + bridge->hostAddress().toString() + "/api/" + bridge->apiKey() + "/sensors"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    QNetworkReply *reply = networkManagerGet(request);
-
-    m_sensorsRefreshRequests.insert(reply, device);
-}
-
 void DevicePluginPhilipsHue::discoverBridgeDevices(HueBridge *bridge)
 {
     Device *device = m_bridges.value(bridge);
@@ -849,56 +800,31 @@ void DevicePluginPhilipsHue::processBridgeSensorDiscoveryResponse(Device *device
 
 }
 
-void DevicePluginPhilipsHue::processLightRefreshResponse(Device *device, const QByteArray &data)
-{
-    QJsonParseError error;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
-
-    // check JSON error
-    if (error.error != QJsonParseError::NoError) {
-        qCWarning(dcPhilipsHue) << "Hue Bridge json error in response" << error.errorString();
-        return;
-    }
-
-    // check response error
-    if (data.contains("error")) {
-        if (!jsonDoc.toVariant().toList().isEmpty()) {
-            qCWarning(dcPhilipsHue) << "Failed to refresh Hue Light:" << jsonDoc.toVariant().toList().first().toMap().value("error").toMap().value("description").toString();
-        } else {
-            qCWarning(dcPhilipsHue) << "Failed to refresh Hue Light: Invalid error message format";
-        }
-        return;
-    }
-
-    HueLight *light = m_lights.key(device);
-    light->updateStates(jsonDoc.toVariant().toMap().value("state").toMap());
-}
-
 void DevicePluginPhilipsHue::processBridgeRefreshResponse(Device *device, const QByteArray &data)
 {
-    QJsonParseError error;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
+    HueSnapshot snapshot = HueSnapshot::fromJson(data);
 
     // check JSON error
-    if (error.error != QJsonParseError::NoError) {
-        qCWarning(dcPhilipsHue) << "Hue Bridge json error in response" << error.errorString();
+    if (snapshot.error() == HueSnapshot::ParseError) {
+        qCWarning(dcPhilipsHue) << "Hue Bridge json error in response" << snapshot.errorString();
         return;
     }
 
-    if (!jsonDoc.toVariant().toList().isEmpty()) {
-        qCWarning(dcPhilipsHue) << "Failed to refresh Hue Bridge:" << jsonDoc.toVariant().toList().first().toMap().value("error").toMap().value("description").toString();
+    // check response error
+    if (snapshot.error() == HueSnapshot::BridgeError) {
+        qCWarning(dcPhilipsHue) << "Failed to refresh Hue Bridge:" << snapshot.errorString();
         bridgeReachableChanged(device, false);
         return;
     }
 
-    QVariantMap configMap = jsonDoc.toVariant().toMap();
+    QJsonObject configObject = snapshot.config();
 
     // mark bridge as reachable
     bridgeReachableChanged(device, true);
-    device->setStateValue(apiVersionStateTypeId, configMap.value("apiversion").toString());
-    device->setStateValue(softwareVersionStateTypeId, configMap.value("swversion").toString());
+    device->setStateValue(apiVersionStateTypeId, configObject.value("apiversion").toString());
+    device->setStateValue(softwareVersionStateTypeId, configObject.value("swversion").toString());
 
-    int updateStatus = configMap.value("swupdate").toMap().value("updatestate").toInt();
+    int updateStatus = configObject.value("swupdate").toObject().value("updatestate").toInt();
     switch (updateStatus) {
     case 0:
         device->setStateValue(updateStatusStateTypeId, "Up to date");
@@ -916,75 +842,43 @@ void DevicePluginPhilipsHue::processBridgeRefreshResponse(Device *device, const
         break;
     }
 
-    // do lights/sensor update right after successfull bridge update
-    HueBridge *bridge = m_bridges.key(device);
-    refreshLights(bridge);
+    processLightsSnapshot(device, snapshot);
+    processSensorsSnapshot(device, snapshot);
+    m_commandQueues.value(m_bridges.key(device))->setGroups(snapshot.groups());
 }
 
-void DevicePluginPhilipsHue::processLightsRefreshResponse(Device *device, const QByteArray &data)
+void DevicePluginPhilipsHue::processLightsSnapshot(Device *device, const HueSnapshot &snapshot)
 {
-    QJsonParseError error;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
-
-    // check JSON error
-    if (error.error != QJsonParseError::NoError) {
-        qCWarning(dcPhilipsHue) << "Hue Bridge json error in response" << error.errorString();
-        return;
-    }
+    QHash<int, HueLight *> lights = m_bridgeLights.value(device->id());
+    QHash<int, QJsonObject> lightStates = snapshot.lightStates();
 
-    // check response error
-    if (data.contains("error")) {
-        if (!jsonDoc.toVariant().toList().isEmpty()) {
-            qCWarning(dcPhilipsHue) << "Failed to refresh Hue Lights:" << jsonDoc.toVariant().toList().first().toMap().value("error").toMap().value("description").toString();
-        } else {
-            qCWarning(dcPhilipsHue) << "Failed to refresh Hue Lights: Invalid error message format";
-        }
-        return;
-    }
+    // only lights with a changed state get updated
+    foreach (HueLight *light, lights) {
+        if (!lightStates.contains(light->id()))
+            continue;
 
-    // Update light states
-    QVariantMap lightsMap = jsonDoc.toVariant().toMap();
-    foreach (const QString &lightId, lightsMap.keys()) {
-        QVariantMap lightMap = lightsMap.value(lightId).toMap();
-        // get the light of this bridge
-        foreach (HueLight *light, m_lights.keys()) {
-            if (light->id() == lightId.toInt() && light->bridgeId() == device->id()) {
-                light->updateStates(lightMap.value("state").toMap());
-            }
-        }
+        QJsonObject stateObject = lightStates.value(light->id());
+        if (light->updateSnapshot(stateObject))
+            light->updateStates(stateObject.toVariantMap());
     }
 
-    if (!m_remotes.isEmpty())
-        refreshSensors(m_bridges.key(device));
+    m_commandQueues.value(m_bridges.key(device))->setLightIds(lightStates.keys());
 }
 
-void DevicePluginPhilipsHue::processSensorsRefreshResponse(Device *device, const QByteArray &data)
+void DevicePluginPhilipsHue::processSensorsSnapshot(Device *device, const HueSnapshot &snapshot)
 {
-    QJsonParseError error;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
-
-    // check JSON error
-    if (error.error != QJsonParseError::NoError) {
-        qCWarning(dcPhilipsHue) << "Hue Bridge json error in response" << error.errorString();
+    QHash<int, HueRemote *> remotes = m_bridgeRemotes.value(device->id());
+    if (remotes.isEmpty())
         return;
-    }
 
-    // check response error
-    if (!jsonDoc.toVariant().toList().isEmpty()) {
-        qCWarning(dcPhilipsHue) << "Failed to refresh Hue Sensors:" << jsonDoc.toVariant().toList().first().toMap().value("error").toMap().value("description").toString();
-        return;
-    }
+    QHash<int, QJsonObject> sensors = snapshot.sensors();
+    foreach (HueRemote *remote, remotes) {
+        QJsonObject sensorObject = sensors.value(remote->id());
+        if (sensorObject.isEmpty())
+            continue;
 
-    // Update sensor states
-    QVariantMap sensorsMap = jsonDoc.toVariant().toMap();
-    foreach (const QString &sensorId, sensorsMap.keys()) {
-        QVariantMap sensorMap = sensorsMap.value(sensorId).toMap();
-        foreach (HueRemote *remote, m_remotes.keys()) {
-            if (remote->id() == sensorId.toInt() && remote->bridgeId() == device->id()) {
-                //qCDebug(dcPhilipsHue) << "update remote" << remote->id() << remote->name();
-                remote->updateStates(sensorMap.value("state").toMap(), sensorMap.value("config").toMap());
-            }
-        }
+        if (remote->updateSnapshot(sensorObject))
+            remote->updateStates(sensorObject.value("state").toObject().toVariantMap(), sensorObject.value("config").toObject().toVariantMap());
     }
 }
 
@@ -1012,10 +906,6 @@ void DevicePluginPhilipsHue::processSetNameResponse(Device *device, const QByteA
     }
 
     //emit deviceSetupFinished(device, DeviceManager::DeviceSetupStatusSuccess);
-
-    if (device->deviceClassId() == hueLightDeviceClassId || device->deviceClassId() == hueWhiteLightDeviceClassId)
-        refreshLight(device);
-
 }
 
 void DevicePluginPhilipsHue::processPairingResponse(PairingInfo *pairingInfo, const QByteArray &data)
@@ -1111,6 +1001,8 @@ void DevicePluginPhilipsHue::processInformationResponse(PairingInfo *pairingInfo
 
 void DevicePluginPhilipsHue::processActionResponse(Device *device, const ActionId actionId, const QByteArray &data)
 {
+    Q_UNUSED(device)
+
     QJsonParseError error;
     QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
 
@@ -1132,12 +1024,50 @@ void DevicePluginPhilipsHue::processActionResponse(Device *device, const ActionI
         return;
     }
 
-    if (device->deviceClassId() != hueBridgeDeviceClassId)
-        m_lights.key(device)->processActionResponse(jsonDoc.toVariant().toList());
-
     emit actionExecutionFinished(actionId, DeviceManager::DeviceErrorNoError);
 }
 
+void DevicePluginPhilipsHue::processCommandResponse(HueBridge *bridge, const HueCommand &command, const QByteArray &data)
+{
+    QJsonParseError error;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
+
+    // check JSON error
+    if (error.error != QJsonParseError::NoError) {
+        qCWarning(dcPhilipsHue) << "Hue Bridge json error in response" << error.errorString();
+        foreach (const ActionId &actionId, command.actionIds) {
+            emit actionExecutionFinished(actionId, DeviceManager::DeviceErrorHardwareFailure);
+        }
+        return;
+    }
+
+    // check response error
+    if (data.contains("error")) {
+        qCWarning(dcPhilipsHue) << "Failed to execute Hue action:" << jsonDoc.toJson();
+        foreach (const ActionId &actionId, command.actionIds) {
+            emit actionExecutionFinished(actionId, DeviceManager::DeviceErrorHardwareFailure);
+        }
+        return;
+    }
+
+    // a group reports the changed group action, so apply the sent state to each light of the group
+    foreach (int lightId, command.lightIds) {
+        HueLight *light = findLight(bridge, lightId);
+        if (!light)
+            continue;
+
+        if (command.isGroupCommand()) {
+            light->applyStates(command.state);
+        } else {
+            light->processActionResponse(jsonDoc.toVariant().toList());
+        }
+    }
+
+    foreach (const ActionId &actionId, command.actionIds) {
+        emit actionExecutionFinished(actionId, DeviceManager::DeviceErrorNoError);
+    }
+}
+
 void DevicePluginPhilipsHue::bridgeReachableChanged(Device *device, const bool &reachable)
 {
     if (reachable) {
@@ -1147,18 +1077,17 @@ void DevicePluginPhilipsHue::bridgeReachableChanged(Device *device, const bool &
         if (device->deviceClassId() == hueBridgeDeviceClassId) {
             device->setStateValue(bridgeReachableStateTypeId, false);
 
-            foreach (HueLight *light, m_lights.keys()) {
-                if (light->bridgeId() == device->id()) {
-                    light->setReachable(false);
-                    m_lights.value(light)->setStateValue(hueReachableStateTypeId, false);
-                }
+            // the next snapshot has to update all states again
+            foreach (HueLight *light, m_bridgeLights.value(device->id())) {
+                light->setReachable(false);
+                light->clearSnapshot();
+                m_lights.value(light)->setStateValue(hueReachableStateTypeId, false);
             }
 
-            foreach (HueRemote *remote, m_remotes.keys()) {
-                if (remote->bridgeId() == device->id()) {
-                    remote->setReachable(false);
-                    m_remotes.value(remote)->setStateValue(hueReachableStateTypeId, false);
-                }
+            foreach (HueRemote *remote, m_bridgeRemotes.value(device->id())) {
+                remote->setReachable(false);
+                remote->clearSnapshot();
+                m_remotes.value(remote)->setStateValue(hueReachableStateTypeId, false);
             }
         }
     }
@@ -1201,6 +1130,34 @@ bool DevicePluginPhilipsHue::sensorAlreadyAdded(const QString &uuid)
     return false;
 }
 
+void DevicePluginPhilipsHue::addBridge(HueBridge *bridge, Device *device)
+{
+    m_bridges.insert(bridge, device);
+
+    HueCommandQueue *commandQueue = new HueCommandQueue(bridge);
+    connect(commandQueue, &HueCommandQueue::commandReady, this, &DevicePluginPhilipsHue::onCommandReady);
+    m_commandQueues.insert(bridge, commandQueue);
+}
+
+HueBridge *DevicePluginPhilipsHue::bridgeForLight(HueLight *light) const
+{
+    foreach (HueBridge *bridge, m_bridges.keys()) {
+        if (m_bridges.value(bridge)->id() == light->bridgeId()) {
+            return bridge;
+        }
+    }
+    return 0;
+}
+
+HueLight *DevicePluginPhilipsHue::findLight(HueBridge *bridge, int lightId) const
+{
+    Device *bridgeDevice = m_bridges.value(bridge);
+    if (!bridgeDevice)
+        return 0;
+
+    return m_bridgeLights.value(bridgeDevice->id()).value(lightId);
+}
+
 int DevicePluginPhilipsHue::brightnessToPercentage(int brightness)
 {
     return qRound((100.0 * brightness) / 255.0);
@@ -26,9 +26,12 @@
 #include "huebridge.h"
 #include "huelight.h"
 #include "hueremote.h"
+#include "huecommandqueue.h"
+#include "huesnapshot.h"
 #include "pairinginfo.h"
 
 class QNetworkReply;
+class QJsonObject;
 
 class DevicePluginPhilipsHue: public DevicePlugin
 {
@@ -60,6 +63,7 @@ private slots:
     void remoteStateChanged();
     void onRemoteButtonEvent(const int &buttonCode);
     void onTimeout();
+    void onCommandReady(const HueCommand &command);
 
 private:
     QTimer *m_timer;
@@ -71,26 +75,30 @@ private:
     QList<HueLight *> m_unconfiguredLights;
     QList<QNetworkReply *> m_discoveryRequests;
 
-    QHash<QNetworkReply *, Device *> m_lightRefreshRequests;
     QHash<QNetworkReply *, Device *> m_lightSetNameRequests;
     QHash<QNetworkReply *, Device *> m_bridgeRefreshRequests;
-    QHash<QNetworkReply *, Device *> m_lightsRefreshRequests;
-    QHash<QNetworkReply *, Device *> m_sensorsRefreshRequests;
     QHash<QNetworkReply *, Device *> m_bridgeLightsDiscoveryRequests;
     QHash<QNetworkReply *, Device *> m_bridgeSensorsDiscoveryRequests;
     QHash<QNetworkReply *, Device *> m_bridgeSearchDevicesRequests;
 
     QHash<QNetworkReply *, QPair<Device *, ActionId> > m_asyncActions;
+    QHash<QNetworkReply *, QPair<HueBridge *, HueCommand> > m_commandRequests;
 
     QHash<HueBridge *, Device *> m_bridges;
     QHash<HueLight *, Device *> m_lights;
     QHash<HueRemote *, Device *> m_remotes;
+    QHash<HueBridge *, HueCommandQueue *> m_commandQueues;
+
+    // bridge local ids of the lights and sensors for each bridge device
+    QHash<DeviceId, QHash<int, HueLight *> > m_bridgeLights;
+    QHash<DeviceId, QHash<int, HueRemote *> > m_bridgeRemotes;
+
+    void addBridge(HueBridge *bridge, Device *device);
+    HueBridge *bridgeForLight(HueLight *light) const;
+    HueLight *findLight(HueBridge *bridge, int lightId) const;
 
-    void refreshLight(Device *device);
     void refreshBridge(Device *device);
 
-    void refreshLights(HueBridge *bridge);
-    void refreshSensors(HueBridge *bridge);
 
     void discoverBridgeDevices(HueBridge *bridge);
     void searchNewDevices(HueBridge *bridge);
@@ -100,14 +108,14 @@ private:
     void processNUpnpResponse(const QByteArray &data);
     void processBridgeLightDiscoveryResponse(Device *device, const QByteArray &data);
     void processBridgeSensorDiscoveryResponse(Device *device, const QByteArray &data);
-    void processLightRefreshResponse(Device *device, const QByteArray &data);
     void processBridgeRefreshResponse(Device *device, const QByteArray &data);
-    void processLightsRefreshResponse(Device *device, const QByteArray &data);
-    void processSensorsRefreshResponse(Device *device, const QByteArray &data);
+    void processLightsSnapshot(Device *device, const HueSnapshot &snapshot);
+    void processSensorsSnapshot(Device *device, const HueSnapshot &snapshot);
     void processSetNameResponse(Device *device, const QByteArray &data);
     void processPairingResponse(PairingInfo *pairingInfo, const QByteArray &data);
     void processInformationResponse(PairingInfo *pairingInfo, const QByteArray &data);
     void processActionResponse(Device *device, const ActionId actionId, const QByteArray &data);
+    void processCommandResponse(HueBridge *bridge, const HueCommand &command, const QByteArray &data);
 
     void bridgeReachableChanged(Device *device, const bool &reachable);
 
@@ -0,0 +1,171 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "huecommandqueue.h"
+#include "extern-plugininfo.h"
+
+// A bridge handles about 10 light commands per second and one group command per second
+static const int lightCommandInterval = 100;
+static const int groupCommandInterval = 1000;
+
+HueCommand::HueCommand() :
+    groupId(-1)
+{
+}
+
+bool HueCommand::isGroupCommand() const
+{
+    return groupId >= 0;
+}
+
+HueCommandQueue::HueCommandQueue(HueBridge *bridge) :
+    QObject(bridge),
+    m_bridge(bridge)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &HueCommandQueue::dispatchNextCommand);
+}
+
+void HueCommandQueue::setLightIds(const QList<int> &lightIds)
+{
+    m_lightIds = lightIds.toSet();
+}
+
+void HueCommandQueue::setGroups(const QHash<int, QSet<int> > &groups)
+{
+    m_groups = groups;
+}
+
+void HueCommandQueue::enqueue(int lightId, const QVariantMap &state, const ActionId &actionId)
+{
+    // merge with the pending write of this light, the later value of a property wins
+    if (m_pendingCommands.contains(lightId)) {
+        HueCommand &command = m_pendingCommands[lightId];
+        foreach (const QString &key, state.keys()) {
+            command.state.insert(key, state.value(key));
+        }
+        command.actionIds.append(actionId);
+    } else {
+        HueCommand command;
+        command.lightIds.append(lightId);
+        command.state = state;
+        command.actionIds.append(actionId);
+        m_pendingCommands.insert(lightId, command);
+        m_pendingLights.append(lightId);
+    }
+
+    // give the actions of the same event loop iteration the chance to be merged
+    if (!m_timer->isActive())
+        m_timer->start(0);
+}
+
+QList<ActionId> HueCommandQueue::clear()
+{
+    QList<ActionId> actionIds;
+    foreach (const HueCommand &command, m_pendingCommands) {
+        actionIds.append(command.actionIds);
+    }
+
+    m_pendingCommands.clear();
+    m_pendingLights.clear();
+    m_timer->stop();
+    return actionIds;
+}
+
+int HueCommandQueue::pendingCount() const
+{
+    return m_pendingLights.count();
+}
+
+QNetworkRequest HueCommandQueue::createRequest(const HueCommand &command) const
+{
+    QString path;
+    if (command.isGroupCommand()) {
+        path = "/groups/" + QString::number(command.groupId) + "/action";
+    } else {
+        path = "/lights/" + QString::number(command.lightIds.first()) + "/state";
+    }
+
+    QNetworkRequest request(QUrl("http://" + m_bridge->hostAddress().toString() + "/api/" + m_bridge->apiKey() + path));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    return request;
+}
+
+HueCommand HueCommandQueue::takeNextCommand()
+{
+    HueCommand command = m_pendingCommands.take(m_pendingLights.takeFirst());
+
+    // collect all other lights waiting for exactly the same state
+    QList<int> sameStateLights;
+    foreach (int lightId, m_pendingLights) {
+        if (m_pendingCommands.value(lightId).state == command.state) {
+            sameStateLights.append(lightId);
+        }
+    }
+
+    if (sameStateLights.isEmpty())
+        return command;
+
+    QSet<int> groupLights = sameStateLights.toSet();
+    groupLights.insert(command.lightIds.first());
+
+    int groupId = findGroup(groupLights);
+    if (groupId < 0)
+        return command;
+
+    command.groupId = groupId;
+    foreach (int lightId, sameStateLights) {
+        m_pendingLights.removeAll(lightId);
+        HueCommand mergedCommand = m_pendingCommands.take(lightId);
+        command.lightIds.append(lightId);
+        command.actionIds.append(mergedCommand.actionIds);
+    }
+
+    qCDebug(dcPhilipsHue()) << "Send" << command.lightIds.count() << "light commands as group" << groupId << "command";
+    return command;
+}
+
+int HueCommandQueue::findGroup(const QSet<int> &lightIds) const
+{
+    // group 0 always contains all lights of the bridge
+    if (!m_lightIds.isEmpty() && lightIds == m_lightIds)
+        return 0;
+
+    foreach (int groupId, m_groups.keys()) {
+        if (m_groups.value(groupId) == lightIds) {
+            return groupId;
+        }
+    }
+
+    return -1;
+}
+
+void HueCommandQueue::dispatchNextCommand()
+{
+    if (m_pendingLights.isEmpty())
+        return;
+
+    HueCommand command = takeNextCommand();
+    emit commandReady(command);
+
+    // pace the next command according to the cost of this one
+    m_timer->start(command.isGroupCommand() ? groupCommandInterval : lightCommandInterval);
+}
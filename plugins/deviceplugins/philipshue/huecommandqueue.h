@@ -0,0 +1,84 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef HUECOMMANDQUEUE_H
+#define HUECOMMANDQUEUE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+#include <QVariantMap>
+#include <QNetworkRequest>
+
+#include "typeutils.h"
+#include "huebridge.h"
+
+// One state write sent to the bridge, either to a single light or to a group of lights
+class HueCommand
+{
+public:
+    HueCommand();
+
+    QList<int> lightIds;
+    int groupId;
+    QVariantMap state;
+    QList<ActionId> actionIds;
+
+    bool isGroupCommand() const;
+};
+
+class HueCommandQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HueCommandQueue(HueBridge *bridge);
+
+    void setLightIds(const QList<int> &lightIds);
+    void setGroups(const QHash<int, QSet<int> > &groups);
+
+    void enqueue(int lightId, const QVariantMap &state, const ActionId &actionId);
+    QList<ActionId> clear();
+
+    int pendingCount() const;
+
+    QNetworkRequest createRequest(const HueCommand &command) const;
+
+private:
+    HueBridge *m_bridge;
+    QTimer *m_timer;
+
+    QList<int> m_pendingLights;
+    QHash<int, HueCommand> m_pendingCommands;
+
+    QSet<int> m_lightIds;
+    QHash<int, QSet<int> > m_groups;
+
+    HueCommand takeNextCommand();
+    int findGroup(const QSet<int> &lightIds) const;
+
+signals:
+    void commandReady(const HueCommand &command);
+
+private slots:
+    void dispatchNextCommand();
+};
+
+#endif // HUECOMMANDQUEUE_H
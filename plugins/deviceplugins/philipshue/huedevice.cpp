@@ -126,3 +126,17 @@ void HueDevice::setReachable(const bool &reachable)
     m_reachable = reachable;
 }
 
+bool HueDevice::updateSnapshot(const QJsonObject &snapshot)
+{
+    // compare the raw JSON before converting it into state values
+    if (snapshot == m_snapshot)
+        return false;
+
+    m_snapshot = snapshot;
+    return true;
+}
+
+void HueDevice::clearSnapshot()
+{
+    m_snapshot = QJsonObject();
+}
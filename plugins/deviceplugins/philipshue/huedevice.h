@@ -26,6 +26,7 @@
 #include <QHostAddress>
 #include <QNetworkRequest>
 #include <QJsonDocument>
+#include <QJsonObject>
 
 #include "typeutils.h"
 
@@ -65,6 +66,9 @@ public:
     bool reachable() const;
     void setReachable(const bool &reachable);
 
+    bool updateSnapshot(const QJsonObject &snapshot);
+    void clearSnapshot();
+
 private:
     int m_id;
     QString m_name;
@@ -77,6 +81,7 @@ private:
     QString m_softwareVersion;
 
     bool m_reachable;
+    QJsonObject m_snapshot;
 };
 
 #endif // HUEDEVICE_H
@@ -157,85 +157,85 @@ void HueLight::updateStates(const QVariantMap &statesMap)
 
 void HueLight::processActionResponse(const QVariantList &responseList)
 {
+    QString statePrefix = "/lights/" + QString::number(id()) + "/state/";
+
+    QVariantMap states;
     foreach (const QVariant &resultVariant, responseList) {
-        QVariantMap result = resultVariant.toMap();
-        if (result.contains("success")) {
-            QVariantMap successMap = result.value("success").toMap();
-            if (successMap.contains("/lights/" + QString::number(id()) + "/state/on")) {
-                m_power = successMap.value("/lights/" + QString::number(id()) + "/state/on").toBool();
-            }
-            if (successMap.contains("/lights/" + QString::number(id()) + "/state/hue")) {
-                m_hue = successMap.value("/lights/" + QString::number(id()) + "/state/hue").toInt();
-                m_colorMode = ColorModeHS;
-            }
-            if (successMap.contains("/lights/" + QString::number(id()) + "/state/bri")) {
-                m_brightness = successMap.value("/lights/" + QString::number(id()) + "/state/bri").toInt();
-            }
-            if (successMap.contains("/lights/" + QString::number(id()) + "/state/sat")) {
-                m_sat = successMap.value("/lights/" + QString::number(id()) + "/state/sat").toInt();
-                m_colorMode = ColorModeHS;
-            }
-            if (successMap.contains("/lights/" + QString::number(id()) + "/state/xy")) {
-                m_xy = successMap.value("/lights/" + QString::number(id()) + "/state/xy").toPoint();
-                m_colorMode = ColorModeXY;
-            }
-            if (successMap.contains("/lights/" + QString::number(id()) + "/state/ct")) {
-                m_ct = successMap.value("/lights/" + QString::number(id()) + "/state/ct").toInt();
-                m_colorMode = ColorModeCT;
-            }
-            if (successMap.contains("/lights/" + QString::number(id()) + "/state/effect")) {
-                QString effect = successMap.value("/lights/" + QString::number(id()) + "/state/effect").toString();
-                if (effect == "none") {
-                    setEffect("none");
-                } else if (effect == "colorloop") {
-                    setEffect("color loop");
-                }
-            }
-            if (successMap.contains("/lights/" + QString::number(id()) + "/state/alert")) {
-                m_alert = successMap.value("/lights/" + QString::number(id()) + "/state/alert").toString();
+        QVariantMap successMap = resultVariant.toMap().value("success").toMap();
+        foreach (const QString &path, successMap.keys()) {
+            if (path.startsWith(statePrefix)) {
+                states.insert(path.mid(statePrefix.length()), successMap.value(path));
             }
+        }
+    }
+
+    applyStates(states);
+}
+
+void HueLight::applyStates(const QVariantMap &states)
+{
+    if (states.contains("on"))
+        m_power = states.value("on").toBool();
+
+    if (states.contains("hue")) {
+        m_hue = states.value("hue").toInt();
+        m_colorMode = ColorModeHS;
+    }
+
+    if (states.contains("bri"))
+        m_brightness = states.value("bri").toInt();
+
+    if (states.contains("sat")) {
+        m_sat = states.value("sat").toInt();
+        m_colorMode = ColorModeHS;
+    }
+
+    if (states.contains("xy") && states.value("xy").toList().count() == 2) {
+        m_xy = QPointF(states.value("xy").toList().first().toFloat(), states.value("xy").toList().last().toFloat());
+        m_colorMode = ColorModeXY;
+    }
 
+    if (states.contains("ct")) {
+        m_ct = states.value("ct").toInt();
+        m_colorMode = ColorModeCT;
+    }
+
+    if (states.contains("effect")) {
+        QString effect = states.value("effect").toString();
+        if (effect == "none") {
+            setEffect("none");
+        } else if (effect == "colorloop") {
+            setEffect("color loop");
         }
     }
+
+    if (states.contains("alert"))
+        m_alert = states.value("alert").toString();
+
     emit stateChanged();
 }
 
-QPair<QNetworkRequest, QByteArray> HueLight::createSetPowerRequest(const bool &power)
+QVariantMap HueLight::createSetPowerState(const bool &power)
 {
     qCDebug(dcPhilipsHue()) << "Create power request" << power;
-
     QVariantMap requestMap;
     requestMap.insert("on", power);
-
-    QJsonDocument jsonDoc = QJsonDocument::fromVariant(requestMap);
-
-    QNetworkRequest request(QUrl("http://" + hostAddress().toString() + "/api/" + apiKey() +
-                                 "/lights/" + QString::number(id()) + "/state"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    return QPair<QNetworkRequest, QByteArray>(request, jsonDoc.toJson());
+    return requestMap;
 }
 
-QPair<QNetworkRequest, QByteArray> HueLight::createSetColorRequest(const QColor &color)
+QVariantMap HueLight::createSetColorState(const QColor &color)
 {
     qCDebug(dcPhilipsHue()) << "Create color request" << color.toRgb();
-
     QVariantMap requestMap;
     requestMap.insert("hue", color.hue() * 65535 / 360);
     requestMap.insert("sat", color.saturation());
     requestMap.insert("on", true);
-
-    QJsonDocument jsonDoc = QJsonDocument::fromVariant(requestMap);
-
-    QNetworkRequest request(QUrl("http://" + hostAddress().toString() + "/api/" + apiKey() +
-                                 "/lights/" + QString::number(id()) + "/state"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    return QPair<QNetworkRequest, QByteArray>(request, jsonDoc.toJson());
+    return requestMap;
 }
 
-QPair<QNetworkRequest, QByteArray> HueLight::createSetBrightnessRequest(const int &brightness)
+QVariantMap HueLight::createSetBrightnessState(const int &brightness)
 {
     qCDebug(dcPhilipsHue()) << "Create brightness request" << brightness;
-
     QVariantMap requestMap;
     requestMap.insert("bri", brightness);
     if (brightness == 0) {
@@ -243,19 +243,12 @@ QPair<QNetworkRequest, QByteArray> HueLight::createSetBrightnessRequest(const in
     } else {
         requestMap.insert("on", true);
     }
-
-    QJsonDocument jsonDoc = QJsonDocument::fromVariant(requestMap);
-
-    QNetworkRequest request(QUrl("http://" + hostAddress().toString() + "/api/" + apiKey() +
-                                 "/lights/" + QString::number(id()) + "/state"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    return QPair<QNetworkRequest, QByteArray>(request, jsonDoc.toJson());
+    return requestMap;
 }
 
-QPair<QNetworkRequest, QByteArray> HueLight::createSetEffectRequest(const QString &effect)
+QVariantMap HueLight::createSetEffectState(const QString &effect)
 {
     qCDebug(dcPhilipsHue()) << "Create effect request" << effect;
-
     QVariantMap requestMap;
     if (effect == "none") {
         requestMap.insert("effect", "none");
@@ -263,44 +256,26 @@ QPair<QNetworkRequest, QByteArray> HueLight::createSetEffectRequest(const QStrin
         requestMap.insert("effect", "colorloop");
         requestMap.insert("on", true);
     }
-    QJsonDocument jsonDoc = QJsonDocument::fromVariant(requestMap);
-
-    QNetworkRequest request(QUrl("http://" + hostAddress().toString() + "/api/" + apiKey() +
-                                 "/lights/" + QString::number(id()) + "/state"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    return QPair<QNetworkRequest, QByteArray>(request, jsonDoc.toJson());
+    return requestMap;
 }
 
-QPair<QNetworkRequest, QByteArray> HueLight::createSetTemperatureRequest(const int &colorTemp)
+QVariantMap HueLight::createSetTemperatureState(const int &colorTemp)
 {
     qCDebug(dcPhilipsHue()) << "Create color temperature request" << colorTemp;
-
     QVariantMap requestMap;
     requestMap.insert("ct", colorTemp);
     requestMap.insert("on", true);
-
-    QJsonDocument jsonDoc = QJsonDocument::fromVariant(requestMap);
-
-    QNetworkRequest request(QUrl("http://" + hostAddress().toString() + "/api/" + apiKey() +
-                                 "/lights/" + QString::number(id()) + "/state"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    return QPair<QNetworkRequest, QByteArray>(request, jsonDoc.toJson());
+    return requestMap;
 }
 
-QPair<QNetworkRequest, QByteArray> HueLight::createFlashRequest(const QString &alert)
+QVariantMap HueLight::createFlashState(const QString &alert)
 {
     qCDebug(dcPhilipsHue()) << "Create flash request" << alert;
-
     QVariantMap requestMap;
     if (alert == "flash") {
         requestMap.insert("alert", "select");
     } else if (alert == "flash 15 [s]") {
         requestMap.insert("alert", "lselect");
     }
-    QJsonDocument jsonDoc = QJsonDocument::fromVariant(requestMap);
-
-    QNetworkRequest request(QUrl("http://" + hostAddress().toString() + "/api/" + apiKey() +
-                                 "/lights/" + QString::number(id()) + "/state"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    return QPair<QNetworkRequest, QByteArray>(request, jsonDoc.toJson());
+    return requestMap;
 }
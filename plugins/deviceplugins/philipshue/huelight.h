@@ -78,14 +78,15 @@ public:
     // update states
     void updateStates(const QVariantMap &statesMap);
     void processActionResponse(const QVariantList &responseList);
-
-    // create action requests
-    QPair<QNetworkRequest, QByteArray> createSetPowerRequest(const bool &power);
-    QPair<QNetworkRequest, QByteArray> createSetColorRequest(const QColor &color);
-    QPair<QNetworkRequest, QByteArray> createSetBrightnessRequest(const int &brightness);
-    QPair<QNetworkRequest, QByteArray> createSetEffectRequest(const QString &effect);
-    QPair<QNetworkRequest, QByteArray> createSetTemperatureRequest(const int &colorTemp);
-    QPair<QNetworkRequest, QByteArray> createFlashRequest(const QString &alert);
+    void applyStates(const QVariantMap &states);
+
+    // create action state bodies, sent by the HueCommandQueue of the bridge
+    QVariantMap createSetPowerState(const bool &power);
+    QVariantMap createSetColorState(const QColor &color);
+    QVariantMap createSetBrightnessState(const int &brightness);
+    QVariantMap createSetEffectState(const QString &effect);
+    QVariantMap createSetTemperatureState(const int &colorTemp);
+    QVariantMap createFlashState(const QString &alert);
 
 private:
     bool m_power;
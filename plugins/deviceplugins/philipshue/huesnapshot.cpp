@@ -0,0 +1,108 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "huesnapshot.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+
+HueSnapshot::HueSnapshot() :
+    m_error(NoError)
+{
+}
+
+HueSnapshot HueSnapshot::fromJson(const QByteArray &data)
+{
+    HueSnapshot snapshot;
+
+    QJsonParseError error;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
+    if (error.error != QJsonParseError::NoError) {
+        snapshot.m_error = ParseError;
+        snapshot.m_errorString = error.errorString();
+        return snapshot;
+    }
+
+    // the bridge reports errors as a list of error objects
+    if (jsonDoc.isArray()) {
+        snapshot.m_error = BridgeError;
+        if (!jsonDoc.array().isEmpty()) {
+            snapshot.m_errorString = jsonDoc.array().first().toObject().value("error").toObject().value("description").toString();
+        } else {
+            snapshot.m_errorString = "Invalid error message format";
+        }
+        return snapshot;
+    }
+
+    QJsonObject bridgeObject = jsonDoc.object();
+    snapshot.m_config = bridgeObject.value("config").toObject();
+
+    QJsonObject lightsObject = bridgeObject.value("lights").toObject();
+    for (QJsonObject::const_iterator it = lightsObject.constBegin(); it != lightsObject.constEnd(); ++it) {
+        snapshot.m_lightStates.insert(it.key().toInt(), it.value().toObject().value("state").toObject());
+    }
+
+    QJsonObject sensorsObject = bridgeObject.value("sensors").toObject();
+    for (QJsonObject::const_iterator it = sensorsObject.constBegin(); it != sensorsObject.constEnd(); ++it) {
+        snapshot.m_sensors.insert(it.key().toInt(), it.value().toObject());
+    }
+
+    // the light ids of a group are strings
+    QJsonObject groupsObject = bridgeObject.value("groups").toObject();
+    for (QJsonObject::const_iterator it = groupsObject.constBegin(); it != groupsObject.constEnd(); ++it) {
+        QSet<int> lightIds;
+        foreach (const QJsonValue &lightId, it.value().toObject().value("lights").toArray()) {
+            lightIds.insert(lightId.toString().toInt());
+        }
+        snapshot.m_groups.insert(it.key().toInt(), lightIds);
+    }
+
+    return snapshot;
+}
+
+HueSnapshot::Error HueSnapshot::error() const
+{
+    return m_error;
+}
+
+QString HueSnapshot::errorString() const
+{
+    return m_errorString;
+}
+
+QJsonObject HueSnapshot::config() const
+{
+    return m_config;
+}
+
+QHash<int, QJsonObject> HueSnapshot::lightStates() const
+{
+    return m_lightStates;
+}
+
+QHash<int, QJsonObject> HueSnapshot::sensors() const
+{
+    return m_sensors;
+}
+
+QHash<int, QSet<int> > HueSnapshot::groups() const
+{
+    return m_groups;
+}
@@ -0,0 +1,61 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef HUESNAPSHOT_H
+#define HUESNAPSHOT_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QJsonObject>
+
+// The full datastore of a bridge (GET /api/<key>), fetched once per poll
+class HueSnapshot
+{
+public:
+    enum Error {
+        NoError,
+        ParseError,
+        BridgeError
+    };
+
+    HueSnapshot();
+
+    static HueSnapshot fromJson(const QByteArray &data);
+
+    Error error() const;
+    QString errorString() const;
+
+    QJsonObject config() const;
+    QHash<int, QJsonObject> lightStates() const;
+    QHash<int, QJsonObject> sensors() const;
+    QHash<int, QSet<int> > groups() const;
+
+private:
+    Error m_error;
+    QString m_errorString;
+
+    QJsonObject m_config;
+    QHash<int, QJsonObject> m_lightStates;
+    QHash<int, QJsonObject> m_sensors;
+    QHash<int, QSet<int> > m_groups;
+};
+
+#endif // HUESNAPSHOT_H
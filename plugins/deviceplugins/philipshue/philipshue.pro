@@ -16,7 +16,9 @@ SOURCES += \
     huelight.cpp \
     pairinginfo.cpp \
     hueremote.cpp \
-    huedevice.cpp
+    huedevice.cpp \
+    huecommandqueue.cpp \
+    huesnapshot.cpp
 
 HEADERS += \
     devicepluginphilipshue.h \
@@ -27,7 +29,9 @@ HEADERS += \
     huelight.h \
     pairinginfo.h \
     hueremote.h \
-    huedevice.h
+    huedevice.h \
+    huecommandqueue.h \
+    huesnapshot.h
 
 
 
@@ -60,6 +60,12 @@ DeviceManager::HardwareResources DevicePluginUnitec::requiredHardware() const
     return DeviceManager::HardwareResourceRadio433;
 }
 
+Radio433CodeWord::Protocols DevicePluginUnitec::radio433Protocols() const
+{
+    // Only transmitting
+    return Radio433CodeWord::ProtocolNone;
+}
+
 DeviceManager::DeviceSetupStatus DevicePluginUnitec::setupDevice(Device *device)
 {
     if (device->deviceClassId() != switchDeviceClassId) {
@@ -34,6 +34,7 @@ public:
     explicit DevicePluginUnitec();
 
     DeviceManager::HardwareResources requiredHardware() const override;
+    Radio433CodeWord::Protocols radio433Protocols() const override;
     DeviceManager::DeviceSetupStatus setupDevice(Device *device) override;
 
 public slots:
@@ -183,11 +183,6 @@ void DevicePluginWemo::upnpDiscoveryFinished(const QList<UpnpDeviceDescriptor> &
     emit devicesDiscovered(wemoSwitchDeviceClassId, deviceDescriptors);
 }
 
-void DevicePluginWemo::upnpNotifyReceived(const QByteArray &notifyData)
-{
-    Q_UNUSED(notifyData);
-}
-
 
 void DevicePluginWemo::refresh(Device *device)
 {
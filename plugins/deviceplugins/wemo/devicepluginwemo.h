@@ -43,7 +43,6 @@ public:
 
     void guhTimer() override;
     void upnpDiscoveryFinished(const QList<UpnpDeviceDescriptor> &upnpDeviceDescriptorList) override;
-    void upnpNotifyReceived(const QByteArray &notifyData);
 
 private:
     QHash<QNetworkReply *, Device *> m_refreshReplies;
@@ -55,8 +55,8 @@ DevicePluginWs2812::DevicePluginWs2812()
 
 DeviceManager::HardwareResources DevicePluginWs2812::requiredHardware() const
 {
-    // We need the NetworkAccessManager for node discovery and the timer for ping requests
-    return DeviceManager::HardwareResourceNetworkManager | DeviceManager::HardwareResourceTimer;
+    // We need the NetworkAccessManager for node discovery, the reachability follows the CoAP notifications
+    return DeviceManager::HardwareResourceNetworkManager;
 }
 
 DeviceManager::DeviceSetupStatus DevicePluginWs2812::setupDevice(Device *device)
@@ -74,6 +74,7 @@ DeviceManager::DeviceSetupStatus DevicePluginWs2812::setupDevice(Device *device)
         m_coap = new Coap(this);
         connect(m_coap.data(), SIGNAL(replyFinished(CoapReply*)), this, SLOT(coapReplyFinished(CoapReply*)));
         connect(m_coap.data(), SIGNAL(notificationReceived(CoapObserveResource,int,QByteArray)), this, SLOT(onNotificationReceived(CoapObserveResource,int,QByteArray)));
+        connect(m_coap.data(), SIGNAL(observationLost(CoapObserveResource)), this, SLOT(onObservationLost(CoapObserveResource)));
     }
 
     return DeviceManager::DeviceSetupStatusSuccess;
@@ -81,11 +82,19 @@ DeviceManager::DeviceSetupStatus DevicePluginWs2812::setupDevice(Device *device)
 
 void DevicePluginWs2812::deviceRemoved(Device *device)
 {
-    Q_UNUSED(device)
-
     // Delete the CoAP socket if there are no devices left
     if (myDevices().isEmpty()) {
         m_coap->deleteLater();
+        return;
+    }
+
+    // Stop the notifications of the removed device
+    QUrl url;
+    url.setScheme("coap");
+    url.setHost(device->paramValue(hostParamTypeId).toString());
+    foreach (const QString &path, observedResources()) {
+        url.setPath(path);
+        m_coap->disableNotifications(CoapRequest(url));
     }
 }
 
@@ -149,18 +158,8 @@ void DevicePluginWs2812::networkManagerReplyReady(QNetworkReply *reply)
 
 void DevicePluginWs2812::postSetupDevice(Device *device)
 {
-    // Try to ping the device after a successful setup
-    pingDevice(device);
-}
-
-void DevicePluginWs2812::guhTimer()
-{
-    // Try to ping each device every 10 seconds to make sure it is still reachable
-    foreach (Device *device, myDevices()) {
-        if (device->deviceClassId() == ws2812DeviceClassId) {
-            pingDevice(device);
-        }
-    }
+    // The responses of the registrations deliver the current values and the reachability
+    enableNotifications(device);
 }
 
 DeviceManager::DeviceError DevicePluginWs2812::executeAction(Device *device, const Action &action)
@@ -380,106 +379,11 @@ DeviceManager::DeviceError DevicePluginWs2812::executeAction(Device *device, con
     return DeviceManager::DeviceErrorActionTypeNotFound;
 }
 
-void DevicePluginWs2812::pingDevice(Device *device)
-{
-    QUrl url;
-    url.setScheme("coap");
-    url.setHost(device->paramValue(hostParamTypeId).toString());
-    m_pingReplies.insert(m_coap->ping(CoapRequest(url)), device);
-}
-
-void DevicePluginWs2812::updateBattery(Device *device)
+QStringList DevicePluginWs2812::observedResources()
 {
-    qCDebug(dcWs2812) << "Update" << device->name() << "battery value";
-    QUrl url;
-    url.setScheme("coap");
-    url.setHost(device->paramValue(hostParamTypeId).toString());
-    url.setPath("/s/battery");
-    CoapReply *reply = m_coap->get(CoapRequest(url));
-    if (reply->isFinished() && reply->error() != CoapReply::NoError) {
-        qCWarning(dcWs2812) << "CoAP reply finished with error" << reply->errorString();
-        setReachable(device, false);
-        reply->deleteLater();
-        return;
-    }
-    m_updateReplies.insert(reply, device);
+    return QStringList() << "/s/battery" << "/p/maxpix" << "/a/color" << "/a/speed" << "/a/brightness" << "/a/effect" << "/a/tcolor";
 }
 
-
-
-void DevicePluginWs2812::updateColor(Device *device)
-{
-    qCDebug(dcWs2812) << "Update" << device->name() << "color value";
-    QUrl url;
-    url.setScheme("coap");
-    url.setHost(device->paramValue(hostParamTypeId).toString());
-    url.setPath("/a/color");
-    CoapReply *reply = m_coap->get(CoapRequest(url));
-    if (reply->isFinished() && reply->error() != CoapReply::NoError) {
-        qCWarning(dcWs2812) << "CoAP reply finished with error" << reply->errorString();
-        setReachable(device, false);
-        reply->deleteLater();
-        return;
-    }
-    m_updateReplies.insert(reply, device);
-}
-
-void DevicePluginWs2812::updateTricolore(Device *device)
-{
-    qCDebug(dcWs2812) << "Update" << device->name() << "tricolore value";
-    QUrl url;
-    url.setScheme("coap");
-    url.setHost(device->paramValue(hostParamTypeId).toString());
-    url.setPath("/a/tcolor");
-    CoapReply *reply = m_coap->get(CoapRequest(url));
-    if (reply->isFinished() && reply->error() != CoapReply::NoError) {
-        qCWarning(dcWs2812) << "CoAP reply finished with error" << reply->errorString();
-        setReachable(device, false);
-        reply->deleteLater();
-        return;
-    }
-    m_updateReplies.insert(reply, device);
-}
-
-
-
-void DevicePluginWs2812::updateEffect(Device *device)
-{
-    qCDebug(dcWs2812) << "Update" << device->name() << "effect mode";
-    QUrl url;
-    url.setScheme("coap");
-    url.setHost(device->paramValue(hostParamTypeId).toString());
-    url.setPath("/a/effect");
-    CoapReply *reply = m_coap->get(CoapRequest(url));
-    if (reply->isFinished() && reply->error() != CoapReply::NoError) {
-        qCWarning(dcWs2812) << "CoAP reply finished with error" << reply->errorString();
-        setReachable(device, false);
-        reply->deleteLater();
-        return;
-    }
-    m_updateReplies.insert(reply, device);
-}
-
-
-void DevicePluginWs2812::updateMaxPix(Device *device)
-{
-    qCDebug(dcWs2812) << "Update" << device->name() << "max pix";
-    QUrl url;
-    url.setScheme("coap");
-    url.setHost(device->paramValue(hostParamTypeId).toString());
-    url.setPath("/p/maxpix");
-    CoapReply *reply = m_coap->get(CoapRequest(url));
-    if (reply->isFinished() && reply->error() != CoapReply::NoError) {
-        qCWarning(dcWs2812) << "CoAP reply finished with error" << reply->errorString();
-        setReachable(device, false);
-        reply->deleteLater();
-        return;
-    }
-    m_updateReplies.insert(reply, device);
-}
-
-
-
 void DevicePluginWs2812::enableNotifications(Device *device)
 {
     qCDebug(dcWs2812) << "Enable" << device->name() << "notifications";
@@ -487,27 +391,11 @@ void DevicePluginWs2812::enableNotifications(Device *device)
     url.setScheme("coap");
     url.setHost(device->paramValue(hostParamTypeId).toString());
 
-
-    url.setPath("/s/battery");
-    m_enableNotification.insert(m_coap->enableResourceNotifications(CoapRequest(url)), device);
-
-    url.setPath("/p/maxpix");
-    m_enableNotification.insert(m_coap->enableResourceNotifications(CoapRequest(url)), device);
-
-    url.setPath("/a/color");
-    m_enableNotification.insert(m_coap->enableResourceNotifications(CoapRequest(url)), device);
-
-    url.setPath("/a/speed");
-    m_enableNotification.insert(m_coap->enableResourceNotifications(CoapRequest(url)), device);
-
-    url.setPath("/a/brightness");
-    m_enableNotification.insert(m_coap->enableResourceNotifications(CoapRequest(url)), device);
-
-    url.setPath("/a/effect");
-    m_enableNotification.insert(m_coap->enableResourceNotifications(CoapRequest(url)), device);
-
-    url.setPath("/a/tcolor");
-    m_enableNotification.insert(m_coap->enableResourceNotifications(CoapRequest(url)), device);
+    // Coap registers the observations again once they are older than their max age
+    foreach (const QString &path, observedResources()) {
+        url.setPath(path);
+        m_enableNotification.insert(m_coap->enableResourceNotifications(CoapRequest(url)), device);
+    }
 }
 
 void DevicePluginWs2812::setReachable(Device *device, const bool &reachable)
@@ -518,16 +406,6 @@ void DevicePluginWs2812::setReachable(Device *device, const bool &reachable)
             qCWarning(dcWs2812()) << device->name() << "reachable changed" << reachable;
         } else {
             qCDebug(dcWs2812()) << device->name() << "reachable changed" << reachable;
-
-            // Get current state values after a reconnect
-            updateBattery(device);
-            updateColor(device);
-            updateEffect(device);
-            updateMaxPix(device);
-            updateTricolore(device);
-
-            // Make sure the notifications are enabled
-            enableNotifications(device);
         }
     }
 
@@ -558,100 +436,7 @@ Device *DevicePluginWs2812::findDevice(const QHostAddress &address)
 
 void DevicePluginWs2812::coapReplyFinished(CoapReply *reply)
 {
-    if (m_pingReplies.contains(reply)) {
-        Device *device = m_pingReplies.take(reply);
-
-        // Check CoAP reply error
-        if (reply->error() != CoapReply::NoError) {
-            if (device->stateValue(reachableStateTypeId).toBool())
-                qCWarning(dcWs2812) << "Ping device" << reply->request().url().toString() << "reply finished with error" << reply->errorString();
-
-            setReachable(device, false);
-            reply->deleteLater();
-            return;
-        }
-        setReachable(device, true);
-
-    } else if (m_updateReplies.contains(reply)) {
-        Device *device = m_updateReplies.take(reply);
-        QString urlPath = reply->request().url().path();
-
-        // Check CoAP reply error
-        if (reply->error() != CoapReply::NoError) {
-            qCWarning(dcWs2812) << "Update resource" << urlPath << "reply finished with error" << reply->errorString();
-            setReachable(device, false);
-            reply->deleteLater();
-            return;
-        }
-
-        // Check CoAP status code
-        if (reply->statusCode() != CoapPdu::Content) {
-            qCWarning(dcWs2812) << "Update resource" << urlPath << "status code error:" << reply;
-            reply->deleteLater();
-            return;
-        }
-
-        // Update corresponding device state
-        if (urlPath == "/s/battery") {
-            qCDebug(dcWs2812()) << "Updated battery value:" << reply->payload();
-            device->setStateValue(batteryStateTypeId, reply->payload().toDouble());
-        } else if (urlPath == "/a/color") {
-            qCDebug(dcWs2812()) << "Updated color value:" << reply->payload();
-            device->setStateValue(effectColorStateTypeId, QVariant::fromValue(reply->payload()));
-        } else if (urlPath == "/a/effect") {
-
-            qCDebug(dcWs2812()) << "Updated effect value:" << reply->payload();
-            int effectmode  =  reply->payload().toInt();
-            QString effectModeString;
-
-            switch (effectmode) {
-               case 0:
-                    effectModeString == "Off";
-                    break;
-                case 1:
-                     effectModeString == "Color On";
-                     break;
-                case 2:
-                     effectModeString == "Color Wave";
-                     break;
-                case 3:
-                     effectModeString == "Color Fade";
-                     break;
-                case 4:
-                     effectModeString == "Color Flash";
-                     break;
-                case 5:
-                     effectModeString == "Rainbow Wave";
-                     break;
-                case 6:
-                     effectModeString == "Rainbow Flash";
-                     break;
-                case 7:
-                     effectModeString == "Knight Rider";
-                     break;
-                case 8:
-                     effectModeString == "Fire";
-                     break;
-                case 9:
-                     effectModeString == "Tricolore";
-                     break;
-                default:
-                    effectModeString == "Off";
-            }
-            device->setStateValue(effectModeStateTypeId, effectModeString);
-        }else if (urlPath == "/a/brightness") {
-            qCDebug(dcWs2812()) << "Updated brightness value:" << reply->payload().toInt();
-            device->setStateValue(brightnessStateTypeId, reply->payload().toInt());
-        }else if (urlPath == "/a/speed") {
-            qCDebug(dcWs2812()) << "Updated speed value:" << reply->payload().toInt();
-            device->setStateValue(speedStateTypeId, reply->payload().toInt());
-        }else if (urlPath == "/p/maxpix") {
-            qCDebug(dcWs2812()) << "Updated max pix value:" << reply->payload().toInt();
-            device->setStateValue(maxPixStateTypeId, reply->payload().toInt());
-        }
-
-
-    } else if (m_setEffect.contains(reply)) {
+    if (m_setEffect.contains(reply)) {
         Action action = m_setEffect.take(reply);
         Device *device = m_asyncActions.take(action.id());
 
@@ -827,6 +612,10 @@ void DevicePluginWs2812::coapReplyFinished(CoapReply *reply)
         }
 
         qCDebug(dcWs2812()) << "Enabled successfully notifications for" << device->name() << reply->request().url().path();
+
+        // The response of the registration contains the current value
+        setReachable(device, true);
+        updateResourceState(device, reply->request().url().path(), reply->payload());
     }
 
     // Delete the CoAP reply
@@ -834,6 +623,62 @@ void DevicePluginWs2812::coapReplyFinished(CoapReply *reply)
 }
 
 
+void DevicePluginWs2812::updateResourceState(Device *device, const QString &urlPath, const QByteArray &payload)
+{
+    // Update the corresponding device state
+    if (urlPath == "/s/battery") {
+        qCDebug(dcWs2812()) << "Updated battery value:" << payload;
+        device->setStateValue(batteryStateTypeId, payload.toDouble());
+    } else if (urlPath == "/a/color") {
+        qCDebug(dcWs2812()) << "Updated color value:" << payload;
+        device->setStateValue(effectColorStateTypeId, QVariant::fromValue(payload));
+    } else if (urlPath == "/a/effect") {
+        qCDebug(dcWs2812()) << "Updated effect value:" << payload;
+        QString effectModeString;
+        switch (payload.toInt()) {
+        case 1:
+            effectModeString = "Color On";
+            break;
+        case 2:
+            effectModeString = "Color Wave";
+            break;
+        case 3:
+            effectModeString = "Color Fade";
+            break;
+        case 4:
+            effectModeString = "Color Flash";
+            break;
+        case 5:
+            effectModeString = "Rainbow Wave";
+            break;
+        case 6:
+            effectModeString = "Rainbow Flash";
+            break;
+        case 7:
+            effectModeString = "Knight Rider";
+            break;
+        case 8:
+            effectModeString = "Fire";
+            break;
+        case 9:
+            effectModeString = "Tricolore";
+            break;
+        default:
+            effectModeString = "Off";
+        }
+        device->setStateValue(effectModeStateTypeId, effectModeString);
+    } else if (urlPath == "/a/brightness") {
+        qCDebug(dcWs2812()) << "Updated brightness value:" << payload.toInt();
+        device->setStateValue(brightnessStateTypeId, payload.toInt());
+    } else if (urlPath == "/a/speed") {
+        qCDebug(dcWs2812()) << "Updated speed value:" << payload.toInt();
+        device->setStateValue(speedStateTypeId, payload.toInt());
+    } else if (urlPath == "/p/maxpix") {
+        qCDebug(dcWs2812()) << "Updated max pix value:" << payload.toInt();
+        device->setStateValue(maxPixStateTypeId, payload.toInt());
+    }
+}
+
 void DevicePluginWs2812::onNotificationReceived(const CoapObserveResource &resource, const int &notificationNumber, const QByteArray &payload)
 {
     qCDebug(dcWs2812) << " --> Got notification nr." << notificationNumber << resource.url().toString() << payload;
@@ -843,57 +688,16 @@ void DevicePluginWs2812::onNotificationReceived(const CoapObserveResource &resou
         return;
     }
 
-    // Update the corresponding device state
-    if (resource.url().path() == "/s/battery") {
-        device->setStateValue(batteryStateTypeId, payload.toDouble());
-    }else if (resource.url().path() == "/a/color") {
-        device->setStateValue(effectColorStateTypeId, QVariant::fromValue(payload));
-    }else if (resource.url().path() == "/a/effect") {
-        int effectmode  =  payload.toInt();
-        QString effectModeString;
-
-        switch (effectmode) {
-           case 0:
-                effectModeString == "Off";
-                break;
-            case 1:
-                 effectModeString == "Color On";
-                 break;
-            case 2:
-                 effectModeString == "Color Wave";
-                 break;
-            case 3:
-                 effectModeString == "Color Fade";
-                 break;
-            case 4:
-                 effectModeString == "Color Flash";
-                 break;
-            case 5:
-                 effectModeString == "Rainbow Wave";
-                 break;
-            case 6:
-                 effectModeString == "Rainbow Flash";
-                 break;
-            case 7:
-                 effectModeString == "Knight Rider";
-                 break;
-            case 8:
-                 effectModeString == "Fire";
-                 break;
-            case 9:
-                 effectModeString == "Tricolore";
-                 break;
-            default:
-                effectModeString == "Off";
-        }
+    // Every notification proves that the device is still reachable
+    setReachable(device, true);
+    updateResourceState(device, resource.url().path(), payload);
+}
 
+void DevicePluginWs2812::onObservationLost(const CoapObserveResource &resource)
+{
+    Device *device = findDevice(QHostAddress(resource.url().host()));
+    if (!device)
+        return;
 
-        device->setStateValue(effectModeStateTypeId, effectModeString);
-    }else if (resource.url().path() == "/a/brightness") {
-        device->setStateValue(effectColorStateTypeId, payload.toInt());
-    }else if (resource.url().path() == "/a/speed") {
-        device->setStateValue(effectColorStateTypeId, payload.toInt());
-    }else if (resource.url().path() == "/p/maxpix") {
-        device->setStateValue(maxPixStateTypeId, payload.toInt());
-    }
+    setReachable(device, false);
 }
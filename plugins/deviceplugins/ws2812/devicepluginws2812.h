@@ -46,7 +46,6 @@ public:
 
     void postSetupDevice(Device *device) override;
 
-    void guhTimer() override;
     DeviceManager::DeviceError executeAction(Device *device, const Action &action) override;
 
 private:
@@ -54,10 +53,6 @@ private:
     QPointer<Coap> m_coap;
     QHash<QNetworkReply *, DeviceClassId> m_asyncNodeScans;
     QHash<CoapReply *, Device *> m_enableNotification;
-    QHash<CoapReply *, Device *> m_pingReplies;
-
-    // State updates
-    QHash<CoapReply *, Device *> m_updateReplies;
 
     // Actions
     QHash<ActionId, Device *> m_asyncActions;
@@ -69,15 +64,9 @@ private:
     QHash<CoapReply *, Action> m_setSpeed;
     QHash<CoapReply *, Action> m_setTColor;
 
-    void pingDevice(Device *device);
-
-    void updateBattery(Device *device);
-    void updateColor(Device *device);
-    void updateEffect(Device *device);
-    void updateMaxPix(Device *device);
-    void updateTricolore(Device *device);
-
+    static QStringList observedResources();
     void enableNotifications(Device *device);
+    void updateResourceState(Device *device, const QString &urlPath, const QByteArray &payload);
 
     void setReachable(Device *device, const bool &reachable);
 
@@ -91,6 +80,7 @@ private:
 private slots:
     void coapReplyFinished(CoapReply *reply);
     void onNotificationReceived(const CoapObserveResource &resource, const int &notificationNumber, const QByteArray &payload);
+    void onObservationLost(const CoapObserveResource &resource);
 };
 
 #endif // DEVICEPLUGINWS2812_H
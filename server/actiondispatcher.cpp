@@ -0,0 +1,357 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class guhserver::ActionDispatcher
+    \brief Serializes the execution of \l{Action}{Actions} per \l{Device}.
+
+    \ingroup core
+    \inmodule core
+
+    Every \l{Action} of the API and of the \l{RuleEngine} gets executed through the ActionDispatcher.
+    A device executes only one action at a time, further actions for the same device wait in the
+    queue of the device until the running (asynchronous) action finished. Each plugin executes at most
+    \l{maximumPluginActions()} actions at the same time.
+
+    A queued action which sets the value of a writable \l{StateType} gets replaced by a newer action setting
+    the same state, because only the last written value matters. Any other param of the actions has to be
+    equal. Other actions never get replaced, since each of them may have an effect of its own. The
+    superseded actions finish with the result of the action which replaced them. If the queue of a
+    device is full, new actions get rejected with
+    \l{DeviceManager::DeviceErrorHardwareNotAvailable}{DeviceErrorHardwareNotAvailable}. An asynchronous
+    action which did not finish within \l{actionTimeout()} milliseconds finishes with
+    \l{DeviceManager::DeviceErrorHardwareFailure}{DeviceErrorHardwareFailure}.
+
+    The queue depth and the latency from dispatching an action until it finished can be read for each
+    device with \l{statistics()}.
+
+    \sa GuhCore::executeAction()
+*/
+
+/*! \fn void guhserver::ActionDispatcher::actionExecuted(const Action &action, DeviceManager::DeviceError status);
+    This signal is emitted when an \a action finished with the given \a status, which was not
+    finished already when it was dispatched.
+
+    \sa dispatch()
+*/
+
+#include "actiondispatcher.h"
+#include "loggingcategories.h"
+#include "guhsettings.h"
+#include "plugin/device.h"
+
+namespace guhserver {
+
+/*! Constructs a new ActionDispatcher executing the actions with the given \a deviceManager and \a parent. */
+ActionDispatcher::ActionDispatcher(DeviceManager *deviceManager, QObject *parent) :
+    QObject(parent),
+    m_deviceManager(deviceManager),
+    m_processing(false),
+    m_startingActionFinished(false),
+    m_startingActionStatus(DeviceManager::DeviceErrorNoError)
+{
+    GuhSettings settings(GuhSettings::SettingsRoleGlobal);
+    settings.beginGroup("Actions");
+    m_maximumPluginActions = qMax(1, settings.value("maxPluginActions", 4).toInt());
+    m_maximumQueueDepth = qMax(1, settings.value("maxQueueDepth", 16).toInt());
+    m_actionTimeout = settings.value("timeout", 30000).toInt();
+    settings.endGroup();
+
+    m_durationMetric = Metrics::histogram("guh_action_duration_microseconds", "Time from dispatching an action until it finished.", Metrics::durationBounds());
+    m_timeoutMetric = Metrics::counter("guh_action_timeouts_total", "Actions which did not finish within the action timeout.");
+
+    m_timeoutTimer = new QTimer(this);
+    m_timeoutTimer->setInterval(1000);
+    connect(m_timeoutTimer, &QTimer::timeout, this, &ActionDispatcher::onTimeout);
+
+    connect(m_deviceManager, &DeviceManager::actionExecutionFinished, this, &ActionDispatcher::onActionExecutionFinished);
+    connect(m_deviceManager, &DeviceManager::deviceRemoved, this, &ActionDispatcher::onDeviceRemoved);
+}
+
+/*! Dispatches the given \a action. If the device and its plugin are idle, the action will be executed
+ *  immediately and the result of \l{DeviceManager::executeAction()} will be returned. Otherwise the action
+ *  gets queued and \l{DeviceManager::DeviceErrorAsync}{DeviceErrorAsync} will be returned; the
+ *  \l{actionExecuted()} signal tells the result once the action finished. */
+DeviceManager::DeviceError ActionDispatcher::dispatch(const Action &action)
+{
+    Device *device = m_deviceManager->findConfiguredDevice(action.deviceId());
+    if (!device)
+        return DeviceManager::DeviceErrorDeviceNotFound;
+
+    PendingAction pendingAction;
+    pendingAction.action = action;
+    pendingAction.pluginId = device->pluginId();
+    pendingAction.latency.start();
+    pendingAction.startTime = 0;
+
+    QList<PendingAction> &queue = m_queues[action.deviceId()];
+    Statistics &statistics = m_statistics[action.deviceId()];
+
+    // a newer value of a writable state replaces the queued one
+    if (setsStateValue(device, action)) {
+        for (int i = 0; i < queue.count(); i++) {
+            if (!hasSameTarget(queue.at(i).action, action))
+                continue;
+
+            pendingAction.supersededActions = queue.at(i).supersededActions;
+            pendingAction.supersededActions.append(queue.at(i).action);
+            queue[i] = pendingAction;
+            statistics.superseded++;
+            qCDebug(dcDeviceManager) << "Action" << queue.at(i).action.id().toString() << "superseded" << pendingAction.supersededActions.count() << "queued actions of" << device->name();
+            return DeviceManager::DeviceErrorAsync;
+        }
+    }
+
+    if (queue.isEmpty() && !m_runningActions.contains(action.deviceId()) && m_pluginActions.value(pendingAction.pluginId) < m_maximumPluginActions) {
+        DeviceManager::DeviceError status = startAction(pendingAction);
+        if (status != DeviceManager::DeviceErrorAsync)
+            finishAction(action.deviceId(), status, false);
+
+        return status;
+    }
+
+    if (queue.count() >= m_maximumQueueDepth) {
+        qCWarning(dcDeviceManager) << "Action queue of" << device->name() << "is full. Rejecting action.";
+        statistics.rejected++;
+        return DeviceManager::DeviceErrorHardwareNotAvailable;
+    }
+
+    queue.append(pendingAction);
+    statistics.queueDepth = queue.count();
+    statistics.maximumQueueDepth = qMax(statistics.maximumQueueDepth, statistics.queueDepth);
+    return DeviceManager::DeviceErrorAsync;
+}
+
+/*! Returns the maximum number of actions a plugin executes at the same time. */
+int ActionDispatcher::maximumPluginActions() const
+{
+    return m_maximumPluginActions;
+}
+
+/*! Sets the maximum number of actions a plugin executes at the same time to \a maximumPluginActions. */
+void ActionDispatcher::setMaximumPluginActions(const int &maximumPluginActions)
+{
+    m_maximumPluginActions = qMax(1, maximumPluginActions);
+    processQueues();
+}
+
+/*! Returns the maximum number of queued actions of a device. */
+int ActionDispatcher::maximumQueueDepth() const
+{
+    return m_maximumQueueDepth;
+}
+
+/*! Sets the maximum number of queued actions of a device to \a maximumQueueDepth. */
+void ActionDispatcher::setMaximumQueueDepth(const int &maximumQueueDepth)
+{
+    m_maximumQueueDepth = qMax(1, maximumQueueDepth);
+}
+
+/*! Returns the timeout [ms] of asynchronous actions. */
+int ActionDispatcher::actionTimeout() const
+{
+    return m_actionTimeout;
+}
+
+/*! Sets the timeout of asynchronous actions to \a actionTimeout milliseconds. A value of 0 disables the timeout. */
+void ActionDispatcher::setActionTimeout(const int &actionTimeout)
+{
+    m_actionTimeout = actionTimeout;
+}
+
+/*! Returns the number of queued actions of the device with the given \a deviceId. */
+int ActionDispatcher::queueDepth(const DeviceId &deviceId) const
+{
+    return m_queues.value(deviceId).count();
+}
+
+/*! Returns the action statistics of the device with the given \a deviceId. */
+ActionDispatcher::Statistics ActionDispatcher::statistics(const DeviceId &deviceId) const
+{
+    return m_statistics.value(deviceId);
+}
+
+bool ActionDispatcher::setsStateValue(Device *device, const Action &action) const
+{
+    // the ActionType of a writable StateType has the id of the StateType and one param with the same id
+    if (action.params().isEmpty())
+        return false;
+
+    DeviceClass deviceClass = m_deviceManager->findDeviceClass(device->deviceClassId());
+    return deviceClass.hasStateType(StateTypeId(action.actionTypeId().toString()));
+}
+
+bool ActionDispatcher::hasSameTarget(const Action &queuedAction, const Action &action) const
+{
+    if (queuedAction.actionTypeId() != action.actionTypeId() || queuedAction.params().count() != action.params().count())
+        return false;
+
+    // all params except the state value have to match
+    foreach (const Param &param, action.params()) {
+        if (!queuedAction.params().hasParam(param.paramTypeId()))
+            return false;
+
+        if (param.paramTypeId().toString() == action.actionTypeId().toString())
+            continue;
+
+        if (queuedAction.param(param.paramTypeId()).value() != param.value())
+            return false;
+    }
+    return true;
+}
+
+DeviceManager::DeviceError ActionDispatcher::startAction(const PendingAction &pendingAction)
+{
+    DeviceId deviceId = pendingAction.action.deviceId();
+
+    m_runningActions.insert(deviceId, pendingAction);
+    m_runningActions[deviceId].startTime = pendingAction.latency.elapsed();
+    m_runningActionDevices.insert(pendingAction.action.id(), deviceId);
+    m_pluginActions[pendingAction.pluginId]++;
+
+    // the plugin could finish an asynchronous action before returning, take that as synchronous result.
+    // The plugin may dispatch further actions meanwhile, so the outer starting action gets restored.
+    ActionId previousActionId = m_startingActionId;
+    bool previousActionFinished = m_startingActionFinished;
+    DeviceManager::DeviceError previousActionStatus = m_startingActionStatus;
+
+    m_startingActionId = pendingAction.action.id();
+    m_startingActionFinished = false;
+    DeviceManager::DeviceError status = m_deviceManager->executeAction(pendingAction.action);
+    bool finished = m_startingActionFinished;
+    DeviceManager::DeviceError finishedStatus = m_startingActionStatus;
+
+    m_startingActionId = previousActionId;
+    m_startingActionFinished = previousActionFinished;
+    m_startingActionStatus = previousActionStatus;
+
+    if (status == DeviceManager::DeviceErrorAsync && finished)
+        return finishedStatus;
+
+    if (status == DeviceManager::DeviceErrorAsync && m_actionTimeout > 0 && !m_timeoutTimer->isActive())
+        m_timeoutTimer->start();
+
+    return status;
+}
+
+void ActionDispatcher::finishAction(const DeviceId &deviceId, const DeviceManager::DeviceError &status, const bool &notify)
+{
+    if (!m_runningActions.contains(deviceId))
+        return;
+
+    PendingAction pendingAction = m_runningActions.take(deviceId);
+    m_runningActionDevices.remove(pendingAction.action.id());
+    m_pluginActions[pendingAction.pluginId]--;
+
+    qint64 latency = pendingAction.latency.elapsed();
+    Statistics &statistics = m_statistics[deviceId];
+    statistics.executed++;
+    statistics.totalLatency += latency;
+    statistics.maximumLatency = qMax(statistics.maximumLatency, latency);
+    m_durationMetric->observe(pendingAction.latency.nsecsElapsed() / 1000);
+
+    qCDebug(dcDeviceManager) << "Action" << pendingAction.action.id().toString() << "finished after" << latency << "ms with" << status << "queue depth" << m_queues.value(deviceId).count();
+
+    if (notify)
+        emit actionExecuted(pendingAction.action, status);
+
+    foreach (const Action &action, pendingAction.supersededActions)
+        emit actionExecuted(action, status);
+
+    if (m_runningActions.isEmpty())
+        m_timeoutTimer->stop();
+
+    processQueues();
+}
+
+void ActionDispatcher::processQueues()
+{
+    // finishing an action while starting the next one must not start the queues recursively
+    if (m_processing)
+        return;
+
+    m_processing = true;
+    bool started = true;
+    while (started) {
+        started = false;
+        foreach (const DeviceId &deviceId, m_queues.keys()) {
+            QList<PendingAction> &queue = m_queues[deviceId];
+            if (queue.isEmpty()) {
+                m_queues.remove(deviceId);
+                continue;
+            }
+
+            if (m_runningActions.contains(deviceId) || m_pluginActions.value(queue.first().pluginId) >= m_maximumPluginActions)
+                continue;
+
+            PendingAction pendingAction = queue.takeFirst();
+            m_statistics[deviceId].queueDepth = queue.count();
+            started = true;
+
+            DeviceManager::DeviceError status = startAction(pendingAction);
+            if (status != DeviceManager::DeviceErrorAsync)
+                finishAction(deviceId, status, true);
+        }
+    }
+    m_processing = false;
+}
+
+void ActionDispatcher::onActionExecutionFinished(const ActionId &actionId, DeviceManager::DeviceError status)
+{
+    // actions which timed out already are not running any more
+    if (!m_runningActionDevices.contains(actionId))
+        return;
+
+    if (actionId == m_startingActionId) {
+        m_startingActionFinished = true;
+        m_startingActionStatus = status;
+        return;
+    }
+
+    finishAction(m_runningActionDevices.value(actionId), status, true);
+}
+
+void ActionDispatcher::onDeviceRemoved(const DeviceId &deviceId)
+{
+    foreach (const PendingAction &pendingAction, m_queues.take(deviceId)) {
+        emit actionExecuted(pendingAction.action, DeviceManager::DeviceErrorDeviceNotFound);
+        foreach (const Action &action, pendingAction.supersededActions)
+            emit actionExecuted(action, DeviceManager::DeviceErrorDeviceNotFound);
+    }
+
+    finishAction(deviceId, DeviceManager::DeviceErrorDeviceNotFound, true);
+    m_statistics.remove(deviceId);
+}
+
+void ActionDispatcher::onTimeout()
+{
+    foreach (const DeviceId &deviceId, m_runningActions.keys()) {
+        const PendingAction &pendingAction = m_runningActions[deviceId];
+        if (pendingAction.latency.elapsed() - pendingAction.startTime < m_actionTimeout)
+            continue;
+
+        qCWarning(dcDeviceManager) << "Action" << pendingAction.action.id().toString() << "timed out after" << m_actionTimeout << "ms";
+        m_statistics[deviceId].timeouts++;
+        m_timeoutMetric->increment();
+        finishAction(deviceId, DeviceManager::DeviceErrorHardwareFailure, true);
+    }
+}
+
+}
@@ -0,0 +1,123 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef ACTIONDISPATCHER_H
+#define ACTIONDISPATCHER_H
+
+#include "devicemanager.h"
+#include "types/action.h"
+#include "metrics.h"
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+
+namespace guhserver {
+
+class ActionDispatcher : public QObject
+{
+    Q_OBJECT
+public:
+    class Statistics
+    {
+    public:
+        Statistics() : executed(0), superseded(0), rejected(0), timeouts(0), queueDepth(0), maximumQueueDepth(0), totalLatency(0), maximumLatency(0) {}
+
+        int executed;
+        int superseded;
+        int rejected;
+        int timeouts;
+        int queueDepth;
+        int maximumQueueDepth;
+        qint64 totalLatency;
+        qint64 maximumLatency;
+
+        qint64 averageLatency() const { return executed > 0 ? totalLatency / executed : 0; }
+    };
+
+    explicit ActionDispatcher(DeviceManager *deviceManager, QObject *parent = 0);
+
+    DeviceManager::DeviceError dispatch(const Action &action);
+
+    int maximumPluginActions() const;
+    void setMaximumPluginActions(const int &maximumPluginActions);
+
+    int maximumQueueDepth() const;
+    void setMaximumQueueDepth(const int &maximumQueueDepth);
+
+    int actionTimeout() const;
+    void setActionTimeout(const int &actionTimeout);
+
+    int queueDepth(const DeviceId &deviceId) const;
+    Statistics statistics(const DeviceId &deviceId) const;
+
+private:
+    class PendingAction
+    {
+    public:
+        Action action;
+        PluginId pluginId;
+        QList<Action> supersededActions;
+        QElapsedTimer latency;
+        qint64 startTime;
+    };
+
+    DeviceManager *m_deviceManager;
+
+    int m_maximumPluginActions;
+    int m_maximumQueueDepth;
+    int m_actionTimeout;
+    bool m_processing;
+    ActionId m_startingActionId;
+    bool m_startingActionFinished;
+    DeviceManager::DeviceError m_startingActionStatus;
+    QTimer *m_timeoutTimer;
+
+    QHash<DeviceId, QList<PendingAction> > m_queues;
+    QHash<DeviceId, PendingAction> m_runningActions;
+    QHash<ActionId, DeviceId> m_runningActionDevices;
+    QHash<PluginId, int> m_pluginActions;
+    QHash<DeviceId, Statistics> m_statistics;
+
+    MetricHistogram *m_durationMetric;
+    MetricCounter *m_timeoutMetric;
+
+    bool setsStateValue(Device *device, const Action &action) const;
+    bool hasSameTarget(const Action &queuedAction, const Action &action) const;
+
+    DeviceManager::DeviceError startAction(const PendingAction &pendingAction);
+    void finishAction(const DeviceId &deviceId, const DeviceManager::DeviceError &status, const bool &notify);
+    void processQueues();
+
+signals:
+    void actionExecuted(const Action &action, DeviceManager::DeviceError status);
+
+private slots:
+    void onActionExecutionFinished(const ActionId &actionId, DeviceManager::DeviceError status);
+    void onDeviceRemoved(const DeviceId &deviceId);
+    void onTimeout();
+
+};
+
+}
+
+#endif // ACTIONDISPATCHER_H
@@ -48,7 +48,9 @@ BluetoothServer::BluetoothServer(QObject *parent) :
     TransportInterface(parent),
     m_server(0)
 {
-
+    m_clientsMetric = Metrics::gauge("guh_transport_clients", "Connected clients of the transport.", "transport", "bluetooth");
+    m_sentBytesMetric = Metrics::counter("guh_transport_sent_bytes_total", "Bytes sent to the clients of the transport.", "transport", "bluetooth");
+    m_receivedBytesMetric = Metrics::counter("guh_transport_received_bytes_total", "Bytes received from the clients of the transport.", "transport", "bluetooth");
 }
 
 /*! Destructs this \l{BluetoothServer}. */
@@ -67,20 +69,22 @@ bool BluetoothServer::hardwareAvailable()
     return localDevice.isValid();
 }
 
-/*! Send \a data to the client with the given \a clientId.*/
-void BluetoothServer::sendData(const QUuid &clientId, const QVariantMap &data)
+/*! Returns the given \a data as compact JSON line, the messages are separated by new lines. */
+QByteArray BluetoothServer::encode(const QVariantMap &data) const
 {
-    QBluetoothSocket *client = 0;
-    client = m_clientList.value(clientId);
-    if (client)
-        client->write(QJsonDocument::fromVariant(data).toJson(QJsonDocument::Compact) + '\n');
+    return QJsonDocument::fromVariant(data).toJson(QJsonDocument::Compact) + '\n';
 }
 
-/*! Send the given \a data to the \a clients. */
-void BluetoothServer::sendData(const QList<QUuid> &clients, const QVariantMap &data)
+/*! Send the encoded \a payload to the client with the given \a clientId.*/
+void BluetoothServer::sendPayload(const QUuid &clientId, const QByteArray &payload)
 {
-    foreach (const QUuid &client, clients)
-        sendData(client, data);
+    QBluetoothSocket *client = 0;
+    client = m_clientList.value(clientId);
+    if (!client)
+        return;
+
+    client->write(payload);
+    m_sentBytesMetric->increment(payload.size());
 }
 
 void BluetoothServer::onClientConnected()
@@ -94,6 +98,7 @@ void BluetoothServer::onClientConnected()
 
     QUuid clientId = QUuid::createUuid();
     m_clientList.insert(clientId, client);
+    m_clientsMetric->set(m_clientList.count());
 
     connect(client, SIGNAL(readyRead()), this, SLOT(readData()));
     connect(client, SIGNAL(error(QBluetoothSocket::SocketError)), this, SLOT(onError(QBluetoothSocket::SocketError)));
@@ -111,6 +116,7 @@ void BluetoothServer::onClientDisconnected()
     qCDebug(dcConnection) << "Bluetooth server: client disconnected:" << client->localName() << client->localAddress().toString();
     QUuid clientId = m_clientList.key(client);
     m_clientList.take(clientId)->deleteLater();
+    m_clientsMetric->set(m_clientList.count());
 }
 
 void BluetoothServer::onError(QBluetoothSocket::SocketError error)
@@ -127,6 +133,7 @@ void BluetoothServer::readData()
     QByteArray message;
     while (client->canReadLine()) {
         QByteArray dataLine = client->readLine();
+        m_receivedBytesMetric->increment(dataLine.size());
         message.append(dataLine);
         if (dataLine.endsWith('\n')) {
             qCDebug(dcConnection()) << "Bluetooth data received:" << message;
@@ -26,6 +26,7 @@
 #include <QBluetoothServer>
 
 #include "transportinterface.h"
+#include "metrics.h"
 
 namespace guhserver {
 
@@ -38,14 +39,18 @@ public:
 
     static bool hardwareAvailable();
 
-    void sendData(const QUuid &clientId, const QVariantMap &data) override;
-    void sendData(const QList<QUuid> &clients, const QVariantMap &data) override;
+    QByteArray encode(const QVariantMap &data) const override;
+    void sendPayload(const QUuid &clientId, const QByteArray &payload) override;
 
 private:
     QBluetoothServer *m_server;
     QBluetoothServiceInfo m_serviceInfo;
     QHash<QUuid, QBluetoothSocket *> m_clientList;
 
+    MetricGauge *m_clientsMetric;
+    MetricCounter *m_sentBytesMetric;
+    MetricCounter *m_receivedBytesMetric;
+
 private slots:
     void onClientConnected();
     void onClientDisconnected();
@@ -0,0 +1,129 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class guhserver::CatalogCache
+    \brief This class keeps serialized snapshots of the large catalog responses.
+
+    \ingroup server
+    \inmodule core
+
+    The supported vendors, device classes and plugins only change if the plugins get loaded, the
+    locale changes or a plugin configuration changes. The \l{CatalogCache} builds each catalog
+    response once, serializes it to compact JSON and computes a tag from the content. The snapshots
+    are kept per locale until the \l{DeviceManager::catalogVersion()}{catalog version} changes.
+
+    The JSON-RPC handlers return the cached data and the REST resources the serialized JSON. Clients
+    can send a known tag (JSON-RPC \tt etag parameter or HTTP \tt If-None-Match header) and get a short
+    reply without the catalog if it did not change.
+
+    \sa DeviceManager::catalogVersion()
+*/
+
+/*! \class guhserver::CatalogCache::Snapshot
+    \brief Holds the \l{CatalogCache::Snapshot::data}{data}, the serialized \l{CatalogCache::Snapshot::json}{json}
+    and the \l{CatalogCache::Snapshot::tag}{tag} of a cached catalog.
+*/
+
+#include "catalogcache.h"
+#include "loggingcategories.h"
+
+#include <QJsonDocument>
+#include <QCryptographicHash>
+
+namespace guhserver {
+
+/*! Constructs a \l{CatalogCache} for the catalog of the given \a deviceManager with the given \a parent. */
+CatalogCache::CatalogCache(DeviceManager *deviceManager, QObject *parent) :
+    QObject(parent),
+    m_deviceManager(deviceManager),
+    m_version(-1),
+    m_hits(0),
+    m_misses(0)
+{
+}
+
+/*! Returns the snapshot with the given \a name for the current catalog version and locale. If there is
+ *  no valid snapshot, it will be created from the data returned by \a build.
+ */
+CatalogCache::Snapshot CatalogCache::snapshot(const QString &name, std::function<QVariant()> build)
+{
+    QString locale = m_deviceManager->locale().name();
+    if (m_version != m_deviceManager->catalogVersion() || m_locale != locale) {
+        qCDebug(dcApplication) << "Catalog changed, dropping" << m_snapshots.count() << "cached snapshots";
+        m_snapshots.clear();
+        m_version = m_deviceManager->catalogVersion();
+        m_locale = locale;
+    }
+
+    QHash<QString, Snapshot>::const_iterator i = m_snapshots.constFind(name);
+    if (i != m_snapshots.constEnd()) {
+        m_hits++;
+        return i.value();
+    }
+
+    m_misses++;
+    Snapshot snapshot;
+    snapshot.data = build();
+    snapshot.json = QJsonDocument::fromVariant(snapshot.data).toJson(QJsonDocument::Compact);
+    snapshot.tag = QCryptographicHash::hash(snapshot.json, QCryptographicHash::Md5).toHex();
+    m_snapshots.insert(name, snapshot);
+    return snapshot;
+}
+
+/*! Returns the catalog version of the cached snapshots. */
+int CatalogCache::version() const
+{
+    return m_version;
+}
+
+/*! Returns how many snapshots could be served from the cache. */
+int CatalogCache::hits() const
+{
+    return m_hits;
+}
+
+/*! Returns how many snapshots had to be built. */
+int CatalogCache::misses() const
+{
+    return m_misses;
+}
+
+/*! Returns true if the given HTTP \a ifNoneMatch header value contains the given \a tag. */
+bool CatalogCache::matchesTag(const QByteArray &ifNoneMatch, const QByteArray &tag)
+{
+    foreach (QByteArray value, ifNoneMatch.split(',')) {
+        value = value.trimmed();
+        if (value == "*")
+            return true;
+
+        if (value.startsWith("W/"))
+            value = value.mid(2);
+
+        if (value.length() >= 2 && value.startsWith('"') && value.endsWith('"'))
+            value = value.mid(1, value.length() - 2);
+
+        if (value == tag)
+            return true;
+    }
+    return false;
+}
+
+}
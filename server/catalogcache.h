@@ -0,0 +1,71 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef CATALOGCACHE_H
+#define CATALOGCACHE_H
+
+#include "devicemanager.h"
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QVariant>
+#include <QByteArray>
+
+#include <functional>
+
+namespace guhserver {
+
+class CatalogCache : public QObject
+{
+    Q_OBJECT
+public:
+    class Snapshot
+    {
+    public:
+        QVariant data;
+        QByteArray json;
+        QByteArray tag;
+    };
+
+    explicit CatalogCache(DeviceManager *deviceManager, QObject *parent = 0);
+
+    Snapshot snapshot(const QString &name, std::function<QVariant()> build);
+
+    int version() const;
+    int hits() const;
+    int misses() const;
+
+    static bool matchesTag(const QByteArray &ifNoneMatch, const QByteArray &tag);
+
+private:
+    DeviceManager *m_deviceManager;
+    int m_version;
+    QString m_locale;
+    QHash<QString, Snapshot> m_snapshots;
+
+    int m_hits;
+    int m_misses;
+
+};
+
+}
+
+#endif // CATALOGCACHE_H
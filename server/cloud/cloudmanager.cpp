@@ -79,6 +79,13 @@ void CloudManager::sendData(const QList<QUuid> &clients, const QVariantMap &data
     }
 }
 
+void CloudManager::sendPayload(const QUuid &clientId, const QByteArray &payload)
+{
+    // The tunnel data get wrapped into the messages of the cloud interface, messages of the cloud
+    // never reach the JSON-RPC workers, so this is only a fallback
+    sendData(clientId, QJsonDocument::fromJson(payload).toVariant().toMap());
+}
+
 bool CloudManager::enabled() const
 {
     return m_enabled;
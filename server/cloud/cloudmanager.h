@@ -47,6 +47,7 @@ public:
 
     void sendData(const QUuid &clientId, const QVariantMap &data) override;
     void sendData(const QList<QUuid> &clients, const QVariantMap &data) override;
+    void sendPayload(const QUuid &clientId, const QByteArray &payload) override;
 
     bool enabled() const;
     bool connected() const;
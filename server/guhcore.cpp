@@ -102,6 +102,10 @@
 #include "networkmanager/networkmanager.h"
 
 #include "devicemanager.h"
+#include "startupprofiler.h"
+#include "catalogcache.h"
+#include "readmodel.h"
+#include "stallwatchdog.h"
 #include "plugin/device.h"
 
 namespace guhserver {
@@ -120,6 +124,9 @@ GuhCore *GuhCore::instance()
 /*! Destructor of the \l{GuhCore}. */
 GuhCore::~GuhCore()
 {
+    // The JSON-RPC workers read the read model and call into the core
+    jsonRPCServer()->stopWorkers();
+
     m_logger->logSystemEvent(m_timeManager->currentDateTime(), false);
 }
 
@@ -289,16 +296,16 @@ DeviceManager::DeviceError GuhCore::removeConfiguredDevice(const DeviceId &devic
     return removeError;
 }
 
-/*! Calls the metheod DeviceManager::executeAction(\a action).
- *  \sa DeviceManager::executeAction(), */
+/*! Dispatches the given \a action through the \l{ActionDispatcher}, which executes it with DeviceManager::executeAction()
+ *  once the device is idle. If the action was queued or is asynchronous, \l{DeviceManager::DeviceErrorAsync}{DeviceErrorAsync}
+ *  will be returned and the \l{actionExecuted()} signal tells the result.
+ *  \sa DeviceManager::executeAction(), ActionDispatcher::dispatch() */
 DeviceManager::DeviceError GuhCore::executeAction(const Action &action)
 {
-    DeviceManager::DeviceError ret = m_deviceManager->executeAction(action);
+    DeviceManager::DeviceError ret = m_actionDispatcher->dispatch(action);
     if (ret == DeviceManager::DeviceErrorNoError) {
         m_logger->logAction(action);
-    } else if (ret == DeviceManager::DeviceErrorAsync) {
-        m_pendingActions.insert(action.id(), action);
-    } else {
+    } else if (ret != DeviceManager::DeviceErrorAsync) {
         m_logger->logAction(action, Logging::LoggingLevelAlert, ret);
     }
     return ret;
@@ -361,6 +368,30 @@ RuleEngine *GuhCore::ruleEngine() const
     return m_ruleEngine;
 }
 
+/*! Returns a pointer to the \l{ActionDispatcher} instance owned by GuhCore.*/
+ActionDispatcher *GuhCore::actionDispatcher() const
+{
+    return m_actionDispatcher;
+}
+
+/*! Returns a pointer to the \l{CatalogCache} instance owned by GuhCore.*/
+CatalogCache *GuhCore::catalogCache() const
+{
+    return m_catalogCache;
+}
+
+/*! Returns a pointer to the \l{ReadModel} instance owned by GuhCore.*/
+ReadModel *GuhCore::readModel() const
+{
+    return m_readModel;
+}
+
+/*! Returns a pointer to the \l{StallWatchdog} instance owned by GuhCore.*/
+StallWatchdog *GuhCore::stallWatchdog() const
+{
+    return m_stallWatchdog;
+}
+
 /*! Returns a pointer to the \l{TimeManager} instance owned by GuhCore.*/
 TimeManager *GuhCore::timeManager() const
 {
@@ -428,25 +459,52 @@ TcpServer *GuhCore::tcpServer() const
 GuhCore::GuhCore(QObject *parent) :
     QObject(parent)
 {
+    // The profile of the daemon starts in main(), a restarted core gets a new one
+    if (!StartupProfiler::isRunning())
+        StartupProfiler::start();
+
     qCDebug(dcApplication()) << "Loading guh configurations" << GuhSettings(GuhSettings::SettingsRoleGlobal).fileName();
+    StartupProfiler::beginPhase("Configuration");
     m_configuration = new GuhConfiguration(this);
+    StartupProfiler::endPhase("Configuration");
 
     qCDebug(dcApplication()) << "Creating Time Manager";
+    StartupProfiler::beginPhase("Time manager");
     m_timeManager = new TimeManager(m_configuration->timeZone(), this);
+    StartupProfiler::endPhase("Time manager");
 
     qCDebug(dcApplication) << "Creating Log Engine";
+    StartupProfiler::beginPhase("Log engine");
     m_logger = new LogEngine(this);
+    StartupProfiler::endPhase("Log engine");
 
     qCDebug(dcApplication) << "Creating Cloud Manager";
+    StartupProfiler::beginPhase("Cloud manager");
     m_cloudManager = new CloudManager(m_configuration->cloudEnabled(), m_configuration->cloudAuthenticationServer(), m_configuration->cloudProxyServer(), this);
+    StartupProfiler::endPhase("Cloud manager");
 
     qCDebug(dcApplication) << "Creating Device Manager";
+    StartupProfiler::beginPhase("Device manager");
     m_deviceManager = new DeviceManager(m_configuration->locale(), this);
+    StartupProfiler::endPhase("Device manager");
+
+    qCDebug(dcApplication) << "Creating Action Dispatcher";
+    m_actionDispatcher = new ActionDispatcher(m_deviceManager, this);
+    m_catalogCache = new CatalogCache(m_deviceManager, this);
+
+    // Watches the event loop once the startup is finished
+    m_stallWatchdog = new StallWatchdog(this);
 
     qCDebug(dcApplication) << "Creating Rule Engine";
+    StartupProfiler::beginPhase("Rule engine");
     m_ruleEngine = new RuleEngine(this);
+    StartupProfiler::endPhase("Rule engine");
+
+    // Has to follow the changes before the JSON-RPC handlers, which send the notifications
+    m_readModel = new ReadModel(m_deviceManager, m_ruleEngine, this);
 
     qCDebug(dcApplication) << "Creating Server Manager";
+    StartupProfiler::beginPhase("Servers");
     m_serverManager = new ServerManager(this);
 
 #ifdef TESTING_ENABLED
@@ -468,9 +526,12 @@ GuhCore::GuhCore(QObject *parent) :
     // Webserver setup
     m_webServer = new WebServer(m_configuration->webServerAddress(), m_configuration->webServerPort(), m_configuration->webServerPublicFolder(), this);
     m_serverManager->restServer()->registerWebserver(m_webServer);
+    StartupProfiler::endPhase("Servers");
 
     // Create the NetworkManager
+    StartupProfiler::beginPhase("Network manager");
     m_networkManager = new NetworkManager(this);
+    StartupProfiler::endPhase("Network manager");
 
     // Connect the configuration changes
     connect(m_configuration, &GuhConfiguration::cloudEnabledChanged, m_cloudManager, &CloudManager::onCloudEnabledChanged);
@@ -484,15 +545,18 @@ GuhCore::GuhCore(QObject *parent) :
     connect(m_deviceManager, &DeviceManager::deviceAdded, this, &GuhCore::deviceAdded);
     connect(m_deviceManager, &DeviceManager::deviceChanged, this, &GuhCore::deviceChanged);
     connect(m_deviceManager, &DeviceManager::deviceRemoved, this, &GuhCore::deviceRemoved);
-    connect(m_deviceManager, &DeviceManager::actionExecutionFinished, this, &GuhCore::actionExecutionFinished);
+    connect(m_actionDispatcher, &ActionDispatcher::actionExecuted, this, &GuhCore::actionExecutionFinished);
     connect(m_deviceManager, &DeviceManager::devicesDiscovered, this, &GuhCore::devicesDiscovered);
     connect(m_deviceManager, &DeviceManager::deviceSetupFinished, this, &GuhCore::deviceSetupFinished);
     connect(m_deviceManager, &DeviceManager::deviceReconfigurationFinished, this, &GuhCore::deviceReconfigurationFinished);
     connect(m_deviceManager, &DeviceManager::pairingFinished, this, &GuhCore::pairingFinished);
+    // Queued, so the servers started by queued calls are part of the startup as well
+    connect(m_deviceManager, &DeviceManager::loaded, this, &GuhCore::onDeviceManagerLoaded, Qt::QueuedConnection);
 
     connect(m_ruleEngine, &RuleEngine::ruleAdded, this, &GuhCore::ruleAdded);
     connect(m_ruleEngine, &RuleEngine::ruleRemoved, this, &GuhCore::ruleRemoved);
     connect(m_ruleEngine, &RuleEngine::ruleConfigurationChanged, this, &GuhCore::ruleConfigurationChanged);
+    connect(this, &GuhCore::ruleActiveChanged, m_readModel, &ReadModel::updateRule);
 
     connect(m_timeManager, &TimeManager::dateTimeChanged, this, &GuhCore::onDateTimeChanged);
     connect(m_timeManager, &TimeManager::tick, m_deviceManager, &DeviceManager::timeTick);
@@ -534,26 +598,8 @@ void GuhCore::gotEvent(const Event &event)
     }
 
     // Set action params, depending on the event value
-    foreach (RuleAction ruleAction, eventBasedActions) {
-        RuleActionParamList newParams;
-        foreach (RuleActionParam ruleActionParam, ruleAction.ruleActionParams()) {
-            // if this event param should be taken over in this action
-            if (event.eventTypeId() == ruleActionParam.eventTypeId()) {
-                QVariant eventValue = event.params().first().value();
-
-                // TODO: get param names...when an event has more than one parameter
-
-                // TODO: limits / scale calculation -> actionValue = eventValue * x
-                //       something like a EventParamDescriptor
-
-                ruleActionParam.setValue(eventValue);
-                qCDebug(dcRuleEngine) << "take over event param value" << ruleActionParam.value();
-            }
-            newParams.append(ruleActionParam);
-        }
-        ruleAction.setRuleActionParams(newParams);
-        actions.append(ruleAction);
-    }
+    foreach (const RuleAction &ruleAction, eventBasedActions)
+        actions.append(RuleEngine::takeOverEventParams(ruleAction, event));
 
     executeRuleActions(actions);
 }
@@ -587,6 +633,19 @@ void GuhCore::onLocaleChanged()
     m_deviceManager->setLocale(m_configuration->locale());
 }
 
+void GuhCore::onDeviceManagerLoaded()
+{
+    StartupProfiler::finish();
+    qCDebug(dcApplication) << "Startup finished in" << StartupProfiler::bootTime() << "ms";
+    m_stallWatchdog->startWatching();
+
+    if (StartupProfiler::reportEnabled()) {
+        foreach (const QString &line, StartupProfiler::report()) {
+            qCDebug(dcApplication) << qPrintable(line);
+        }
+    }
+}
+
 /*! Return the instance of the log engine */
 LogEngine* GuhCore::logEngine() const
 {
@@ -605,10 +664,9 @@ RestServer *GuhCore::restServer() const
     return m_serverManager->restServer();
 }
 
-void GuhCore::actionExecutionFinished(const ActionId &id, DeviceManager::DeviceError status)
+void GuhCore::actionExecutionFinished(const Action &action, DeviceManager::DeviceError status)
 {
-    emit actionExecuted(id, status);
-    Action action = m_pendingActions.take(id);
+    emit actionExecuted(action.id(), status);
     m_logger->logAction(action, status == DeviceManager::DeviceErrorNoError ? Logging::LoggingLevelInfo : Logging::LoggingLevelAlert, status);
 }
 
@@ -32,6 +32,7 @@
 #include "guhconfiguration.h"
 #include "devicemanager.h"
 #include "ruleengine.h"
+#include "actiondispatcher.h"
 #include "servermanager.h"
 #include "websocketserver.h"
 #include "bluetoothserver.h"
@@ -52,6 +53,9 @@ class Device;
 namespace guhserver {
 
 class JsonRPCServer;
+class CatalogCache;
+class ReadModel;
+class StallWatchdog;
 class LogEngine;
 class NetworkManager;
 
@@ -82,6 +86,10 @@ public:
     RestServer *restServer() const;
     DeviceManager *deviceManager() const;
     RuleEngine *ruleEngine() const;
+    ActionDispatcher *actionDispatcher() const;
+    CatalogCache *catalogCache() const;
+    ReadModel *readModel() const;
+    StallWatchdog *stallWatchdog() const;
     TimeManager *timeManager() const;
     WebServer *webServer() const;
     WebSocketServer *webSocketServer() const;
@@ -124,6 +132,10 @@ private:
     ServerManager *m_serverManager;
     DeviceManager *m_deviceManager;
     RuleEngine *m_ruleEngine;
+    ActionDispatcher *m_actionDispatcher;
+    CatalogCache *m_catalogCache;
+    ReadModel *m_readModel;
+    StallWatchdog *m_stallWatchdog;
     LogEngine *m_logger;
     TimeManager *m_timeManager;
 
@@ -140,13 +152,12 @@ private:
 
     CloudManager *m_cloudManager;
 
-    QHash<ActionId, Action> m_pendingActions;
-
 private slots:
     void gotEvent(const Event &event);
     void onDateTimeChanged(const QDateTime &dateTime);
     void onLocaleChanged();
-    void actionExecutionFinished(const ActionId &id, DeviceManager::DeviceError status);
+    void onDeviceManagerLoaded();
+    void actionExecutionFinished(const Action &action, DeviceManager::DeviceError status);
 
 };
 
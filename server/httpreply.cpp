@@ -47,6 +47,8 @@
         The request has no content but it was expected.
     \value Found
         The resource was found.
+    \value NotModified
+        The resource did not change since the version the client already has.
     \value BadRequest
         The request was bad formatted. Also if a \l{Param} was not understood or the header is not correct.
     \value Forbidden
@@ -131,6 +133,7 @@
 
 #include "httpreply.h"
 #include "loggingcategories.h"
+#include "metrics.h"
 #include "guhcore.h"
 
 #include <QDateTime>
@@ -143,54 +146,27 @@ HttpReply::HttpReply(QObject *parent) :
     QObject(parent),
     m_statusCode(HttpReply::Ok),
     m_type(HttpReply::TypeSync),
-    m_payload(QByteArray()),
     m_closeConnection(false),
+    m_timer(0),
     m_timedOut(false)
 {
-    m_timer = new QTimer(this);
-    connect(m_timer, &QTimer::timeout, this, &HttpReply::timedOut);
-
-    m_reasonPhrase = getHttpReasonPhrase(m_statusCode);
-
-    // set known headers
-    setHeader(HttpReply::ContentTypeHeader, "text/plain; charset=\"utf-8\";");
-    setHeader(HttpHeaderType::ServerHeader, "guh/" + QByteArray(GUH_VERSION_STRING));
-    setHeader(HttpHeaderType::DateHeader, GuhCore::instance()->timeManager()->currentDateTime().toString("ddd, dd MMM yyyy hh:mm:ss").toUtf8());
-    setHeader(HttpHeaderType::CacheControlHeader, "no-cache");
-    setHeader(HttpHeaderType::ConnectionHeader, "Keep-Alive");
-    setRawHeader("Access-Control-Allow-Origin","*");
-    setRawHeader("Keep-Alive", "timeout=12, max=50");
-    packReply();
+    setDefaultHeaders();
 }
 
 HttpReply::HttpReply(const HttpReply::HttpStatusCode &statusCode, const HttpReply::Type &type, QObject *parent):
     QObject(parent),
     m_statusCode(statusCode),
     m_type(type),
-    m_payload(QByteArray()),
+    m_closeConnection(false),
+    m_timer(0),
     m_timedOut(false)
 {
-    m_timer = new QTimer(this);
-    connect(m_timer, &QTimer::timeout, this, &HttpReply::timeout);
-
-    m_reasonPhrase = getHttpReasonPhrase(m_statusCode);
-
-    // set known / default headers
-    setHeader(HttpReply::ContentTypeHeader, "text/plain; charset=\"utf-8\";");
-    setHeader(HttpHeaderType::ServerHeader, "guh/" + QByteArray(GUH_VERSION_STRING));
-    setHeader(HttpHeaderType::DateHeader, GuhCore::instance()->timeManager()->currentDateTime().toString("ddd, dd MMM yyyy hh:mm:ss").toUtf8());
-    setHeader(HttpHeaderType::CacheControlHeader, "no-cache");
-    setHeader(HttpHeaderType::ConnectionHeader, "Keep-Alive");
-    setRawHeader("Access-Control-Allow-Origin","*");
-    setRawHeader("Keep-Alive", "timeout=12, max=50");
-    packReply();
+    setDefaultHeaders();
 }
 
 void HttpReply::setHttpStatusCode(const HttpReply::HttpStatusCode &statusCode)
 {
     m_statusCode = statusCode;
-    m_reasonPhrase = getHttpReasonPhrase(m_statusCode);
-    packReply();
 }
 
 /*! Returns the status code of this \l{HttpReply}.*/
@@ -202,7 +178,7 @@ HttpReply::HttpStatusCode HttpReply::httpStatusCode() const
 /*! Returns the error code reason phrase for the current \l{HttpStatusCode}.*/
 QByteArray HttpReply::httpReasonPhrase() const
 {
-    return m_reasonPhrase;
+    return getHttpReasonPhrase(m_statusCode);
 }
 
 /*! Returns the type of this \l{HttpReply}.
@@ -217,7 +193,6 @@ HttpReply::Type HttpReply::type() const
 void HttpReply::setClientId(const QUuid &clientId)
 {
     m_clientId = clientId;
-    packReply();
 }
 
 /*! Returns the clientId of this \l{HttpReply}.*/
@@ -226,12 +201,11 @@ QUuid HttpReply::clientId() const
     return m_clientId;
 }
 
-/*! Set the payload of this \l{HttpReply} to the given \a data.*/
+/*! Set the payload of this \l{HttpReply} to the given \a data. The data will be shared, not copied.*/
 void HttpReply::setPayload(const QByteArray &data)
 {
     m_payload = data;
     setHeader(HttpHeaderType::ContentLenghtHeader, QByteArray::number(data.length()));
-    packReply();
 }
 
 /*! Returns the payload of this \l{HttpReply}.*/
@@ -246,11 +220,7 @@ QByteArray HttpReply::payload() const
 void HttpReply::setRawHeader(const QByteArray headerType, const QByteArray &value)
 {
     // if the header is already set, overwrite it
-    if (m_rawHeaderList.keys().contains(headerType)) {
-        m_rawHeaderList.remove(headerType);
-    }
     m_rawHeaderList.insert(headerType, value);
-    packReply();
 }
 
 /*! This method appends a known header to the header list of this \l{HttpReply}.
@@ -261,19 +231,53 @@ void HttpReply::setHeader(const HttpHeaderType &headerType, const QByteArray &va
     setRawHeader(getHeaderType(headerType), value);
 }
 
+/*! Removes the header \a headerType from the header list of this \l{HttpReply}. */
+void HttpReply::removeRawHeader(const QByteArray &headerType)
+{
+    m_rawHeaderList.remove(headerType);
+}
+
 /*! Returns the list of all set headers in this \l{HttpReply}.*/
 QHash<QByteArray, QByteArray> HttpReply::rawHeaderList() const
 {
     return m_rawHeaderList;
 }
 
-/*! Returns the raw headers of this \l{HttpReply}.
-    \note The header will be empty until the method \l{packReply()} was called.
-    \sa packReply()
+/*! Returns the status line and the header block of this \l{HttpReply}, terminated by an empty line.
+    The header gets serialized on each call, so call it once when the reply gets sent.
+    \sa payload()
 */
 QByteArray HttpReply::rawHeader() const
 {
-    return m_rawHeader;
+    QByteArray dateHeader = getHeaderType(DateHeader);
+
+    // status line + one line per header, enough to avoid reallocations
+    QByteArray header;
+    header.reserve(64 + m_rawHeaderList.count() * 48);
+    header.append("HTTP/1.1 ");
+    header.append(QByteArray::number(m_statusCode));
+    header.append(' ');
+    header.append(getHttpReasonPhrase(m_statusCode));
+    header.append("\r\n");
+
+    QHash<QByteArray, QByteArray>::const_iterator i;
+    for (i = m_rawHeaderList.constBegin(); i != m_rawHeaderList.constEnd(); ++i) {
+        header.append(i.key());
+        header.append(": ");
+        header.append(i.value());
+        header.append("\r\n");
+    }
+
+    // the date is the time of sending
+    if (!m_rawHeaderList.contains(dateHeader)) {
+        header.append(dateHeader);
+        header.append(": ");
+        header.append(GuhCore::instance()->timeManager()->currentDateTime().toString("ddd, dd MMM yyyy hh:mm:ss").toUtf8());
+        header.append("\r\n");
+    }
+
+    header.append("\r\n");
+    return header;
 }
 
 /*! Sets the \a close paramter of this \l{HttpReply}. If \a close is true,
@@ -295,7 +299,7 @@ bool HttpReply::closeConnection() const
 /*! Returns true if the raw header and the payload of this \l{HttpReply} is empty.*/
 bool HttpReply::isEmpty() const
 {
-    return m_rawHeader.isEmpty() && m_payload.isEmpty() && m_rawHeaderList.isEmpty();
+    return m_payload.isEmpty() && m_rawHeaderList.isEmpty();
 }
 
 /*! Clears all data of this \l{HttpReply}. */
@@ -304,33 +308,16 @@ void HttpReply::clear()
     m_closeConnection = false;
     m_type = TypeSync;
     m_statusCode = Ok;
-    m_rawHeader.clear();
     m_payload.clear();
     m_rawHeaderList.clear();
 }
-/*! Packs the whole reply data of this \l{HttpReply}. The data can be accessed with \l{HttpReply::data()}.
-    \sa data()
-*/
-void HttpReply::packReply()
-{
-    // set status code
-    m_data.clear();
-    m_rawHeader.clear();
-    m_rawHeader.append("HTTP/1.1 " + QByteArray::number(m_statusCode) + " " + getHttpReasonPhrase(m_statusCode) + "\r\n");
-
-    // write header
-    foreach (const QByteArray &headerName, m_rawHeaderList.keys()) {
-        m_rawHeader.append(headerName + ": " + m_rawHeaderList.value(headerName) + "\r\n" );
-    }
-
-    m_rawHeader.append("\r\n");
-    m_data = m_rawHeader.append(m_payload);
-}
 
-/*! Returns the current raw data (header + payload) of this \l{HttpReply}.*/
+/*! Returns the raw data (header + payload) of this \l{HttpReply}. This copies the payload, the \l{WebServer}
+    writes the \l{rawHeader()} and the \l{payload()} separately instead.
+*/
 QByteArray HttpReply::data() const
 {
-    return m_data;
+    return rawHeader() + m_payload;
 }
 
 /*! Return true if the response took to long for the request.*/
@@ -339,6 +326,17 @@ bool HttpReply::timedOut() const
     return m_timedOut;
 }
 
+void HttpReply::setDefaultHeaders()
+{
+    m_rawHeaderList.reserve(12);
+    setHeader(HttpReply::ContentTypeHeader, "text/plain; charset=\"utf-8\";");
+    setHeader(HttpHeaderType::ServerHeader, "guh/" + QByteArray(GUH_VERSION_STRING));
+    setHeader(HttpHeaderType::CacheControlHeader, "no-cache");
+    setHeader(HttpHeaderType::ConnectionHeader, "Keep-Alive");
+    setRawHeader("Access-Control-Allow-Origin","*");
+    setRawHeader("Keep-Alive", "timeout=12, max=50");
+}
+
 QByteArray HttpReply::getHttpReasonPhrase(const HttpReply::HttpStatusCode &statusCode)
 {
     switch (statusCode) {
@@ -352,6 +350,8 @@ QByteArray HttpReply::getHttpReasonPhrase(const HttpReply::HttpStatusCode &statu
         return "No Content";
     case Found:
         return "Found";
+    case NotModified:
+        return "Not Modified";
     case BadRequest:
         return "Bad Request";
     case Forbidden:
@@ -407,17 +407,25 @@ QByteArray HttpReply::getHeaderType(const HttpReply::HttpHeaderType &headerType)
     }
 }
 
-/*! Starts the timer for an async \l{HttpReply}.
+/*! Starts the timer for an async \l{HttpReply}. The timer only gets created for async replies.
  *
  *  \sa finished()
  */
 void HttpReply::startWait()
 {
+    if (!m_timer) {
+        m_timer = new QTimer(this);
+        m_timer->setSingleShot(true);
+        connect(m_timer, &QTimer::timeout, this, &HttpReply::timeout);
+    }
     m_timer->start(10000);
 }
 
 void HttpReply::timeout()
 {
+    static MetricCounter *timeoutMetric = Metrics::counter("guh_http_reply_timeouts_total", "Asynchronous HTTP replies which timed out.");
+    timeoutMetric->increment();
+
     qCDebug(dcWebServer) << "Http reply timeout";
     m_timedOut = true;
     emit finished();
@@ -42,6 +42,7 @@ public:
         Accepted                = 202,
         NoContent               = 204,
         Found                   = 302,
+        NotModified             = 304,
         BadRequest              = 400,
         Forbidden               = 403,
         NotFound                = 404,
@@ -91,6 +92,7 @@ public:
 
     void setRawHeader(const QByteArray headerType, const QByteArray &value);
     void setHeader(const HttpHeaderType &headerType, const QByteArray &value);
+    void removeRawHeader(const QByteArray &headerType);
     QHash<QByteArray, QByteArray> rawHeaderList() const;
     QByteArray rawHeader() const;
 
@@ -100,21 +102,16 @@ public:
     bool isEmpty() const;
     void clear();
 
-    void packReply();
-
     QByteArray data() const;
 
     bool timedOut() const;
 
 private:
     HttpStatusCode m_statusCode;
-    QByteArray m_reasonPhrase;
     Type m_type;
     QUuid m_clientId;
 
-    QByteArray m_rawHeader;
     QByteArray m_payload;
-    QByteArray m_data;
 
     QHash<QByteArray, QByteArray> m_rawHeaderList;
 
@@ -123,8 +120,9 @@ private:
     QTimer *m_timer;
     bool m_timedOut;
 
-    QByteArray getHttpReasonPhrase(const HttpStatusCode &statusCode);
-    QByteArray getHeaderType(const HttpHeaderType &headerType);
+    void setDefaultHeaders();
+    static QByteArray getHttpReasonPhrase(const HttpStatusCode &statusCode);
+    static QByteArray getHeaderType(const HttpHeaderType &headerType);
 
 private slots:
     void timeout();
@@ -55,6 +55,7 @@
 
 #include "devicehandler.h"
 #include "guhcore.h"
+#include "readmodel.h"
 #include "devicemanager.h"
 #include "loggingcategories.h"
 #include "plugin/device.h"
@@ -73,28 +74,37 @@ DeviceHandler::DeviceHandler(QObject *parent) :
     QVariantMap params;
 
     params.clear(); returns.clear();
-    setDescription("GetSupportedVendors", "Returns a list of supported Vendors.");
+    setDescription("GetSupportedVendors", "Returns a list of supported Vendors. If the given etag matches the current "
+                   "catalog, the vendors will be omitted.");
+    params.insert("o:etag", JsonTypes::basicTypeToString(JsonTypes::String));
     setParams("GetSupportedVendors", params);
     QVariantList vendors;
     vendors.append(JsonTypes::vendorRef());
-    returns.insert("vendors", vendors);
+    returns.insert("o:vendors", vendors);
+    returns.insert("etag", JsonTypes::basicTypeToString(JsonTypes::String));
     setReturns("GetSupportedVendors", returns);
 
     params.clear(); returns.clear();
-    setDescription("GetSupportedDevices", "Returns a list of supported Device classes, optionally filtered by vendorId.");
+    setDescription("GetSupportedDevices", "Returns a list of supported Device classes, optionally filtered by vendorId. "
+                   "If the given etag matches the current catalog, the device classes will be omitted.");
     params.insert("o:vendorId", JsonTypes::basicTypeToString(JsonTypes::Uuid));
+    params.insert("o:etag", JsonTypes::basicTypeToString(JsonTypes::String));
     setParams("GetSupportedDevices", params);
     QVariantList deviceClasses;
     deviceClasses.append(JsonTypes::deviceClassRef());
-    returns.insert("deviceClasses", deviceClasses);
+    returns.insert("o:deviceClasses", deviceClasses);
+    returns.insert("etag", JsonTypes::basicTypeToString(JsonTypes::String));
     setReturns("GetSupportedDevices", returns);
 
     params.clear(); returns.clear();
-    setDescription("GetPlugins", "Returns a list of loaded plugins.");
+    setDescription("GetPlugins", "Returns a list of loaded plugins. If the given etag matches the current "
+                   "catalog, the plugins will be omitted.");
+    params.insert("o:etag", JsonTypes::basicTypeToString(JsonTypes::String));
     setParams("GetPlugins", params);
     QVariantList plugins;
     plugins.append(JsonTypes::pluginRef());
-    returns.insert("plugins", plugins);
+    returns.insert("o:plugins", plugins);
+    returns.insert("etag", JsonTypes::basicTypeToString(JsonTypes::String));
     setReturns("GetPlugins", returns);
 
     params.clear(); returns.clear();
@@ -167,6 +177,20 @@ DeviceHandler::DeviceHandler(QObject *parent) :
     devices.append(JsonTypes::deviceRef());
     returns.insert("devices", devices);
     setReturns("GetConfiguredDevices", returns);
+    setReadOnly("GetConfiguredDevices");
+
+    params.clear(); returns.clear();
+    setDescription("GetChangesSince", "Returns the configured devices which were added, edited or changed a state after the "
+                   "given sequence and the ids of the removed devices. Pass the returned sequence with the next call. If the "
+                   "changes since the given sequence are not known any more, resyncRequired is true and devices contains "
+                   "all configured devices.");
+    params.insert("sequence", JsonTypes::basicTypeToString(JsonTypes::Int));
+    setParams("GetChangesSince", params);
+    returns.insert("sequence", JsonTypes::basicTypeToString(JsonTypes::Int));
+    returns.insert("resyncRequired", JsonTypes::basicTypeToString(JsonTypes::Bool));
+    returns.insert("devices", QVariantList() << JsonTypes::deviceRef());
+    returns.insert("removedDeviceIds", QVariantList() << JsonTypes::basicTypeToString(JsonTypes::Uuid));
+    setReturns("GetChangesSince", returns);
 
     params.clear(); returns.clear();
     setDescription("GetDiscoveredDevices", "Performs a device discovery and returns the results. This function may take a while to return.");
@@ -255,6 +279,7 @@ DeviceHandler::DeviceHandler(QObject *parent) :
     returns.insert("deviceError", JsonTypes::deviceErrorRef());
     returns.insert("o:value", JsonTypes::basicTypeToString(JsonTypes::Variant));
     setReturns("GetStateValue", returns);
+    setReadOnly("GetStateValue");
 
     params.clear(); returns.clear();
     setDescription("GetStateValues", "Get all the state values of the given device.");
@@ -268,6 +293,7 @@ DeviceHandler::DeviceHandler(QObject *parent) :
     states.append(state);
     returns.insert("o:values", states);
     setReturns("GetStateValues", returns);
+    setReadOnly("GetStateValues");
 
     // Notifications
     params.clear(); returns.clear();
@@ -310,18 +336,19 @@ QString DeviceHandler::name() const
 
 JsonReply* DeviceHandler::GetSupportedVendors(const QVariantMap &params) const
 {
-    Q_UNUSED(params)
-
-    QVariantMap returns;
-    returns.insert("vendors", JsonTypes::packSupportedVendors());
-    return createReply(returns);
+    CatalogCache::Snapshot snapshot = GuhCore::instance()->catalogCache()->snapshot("vendors", [] () {
+        return QVariant(JsonTypes::packSupportedVendors());
+    });
+    return createSnapshotReply("vendors", snapshot, params);
 }
 
 JsonReply* DeviceHandler::GetSupportedDevices(const QVariantMap &params) const
 {
-    QVariantMap returns;
-    returns.insert("deviceClasses", JsonTypes::packSupportedDevices(VendorId(params.value("vendorId").toString())));
-    return createReply(returns);
+    VendorId vendorId = VendorId(params.value("vendorId").toString());
+    CatalogCache::Snapshot snapshot = GuhCore::instance()->catalogCache()->snapshot("deviceclasses/" + vendorId.toString(), [vendorId] () {
+        return QVariant(JsonTypes::packSupportedDevices(vendorId));
+    });
+    return createSnapshotReply("deviceClasses", snapshot, params);
 }
 
 JsonReply *DeviceHandler::GetDiscoveredDevices(const QVariantMap &params) const
@@ -344,11 +371,10 @@ JsonReply *DeviceHandler::GetDiscoveredDevices(const QVariantMap &params) const
 
 JsonReply* DeviceHandler::GetPlugins(const QVariantMap &params) const
 {
-    Q_UNUSED(params)
-
-    QVariantMap returns;
-    returns.insert("plugins", JsonTypes::packPlugins());
-    return createReply(returns);
+    CatalogCache::Snapshot snapshot = GuhCore::instance()->catalogCache()->snapshot("plugins", [] () {
+        return QVariant(JsonTypes::packPlugins());
+    });
+    return createSnapshotReply("plugins", snapshot, params);
 }
 
 JsonReply *DeviceHandler::GetPluginConfiguration(const QVariantMap &params) const
@@ -454,25 +480,32 @@ JsonReply *DeviceHandler::ConfirmPairing(const QVariantMap &params)
 
 JsonReply* DeviceHandler::GetConfiguredDevices(const QVariantMap &params) const
 {
+    QSharedPointer<const ReadModel::Snapshot> snapshot = GuhCore::instance()->readModel()->snapshot();
+
     QVariantMap returns;
     QVariantList configuredDeviceList;
     if (params.contains("deviceId")) {
-        Device *device = GuhCore::instance()->deviceManager()->findConfiguredDevice(DeviceId(params.value("deviceId").toString()));
-        if (!device) {
+        DeviceId deviceId = DeviceId(params.value("deviceId").toString());
+        if (!snapshot->devices.contains(deviceId)) {
             returns.insert("deviceError", JsonTypes::deviceErrorToString(DeviceManager::DeviceErrorDeviceNotFound));
             return createReply(returns);
         } else {
-            configuredDeviceList.append(JsonTypes::packDevice(device));
+            configuredDeviceList.append(snapshot->devices.value(deviceId));
         }
     } else {
-        foreach (Device *device, GuhCore::instance()->deviceManager()->configuredDevices()) {
-            configuredDeviceList.append(JsonTypes::packDevice(device));
+        foreach (const DeviceId &deviceId, snapshot->deviceIds) {
+            configuredDeviceList.append(snapshot->devices.value(deviceId));
         }
     }
     returns.insert("devices", configuredDeviceList);
     return createReply(returns);
 }
 
+JsonReply *DeviceHandler::GetChangesSince(const QVariantMap &params) const
+{
+    return createReply(JsonTypes::packDeviceChanges(params.value("sequence").toLongLong()));
+}
+
 JsonReply *DeviceHandler::ReconfigureDevice(const QVariantMap &params)
 {
     Q_UNUSED(params);
@@ -587,36 +620,43 @@ JsonReply* DeviceHandler::GetStateTypes(const QVariantMap &params) const
 
 JsonReply* DeviceHandler::GetStateValue(const QVariantMap &params) const
 {
+    QSharedPointer<const ReadModel::Snapshot> snapshot = GuhCore::instance()->readModel()->snapshot();
+
     QVariantMap returns;
 
-    Device *device = GuhCore::instance()->deviceManager()->findConfiguredDevice(DeviceId(params.value("deviceId").toString()));
-    if (!device) {
+    DeviceId deviceId = DeviceId(params.value("deviceId").toString());
+    if (!snapshot->devices.contains(deviceId)) {
         returns.insert("deviceError", JsonTypes::deviceErrorToString(DeviceManager::DeviceErrorDeviceNotFound));
         return createReply(returns);
     }
+
     StateTypeId stateTypeId = StateTypeId(params.value("stateTypeId").toString());
-    if (!device->hasState(stateTypeId)) {
-        returns.insert("deviceError", JsonTypes::deviceErrorToString(DeviceManager::DeviceErrorStateTypeNotFound));
-        return createReply(returns);
+    foreach (const QVariant &stateValue, snapshot->devices.value(deviceId).value("states").toList()) {
+        if (StateTypeId(stateValue.toMap().value("stateTypeId").toString()) == stateTypeId) {
+            returns.insert("deviceError", JsonTypes::deviceErrorToString(DeviceManager::DeviceErrorNoError));
+            returns.insert("value", stateValue.toMap().value("value"));
+            return createReply(returns);
+        }
     }
 
-    returns.insert("deviceError", JsonTypes::deviceErrorToString(DeviceManager::DeviceErrorNoError));
-    returns.insert("value", device->state(stateTypeId).value());
+    returns.insert("deviceError", JsonTypes::deviceErrorToString(DeviceManager::DeviceErrorStateTypeNotFound));
     return createReply(returns);
 }
 
 JsonReply *DeviceHandler::GetStateValues(const QVariantMap &params) const
 {
+    QSharedPointer<const ReadModel::Snapshot> snapshot = GuhCore::instance()->readModel()->snapshot();
+
     QVariantMap returns;
 
-    Device *device = GuhCore::instance()->deviceManager()->findConfiguredDevice(DeviceId(params.value("deviceId").toString()));
-    if (!device) {
+    DeviceId deviceId = DeviceId(params.value("deviceId").toString());
+    if (!snapshot->devices.contains(deviceId)) {
         returns.insert("deviceError", JsonTypes::deviceErrorToString(DeviceManager::DeviceErrorDeviceNotFound));
         return createReply(returns);
     }
 
     returns.insert("deviceError", JsonTypes::deviceErrorToString(DeviceManager::DeviceErrorNoError));
-    returns.insert("values", JsonTypes::packDeviceStates(device));
+    returns.insert("values", snapshot->devices.value(deviceId).value("states"));
     return createReply(returns);
 }
 
@@ -724,4 +764,15 @@ void DeviceHandler::pairingFinished(const PairingTransactionId &pairingTransacti
     m_asynDeviceAdditions.insert(deviceId, reply);
 }
 
+JsonReply *DeviceHandler::createSnapshotReply(const QString &key, const CatalogCache::Snapshot &snapshot, const QVariantMap &params) const
+{
+    // a client which already knows this catalog only gets the tag back
+    QVariantMap returns;
+    returns.insert("etag", QString::fromLatin1(snapshot.tag));
+    if (params.value("etag").toString() != QString::fromLatin1(snapshot.tag))
+        returns.insert(key, snapshot.data);
+
+    return createReply(returns);
+}
+
 }
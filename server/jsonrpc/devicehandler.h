@@ -24,6 +24,7 @@
 
 #include "jsonhandler.h"
 #include "devicemanager.h"
+#include "catalogcache.h"
 
 namespace guhserver {
 
@@ -46,6 +47,7 @@ public:
     Q_INVOKABLE JsonReply *PairDevice(const QVariantMap &params);
     Q_INVOKABLE JsonReply *ConfirmPairing(const QVariantMap &params);
     Q_INVOKABLE JsonReply *GetConfiguredDevices(const QVariantMap &params) const;
+    Q_INVOKABLE JsonReply *GetChangesSince(const QVariantMap &params) const;
     Q_INVOKABLE JsonReply *ReconfigureDevice(const QVariantMap &params);
     Q_INVOKABLE JsonReply *EditDevice(const QVariantMap &params);
     Q_INVOKABLE JsonReply *RemoveConfiguredDevice(const QVariantMap &params);
@@ -85,6 +87,8 @@ private:
     mutable QHash<DeviceId, JsonReply*> m_asynDeviceAdditions;
     mutable QHash<DeviceId, JsonReply*> m_asynDeviceEditAdditions;
     mutable QHash<QUuid, JsonReply*> m_asyncPairingRequests;
+
+    JsonReply *createSnapshotReply(const QString &key, const CatalogCache::Snapshot &snapshot, const QVariantMap &params) const;
 };
 
 }
@@ -26,6 +26,9 @@
     \ingroup json
     \inmodule core
 
+    Methods which are marked with \l{setReadOnly()} get executed on a worker thread of the \l{JsonRPCServer}.
+    They must only read from the \l{ReadModel} and must not create any objects other than the \l{JsonReply}.
+
     \sa JsonRPCServer, JsonReply
 */
 
@@ -40,6 +43,7 @@
 
 #include "jsonhandler.h"
 #include "loggingcategories.h"
+#include "metrics.h"
 
 #include <QMetaMethod>
 #include <QDebug>
@@ -103,6 +107,12 @@ bool JsonHandler::hasMethod(const QString &methodName)
     return m_descriptions.contains(methodName) && m_params.contains(methodName) && m_returns.contains(methodName);
 }
 
+/*! Returns true if the method with the given \a methodName is read-only and can be executed on any thread. */
+bool JsonHandler::isReadOnly(const QString &methodName) const
+{
+    return m_readOnlyMethods.contains(methodName);
+}
+
 /*! Validates the given \a params for the given \a methodName. Returns the error string and false if
     the params are not valid. */
 QPair<bool, QString> JsonHandler::validateParams(const QString &methodName, const QVariantMap &params)
@@ -159,6 +169,14 @@ void JsonHandler::setReturns(const QString &methodName, const QVariantMap &retur
     qCWarning(dcJsonRpc) << "Cannot set returns. No such method:" << methodName;
 }
 
+/*! Marks the method with the given \a methodName as read-only. The method will be executed on a worker thread of the
+ *  \l{JsonRPCServer} and must return a synchronous \l{JsonReply} with data from the \l{ReadModel} only.
+ */
+void JsonHandler::setReadOnly(const QString &methodName)
+{
+    m_readOnlyMethods.insert(methodName);
+}
+
 /*! Returns the pointer to a new \l{JsonReply} with the given \a data. */
 JsonReply *JsonHandler::createReply(const QVariantMap &data) const
 {
@@ -341,6 +359,9 @@ void JsonReply::startWait()
 
 void JsonReply::timeout()
 {
+    static MetricCounter *timeoutMetric = Metrics::counter("guh_jsonrpc_reply_timeouts_total", "Asynchronous JSON-RPC replies which timed out.");
+    timeoutMetric->increment();
+
     m_timedOut = true;
     emit finished();
 }
@@ -24,6 +24,7 @@
 
 #include "jsontypes.h"
 
+#include <QSet>
 #include <QObject>
 #include <QVariantMap>
 #include <QMetaMethod>
@@ -95,6 +96,7 @@ public:
     QVariantMap introspect(QMetaMethod::MethodType);
 
     bool hasMethod(const QString &methodName);
+    bool isReadOnly(const QString &methodName) const;
     QPair<bool, QString> validateParams(const QString &methodName, const QVariantMap &params);
     QPair<bool, QString> validateReturns(const QString &methodName, const QVariantMap &returns);
 
@@ -105,6 +107,7 @@ protected:
     void setDescription(const QString &methodName, const QString &description);
     void setParams(const QString &methodName, const QVariantMap &params);
     void setReturns(const QString &methodName, const QVariantMap &returns);
+    void setReadOnly(const QString &methodName);
 
     JsonReply *createReply(const QVariantMap &data) const;
     JsonReply *createAsyncReply(const QString &method) const;
@@ -119,6 +122,7 @@ private:
     QHash<QString, QString> m_descriptions;
     QHash<QString, QVariantMap> m_params;
     QHash<QString, QVariantMap> m_returns;
+    QSet<QString> m_readOnlyMethods;
 };
 
 }
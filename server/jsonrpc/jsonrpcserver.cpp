@@ -32,7 +32,22 @@
     an \l{JsonHandler} and provides the introspection, version and notification control methods
     for the \l{JSON-RPC API}.
 
-    \sa ServerManager, TransportInterface, TcpServer, WebSocketServer
+    The messages of the clients get parsed and validated on a pool of worker threads. All messages of a
+    client are handled by the same worker, so the responses keep the order of the requests. Methods marked as
+    \l{JsonHandler::setReadOnly()}{read-only} get executed on the worker with the data of the \l{ReadModel},
+    and the response gets encoded there as well. All other methods get executed on the main thread, the
+    worker waits for them before it continues with the next message of its clients. The number of workers
+    can be set with \tt workerThreads in the \tt JSONRPC group of the global settings, \tt 0 handles
+    everything on the main thread.
+
+    \sa ServerManager, TransportInterface, TcpServer, WebSocketServer, ReadModel
+*/
+
+/*! \fn void guhserver::JsonRPCServer::notificationReady(const QVariantMap &notification);
+    This signal is emitted for every \a notification sent to the \l{TransportInterface}{TransportInterfaces},
+    independent of the notification status of the clients.
+
+    \sa EventStream
 */
 
 
@@ -40,13 +55,17 @@
 #include "jsontypes.h"
 #include "jsonhandler.h"
 #include "guhcore.h"
+#include "guhsettings.h"
+#include "readmodel.h"
 #include "devicemanager.h"
 #include "plugin/deviceplugin.h"
+#include "plugin/pluginthread.h"
 #include "plugin/deviceclass.h"
 #include "plugin/device.h"
 #include "rule.h"
 #include "ruleengine.h"
 #include "loggingcategories.h"
+#include "calltrace.h"
 
 #include "devicehandler.h"
 #include "actionhandler.h"
@@ -58,8 +77,10 @@
 #include "cloudhandler.h"
 #include "configurationhandler.h"
 #include "networkmanagerhandler.h"
+#include "metricshandler.h"
 
 #include <QJsonDocument>
+#include <QJsonParseError>
 #include <QStringList>
 #include <QSslConfiguration>
 
@@ -68,7 +89,9 @@ namespace guhserver {
 /*! Constructs a \l{JsonRPCServer} with the given \a sslConfiguration and \a parent. */
 JsonRPCServer::JsonRPCServer(const QSslConfiguration &sslConfiguration, QObject *parent):
     JsonHandler(parent),
-    m_notificationId(0)
+    m_notificationId(0),
+    m_mailbox(new PluginMailbox(this)),
+    m_stopping(0)
 {
     Q_UNUSED(sslConfiguration)
     // First, define our own JSONRPC methods
@@ -81,6 +104,7 @@ JsonRPCServer::JsonRPCServer(const QSslConfiguration &sslConfiguration, QObject
     returns.insert("methods", JsonTypes::basicTypeToString(JsonTypes::Object));
     returns.insert("types", JsonTypes::basicTypeToString(JsonTypes::Object));
     setReturns("Introspect", returns);
+    setReadOnly("Introspect");
 
     params.clear(); returns.clear();
     setDescription("Version", "Version of this Guh/JSONRPC interface.");
@@ -88,6 +112,7 @@ JsonRPCServer::JsonRPCServer(const QSslConfiguration &sslConfiguration, QObject
     returns.insert("version", JsonTypes::basicTypeToString(JsonTypes::String));
     returns.insert("protocol version", JsonTypes::basicTypeToString(JsonTypes::String));
     setReturns("Version", returns);
+    setReadOnly("Version");
 
     params.clear(); returns.clear();
     setDescription("SetNotificationStatus", "Enable/Disable notifications for this connections.");
@@ -96,9 +121,26 @@ JsonRPCServer::JsonRPCServer(const QSslConfiguration &sslConfiguration, QObject
     returns.insert("enabled", JsonTypes::basicTypeToString(JsonTypes::Bool));
     setReturns("SetNotificationStatus", returns);
 
+    params.clear(); returns.clear();
+    setDescription("GetStartupProfile", "Get the duration of each phase of the server startup in milliseconds since the start. "
+                   "The critical path lists the top level phases in the order they were passed, including the time spent "
+                   "in the event loop between them.");
+    setParams("GetStartupProfile", params);
+    returns.insert("finished", JsonTypes::basicTypeToString(JsonTypes::Bool));
+    returns.insert("bootTime", JsonTypes::basicTypeToString(JsonTypes::Int));
+    returns.insert("phases", QVariantList() << JsonTypes::startupPhaseRef());
+    returns.insert("criticalPath", QVariantList() << JsonTypes::startupPhaseRef());
+    setReturns("GetStartupProfile", returns);
+
     QMetaObject::invokeMethod(this, "setup", Qt::QueuedConnection);
 }
 
+/*! Destroys this \l{JsonRPCServer} and stops the worker threads. */
+JsonRPCServer::~JsonRPCServer()
+{
+    stopWorkers();
+}
+
 /*! Returns the \e namespace of \l{JsonHandler}. */
 QString JsonRPCServer::name() const
 {
@@ -109,21 +151,8 @@ JsonReply* JsonRPCServer::Introspect(const QVariantMap &params) const
 {
     Q_UNUSED(params)
 
-    QVariantMap data;
-    data.insert("types", JsonTypes::allTypes());
-    QVariantMap methods;
-    foreach (JsonHandler *handler, m_handlers)
-        methods.unite(handler->introspect(QMetaMethod::Method));
-
-    data.insert("methods", methods);
-
-    QVariantMap signalsMap;
-    foreach (JsonHandler *handler, m_handlers)
-        signalsMap.unite(handler->introspect(QMetaMethod::Signal));
-
-    data.insert("notifications", signalsMap);
-
-    return createReply(data);
+    // the introspection gets published once all handlers are registered
+    return createReply(GuhCore::instance()->readModel()->snapshot()->introspection);
 }
 
 JsonReply* JsonRPCServer::Version(const QVariantMap &params) const
@@ -145,6 +174,13 @@ JsonReply* JsonRPCServer::SetNotificationStatus(const QVariantMap &params)
     return createReply(returns);
 }
 
+JsonReply *JsonRPCServer::GetStartupProfile(const QVariantMap &params) const
+{
+    Q_UNUSED(params)
+
+    return createReply(JsonTypes::packStartupProfile());
+}
+
 /*! Returns the list of registred \l{JsonHandler}{JsonHandlers} and their name.*/
 QHash<QString, JsonHandler *> JsonRPCServer::handlers() const
 {
@@ -164,6 +200,62 @@ void JsonRPCServer::registerTransportInterface(TransportInterface *interface, co
     m_interfaces.append(interface);
 }
 
+/*! Processes the raw \a data received by the given \a interface from the client with the given \a clientId. The
+ *  message gets handed to the worker thread of the client, errors and responses get sent back over the \a interface.
+ *  This method has to be called on the main thread.
+ */
+void JsonRPCServer::dispatchMessage(TransportInterface *interface, const QUuid &clientId, const QByteArray &data)
+{
+    if (m_stopping.load())
+        return;
+
+    if (m_workerMailboxes.isEmpty()) {
+        processMessage(interface, clientId, data);
+        return;
+    }
+
+    PluginMailbox *mailbox = m_workerMailboxes.at(qHash(clientId) % m_workerMailboxes.count());
+    mailbox->post([this, interface, clientId, data]() {
+        processMessage(interface, clientId, data);
+    });
+}
+
+/*! Returns the number of worker threads processing the JSON-RPC messages. */
+int JsonRPCServer::workerCount() const
+{
+    return m_workers.count();
+}
+
+/*! Stops the worker threads. Pending messages get dropped, calls of the workers into the main thread get skipped.
+ *  This method has to be called on the main thread before the core components get destroyed.
+ */
+void JsonRPCServer::stopWorkers()
+{
+    if (m_workers.isEmpty())
+        return;
+
+    qCDebug(dcJsonRpc) << "Stopping" << m_workers.count() << "JSON-RPC workers";
+    m_stopping.store(1);
+    for (int i = 0; i < m_workers.count(); i++) {
+        QThread *worker = m_workers.at(i);
+        PluginMailbox *mailbox = m_workerMailboxes.at(i);
+        mailbox->post([worker, mailbox]() {
+            mailbox->deleteLater();
+            worker->quit();
+        });
+    }
+
+    // Release the workers waiting for the main thread
+    foreach (QThread *worker, m_workers) {
+        while (!worker->wait(10))
+            m_mailbox->deliver();
+
+        delete worker;
+    }
+    m_workers.clear();
+    m_workerMailboxes.clear();
+}
+
 void JsonRPCServer::setup()
 {
     registerHandler(this);
@@ -176,29 +268,134 @@ void JsonRPCServer::setup()
     registerHandler(new CloudHandler(this));
     registerHandler(new ConfigurationHandler(this));
     registerHandler(new NetworkManagerHandler(this));
+    registerHandler(new MetricsHandler(this));
+
+    // The API only changes with the protocol version, so it gets published once
+    QVariantMap introspection;
+    introspection.insert("types", JsonTypes::allTypes());
+    QVariantMap methods;
+    foreach (JsonHandler *handler, m_handlers)
+        methods.unite(handler->introspect(QMetaMethod::Method));
+
+    introspection.insert("methods", methods);
+
+    QVariantMap signalsMap;
+    foreach (JsonHandler *handler, m_handlers)
+        signalsMap.unite(handler->introspect(QMetaMethod::Signal));
+
+    introspection.insert("notifications", signalsMap);
+    GuhCore::instance()->readModel()->setIntrospection(introspection);
+
+    startWorkers();
+}
+
+void JsonRPCServer::startWorkers()
+{
+    GuhSettings globalSettings(GuhSettings::SettingsRoleGlobal);
+    globalSettings.beginGroup("JSONRPC");
+    int count = globalSettings.value("workerThreads", qBound(1, QThread::idealThreadCount(), 4)).toInt();
+    globalSettings.endGroup();
+
+    // The handlers must not change any more once the workers are running
+    for (int i = 0; i < count; i++) {
+        QThread *worker = new QThread(this);
+        worker->setObjectName(QString("JSON-RPC worker %1").arg(i));
+        PluginMailbox *mailbox = new PluginMailbox();
+        mailbox->moveToThread(worker);
+        m_workers.append(worker);
+        m_workerMailboxes.append(mailbox);
+        worker->start();
+    }
+    qCDebug(dcJsonRpc) << "Started" << m_workers.count() << "JSON-RPC workers";
+}
+
+void JsonRPCServer::processMessage(TransportInterface *interface, const QUuid &clientId, const QByteArray &data)
+{
+    if (m_stopping.load())
+        return;
+
+    QJsonParseError error;
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
+
+    if(error.error != QJsonParseError::NoError) {
+        qCWarning(dcJsonRpc) << "Failed to parse JSON data" << data << ":" << error.errorString();
+        sendReply(interface, clientId, TransportInterface::createErrorResponse(-1, QString("Failed to parse JSON data: %1").arg(error.errorString())));
+        return;
+    }
+
+    QVariantMap message = jsonDoc.toVariant().toMap();
+
+    bool success;
+    int commandId = message.value("id").toInt(&success);
+    if (!success) {
+        qCWarning(dcJsonRpc) << "Error parsing command. Missing \"id\":" << message;
+        sendReply(interface, clientId, TransportInterface::createErrorResponse(commandId, "Error parsing command. Missing 'id'"));
+        return;
+    }
+
+    QStringList commandList = message.value("method").toString().split('.');
+    if (commandList.count() != 2) {
+        qCWarning(dcJsonRpc) << "Error parsing method.\nGot:" << message.value("method").toString() << "\nExpected: \"Namespace.method\"";
+        sendReply(interface, clientId, TransportInterface::createErrorResponse(commandId, QString("Error parsing method. Got: '%1'', Expected: 'Namespace.method'").arg(message.value("method").toString())));
+        return;
+    }
+
+    QString targetNamespace = commandList.first();
+    QString method = commandList.last();
+
+    JsonHandler *handler = m_handlers.value(targetNamespace);
+    if (!handler) {
+        sendReply(interface, clientId, TransportInterface::createErrorResponse(commandId, "No such namespace"));
+        return;
+    }
+    if (!handler->hasMethod(method)) {
+        sendReply(interface, clientId, TransportInterface::createErrorResponse(commandId, "No such method"));
+        return;
+    }
+
+    if (handler->isReadOnly(method)) {
+        processRequest(interface, clientId, targetNamespace, method, message);
+        return;
+    }
+
+    // Serialize the call onto the main thread, the next message of this client has to wait for it
+    m_mailbox->call([this, interface, clientId, targetNamespace, method, message]() {
+        if (m_stopping.load())
+            return;
+
+        processRequest(interface, clientId, targetNamespace, method, message);
+    });
 }
 
 void JsonRPCServer::processData(const QUuid &clientId, const QString &targetNamespace, const QString &method, const QVariantMap &message)
 {
-    TransportInterface *interface = qobject_cast<TransportInterface *>(sender());
+    processRequest(qobject_cast<TransportInterface *>(sender()), clientId, targetNamespace, method, message);
+}
 
-    // Note: id, targetNamespace and method already checked in TcpServer
+void JsonRPCServer::processRequest(TransportInterface *interface, const QUuid &clientId, const QString &targetNamespace, const QString &method, const QVariantMap &message)
+{
+    // Note: id, targetNamespace and method already checked in processMessage()
     int commandId = message.value("id").toInt();
     QVariantMap params = message.value("params").toMap();
 
     JsonHandler *handler = m_handlers.value(targetNamespace);
     QPair<bool, QString> validationResult = handler->validateParams(method, params);
     if (!validationResult.first) {
-        interface->sendErrorResponse(clientId, commandId, "Invalid params: " + validationResult.second);
+        sendReply(interface, clientId, TransportInterface::createErrorResponse(commandId, "Invalid params: " + validationResult.second));
         return;
     }
 
+    // the trace covers the handler and the encoding of the response
+    CallTrace trace("JSON-RPC", targetNamespace + "." + method);
+
     // Hack: attach clientId to handler to be able to handle the JSONRPC methods. Do not use this outside of jsonrpcserver
-    handler->setProperty("clientId", clientId);
+    if (!handler->isReadOnly(method))
+        handler->setProperty("clientId", clientId);
 
     JsonReply *reply;
-    QMetaObject::invokeMethod(handler, method.toLatin1().data(), Q_RETURN_ARG(JsonReply*, reply), Q_ARG(QVariantMap, params));
+    QMetaObject::invokeMethod(handler, method.toLatin1().data(), Qt::DirectConnection, Q_RETURN_ARG(JsonReply*, reply), Q_ARG(QVariantMap, params));
     if (reply->type() == JsonReply::TypeAsync) {
+        Q_ASSERT_X(QThread::currentThread() == thread(), "JsonRPCServer", "Read-only methods must reply synchronously.");
         m_asyncReplies.insert(reply, interface);
         reply->setClientId(clientId);
         reply->setCommandId(commandId);
@@ -207,11 +404,28 @@ void JsonRPCServer::processData(const QUuid &clientId, const QString &targetName
     } else {
         Q_ASSERT_X((targetNamespace == "JSONRPC" && method == "Introspect") || handler->validateReturns(method, reply->data()).first
                    ,"validating return value", formatAssertion(targetNamespace, method, handler, reply->data()).toLatin1().data());
-        interface->sendResponse(clientId, commandId, reply->data());
+        sendReply(interface, clientId, TransportInterface::createResponse(commandId, reply->data()));
         reply->deleteLater();
     }
 }
 
+void JsonRPCServer::sendReply(TransportInterface *interface, const QUuid &clientId, const QVariantMap &response)
+{
+    if (QThread::currentThread() == thread()) {
+        interface->sendData(clientId, response);
+        return;
+    }
+
+    // Encode on the worker, the transports write on the main thread
+    QByteArray payload = interface->encode(response);
+    m_mailbox->post([this, interface, clientId, payload]() {
+        if (m_stopping.load())
+            return;
+
+        interface->sendPayload(clientId, payload);
+    });
+}
+
 QString JsonRPCServer::formatAssertion(const QString &targetNamespace, const QString &method, JsonHandler *handler, const QVariantMap &data) const
 {
     QJsonDocument doc = QJsonDocument::fromVariant(handler->introspect(QMetaMethod::Method).value(targetNamespace + "." + method));
@@ -235,6 +449,8 @@ void JsonRPCServer::sendNotification(const QVariantMap &params)
     foreach (TransportInterface *interface, m_interfaces) {
         interface->sendData(m_clients.keys(true), notification);
     }
+
+    emit notificationReady(notification);
 }
 
 void JsonRPCServer::asyncReplyFinished()
@@ -29,11 +29,15 @@
 #include "types/action.h"
 #include "types/event.h"
 
+#include <QList>
 #include <QObject>
+#include <QThread>
 #include <QVariantMap>
 #include <QString>
+#include <QAtomicInt>
 
 class Device;
+class PluginMailbox;
 class QSslConfiguration;
 
 namespace guhserver {
@@ -43,17 +47,27 @@ class JsonRPCServer: public JsonHandler
     Q_OBJECT
 public:
     JsonRPCServer(const QSslConfiguration &sslConfiguration = QSslConfiguration(), QObject *parent = 0);
+    ~JsonRPCServer();
 
     // JsonHandler API implementation
     QString name() const;
     Q_INVOKABLE JsonReply *Introspect(const QVariantMap &params) const;
     Q_INVOKABLE JsonReply *Version(const QVariantMap &params) const;
     Q_INVOKABLE JsonReply *SetNotificationStatus(const QVariantMap &params);
+    Q_INVOKABLE JsonReply *GetStartupProfile(const QVariantMap &params) const;
 
     QHash<QString, JsonHandler *> handlers() const;
 
     void registerTransportInterface(TransportInterface *interface, const bool &enabled = true);
 
+    void dispatchMessage(TransportInterface *interface, const QUuid &clientId, const QByteArray &data);
+
+    int workerCount() const;
+    void stopWorkers();
+
+signals:
+    void notificationReady(const QVariantMap &notification);
+
 private slots:
     void setup();
 
@@ -76,7 +90,17 @@ private:
 
     int m_notificationId;
 
+    PluginMailbox *m_mailbox;
+    QList<QThread *> m_workers;
+    QList<PluginMailbox *> m_workerMailboxes;
+    QAtomicInt m_stopping;
+
     void registerHandler(JsonHandler *handler);
+    void startWorkers();
+
+    void processMessage(TransportInterface *interface, const QUuid &clientId, const QByteArray &data);
+    void processRequest(TransportInterface *interface, const QUuid &clientId, const QString &targetNamespace, const QString &method, const QVariantMap &message);
+    void sendReply(TransportInterface *interface, const QUuid &clientId, const QVariantMap &response);
     QString formatAssertion(const QString &targetNamespace, const QString &method, JsonHandler *handler, const QVariantMap &data) const;
 };
 
@@ -87,6 +87,7 @@ QVariantList JsonTypes::s_configurationError;
 QVariantList JsonTypes::s_networkManagerError;
 QVariantList JsonTypes::s_networkManagerState;
 QVariantList JsonTypes::s_networkDeviceState;
+QVariantList JsonTypes::s_metricType;
 
 QVariantMap JsonTypes::s_paramType;
 QVariantMap JsonTypes::s_param;
@@ -117,6 +118,12 @@ QVariantMap JsonTypes::s_repeatingOption;
 QVariantMap JsonTypes::s_wirelessAccessPoint;
 QVariantMap JsonTypes::s_wiredNetworkDevice;
 QVariantMap JsonTypes::s_wirelessNetworkDevice;
+QVariantMap JsonTypes::s_startupPhase;
+QVariantMap JsonTypes::s_metric;
+QVariantMap JsonTypes::s_metricBucket;
+QVariantMap JsonTypes::s_slowCall;
+QVariantMap JsonTypes::s_ruleStatistics;
+QVariantMap JsonTypes::s_simulatedRule;
 
 void JsonTypes::init()
 {
@@ -143,6 +150,7 @@ void JsonTypes::init()
     s_networkManagerError = enumToStrings(NetworkManager::staticMetaObject, "NetworkManagerError");
     s_networkManagerState = enumToStrings(NetworkManager::staticMetaObject, "NetworkManagerState");
     s_networkDeviceState = enumToStrings(NetworkDevice::staticMetaObject, "NetworkDeviceState");
+    s_metricType = enumToStrings(Metric::staticMetaObject, "MetricType");
 
     // ParamType
     s_paramType.insert("id", basicTypeToString(Uuid));
@@ -350,6 +358,48 @@ void JsonTypes::init()
     s_wirelessNetworkDevice.insert("bitRate", basicTypeToString(QVariant::String));
     s_wirelessNetworkDevice.insert("o:currentAccessPoint", wirelessAccessPointRef());
 
+    // StartupPhase
+    s_startupPhase.insert("name", basicTypeToString(QVariant::String));
+    s_startupPhase.insert("o:parent", basicTypeToString(QVariant::String));
+    s_startupPhase.insert("start", basicTypeToString(QVariant::Int));
+    s_startupPhase.insert("duration", basicTypeToString(QVariant::Int));
+
+    // Metric
+    s_metric.insert("name", basicTypeToString(String));
+    s_metric.insert("help", basicTypeToString(String));
+    s_metric.insert("type", metricTypeRef());
+    s_metric.insert("o:labelName", basicTypeToString(String));
+    s_metric.insert("o:labelValue", basicTypeToString(String));
+    s_metric.insert("o:value", basicTypeToString(Int));
+    s_metric.insert("o:count", basicTypeToString(Int));
+    s_metric.insert("o:sum", basicTypeToString(Int));
+    s_metric.insert("o:buckets", QVariantList() << metricBucketRef());
+
+    // MetricBucket
+    s_metricBucket.insert("o:upperBound", basicTypeToString(Int));
+    s_metricBucket.insert("count", basicTypeToString(Int));
+
+    // SlowCall
+    s_slowCall.insert("site", basicTypeToString(String));
+    s_slowCall.insert("context", QVariantList() << basicTypeToString(String));
+    s_slowCall.insert("duration", basicTypeToString(Int));
+    s_slowCall.insert("timestamp", basicTypeToString(Int));
+
+    // RuleStatistics
+    s_ruleStatistics.insert("ruleId", basicTypeToString(Uuid));
+    s_ruleStatistics.insert("evaluations", basicTypeToString(Int));
+    s_ruleStatistics.insert("matches", basicTypeToString(Int));
+    s_ruleStatistics.insert("activations", basicTypeToString(Int));
+    s_ruleStatistics.insert("actions", basicTypeToString(Int));
+    s_ruleStatistics.insert("totalTime", basicTypeToString(Int));
+    s_ruleStatistics.insert("maxTime", basicTypeToString(Int));
+
+    // SimulatedRule
+    s_simulatedRule.insert("ruleId", basicTypeToString(Uuid));
+    s_simulatedRule.insert("name", basicTypeToString(String));
+    s_simulatedRule.insert("o:active", basicTypeToString(Bool));
+    s_simulatedRule.insert("actions", QVariantList() << ruleActionRef());
+
     s_initialized = true;
 }
 
@@ -398,6 +448,7 @@ QVariantMap JsonTypes::allTypes()
     allTypes.insert("NetworkManagerError", networkManagerError());
     allTypes.insert("NetworkManagerState", networkManagerState());
     allTypes.insert("NetworkDeviceState", networkDeviceState());
+    allTypes.insert("MetricType", metricType());
 
     allTypes.insert("StateType", stateTypeDescription());
     allTypes.insert("StateDescriptor", stateDescriptorDescription());
@@ -427,6 +478,12 @@ QVariantMap JsonTypes::allTypes()
     allTypes.insert("WirelessAccessPoint", wirelessAccessPointDescription());
     allTypes.insert("WiredNetworkDevice", wiredNetworkDeviceDescription());
     allTypes.insert("WirelessNetworkDevice", wirelessNetworkDeviceDescription());
+    allTypes.insert("StartupPhase", startupPhaseDescription());
+    allTypes.insert("Metric", metricDescription());
+    allTypes.insert("MetricBucket", metricBucketDescription());
+    allTypes.insert("SlowCall", slowCallDescription());
+    allTypes.insert("RuleStatistics", ruleStatisticsDescription());
+    allTypes.insert("SimulatedRule", simulatedRuleDescription());
 
     return allTypes;
 }
@@ -1011,6 +1068,115 @@ QVariantMap JsonTypes::packWirelessNetworkDevice(WirelessNetworkDevice *networkD
     return networkDeviceVariant;
 }
 
+/*! Returns a variant map of the given startup \a phase. */
+QVariantMap JsonTypes::packStartupPhase(const StartupProfiler::Phase &phase)
+{
+    QVariantMap phaseVariant;
+    phaseVariant.insert("name", phase.name);
+    if (!phase.parent.isEmpty())
+        phaseVariant.insert("parent", phase.parent);
+
+    phaseVariant.insert("start", phase.start);
+    phaseVariant.insert("duration", phase.duration);
+    return phaseVariant;
+}
+
+/*! Returns a variant map with the current values of the given \a metric. The last bucket of a
+ *  histogram has no upper bound and counts all observations. */
+QVariantMap JsonTypes::packMetric(Metric *metric)
+{
+    QVariantMap metricVariant;
+    metricVariant.insert("name", metric->name());
+    metricVariant.insert("help", metric->help());
+    metricVariant.insert("type", s_metricType.at(metric->type()));
+    if (!metric->labelName().isEmpty()) {
+        metricVariant.insert("labelName", metric->labelName());
+        metricVariant.insert("labelValue", metric->labelValue());
+    }
+
+    switch (metric->type()) {
+    case Metric::MetricTypeCounter:
+        metricVariant.insert("value", static_cast<MetricCounter *>(metric)->value());
+        break;
+    case Metric::MetricTypeGauge:
+        metricVariant.insert("value", static_cast<MetricGauge *>(metric)->value());
+        break;
+    case Metric::MetricTypeHistogram: {
+        MetricHistogram *histogram = static_cast<MetricHistogram *>(metric);
+        QList<qint64> bounds = histogram->bounds();
+        QList<qint64> bucketCounts = histogram->bucketCounts();
+        QVariantList buckets;
+        for (int i = 0; i < bucketCounts.count(); i++) {
+            QVariantMap bucket;
+            if (i < bounds.count())
+                bucket.insert("upperBound", bounds.at(i));
+
+            bucket.insert("count", bucketCounts.at(i));
+            buckets.append(bucket);
+        }
+        metricVariant.insert("count", histogram->count());
+        metricVariant.insert("sum", histogram->sum());
+        metricVariant.insert("buckets", buckets);
+        break;
+    }
+    }
+    return metricVariant;
+}
+
+/*! Returns a variant map of the given slow call or stall \a record. */
+QVariantMap JsonTypes::packSlowCall(const CallTrace::Record &record)
+{
+    QVariantMap slowCall;
+    slowCall.insert("site", record.site);
+    slowCall.insert("context", record.context);
+    slowCall.insert("duration", record.duration);
+    slowCall.insert("timestamp", record.timestamp.toMSecsSinceEpoch());
+    return slowCall;
+}
+
+/*! Returns a variant map of the given runtime \a statistics of the \l{Rule} with the given \a ruleId.
+    The evaluation times are given in microseconds.
+*/
+QVariantMap JsonTypes::packRuleStatistics(const RuleId &ruleId, const RuleEngine::Statistics &statistics)
+{
+    QVariantMap ruleStatistics;
+    ruleStatistics.insert("ruleId", ruleId.toString());
+    ruleStatistics.insert("evaluations", statistics.evaluations);
+    ruleStatistics.insert("matches", statistics.matches);
+    ruleStatistics.insert("activations", statistics.activations);
+    ruleStatistics.insert("actions", statistics.actions);
+    ruleStatistics.insert("totalTime", statistics.totalTime / 1000);
+    ruleStatistics.insert("maxTime", statistics.maxTime / 1000);
+    return ruleStatistics;
+}
+
+/*! Returns a variant map of the given \a rule as returned by \l{RuleEngine::simulateEvent()} for the
+    given \a event, containing the \l{RuleAction}{RuleActions} which would be executed.
+*/
+QVariantMap JsonTypes::packSimulatedRule(const Rule &rule, const Event &event)
+{
+    QVariantMap simulatedRule;
+    simulatedRule.insert("ruleId", rule.id().toString());
+    simulatedRule.insert("name", rule.name());
+
+    QVariantList actions;
+    if (rule.eventDescriptors().isEmpty()) {
+        simulatedRule.insert("active", rule.active());
+        foreach (const RuleAction &ruleAction, rule.active() ? rule.actions() : rule.exitActions())
+            actions.append(packRuleAction(ruleAction));
+    } else {
+        foreach (const RuleAction &ruleAction, rule.actions()) {
+            if (ruleAction.isEventBased()) {
+                actions.append(packRuleAction(RuleEngine::takeOverEventParams(ruleAction, event)));
+            } else {
+                actions.append(packRuleAction(ruleAction));
+            }
+        }
+    }
+    simulatedRule.insert("actions", actions);
+    return simulatedRule;
+}
+
 /*! Returns a variant list of the supported vendors. */
 QVariantList JsonTypes::packSupportedVendors()
 {
@@ -1041,6 +1207,44 @@ QVariantList JsonTypes::packConfiguredDevices()
     return configuredDeviceList;
 }
 
+/*! Returns a variant map with the configured devices which changed after the given \a sequence and the ids
+ *  of the removed devices. If the change journal does not reach back to the given \a sequence, all configured
+ *  devices will be returned and \tt resyncRequired is true.
+ */
+QVariantMap JsonTypes::packDeviceChanges(const qint64 &sequence)
+{
+    const ChangeJournal &journal = GuhCore::instance()->deviceManager()->changeJournal();
+
+    QVariantMap changes;
+    changes.insert("sequence", journal.sequence());
+
+    QList<ChangeJournal::Change> journalChanges;
+    if (!journal.changesSince(sequence, &journalChanges)) {
+        changes.insert("resyncRequired", true);
+        changes.insert("devices", packConfiguredDevices());
+        changes.insert("removedDeviceIds", QVariantList());
+        return changes;
+    }
+
+    QVariantList devices;
+    QVariantList removedDeviceIds;
+    foreach (const ChangeJournal::Change &change, journalChanges) {
+        if (change.type == ChangeJournal::ChangeTypeRemoved) {
+            removedDeviceIds.append(change.id);
+            continue;
+        }
+
+        Device *device = GuhCore::instance()->deviceManager()->findConfiguredDevice(DeviceId::fromUuid(change.id));
+        if (device)
+            devices.append(packDevice(device));
+    }
+
+    changes.insert("resyncRequired", false);
+    changes.insert("devices", devices);
+    changes.insert("removedDeviceIds", removedDeviceIds);
+    return changes;
+}
+
 /*! Returns a variant list of States from the given \a device. */
 QVariantList JsonTypes::packDeviceStates(Device *device)
 {
@@ -1077,6 +1281,43 @@ QVariantMap JsonTypes::packBasicConfiguration()
     return basicConfiguration;
 }
 
+/*! Returns a variant map with the phases and the critical path of the server startup. */
+QVariantMap JsonTypes::packStartupProfile()
+{
+    QVariantList phases;
+    foreach (const StartupProfiler::Phase &phase, StartupProfiler::phases())
+        phases.append(packStartupPhase(phase));
+
+    QVariantList criticalPath;
+    foreach (const StartupProfiler::Phase &phase, StartupProfiler::criticalPath())
+        criticalPath.append(packStartupPhase(phase));
+
+    QVariantMap startupProfile;
+    startupProfile.insert("finished", StartupProfiler::isFinished());
+    startupProfile.insert("bootTime", StartupProfiler::bootTime());
+    startupProfile.insert("phases", phases);
+    startupProfile.insert("criticalPath", criticalPath);
+    return startupProfile;
+}
+
+/*! Returns a variant list with all registered \l{Metric}{Metrics}. */
+QVariantList JsonTypes::packMetrics()
+{
+    QVariantList metrics;
+    foreach (Metric *metric, Metrics::metrics())
+        metrics.append(packMetric(metric));
+    return metrics;
+}
+
+/*! Returns a variant list of the given slow call or stall \a records. */
+QVariantList JsonTypes::packSlowCalls(const QList<CallTrace::Record> &records)
+{
+    QVariantList slowCalls;
+    foreach (const CallTrace::Record &record, records)
+        slowCalls.append(packSlowCall(record));
+    return slowCalls;
+}
+
 /*! Returns a variant map with the current tcp configuration of the server. */
 QVariantMap JsonTypes::packTcpServerConfiguration()
 {
@@ -1124,6 +1365,44 @@ QVariantList JsonTypes::packRuleDescriptions(const QList<Rule> &rules)
     return rulesList;
 }
 
+/*! Returns a variant map with the descriptions of the rules which changed after the given \a sequence and the
+ *  ids of the removed rules. If the change journal does not reach back to the given \a sequence, all rule
+ *  descriptions will be returned and \tt resyncRequired is true.
+ */
+QVariantMap JsonTypes::packRuleChanges(const qint64 &sequence)
+{
+    const ChangeJournal &journal = GuhCore::instance()->ruleEngine()->changeJournal();
+
+    QVariantMap changes;
+    changes.insert("sequence", journal.sequence());
+
+    QList<ChangeJournal::Change> journalChanges;
+    if (!journal.changesSince(sequence, &journalChanges)) {
+        changes.insert("resyncRequired", true);
+        changes.insert("ruleDescriptions", packRuleDescriptions());
+        changes.insert("removedRuleIds", QVariantList());
+        return changes;
+    }
+
+    QVariantList ruleDescriptions;
+    QVariantList removedRuleIds;
+    foreach (const ChangeJournal::Change &change, journalChanges) {
+        if (change.type == ChangeJournal::ChangeTypeRemoved) {
+            removedRuleIds.append(change.id);
+            continue;
+        }
+
+        Rule rule = GuhCore::instance()->ruleEngine()->findRule(RuleId::fromUuid(change.id));
+        if (!rule.id().isNull())
+            ruleDescriptions.append(packRuleDescription(rule));
+    }
+
+    changes.insert("resyncRequired", false);
+    changes.insert("ruleDescriptions", ruleDescriptions);
+    changes.insert("removedRuleIds", removedRuleIds);
+    return changes;
+}
+
 /*! Returns a variant list of action types for the given \a deviceClass. */
 QVariantList JsonTypes::packActionTypes(const DeviceClass &deviceClass)
 {
@@ -1792,6 +2071,42 @@ QPair<bool, QString> JsonTypes::validateVariant(const QVariant &templateVariant,
                     qCWarning(dcJsonRpc) << "WirelessNetworkDevice not matching";
                     return result;
                 }
+            } else if (refName == startupPhaseRef()) {
+                QPair<bool, QString> result = validateMap(startupPhaseDescription(), variant.toMap());
+                if (!result.first) {
+                    qCWarning(dcJsonRpc) << "StartupPhase not matching";
+                    return result;
+                }
+            } else if (refName == metricRef()) {
+                QPair<bool, QString> result = validateMap(metricDescription(), variant.toMap());
+                if (!result.first) {
+                    qCWarning(dcJsonRpc) << "Metric not matching";
+                    return result;
+                }
+            } else if (refName == metricBucketRef()) {
+                QPair<bool, QString> result = validateMap(metricBucketDescription(), variant.toMap());
+                if (!result.first) {
+                    qCWarning(dcJsonRpc) << "MetricBucket not matching";
+                    return result;
+                }
+            } else if (refName == slowCallRef()) {
+                QPair<bool, QString> result = validateMap(slowCallDescription(), variant.toMap());
+                if (!result.first) {
+                    qCWarning(dcJsonRpc) << "SlowCall not matching";
+                    return result;
+                }
+            } else if (refName == ruleStatisticsRef()) {
+                QPair<bool, QString> result = validateMap(ruleStatisticsDescription(), variant.toMap());
+                if (!result.first) {
+                    qCWarning(dcJsonRpc) << "RuleStatistics not matching";
+                    return result;
+                }
+            } else if (refName == simulatedRuleRef()) {
+                QPair<bool, QString> result = validateMap(simulatedRuleDescription(), variant.toMap());
+                if (!result.first) {
+                    qCWarning(dcJsonRpc) << "SimulatedRule not matching";
+                    return result;
+                }
             } else if (refName == basicTypeRef()) {
                 QPair<bool, QString> result = validateBasicType(variant);
                 if (!result.first) {
@@ -1924,6 +2239,12 @@ QPair<bool, QString> JsonTypes::validateVariant(const QVariant &templateVariant,
                     qCWarning(dcJsonRpc) << QString("Value %1 not allowed in %2").arg(variant.toString()).arg(networkDeviceStateRef());
                     return result;
                 }
+            } else if (refName == metricTypeRef()) {
+                QPair<bool, QString> result = validateEnum(s_metricType, variant);
+                if (!result.first) {
+                    qCWarning(dcJsonRpc) << QString("Value %1 not allowed in %2").arg(variant.toString()).arg(metricTypeRef());
+                    return result;
+                }
             } else {
                 Q_ASSERT_X(false, "JsonTypes", QString("Unhandled ref: %1").arg(refName).toLatin1().data());
                 return report(false, QString("Unhandled ref %1. Server implementation incomplete.").arg(refName));
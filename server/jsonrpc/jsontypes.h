@@ -28,6 +28,9 @@
 #include "devicemanager.h"
 #include "ruleengine.h"
 #include "guhconfiguration.h"
+#include "startupprofiler.h"
+#include "metrics.h"
+#include "calltrace.h"
 
 #include "types/event.h"
 #include "types/action.h"
@@ -136,6 +139,7 @@ public:
     DECLARE_TYPE(networkManagerError, "NetworkManagerError", NetworkManager, NetworkManagerError)
     DECLARE_TYPE(networkManagerState, "NetworkManagerState", NetworkManager, NetworkManagerState)
     DECLARE_TYPE(networkDeviceState, "NetworkDeviceState", NetworkDevice, NetworkDeviceState)
+    DECLARE_TYPE(metricType, "MetricType", Metric, MetricType)
 
     DECLARE_OBJECT(paramType, "ParamType")
     DECLARE_OBJECT(param, "Param")
@@ -166,6 +170,12 @@ public:
     DECLARE_OBJECT(wirelessAccessPoint, "WirelessAccessPoint")
     DECLARE_OBJECT(wiredNetworkDevice, "WiredNetworkDevice")
     DECLARE_OBJECT(wirelessNetworkDevice, "WirelessNetworkDevice")
+    DECLARE_OBJECT(startupPhase, "StartupPhase")
+    DECLARE_OBJECT(metric, "Metric")
+    DECLARE_OBJECT(metricBucket, "MetricBucket")
+    DECLARE_OBJECT(slowCall, "SlowCall")
+    DECLARE_OBJECT(ruleStatistics, "RuleStatistics")
+    DECLARE_OBJECT(simulatedRule, "SimulatedRule")
 
     // pack types
     static QVariantMap packEventType(const EventType &eventType);
@@ -197,6 +207,11 @@ public:
     static QVariantMap packWirelessAccessPoint(WirelessAccessPoint *wirelessAccessPoint);
     static QVariantMap packWiredNetworkDevice(WiredNetworkDevice *networkDevice);
     static QVariantMap packWirelessNetworkDevice(WirelessNetworkDevice *networkDevice);
+    static QVariantMap packStartupPhase(const StartupProfiler::Phase &phase);
+    static QVariantMap packMetric(Metric *metric);
+    static QVariantMap packSlowCall(const CallTrace::Record &record);
+    static QVariantMap packRuleStatistics(const RuleId &ruleId, const RuleEngine::Statistics &statistics);
+    static QVariantMap packSimulatedRule(const Rule &rule, const Event &event);
 
     // pack resources
     static QVariantList packRules(const QList<Rule> rules);
@@ -204,6 +219,7 @@ public:
     static QVariantList packSupportedVendors();
     static QVariantList packSupportedDevices(const VendorId &vendorId);
     static QVariantList packConfiguredDevices();
+    static QVariantMap packDeviceChanges(const qint64 &sequence);
     static QVariantList packDeviceStates(Device *device);
     static QVariantList packDeviceDescriptors(const QList<DeviceDescriptor> deviceDescriptors);
 
@@ -211,9 +227,13 @@ public:
     static QVariantMap packTcpServerConfiguration();
     static QVariantMap packWebServerConfiguration();
     static QVariantMap packWebSocketServerConfiguration();
+    static QVariantMap packStartupProfile();
+    static QVariantList packMetrics();
+    static QVariantList packSlowCalls(const QList<CallTrace::Record> &records);
 
     static QVariantList packRuleDescriptions();
     static QVariantList packRuleDescriptions(const QList<Rule> &rules);
+    static QVariantMap packRuleChanges(const qint64 &sequence);
 
     static QVariantList packActionTypes(const DeviceClass &deviceClass);
     static QVariantList packStateTypes(const DeviceClass &deviceClass);
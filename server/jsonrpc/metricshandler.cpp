@@ -0,0 +1,93 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class guhserver::MetricsHandler
+    \brief This subclass of \l{JsonHandler} processes the JSON requests for the \tt Metrics namespace of the JSON-RPC API.
+
+    \ingroup json
+    \inmodule core
+
+    This \l{JsonHandler} will be created in the \l{JsonRPCServer} and used to handle JSON-RPC requests
+    for the \tt {Metrics} namespace of the API. The same values can be scraped in the Prometheus text
+    format from the \tt /metrics path of the \l{WebServer}.
+
+    \sa Metrics, CallTrace, StallWatchdog, JsonHandler, JsonRPCServer
+*/
+
+#include "metricshandler.h"
+#include "metrics.h"
+#include "calltrace.h"
+#include "guhcore.h"
+#include "stallwatchdog.h"
+
+namespace guhserver {
+
+/*! Constructs a new \l{MetricsHandler} with the given \a parent. */
+MetricsHandler::MetricsHandler(QObject *parent) :
+    JsonHandler(parent)
+{
+    QVariantMap params;
+    QVariantMap returns;
+
+    params.clear(); returns.clear();
+    setDescription("GetMetrics", "Get the current values of all runtime counters, gauges and histograms of the server. "
+                   "Durations are given in microseconds. The last bucket of a histogram has no upperBound and contains "
+                   "all observations, the bucket counts are cumulative.");
+    setParams("GetMetrics", params);
+    returns.insert("metrics", QVariantList() << JsonTypes::metricRef());
+    setReturns("GetMetrics", returns);
+
+    params.clear(); returns.clear();
+    setDescription("GetSlowCalls", "Get the slowest calls into plugins, handlers and engines and the longest stalls of the "
+                   "event loop, the slowest one first. The durations are given in milliseconds, the context lists the active "
+                   "call sites starting with the outermost one.");
+    setParams("GetSlowCalls", params);
+    returns.insert("slowCalls", QVariantList() << JsonTypes::slowCallRef());
+    returns.insert("stalls", QVariantList() << JsonTypes::slowCallRef());
+    setReturns("GetSlowCalls", returns);
+}
+
+/*! Returns the name of the \l{MetricsHandler}. In this case \b Metrics.*/
+QString MetricsHandler::name() const
+{
+    return "Metrics";
+}
+
+JsonReply *MetricsHandler::GetMetrics(const QVariantMap &params) const
+{
+    Q_UNUSED(params)
+
+    QVariantMap returns;
+    returns.insert("metrics", JsonTypes::packMetrics());
+    return createReply(returns);
+}
+
+JsonReply *MetricsHandler::GetSlowCalls(const QVariantMap &params) const
+{
+    Q_UNUSED(params)
+
+    QVariantMap returns;
+    returns.insert("slowCalls", JsonTypes::packSlowCalls(CallTrace::slowestCalls()));
+    returns.insert("stalls", JsonTypes::packSlowCalls(GuhCore::instance()->stallWatchdog()->stalls()));
+    return createReply(returns);
+}
+
+}
@@ -0,0 +1,42 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef METRICSHANDLER_H
+#define METRICSHANDLER_H
+
+#include "jsonhandler.h"
+
+namespace guhserver {
+
+class MetricsHandler : public JsonHandler
+{
+    Q_OBJECT
+public:
+    explicit MetricsHandler(QObject *parent = 0);
+    QString name() const override;
+
+    Q_INVOKABLE JsonReply *GetMetrics(const QVariantMap &params) const;
+    Q_INVOKABLE JsonReply *GetSlowCalls(const QVariantMap &params) const;
+
+};
+
+}
+
+#endif // METRICSHANDLER_H
@@ -54,6 +54,9 @@
 
 #include "ruleshandler.h"
 #include "guhcore.h"
+#include "readmodel.h"
+#include "devicemanager.h"
+#include "plugin/device.h"
 #include "ruleengine.h"
 #include "loggingcategories.h"
 
@@ -74,6 +77,20 @@ RulesHandler::RulesHandler(QObject *parent) :
     setParams("GetRules", params);
     returns.insert("ruleDescriptions", QVariantList() << JsonTypes::ruleDescriptionRef());
     setReturns("GetRules", returns);
+    setReadOnly("GetRules");
+
+    params.clear(); returns.clear();
+    setDescription("GetChangesSince", "Get the descriptions of the rules which were added, edited or changed their active state "
+                   "after the given sequence and the ids of the removed rules. Pass the returned sequence with the next call. "
+                   "If the changes since the given sequence are not known any more, resyncRequired is true and "
+                   "ruleDescriptions contains all rules.");
+    params.insert("sequence", JsonTypes::basicTypeToString(JsonTypes::Int));
+    setParams("GetChangesSince", params);
+    returns.insert("sequence", JsonTypes::basicTypeToString(JsonTypes::Int));
+    returns.insert("resyncRequired", JsonTypes::basicTypeToString(JsonTypes::Bool));
+    returns.insert("ruleDescriptions", QVariantList() << JsonTypes::ruleDescriptionRef());
+    returns.insert("removedRuleIds", QVariantList() << JsonTypes::basicTypeToString(JsonTypes::Uuid));
+    setReturns("GetChangesSince", returns);
 
     params.clear(); returns.clear();
     setDescription("GetRuleDetails", "Get details for the rule identified by ruleId");
@@ -82,6 +99,7 @@ RulesHandler::RulesHandler(QObject *parent) :
     returns.insert("o:rule", JsonTypes::ruleRef());
     returns.insert("ruleError", JsonTypes::ruleErrorRef());
     setReturns("GetRuleDetails", returns);
+    setReadOnly("GetRuleDetails");
 
     params.clear(); returns.clear();
     setDescription("AddRule", "Add a rule. You can describe rules by one or many EventDesciptors and a StateEvaluator. Note that only "
@@ -163,6 +181,35 @@ RulesHandler::RulesHandler(QObject *parent) :
     returns.insert("ruleError", JsonTypes::ruleErrorRef());
     setReturns("ExecuteExitActions", returns);
 
+    params.clear(); returns.clear();
+    setDescription("GetRuleStatistics", "Get the runtime statistics of the rule with the given ruleId, or of all rules if no ruleId "
+                   "is given. The statistics count how often a rule has been evaluated, how often its events or states matched, "
+                   "how often it triggered or entered its active state and how many actions it has issued. The evaluation "
+                   "times are given in microseconds. The statistics are kept in memory only.");
+    params.insert("o:ruleId", JsonTypes::basicTypeToString(JsonTypes::Uuid));
+    setParams("GetRuleStatistics", params);
+    returns.insert("o:ruleStatistics", QVariantList() << JsonTypes::ruleStatisticsRef());
+    returns.insert("ruleError", JsonTypes::ruleErrorRef());
+    setReturns("GetRuleStatistics", returns);
+
+    params.clear(); returns.clear();
+    setDescription("ResetRuleStatistics", "Reset the runtime statistics of all rules.");
+    setParams("ResetRuleStatistics", params);
+    returns.insert("ruleError", JsonTypes::ruleErrorRef());
+    setReturns("ResetRuleStatistics", returns);
+
+    params.clear(); returns.clear();
+    setDescription("Simulate", "Evaluate all rules against a hypothetical event or state change without executing anything. "
+                   "Exactly one of event or state has to be given. A state is evaluated as if the device state changed "
+                   "to the given value. Returns the rules which would be triggered or change their active state and the "
+                   "actions they would execute. The active state of the rules and the rule statistics stay untouched.");
+    params.insert("o:event", JsonTypes::eventRef());
+    params.insert("o:state", JsonTypes::stateRef());
+    setParams("Simulate", params);
+    returns.insert("o:simulatedRules", QVariantList() << JsonTypes::simulatedRuleRef());
+    returns.insert("ruleError", JsonTypes::ruleErrorRef());
+    setReturns("Simulate", returns);
+
     // Notifications
     params.clear(); returns.clear();
     setDescription("RuleRemoved", "Emitted whenever a Rule was removed.");
@@ -201,21 +248,33 @@ JsonReply* RulesHandler::GetRules(const QVariantMap &params)
 {
     Q_UNUSED(params)
 
+    QSharedPointer<const ReadModel::Snapshot> snapshot = GuhCore::instance()->readModel()->snapshot();
+
+    QVariantList ruleDescriptions;
+    foreach (const RuleId &ruleId, snapshot->ruleIds)
+        ruleDescriptions.append(snapshot->ruleDescriptions.value(ruleId));
+
     QVariantMap returns;
-    returns.insert("ruleDescriptions", JsonTypes::packRuleDescriptions());
+    returns.insert("ruleDescriptions", ruleDescriptions);
 
     return createReply(returns);
 }
 
+JsonReply *RulesHandler::GetChangesSince(const QVariantMap &params)
+{
+    return createReply(JsonTypes::packRuleChanges(params.value("sequence").toLongLong()));
+}
+
 JsonReply *RulesHandler::GetRuleDetails(const QVariantMap &params)
 {
+    QSharedPointer<const ReadModel::Snapshot> snapshot = GuhCore::instance()->readModel()->snapshot();
+
     RuleId ruleId = RuleId(params.value("ruleId").toString());
-    Rule rule = GuhCore::instance()->ruleEngine()->findRule(ruleId);
-    if (rule.id().isNull()) {
+    if (!snapshot->rules.contains(ruleId)) {
         return createReply(statusToReply(RuleEngine::RuleErrorRuleNotFound));
     }
     QVariantMap returns = statusToReply(RuleEngine::RuleErrorNoError);
-    returns.insert("rule", JsonTypes::packRule(rule));
+    returns.insert("rule", snapshot->rules.value(ruleId));
     return createReply(returns);
 }
 
@@ -297,6 +356,81 @@ JsonReply *RulesHandler::ExecuteExitActions(const QVariantMap &params)
     return createReply(returns);
 }
 
+JsonReply *RulesHandler::GetRuleStatistics(const QVariantMap &params)
+{
+    RuleEngine *ruleEngine = GuhCore::instance()->ruleEngine();
+
+    QList<RuleId> ruleIds = ruleEngine->ruleIds();
+    if (params.contains("ruleId")) {
+        RuleId ruleId(params.value("ruleId").toString());
+        if (!ruleIds.contains(ruleId))
+            return createReply(statusToReply(RuleEngine::RuleErrorRuleNotFound));
+
+        ruleIds = QList<RuleId>() << ruleId;
+    }
+
+    QVariantList ruleStatistics;
+    foreach (const RuleId &ruleId, ruleIds)
+        ruleStatistics.append(JsonTypes::packRuleStatistics(ruleId, ruleEngine->statistics(ruleId)));
+
+    QVariantMap returns = statusToReply(RuleEngine::RuleErrorNoError);
+    returns.insert("ruleStatistics", ruleStatistics);
+    return createReply(returns);
+}
+
+JsonReply *RulesHandler::ResetRuleStatistics(const QVariantMap &params)
+{
+    Q_UNUSED(params)
+
+    GuhCore::instance()->ruleEngine()->resetStatistics();
+    return createReply(statusToReply(RuleEngine::RuleErrorNoError));
+}
+
+JsonReply *RulesHandler::Simulate(const QVariantMap &params)
+{
+    if (params.contains("event") == params.contains("state"))
+        return createReply(statusToReply(RuleEngine::RuleErrorInvalidParameter));
+
+    QList<State> assumedStates;
+    Event event;
+    if (params.contains("event")) {
+        QVariantMap eventMap = params.value("event").toMap();
+        event = Event(EventTypeId(eventMap.value("eventTypeId").toString()),
+                      DeviceId(eventMap.value("deviceId").toString()),
+                      JsonTypes::unpackParams(eventMap.value("params").toList()));
+    } else {
+        // Simulate the state change event the DeviceManager would emit
+        QVariantMap stateMap = params.value("state").toMap();
+        StateTypeId stateTypeId(stateMap.value("stateTypeId").toString());
+        State state(stateTypeId, DeviceId(stateMap.value("deviceId").toString()));
+        state.setValue(stateMap.value("value"));
+        assumedStates.append(state);
+
+        Param valueParam(ParamTypeId(stateTypeId.toString()), state.value());
+        event = Event(EventTypeId(stateTypeId.toString()), state.deviceId(), ParamList() << valueParam, true);
+    }
+
+    Device *device = GuhCore::instance()->deviceManager()->findConfiguredDevice(event.deviceId());
+    if (!device)
+        return createReply(statusToReply(RuleEngine::RuleErrorDeviceNotFound));
+
+    DeviceClass deviceClass = GuhCore::instance()->deviceManager()->findDeviceClass(device->deviceClassId());
+    if (event.isStateChangeEvent()) {
+        if (!deviceClass.hasStateType(StateTypeId(event.eventTypeId().toString())))
+            return createReply(statusToReply(RuleEngine::RuleErrorStateTypeNotFound));
+    } else if (!deviceClass.hasEventType(event.eventTypeId())) {
+        return createReply(statusToReply(RuleEngine::RuleErrorEventTypeNotFound));
+    }
+
+    QVariantList simulatedRules;
+    foreach (const Rule &rule, GuhCore::instance()->ruleEngine()->simulateEvent(event, assumedStates))
+        simulatedRules.append(JsonTypes::packSimulatedRule(rule, event));
+
+    QVariantMap returns = statusToReply(RuleEngine::RuleErrorNoError);
+    returns.insert("simulatedRules", simulatedRules);
+    return createReply(returns);
+}
+
 void RulesHandler::ruleRemovedNotification(const RuleId &ruleId)
 {
     QVariantMap params;
@@ -35,6 +35,7 @@ public:
     QString name() const override;
 
     Q_INVOKABLE JsonReply *GetRules(const QVariantMap &params);
+    Q_INVOKABLE JsonReply *GetChangesSince(const QVariantMap &params);
     Q_INVOKABLE JsonReply *GetRuleDetails(const QVariantMap &params);
 
     Q_INVOKABLE JsonReply *AddRule(const QVariantMap &params);
@@ -48,6 +49,10 @@ public:
     Q_INVOKABLE JsonReply *ExecuteActions(const QVariantMap &params);
     Q_INVOKABLE JsonReply *ExecuteExitActions(const QVariantMap &params);
 
+    Q_INVOKABLE JsonReply *GetRuleStatistics(const QVariantMap &params);
+    Q_INVOKABLE JsonReply *ResetRuleStatistics(const QVariantMap &params);
+    Q_INVOKABLE JsonReply *Simulate(const QVariantMap &params);
+
 signals:
     void RuleRemoved(const QVariantMap &params);
     void RuleAdded(const QVariantMap &params);
@@ -113,6 +113,7 @@
 #include "guhsettings.h"
 #include "logengine.h"
 #include "loggingcategories.h"
+#include "calltrace.h"
 #include "logging.h"
 
 #include <QCoreApplication>
@@ -123,6 +124,7 @@
 #include <QSqlError>
 #include <QMetaEnum>
 #include <QDateTime>
+#include <QElapsedTimer>
 
 #define DB_SCHEMA_VERSION 2
 
@@ -136,6 +138,9 @@ LogEngine::LogEngine(QObject *parent):
     m_db.setDatabaseName(GuhSettings::logPath());
     m_dbMaxSize = 20000;
 
+    m_insertMetric = Metrics::histogram("guh_log_insert_duration_microseconds", "Duration of writing a log entry into the database.", Metrics::durationBounds());
+    m_entriesMetric = Metrics::gauge("guh_log_entries", "Number of entries in the log database.");
+
     if (QCoreApplication::instance()->organizationName() == "guh-test") {
         m_dbMaxSize = 20;
         qCDebug(dcLogEngine) << "Set logging dab max size to" << m_dbMaxSize << "for testing.";
@@ -213,6 +218,8 @@ void LogEngine::clearDatabase()
     QString queryDeleteString = QString("DELETE FROM entries;");
     if (!query.exec(queryDeleteString)) {
         qCWarning(dcLogEngine) << "Could not clear logging database. Driver error:" << query.lastError().driverText() << "Database error:" << query.lastError().databaseText();
+    } else {
+        m_entriesMetric->set(0);
     }
 
     emit logDatabaseUpdated();
@@ -333,6 +340,10 @@ void LogEngine::removeRuleLogs(const RuleId &ruleId)
 
 void LogEngine::appendLogEntry(const LogEntry &entry)
 {
+    CallTrace trace("LogEngine", "appendLogEntry");
+    QElapsedTimer timer;
+    timer.start();
+
     checkDBSize();
     QString queryString = QString("INSERT INTO entries (timestamp, loggingEventType, loggingLevel, sourceType, typeId, deviceId, value, active, errorCode) values ('%1', '%2', '%3', '%4', '%5', '%6', '%7', '%8', '%9');")
             .arg(entry.timestamp().toTime_t())
@@ -346,12 +357,15 @@ void LogEngine::appendLogEntry(const LogEntry &entry)
             .arg(entry.errorCode());
 
     QSqlQuery query;
-    if (!query.exec(queryString)) {
+    bool success = query.exec(queryString);
+    m_insertMetric->observe(timer.nsecsElapsed() / 1000);
+    if (!success) {
         qCWarning(dcLogEngine) << "Error writing log entry. Driver error:" << query.lastError().driverText() << "Database error:" << query.lastError().databaseText();
         qCWarning(dcLogEngine) << entry;
         return;
     }
 
+    m_entriesMetric->increment();
     emit logEntryAdded(entry);
 }
 
@@ -368,6 +382,7 @@ void LogEngine::checkDBSize()
         query.last();
         numRows = query.at() + 1;
     }
+    m_entriesMetric->set(numRows);
 
     if (numRows >= m_dbMaxSize) {
         // keep only the latest m_dbMaxSize entries
@@ -376,6 +391,7 @@ void LogEngine::checkDBSize()
         if (!query.exec(queryDeleteString)) {
             qCWarning(dcLogEngine) << "Error deleting oldest log entries to keep size. Driver error:" << query.lastError().driverText() << "Database error:" << query.lastError().databaseText();
         } else {
+            m_entriesMetric->set(m_dbMaxSize);
             emit logDatabaseUpdated();
         }
     }
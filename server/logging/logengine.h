@@ -27,6 +27,7 @@
 #include "types/event.h"
 #include "types/action.h"
 #include "rule.h"
+#include "metrics.h"
 
 #include <QObject>
 #include <QSqlDatabase>
@@ -52,6 +53,9 @@ private:
     QSqlDatabase m_db;
     int m_dbMaxSize;
 
+    MetricHistogram *m_insertMetric;
+    MetricGauge *m_entriesMetric;
+
     void initDB();
     void appendLogEntry(const LogEntry &entry);
     void checkDBSize();
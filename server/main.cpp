@@ -39,6 +39,7 @@
 #include "guhservice.h"
 #include "guhsettings.h"
 #include "guhapplication.h"
+#include "startupprofiler.h"
 #include "loggingcategories.h"
 
 static QHash<QString, bool> s_loggingFilters;
@@ -104,6 +105,7 @@ static void consoleLogHandler(QtMsgType type, const QMessageLogContext& context,
 
 int main(int argc, char *argv[])
 {
+    StartupProfiler::start();
     qInstallMessageHandler(consoleLogHandler);
 
     GuhApplication application(argc, argv);
@@ -130,6 +132,7 @@ int main(int argc, char *argv[])
     s_loggingFilters.insert("Avahi", false);
     s_loggingFilters.insert("Cloud", true);
     s_loggingFilters.insert("NetworkManager", true);
+    s_loggingFilters.insert("Watchdog", false);
 
     QHash<QString, bool> loggingFiltersPlugins;
     foreach (const QJsonObject &pluginMetadata, DeviceManager::pluginsMetadata()) {
@@ -186,6 +189,8 @@ int main(int argc, char *argv[])
     parser.addOption(allOption);
     QCommandLineOption debugOption(QStringList() << "d" << "debug-category", debugDescription, "[No]DebugCategory");
     parser.addOption(debugOption);
+    QCommandLineOption profileOption(QStringList() << "profile-startup", QCoreApplication::translate("main", "Print the duration of each startup phase and the critical path of the startup once guhd is ready."));
+    parser.addOption(profileOption);
 
     parser.process(application);
 
@@ -209,6 +214,11 @@ int main(int argc, char *argv[])
             s_loggingFilters[debugArea] = true;
 
     }
+    if (parser.isSet(profileOption)) {
+        StartupProfiler::setReportEnabled(true);
+        s_loggingFilters["Application"] = true;
+    }
+
     QLoggingCategory::installFilter(loggingCategoryFilter);
 
     bool startForeground = parser.isSet(foregroundOption);
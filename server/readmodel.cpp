@@ -0,0 +1,191 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class guhserver::ReadModel
+    \brief This class publishes an immutable snapshot of the devices, states and rules.
+
+    \ingroup server
+    \inmodule core
+
+    The read-only JSON-RPC methods get executed on the worker threads of the \l{JsonRPCServer} and must not
+    touch the \l{Device} objects or the \l{RuleEngine}, which belong to the main thread. The \l{ReadModel}
+    keeps the packed JSON representation of the configured devices, their states and the rules in a
+    \l{ReadModel::Snapshot}{Snapshot} which can be read from any thread.
+
+    A snapshot never changes once it has been published. The \l{ReadModel} follows the signals of the
+    \l{DeviceManager} and the \l{RuleEngine} on the main thread, copies the current snapshot, repacks only the
+    changed device or rule and publishes the copy. Since the containers are implicitly shared, a copy costs
+    about as much as the changed entries. The signals get emitted while the mutating call is executed,
+    so a client always reads its own changes.
+
+    \sa JsonRPCServer
+*/
+
+/*! \class guhserver::ReadModel::Snapshot
+    \brief Holds the packed devices, rules and the introspection of the API at the time of a change.
+
+    The \l{ReadModel::Snapshot::version}{version} gets increased with every published change.
+*/
+
+#include "readmodel.h"
+#include "ruleengine.h"
+#include "devicemanager.h"
+#include "plugin/device.h"
+#include "jsonrpc/jsontypes.h"
+#include "loggingcategories.h"
+
+#include <QMutexLocker>
+
+namespace guhserver {
+
+/*! Constructs a \l{ReadModel} with the given \a parent following the given \a deviceManager and \a ruleEngine. */
+ReadModel::ReadModel(DeviceManager *deviceManager, RuleEngine *ruleEngine, QObject *parent) :
+    QObject(parent),
+    m_deviceManager(deviceManager),
+    m_ruleEngine(ruleEngine),
+    m_snapshot(new Snapshot())
+{
+    connect(m_deviceManager, &DeviceManager::loaded, this, &ReadModel::rebuild);
+    connect(m_deviceManager, &DeviceManager::deviceAdded, this, &ReadModel::updateDevice);
+    connect(m_deviceManager, &DeviceManager::deviceChanged, this, &ReadModel::updateDevice);
+    connect(m_deviceManager, &DeviceManager::deviceSetupFinished, this, &ReadModel::updateDevice);
+    connect(m_deviceManager, &DeviceManager::deviceStateChanged, this, &ReadModel::updateDeviceStates);
+    connect(m_deviceManager, &DeviceManager::deviceRemoved, this, &ReadModel::removeDevice);
+
+    connect(m_ruleEngine, &RuleEngine::ruleAdded, this, &ReadModel::updateRule);
+    connect(m_ruleEngine, &RuleEngine::ruleConfigurationChanged, this, &ReadModel::updateRule);
+    connect(m_ruleEngine, &RuleEngine::ruleRemoved, this, &ReadModel::removeRule);
+
+    rebuild();
+}
+
+/*! Returns the current snapshot. This method can be called from any thread, the returned snapshot stays valid
+ *  as long as the caller holds it. */
+QSharedPointer<const ReadModel::Snapshot> ReadModel::snapshot() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_snapshot;
+}
+
+/*! Publishes the given \a introspection of the JSON-RPC API. */
+void ReadModel::setIntrospection(const QVariantMap &introspection)
+{
+    Snapshot *snapshot = copy();
+    snapshot->introspection = introspection;
+    publish(snapshot);
+}
+
+/*! Packs all configured devices and rules again. */
+void ReadModel::rebuild()
+{
+    Snapshot *snapshot = copy();
+    snapshot->deviceIds.clear();
+    snapshot->devices.clear();
+    foreach (Device *device, m_deviceManager->configuredDevices()) {
+        snapshot->deviceIds.append(device->id());
+        snapshot->devices.insert(device->id(), JsonTypes::packDevice(device));
+    }
+
+    snapshot->ruleIds.clear();
+    snapshot->ruleDescriptions.clear();
+    snapshot->rules.clear();
+    foreach (const RuleId &ruleId, m_ruleEngine->ruleIds()) {
+        Rule rule = m_ruleEngine->findRule(ruleId);
+        snapshot->ruleIds.append(ruleId);
+        snapshot->ruleDescriptions.insert(ruleId, JsonTypes::packRuleDescription(rule));
+        snapshot->rules.insert(ruleId, JsonTypes::packRule(rule));
+    }
+
+    qCDebug(dcApplication) << "Read model rebuilt with" << snapshot->deviceIds.count() << "devices and" << snapshot->ruleIds.count() << "rules";
+    publish(snapshot);
+}
+
+/*! Packs the given \a rule again. This slot gets also called by \l{GuhCore} once the active state of the \a rule changed. */
+void ReadModel::updateRule(const Rule &rule)
+{
+    Snapshot *snapshot = copy();
+    if (!snapshot->rules.contains(rule.id()))
+        snapshot->ruleIds.append(rule.id());
+
+    snapshot->ruleDescriptions.insert(rule.id(), JsonTypes::packRuleDescription(rule));
+    snapshot->rules.insert(rule.id(), JsonTypes::packRule(rule));
+    publish(snapshot);
+}
+
+void ReadModel::updateDevice(Device *device)
+{
+    // The setup of a new device may still fail
+    if (!m_deviceManager->findConfiguredDevice(device->id()))
+        return;
+
+    Snapshot *snapshot = copy();
+    if (!snapshot->devices.contains(device->id()))
+        snapshot->deviceIds.append(device->id());
+
+    snapshot->devices.insert(device->id(), JsonTypes::packDevice(device));
+    publish(snapshot);
+}
+
+void ReadModel::updateDeviceStates(Device *device)
+{
+    // Devices which are not yet known get packed as a whole once they have been added
+    if (!m_snapshot->devices.contains(device->id()))
+        return;
+
+    Snapshot *snapshot = copy();
+    QVariantMap packedDevice = snapshot->devices.value(device->id());
+    packedDevice.insert("states", JsonTypes::packDeviceStates(device));
+    snapshot->devices.insert(device->id(), packedDevice);
+    publish(snapshot);
+}
+
+void ReadModel::removeDevice(const DeviceId &deviceId)
+{
+    Snapshot *snapshot = copy();
+    snapshot->deviceIds.removeAll(deviceId);
+    snapshot->devices.remove(deviceId);
+    publish(snapshot);
+}
+
+void ReadModel::removeRule(const RuleId &ruleId)
+{
+    Snapshot *snapshot = copy();
+    snapshot->ruleIds.removeAll(ruleId);
+    snapshot->ruleDescriptions.remove(ruleId);
+    snapshot->rules.remove(ruleId);
+    publish(snapshot);
+}
+
+ReadModel::Snapshot *ReadModel::copy() const
+{
+    // Only the main thread publishes, so the current snapshot can be read without locking here
+    return new Snapshot(*m_snapshot);
+}
+
+void ReadModel::publish(ReadModel::Snapshot *snapshot)
+{
+    snapshot->version++;
+
+    QMutexLocker locker(&m_mutex);
+    m_snapshot = QSharedPointer<const Snapshot>(snapshot);
+}
+
+}
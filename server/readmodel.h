@@ -0,0 +1,88 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef READMODEL_H
+#define READMODEL_H
+
+#include "rule.h"
+#include "typeutils.h"
+
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QVariantMap>
+#include <QSharedPointer>
+
+class Device;
+class DeviceManager;
+
+namespace guhserver {
+
+class RuleEngine;
+
+class ReadModel : public QObject
+{
+    Q_OBJECT
+public:
+    class Snapshot
+    {
+    public:
+        Snapshot() : version(0) {}
+
+        qint64 version;
+        QList<DeviceId> deviceIds;
+        QHash<DeviceId, QVariantMap> devices;
+        QList<RuleId> ruleIds;
+        QHash<RuleId, QVariantMap> ruleDescriptions;
+        QHash<RuleId, QVariantMap> rules;
+        QVariantMap introspection;
+    };
+
+    explicit ReadModel(DeviceManager *deviceManager, RuleEngine *ruleEngine, QObject *parent = 0);
+
+    QSharedPointer<const Snapshot> snapshot() const;
+
+    void setIntrospection(const QVariantMap &introspection);
+
+public slots:
+    void rebuild();
+    void updateRule(const Rule &rule);
+
+private slots:
+    void updateDevice(Device *device);
+    void updateDeviceStates(Device *device);
+    void removeDevice(const DeviceId &deviceId);
+    void removeRule(const RuleId &ruleId);
+
+private:
+    DeviceManager *m_deviceManager;
+    RuleEngine *m_ruleEngine;
+
+    mutable QMutex m_mutex;
+    QSharedPointer<const Snapshot> m_snapshot;
+
+    Snapshot *copy() const;
+    void publish(Snapshot *snapshot);
+};
+
+}
+
+#endif // READMODEL_H
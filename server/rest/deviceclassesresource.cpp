@@ -112,7 +112,7 @@ HttpReply *DeviceClassesResource::proccessGetRequest(const HttpRequest &request,
                 }
             }
         }
-        return getDeviceClasses(vendorId);
+        return getDeviceClasses(request, vendorId);
     }
 
     // GET /api/v1/deviceclasses/{deviceClassId}
@@ -297,7 +297,7 @@ void DeviceClassesResource::devicesDiscovered(const DeviceClassId &deviceClassId
     reply->finished();
 }
 
-HttpReply *DeviceClassesResource::getDeviceClasses(const VendorId &vendorId)
+HttpReply *DeviceClassesResource::getDeviceClasses(const HttpRequest &request, const VendorId &vendorId)
 {
     if (vendorId == VendorId()) {
         qCDebug(dcRest) << "Get all device classes.";
@@ -305,10 +305,10 @@ HttpReply *DeviceClassesResource::getDeviceClasses(const VendorId &vendorId)
         qCDebug(dcRest) << "Get device classes for vendor" << vendorId.toString();
     }
 
-    HttpReply *reply = createSuccessReply();
-    reply->setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
-    reply->setPayload(QJsonDocument::fromVariant(JsonTypes::packSupportedDevices(vendorId)).toJson());
-    return reply;
+    CatalogCache::Snapshot snapshot = GuhCore::instance()->catalogCache()->snapshot("deviceclasses/" + vendorId.toString(), [vendorId] () {
+        return QVariant(JsonTypes::packSupportedDevices(vendorId));
+    });
+    return createSnapshotReply(request, snapshot);
 }
 
 }
@@ -52,7 +52,7 @@ private:
     HttpReply *proccessGetRequest(const HttpRequest &request, const QStringList &urlTokens) override;
 
     // Get methods
-    HttpReply *getDeviceClasses(const VendorId &vendorId);
+    HttpReply *getDeviceClasses(const HttpRequest &request, const VendorId &vendorId);
     HttpReply *getDeviceClass();
 
     HttpReply *getActionTypes();
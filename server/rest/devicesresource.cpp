@@ -115,7 +115,16 @@ HttpReply *DevicesResource::proccessRequest(const HttpRequest &request, const QS
 
 HttpReply *DevicesResource::proccessGetRequest(const HttpRequest &request, const QStringList &urlTokens)
 {
-    Q_UNUSED(request)
+    // GET /api/v1/devices?changesSince={sequence}
+    if (urlTokens.count() == 3 && request.urlQuery().hasQueryItem("changesSince")) {
+        bool ok = false;
+        qint64 sequence = request.urlQuery().queryItemValue("changesSince").toLongLong(&ok);
+        if (!ok) {
+            qCWarning(dcRest) << "Could not parse sequence:" << request.urlQuery().queryItemValue("changesSince");
+            return createErrorReply(HttpReply::BadRequest);
+        }
+        return getDeviceChanges(sequence);
+    }
 
     // GET /api/v1/devices
     if (urlTokens.count() == 3)
@@ -246,6 +255,15 @@ HttpReply *DevicesResource::getConfiguredDevices() const
     return reply;
 }
 
+HttpReply *DevicesResource::getDeviceChanges(const qint64 &sequence) const
+{
+    qCDebug(dcRest) << "Get device changes since" << sequence;
+    HttpReply *reply = createSuccessReply();
+    reply->setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
+    reply->setPayload(QJsonDocument::fromVariant(JsonTypes::packDeviceChanges(sequence)).toJson());
+    return reply;
+}
+
 HttpReply *DevicesResource::getConfiguredDevice(Device *device) const
 {
     qCDebug(dcRest) << "Get configured device with id:" << device->id().toString();
@@ -59,6 +59,7 @@ private:
 
     // Get methods
     HttpReply *getConfiguredDevices() const;
+    HttpReply *getDeviceChanges(const qint64 &sequence) const;
     HttpReply *getConfiguredDevice(Device *device) const;
     HttpReply *getDeviceStateValues(Device *device) const;
     HttpReply *getDeviceStateValue(Device *device, const StateTypeId &stateTypeId) const;
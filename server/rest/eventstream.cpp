@@ -0,0 +1,308 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class guhserver::EventStream
+    \brief This class streams the JSON-RPC notifications to HTTP clients as server-sent events.
+
+    \ingroup server
+    \inmodule core
+
+    The \l{EventStream} will be created in the \l{RestServer} and receives every notification the
+    \l{JsonRPCServer} sends to its clients (state changes, events, log entries, rule changes...). A client
+    opens the stream with a GET request on the \tt events resource and keeps the connection open. Every
+    notification will be sent as a \tt text/event-stream message containing a monotonic event id, the
+    notification name as event type and the compact JSON notification as data:
+
+    \code
+        http://localhost:3333/api/v1/events?namespaces=Devices,Rules&deviceId=<deviceId>
+
+        id: 3012855906304042
+        event: Devices.StateChanged
+        data: {"id":17,"notification":"Devices.StateChanged","params":{...}}
+    \endcode
+
+    The stream can be filtered with the query parameters \tt namespaces, \tt notifications and \tt deviceId.
+    Each parameter accepts a comma separated list and can be repeated. Notifications without a device
+    will not be sent if a \tt deviceId filter was given.
+
+    The last notifications will be kept in a bounded replay buffer. A reconnecting client can pass the
+    \tt Last-Event-ID header (or the \tt lastEventId query parameter) to receive the notifications it missed.
+    If the requested notifications are not in the buffer any more, the client receives a
+    \tt ReplayIncomplete event first and should fetch the current state again. The upper bits of the event
+    ids hold a random instance id, which changes with every start of the server. An event id of a previous
+    instance therefore always results in a \tt ReplayIncomplete event. Idle streams receive a heartbeat
+    comment every 15 seconds.
+
+    \sa RestServer, WebServer, JsonRPCServer
+*/
+
+#include "eventstream.h"
+#include "webserver.h"
+#include "httprequest.h"
+#include "httpreply.h"
+#include "restresource.h"
+#include "loggingcategories.h"
+
+#include <QJsonDocument>
+#include <QUrlQuery>
+
+namespace guhserver {
+
+static const int replayBufferSize = 256;
+static const int heartbeatInterval = 15000;
+
+// 20 bits of instance id and 32 bits of counter, like the sequences of the ChangeJournal
+static const int counterBits = 32;
+static const qint64 instanceMask = 0xfffff;
+
+/*! Constructs a \l{EventStream} with the given \a parent. */
+EventStream::EventStream(QObject *parent) :
+    QObject(parent),
+    m_webserver(0),
+    m_instance(0),
+    m_buffering(false)
+{
+    startInstance();
+
+    m_heartbeatTimer = new QTimer(this);
+    m_heartbeatTimer->setInterval(heartbeatInterval);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &EventStream::sendHeartbeat);
+}
+
+/*! Sets the \a webServer on which the streams of this \l{EventStream} will be opened. */
+void EventStream::registerWebserver(WebServer *webServer)
+{
+    m_webserver = webServer;
+}
+
+/*! Processes the given \a request with the given \a urlTokens from the client with the given \a clientId.
+ *  A valid request opens a new stream, otherwise an error reply will be sent to the client.
+ */
+void EventStream::processRequest(const QUuid &clientId, const HttpRequest &request, const QStringList &urlTokens)
+{
+    HttpReply *reply = 0;
+    Filter filter;
+    if (request.method() == HttpRequest::Options && urlTokens.count() == 3) {
+        reply = RestResource::createCorsSuccessReply();
+    } else if (request.method() != HttpRequest::Get || urlTokens.count() != 3) {
+        reply = RestResource::createErrorReply(HttpReply::BadRequest);
+    } else if (!parseFilter(request, &filter)) {
+        reply = RestResource::createErrorReply(HttpReply::BadRequest);
+    }
+
+    if (reply) {
+        reply->setClientId(clientId);
+        m_webserver->sendHttpReply(reply);
+        reply->deleteLater();
+        return;
+    }
+
+    // no payload and therefore no Content-Length, the connection stays open until the client closes it
+    reply = new HttpReply(HttpReply::Ok, HttpReply::TypeSync);
+    reply->setHeader(HttpReply::ContentTypeHeader, "text/event-stream");
+    reply->setClientId(clientId);
+    bool started = m_webserver->startEventStream(reply);
+    reply->deleteLater();
+    if (!started)
+        return;
+
+    qCDebug(dcWebServer) << "Event stream opened for client" << clientId.toString();
+    m_streams.insert(clientId, filter);
+    m_buffering = true;
+    m_webserver->sendEventStreamData(clientId, "retry: 3000\n\n");
+
+    // resume from the id of the last received event
+    QByteArray lastEventIdString = request.urlQuery().queryItemValue("lastEventId").toUtf8();
+    foreach (const QByteArray &header, request.rawHeaderList().keys()) {
+        if (header.toLower() == "last-event-id") {
+            lastEventIdString = request.rawHeaderList().value(header);
+            break;
+        }
+    }
+
+    if (!lastEventIdString.isEmpty()) {
+        bool ok = false;
+        qint64 lastEventId = lastEventIdString.toLongLong(&ok);
+        if (ok)
+            replay(clientId, filter, lastEventId);
+    }
+
+    if (!m_heartbeatTimer->isActive())
+        m_heartbeatTimer->start();
+}
+
+/*! Removes the stream of the client with the given \a clientId. */
+void EventStream::removeStream(const QUuid &clientId)
+{
+    if (m_streams.remove(clientId) > 0)
+        qCDebug(dcWebServer) << "Event stream closed for client" << clientId.toString();
+
+    if (m_streams.isEmpty())
+        m_heartbeatTimer->stop();
+}
+
+/*! Returns the number of open streams. */
+int EventStream::streamCount() const
+{
+    return m_streams.count();
+}
+
+/*! Returns the id of the last event which was published on this \l{EventStream}. */
+qint64 EventStream::lastEventId() const
+{
+    return m_lastEventId;
+}
+
+bool EventStream::Filter::matches(const QString &notification, const QUuid &deviceId) const
+{
+    if (!namespaces.isEmpty() && !namespaces.contains(notification.section('.', 0, 0)))
+        return false;
+
+    if (!notifications.isEmpty() && !notifications.contains(notification))
+        return false;
+
+    if (!deviceIds.isEmpty() && !deviceIds.contains(deviceId))
+        return false;
+
+    return true;
+}
+
+bool EventStream::parseFilter(const HttpRequest &request, EventStream::Filter *filter) const
+{
+    QUrlQuery query = request.urlQuery();
+
+    foreach (const QString &value, query.allQueryItemValues("namespaces"))
+        filter->namespaces.append(value.split(",", QString::SkipEmptyParts));
+
+    foreach (const QString &value, query.allQueryItemValues("notifications"))
+        filter->notifications.append(value.split(",", QString::SkipEmptyParts));
+
+    foreach (const QString &value, query.allQueryItemValues("deviceId")) {
+        foreach (const QString &deviceIdString, value.split(",", QString::SkipEmptyParts)) {
+            QUuid deviceId(deviceIdString);
+            if (deviceId.isNull()) {
+                qCWarning(dcWebServer) << "Invalid deviceId in event stream filter:" << deviceIdString;
+                return false;
+            }
+            filter->deviceIds.append(deviceId);
+        }
+    }
+
+    return true;
+}
+
+void EventStream::replay(const QUuid &clientId, const EventStream::Filter &filter, const qint64 &lastEventId)
+{
+    qint64 firstEventId = m_replayBuffer.isEmpty() ? m_lastEventId + 1 : m_replayBuffer.first().id;
+
+    // an id of a previous server instance says nothing about the events of this one
+    bool otherInstance = (lastEventId >> counterBits) != m_instance || lastEventId > m_lastEventId;
+    qint64 resumeId = otherInstance ? 0 : lastEventId;
+
+    if (otherInstance || resumeId + 1 < firstEventId) {
+        qCDebug(dcWebServer) << "Event stream replay incomplete for client" << clientId.toString() << "requested" << lastEventId;
+        m_webserver->sendEventStreamData(clientId, "event: ReplayIncomplete\ndata: {}\n\n");
+    }
+
+    foreach (const Event &event, m_replayBuffer) {
+        if (event.id > resumeId && filter.matches(event.notification, event.deviceId))
+            m_webserver->sendEventStreamData(clientId, event.data);
+    }
+}
+
+QUuid EventStream::notificationDeviceId(const QVariantMap &params)
+{
+    if (params.contains("deviceId"))
+        return QUuid(params.value("deviceId").toString());
+
+    if (params.contains("device"))
+        return QUuid(params.value("device").toMap().value("id").toString());
+
+    if (params.contains("event"))
+        return QUuid(params.value("event").toMap().value("deviceId").toString());
+
+    if (params.contains("logEntry"))
+        return QUuid(params.value("logEntry").toMap().value("deviceId").toString());
+
+    return QUuid();
+}
+
+/*! Publishes the given JSON-RPC \a notification to all matching streams and keeps it in the replay buffer.
+ *  The notification gets serialized once for all streams.
+ */
+void EventStream::publishNotification(const QVariantMap &notification)
+{
+    // nothing to do until the first stream was opened
+    if (!m_buffering)
+        return;
+
+    // the counter would run into the instance bits, the clients have to start over with a new instance
+    if (((m_lastEventId + 1) >> counterBits) != m_instance)
+        startInstance();
+
+    Event event;
+    event.id = ++m_lastEventId;
+    event.notification = notification.value("notification").toString();
+    event.deviceId = notificationDeviceId(notification.value("params").toMap());
+
+    QByteArray json = QJsonDocument::fromVariant(notification).toJson(QJsonDocument::Compact);
+    event.data.reserve(json.length() + event.notification.length() + 32);
+    event.data.append("id: ");
+    event.data.append(QByteArray::number(event.id));
+    event.data.append("\nevent: ");
+    event.data.append(event.notification.toUtf8());
+    event.data.append("\ndata: ");
+    event.data.append(json);
+    event.data.append("\n\n");
+
+    m_replayBuffer.append(event);
+    while (m_replayBuffer.count() > replayBufferSize)
+        m_replayBuffer.removeFirst();
+
+    QHash<QUuid, Filter>::const_iterator i;
+    for (i = m_streams.constBegin(); i != m_streams.constEnd(); ++i) {
+        if (i.value().matches(event.notification, event.deviceId))
+            m_webserver->sendEventStreamData(i.key(), event.data);
+    }
+}
+
+void EventStream::startInstance()
+{
+    // a restart within the same process must not pick the previous instance again
+    static qint64 previousInstance = 0;
+
+    qint64 instance = 0;
+    while (instance == 0 || instance == m_instance || instance == previousInstance)
+        instance = QUuid::createUuid().data1 & instanceMask;
+
+    previousInstance = instance;
+    m_instance = instance;
+    m_lastEventId = m_instance << counterBits;
+    m_replayBuffer.clear();
+}
+
+void EventStream::sendHeartbeat()
+{
+    foreach (const QUuid &clientId, m_streams.keys())
+        m_webserver->sendEventStreamData(clientId, ": heartbeat\n\n");
+}
+
+}
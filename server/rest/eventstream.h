@@ -0,0 +1,96 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef EVENTSTREAM_H
+#define EVENTSTREAM_H
+
+#include <QObject>
+#include <QUuid>
+#include <QTimer>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QVariantMap>
+
+namespace guhserver {
+
+class WebServer;
+class HttpRequest;
+
+class EventStream : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EventStream(QObject *parent = 0);
+
+    void registerWebserver(WebServer *webServer);
+
+    void processRequest(const QUuid &clientId, const HttpRequest &request, const QStringList &urlTokens);
+    void removeStream(const QUuid &clientId);
+
+    int streamCount() const;
+    qint64 lastEventId() const;
+
+private:
+    class Filter
+    {
+    public:
+        QStringList namespaces;
+        QStringList notifications;
+        QList<QUuid> deviceIds;
+
+        bool matches(const QString &notification, const QUuid &deviceId) const;
+    };
+
+    class Event
+    {
+    public:
+        qint64 id;
+        QString notification;
+        QUuid deviceId;
+        QByteArray data;
+    };
+
+    WebServer *m_webserver;
+    QTimer *m_heartbeatTimer;
+
+    QHash<QUuid, Filter> m_streams;
+    QList<Event> m_replayBuffer;
+    qint64 m_instance;
+    qint64 m_lastEventId;
+    bool m_buffering;
+
+    bool parseFilter(const HttpRequest &request, Filter *filter) const;
+    void replay(const QUuid &clientId, const Filter &filter, const qint64 &lastEventId);
+    void startInstance();
+
+    static QUuid notificationDeviceId(const QVariantMap &params);
+
+public slots:
+    void publishNotification(const QVariantMap &notification);
+
+private slots:
+    void sendHeartbeat();
+
+};
+
+}
+
+#endif // EVENTSTREAM_H
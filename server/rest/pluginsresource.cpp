@@ -99,11 +99,9 @@ HttpReply *PluginsResource::proccessRequest(const HttpRequest &request, const QS
 
 HttpReply *PluginsResource::proccessGetRequest(const HttpRequest &request, const QStringList &urlTokens)
 {
-    Q_UNUSED(request)
-
     // GET /api/v1/plugins
     if (urlTokens.count() == 3)
-        return getPlugins();
+        return getPlugins(request);
 
     // GET /api/v1/plugins/{pluginId}
     if (urlTokens.count() == 4)
@@ -134,13 +132,13 @@ HttpReply *PluginsResource::proccessOptionsRequest(const HttpRequest &request, c
     return RestResource::createCorsSuccessReply();
 }
 
-HttpReply *PluginsResource::getPlugins() const
+HttpReply *PluginsResource::getPlugins(const HttpRequest &request) const
 {
     qCDebug(dcRest) << "Get plugins";
-    HttpReply *reply = createSuccessReply();
-    reply->setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
-    reply->setPayload(QJsonDocument::fromVariant(JsonTypes::packPlugins()).toJson());
-    return reply;
+    CatalogCache::Snapshot snapshot = GuhCore::instance()->catalogCache()->snapshot("plugins", [] () {
+        return QVariant(JsonTypes::packPlugins());
+    });
+    return createSnapshotReply(request, snapshot);
 }
 
 HttpReply *PluginsResource::getPlugin(const PluginId &pluginId) const
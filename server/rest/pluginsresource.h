@@ -51,7 +51,7 @@ private:
     HttpReply *proccessOptionsRequest(const HttpRequest &request, const QStringList &urlTokens) override;
 
     // Get methods
-    HttpReply *getPlugins() const;
+    HttpReply *getPlugins(const HttpRequest &request) const;
     HttpReply *getPlugin(const PluginId &pluginId) const;
     HttpReply *getPluginConfiguration(const PluginId &pluginId) const;
     HttpReply *setPluginConfiguration(const PluginId &pluginId, const QByteArray &payload) const;
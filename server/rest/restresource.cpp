@@ -150,6 +150,35 @@ HttpReply *RestResource::createAsyncReply()
     return reply;
 }
 
+/*! Returns the pointer to a new created \l{HttpReply} for the given catalog \a snapshot. If the \tt If-None-Match
+    header of the \a request contains the tag of the snapshot, the reply has the status \l{HttpReply::NotModified}
+    and no payload. Otherwise the serialized snapshot will be the payload.
+
+    \sa CatalogCache
+*/
+HttpReply *RestResource::createSnapshotReply(const HttpRequest &request, const CatalogCache::Snapshot &snapshot)
+{
+    // header names are case insensitive
+    QByteArray ifNoneMatch;
+    foreach (const QByteArray &header, request.rawHeaderList().keys()) {
+        if (header.toLower() == "if-none-match") {
+            ifNoneMatch = request.rawHeaderList().value(header);
+            break;
+        }
+    }
+
+    HttpReply *reply;
+    if (CatalogCache::matchesTag(ifNoneMatch, snapshot.tag)) {
+        reply = new HttpReply(HttpReply::NotModified, HttpReply::TypeSync);
+    } else {
+        reply = new HttpReply(HttpReply::Ok, HttpReply::TypeSync);
+        reply->setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
+        reply->setPayload(snapshot.json);
+    }
+    reply->setRawHeader("ETag", '"' + snapshot.tag + '"');
+    return reply;
+}
+
 /*! This method can be used from every \l{RestResource} in order to verify if the \a payload of a
     \l{HttpRequest} is a valid JSON document. Returns \tt true and the valid \e QVariant if there
     was no error while parsing JSON. Returns \tt false and an invalid \e QVariant if the \a payload
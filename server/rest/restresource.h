@@ -27,6 +27,7 @@
 #include "httpreply.h"
 #include "httprequest.h"
 #include "jsontypes.h"
+#include "catalogcache.h"
 
 class QVariant;
 
@@ -50,6 +51,7 @@ public:
     static HttpReply *createRuleErrorReply(const HttpReply::HttpStatusCode &statusCode, const RuleEngine::RuleError &ruleError);
     static HttpReply *createLoggingErrorReply(const HttpReply::HttpStatusCode &statusCode, const Logging::LoggingError &loggingError);
     static HttpReply *createAsyncReply();
+    static HttpReply *createSnapshotReply(const HttpRequest &request, const CatalogCache::Snapshot &snapshot);
     static QPair<bool, QVariant> verifyPayload(const QByteArray &payload);
 
 private:
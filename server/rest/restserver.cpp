@@ -52,6 +52,8 @@ RestServer::RestServer(const QSslConfiguration &sslConfiguration, QObject *paren
 {
     Q_UNUSED(sslConfiguration)
 
+    m_eventStream = new EventStream(this);
+
     QMetaObject::invokeMethod(this, "setup", Qt::QueuedConnection);
 }
 
@@ -66,10 +68,17 @@ void RestServer::registerWebserver(WebServer *webServer)
     connect(m_webserver, &WebServer::clientConnected, this, &RestServer::clientConnected);
     connect(m_webserver, &WebServer::clientDisconnected, this, &RestServer::clientDisconnected);
     connect(m_webserver, &WebServer::httpRequestReady, this, &RestServer::processHttpRequest);
+    m_eventStream->registerWebserver(m_webserver);
 
     QMetaObject::invokeMethod(m_webserver, "startServer", Qt::QueuedConnection);
 }
 
+/*! Returns the \l{EventStream} which streams the notifications to the clients of the \l{WebServer}. */
+EventStream *RestServer::eventStream() const
+{
+    return m_eventStream;
+}
+
 void RestServer::setup()
 {
     // Create resources
@@ -79,6 +88,7 @@ void RestServer::setup()
     m_pluginsResource = new PluginsResource(this);
     m_rulesResource = new RulesResource(this);
     m_logsResource = new LogsResource(this);
+    m_systemResource = new SystemResource(this);
 
     m_resources.insert(m_deviceResource->name(), m_deviceResource);
     m_resources.insert(m_deviceClassesResource->name(), m_deviceClassesResource);
@@ -86,6 +96,7 @@ void RestServer::setup()
     m_resources.insert(m_pluginsResource->name(), m_pluginsResource);
     m_resources.insert(m_rulesResource->name(), m_rulesResource);
     m_resources.insert(m_logsResource->name(), m_logsResource);
+    m_resources.insert(m_systemResource->name(), m_systemResource);
 }
 
 void RestServer::clientConnected(const QUuid &clientId)
@@ -96,6 +107,7 @@ void RestServer::clientConnected(const QUuid &clientId)
 void RestServer::clientDisconnected(const QUuid &clientId)
 {
     m_clientList.removeAll(clientId);
+    m_eventStream->removeStream(clientId);
 }
 
 void RestServer::processHttpRequest(const QUuid &clientId, const HttpRequest &request)
@@ -112,8 +124,14 @@ void RestServer::processHttpRequest(const QUuid &clientId, const HttpRequest &re
         return;
     }
 
-    // check resource
+    // check event stream
     QString resourceName = urlTokens.at(2);
+    if (resourceName == "events") {
+        m_eventStream->processRequest(clientId, request, urlTokens);
+        return;
+    }
+
+    // check resource
     if (!m_resources.contains(resourceName)) {
         HttpReply *reply = RestResource::createErrorReply(HttpReply::BadRequest);
         reply->setClientId(clientId);
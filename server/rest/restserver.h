@@ -31,6 +31,8 @@
 #include "pluginsresource.h"
 #include "rulesresource.h"
 #include "logsresource.h"
+#include "systemresource.h"
+#include "eventstream.h"
 
 class QSslConfiguration;
 
@@ -47,6 +49,8 @@ public:
 
     void registerWebserver(WebServer *webServer);
 
+    EventStream *eventStream() const;
+
 private:
     WebServer *m_webserver;
     QList<QUuid> m_clientList;
@@ -54,12 +58,15 @@ private:
 
     QHash<QUuid, HttpReply *> m_asyncReplies;
 
+    EventStream *m_eventStream;
+
     DevicesResource *m_deviceResource;
     DeviceClassesResource *m_deviceClassesResource;
     VendorsResource *m_vendorsResource;
     PluginsResource *m_pluginsResource;
     RulesResource *m_rulesResource;
     LogsResource *m_logsResource;
+    SystemResource *m_systemResource;
 
 private slots:
     void setup();
@@ -109,7 +109,16 @@ HttpReply *RulesResource::proccessRequest(const HttpRequest &request, const QStr
 
 HttpReply *RulesResource::proccessGetRequest(const HttpRequest &request, const QStringList &urlTokens)
 {
-    Q_UNUSED(request)
+    // GET /api/v1/rules?changesSince={sequence}
+    if (urlTokens.count() == 3 && request.urlQuery().hasQueryItem("changesSince")) {
+        bool ok = false;
+        qint64 sequence = request.urlQuery().queryItemValue("changesSince").toLongLong(&ok);
+        if (!ok) {
+            qCWarning(dcRest) << "Could not parse sequence:" << request.urlQuery().queryItemValue("changesSince");
+            return createErrorReply(HttpReply::BadRequest);
+        }
+        return getRuleChanges(sequence);
+    }
 
     // GET /api/v1/rules
     if (urlTokens.count() == 3) {
@@ -190,6 +199,15 @@ HttpReply *RulesResource::proccessOptionsRequest(const HttpRequest &request, con
     return RestResource::createCorsSuccessReply();
 }
 
+HttpReply *RulesResource::getRuleChanges(const qint64 &sequence) const
+{
+    qCDebug(dcRest) << "Get rule changes since" << sequence;
+    HttpReply *reply = createSuccessReply();
+    reply->setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
+    reply->setPayload(QJsonDocument::fromVariant(JsonTypes::packRuleChanges(sequence)).toJson());
+    return reply;
+}
+
 HttpReply *RulesResource::getRules(const DeviceId &deviceId) const
 {
     HttpReply *reply = createSuccessReply();
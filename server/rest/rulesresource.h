@@ -55,6 +55,7 @@ private:
 
     // Get methods
     HttpReply *getRules(const DeviceId &deviceId) const;
+    HttpReply *getRuleChanges(const qint64 &sequence) const;
     HttpReply *getRuleDetails(const RuleId &ruleId) const;
 
     // Delete methods
@@ -0,0 +1,115 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class guhserver::SystemResource
+    \brief This subclass of \l{RestResource} processes the REST requests for the \tt System namespace.
+
+    \ingroup json
+    \inmodule core
+
+    This \l{RestResource} will be created in the \l{RestServer} and used to handle REST requests
+    about the state of the guh server itself.
+
+    \code
+        http://localhost:3333/api/v1/system/startup
+        http://localhost:3333/api/v1/system/metrics
+    \endcode
+
+    \sa StartupProfiler, Metrics, RestResource, RestServer
+*/
+
+#include "systemresource.h"
+#include "httprequest.h"
+#include "loggingcategories.h"
+
+#include <QJsonDocument>
+
+namespace guhserver {
+
+/*! Constructs a \l SystemResource with the given \a parent. */
+SystemResource::SystemResource(QObject *parent) :
+    RestResource(parent)
+{
+}
+
+/*! Returns the name of the \l{RestResource}. In this case \b system.
+
+    \sa RestResource::name()
+*/
+QString SystemResource::name() const
+{
+    return "system";
+}
+
+/*! This method will be used to process the given \a request and the given \a urlTokens. The request
+    has to be in this namespace. Returns the resulting \l HttpReply.
+
+    \sa HttpRequest, HttpReply, RestResource::proccessRequest()
+*/
+HttpReply *SystemResource::proccessRequest(const HttpRequest &request, const QStringList &urlTokens)
+{
+    // check method
+    HttpReply *reply;
+    switch (request.method()) {
+    case HttpRequest::Get:
+        reply = proccessGetRequest(request, urlTokens);
+        break;
+    default:
+        reply = createErrorReply(HttpReply::BadRequest);
+        break;
+    }
+    return reply;
+}
+
+HttpReply *SystemResource::proccessGetRequest(const HttpRequest &request, const QStringList &urlTokens)
+{
+    Q_UNUSED(request)
+
+    // GET /api/v1/system/startup
+    if (urlTokens.count() == 4 && urlTokens.at(3) == "startup")
+        return getStartupProfile();
+
+    // GET /api/v1/system/metrics
+    if (urlTokens.count() == 4 && urlTokens.at(3) == "metrics")
+        return getMetrics();
+
+    return createErrorReply(HttpReply::NotImplemented);
+}
+
+HttpReply *SystemResource::getStartupProfile() const
+{
+    qCDebug(dcRest) << "Get startup profile";
+    HttpReply *reply = createSuccessReply();
+    reply->setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
+    reply->setPayload(QJsonDocument::fromVariant(JsonTypes::packStartupProfile()).toJson());
+    return reply;
+}
+
+HttpReply *SystemResource::getMetrics() const
+{
+    qCDebug(dcRest) << "Get metrics";
+    HttpReply *reply = createSuccessReply();
+    reply->setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
+    reply->setPayload(QJsonDocument::fromVariant(JsonTypes::packMetrics()).toJson());
+    return reply;
+}
+
+}
@@ -0,0 +1,56 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef SYSTEMRESOURCE_H
+#define SYSTEMRESOURCE_H
+
+#include <QObject>
+
+#include "jsontypes.h"
+#include "restresource.h"
+#include "httpreply.h"
+
+namespace guhserver {
+
+class HttpRequest;
+
+class SystemResource : public RestResource
+{
+    Q_OBJECT
+public:
+    explicit SystemResource(QObject *parent = 0);
+
+    QString name() const override;
+
+    HttpReply *proccessRequest(const HttpRequest &request, const QStringList &urlTokens) override;
+
+private:
+    // Process method
+    HttpReply *proccessGetRequest(const HttpRequest &request, const QStringList &urlTokens) override;
+
+    // Get methods
+    HttpReply *getStartupProfile() const;
+    HttpReply *getMetrics() const;
+
+};
+
+}
+
+#endif // SYSTEMRESOURCE_H
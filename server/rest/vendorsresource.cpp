@@ -91,11 +91,9 @@ HttpReply *VendorsResource::proccessRequest(const HttpRequest &request, const QS
 
 HttpReply *VendorsResource::proccessGetRequest(const HttpRequest &request, const QStringList &urlTokens)
 {
-    Q_UNUSED(request)
-
     // GET /api/v1/vendors
     if (urlTokens.count() == 3)
-        return getVendors();
+        return getVendors(request);
 
     // GET /api/v1/vendors/{vendorId}
     if (urlTokens.count() == 4)
@@ -104,18 +102,13 @@ HttpReply *VendorsResource::proccessGetRequest(const HttpRequest &request, const
     return createErrorReply(HttpReply::NotImplemented);
 }
 
-HttpReply *VendorsResource::getVendors() const
+HttpReply *VendorsResource::getVendors(const HttpRequest &request) const
 {
     qCDebug(dcRest) << "Get vendors";
-    HttpReply *reply = createSuccessReply();
-
-    QVariantList vendorsList;
-    foreach (const Vendor &vendor, GuhCore::instance()->deviceManager()->supportedVendors()) {
-        vendorsList.append(JsonTypes::packVendor(vendor));
-    }
-    reply->setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
-    reply->setPayload(QJsonDocument::fromVariant(vendorsList).toJson());
-    return reply;
+    CatalogCache::Snapshot snapshot = GuhCore::instance()->catalogCache()->snapshot("vendors", [] () {
+        return QVariant(JsonTypes::packSupportedVendors());
+    });
+    return createSnapshotReply(request, snapshot);
 }
 
 HttpReply *VendorsResource::getVendor(const VendorId &vendorId) const
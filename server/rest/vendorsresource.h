@@ -49,7 +49,7 @@ private:
     HttpReply *proccessGetRequest(const HttpRequest &request, const QStringList &urlTokens) override;
 
     // Get methods
-    HttpReply *getVendors() const;
+    HttpReply *getVendors(const HttpRequest &request) const;
     HttpReply *getVendor(const VendorId &vendorId) const;
 
 };
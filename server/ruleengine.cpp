@@ -45,6 +45,13 @@
     Will be emitted whenever a \l{Rule} changed his enable/disable status.
     The parameter \a rule holds the changed rule.*/
 
+/*! \class guhserver::RuleEngine::Statistics
+    \brief Holds the runtime counters of a single \l{Rule}.
+
+    The \c actions count includes the exit actions issued when a rule leaves its active state.
+    The evaluation times are measured in nanoseconds.
+*/
+
 /*! \enum guhserver::RuleEngine::RuleError
     \value RuleErrorNoError
         No error happened. Everything is fine.
@@ -109,12 +116,14 @@
 #include "types/paramdescriptor.h"
 #include "guhsettings.h"
 #include "devicemanager.h"
+#include "calltrace.h"
 #include "plugin/device.h"
 
 #include <QDebug>
 #include <QStringList>
 #include <QStandardPaths>
 #include <QCoreApplication>
+#include <QElapsedTimer>
 
 namespace guhserver {
 
@@ -124,6 +133,8 @@ namespace guhserver {
 RuleEngine::RuleEngine(QObject *parent) :
     QObject(parent)
 {
+    m_evaluationMetric = Metrics::histogram("guh_rule_evaluation_duration_microseconds", "Duration of evaluating an event against all rules.", Metrics::durationBounds());
+
     GuhSettings settings(GuhSettings::SettingsRoleRules);
     qCDebug(dcRuleEngine) << "loading rules from" << settings.fileName();
     foreach (const QString &idString, settings.childGroups()) {
@@ -317,6 +328,17 @@ RuleEngine::RuleEngine(QObject *parent) :
         appendRule(rule);
         settings.endGroup();
     }
+
+    // Journal every change of the rules before anybody else gets notified
+    connect(this, &RuleEngine::ruleAdded, this, [this](const Rule &rule) {
+        m_changeJournal.record(rule.id(), ChangeJournal::ChangeTypeAdded);
+    });
+    connect(this, &RuleEngine::ruleConfigurationChanged, this, [this](const Rule &rule) {
+        m_changeJournal.record(rule.id(), ChangeJournal::ChangeTypeChanged);
+    });
+    connect(this, &RuleEngine::ruleRemoved, this, [this](const RuleId &ruleId) {
+        m_changeJournal.record(ruleId, ChangeJournal::ChangeTypeRemoved);
+    });
 }
 
 /*! Destructor of the \l{RuleEngine}. */
@@ -330,49 +352,38 @@ RuleEngine::~RuleEngine()
     and evaluate their states in the system. It will return a
     list of all \l{Rule}{Rules} that are triggered or change its active state
     because of this \a event.
+
+    \sa simulateEvent(), statistics()
 */
 QList<Rule> RuleEngine::evaluateEvent(const Event &event)
 {
+    CallTrace trace("RuleEngine", "evaluateEvent");
+    QElapsedTimer timer;
+    timer.start();
+
     Device *device = GuhCore::instance()->deviceManager()->findConfiguredDevice(event.deviceId());
 
     qCDebug(dcRuleEngine) << "Got event:" << event << device->name() << event.eventTypeId();
 
-    QList<Rule> rules;
-    foreach (const RuleId &id, ruleIds()) {
-        Rule rule = m_rules.value(id);
-        if (!rule.enabled())
-            continue;
-
+    QList<Rule> rules = matchEvent(event, QList<State>(), &m_statistics);
+    foreach (const Rule &rule, rules) {
         if (rule.eventDescriptors().isEmpty()) {
-            // This rule seems to have only states, check on state changed
-            if (containsState(rule.stateEvaluator(), event)) {
-                if (rule.stateEvaluator().evaluate()) {
-                    if (!m_activeRules.contains(rule.id())) {
-                        qCDebug(dcRuleEngine) << "Rule" << rule.id() << "entered active state.";
-                        rule.setActive(true);
-                        m_rules[rule.id()] = rule;
-                        m_activeRules.append(rule.id());
-                        rules.append(rule);
-                    }
-                } else {
-                    if (m_activeRules.contains(rule.id())) {
-                        qCDebug(dcRuleEngine) << "Rule" << rule.id() << "left active state.";
-                        rule.setActive(false);
-                        m_rules[rule.id()] = rule;
-                        m_activeRules.removeAll(rule.id());
-                        rules.append(rule);
-                    }
-                }
+            // This rule has only states and changed its active state
+            qCDebug(dcRuleEngine) << "Rule" << rule.id() << (rule.active() ? "entered active state." : "left active state.");
+            m_rules[rule.id()] = rule;
+            if (rule.active()) {
+                m_activeRules.append(rule.id());
+            } else {
+                m_activeRules.removeAll(rule.id());
             }
+            m_changeJournal.record(rule.id(), ChangeJournal::ChangeTypeChanged);
         } else {
-            if (containsEvent(rule, event)) {
-                if (rule.stateEvaluator().evaluate()) {
-                    qCDebug(dcRuleEngine) << "Rule" << rule.id() << "contains event" << event.eventId() << "and all states match.";
-                    rules.append(rule);
-                }
-            }
+            qCDebug(dcRuleEngine) << "Rule" << rule.id() << "contains event" << event.eventId() << "and all states match.";
         }
+        recordTriggered(rule);
     }
+
+    m_evaluationMetric->observe(timer.nsecsElapsed() / 1000);
     return rules;
 }
 
@@ -384,6 +395,7 @@ QList<Rule> RuleEngine::evaluateEvent(const Event &event)
 QList<Rule> RuleEngine::evaluateTime(const QDateTime &dateTime)
 {
     QList<Rule> rules;
+    QElapsedTimer timer;
 
     foreach (const Rule &r, m_rules.values()) {
         Rule rule = m_rules.value(r.id());
@@ -392,17 +404,22 @@ QList<Rule> RuleEngine::evaluateTime(const QDateTime &dateTime)
 
         // check if this rule is time based
         if (!rule.timeDescriptor().isEmpty()) {
+            timer.start();
+            Statistics &statistics = m_statistics[rule.id()];
+            statistics.evaluations++;
 
             // check if this rule is based on calendarItems
             if (!rule.timeDescriptor().calendarItems().isEmpty()) {
                 //qCDebug(dcRuleEngine()) << "Evaluate CalendarItem against" << dateTime.toString("dd:MM:yyyy hh:mm") << "for rule" << rule.id().toString();
                 bool active = rule.timeDescriptor().evaluate(dateTime);
                 if (active) {
+                    statistics.matches++;
                     if (!m_activeRules.contains(rule.id())) {
                         qCDebug(dcRuleEngine) << "Rule" << rule.id().toString() << "active.";
                         rule.setActive(true);
                         m_rules[rule.id()] = rule;
                         m_activeRules.append(rule.id());
+                        m_changeJournal.record(rule.id(), ChangeJournal::ChangeTypeChanged);
                         rules.append(rule);
                     }
                 } else {
@@ -411,6 +428,7 @@ QList<Rule> RuleEngine::evaluateTime(const QDateTime &dateTime)
                         rule.setActive(false);
                         m_rules[rule.id()] = rule;
                         m_activeRules.removeAll(rule.id());
+                        m_changeJournal.record(rule.id(), ChangeJournal::ChangeTypeChanged);
                         rules.append(rule);
                     }
                 }
@@ -420,15 +438,78 @@ QList<Rule> RuleEngine::evaluateTime(const QDateTime &dateTime)
             if (!rule.timeDescriptor().timeEventItems().isEmpty()) {
                 bool valid = rule.timeDescriptor().evaluate(dateTime);
                 if (valid) {
+                    statistics.matches++;
                     rules.append(rule);
                 }
             }
+
+            qint64 duration = timer.nsecsElapsed();
+            statistics.totalTime += duration;
+            statistics.maxTime = qMax(statistics.maxTime, duration);
         }
     }
 
+    foreach (const Rule &rule, rules)
+        recordTriggered(rule);
+
     return rules;
 }
 
+/*! Returns the \l{Rule}{Rules} which would be triggered or change their active state if the given \a event
+    would happen right now. The \a assumedStates replace the current values of the matching device states
+    while evaluating the \l{StateEvaluator}{StateEvaluators}, so a hypothetical state change can be simulated
+    by passing the state change event together with the new \l{State}.
+
+    This uses the same matching as evaluateEvent(), but neither changes the active state of any \l{Rule}
+    nor records \l{RuleEngine::Statistics}{Statistics}. No action will be executed.
+*/
+QList<Rule> RuleEngine::simulateEvent(const Event &event, const QList<State> &assumedStates) const
+{
+    return matchEvent(event, assumedStates, 0);
+}
+
+/*! Returns a copy of the given \a ruleAction where every \l{RuleActionParam} based on the given \a event
+    takes over the value of the event.
+*/
+RuleAction RuleEngine::takeOverEventParams(const RuleAction &ruleAction, const Event &event)
+{
+    RuleAction action = ruleAction;
+    RuleActionParamList newParams;
+    foreach (RuleActionParam ruleActionParam, ruleAction.ruleActionParams()) {
+        // if this event param should be taken over in this action
+        if (event.eventTypeId() == ruleActionParam.eventTypeId() && !event.params().isEmpty()) {
+            QVariant eventValue = event.params().first().value();
+
+            // TODO: get param names...when an event has more than one parameter
+
+            // TODO: limits / scale calculation -> actionValue = eventValue * x
+            //       something like a EventParamDescriptor
+
+            ruleActionParam.setValue(eventValue);
+            qCDebug(dcRuleEngine) << "take over event param value" << ruleActionParam.value();
+        }
+        newParams.append(ruleActionParam);
+    }
+    action.setRuleActionParams(newParams);
+    return action;
+}
+
+/*! Returns the runtime \l{RuleEngine::Statistics}{Statistics} of the \l{Rule} with the given \a ruleId.
+    The statistics count how often the rule has been evaluated, how often its events or states matched,
+    how often it triggered or became active, how many actions it has issued and how long its evaluation took.
+    They are kept in memory only and get dropped when the rule gets removed or edited.
+*/
+RuleEngine::Statistics RuleEngine::statistics(const RuleId &ruleId) const
+{
+    return m_statistics.value(ruleId);
+}
+
+/*! Resets the \l{RuleEngine::Statistics}{Statistics} of all \l{Rule}{Rules}. */
+void RuleEngine::resetStatistics()
+{
+    m_statistics.clear();
+}
+
 /*! Add the given \a rule to the system. If the rule will be added
     from an edit request, the parameter \a fromEdit will be true.
 */
@@ -682,6 +763,14 @@ QList<RuleId> RuleEngine::ruleIds() const
     return m_ruleIds;
 }
 
+/*! Returns the \l{ChangeJournal} of the rules. Every add, edit, removal and active state change of a
+ *  \l{Rule} gets a new sequence in this journal.
+ */
+const ChangeJournal &RuleEngine::changeJournal() const
+{
+    return m_changeJournal;
+}
+
 /*! Removes the \l{Rule} with the given \a ruleId from the Engine.
     Returns \l{RuleError} which describes whether the operation
     was successful or not. If \a fromEdit is true, the notification Rules.RuleRemoved
@@ -698,6 +787,7 @@ RuleEngine::RuleError RuleEngine::removeRule(const RuleId &ruleId, bool fromEdit
     m_ruleIds.takeAt(index);
     m_rules.remove(ruleId);
     m_activeRules.removeAll(ruleId);
+    m_statistics.remove(ruleId);
 
     GuhSettings settings(GuhSettings::SettingsRoleRules);
     settings.beginGroup(ruleId.toString());
@@ -943,7 +1033,65 @@ void RuleEngine::removeDeviceFromRule(const RuleId &id, const DeviceId &deviceId
     emit ruleConfigurationChanged(newRule);
 }
 
-bool RuleEngine::containsEvent(const Rule &rule, const Event &event)
+QList<Rule> RuleEngine::matchEvent(const Event &event, const QList<State> &assumedStates, QHash<RuleId, Statistics> *statistics) const
+{
+    QList<Rule> rules;
+    QElapsedTimer timer;
+    foreach (const RuleId &id, m_ruleIds) {
+        Rule rule = m_rules.value(id);
+        if (!rule.enabled())
+            continue;
+
+        if (statistics)
+            timer.start();
+
+        bool matched = false;
+        if (rule.eventDescriptors().isEmpty()) {
+            // This rule seems to have only states, check on state changed
+            if (containsState(rule.stateEvaluator(), event)) {
+                matched = true;
+                bool active = rule.stateEvaluator().evaluate(assumedStates);
+                if (active != m_activeRules.contains(rule.id())) {
+                    rule.setActive(active);
+                    rules.append(rule);
+                }
+            }
+        } else {
+            if (containsEvent(rule, event)) {
+                matched = true;
+                if (rule.stateEvaluator().evaluate(assumedStates)) {
+                    rules.append(rule);
+                }
+            }
+        }
+
+        if (statistics) {
+            qint64 duration = timer.nsecsElapsed();
+            Statistics &ruleStatistics = (*statistics)[rule.id()];
+            ruleStatistics.evaluations++;
+            if (matched)
+                ruleStatistics.matches++;
+            ruleStatistics.totalTime += duration;
+            ruleStatistics.maxTime = qMax(ruleStatistics.maxTime, duration);
+        }
+    }
+    return rules;
+}
+
+void RuleEngine::recordTriggered(const Rule &rule)
+{
+    Statistics &statistics = m_statistics[rule.id()];
+    // rules which only have an active state issue their exit actions when they leave it
+    bool isStateBased = rule.eventDescriptors().isEmpty() && rule.timeDescriptor().timeEventItems().isEmpty();
+    if (isStateBased && !rule.active()) {
+        statistics.actions += rule.exitActions().count();
+        return;
+    }
+    statistics.activations++;
+    statistics.actions += rule.actions().count();
+}
+
+bool RuleEngine::containsEvent(const Rule &rule, const Event &event) const
 {
     foreach (const EventDescriptor &eventDescriptor, rule.eventDescriptors()) {
         if (eventDescriptor == event) {
@@ -954,7 +1102,7 @@ bool RuleEngine::containsEvent(const Rule &rule, const Event &event)
     return false;
 }
 
-bool RuleEngine::containsState(const StateEvaluator &stateEvaluator, const Event &stateChangeEvent)
+bool RuleEngine::containsState(const StateEvaluator &stateEvaluator, const Event &stateChangeEvent) const
 {
     if (stateEvaluator.stateDescriptor().isValid() && stateEvaluator.stateDescriptor().stateTypeId().toString() == stateChangeEvent.eventTypeId().toString()) {
         return true;
@@ -26,6 +26,8 @@
 #include "types/event.h"
 #include "plugin/deviceclass.h"
 #include "stateevaluator.h"
+#include "changejournal.h"
+#include "metrics.h"
 
 #include <QObject>
 #include <QList>
@@ -67,17 +69,37 @@ public:
         RemovePolicyUpdate
     };
 
+    class Statistics
+    {
+    public:
+        Statistics() : evaluations(0), matches(0), activations(0), actions(0), totalTime(0), maxTime(0) {}
+
+        int evaluations;
+        int matches;
+        int activations;
+        int actions;
+        qint64 totalTime; // [ns]
+        qint64 maxTime; // [ns]
+    };
+
     explicit RuleEngine(QObject *parent = 0);
     ~RuleEngine();
 
     QList<Rule> evaluateEvent(const Event &event);
     QList<Rule> evaluateTime(const QDateTime &dateTime);
+    QList<Rule> simulateEvent(const Event &event, const QList<State> &assumedStates = QList<State>()) const;
+
+    static RuleAction takeOverEventParams(const RuleAction &ruleAction, const Event &event);
+
+    Statistics statistics(const RuleId &ruleId) const;
+    void resetStatistics();
 
     RuleError addRule(const Rule &rule, bool fromEdit = false);
     RuleError editRule(const Rule &rule);
 
     QList<Rule> rules() const;
     QList<RuleId> ruleIds() const;
+    const ChangeJournal &changeJournal() const;
 
     RuleError removeRule(const RuleId &ruleId, bool fromEdit = false);
 
@@ -98,8 +120,11 @@ signals:
     void ruleConfigurationChanged(const Rule &rule);
 
 private:
-    bool containsEvent(const Rule &rule, const Event &event);
-    bool containsState(const StateEvaluator &stateEvaluator, const Event &stateChangeEvent);
+    QList<Rule> matchEvent(const Event &event, const QList<State> &assumedStates, QHash<RuleId, Statistics> *statistics) const;
+    void recordTriggered(const Rule &rule);
+
+    bool containsEvent(const Rule &rule, const Event &event) const;
+    bool containsState(const StateEvaluator &stateEvaluator, const Event &stateChangeEvent) const;
 
     bool checkEventDescriptors(const QList<EventDescriptor> eventDescriptors, const EventTypeId &eventTypeId);
     QVariant::Type getActionParamType(const ActionTypeId &actionTypeId, const ParamTypeId &paramTypeId);
@@ -112,6 +137,10 @@ private:
     QList<RuleId> m_ruleIds; // Keeping a list of RuleIds to keep sorting order...
     QHash<RuleId, Rule> m_rules; // ...but use a Hash for faster finding
     QList<RuleId> m_activeRules;
+    QHash<RuleId, Statistics> m_statistics;
+
+    ChangeJournal m_changeJournal;
+    MetricHistogram *m_evaluationMetric;
 };
 
 }
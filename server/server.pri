@@ -4,6 +4,10 @@ RESOURCES += $$top_srcdir/icons.qrc
 HEADERS += $$top_srcdir/server/guhcore.h \
     $$top_srcdir/server/tcpserver.h \
     $$top_srcdir/server/ruleengine.h \
+    $$top_srcdir/server/actiondispatcher.h \
+    $$top_srcdir/server/catalogcache.h \
+    $$top_srcdir/server/readmodel.h \
+    $$top_srcdir/server/stallwatchdog.h \
     $$top_srcdir/server/rule.h \
     $$top_srcdir/server/stateevaluator.h \
     $$top_srcdir/server/webserver.h \
@@ -26,6 +30,7 @@ HEADERS += $$top_srcdir/server/guhcore.h \
     $$top_srcdir/server/jsonrpc/cloudhandler.h \
     $$top_srcdir/server/jsonrpc/configurationhandler.h \
     $$top_srcdir/server/jsonrpc/networkmanagerhandler.h \
+    $$top_srcdir/server/jsonrpc/metricshandler.h \
     $$top_srcdir/server/logging/logging.h \
     $$top_srcdir/server/logging/logengine.h \
     $$top_srcdir/server/logging/logfilter.h \
@@ -38,6 +43,8 @@ HEADERS += $$top_srcdir/server/guhcore.h \
     $$top_srcdir/server/rest/logsresource.h \
     $$top_srcdir/server/rest/pluginsresource.h \
     $$top_srcdir/server/rest/rulesresource.h \
+    $$top_srcdir/server/rest/systemresource.h \
+    $$top_srcdir/server/rest/eventstream.h \
     $$top_srcdir/server/time/timedescriptor.h \
     $$top_srcdir/server/time/calendaritem.h \
     $$top_srcdir/server/time/repeatingoption.h \
@@ -65,6 +72,10 @@ HEADERS += $$top_srcdir/server/guhcore.h \
 SOURCES += $$top_srcdir/server/guhcore.cpp \
     $$top_srcdir/server/tcpserver.cpp \
     $$top_srcdir/server/ruleengine.cpp \
+    $$top_srcdir/server/actiondispatcher.cpp \
+    $$top_srcdir/server/catalogcache.cpp \
+    $$top_srcdir/server/readmodel.cpp \
+    $$top_srcdir/server/stallwatchdog.cpp \
     $$top_srcdir/server/rule.cpp \
     $$top_srcdir/server/stateevaluator.cpp \
     $$top_srcdir/server/webserver.cpp \
@@ -87,6 +98,7 @@ SOURCES += $$top_srcdir/server/guhcore.cpp \
     $$top_srcdir/server/jsonrpc/cloudhandler.cpp \
     $$top_srcdir/server/jsonrpc/configurationhandler.cpp \
     $$top_srcdir/server/jsonrpc/networkmanagerhandler.cpp \
+    $$top_srcdir/server/jsonrpc/metricshandler.cpp \
     $$top_srcdir/server/logging/logengine.cpp \
     $$top_srcdir/server/logging/logfilter.cpp \
     $$top_srcdir/server/logging/logentry.cpp \
@@ -98,6 +110,8 @@ SOURCES += $$top_srcdir/server/guhcore.cpp \
     $$top_srcdir/server/rest/logsresource.cpp \
     $$top_srcdir/server/rest/pluginsresource.cpp \
     $$top_srcdir/server/rest/rulesresource.cpp \
+    $$top_srcdir/server/rest/systemresource.cpp \
+    $$top_srcdir/server/rest/eventstream.cpp \
     $$top_srcdir/server/time/timedescriptor.cpp \
     $$top_srcdir/server/time/calendaritem.cpp \
     $$top_srcdir/server/time/repeatingoption.cpp \
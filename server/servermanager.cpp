@@ -73,6 +73,9 @@ ServerManager::ServerManager(QObject *parent) :
     m_jsonServer = new JsonRPCServer(m_sslConfiguration, this);
 
     m_restServer = new RestServer(m_sslConfiguration, this);
+
+    // stream the notifications also to the REST clients
+    connect(m_jsonServer, &JsonRPCServer::notificationReady, m_restServer->eventStream(), &EventStream::publishNotification);
 }
 
 /*! Returns the pointer to the created \l{JsonRPCServer} in this \l{ServerManager}. */
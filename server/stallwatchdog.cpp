@@ -0,0 +1,189 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/*!
+    \class guhserver::StallWatchdog
+    \brief This class detects stalls of the main event loop of the guh server.
+
+    \ingroup server
+    \inmodule core
+
+    The plugins, the \l{RuleEngine}, the \l{LogEngine} and the JSON-RPC handlers share the main thread.
+    The \l{StallWatchdog} sends a heartbeat through the main event loop every \l{interval()} milliseconds
+    and measures how late it arrives. The latency gets recorded in the \l{MetricHistogram}
+    \tt guh_event_loop_latency_microseconds.
+
+    A watchdog thread checks the heartbeat independently of the main thread. As soon as the event loop is
+    blocked longer than the \l{threshold()}, it logs the \l{CallTrace::context()}{call context} of the main
+    thread, so the blocking plugin or handler can be named even if the event loop never recovers. Once the
+    heartbeat arrives again, the whole stall gets recorded in \l{stalls()}.
+
+    \sa CallTrace
+*/
+
+#include "stallwatchdog.h"
+#include "metrics.h"
+#include "loggingcategories.h"
+
+namespace guhserver {
+
+static const int s_maxStalls = 20;
+
+/*! Constructs a \l{StallWatchdog} with the given \a parent. The watchdog has to be created in the main thread. */
+StallWatchdog::StallWatchdog(QObject *parent) :
+    QThread(parent),
+    m_lastBeat(0),
+    m_interval(50),
+    m_threshold(250),
+    m_watching(0),
+    m_stallDetected(false)
+{
+    m_heartbeatTimer = new QTimer(this);
+    m_heartbeatTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &StallWatchdog::heartbeat);
+
+    m_latencyMetric = Metrics::histogram("guh_event_loop_latency_microseconds", "Delay of the main event loop heartbeat.", Metrics::durationBounds());
+    m_stallMetric = Metrics::counter("guh_event_loop_stalls_total", "Event loop stalls longer than the watchdog threshold.");
+}
+
+/*! Stops the watchdog thread and destroys this \l{StallWatchdog}. */
+StallWatchdog::~StallWatchdog()
+{
+    stopWatching();
+}
+
+/*! Starts the heartbeat and the watchdog thread. */
+void StallWatchdog::startWatching()
+{
+    if (m_watching.load())
+        return;
+
+    qCDebug(dcWatchdog) << "Start watching the event loop with a threshold of" << threshold() << "ms";
+    m_clock.start();
+    m_lastBeat.store(0);
+    m_watching.store(1);
+    m_heartbeatTimer->start(interval());
+    start(QThread::LowPriority);
+}
+
+/*! Stops the heartbeat and waits until the watchdog thread has finished. */
+void StallWatchdog::stopWatching()
+{
+    if (!m_watching.load())
+        return;
+
+    m_watching.store(0);
+    m_heartbeatTimer->stop();
+    wait();
+}
+
+/*! Returns the interval [ms] of the heartbeat. The default is 50 ms. */
+int StallWatchdog::interval() const
+{
+    return m_interval.load();
+}
+
+/*! Sets the \a interval [ms] of the heartbeat. */
+void StallWatchdog::setInterval(const int &interval)
+{
+    m_interval.store(interval);
+    if (m_heartbeatTimer->isActive())
+        m_heartbeatTimer->start(interval);
+}
+
+/*! Returns the time [ms] the event loop can be blocked before it counts as stall. The default is 250 ms. */
+int StallWatchdog::threshold() const
+{
+    return m_threshold.load();
+}
+
+/*! Sets the stall \a threshold [ms]. */
+void StallWatchdog::setThreshold(const int &threshold)
+{
+    m_threshold.store(threshold);
+}
+
+/*! Returns the longest recorded stalls, the longest one first. The duration of a stall is the time the
+ *  heartbeat was late. */
+QList<CallTrace::Record> StallWatchdog::stalls() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stalls;
+}
+
+/*! The watchdog thread. It never touches the main thread, it only reads the time of the last heartbeat. */
+void StallWatchdog::run()
+{
+    while (m_watching.load()) {
+        QThread::msleep(m_interval.load());
+
+        qint64 blocked = m_clock.elapsed() - m_lastBeat.load() - m_interval.load();
+        if (blocked < m_threshold.load())
+            continue;
+
+        QMutexLocker locker(&m_mutex);
+        if (m_stallDetected)
+            continue;
+
+        QStringList context = CallTrace::context();
+        m_stallDetected = true;
+        m_stallContext = context;
+        locker.unlock();
+
+        qCWarning(dcWatchdog) << "Event loop blocked for more than" << blocked << "ms in" << (context.isEmpty() ? QString("unknown context") : context.join(" > "));
+    }
+}
+
+void StallWatchdog::heartbeat()
+{
+    qint64 now = m_clock.elapsed();
+    qint64 latency = qMax(qint64(0), now - m_lastBeat.load() - m_interval.load());
+    m_lastBeat.store(now);
+    m_latencyMetric->observe(latency * 1000);
+
+    if (latency < m_threshold.load())
+        return;
+
+    m_stallMetric->increment();
+
+    QMutexLocker locker(&m_mutex);
+    CallTrace::Record stall;
+    stall.site = m_stallContext.isEmpty() ? QString("Event loop") : m_stallContext.last();
+    stall.context = m_stallContext;
+    stall.duration = latency;
+    stall.timestamp = QDateTime::currentDateTime();
+    m_stallDetected = false;
+    m_stallContext.clear();
+
+    int index = 0;
+    while (index < m_stalls.count() && m_stalls.at(index).duration >= stall.duration)
+        index++;
+
+    if (index < s_maxStalls) {
+        m_stalls.insert(index, stall);
+        if (m_stalls.count() > s_maxStalls)
+            m_stalls.removeLast();
+    }
+    locker.unlock();
+
+    qCWarning(dcWatchdog) << "Event loop stalled for" << latency << "ms in" << (stall.context.isEmpty() ? QString("unknown context") : stall.context.join(" > "));
+}
+
+}
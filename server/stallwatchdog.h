@@ -0,0 +1,83 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include "calltrace.h"
+
+#include <QList>
+#include <QMutex>
+#include <QTimer>
+#include <QThread>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+
+class MetricCounter;
+class MetricHistogram;
+
+namespace guhserver {
+
+class StallWatchdog : public QThread
+{
+    Q_OBJECT
+public:
+    explicit StallWatchdog(QObject *parent = 0);
+    ~StallWatchdog();
+
+    void startWatching();
+    void stopWatching();
+
+    int interval() const;
+    void setInterval(const int &interval);
+
+    int threshold() const;
+    void setThreshold(const int &threshold);
+
+    QList<CallTrace::Record> stalls() const;
+
+protected:
+    void run() override;
+
+private:
+    QTimer *m_heartbeatTimer;
+    QElapsedTimer m_clock;
+    QAtomicInteger<qint64> m_lastBeat;
+    QAtomicInt m_interval;
+    QAtomicInt m_threshold;
+    QAtomicInt m_watching;
+
+    mutable QMutex m_mutex;
+    bool m_stallDetected;
+    QStringList m_stallContext;
+    QList<CallTrace::Record> m_stalls;
+
+    MetricHistogram *m_latencyMetric;
+    MetricCounter *m_stallMetric;
+
+private slots:
+    void heartbeat();
+
+};
+
+}
+
+#endif // STALLWATCHDOG_H
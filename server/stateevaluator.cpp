@@ -96,20 +96,35 @@ void StateEvaluator::setOperatorType(Types::StateOperator operatorType)
     m_operatorType = operatorType;
 }
 
-/*! Returns true, if all child evaluator conditions are true depending on the \l {Types::StateOperator}{StateOperator}.*/
-bool StateEvaluator::evaluate() const
+/*! Returns true, if all child evaluator conditions are true depending on the \l {Types::StateOperator}{StateOperator}.
+    The \a assumedStates replace the current values of the matching device states, which allows to
+    evaluate a hypothetical state change without applying it.
+*/
+bool StateEvaluator::evaluate(const QList<State> &assumedStates) const
 {
     if (m_stateDescriptor.isValid()) {
-        Device *device = GuhCore::instance()->deviceManager()->findConfiguredDevice(m_stateDescriptor.deviceId());
-        if (!device) {
-            qCWarning(dcRuleEngine) << "Device not existing!";
-            return false;
+        State state(StateTypeId(), DeviceId());
+        foreach (const State &assumedState, assumedStates) {
+            if (assumedState.deviceId() == m_stateDescriptor.deviceId() && assumedState.stateTypeId() == m_stateDescriptor.stateTypeId()) {
+                state = assumedState;
+                break;
+            }
         }
-        if (!device->hasState(m_stateDescriptor.stateTypeId())) {
-            qCWarning(dcRuleEngine) << "Device found, but it does not appear to have such a state!";
-            return false;
+
+        if (state.stateTypeId().isNull()) {
+            Device *device = GuhCore::instance()->deviceManager()->findConfiguredDevice(m_stateDescriptor.deviceId());
+            if (!device) {
+                qCWarning(dcRuleEngine) << "Device not existing!";
+                return false;
+            }
+            if (!device->hasState(m_stateDescriptor.stateTypeId())) {
+                qCWarning(dcRuleEngine) << "Device found, but it does not appear to have such a state!";
+                return false;
+            }
+            state = device->state(m_stateDescriptor.stateTypeId());
         }
-        if (m_stateDescriptor != device->state(m_stateDescriptor.stateTypeId())) {
+
+        if (m_stateDescriptor != state) {
             // state not matching
             return false;
         }
@@ -117,7 +132,7 @@ bool StateEvaluator::evaluate() const
 
     if (m_operatorType == Types::StateOperatorOr) {
         foreach (const StateEvaluator &stateEvaluator, m_childEvaluators) {
-            if (stateEvaluator.evaluate()) {
+            if (stateEvaluator.evaluate(assumedStates)) {
                 return true;
             }
         }
@@ -125,7 +140,7 @@ bool StateEvaluator::evaluate() const
     }
 
     foreach (const StateEvaluator &stateEvaluator, m_childEvaluators) {
-        if (!stateEvaluator.evaluate()) {
+        if (!stateEvaluator.evaluate(assumedStates)) {
             return false;
         }
     }
@@ -46,7 +46,7 @@ public:
     Types::StateOperator operatorType() const;
     void setOperatorType(Types::StateOperator operatorType);
 
-    bool evaluate() const;
+    bool evaluate(const QList<State> &assumedStates = QList<State>()) const;
     bool containsDevice(const DeviceId &deviceId) const;
 
     void removeDevice(const DeviceId &deviceId);
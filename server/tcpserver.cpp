@@ -40,7 +40,6 @@
 #include "jsonrpcserver.h"
 
 #include <QDebug>
-#include <QJsonDocument>
 
 namespace guhserver {
 
@@ -58,6 +57,10 @@ TcpServer::TcpServer(const QHostAddress &host, const uint &port, QObject *parent
     m_avahiService = new QtAvahiService(this);
     connect(m_avahiService, &QtAvahiService::serviceStateChanged, this, &TcpServer::onAvahiServiceStateChanged);
 #endif
+
+    m_clientsMetric = Metrics::gauge("guh_transport_clients", "Connected clients of the transport.", "transport", "tcp");
+    m_sentBytesMetric = Metrics::counter("guh_transport_sent_bytes_total", "Bytes sent to the clients of the transport.", "transport", "tcp");
+    m_receivedBytesMetric = Metrics::counter("guh_transport_received_bytes_total", "Bytes received from the clients of the transport.", "transport", "tcp");
 }
 
 /*! Destructor of this \l{TcpServer}. */
@@ -67,21 +70,14 @@ TcpServer::~TcpServer()
     stopServer();
 }
 
-/*! Sending \a data to a list of \a clients.*/
-void TcpServer::sendData(const QList<QUuid> &clients, const QVariantMap &data)
-{
-    foreach (const QUuid &client, clients) {
-        sendData(client, data);
-    }
-}
-
-/*! Sending \a data to the client with the given \a clientId.*/
-void TcpServer::sendData(const QUuid &clientId, const QVariantMap &data)
+/*! Sending the encoded \a payload to the client with the given \a clientId.*/
+void TcpServer::sendPayload(const QUuid &clientId, const QByteArray &payload)
 {
     QTcpSocket *client = 0;
     client = m_clientList.value(clientId);
     if (client) {
-        client->write(QJsonDocument::fromVariant(data).toJson());
+        client->write(payload);
+        m_sentBytesMetric->increment(payload.size());
     }
 }
 
@@ -96,6 +92,7 @@ void TcpServer::onClientConnected()
 
     // append the new client to the client list
     m_clientList.insert(clientId, newConnection);
+    m_clientsMetric->set(m_clientList.count());
 
     connect(newConnection, SIGNAL(readyRead()),this,SLOT(readPackage()));
     connect(newConnection,SIGNAL(disconnected()),this,SLOT(onClientDisconnected()));
@@ -107,15 +104,21 @@ void TcpServer::readPackage()
 {
     QTcpSocket *client = qobject_cast<QTcpSocket*>(sender());
     qCDebug(dcTcpServer) << "Data comming from" << client->peerAddress().toString();
-    QByteArray message;
-    while (client->canReadLine()) {
-        QByteArray dataLine = client->readLine();
-        qCDebug(dcTcpServer) << "Line in:" << dataLine;
-        message.append(dataLine);
-        if (dataLine.endsWith('\n')) {
-            validateMessage(m_clientList.key(client), message);
-            message.clear();
-        }
+
+    // the framer of each client keeps incomplete messages until the rest arrives
+    QUuid clientId = m_clientList.key(client);
+    JsonStreamFramer &framer = m_clientFramers[clientId];
+    QByteArray data = client->readAll();
+    m_receivedBytesMetric->increment(data.size());
+    if (!framer.append(data)) {
+        qCWarning(dcTcpServer) << "Message from" << client->peerAddress().toString() << "exceeds the maximum size of" << framer.maximumMessageSize() << "bytes";
+        sendErrorResponse(clientId, -1, QString("Message exceeds the maximum size of %1 bytes").arg(framer.maximumMessageSize()));
+    }
+
+    while (framer.hasMessage()) {
+        QByteArray message = framer.takeMessage();
+        qCDebug(dcTcpServer) << "Message in:" << message;
+        validateMessage(clientId, message);
     }
 }
 
@@ -127,7 +130,9 @@ void TcpServer::onClientDisconnected()
 
     qCDebug(dcConnection) << "Tcp server: client disconnected:" << client->peerAddress().toString();
     QUuid clientId = m_clientList.key(client);
+    m_clientFramers.remove(clientId);
     m_clientList.take(clientId)->deleteLater();
+    m_clientsMetric->set(m_clientList.count());
 }
 
 void TcpServer::onError(QAbstractSocket::SocketError error)
@@ -31,6 +31,8 @@
 
 #include "transportinterface.h"
 #include "network/avahi/qtavahiservice.h"
+#include "network/jsonstreamframer.h"
+#include "metrics.h"
 
 namespace guhserver {
 
@@ -41,8 +43,7 @@ public:
     explicit TcpServer(const QHostAddress &host, const uint &port, QObject *parent = 0);
     ~TcpServer();
 
-    void sendData(const QUuid &clientId, const QVariantMap &data) override;
-    void sendData(const QList<QUuid> &clients, const QVariantMap &data) override;
+    void sendPayload(const QUuid &clientId, const QByteArray &payload) override;
 
 private:
     QTimer *m_timer;
@@ -51,10 +52,15 @@ private:
 
     QTcpServer * m_server;
     QHash<QUuid, QTcpSocket *> m_clientList;
+    QHash<QUuid, JsonStreamFramer> m_clientFramers;
 
     QHostAddress m_host;
     qint16 m_port;
 
+    MetricGauge *m_clientsMetric;
+    MetricCounter *m_sentBytesMetric;
+    MetricCounter *m_receivedBytesMetric;
+
 private slots:
     void onClientConnected();
     void onClientDisconnected();
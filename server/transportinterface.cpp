@@ -54,25 +54,23 @@
     \sa WebSocketServer::stopServer(), TcpServer::stopServer()
 */
 
-/*! \fn void guhserver::TransportInterface::sendData(const QUuid &clientId, const QVariantMap &data);
-    Pure virtual method for sending \a data to the client with the id \a clientId over the corresponding \l{TransportInterface}.
-*/
-
-/*! \fn void guhserver::TransportInterface::sendData(const QList<QUuid> &clients, const QVariantMap &data);
-    Pure virtual method for sending \a data to \a clients over the corresponding \l{TransportInterface}.
+/*! \fn void guhserver::TransportInterface::sendPayload(const QUuid &clientId, const QByteArray &payload);
+    Pure virtual method for sending the \l{encode()}{encoded} \a payload to the client with the id \a clientId over
+    the corresponding \l{TransportInterface}. This method gets always called on the main thread.
 */
 
 /*! \fn void guhserver::TransportInterface::dataAvailable(const QUuid &clientId, const QString &targetNamespace, const QString &method, const QVariantMap &message);
     This signal is emitted when valid data from the client with the given \a clientId are available.
     Data are valid if the corresponding \l{TransportInterface} has parsed successfully the given
-    \a targetNamespace, \a method and \a message.
+    \a targetNamespace, \a method and \a message. Transports which receive raw JSON data should use
+    \l{validateMessage()} instead, so the message gets parsed on a worker thread of the \l{JsonRPCServer}.
 
-    \sa WebSocketServer, TcpServer
+    \sa CloudManager
 */
 
 #include "transportinterface.h"
 #include "loggingcategories.h"
-#include "jsonhandler.h"
+#include "jsonrpcserver.h"
 #include "guhcore.h"
 
 #include <QJsonDocument>
@@ -90,80 +88,75 @@ TransportInterface::~TransportInterface()
 {
 }
 
+/*! Sends the given \a data to the client with the given \a clientId. The \a data get \l{encode()}{encoded}
+ *  and written with \l{sendPayload()}.
+ */
+void TransportInterface::sendData(const QUuid &clientId, const QVariantMap &data)
+{
+    sendPayload(clientId, encode(data));
+}
+
+/*! Sends the given \a data to the given \a clients. The \a data get \l{encode()}{encoded} only once for all clients. */
+void TransportInterface::sendData(const QList<QUuid> &clients, const QVariantMap &data)
+{
+    if (clients.isEmpty())
+        return;
+
+    QByteArray payload = encode(data);
+    foreach (const QUuid &clientId, clients)
+        sendPayload(clientId, payload);
+}
+
+/*! Returns the given \a data encoded for this \l{TransportInterface}. This method can be called from any thread. */
+QByteArray TransportInterface::encode(const QVariantMap &data) const
+{
+    return QJsonDocument::fromVariant(data).toJson();
+}
+
 /*! Send a JSON success response to the client with the given \a clientId,
  * \a commandId and \a params to the inerted \l{TransportInterface}.
  */
 void TransportInterface::sendResponse(const QUuid &clientId, int commandId, const QVariantMap &params)
 {
-    QVariantMap response;
-    response.insert("id", commandId);
-    response.insert("status", "success");
-    response.insert("params", params);
-
-    sendData(clientId, response);
+    sendData(clientId, createResponse(commandId, params));
 }
 
 /*! Send a JSON error response to the client with the given \a clientId,
  * \a commandId and \a error to the inerted \l{TransportInterface}.
  */
 void TransportInterface::sendErrorResponse(const QUuid &clientId, int commandId, const QString &error)
+{
+    sendData(clientId, createErrorResponse(commandId, error));
+}
+
+/*! Returns the JSON success response for the given \a commandId and \a params. */
+QVariantMap TransportInterface::createResponse(int commandId, const QVariantMap &params)
+{
+    QVariantMap response;
+    response.insert("id", commandId);
+    response.insert("status", "success");
+    response.insert("params", params);
+    return response;
+}
+
+/*! Returns the JSON error response for the given \a commandId and \a error. */
+QVariantMap TransportInterface::createErrorResponse(int commandId, const QString &error)
 {
     QVariantMap errorResponse;
     errorResponse.insert("id", commandId);
     errorResponse.insert("status", "error");
     errorResponse.insert("error", error);
-
-    sendData(clientId, errorResponse);
+    return errorResponse;
 }
 
-/*! Validates the given \a data from the client with the id \a clientId. If the validation was
- *  successfull, the signal \l{dataAvailable()} will be emitted, otherwise an error response
- *  will be sent to the client.
+/*! Hands the raw \a data received from the client with the id \a clientId to the \l{JsonRPCServer}. The message
+ *  gets parsed and validated on a worker thread, errors get sent back to the client.
  *
- *  \sa dataAvailable()
+ *  \sa JsonRPCServer::dispatchMessage()
  */
 void TransportInterface::validateMessage(const QUuid &clientId, const QByteArray &data)
 {
-    QJsonParseError error;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
-
-    if(error.error != QJsonParseError::NoError) {
-        qCWarning(dcJsonRpc) << "Failed to parse JSON data" << data << ":" << error.errorString();
-        sendErrorResponse(clientId, -1, QString("Failed to parse JSON data: %1").arg(error.errorString()));
-        return;
-    }
-
-    QVariantMap message = jsonDoc.toVariant().toMap();
-
-    bool success;
-    int commandId = message.value("id").toInt(&success);
-    if (!success) {
-        qCWarning(dcJsonRpc) << "Error parsing command. Missing \"id\":" << message;
-        sendErrorResponse(clientId, commandId, "Error parsing command. Missing 'id'");
-        return;
-    }
-
-    QStringList commandList = message.value("method").toString().split('.');
-    if (commandList.count() != 2) {
-        qCWarning(dcJsonRpc) << "Error parsing method.\nGot:" << message.value("method").toString() << "\nExpected: \"Namespace.method\"";
-        sendErrorResponse(clientId, commandId, QString("Error parsing method. Got: '%1'', Expected: 'Namespace.method'").arg(message.value("method").toString()));
-        return;
-    }
-
-    QString targetNamespace = commandList.first();
-    QString method = commandList.last();
-
-    JsonHandler *handler = GuhCore::instance()->jsonRPCServer()->handlers().value(targetNamespace);
-    if (!handler) {
-        sendErrorResponse(clientId, commandId, "No such namespace");
-        return;
-    }
-    if (!handler->hasMethod(method)) {
-        sendErrorResponse(clientId, commandId, "No such method");
-        return;
-    }
-
-    emit dataAvailable(clientId, targetNamespace, method, message);
+    GuhCore::instance()->jsonRPCServer()->dispatchMessage(this, clientId, data);
 }
 
 }
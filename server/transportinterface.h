@@ -23,6 +23,7 @@
 
 #include <QVariant>
 #include <QString>
+#include <QByteArray>
 #include <QList>
 #include <QUuid>
 
@@ -35,12 +36,18 @@ public:
     explicit TransportInterface(QObject *parent = 0);
     virtual ~TransportInterface() = 0;
 
-    virtual void sendData(const QUuid &clientId, const QVariantMap &data) = 0;
-    virtual void sendData(const QList<QUuid> &clients, const QVariantMap &data) = 0;
+    virtual void sendData(const QUuid &clientId, const QVariantMap &data);
+    virtual void sendData(const QList<QUuid> &clients, const QVariantMap &data);
+
+    virtual QByteArray encode(const QVariantMap &data) const;
+    virtual void sendPayload(const QUuid &clientId, const QByteArray &payload) = 0;
 
     void sendResponse(const QUuid &clientId, int commandId, const QVariantMap &params = QVariantMap());
     void sendErrorResponse(const QUuid &clientId, int commandId, const QString &error);
 
+    static QVariantMap createResponse(int commandId, const QVariantMap &params = QVariantMap());
+    static QVariantMap createErrorResponse(int commandId, const QString &error);
+
 protected:
     void validateMessage(const QUuid &clientId, const QByteArray &data);
 
@@ -44,6 +44,9 @@
     The URL for the secure HTTPS (TLS 1.2) REST API access to a \l{RestResource}:
     \code https://localhost:3333/api/v1/{RestResource}\endcode
 
+    The runtime \l{Metrics} of guhd can be scraped in the Prometheus text format from:
+    \code http://localhost:3333/metrics\endcode
+
     You can turn on the HTTPS server in the \tt WebServer section of the \tt /etc/guh/guhd.conf file.
 
     \note For \tt HTTPS you need to have a certificate and configure it in the \tt SSL-configuration
@@ -92,6 +95,9 @@
 
 namespace guhserver {
 
+// pending event stream data of a single client, above this the client is considered stalled
+static const qint64 eventStreamBufferLimit = 1024 * 1024;
+
 /*! Constructs a \l{WebServer} with the given \a host, \a port, \a publicFolder and \a parent.
  *
  *  \sa ServerManager
@@ -114,6 +120,10 @@ WebServer::WebServer(const QHostAddress &host, const uint &port, const QString &
     m_avahiService = new QtAvahiService(this);
     connect(m_avahiService, &QtAvahiService::serviceStateChanged, this, &WebServer::onAvahiServiceStateChanged);
 #endif
+
+    m_clientsMetric = Metrics::gauge("guh_transport_clients", "Connected clients of the transport.", "transport", "http");
+    m_sentBytesMetric = Metrics::counter("guh_transport_sent_bytes_total", "Bytes sent to the clients of the transport.", "transport", "http");
+    m_receivedBytesMetric = Metrics::counter("guh_transport_received_bytes_total", "Bytes received from the clients of the transport.", "transport", "http");
 }
 
 /*! Destructor of this \l{WebServer}. */
@@ -137,10 +147,66 @@ void WebServer::sendHttpReply(HttpReply *reply)
         return;
     }
 
-    // send raw data
-    reply->packReply();
+    // serialize the header once and write it and the payload without joining them
     qCDebug(dcWebServer) << "respond" << reply->httpStatusCode() << reply->httpReasonPhrase();
-    socket->write(reply->data());
+    QByteArray header = reply->rawHeader();
+    socket->write(header);
+    if (!reply->payload().isEmpty())
+        socket->write(reply->payload());
+
+    m_sentBytesMetric->increment(header.size() + reply->payload().size());
+}
+
+/*! Sends the header of the given event stream \a reply to the corresponding client and keeps the
+ *  connection open. The connection will not time out any more and further requests on it will be ignored.
+ *  Returns false if the client does not exist.
+ *
+ * \sa EventStream, sendEventStreamData()
+ */
+bool WebServer::startEventStream(HttpReply *reply)
+{
+    QSslSocket *socket = m_clientList.value(reply->clientId());
+    if (!socket) {
+        qCWarning(dcWebServer) << "Could not start event stream for unknown client" << reply->clientId().toString();
+        return false;
+    }
+
+    // the stream never times out, the keep-alive parameters of the default headers don't apply
+    reply->removeRawHeader("Keep-Alive");
+    sendHttpReply(reply);
+
+    foreach (WebServerClient *webserverClient, m_webServerClients) {
+        if (webserverClient->address() == socket->peerAddress()) {
+            webserverClient->stopTimout(socket);
+            break;
+        }
+    }
+
+    m_eventStreams.append(socket);
+    return true;
+}
+
+/*! Writes the given event stream \a data to the client with the given \a clientId. A client which does not
+ *  read its stream any more gets disconnected once more than 1 MiB is waiting to be written.
+ *
+ * \sa startEventStream()
+ */
+void WebServer::sendEventStreamData(const QUuid &clientId, const QByteArray &data)
+{
+    QSslSocket *socket = m_clientList.value(clientId);
+    if (!socket || !m_eventStreams.contains(socket))
+        return;
+
+    if (socket->bytesToWrite() + data.size() > eventStreamBufferLimit) {
+        // the disconnect would remove the stream while the caller iterates over its streams
+        qCWarning(dcWebServer) << "Event stream client" << clientId.toString() << "is too slow, closing the connection";
+        m_eventStreams.removeAll(socket);
+        QTimer::singleShot(0, socket, [socket]() { socket->abort(); });
+        return;
+    }
+
+    socket->write(data);
+    m_sentBytesMetric->increment(data.size());
 }
 
 /*! Returns the port on which the webserver is listening. */
@@ -284,6 +350,7 @@ void WebServer::incomingConnection(qintptr socketDescriptor)
     // append the new client to the client list
     QUuid clientId = QUuid::createUuid();
     m_clientList.insert(clientId, socket);
+    m_clientsMetric->set(m_clientList.count());
 
     qCDebug(dcConnection) << QString("Webserver client %1:%2 connected").arg(socket->peerAddress().toString()).arg(socket->peerPort());
 
@@ -320,6 +387,11 @@ void WebServer::readClient()
 
     // read HTTP request
     QByteArray data = socket->readAll();
+    m_receivedBytesMetric->increment(data.size());
+
+    // an event stream only sends data to the client
+    if (m_eventStreams.contains(socket))
+        return;
 
     HttpRequest request;
     if (m_incompleteRequests.contains(socket)) {
@@ -405,6 +477,16 @@ void WebServer::readClient()
         return;
     }
 
+    // check metrics call
+    if (request.url().path() == "/metrics" && request.method() == HttpRequest::Get) {
+        HttpReply *reply = RestResource::createSuccessReply();
+        reply->setHeader(HttpReply::ContentTypeHeader, "text/plain; version=0.0.4; charset=utf-8");
+        reply->setPayload(Metrics::prometheusText());
+        reply->setClientId(clientId);
+        sendHttpReply(reply);
+        reply->deleteLater();
+        return;
+    }
 
     // request for a file...
     if (request.method() == HttpRequest::Get) {
@@ -490,7 +572,9 @@ void WebServer::onDisconnected()
     // clean up
     QUuid clientId = m_clientList.key(socket);
     m_clientList.remove(clientId);
+    m_clientsMetric->set(m_clientList.count());
     m_incompleteRequests.remove(socket);
+    m_eventStreams.removeAll(socket);
     emit clientDisconnected(clientId);
 
     socket->deleteLater();
@@ -802,6 +886,16 @@ void WebServerClient::resetTimout(QSslSocket *socket)
         timer->start();
 }
 
+/*! Stops the connection timeout for the given \a socket. The connection stays open until one of the
+ *  sides closes it. This will be used for event streams.
+ */
+void WebServerClient::stopTimout(QSslSocket *socket)
+{
+    QTimer *timer = m_runningConnections.key(socket);
+    if (timer)
+        timer->stop();
+}
+
 void WebServerClient::onTimout()
 {
     QTimer *timer =  static_cast<QTimer *>(sender());
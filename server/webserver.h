@@ -35,6 +35,7 @@
 #include <QSslKey>
 
 #include "network/avahi/qtavahiservice.h"
+#include "metrics.h"
 
 // Note: Hypertext Transfer Protocol (HTTP/1.1) from the Internet Engineering Task Force (IETF):
 //       https://tools.ietf.org/html/rfc7231
@@ -57,6 +58,7 @@ public:
     void removeConnection(QSslSocket *socket);
 
     void resetTimout(QSslSocket *socket);
+    void stopTimout(QSslSocket *socket);
 
 private:
     QHostAddress m_address;
@@ -76,6 +78,8 @@ public:
     ~WebServer();
 
     void sendHttpReply(HttpReply *reply);
+    bool startEventStream(HttpReply *reply);
+    void sendEventStreamData(const QUuid &clientId, const QByteArray &data);
     int port() const;
     QList<QHostAddress> serverAddressList();
 
@@ -84,6 +88,7 @@ private:
     QHash<QUuid, QSslSocket *> m_clientList;
     QList<WebServerClient *> m_webServerClients;
     QHash<QSslSocket *, HttpRequest> m_incompleteRequests;
+    QList<QSslSocket *> m_eventStreams;
 
     QtAvahiService *m_avahiService;
 
@@ -96,6 +101,10 @@ private:
 
     bool m_enabled;
 
+    MetricGauge *m_clientsMetric;
+    MetricCounter *m_sentBytesMetric;
+    MetricCounter *m_receivedBytesMetric;
+
     bool verifyFile(QSslSocket *socket, const QString &fileName);
     QString fileName(const QString &query);
 
@@ -52,7 +52,6 @@
 #include "websocketserver.h"
 #include "loggingcategories.h"
 
-#include <QJsonDocument>
 #include <QSslConfiguration>
 
 namespace guhserver {
@@ -73,6 +72,10 @@ WebSocketServer::WebSocketServer(const QHostAddress &address, const uint &port,
     m_avahiService = new QtAvahiService(this);
     connect(m_avahiService, &QtAvahiService::serviceStateChanged, this, &WebSocketServer::onAvahiServiceStateChanged);
 #endif
+
+    m_clientsMetric = Metrics::gauge("guh_transport_clients", "Connected clients of the transport.", "transport", "websocket");
+    m_sentBytesMetric = Metrics::counter("guh_transport_sent_bytes_total", "Bytes sent to the clients of the transport.", "transport", "websocket");
+    m_receivedBytesMetric = Metrics::counter("guh_transport_received_bytes_total", "Bytes received from the clients of the transport.", "transport", "websocket");
 }
 
 /*! Destructor of this \l{WebSocketServer}. */
@@ -82,27 +85,17 @@ WebSocketServer::~WebSocketServer()
     stopServer();
 }
 
-/*! Send the given \a data map to the client with the given \a clientId.
+/*! Send the given encoded \a payload to the client with the given \a clientId.
  *
- * \sa TransportInterface::sendData()
+ * \sa TransportInterface::sendPayload()
  */
-void WebSocketServer::sendData(const QUuid &clientId, const QVariantMap &data)
+void WebSocketServer::sendPayload(const QUuid &clientId, const QByteArray &payload)
 {
     QWebSocket *client = 0;
     client = m_clientList.value(clientId);
     if (client) {
-        client->sendTextMessage(QJsonDocument::fromVariant(data).toJson());
-    }
-}
-
-/*! Send the given \a data map to the given list of \a clients.
- *
- * \sa TransportInterface::sendData()
- */
-void WebSocketServer::sendData(const QList<QUuid> &clients, const QVariantMap &data)
-{
-    foreach (const QUuid &client, clients) {
-        sendData(client, data);
+        client->sendTextMessage(payload);
+        m_sentBytesMetric->increment(payload.size());
     }
 }
 
@@ -124,6 +117,7 @@ void WebSocketServer::onClientConnected()
 
     // append the new client to the client list
     m_clientList.insert(clientId, client);
+    m_clientsMetric->set(m_clientList.count());
 
     connect(client, SIGNAL(pong(quint64,QByteArray)), this, SLOT(onPing(quint64,QByteArray)));
     connect(client, SIGNAL(binaryMessageReceived(QByteArray)), this, SLOT(onBinaryMessageReceived(QByteArray)));
@@ -140,6 +134,7 @@ void WebSocketServer::onClientDisconnected()
     qCDebug(dcConnection) << "Websocket server: client disconnected:" << client->peerAddress().toString();
     QUuid clientId = m_clientList.key(client);
     m_clientList.take(clientId)->deleteLater();
+    m_clientsMetric->set(m_clientList.count());
 }
 
 void WebSocketServer::onBinaryMessageReceived(const QByteArray &data)
@@ -152,7 +147,9 @@ void WebSocketServer::onTextMessageReceived(const QString &message)
 {
     QWebSocket *client = qobject_cast<QWebSocket *>(sender());
     qCDebug(dcWebSocketServer) << "Text message from" << client->peerAddress().toString() << ":" << message;
-    validateMessage(m_clientList.key(client), message.toUtf8());
+    QByteArray data = message.toUtf8();
+    m_receivedBytesMetric->increment(data.size());
+    validateMessage(m_clientList.key(client), data);
 }
 
 void WebSocketServer::onClientError(QAbstractSocket::SocketError error)
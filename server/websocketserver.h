@@ -30,6 +30,7 @@
 
 #include "network/avahi/qtavahiservice.h"
 #include "transportinterface.h"
+#include "metrics.h"
 
 // Note: WebSocket Protocol from the Internet Engineering Task Force (IETF) -> RFC6455 V13:
 //       http://tools.ietf.org/html/rfc6455
@@ -45,8 +46,7 @@ public:
     explicit WebSocketServer(const QHostAddress &address, const uint &port, const bool &sslEnabled, QObject *parent = 0);
     ~WebSocketServer();
 
-    void sendData(const QUuid &clientId, const QVariantMap &data) override;
-    void sendData(const QList<QUuid> &clients, const QVariantMap &data) override;
+    void sendPayload(const QUuid &clientId, const QByteArray &payload) override;
 
 private:
     QWebSocketServer *m_server;
@@ -62,6 +62,10 @@ private:
 
     bool m_enabled;
 
+    MetricGauge *m_clientsMetric;
+    MetricCounter *m_sentBytesMetric;
+    MetricCounter *m_receivedBytesMetric;
+
 private slots:
     void onClientConnected();
     void onClientDisconnected();
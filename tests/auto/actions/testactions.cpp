@@ -38,6 +38,9 @@ class TestActions: public GuhTestBase
 {
     Q_OBJECT
 
+private:
+    DeviceId addDisplayPinDevice();
+
 private slots:
     void executeAction_data();
     void executeAction();
@@ -45,6 +48,10 @@ private slots:
     void getActionType_data();
     void getActionType();
 
+    void queueActionsPerDevice();
+    void supersedeQueuedActions();
+    void keepActionsWithDifferentTargets();
+
 };
 
 void TestActions::executeAction_data()
@@ -150,5 +157,132 @@ void TestActions::getActionType()
     }
 }
 
+void TestActions::queueActionsPerDevice()
+{
+    qRegisterMetaType<ActionId>();
+    qRegisterMetaType<DeviceManager::DeviceError>();
+    QSignalSpy spy(GuhCore::instance(), SIGNAL(actionExecuted(ActionId,DeviceManager::DeviceError)));
+
+    // the first action keeps the device busy, the others have to wait
+    for (int i = 0; i < 3; i++) {
+        Action action(mockActionIdAsync, m_mockDeviceId);
+        QCOMPARE(GuhCore::instance()->executeAction(action), DeviceManager::DeviceErrorAsync);
+    }
+    QCOMPARE(GuhCore::instance()->actionDispatcher()->queueDepth(m_mockDeviceId), 2);
+
+    while (spy.count() < 3)
+        QVERIFY(spy.wait());
+
+    foreach (const QList<QVariant> &arguments, spy)
+        QCOMPARE(arguments.at(1).value<DeviceManager::DeviceError>(), DeviceManager::DeviceErrorNoError);
+
+    QCOMPARE(GuhCore::instance()->actionDispatcher()->queueDepth(m_mockDeviceId), 0);
+    QVERIFY(GuhCore::instance()->actionDispatcher()->statistics(m_mockDeviceId).maximumQueueDepth >= 2);
+}
+
+void TestActions::supersedeQueuedActions()
+{
+    qRegisterMetaType<ActionId>();
+    qRegisterMetaType<DeviceManager::DeviceError>();
+
+    ActionTypeId timeoutActionTypeId("54646e7c-bc54-4895-81a2-590d72d120f9");
+    StateTypeId percentageStateTypeId("72981c04-267a-4ba0-a59e-9921d2f3af9c");
+
+    DeviceId deviceId = addDisplayPinDevice();
+    QVERIFY(!deviceId.isNull());
+
+    ActionDispatcher *dispatcher = GuhCore::instance()->actionDispatcher();
+    int actionTimeout = dispatcher->actionTimeout();
+    dispatcher->setActionTimeout(500);
+
+    QSignalSpy spy(GuhCore::instance(), SIGNAL(actionExecuted(ActionId,DeviceManager::DeviceError)));
+
+    // the timeout action never finishes and keeps the device busy
+    Action busyAction(timeoutActionTypeId, deviceId);
+    QCOMPARE(GuhCore::instance()->executeAction(busyAction), DeviceManager::DeviceErrorAsync);
+
+    // only the last written value of the writable state has to reach the device
+    for (int i = 1; i <= 3; i++) {
+        Action action(ActionTypeId(percentageStateTypeId.toString()), deviceId);
+        action.setParams(ParamList() << Param(ParamTypeId(percentageStateTypeId.toString()), i * 10));
+        QCOMPARE(GuhCore::instance()->executeAction(action), DeviceManager::DeviceErrorAsync);
+    }
+    QCOMPARE(dispatcher->queueDepth(deviceId), 1);
+    QCOMPARE(dispatcher->statistics(deviceId).superseded, 2);
+
+    // the superseded actions finish together with the last one
+    while (spy.count() < 4)
+        QVERIFY(spy.wait());
+
+    QCOMPARE(dispatcher->queueDepth(deviceId), 0);
+    QCOMPARE(GuhCore::instance()->deviceManager()->findConfiguredDevice(deviceId)->stateValue(percentageStateTypeId).toInt(), 30);
+
+    dispatcher->setActionTimeout(actionTimeout);
+
+    QVariantMap params;
+    params.insert("deviceId", deviceId);
+    verifyDeviceError(injectAndWait("Devices.RemoveConfiguredDevice", params));
+}
+
+void TestActions::keepActionsWithDifferentTargets()
+{
+    qRegisterMetaType<ActionId>();
+    qRegisterMetaType<DeviceManager::DeviceError>();
+    QSignalSpy spy(GuhCore::instance(), SIGNAL(actionExecuted(ActionId,DeviceManager::DeviceError)));
+    ActionDispatcher *dispatcher = GuhCore::instance()->actionDispatcher();
+    int superseded = dispatcher->statistics(m_mockDeviceId).superseded;
+
+    Action busyAction(mockActionIdAsync, m_mockDeviceId);
+    QCOMPARE(GuhCore::instance()->executeAction(busyAction), DeviceManager::DeviceErrorAsync);
+
+    // actions which do not set a state may have an effect of their own, none of them may get dropped
+    QList<ActionId> actionIds;
+    for (int i = 0; i < 2; i++) {
+        Action action(mockActionIdWithParams, m_mockDeviceId);
+        action.setParams(ParamList() << Param(mockActionParam1ParamTypeId, i) << Param(mockActionParam2ParamTypeId, true));
+        actionIds.append(action.id());
+        QCOMPARE(GuhCore::instance()->executeAction(action), DeviceManager::DeviceErrorAsync);
+    }
+    QCOMPARE(dispatcher->queueDepth(m_mockDeviceId), 2);
+    QCOMPARE(dispatcher->statistics(m_mockDeviceId).superseded, superseded);
+
+    while (spy.count() < 3)
+        QVERIFY(spy.wait());
+
+    foreach (const QList<QVariant> &arguments, spy) {
+        actionIds.removeAll(arguments.at(0).value<ActionId>());
+        QCOMPARE(arguments.at(1).value<DeviceManager::DeviceError>(), DeviceManager::DeviceErrorNoError);
+    }
+    QVERIFY(actionIds.isEmpty());
+    QCOMPARE(dispatcher->queueDepth(m_mockDeviceId), 0);
+}
+
+DeviceId TestActions::addDisplayPinDevice()
+{
+    QVariantMap resultCountParam;
+    resultCountParam.insert("paramTypeId", resultCountParamTypeId);
+    resultCountParam.insert("value", 1);
+
+    QVariantMap params;
+    params.insert("deviceClassId", mockDisplayPinDeviceClassId);
+    params.insert("discoveryParams", QVariantList() << resultCountParam);
+    QVariant response = injectAndWait("Devices.GetDiscoveredDevices", params);
+    QVariantList deviceDescriptors = response.toMap().value("params").toMap().value("deviceDescriptors").toList();
+    if (deviceDescriptors.isEmpty())
+        return DeviceId();
+
+    params.clear();
+    params.insert("deviceClassId", mockDisplayPinDeviceClassId);
+    params.insert("name", "Display pin mock device");
+    params.insert("deviceDescriptorId", deviceDescriptors.first().toMap().value("id").toString());
+    response = injectAndWait("Devices.PairDevice", params);
+
+    params.clear();
+    params.insert("pairingTransactionId", response.toMap().value("params").toMap().value("pairingTransactionId").toString());
+    params.insert("secret", "243681");
+    response = injectAndWait("Devices.ConfirmPairing", params);
+    return DeviceId(response.toMap().value("params").toMap().value("deviceId").toString());
+}
+
 #include "testactions.moc"
 QTEST_MAIN(TestActions)
@@ -18,5 +18,19 @@ SUBDIRS = versioning \
         logging \
         restlogging \
         #coap \ # temporary removed until fixed
+        coapobserve \
         configurations \
+        radio433 \
+        gpio \
+        upnp \
+        networkdetector \
+        philipshue \
+        maxcube \
+        jsonstreamframer \
+        networkaccessmanager \
+        startup \
+        metrics \
+        pluginthread \
+        threadedplugins \
+        lazyloading \
         #timemanager \
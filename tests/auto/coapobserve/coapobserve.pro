@@ -0,0 +1,6 @@
+TARGET = testcoapobserve
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += testcoapobserve.cpp
@@ -0,0 +1,267 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "coap/coap.h"
+#include "coap/coappdu.h"
+#include "coap/coapoption.h"
+#include "coap/coapreply.h"
+#include "coap/coaprequest.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QUdpSocket>
+
+Q_DECLARE_METATYPE(CoapObserveResource)
+
+// A CoAP server on the loopback interface which answers with hand made PDUs
+class FakeCoapPeer : public QObject
+{
+    Q_OBJECT
+public:
+    FakeCoapPeer()
+    {
+        m_socket.bind(QHostAddress::LocalHost, 0);
+        connect(&m_socket, &QUdpSocket::readyRead, this, &FakeCoapPeer::onReadyRead);
+    }
+
+    quint16 port() const { return m_socket.localPort(); }
+    QUrl url(const QString &path) const { return QUrl(QString("coap://127.0.0.1:%1%2").arg(port()).arg(path)); }
+
+    QList<QByteArray> datagrams() const { return m_datagrams; }
+    void clear() { m_datagrams.clear(); }
+
+    // waits for the next datagram of the client, the already received ones are skipped
+    QByteArray waitForDatagram(int timeout = 5000)
+    {
+        int count = m_datagrams.count();
+        QSignalSpy spy(this, SIGNAL(datagramReceived()));
+        if (m_datagrams.count() == count && !spy.wait(timeout))
+            return QByteArray();
+
+        return m_datagrams.at(count);
+    }
+
+    void send(const CoapPdu &pdu)
+    {
+        m_socket.writeDatagram(pdu.pack(), m_clientAddress, m_clientPort);
+    }
+
+    void sendNotification(const QByteArray &token, CoapPdu::MessageType type, quint16 messageId, int notificationNumber, const QByteArray &payload)
+    {
+        CoapPdu pdu;
+        pdu.setMessageType(type);
+        pdu.setStatusCode(CoapPdu::Content);
+        pdu.setMessageId(messageId);
+        pdu.setToken(token);
+        pdu.addOption(CoapOption::Observe, QByteArray(1, (char)notificationNumber));
+        pdu.setPayload(payload);
+        send(pdu);
+    }
+
+    void answer(const QByteArray &requestData, CoapPdu::StatusCode statusCode, int notificationNumber, int maxAge, const QByteArray &payload)
+    {
+        CoapPdu request(requestData);
+
+        CoapPdu pdu;
+        pdu.setMessageType(CoapPdu::Acknowledgement);
+        pdu.setStatusCode(statusCode);
+        pdu.setMessageId(request.messageId());
+        pdu.setToken(request.token());
+        if (notificationNumber >= 0)
+            pdu.addOption(CoapOption::Observe, QByteArray(1, (char)notificationNumber));
+
+        pdu.addOption(CoapOption::MaxAge, QByteArray(1, (char)maxAge));
+        pdu.setPayload(payload);
+        send(pdu);
+    }
+
+signals:
+    void datagramReceived();
+
+private slots:
+    void onReadyRead()
+    {
+        while (m_socket.hasPendingDatagrams()) {
+            QByteArray data;
+            data.resize(m_socket.pendingDatagramSize());
+            m_socket.readDatagram(data.data(), data.size(), &m_clientAddress, &m_clientPort);
+            m_datagrams.append(data);
+        }
+        emit datagramReceived();
+    }
+
+private:
+    QUdpSocket m_socket;
+    QHostAddress m_clientAddress;
+    quint16 m_clientPort;
+    QList<QByteArray> m_datagrams;
+};
+
+class TestCoapObserve: public QObject
+{
+    Q_OBJECT
+
+private:
+    QByteArray registerObservation(Coap *coap, FakeCoapPeer *peer, int maxAge);
+
+private slots:
+    void initTestCase();
+
+    void dropOutdatedNotifications();
+    void acknowledgeConfirmableNotifications();
+    void reuseTokenOnRegistration();
+    void reRegisterExpiredObservation();
+};
+
+QByteArray TestCoapObserve::registerObservation(Coap *coap, FakeCoapPeer *peer, int maxAge)
+{
+    QSignalSpy spy(coap, SIGNAL(replyFinished(CoapReply*)));
+    CoapReply *reply = coap->enableResourceNotifications(CoapRequest(peer->url("/sensor")));
+
+    QByteArray request = peer->waitForDatagram();
+    if (request.isEmpty())
+        return QByteArray();
+
+    peer->answer(request, CoapPdu::Content, 1, maxAge, "1");
+    if (!spy.wait() || reply->error() != CoapReply::NoError)
+        return QByteArray();
+
+    reply->deleteLater();
+    return CoapPdu(request).token();
+}
+
+void TestCoapObserve::initTestCase()
+{
+    qRegisterMetaType<CoapObserveResource>();
+}
+
+void TestCoapObserve::dropOutdatedNotifications()
+{
+    FakeCoapPeer peer;
+    Coap coap(this, 0);
+
+    QByteArray token = registerObservation(&coap, &peer, 60);
+    QVERIFY(!token.isEmpty());
+
+    QSignalSpy spy(&coap, SIGNAL(notificationReceived(CoapObserveResource,int,QByteArray)));
+
+    peer.sendNotification(token, CoapPdu::NonConfirmable, 100, 5, "5");
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(1).toInt(), 5);
+    QCOMPARE(spy.at(0).at(2).toByteArray(), QByteArray("5"));
+
+    // an older notification overtaken by a newer one must be dropped
+    peer.sendNotification(token, CoapPdu::NonConfirmable, 101, 3, "3");
+    QTest::qWait(300);
+    QCOMPARE(spy.count(), 1);
+
+    peer.sendNotification(token, CoapPdu::NonConfirmable, 102, 6, "6");
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(1).toInt(), 6);
+    QCOMPARE(spy.at(1).at(2).toByteArray(), QByteArray("6"));
+}
+
+void TestCoapObserve::acknowledgeConfirmableNotifications()
+{
+    FakeCoapPeer peer;
+    Coap coap(this, 0);
+
+    QByteArray token = registerObservation(&coap, &peer, 60);
+    QVERIFY(!token.isEmpty());
+
+    QSignalSpy spy(&coap, SIGNAL(notificationReceived(CoapObserveResource,int,QByteArray)));
+
+    // non confirmable notifications don't get an answer
+    peer.clear();
+    peer.sendNotification(token, CoapPdu::NonConfirmable, 200, 2, "2");
+    QVERIFY(spy.wait());
+    QTest::qWait(300);
+    QVERIFY(peer.datagrams().isEmpty());
+
+    // confirmable ones get an empty ACK with their message id
+    peer.sendNotification(token, CoapPdu::Confirmable, 201, 3, "3");
+    QByteArray data = peer.waitForDatagram();
+    QVERIFY(!data.isEmpty());
+    CoapPdu ack(data);
+    QCOMPARE(ack.messageType(), CoapPdu::Acknowledgement);
+    QCOMPARE(ack.statusCode(), CoapPdu::Empty);
+    QCOMPARE((int)ack.messageId(), 201);
+    QTRY_COMPARE(spy.count(), 2);
+
+    // even if they are outdated
+    peer.clear();
+    peer.sendNotification(token, CoapPdu::Confirmable, 202, 1, "1");
+    data = peer.waitForDatagram();
+    QVERIFY(!data.isEmpty());
+    QCOMPARE((int)CoapPdu(data).messageId(), 202);
+    QTest::qWait(300);
+    QCOMPARE(spy.count(), 2);
+}
+
+void TestCoapObserve::reuseTokenOnRegistration()
+{
+    FakeCoapPeer peer;
+    Coap coap(this, 0);
+
+    QByteArray token = registerObservation(&coap, &peer, 60);
+    QVERIFY(!token.isEmpty());
+
+    // registering the same resource again has to keep the token of the notifications
+    QByteArray secondToken = registerObservation(&coap, &peer, 60);
+    QCOMPARE(secondToken, token);
+
+    QSignalSpy spy(&coap, SIGNAL(notificationReceived(CoapObserveResource,int,QByteArray)));
+    peer.sendNotification(token, CoapPdu::NonConfirmable, 300, 2, "2");
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestCoapObserve::reRegisterExpiredObservation()
+{
+    FakeCoapPeer peer;
+    Coap coap(this, 0);
+
+    // a max age of 0 lets the observation expire with the next check
+    QByteArray token = registerObservation(&coap, &peer, 0);
+    QVERIFY(!token.isEmpty());
+
+    QSignalSpy lostSpy(&coap, SIGNAL(observationLost(CoapObserveResource)));
+
+    // the observation gets registered again with the same token
+    peer.clear();
+    QByteArray request = peer.waitForDatagram(10000);
+    QVERIFY2(!request.isEmpty(), "Observation has not been registered again");
+    CoapPdu registration(request);
+    QCOMPARE(registration.token(), token);
+    QVERIFY(registration.hasOption(CoapOption::Observe));
+
+    // the server does not know the resource any more
+    peer.answer(request, CoapPdu::NotFound, -1, 60, QByteArray());
+    QVERIFY(lostSpy.wait());
+    QCOMPARE(lostSpy.count(), 1);
+    CoapObserveResource resource = lostSpy.first().first().value<CoapObserveResource>();
+    QCOMPARE(resource.url(), peer.url("/sensor"));
+    QCOMPARE(resource.token(), token);
+}
+
+#include "testcoapobserve.moc"
+QTEST_MAIN(TestCoapObserve)
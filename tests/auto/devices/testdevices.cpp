@@ -47,6 +47,7 @@ private slots:
     void setPluginConfig();
 
     void getSupportedVendors();
+    void getSupportedVendorsEtag();
 
     void getSupportedDevices_data();
     void getSupportedDevices();
@@ -56,6 +57,8 @@ private slots:
 
     void getConfiguredDevices();
 
+    void getChangesSince();
+
     void storedDevices();
 
     void discoverDevices_data();
@@ -197,6 +200,26 @@ void TestDevices::getSupportedVendors()
     QCOMPARE(found, true);
 }
 
+void TestDevices::getSupportedVendorsEtag()
+{
+    QVariantMap response = injectAndWait("Devices.GetSupportedVendors").toMap().value("params").toMap();
+    QString etag = response.value("etag").toString();
+    QVERIFY2(!etag.isEmpty(), "Missing etag in response");
+    QVERIFY(response.contains("vendors"));
+
+    // a known catalog only returns the tag
+    QVariantMap params;
+    params.insert("etag", etag);
+    response = injectAndWait("Devices.GetSupportedVendors", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("etag").toString(), etag);
+    QVERIFY2(!response.contains("vendors"), "Unchanged catalog should not be sent again");
+
+    params.insert("etag", "outdated");
+    response = injectAndWait("Devices.GetSupportedVendors", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("etag").toString(), etag);
+    QVERIFY(response.contains("vendors"));
+}
+
 void TestDevices::getSupportedDevices_data()
 {
     QTest::addColumn<VendorId>("vendorId");
@@ -298,6 +321,41 @@ void TestDevices::getConfiguredDevices()
     QCOMPARE(devices.count(), 2); // There should be one auto created mock device and one created in initTestcase()
 }
 
+void TestDevices::getChangesSince()
+{
+    // an unknown sequence requires a complete synchronisation
+    QVariantMap params;
+    params.insert("sequence", 0);
+    QVariantMap response = injectAndWait("Devices.GetChangesSince", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("resyncRequired").toBool(), true);
+    QCOMPARE(response.value("devices").toList().count(), 2);
+    qint64 sequence = response.value("sequence").toLongLong();
+
+    // change a state of the mock device
+    QNetworkAccessManager nam;
+    QSignalSpy spy(&nam, SIGNAL(finished(QNetworkReply*)));
+    QNetworkRequest request(QUrl(QString("http://localhost:%1/setstate?%2=%3").arg(m_mockDevice1Port).arg(mockIntStateId.toString()).arg(4321)));
+    QNetworkReply *reply = nam.get(request);
+    spy.wait();
+    QCOMPARE(spy.count(), 1);
+    reply->deleteLater();
+
+    params.insert("sequence", sequence);
+    response = injectAndWait("Devices.GetChangesSince", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("resyncRequired").toBool(), false);
+    QVERIFY(response.value("sequence").toLongLong() > sequence);
+    QVariantList devices = response.value("devices").toList();
+    QCOMPARE(devices.count(), 1);
+    QCOMPARE(devices.first().toMap().value("id").toUuid(), QUuid(m_mockDeviceId));
+    QVERIFY(response.value("removedDeviceIds").toList().isEmpty());
+
+    // nothing changed since the last call
+    params.insert("sequence", response.value("sequence"));
+    response = injectAndWait("Devices.GetChangesSince", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("resyncRequired").toBool(), false);
+    QVERIFY(response.value("devices").toList().isEmpty());
+}
+
 void TestDevices::storedDevices()
 {
     QVariantMap params;
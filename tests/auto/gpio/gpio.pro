@@ -0,0 +1,6 @@
+TARGET = testgpio
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += testgpio.cpp
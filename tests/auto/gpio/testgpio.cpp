@@ -0,0 +1,244 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "hardware/gpio.h"
+#include "hardware/gpiogroup.h"
+#include "hardware/pwm.h"
+#include "hardware/sysfsattributes.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+class TestGpio: public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_sysfsDirectory;
+
+    bool createAttribute(const QString &fileName, const QByteArray &value);
+    bool createGpio(int gpioNumber);
+
+private slots:
+    void initTestCase();
+
+    void sysfsAttributes();
+
+    void gpioValue_data();
+    void gpioValue();
+
+    void gpioDirection();
+
+    void gpioGroupFallback();
+
+    void pwmAttributes();
+
+    void gpioSetValueBenchmark();
+};
+
+bool TestGpio::createAttribute(const QString &fileName, const QByteArray &value)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    return file.write(value + '\n') == value.length() + 1;
+}
+
+bool TestGpio::createGpio(int gpioNumber)
+{
+    QString gpioDirectory = QString("%1/gpio/gpio%2").arg(m_sysfsDirectory.path()).arg(gpioNumber);
+    if (!QDir().mkpath(gpioDirectory))
+        return false;
+
+    return createAttribute(gpioDirectory + "/value", "0") &&
+            createAttribute(gpioDirectory + "/direction", "in") &&
+            createAttribute(gpioDirectory + "/active_low", "0") &&
+            createAttribute(gpioDirectory + "/edge", "none");
+}
+
+void TestGpio::initTestCase()
+{
+    QVERIFY(m_sysfsDirectory.isValid());
+
+    // Fake sysfs tree with the same layout as /sys/class/gpio and /sys/class/pwm
+    QString gpioDirectory = m_sysfsDirectory.path() + "/gpio";
+    QVERIFY(QDir().mkpath(gpioDirectory));
+    QVERIFY(createAttribute(gpioDirectory + "/export", ""));
+    QVERIFY(createAttribute(gpioDirectory + "/unexport", ""));
+    foreach (int gpioNumber, QList<int>() << 17 << 18 << 22 << 27)
+        QVERIFY(createGpio(gpioNumber));
+
+    QString pwmDirectory = m_sysfsDirectory.path() + "/pwm/pwmchip0";
+    QVERIFY(QDir().mkpath(pwmDirectory + "/pwm0"));
+    QVERIFY(createAttribute(pwmDirectory + "/export", ""));
+    QVERIFY(createAttribute(pwmDirectory + "/unexport", ""));
+    QVERIFY(createAttribute(pwmDirectory + "/pwm0/enable", "0"));
+    QVERIFY(createAttribute(pwmDirectory + "/pwm0/period", "0"));
+    QVERIFY(createAttribute(pwmDirectory + "/pwm0/duty_cycle", "0"));
+    QVERIFY(createAttribute(pwmDirectory + "/pwm0/polarity", "normal"));
+
+    Gpio::setSysfsDirectory(gpioDirectory);
+    Pwm::setSysfsDirectory(m_sysfsDirectory.path() + "/pwm");
+}
+
+void TestGpio::sysfsAttributes()
+{
+    SysfsAttributes attributes(m_sysfsDirectory.path() + "/gpio/gpio27");
+    QCOMPARE(attributes.read("edge"), QByteArray("none"));
+
+    // The file descriptor has to stay open between the accesses
+    int fd = attributes.fileDescriptor("edge");
+    QVERIFY(fd >= 0);
+    QVERIFY(attributes.write("edge", "both"));
+    QCOMPARE(attributes.fileDescriptor("edge"), fd);
+    QCOMPARE(attributes.read("edge"), QByteArray("both"));
+    QCOMPARE(SysfsAttributes::readFile(m_sysfsDirectory.path() + "/gpio/gpio27/edge"), QByteArray("both"));
+
+    // Writing a shorter value must not return the rest of the previous one
+    QVERIFY(attributes.write("edge", "none"));
+    QCOMPARE(attributes.read("edge"), QByteArray("none"));
+
+    QVERIFY(attributes.fileDescriptor("missing") < 0);
+    QVERIFY(!attributes.write("missing", "1"));
+    QVERIFY(attributes.read("missing").isEmpty());
+
+    attributes.close();
+    QCOMPARE(attributes.read("edge"), QByteArray("none"));
+}
+
+void TestGpio::gpioValue_data()
+{
+    QTest::addColumn<int>("value");
+    QTest::addColumn<QByteArray>("fileContent");
+
+    QTest::newRow("high") << (int)Gpio::ValueHigh << QByteArray("1");
+    QTest::newRow("low") << (int)Gpio::ValueLow << QByteArray("0");
+}
+
+void TestGpio::gpioValue()
+{
+    QFETCH(int, value);
+    QFETCH(QByteArray, fileContent);
+
+    QVERIFY(Gpio::isAvailable());
+
+    Gpio gpio(17);
+    QVERIFY(gpio.exportGpio());
+    QVERIFY(gpio.setDirection(Gpio::DirectionOutput));
+    QVERIFY(gpio.setValue((Gpio::Value)value));
+    QCOMPARE((int)gpio.value(), value);
+    QCOMPARE(SysfsAttributes::readFile(gpio.gpioDirectory() + "/value"), fileContent);
+    QVERIFY(!gpio.setValue(Gpio::ValueInvalid));
+}
+
+void TestGpio::gpioDirection()
+{
+    Gpio gpio(27);
+    QVERIFY(gpio.setDirection(Gpio::DirectionInput));
+    QCOMPARE(gpio.direction(), Gpio::DirectionInput);
+    QVERIFY(!gpio.setValue(Gpio::ValueHigh));
+
+    QVERIFY(gpio.setEdgeInterrupt(Gpio::EdgeRising));
+    QCOMPARE(gpio.edgeInterrupt(), Gpio::EdgeRising);
+    QVERIFY(gpio.valueFileDescriptor() >= 0);
+
+    QVERIFY(gpio.setDirection(Gpio::DirectionOutput));
+    QCOMPARE(gpio.direction(), Gpio::DirectionOutput);
+    QVERIFY(!gpio.setEdgeInterrupt(Gpio::EdgeBoth));
+
+    // The direction of an exported GPIO has to be restored by a new instance
+    Gpio otherGpio(27);
+    QCOMPARE(otherGpio.direction(), Gpio::DirectionOutput);
+}
+
+void TestGpio::gpioGroupFallback()
+{
+    GpioGroup group(QList<int>() << 17 << 18 << 22);
+    QVERIFY(!group.isEnabled());
+    QVERIFY(!group.setValues(QList<Gpio::Value>() << Gpio::ValueHigh << Gpio::ValueHigh << Gpio::ValueHigh));
+
+    // There is no GPIO character device in the fake tree
+    QVERIFY(group.enable(Gpio::DirectionOutput));
+    QVERIFY(group.isEnabled());
+    QVERIFY(!group.usesCharacterDevice());
+
+    QList<Gpio::Value> values;
+    values << Gpio::ValueHigh << Gpio::ValueLow << Gpio::ValueHigh;
+    QVERIFY(group.setValues(values));
+    QCOMPARE(group.values(), values);
+    QCOMPARE(SysfsAttributes::readFile(Gpio::sysfsDirectory() + "/gpio18/value"), QByteArray("0"));
+    QCOMPARE(SysfsAttributes::readFile(Gpio::sysfsDirectory() + "/gpio22/value"), QByteArray("1"));
+
+    QVERIFY(!group.setValues(QList<Gpio::Value>() << Gpio::ValueHigh));
+    QVERIFY(!group.setValues(QList<Gpio::Value>() << Gpio::ValueHigh << Gpio::ValueInvalid << Gpio::ValueLow));
+
+    group.disable();
+    QVERIFY(!group.isEnabled());
+
+    // Lines which are not exported can not be grouped
+    GpioGroup invalidGroup(QList<int>() << 17 << 99);
+    QVERIFY(!invalidGroup.enable(Gpio::DirectionOutput));
+    QVERIFY(!invalidGroup.isEnabled());
+}
+
+void TestGpio::pwmAttributes()
+{
+    QVERIFY(Pwm::isAvailable());
+
+    Pwm pwm(0);
+    QVERIFY(pwm.exportPwm());
+    QVERIFY(pwm.setPeriod(1000000));
+    QCOMPARE(pwm.period(), (long)1000000);
+
+    QVERIFY(pwm.setPercentage(25));
+    QCOMPARE(pwm.dutyCycle(), (long)250000);
+    QCOMPARE(pwm.percentage(), 25);
+    QVERIFY(!pwm.setDutyCycle(2000000));
+
+    // A shorter period has to limit the duty cycle
+    QVERIFY(pwm.setPeriod(100000));
+    QCOMPARE(pwm.dutyCycle(), (long)100000);
+
+    QVERIFY(pwm.enable());
+    QVERIFY(pwm.isEnabled());
+    QVERIFY(pwm.setPolarity(Pwm::PolarityInversed));
+    QCOMPARE(pwm.polarity(), Pwm::PolarityInversed);
+    QVERIFY(pwm.isEnabled());
+
+    QVERIFY(pwm.disable());
+    QVERIFY(!pwm.isEnabled());
+}
+
+void TestGpio::gpioSetValueBenchmark()
+{
+    Gpio gpio(22);
+    QVERIFY(gpio.setDirection(Gpio::DirectionOutput));
+
+    bool high = false;
+    QBENCHMARK {
+        high = !high;
+        gpio.setValue(high ? Gpio::ValueHigh : Gpio::ValueLow);
+    }
+}
+
+#include "testgpio.moc"
+QTEST_MAIN(TestGpio)
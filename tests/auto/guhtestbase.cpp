@@ -214,27 +214,27 @@ QVariant GuhTestBase::injectAndWait(const QString &method, const QVariantMap &pa
 
     m_mockTcpServer->injectData(m_clientId, jsonDoc.toJson());
 
-    if (spy.count() == 0) {
-        spy.wait();
-    }
-
-    for (int i = 0; i < spy.count(); i++) {
-        // Make sure the response it a valid JSON string
-        QJsonParseError error;
-        jsonDoc = QJsonDocument::fromJson(spy.at(i).last().toByteArray(), &error);
-        if (error.error != QJsonParseError::NoError) {
-            qWarning() << "JSON parser error" << error.errorString();
-            return QVariant();
-        }
-        QVariantMap response = jsonDoc.toVariant().toMap();
-
-        // skip notifications
-        if (response.contains("notification"))
-            continue;
-
-        if (response.value("id").toInt() == m_commandId) {
-            m_commandId++;
-            return jsonDoc.toVariant();
+    // The request gets processed on a worker thread, notifications may arrive before the response
+    int i = 0;
+    while (i < spy.count() || spy.wait()) {
+        for (; i < spy.count(); i++) {
+            // Make sure the response it a valid JSON string
+            QJsonParseError error;
+            jsonDoc = QJsonDocument::fromJson(spy.at(i).last().toByteArray(), &error);
+            if (error.error != QJsonParseError::NoError) {
+                qWarning() << "JSON parser error" << error.errorString();
+                return QVariant();
+            }
+            QVariantMap response = jsonDoc.toVariant().toMap();
+
+            // skip notifications
+            if (response.contains("notification"))
+                continue;
+
+            if (response.value("id").toInt() == m_commandId) {
+                m_commandId++;
+                return jsonDoc.toVariant();
+            }
         }
     }
     m_commandId++;
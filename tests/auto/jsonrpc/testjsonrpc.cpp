@@ -21,6 +21,7 @@
 
 #include "guhtestbase.h"
 #include "guhcore.h"
+#include "jsonrpcserver.h"
 #include "devicemanager.h"
 #include "mocktcpserver.h"
 
@@ -59,6 +60,8 @@ private slots:
 
     void stateChangeEmitsNotifications();
 
+    void pipelinedReadAfterWrite();
+
 private:
     QStringList extractRefs(const QVariant &variant);
 
@@ -585,6 +588,64 @@ void TestJSONRPC::stateChangeEmitsNotifications()
     QCOMPARE(response.toMap().value("params").toMap().value("value").toInt(), newVal);
 }
 
+void TestJSONRPC::pipelinedReadAfterWrite()
+{
+    QVERIFY(GuhCore::instance()->jsonRPCServer()->workerCount() > 0);
+
+    QSignalSpy spy(m_mockTcpServer, SIGNAL(outgoingData(QUuid,QByteArray)));
+    QVERIFY(spy.isValid());
+
+    // Send a write and a read without waiting for the first response
+    QList<int> commandIds;
+    QStringList names;
+    names << "Pipelined device 1" << "Pipelined device 2";
+    foreach (const QString &name, names) {
+        QVariantMap params;
+        params.insert("deviceId", m_mockDeviceId);
+        params.insert("name", name);
+
+        QVariantMap editCall;
+        editCall.insert("id", m_commandId);
+        editCall.insert("method", "Devices.EditDevice");
+        editCall.insert("params", params);
+        commandIds.append(m_commandId++);
+        m_mockTcpServer->injectData(m_clientId, QJsonDocument::fromVariant(editCall).toJson());
+
+        params.remove("name");
+        QVariantMap getCall;
+        getCall.insert("id", m_commandId);
+        getCall.insert("method", "Devices.GetConfiguredDevices");
+        getCall.insert("params", params);
+        commandIds.append(m_commandId++);
+        m_mockTcpServer->injectData(m_clientId, QJsonDocument::fromVariant(getCall).toJson());
+    }
+
+    // The responses have to arrive in the order of the requests and each read has to see the write before
+    QList<QVariantMap> responses;
+    while (responses.count() < commandIds.count()) {
+        for (int i = 0; i < spy.count(); i++) {
+            QVariantMap response = QJsonDocument::fromJson(spy.at(i).last().toByteArray()).toVariant().toMap();
+            if (!response.contains("notification"))
+                responses.append(response);
+        }
+        spy.clear();
+
+        if (responses.count() < commandIds.count())
+            QVERIFY(spy.wait());
+    }
+
+    for (int i = 0; i < commandIds.count(); i++)
+        QCOMPARE(responses.at(i).value("id").toInt(), commandIds.at(i));
+
+    QVariantList devices = responses.at(1).value("params").toMap().value("devices").toList();
+    QCOMPARE(devices.count(), 1);
+    QCOMPARE(devices.first().toMap().value("name").toString(), names.at(0));
+
+    devices = responses.at(3).value("params").toMap().value("devices").toList();
+    QCOMPARE(devices.count(), 1);
+    QCOMPARE(devices.first().toMap().value("name").toString(), names.at(1));
+}
+
 #include "testjsonrpc.moc"
 
 QTEST_MAIN(TestJSONRPC)
@@ -0,0 +1,6 @@
+TARGET = testjsonstreamframer
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += testjsonstreamframer.cpp
@@ -0,0 +1,113 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "network/jsonstreamframer.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QJsonDocument>
+
+class TestJsonStreamFramer: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void frameMessages_data();
+    void frameMessages();
+
+    void partialReads();
+    void maximumMessageSize();
+};
+
+void TestJsonStreamFramer::frameMessages_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QList<QByteArray> >("messages");
+
+    QTest::newRow("single") << QByteArray("{\"id\":1}\n") << (QList<QByteArray>() << "{\"id\":1}");
+    QTest::newRow("pipelined") << QByteArray("{\"id\":1}{\"id\":2}\n{\"id\":3}") << (QList<QByteArray>() << "{\"id\":1}" << "{\"id\":2}" << "{\"id\":3}");
+    QTest::newRow("nested") << QByteArray("{\"a\":{\"b\":[{},{}]}}") << (QList<QByteArray>() << "{\"a\":{\"b\":[{},{}]}}");
+    QTest::newRow("braces in string") << QByteArray("{\"a\":\"}{\"}{\"b\":\"{\"}") << (QList<QByteArray>() << "{\"a\":\"}{\"}" << "{\"b\":\"{\"}");
+    QTest::newRow("escaped quote") << QByteArray("{\"a\":\"\\\"}\\\\\"}") << (QList<QByteArray>() << "{\"a\":\"\\\"}\\\\\"}");
+    QTest::newRow("invalid line") << QByteArray("  foo bar\n{}") << (QList<QByteArray>() << "foo bar\n" << "{}");
+    QTest::newRow("incomplete") << QByteArray("{\"id\":1}{\"id\"") << (QList<QByteArray>() << "{\"id\":1}");
+}
+
+void TestJsonStreamFramer::frameMessages()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QList<QByteArray>, messages);
+
+    JsonStreamFramer framer;
+    QVERIFY(framer.append(data));
+
+    QList<QByteArray> framedMessages;
+    while (framer.hasMessage())
+        framedMessages.append(framer.takeMessage());
+
+    QCOMPARE(framedMessages, messages);
+}
+
+void TestJsonStreamFramer::partialReads()
+{
+    QVariantMap params;
+    params.insert("label", QString("}{ \"quoted\" \\ }"));
+    params.insert("items", QVariantList() << 1 << QVariantMap() << QVariantList());
+
+    QVariantMap notification;
+    notification.insert("method", "VideoLibrary.OnUpdate");
+    notification.insert("params", params);
+
+    QByteArray document = QJsonDocument::fromVariant(notification).toJson(QJsonDocument::Compact);
+    QByteArray stream = document + document + "\n" + document;
+
+    // feed the stream byte by byte
+    JsonStreamFramer framer;
+    QList<QByteArray> messages;
+    for (int i = 0; i < stream.length(); i++) {
+        QVERIFY(framer.append(stream.mid(i, 1)));
+        while (framer.hasMessage())
+            messages.append(framer.takeMessage());
+    }
+
+    QCOMPARE(messages.count(), 3);
+    foreach (const QByteArray &message, messages)
+        QCOMPARE(message, document);
+
+    QCOMPARE(framer.bufferedSize(), 0);
+}
+
+void TestJsonStreamFramer::maximumMessageSize()
+{
+    JsonStreamFramer framer(8);
+
+    // the oversized message gets dropped, the following one has to be framed again
+    QVERIFY(!framer.append("{\"a\":\"0123456789"));
+    QVERIFY(framer.append("0123456789\"}"));
+    QVERIFY(!framer.hasMessage());
+
+    QVERIFY(framer.append("{\"id\":2}"));
+    QVERIFY(framer.hasMessage());
+    QCOMPARE(framer.takeMessage(), QByteArray("{\"id\":2}"));
+    QCOMPARE(framer.bufferedSize(), 0);
+}
+
+#include "testjsonstreamframer.moc"
+QTEST_MAIN(TestJsonStreamFramer)
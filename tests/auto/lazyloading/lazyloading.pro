@@ -0,0 +1,6 @@
+TARGET = testlazyloading
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += testlazyloading.cpp
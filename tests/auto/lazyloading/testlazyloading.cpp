@@ -0,0 +1,174 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "guhtestbase.h"
+#include "guhcore.h"
+#include "devicemanager.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+using namespace guhserver;
+
+// The threaded mock plugin creates no auto devices and gets loaded on first use
+PluginId threadedPluginId = PluginId("4d56bb36-7b6b-4a8e-a5aa-fe363b23f5c3");
+VendorId guhVendorId = VendorId("2062d64d-3232-433c-88bc-0d33c0ba2ba6");
+DeviceClassId threadedDeviceClassId = DeviceClassId("72cb1038-d893-4624-84bc-d915a1f8e5f9");
+ParamTypeId threadedAsyncParamTypeId = ParamTypeId("eea0ef5d-f078-4794-8fa8-b30c9e3f73b3");
+StateTypeId threadedWorkerThreadStateTypeId = StateTypeId("e4e24d95-f4e5-4b53-b2b2-5d69a3855108");
+StateTypeId threadedPostSetupStateTypeId = StateTypeId("f04abcf7-0c82-4f77-854c-90cd30190f0b");
+ActionTypeId threadedAsyncActionTypeId = ActionTypeId("85a82f9e-7ba6-4634-a151-1ccf718bfcd2");
+
+class TestLazyLoading: public GuhTestBase
+{
+    Q_OBJECT
+
+private:
+    bool isActive(const PluginId &pluginId);
+    QVariant stateValue(const DeviceId &deviceId, const StateTypeId &stateTypeId);
+
+private slots:
+    void inactivePlugin();
+
+    void discoveryActivatesPlugin();
+
+    void addDeviceActivatesPlugin();
+};
+
+bool TestLazyLoading::isActive(const PluginId &pluginId)
+{
+    // the placeholder of an inactive plugin has no meta object of its own
+    DevicePlugin *plugin = GuhCore::instance()->deviceManager()->plugin(pluginId);
+    return plugin && QByteArray(plugin->metaObject()->className()) != "DevicePlugin";
+}
+
+QVariant TestLazyLoading::stateValue(const DeviceId &deviceId, const StateTypeId &stateTypeId)
+{
+    QVariantMap params;
+    params.insert("deviceId", deviceId);
+    params.insert("stateTypeId", stateTypeId);
+    QVariant response = injectAndWait("Devices.GetStateValue", params);
+    return response.toMap().value("params").toMap().value("value");
+}
+
+void TestLazyLoading::inactivePlugin()
+{
+    // registered, but not loaded
+    DevicePlugin *plugin = GuhCore::instance()->deviceManager()->plugin(threadedPluginId);
+    QVERIFY2(plugin, "Threaded mock plugin not registered");
+    QVERIFY(!isActive(threadedPluginId));
+    QCOMPARE(plugin->pluginName(), QString("Threaded Mock Devices"));
+
+    // the catalog gets served from the metadata
+    QVariant response = injectAndWait("Devices.GetPlugins");
+    bool pluginFound = false;
+    foreach (const QVariant &pluginVariant, response.toMap().value("params").toMap().value("plugins").toList()) {
+        if (PluginId(pluginVariant.toMap().value("id").toString()) == threadedPluginId)
+            pluginFound = true;
+    }
+    QVERIFY2(pluginFound, "Inactive plugin missing in Devices.GetPlugins");
+
+    response = injectAndWait("Devices.GetSupportedVendors");
+    bool vendorFound = false;
+    foreach (const QVariant &vendor, response.toMap().value("params").toMap().value("vendors").toList()) {
+        if (VendorId(vendor.toMap().value("id").toString()) == guhVendorId)
+            vendorFound = true;
+    }
+    QVERIFY2(vendorFound, "Vendor of the inactive plugin missing in Devices.GetSupportedVendors");
+
+    QVariantMap params;
+    params.insert("vendorId", guhVendorId);
+    response = injectAndWait("Devices.GetSupportedDevices", params);
+    QVariantMap deviceClass;
+    foreach (const QVariant &deviceClassVariant, response.toMap().value("params").toMap().value("deviceClasses").toList()) {
+        if (DeviceClassId(deviceClassVariant.toMap().value("id").toString()) == threadedDeviceClassId)
+            deviceClass = deviceClassVariant.toMap();
+    }
+    QVERIFY2(!deviceClass.isEmpty(), "Device class of the inactive plugin missing in Devices.GetSupportedDevices");
+    QCOMPARE(deviceClass.value("name").toString(), QString("Threaded Mock Device"));
+    QCOMPARE(PluginId(deviceClass.value("pluginId").toString()), threadedPluginId);
+    QCOMPARE(deviceClass.value("stateTypes").toList().count(), 3);
+    QCOMPARE(deviceClass.value("actionTypes").toList().count(), 4);
+
+    // reading the catalog does not load the plugin
+    QVERIFY(!isActive(threadedPluginId));
+}
+
+void TestLazyLoading::discoveryActivatesPlugin()
+{
+    QVERIFY(!isActive(threadedPluginId));
+
+    // the result of the discovery arrives through the signals of the loaded plugin
+    QVariantMap params;
+    params.insert("deviceClassId", threadedDeviceClassId);
+    params.insert("discoveryParams", QVariantList());
+    QVariant response = injectAndWait("Devices.GetDiscoveredDevices", params);
+    verifyDeviceError(response);
+    QVERIFY(isActive(threadedPluginId));
+
+    QVariantList deviceDescriptors = response.toMap().value("params").toMap().value("deviceDescriptors").toList();
+    QCOMPARE(deviceDescriptors.count(), 1);
+    QCOMPARE(deviceDescriptors.first().toMap().value("title").toString(), QString("Threaded mock device (discovered)"));
+}
+
+void TestLazyLoading::addDeviceActivatesPlugin()
+{
+    // without configured devices the plugin is inactive again after a restart
+    restartServer();
+    QVERIFY(!isActive(threadedPluginId));
+
+    // the asynchronous setup only finishes if the signals of the loaded plugin are connected
+    QVariantMap asyncParam;
+    asyncParam.insert("paramTypeId", threadedAsyncParamTypeId);
+    asyncParam.insert("value", true);
+
+    QVariantMap params;
+    params.insert("deviceClassId", threadedDeviceClassId);
+    params.insert("name", "Threaded mock device");
+    params.insert("deviceParams", QVariantList() << asyncParam);
+    QVariant response = injectAndWait("Devices.AddConfiguredDevice", params);
+    verifyDeviceError(response);
+    QVERIFY(isActive(threadedPluginId));
+
+    DeviceId deviceId(response.toMap().value("params").toMap().value("deviceId").toString());
+    QVERIFY(!deviceId.isNull());
+
+    // the activated plugin runs on its worker thread
+    QCOMPARE(stateValue(deviceId, threadedWorkerThreadStateTypeId).toBool(), true);
+    QTRY_COMPARE(stateValue(deviceId, threadedPostSetupStateTypeId).toBool(), true);
+
+    params.clear();
+    params.insert("deviceId", deviceId);
+    params.insert("actionTypeId", threadedAsyncActionTypeId);
+    response = injectAndWait("Actions.ExecuteAction", params);
+    verifyDeviceError(response);
+
+    // a configured device loads the plugin right away
+    restartServer();
+    QVERIFY(isActive(threadedPluginId));
+
+    params.clear();
+    params.insert("deviceId", deviceId);
+    response = injectAndWait("Devices.RemoveConfiguredDevice", params);
+    verifyDeviceError(response);
+}
+
+#include "testlazyloading.moc"
+QTEST_MAIN(TestLazyLoading)
@@ -0,0 +1,20 @@
+TARGET = testmaxcube
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+INCLUDEPATH += $$top_srcdir/plugins/deviceplugins/eq-3 \
+    $$top_builddir/plugins/deviceplugins/eq-3
+
+SOURCES += testmaxcube.cpp \
+    $$top_srcdir/plugins/deviceplugins/eq-3/maxcubedecoder.cpp \
+    $$top_srcdir/plugins/deviceplugins/eq-3/maxdevice.cpp \
+    $$top_srcdir/plugins/deviceplugins/eq-3/room.cpp \
+    $$top_srcdir/plugins/deviceplugins/eq-3/wallthermostat.cpp \
+    $$top_srcdir/plugins/deviceplugins/eq-3/radiatorthermostat.cpp
+
+HEADERS += $$top_srcdir/plugins/deviceplugins/eq-3/maxcubedecoder.h \
+    $$top_srcdir/plugins/deviceplugins/eq-3/maxdevice.h \
+    $$top_srcdir/plugins/deviceplugins/eq-3/room.h \
+    $$top_srcdir/plugins/deviceplugins/eq-3/wallthermostat.h \
+    $$top_srcdir/plugins/deviceplugins/eq-3/radiatorthermostat.h
@@ -0,0 +1,355 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "maxcubedecoder.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QSignalSpy>
+
+// the plugin sources log to the category of the plugin library
+Q_LOGGING_CATEGORY(dcEQ3, "EQ3")
+
+class TestMaxCube: public QObject
+{
+    Q_OBJECT
+
+private:
+    QByteArray metadata();
+    QByteArray radiatorConfig();
+    QByteArray liveData(char valvePosition);
+    QByteArray cubeSession();
+
+private slots:
+    void decodeBase64_data();
+    void decodeBase64();
+
+    void chunkedSession_data();
+    void chunkedSession();
+
+    void metadataParts();
+    void metadataPartOutOfOrder();
+
+    void shortLiveRecords();
+    void unchangedLiveData();
+};
+
+// One room with a radiator thermostat, a window contact and a wall thermostat
+QByteArray TestMaxCube::metadata()
+{
+    QByteArray data = QByteArray::fromHex("5602");
+
+    // room count, room id, name, group RF address
+    data.append(char(1));
+    data.append(char(1));
+    data.append(char(6));
+    data.append("Living");
+    data.append(QByteArray::fromHex("001122"));
+
+    // device count, then type, RF address, serial number, name and room id of each device
+    data.append(char(3));
+
+    data.append(char(MaxDevice::DeviceRadiatorThermostat));
+    data.append(QByteArray::fromHex("0a0b0c"));
+    data.append("KEQ0000001");
+    data.append(char(6));
+    data.append("Heater");
+    data.append(char(1));
+
+    data.append(char(MaxDevice::DeviceWindowContact));
+    data.append(QByteArray::fromHex("0d0e0f"));
+    data.append("KEQ0000002");
+    data.append(char(6));
+    data.append("Window");
+    data.append(char(1));
+
+    data.append(char(MaxDevice::DeviceWallThermostat));
+    data.append(QByteArray::fromHex("101112"));
+    data.append("KEQ0000003");
+    data.append(char(4));
+    data.append("Wall");
+    data.append(char(1));
+
+    return data;
+}
+
+QByteArray TestMaxCube::radiatorConfig()
+{
+    QByteArray data;
+    data.append(QByteArray::fromHex("0a0b0c"));
+    // type, room id, firmware, unknown
+    data.append(char(MaxDevice::DeviceRadiatorThermostat));
+    data.append(char(1));
+    data.append(char(0x19));
+    data.append(char(0));
+    data.append("KEQ0000001");
+    // comfort 21.5, eco 17, max 30.5, min 4.5, offset +1.0, window open 12
+    data.append(QByteArray::fromHex("2b223d09091803"));
+    // boost, decalcification, valve maximum, valve offset
+    data.append(QByteArray::fromHex("3b0cff00"));
+    // weekly program
+    data.append(QByteArray(7 * 26, 0));
+
+    data.prepend(char(data.length()));
+    return data;
+}
+
+QByteArray TestMaxCube::liveData(char valvePosition)
+{
+    QByteArray data;
+
+    // window contact: only RF address, unknown, init flags and status flags
+    data.append(char(6));
+    data.append(QByteArray::fromHex("0d0e0f"));
+    data.append(QByteArray::fromHex("091210"));
+
+    // radiator thermostat in auto mode, setpoint 21.5
+    data.append(char(11));
+    data.append(QByteArray::fromHex("0a0b0c"));
+    data.append(QByteArray::fromHex("001218"));
+    data.append(valvePosition);
+    data.append(QByteArray::fromHex("2b000000"));
+
+    // wall thermostat in manual mode, setpoint 22.0, current 21.5
+    data.append(char(12));
+    data.append(QByteArray::fromHex("101112"));
+    data.append(QByteArray::fromHex("00121900"));
+    data.append(QByteArray::fromHex("2c000000d7"));
+
+    return data;
+}
+
+QByteArray TestMaxCube::cubeSession()
+{
+    QByteArray metadataBase64 = metadata().toBase64();
+    int split = metadataBase64.length() / 2;
+
+    QByteArray session;
+    session.append("H:KEQ0523864,097f2c,0113,00000000,477719c0,00,32,100b1e,0f24,03,0000\r\n");
+    session.append("M:00,02," + metadataBase64.left(split) + "\r\n");
+    session.append("M:01,02," + metadataBase64.mid(split) + "\r\n");
+    session.append("C:0a0b0c," + radiatorConfig().toBase64() + "\r\n");
+    session.append("L:" + liveData(0x40).toBase64() + "\r\n");
+    session.append("S:00,0,00\r\n");
+    return session;
+}
+
+void TestMaxCube::decodeBase64_data()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    QByteArray allBytes;
+    for (int i = 0; i < 256; i++)
+        allBytes.append(char(i));
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("two padding characters") << QByteArray("f");
+    QTest::newRow("one padding character") << QByteArray("fo");
+    QTest::newRow("no padding") << QByteArray("foo");
+    QTest::newRow("all byte values") << allBytes;
+    QTest::newRow("metadata") << metadata();
+    QTest::newRow("config") << radiatorConfig();
+}
+
+void TestMaxCube::decodeBase64()
+{
+    QFETCH(QByteArray, data);
+
+    QByteArray encoded = data.toBase64();
+
+    // the buffer gets reused between the messages
+    QByteArray output("some previous content which is longer than the data");
+    MaxCubeDecoder::decodeBase64(encoded, output);
+    QCOMPARE(output, QByteArray::fromBase64(encoded));
+    QCOMPARE(output, data);
+}
+
+void TestMaxCube::chunkedSession_data()
+{
+    QTest::addColumn<int>("chunkSize");
+
+    QTest::newRow("byte by byte") << 1;
+    QTest::newRow("7 bytes") << 7;
+    QTest::newRow("64 bytes") << 64;
+    QTest::newRow("whole session") << cubeSession().length();
+}
+
+void TestMaxCube::chunkedSession()
+{
+    QFETCH(int, chunkSize);
+
+    MaxCubeDecoder decoder;
+    QSignalSpy helloSpy(&decoder, SIGNAL(helloReceived()));
+    QSignalSpy radiatorFoundSpy(&decoder, SIGNAL(radiatorThermostatFound()));
+    QSignalSpy radiatorSpy(&decoder, SIGNAL(radiatorThermostatDataUpdated(RadiatorThermostat*)));
+    QSignalSpy wallSpy(&decoder, SIGNAL(wallThermostatDataUpdated(WallThermostat*)));
+    QSignalSpy commandSpy(&decoder, SIGNAL(commandFinished(bool)));
+
+    QByteArray session = cubeSession();
+    for (int i = 0; i < session.length(); i += chunkSize)
+        decoder.processData(session.mid(i, chunkSize));
+
+    // hello
+    QCOMPARE(helloSpy.count(), 1);
+    QCOMPARE(decoder.rfAddress(), QByteArray("097f2c"));
+    QCOMPARE(decoder.firmware(), 113);
+    QCOMPARE(decoder.cubeDateTime(), QDateTime(QDate(2016, 11, 30), QTime(15, 36)));
+
+    // metadata: the window contact gets skipped, the wall thermostat behind it still gets parsed
+    QVERIFY(decoder.isInitialized());
+    QCOMPARE(decoder.roomList().count(), 1);
+    QCOMPARE(decoder.roomList().first()->roomName(), QString("Living"));
+    QCOMPARE(decoder.radiatorThermostatList().count(), 1);
+    QCOMPARE(decoder.wallThermostatList().count(), 1);
+
+    RadiatorThermostat *radiator = decoder.radiatorThermostatList().first();
+    QCOMPARE(radiator->deviceName(), QString("Heater"));
+    QCOMPARE(radiator->serialNumber(), QString("KEQ0000001"));
+    QCOMPARE(radiator->rfAddress(), QByteArray("0a0b0c"));
+    QCOMPARE(radiator->roomName(), QString("Living"));
+
+    WallThermostat *wall = decoder.wallThermostatList().first();
+    QCOMPARE(wall->deviceName(), QString("Wall"));
+    QCOMPARE(wall->serialNumber(), QString("KEQ0000003"));
+    QCOMPARE(wall->rfAddress(), QByteArray("101112"));
+    QCOMPARE(wall->roomName(), QString("Living"));
+
+    // config
+    QCOMPARE(radiatorFoundSpy.count(), 1);
+    QCOMPARE(radiator->comfortTemp(), 21.5);
+    QCOMPARE(radiator->ecoTemp(), 17.0);
+    QCOMPARE(radiator->maxSetPointTemp(), 30.5);
+    QCOMPARE(radiator->minSetPointTemp(), 4.5);
+    QCOMPARE(radiator->offsetTemp(), 1.0);
+    QCOMPARE(radiator->windowOpenTemp(), 12.0);
+
+    // live data
+    QCOMPARE(radiatorSpy.count(), 1);
+    QCOMPARE(radiator->valvePosition(), 0x40);
+    QCOMPARE(radiator->setpointTemperature(), 21.5);
+    QCOMPARE(radiator->deviceMode(), (int)MaxDevice::Auto);
+    QVERIFY(radiator->gatewayKnown());
+    QVERIFY(radiator->dtsActive());
+
+    QCOMPARE(wallSpy.count(), 1);
+    QCOMPARE(wall->setpointTemperature(), 22.0);
+    QCOMPARE(wall->currentTemperature(), 21.5);
+    QCOMPARE(wall->deviceMode(), (int)MaxDevice::Manual);
+
+    // command result
+    QCOMPARE(commandSpy.count(), 1);
+    QCOMPARE(commandSpy.first().first().toBool(), true);
+}
+
+void TestMaxCube::metadataParts()
+{
+    QByteArray metadataBase64 = metadata().toBase64();
+    int split = metadataBase64.length() / 3;
+
+    MaxCubeDecoder decoder;
+    decoder.processData("M:00,03," + metadataBase64.left(split) + "\r\n");
+    QVERIFY(!decoder.isInitialized());
+    QVERIFY(decoder.roomList().isEmpty());
+
+    decoder.processData("M:01,03," + metadataBase64.mid(split, split) + "\r\n");
+    QVERIFY(!decoder.isInitialized());
+    QVERIFY(decoder.roomList().isEmpty());
+
+    decoder.processData("M:02,03," + metadataBase64.mid(2 * split) + "\r\n");
+    QVERIFY(decoder.isInitialized());
+    QCOMPARE(decoder.roomList().count(), 1);
+    QCOMPARE(decoder.radiatorThermostatList().count(), 1);
+    QCOMPARE(decoder.wallThermostatList().count(), 1);
+
+    // the metadata of a reconnect replaces the devices
+    decoder.reset();
+    QVERIFY(!decoder.isInitialized());
+    decoder.processData("M:00,01," + metadataBase64 + "\r\n");
+    QVERIFY(decoder.isInitialized());
+    QCOMPARE(decoder.roomList().count(), 1);
+    QCOMPARE(decoder.radiatorThermostatList().count(), 1);
+    QCOMPARE(decoder.wallThermostatList().count(), 1);
+}
+
+void TestMaxCube::metadataPartOutOfOrder()
+{
+    QByteArray metadataBase64 = metadata().toBase64();
+    int split = metadataBase64.length() / 2;
+
+    MaxCubeDecoder decoder;
+    decoder.processData("M:01,02," + metadataBase64.mid(split) + "\r\n");
+    QVERIFY(!decoder.isInitialized());
+
+    decoder.processData("M:00,02," + metadataBase64.left(split) + "\r\n");
+    decoder.processData("M:00,02," + metadataBase64.left(split) + "\r\n");
+    decoder.processData("M:01,02," + metadataBase64.mid(split) + "\r\n");
+    QVERIFY(decoder.isInitialized());
+    QCOMPARE(decoder.radiatorThermostatList().count(), 1);
+    QCOMPARE(decoder.wallThermostatList().count(), 1);
+}
+
+void TestMaxCube::shortLiveRecords()
+{
+    MaxCubeDecoder decoder;
+    decoder.processData("M:00,01," + metadata().toBase64() + "\r\n");
+    QVERIFY(decoder.isInitialized());
+
+    QSignalSpy radiatorSpy(&decoder, SIGNAL(radiatorThermostatDataUpdated(RadiatorThermostat*)));
+    QSignalSpy wallSpy(&decoder, SIGNAL(wallThermostatDataUpdated(WallThermostat*)));
+
+    // a 6 byte record of a radiator thermostat has no valve position and gets skipped,
+    // the wall thermostat record behind it still gets decoded
+    QByteArray data = QByteArray::fromHex("060a0b0c001218");
+    data.append(liveData(0x40).mid(19));
+    decoder.processData("L:" + data.toBase64() + "\r\n");
+
+    QCOMPARE(radiatorSpy.count(), 0);
+    QCOMPARE(wallSpy.count(), 1);
+
+    // a record which overruns the message stops the decoding
+    decoder.processData("L:" + QByteArray::fromHex("0c101112").toBase64() + "\r\n");
+    QCOMPARE(wallSpy.count(), 1);
+}
+
+void TestMaxCube::unchangedLiveData()
+{
+    MaxCubeDecoder decoder;
+    decoder.processData("M:00,01," + metadata().toBase64() + "\r\n");
+
+    QSignalSpy radiatorSpy(&decoder, SIGNAL(radiatorThermostatDataUpdated(RadiatorThermostat*)));
+    QSignalSpy wallSpy(&decoder, SIGNAL(wallThermostatDataUpdated(WallThermostat*)));
+
+    decoder.processData("L:" + liveData(0x40).toBase64() + "\r\n");
+    QCOMPARE(radiatorSpy.count(), 1);
+    QCOMPARE(wallSpy.count(), 1);
+
+    // only changed records get decoded
+    decoder.processData("L:" + liveData(0x40).toBase64() + "\r\n");
+    QCOMPARE(radiatorSpy.count(), 1);
+    QCOMPARE(wallSpy.count(), 1);
+
+    decoder.processData("L:" + liveData(0x20).toBase64() + "\r\n");
+    QCOMPARE(radiatorSpy.count(), 2);
+    QCOMPARE(wallSpy.count(), 1);
+    QCOMPARE(decoder.radiatorThermostatList().first()->valvePosition(), 0x20);
+}
+
+#include "testmaxcube.moc"
+QTEST_MAIN(TestMaxCube)
@@ -0,0 +1,6 @@
+TARGET = testmetrics
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += testmetrics.cpp
@@ -0,0 +1,216 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "guhtestbase.h"
+#include "metrics.h"
+#include "calltrace.h"
+#include "guhcore.h"
+#include "stallwatchdog.h"
+#include "startupprofiler.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+using namespace guhserver;
+
+class TestMetrics: public GuhTestBase
+{
+    Q_OBJECT
+
+private slots:
+    void registry();
+    void histogramBuckets();
+    void prometheusText();
+
+    void getMetrics();
+    void scrapeMetrics();
+
+    void slowCalls();
+    void stalls();
+
+};
+
+void TestMetrics::registry()
+{
+    MetricCounter *counter = Metrics::counter("test_registry_total", "Test counter.", "label", "a");
+    QVERIFY(counter);
+
+    // the same name and label returns the same metric, another label a new series
+    QCOMPARE(Metrics::counter("test_registry_total", "Test counter.", "label", "a"), counter);
+    QVERIFY(Metrics::counter("test_registry_total", "Test counter.", "label", "b") != counter);
+
+    // a name can only have one type
+    QVERIFY(!Metrics::gauge("test_registry_total", "Test gauge.", "label", "a"));
+
+    counter->increment();
+    counter->increment(41);
+    QCOMPARE(counter->value(), (qint64)42);
+
+    MetricGauge *gauge = Metrics::gauge("test_registry_gauge", "Test gauge.");
+    gauge->set(10);
+    gauge->increment(5);
+    gauge->decrement(7);
+    QCOMPARE(gauge->value(), (qint64)8);
+}
+
+void TestMetrics::histogramBuckets()
+{
+    MetricHistogram *histogram = Metrics::histogram("test_histogram", "Test histogram.", QList<qint64>() << 100 << 10 << 1000);
+    QCOMPARE(histogram->bounds(), QList<qint64>() << 10 << 100 << 1000);
+
+    histogram->observe(5);
+    histogram->observe(10);
+    histogram->observe(50);
+    histogram->observe(5000);
+
+    // the bucket counts are cumulative, the last one has no upper bound
+    QCOMPARE(histogram->bucketCounts(), QList<qint64>() << 2 << 3 << 3 << 4);
+    QCOMPARE(histogram->count(), (qint64)4);
+    QCOMPARE(histogram->sum(), (qint64)5065);
+}
+
+void TestMetrics::prometheusText()
+{
+    Metrics::counter("test_escaping_total", "Line\nbreak", "name", "quote\"d")->increment(3);
+
+    QByteArray text = Metrics::prometheusText();
+    QVERIFY(text.contains("# HELP test_escaping_total Line\\nbreak\n"));
+    QVERIFY(text.contains("# TYPE test_escaping_total counter\n"));
+    QVERIFY(text.contains("test_escaping_total{name=\"quote\\\"d\"} 3\n"));
+
+    QVERIFY(text.contains("# TYPE test_histogram histogram\n"));
+    QVERIFY(text.contains("test_histogram_bucket{le=\"10\"} 2\n"));
+    QVERIFY(text.contains("test_histogram_bucket{le=\"+Inf\"} 4\n"));
+    QVERIFY(text.contains("test_histogram_count 4\n"));
+
+    // every series of a name follows its header
+    QCOMPARE(text.count("# TYPE test_registry_total "), 1);
+}
+
+void TestMetrics::getMetrics()
+{
+    // Trigger a rule evaluation
+    QNetworkAccessManager nam;
+    QSignalSpy spy(&nam, SIGNAL(finished(QNetworkReply*)));
+    QNetworkRequest request(QUrl(QString("http://localhost:%1/generateevent?eventtypeid=%2").arg(m_mockDevice1Port).arg(mockEvent1Id.toString())));
+    QNetworkReply *reply = nam.get(request);
+    spy.wait();
+    QCOMPARE(spy.count(), 1);
+    reply->deleteLater();
+
+    QVariantList metrics = injectAndWait("Metrics.GetMetrics").toMap().value("params").toMap().value("metrics").toList();
+    QVERIFY(!metrics.isEmpty());
+
+    bool evaluationFound = false;
+    bool pluginEventsFound = false;
+    foreach (const QVariant &metricVariant, metrics) {
+        QVariantMap metric = metricVariant.toMap();
+        if (metric.value("name").toString() == "guh_rule_evaluation_duration_microseconds") {
+            QCOMPARE(metric.value("type").toString(), QString("MetricTypeHistogram"));
+            QVERIFY(metric.value("count").toLongLong() > 0);
+            QCOMPARE(metric.value("buckets").toList().count(), Metrics::durationBounds().count() + 1);
+            QVERIFY(!metric.value("buckets").toList().last().toMap().contains("upperBound"));
+            evaluationFound = true;
+        }
+
+        if (metric.value("name").toString() == "guh_plugin_events_total" && metric.value("value").toLongLong() > 0) {
+            QCOMPARE(metric.value("labelName").toString(), QString("plugin"));
+            pluginEventsFound = true;
+        }
+    }
+    QVERIFY(evaluationFound);
+    QVERIFY(pluginEventsFound);
+
+    QVariantList restMetrics = getAndWait(QNetworkRequest(QUrl("http://localhost:3333/api/v1/system/metrics"))).toList();
+    QCOMPARE(restMetrics.count(), metrics.count());
+}
+
+void TestMetrics::scrapeMetrics()
+{
+    QNetworkAccessManager nam;
+    QSignalSpy spy(&nam, SIGNAL(finished(QNetworkReply*)));
+    QNetworkReply *reply = nam.get(QNetworkRequest(QUrl("http://localhost:3333/metrics")));
+    spy.wait();
+    QCOMPARE(spy.count(), 1);
+
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QVERIFY(reply->header(QNetworkRequest::ContentTypeHeader).toString().startsWith("text/plain"));
+
+    QByteArray text = reply->readAll();
+    QVERIFY(text.contains("# TYPE guh_rule_evaluation_duration_microseconds histogram\n"));
+    QVERIFY(text.contains("guh_transport_clients{transport=\"tcp\"}"));
+    reply->deleteLater();
+}
+
+void TestMetrics::slowCalls()
+{
+    CallTrace::clearSlowestCalls();
+    CallTrace::setSlowCallThreshold(0);
+    injectAndWait("JSONRPC.Version");
+    CallTrace::setSlowCallThreshold(100);
+
+    QVariantList slowCalls = injectAndWait("Metrics.GetSlowCalls").toMap().value("params").toMap().value("slowCalls").toList();
+    QVERIFY(!slowCalls.isEmpty());
+
+    bool versionFound = false;
+    foreach (const QVariant &slowCallVariant, slowCalls) {
+        QVariantMap slowCall = slowCallVariant.toMap();
+        if (slowCall.value("site").toString() == "JSON-RPC: JSONRPC.Version") {
+            QCOMPARE(slowCall.value("context").toList().last().toString(), QString("JSON-RPC: JSONRPC.Version"));
+            versionFound = true;
+        }
+    }
+    QVERIFY(versionFound);
+}
+
+void TestMetrics::stalls()
+{
+    QTRY_VERIFY(StartupProfiler::isFinished());
+    GuhCore::instance()->stallWatchdog()->setThreshold(100);
+
+    // block the event loop within a traced call
+    {
+        CallTrace trace("TestMetrics", "block");
+        QTest::qSleep(400);
+    }
+
+    // let the heartbeat arrive
+    QTest::qWait(200);
+    GuhCore::instance()->stallWatchdog()->setThreshold(250);
+
+    QVariantList stalls = injectAndWait("Metrics.GetSlowCalls").toMap().value("params").toMap().value("stalls").toList();
+    QVERIFY(!stalls.isEmpty());
+
+    bool stallFound = false;
+    foreach (const QVariant &stallVariant, stalls) {
+        QVariantMap stall = stallVariant.toMap();
+        if (stall.value("site").toString() == "TestMetrics: block") {
+            QVERIFY(stall.value("duration").toInt() >= 100);
+            stallFound = true;
+        }
+    }
+    QVERIFY(stallFound);
+}
+
+#include "testmetrics.moc"
+QTEST_MAIN(TestMetrics)
@@ -42,16 +42,9 @@ MockTcpServer::~MockTcpServer()
     s_allServers.removeAll(this);
 }
 
-void MockTcpServer::sendData(const QUuid &clientId, const QVariantMap &data)
+void MockTcpServer::sendPayload(const QUuid &clientId, const QByteArray &payload)
 {
-    emit outgoingData(clientId, QJsonDocument::fromVariant(data).toJson());
-}
-
-void MockTcpServer::sendData(const QList<QUuid> &clients, const QVariantMap &data)
-{
-    foreach (const QUuid &clientId, clients) {
-        sendData(clientId, data);
-    }
+    emit outgoingData(clientId, payload);
 }
 
 QList<MockTcpServer *> MockTcpServer::servers()
@@ -61,47 +54,17 @@ QList<MockTcpServer *> MockTcpServer::servers()
 
 void MockTcpServer::injectData(const QUuid &clientId, const QByteArray &data)
 {
-    QJsonParseError error;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(data, &error);
-
-    if(error.error != QJsonParseError::NoError) {
-        qCWarning(dcJsonRpc) << "Failed to parse JSON data" << data << ":" << error.errorString();
-        sendErrorResponse(clientId, -1, QString("Failed to parse JSON data: %1").arg(error.errorString()));
-        return;
-    }
-
-    QVariantMap message = jsonDoc.toVariant().toMap();
-
-    bool success;
-    int commandId = message.value("id").toInt(&success);
-    if (!success) {
-        qCWarning(dcJsonRpc) << "Error parsing command. Missing \"id\":" << message;
-        sendErrorResponse(clientId, commandId, "Error parsing command. Missing 'id'");
-        return;
-    }
-
-    QStringList commandList = message.value("method").toString().split('.');
-    if (commandList.count() != 2) {
-        qCWarning(dcJsonRpc) << "Error parsing method.\nGot:" << message.value("method").toString() << "\nExpected: \"Namespace.method\"";
-        sendErrorResponse(clientId, commandId, QString("Error parsing method. Got: '%1'', Expected: 'Namespace.method'").arg(message.value("method").toString()));
-        return;
-    }
-
-    QString targetNamespace = commandList.first();
-    QString method = commandList.last();
-
-    JsonHandler *handler = GuhCore::instance()->jsonRPCServer()->handlers().value(targetNamespace);
-    if (!handler) {
-        sendErrorResponse(clientId, commandId, "No such namespace");
-        return;
-    }
-
-    if (!handler->hasMethod(method)) {
-        sendErrorResponse(clientId, commandId, "No such method");
-        return;
-    }
-
-    emit dataAvailable(clientId, targetNamespace, method, message);
+    validateMessage(clientId, data);
+}
+
+void MockTcpServer::connectClient(const QUuid &clientId)
+{
+    emit clientConnected(clientId);
+}
+
+void MockTcpServer::disconnectClient(const QUuid &clientId)
+{
+    emit clientDisconnected(clientId);
 }
 
 void MockTcpServer::sendResponse(const QUuid &clientId, int commandId, const QVariantMap &params)
@@ -38,12 +38,13 @@ public:
     explicit MockTcpServer(QObject *parent = 0);
     ~MockTcpServer();
 
-    void sendData(const QUuid &clientId, const QVariantMap &data) override;
-    void sendData(const QList<QUuid> &clients, const QVariantMap &data) override;
+    void sendPayload(const QUuid &clientId, const QByteArray &payload) override;
 
 /************** Used for testing **************************/
     static QList<MockTcpServer*> servers();
     void injectData(const QUuid &clientId, const QByteArray &data);
+    void connectClient(const QUuid &clientId);
+    void disconnectClient(const QUuid &clientId);
 signals:
     void outgoingData(const QUuid &clientId, const QByteArray &data);
 /************** Used for testing **************************/
@@ -0,0 +1,6 @@
+TARGET = testnetworkaccessmanager
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += testnetworkaccessmanager.cpp
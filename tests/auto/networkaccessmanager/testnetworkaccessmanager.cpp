@@ -0,0 +1,217 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "network/networkaccessmanager.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+// Minimal HTTP server which answers every GET with an ETag and revalidations with 304
+class HttpResponder : public QTcpServer
+{
+    Q_OBJECT
+public:
+    HttpResponder() : m_requests(0), m_notModified(0), m_maxAge(0), m_holdResponses(false) { listen(QHostAddress::LocalHost); }
+
+    int requests() const { return m_requests; }
+    int notModified() const { return m_notModified; }
+    void setHoldResponses(bool holdResponses) { m_holdResponses = holdResponses; }
+    void setMaxAge(int maxAge) { m_maxAge = maxAge; }
+
+protected:
+    void incomingConnection(qintptr socketDescriptor) override
+    {
+        QTcpSocket *socket = new QTcpSocket(this);
+        socket->setSocketDescriptor(socketDescriptor);
+        connect(socket, &QTcpSocket::readyRead, this, &HttpResponder::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, socket, &QTcpSocket::deleteLater);
+    }
+
+private:
+    int m_requests;
+    int m_notModified;
+    int m_maxAge;
+    bool m_holdResponses;
+
+private slots:
+    void onReadyRead()
+    {
+        QTcpSocket *socket = static_cast<QTcpSocket *>(sender());
+        QByteArray request = socket->readAll();
+        if (!request.contains("\r\n\r\n"))
+            return;
+
+        m_requests++;
+        if (m_holdResponses)
+            return;
+
+        if (request.contains("If-None-Match: \"v1\"")) {
+            m_notModified++;
+            socket->write("HTTP/1.1 304 Not Modified\r\nETag: \"v1\"\r\nContent-Length: 0\r\n\r\n");
+            return;
+        }
+
+        QByteArray cacheControl;
+        if (m_maxAge > 0)
+            cacheControl = "Cache-Control: max-age=" + QByteArray::number(m_maxAge) + "\r\n";
+
+        QByteArray content("{\"state\":true}");
+        socket->write("HTTP/1.1 200 OK\r\nETag: \"v1\"\r\n" + cacheControl + "Content-Type: application/json\r\nContent-Length: " + QByteArray::number(content.size()) + "\r\n\r\n" + content);
+    }
+};
+
+class TestNetworkAccessManager: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void revalidateCachedResponse();
+    void serveFreshResponseFromCache();
+    void limitHostRequests();
+    void abortQueuedRequest();
+};
+
+void TestNetworkAccessManager::initTestCase()
+{
+    qRegisterMetaType<PluginId>();
+}
+
+void TestNetworkAccessManager::revalidateCachedResponse()
+{
+    HttpResponder responder;
+    NetworkAccessManager manager;
+    PluginId pluginId = PluginId::createPluginId();
+    QSignalSpy spy(&manager, SIGNAL(replyReady(PluginId,QNetworkReply*)));
+
+    QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1/api").arg(responder.serverPort())));
+    for (int i = 0; i < 2; i++) {
+        QNetworkReply *reply = manager.get(pluginId, request);
+        QVERIFY(spy.wait());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+        QCOMPARE(reply->readAll(), QByteArray("{\"state\":true}"));
+        reply->deleteLater();
+    }
+
+    QCOMPARE(responder.requests(), 2);
+    QCOMPARE(responder.notModified(), 1);
+    QCOMPARE(manager.statistics(pluginId).requests, 2);
+    QCOMPARE(manager.statistics(pluginId).cacheHits, 1);
+}
+
+void TestNetworkAccessManager::serveFreshResponseFromCache()
+{
+    HttpResponder responder;
+    responder.setMaxAge(60);
+    NetworkAccessManager manager;
+    PluginId pluginId = PluginId::createPluginId();
+    QSignalSpy spy(&manager, SIGNAL(replyReady(PluginId,QNetworkReply*)));
+
+    QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1/api").arg(responder.serverPort())));
+    QNetworkReply *reply = manager.get(pluginId, request);
+    QVERIFY(spy.wait());
+    reply->deleteLater();
+    spy.clear();
+
+    // the fresh cache hit must not be sent by the request queued in the same event loop pass
+    QNetworkReply *cachedReply = manager.get(pluginId, request);
+    QNetworkReply *postReply = manager.post(pluginId, QNetworkRequest(QUrl(QString("http://127.0.0.1:%1/item").arg(responder.serverPort()))), QByteArray("{}"));
+    QCOMPARE(manager.runningRequests(), 1);
+    QCOMPARE(manager.queuedRequests(), 0);
+
+    while (spy.count() < 2)
+        QVERIFY(spy.wait());
+
+    // no late second replyReady for the cache hit
+    QVERIFY(!spy.wait(200));
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(qvariant_cast<QNetworkReply *>(spy.at(0).at(1)), cachedReply);
+    QCOMPARE(qvariant_cast<QNetworkReply *>(spy.at(1).at(1)), postReply);
+    QCOMPARE(cachedReply->readAll(), QByteArray("{\"state\":true}"));
+    QCOMPARE(responder.requests(), 2);
+    QCOMPARE(manager.runningRequests(), 0);
+    QCOMPARE(manager.statistics(pluginId).cacheHits, 1);
+
+    delete cachedReply;
+    delete postReply;
+}
+
+void TestNetworkAccessManager::limitHostRequests()
+{
+    HttpResponder responder;
+    NetworkAccessManager manager;
+    manager.setMaximumHostRequests(1);
+    PluginId pluginId = PluginId::createPluginId();
+    QSignalSpy spy(&manager, SIGNAL(replyReady(PluginId,QNetworkReply*)));
+
+    QList<QNetworkReply *> replies;
+    for (int i = 0; i < 3; i++) {
+        QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1/item/%2").arg(responder.serverPort()).arg(i)));
+        replies.append(manager.post(pluginId, request, QByteArray("{}")));
+    }
+
+    QCOMPARE(manager.runningRequests(), 1);
+    QCOMPARE(manager.queuedRequests(), 2);
+
+    // the queue has to drain one request after another
+    while (spy.count() < 3)
+        QVERIFY(spy.wait());
+
+    QCOMPARE(responder.requests(), 3);
+    QCOMPARE(manager.runningRequests(), 0);
+    QCOMPARE(manager.queuedRequests(), 0);
+    qDeleteAll(replies);
+}
+
+void TestNetworkAccessManager::abortQueuedRequest()
+{
+    HttpResponder responder;
+    responder.setHoldResponses(true);
+    NetworkAccessManager manager;
+    manager.setMaximumPluginRequests(1);
+    manager.setRequestTimeout(500);
+    PluginId pluginId = PluginId::createPluginId();
+    QSignalSpy spy(&manager, SIGNAL(replyReady(PluginId,QNetworkReply*)));
+
+    QNetworkRequest request(QUrl(QString("http://127.0.0.1:%1/api").arg(responder.serverPort())));
+    QNetworkReply *runningReply = manager.post(pluginId, request, QByteArray());
+    QNetworkReply *queuedReply = manager.post(pluginId, request, QByteArray());
+    QCOMPARE(manager.queuedRequests(), 1);
+
+    queuedReply->abort();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(queuedReply->error(), QNetworkReply::OperationCanceledError);
+    QCOMPARE(manager.queuedRequests(), 0);
+
+    // the held request runs into the timeout
+    QVERIFY(spy.wait());
+    QCOMPARE(runningReply->error(), QNetworkReply::TimeoutError);
+    QCOMPARE(manager.statistics(pluginId).timeouts, 1);
+
+    delete runningReply;
+    delete queuedReply;
+}
+
+#include "testnetworkaccessmanager.moc"
+QTEST_MAIN(TestNetworkAccessManager)
@@ -0,0 +1,14 @@
+TARGET = testnetworkdetector
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+INCLUDEPATH += $$top_srcdir/plugins/deviceplugins/networkdetector \
+    $$top_builddir/plugins/deviceplugins/networkdetector
+
+SOURCES += testnetworkdetector.cpp \
+    $$top_srcdir/plugins/deviceplugins/networkdetector/neighbortable.cpp \
+    $$top_srcdir/plugins/deviceplugins/networkdetector/presenceengine.cpp
+
+HEADERS += $$top_srcdir/plugins/deviceplugins/networkdetector/neighbortable.h \
+    $$top_srcdir/plugins/deviceplugins/networkdetector/presenceengine.h
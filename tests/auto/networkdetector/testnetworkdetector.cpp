@@ -0,0 +1,133 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "neighbortable.h"
+#include "presenceengine.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QSignalSpy>
+
+// the plugin sources log to the category of the plugin library
+Q_LOGGING_CATEGORY(dcNetworkDetector, "NetworkDetector")
+
+// Neighbor table filled by the test instead of the kernel
+class FakeNeighborTable : public NeighborTable
+{
+public:
+    QList<NeighborEntry> entries;
+    QList<QHostAddress> probes;
+
+    QList<NeighborEntry> readEntries() override { return entries; }
+    void probe(const QHostAddress &address) override { probes.append(address); }
+};
+
+class TestNetworkDetector: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseProcNeighborTable();
+
+    void presenceHysteresis();
+    void presenceAddressChanged();
+};
+
+void TestNetworkDetector::parseProcNeighborTable()
+{
+    QByteArray data("IP address       HW type     Flags       HW address            Mask     Device\n"
+                    "10.10.10.1       0x1         0x2         00:11:22:AA:BB:CC     *        eth0\n"
+                    "10.10.10.23      0x1         0x0         00:00:00:00:00:00     *        eth0\n"
+                    "invalid line\n");
+
+    QList<NeighborEntry> entries = ProcNeighborTable::parse(data);
+    QCOMPARE(entries.count(), 2);
+
+    QCOMPARE(entries.at(0).address(), QHostAddress("10.10.10.1"));
+    QCOMPARE(entries.at(0).macAddress(), QString("00:11:22:aa:bb:cc"));
+    QCOMPARE(entries.at(0).interface(), QString("eth0"));
+    QVERIFY(entries.at(0).complete());
+
+    QCOMPARE(entries.at(1).address(), QHostAddress("10.10.10.23"));
+    QVERIFY(!entries.at(1).complete());
+}
+
+void TestNetworkDetector::presenceHysteresis()
+{
+    FakeNeighborTable *table = new FakeNeighborTable();
+    PresenceEngine engine(table);
+    engine.setAbsentThreshold(3);
+    engine.addHost("10.10.10.5");
+
+    QSignalSpy spy(&engine, SIGNAL(hostStateChanged(QString, bool)));
+
+    table->entries.append(NeighborEntry(QHostAddress("10.10.10.1"), "00:11:22:33:44:01", "eth0", true));
+    table->entries.append(NeighborEntry(QHostAddress("10.10.10.5"), "00:11:22:33:44:05", "eth0", true));
+    engine.poll();
+
+    QCOMPARE(engine.hostState("10.10.10.5"), PresenceEngine::HostStatePresent);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(1).toBool(), true);
+
+    // only the tracked host gets probed
+    QCOMPARE(table->probes, QList<QHostAddress>() << QHostAddress("10.10.10.5"));
+
+    // missing for less polls than the threshold keeps the host present
+    table->entries.removeLast();
+    engine.poll();
+    engine.poll();
+    QCOMPARE(engine.hostState("10.10.10.5"), PresenceEngine::HostStatePresent);
+    QCOMPARE(spy.count(), 1);
+
+    engine.poll();
+    QCOMPARE(engine.hostState("10.10.10.5"), PresenceEngine::HostStateAbsent);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(1).toBool(), false);
+
+    // an incomplete entry does not count as present
+    table->entries.append(NeighborEntry(QHostAddress("10.10.10.5"), "00:00:00:00:00:00", "eth0", false));
+    engine.poll();
+    QCOMPARE(engine.hostState("10.10.10.5"), PresenceEngine::HostStateAbsent);
+    QCOMPARE(spy.count(), 2);
+}
+
+void TestNetworkDetector::presenceAddressChanged()
+{
+    FakeNeighborTable *table = new FakeNeighborTable();
+    PresenceEngine engine(table);
+    engine.addHost("10.10.10.5");
+
+    table->entries.append(NeighborEntry(QHostAddress("10.10.10.5"), "00:11:22:33:44:05", "eth0", true));
+    engine.poll();
+    QCOMPARE(engine.hostState("10.10.10.5"), PresenceEngine::HostStatePresent);
+
+    // the same hardware address with a new lease keeps the host present
+    table->entries.clear();
+    table->entries.append(NeighborEntry(QHostAddress("10.10.10.42"), "00:11:22:33:44:05", "eth0", true));
+    table->probes.clear();
+    engine.poll();
+
+    QCOMPARE(engine.hostState("10.10.10.5"), PresenceEngine::HostStatePresent);
+    QCOMPARE(engine.hostAddress("10.10.10.5"), QHostAddress("10.10.10.42"));
+    QCOMPARE(table->probes, QList<QHostAddress>() << QHostAddress("10.10.10.42"));
+}
+
+#include "testnetworkdetector.moc"
+QTEST_MAIN(TestNetworkDetector)
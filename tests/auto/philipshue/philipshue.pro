@@ -0,0 +1,20 @@
+TARGET = testphilipshue
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+INCLUDEPATH += $$top_srcdir/plugins/deviceplugins/philipshue \
+    $$top_builddir/plugins/deviceplugins/philipshue
+
+SOURCES += testphilipshue.cpp \
+    $$top_srcdir/plugins/deviceplugins/philipshue/huebridge.cpp \
+    $$top_srcdir/plugins/deviceplugins/philipshue/huedevice.cpp \
+    $$top_srcdir/plugins/deviceplugins/philipshue/huelight.cpp \
+    $$top_srcdir/plugins/deviceplugins/philipshue/huecommandqueue.cpp \
+    $$top_srcdir/plugins/deviceplugins/philipshue/huesnapshot.cpp
+
+HEADERS += $$top_srcdir/plugins/deviceplugins/philipshue/huebridge.h \
+    $$top_srcdir/plugins/deviceplugins/philipshue/huedevice.h \
+    $$top_srcdir/plugins/deviceplugins/philipshue/huelight.h \
+    $$top_srcdir/plugins/deviceplugins/philipshue/huecommandqueue.h \
+    $$top_srcdir/plugins/deviceplugins/philipshue/huesnapshot.h
@@ -0,0 +1,309 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "huebridge.h"
+#include "huelight.h"
+#include "huecommandqueue.h"
+#include "huesnapshot.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QSignalSpy>
+
+// the plugin sources log to the category of the plugin library
+Q_LOGGING_CATEGORY(dcPhilipsHue, "PhilipsHue")
+
+// Datastore of a bridge with two lights, two groups and a dimmer switch
+static const char *bridgeResponse =
+        "{"
+        "  \"config\": {\"name\": \"Philips hue\", \"apiversion\": \"1.16.0\", \"swversion\": \"01036659\", \"swupdate\": {\"updatestate\": 2}},"
+        "  \"lights\": {"
+        "    \"1\": {\"name\": \"Living room\", \"type\": \"Extended color light\", \"state\": {\"on\": true, \"bri\": 254, \"hue\": 8418, \"sat\": 140,"
+        "            \"xy\": [0.4573, 0.41], \"ct\": 366, \"alert\": \"none\", \"effect\": \"none\", \"colormode\": \"ct\", \"reachable\": true}},"
+        "    \"2\": {\"name\": \"Hall\", \"type\": \"Dimmable light\", \"state\": {\"on\": false, \"bri\": 1, \"alert\": \"none\", \"reachable\": false}}"
+        "  },"
+        "  \"groups\": {"
+        "    \"1\": {\"name\": \"Downstairs\", \"type\": \"Room\", \"lights\": [\"1\", \"2\"]},"
+        "    \"2\": {\"name\": \"Empty\", \"type\": \"LightGroup\", \"lights\": []}"
+        "  },"
+        "  \"sensors\": {"
+        "    \"4\": {\"name\": \"Dimmer\", \"type\": \"ZLLSwitch\", \"state\": {\"buttonevent\": 1002, \"lastupdated\": \"2016-03-01T10:00:00\"},"
+        "            \"config\": {\"on\": true, \"battery\": 100}}"
+        "  }"
+        "}";
+
+class TestPhilipsHue: public QObject
+{
+    Q_OBJECT
+
+private:
+    void setUpBridge(HueBridge *bridge);
+    QVariantMap createState(const QString &key, const QVariant &value);
+
+private slots:
+    void coalesceCommands();
+    void commandOrder();
+    void groupCommands();
+    void clearQueue();
+    void createRequest();
+
+    void parseSnapshot();
+    void parseSnapshotErrors_data();
+    void parseSnapshotErrors();
+    void applySnapshot();
+};
+
+void TestPhilipsHue::setUpBridge(HueBridge *bridge)
+{
+    bridge->setHostAddress(QHostAddress("10.0.0.5"));
+    bridge->setApiKey("apikey");
+}
+
+QVariantMap TestPhilipsHue::createState(const QString &key, const QVariant &value)
+{
+    QVariantMap state;
+    state.insert(key, value);
+    return state;
+}
+
+void TestPhilipsHue::coalesceCommands()
+{
+    HueBridge bridge;
+    setUpBridge(&bridge);
+    HueCommandQueue *queue = new HueCommandQueue(&bridge);
+    QList<HueCommand> commands;
+    connect(queue, &HueCommandQueue::commandReady, [&commands](const HueCommand &command) { commands.append(command); });
+
+    // writes of the same event loop iteration end up in one command, the later value wins
+    QList<ActionId> actionIds;
+    actionIds << ActionId::createActionId() << ActionId::createActionId() << ActionId::createActionId();
+    queue->enqueue(1, createState("on", true), actionIds.at(0));
+    queue->enqueue(1, createState("bri", 100), actionIds.at(1));
+    queue->enqueue(1, createState("bri", 150), actionIds.at(2));
+    QCOMPARE(queue->pendingCount(), 1);
+
+    QTRY_COMPARE(commands.count(), 1);
+    QCOMPARE(commands.first().lightIds, QList<int>() << 1);
+    QVERIFY(!commands.first().isGroupCommand());
+    QCOMPARE(commands.first().state.count(), 2);
+    QCOMPARE(commands.first().state.value("on").toBool(), true);
+    QCOMPARE(commands.first().state.value("bri").toInt(), 150);
+    QCOMPARE(commands.first().actionIds, actionIds);
+
+    // a command which has been sent is not changed any more
+    ActionId actionId = ActionId::createActionId();
+    queue->enqueue(1, createState("bri", 10), actionId);
+    QTRY_COMPARE(commands.count(), 2);
+    QCOMPARE(commands.last().state, createState("bri", 10));
+    QCOMPARE(commands.last().actionIds, QList<ActionId>() << actionId);
+}
+
+void TestPhilipsHue::commandOrder()
+{
+    HueBridge bridge;
+    setUpBridge(&bridge);
+    HueCommandQueue *queue = new HueCommandQueue(&bridge);
+    QList<HueCommand> commands;
+    connect(queue, &HueCommandQueue::commandReady, [&commands](const HueCommand &command) { commands.append(command); });
+
+    queue->enqueue(3, createState("on", true), ActionId::createActionId());
+    queue->enqueue(1, createState("bri", 10), ActionId::createActionId());
+    queue->enqueue(2, createState("on", false), ActionId::createActionId());
+
+    // a merged write keeps the position of the first write to that light
+    queue->enqueue(3, createState("bri", 20), ActionId::createActionId());
+    QCOMPARE(queue->pendingCount(), 3);
+
+    // single light commands are paced, so they arrive one by one
+    QTRY_COMPARE(commands.count(), 3);
+
+    QCOMPARE(commands.at(0).lightIds, QList<int>() << 3);
+    QCOMPARE(commands.at(0).state.value("bri").toInt(), 20);
+    QCOMPARE(commands.at(1).lightIds, QList<int>() << 1);
+    QCOMPARE(commands.at(2).lightIds, QList<int>() << 2);
+}
+
+void TestPhilipsHue::groupCommands()
+{
+    HueBridge bridge;
+    setUpBridge(&bridge);
+    HueCommandQueue *queue = new HueCommandQueue(&bridge);
+    QList<HueCommand> commands;
+    connect(queue, &HueCommandQueue::commandReady, [&commands](const HueCommand &command) { commands.append(command); });
+
+    QHash<int, QSet<int> > groups;
+    groups.insert(5, QSet<int>() << 1 << 2);
+    queue->setGroups(groups);
+    queue->setLightIds(QList<int>() << 1 << 2 << 3);
+
+    // lights of a group waiting for the same state are sent as one group command
+    queue->enqueue(1, createState("on", true), ActionId::createActionId());
+    queue->enqueue(3, createState("on", false), ActionId::createActionId());
+    queue->enqueue(2, createState("on", true), ActionId::createActionId());
+
+    QTRY_COMPARE(commands.count(), 2);
+    QCOMPARE(commands.at(0).groupId, 5);
+    QCOMPARE(commands.at(0).lightIds, QList<int>() << 1 << 2);
+    QCOMPARE(commands.at(0).actionIds.count(), 2);
+    QVERIFY(!commands.at(1).isGroupCommand());
+    QCOMPARE(commands.at(1).lightIds, QList<int>() << 3);
+
+    // all lights of the bridge are group 0
+    commands.clear();
+    queue->enqueue(1, createState("bri", 50), ActionId::createActionId());
+    queue->enqueue(2, createState("bri", 50), ActionId::createActionId());
+    queue->enqueue(3, createState("bri", 50), ActionId::createActionId());
+    QTRY_COMPARE(commands.count(), 1);
+    QCOMPARE(commands.first().groupId, 0);
+    QCOMPARE(commands.first().lightIds.count(), 3);
+
+    // lights which are not a group are sent one by one
+    commands.clear();
+    queue->enqueue(1, createState("bri", 60), ActionId::createActionId());
+    queue->enqueue(3, createState("bri", 60), ActionId::createActionId());
+    QTRY_COMPARE(commands.count(), 2);
+    QVERIFY(!commands.at(0).isGroupCommand());
+    QVERIFY(!commands.at(1).isGroupCommand());
+}
+
+void TestPhilipsHue::clearQueue()
+{
+    HueBridge bridge;
+    setUpBridge(&bridge);
+    HueCommandQueue *queue = new HueCommandQueue(&bridge);
+    QList<HueCommand> commands;
+    connect(queue, &HueCommandQueue::commandReady, [&commands](const HueCommand &command) { commands.append(command); });
+
+    QList<ActionId> actionIds;
+    actionIds << ActionId::createActionId() << ActionId::createActionId() << ActionId::createActionId();
+    queue->enqueue(1, createState("on", true), actionIds.at(0));
+    queue->enqueue(1, createState("bri", 1), actionIds.at(1));
+    queue->enqueue(2, createState("on", true), actionIds.at(2));
+
+    // the pending actions are handed back to be finished by the caller
+    QList<ActionId> clearedIds = queue->clear();
+    QCOMPARE(clearedIds.count(), 3);
+    foreach (const ActionId &actionId, actionIds)
+        QVERIFY(clearedIds.contains(actionId));
+
+    QCOMPARE(queue->pendingCount(), 0);
+    QTest::qWait(200);
+    QVERIFY(commands.isEmpty());
+}
+
+void TestPhilipsHue::createRequest()
+{
+    HueBridge bridge;
+    setUpBridge(&bridge);
+    HueCommandQueue *queue = new HueCommandQueue(&bridge);
+
+    HueCommand command;
+    command.lightIds << 3;
+    QCOMPARE(queue->createRequest(command).url(), QUrl("http://10.0.0.5/api/apikey/lights/3/state"));
+
+    command.groupId = 5;
+    command.lightIds << 4;
+    QCOMPARE(queue->createRequest(command).url(), QUrl("http://10.0.0.5/api/apikey/groups/5/action"));
+}
+
+void TestPhilipsHue::parseSnapshot()
+{
+    HueSnapshot snapshot = HueSnapshot::fromJson(bridgeResponse);
+    QCOMPARE(snapshot.error(), HueSnapshot::NoError);
+
+    QCOMPARE(snapshot.config().value("apiversion").toString(), QString("1.16.0"));
+    QCOMPARE(snapshot.config().value("swupdate").toObject().value("updatestate").toInt(), 2);
+
+    QHash<int, QJsonObject> lightStates = snapshot.lightStates();
+    QCOMPARE(lightStates.count(), 2);
+    QCOMPARE(lightStates.value(1).value("bri").toInt(), 254);
+    QCOMPARE(lightStates.value(1).value("colormode").toString(), QString("ct"));
+    QCOMPARE(lightStates.value(2).value("on").toBool(), false);
+    QVERIFY(!lightStates.value(2).contains("name"));
+
+    QHash<int, QSet<int> > groups = snapshot.groups();
+    QCOMPARE(groups.count(), 2);
+    QCOMPARE(groups.value(1), QSet<int>() << 1 << 2);
+    QVERIFY(groups.contains(2));
+    QVERIFY(groups.value(2).isEmpty());
+
+    QHash<int, QJsonObject> sensors = snapshot.sensors();
+    QCOMPARE(sensors.count(), 1);
+    QCOMPARE(sensors.value(4).value("state").toObject().value("buttonevent").toInt(), 1002);
+    QCOMPARE(sensors.value(4).value("config").toObject().value("battery").toInt(), 100);
+}
+
+void TestPhilipsHue::parseSnapshotErrors_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("error");
+    QTest::addColumn<QString>("errorString");
+
+    QTest::newRow("unauthorized") << QByteArray("[{\"error\": {\"type\": 1, \"address\": \"/\", \"description\": \"unauthorized user\"}}]")
+                                  << (int)HueSnapshot::BridgeError << QString("unauthorized user");
+    QTest::newRow("empty error") << QByteArray("[]") << (int)HueSnapshot::BridgeError << QString("Invalid error message format");
+    QTest::newRow("truncated") << QByteArray("{\"config\": {") << (int)HueSnapshot::ParseError << QString();
+}
+
+void TestPhilipsHue::parseSnapshotErrors()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, error);
+    QFETCH(QString, errorString);
+
+    HueSnapshot snapshot = HueSnapshot::fromJson(data);
+    QCOMPARE((int)snapshot.error(), error);
+    QVERIFY(!snapshot.errorString().isEmpty());
+    if (!errorString.isEmpty())
+        QCOMPARE(snapshot.errorString(), errorString);
+
+    QVERIFY(snapshot.lightStates().isEmpty());
+    QVERIFY(snapshot.groups().isEmpty());
+}
+
+void TestPhilipsHue::applySnapshot()
+{
+    HueSnapshot snapshot = HueSnapshot::fromJson(bridgeResponse);
+    QJsonObject stateObject = snapshot.lightStates().value(1);
+
+    HueLight light;
+    light.setId(1);
+
+    // the first snapshot always changes the light
+    QVERIFY(light.updateSnapshot(stateObject));
+    light.updateStates(stateObject.toVariantMap());
+    QCOMPARE(light.power(), true);
+    QCOMPARE((int)light.brightness(), 254);
+    QCOMPARE((int)light.ct(), 366);
+    QCOMPARE(light.colorMode(), HueLight::ColorModeCT);
+    QVERIFY(light.reachable());
+
+    // the same state again is no change, another one is
+    QVERIFY(!light.updateSnapshot(HueSnapshot::fromJson(bridgeResponse).lightStates().value(1)));
+    stateObject.insert("bri", 100);
+    QVERIFY(light.updateSnapshot(stateObject));
+
+    // after clearing, the next snapshot updates all states again
+    light.clearSnapshot();
+    QVERIFY(light.updateSnapshot(stateObject));
+}
+
+#include "testphilipshue.moc"
+QTEST_MAIN(TestPhilipsHue)
@@ -0,0 +1,6 @@
+TARGET = testpluginthread
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += testpluginthread.cpp
@@ -0,0 +1,118 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "plugin/pluginthread.h"
+#include "plugin/deviceplugin.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QThread>
+
+class TestPlugin : public DevicePlugin
+{
+public:
+    DeviceManager::HardwareResources requiredHardware() const override { return DeviceManager::HardwareResourceNone; }
+};
+
+class TestPluginThread: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void postInOrder();
+    void callMainThread();
+    void adoptPlugin();
+};
+
+void TestPluginThread::postInOrder()
+{
+    PluginMailbox mailbox;
+    PluginThread thread("test");
+    thread.start();
+
+    QList<int> calls;
+    QThread *worker = 0;
+    for (int i = 0; i < 100; i++) {
+        thread.post([&calls, &worker, i]() {
+            worker = QThread::currentThread();
+            calls.append(i);
+        });
+    }
+    thread.shutdown(&mailbox);
+
+    QCOMPARE(calls.count(), 100);
+    for (int i = 0; i < calls.count(); i++)
+        QCOMPARE(calls.at(i), i);
+
+    QCOMPARE(worker, &thread);
+}
+
+void TestPluginThread::callMainThread()
+{
+    PluginMailbox mailbox;
+    PluginThread thread("test");
+    thread.start();
+
+    QThread *caller = 0;
+    QAtomicInt finished;
+    thread.post([&mailbox, &caller, &finished]() {
+        mailbox.call([&caller]() {
+            caller = QThread::currentThread();
+        });
+        finished.store(1);
+    });
+
+    // The worker waits until the main thread delivers the call
+    QTRY_COMPARE(finished.load(), 1);
+    QCOMPARE(caller, QThread::currentThread());
+
+    // Pending calls of the worker get delivered while shutting down
+    int calls = 0;
+    for (int i = 0; i < 10; i++) {
+        thread.post([&mailbox, &calls]() {
+            mailbox.call([&calls]() { calls++; });
+        });
+    }
+    thread.shutdown(&mailbox);
+    QCOMPARE(calls, 10);
+}
+
+void TestPluginThread::adoptPlugin()
+{
+    PluginMailbox mailbox;
+    PluginThread thread("test");
+    thread.start();
+
+    TestPlugin plugin;
+    QObject *child = new QObject(&plugin);
+    thread.adopt(&plugin);
+    QCOMPARE(thread.plugins().count(), 1);
+    QCOMPARE(plugin.thread(), &thread);
+    QCOMPARE(child->thread(), &thread);
+
+    thread.shutdown(&mailbox);
+    QVERIFY(thread.isFinished());
+    QCOMPARE(plugin.thread(), QThread::currentThread());
+    QCOMPARE(child->thread(), QThread::currentThread());
+    QVERIFY(thread.plugins().isEmpty());
+}
+
+#include "testpluginthread.moc"
+QTEST_MAIN(TestPluginThread)
@@ -0,0 +1,6 @@
+TARGET = testradio433
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += testradio433.cpp
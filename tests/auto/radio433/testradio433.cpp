@@ -0,0 +1,357 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "guhtestbase.h"
+#include "guhcore.h"
+#include "devicemanager.h"
+#include "hardware/radio433/radio433transmitter.h"
+#include "hardware/radio433/radio433receiver.h"
+#include "hardware/radio433/radio433codeword.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Records every value written into a named pipe which acts as fake GPIO value file
+class EdgeRecorder : public QThread
+{
+public:
+    EdgeRecorder(const QString &fileName, int expectedWrites) :
+        m_fileName(fileName),
+        m_expectedWrites(expectedWrites)
+    {
+        // O_RDWR never blocks on a fifo, so the transmitter can open it right away
+        m_fd = open(m_fileName.toLocal8Bit().constData(), O_RDWR);
+    }
+
+    ~EdgeRecorder()
+    {
+        if (m_fd >= 0)
+            close(m_fd);
+    }
+
+    bool isOpen() const { return m_fd >= 0; }
+    QByteArray values() const { return m_values; }
+
+protected:
+    void run() override
+    {
+        while (m_values.count() < m_expectedWrites) {
+            char value;
+            if (read(m_fd, &value, 1) != 1)
+                return;
+
+            m_values.append(value);
+        }
+    }
+
+private:
+    QString m_fileName;
+    int m_expectedWrites;
+    int m_fd;
+    QByteArray m_values;
+};
+
+// Records the edge deadlines of the transmitter instead of waiting for them
+class ScheduleRecorder : public Radio433Trasmitter
+{
+public:
+    ScheduleRecorder() : Radio433Trasmitter(0, 0) { }
+    ~ScheduleRecorder() { wait(); }
+
+    QList<qint64> deadlines() const { return m_deadlines; }
+
+protected:
+    void writeValue(bool high) override { Q_UNUSED(high) }
+    void waitUntil(const struct timespec &deadline) override
+    {
+        m_deadlines.append((qint64)deadline.tv_sec * 1000000 + deadline.tv_nsec / 1000);
+    }
+
+private:
+    QList<qint64> m_deadlines;
+};
+
+using namespace guhserver;
+
+class TestRadio433: public GuhTestBase
+{
+    Q_OBJECT
+
+private:
+    QList<int> elroRawData(const QByteArray &binCode) const;
+    QList<int> elroTimings(const QByteArray &binCode) const;
+    QList<int> conradTimings(const QByteArray &binCode) const;
+
+private slots:
+    void decodeCodeWord_data();
+    void decodeCodeWord();
+
+    void receiveFrames_data();
+    void receiveFrames();
+
+    void routeRadioCodes();
+
+    void transmitEdgeValues_data();
+    void transmitEdgeValues();
+
+    void transmitEdgeSchedule_data();
+    void transmitEdgeSchedule();
+};
+
+QList<int> TestRadio433::elroRawData(const QByteArray &binCode) const
+{
+    QList<int> rawData;
+    rawData << 1 << 31;
+    foreach (char c, binCode) {
+        if (c == '0') {
+            rawData << 1 << 3;
+        } else {
+            rawData << 3 << 1;
+        }
+    }
+    return rawData;
+}
+
+QList<int> TestRadio433::elroTimings(const QByteArray &binCode) const
+{
+    QList<int> timings;
+    timings << 31 * 350;
+    foreach (int timing, elroRawData(binCode).mid(2))
+        timings << timing * 350;
+
+    return timings;
+}
+
+QList<int> TestRadio433::conradTimings(const QByteArray &binCode) const
+{
+    QList<int> timings;
+    timings << 10 * 650;
+    foreach (char c, binCode) {
+        if (c == '0') {
+            timings << 650 << 1300;
+        } else {
+            timings << 1300 << 650;
+        }
+    }
+    return timings;
+}
+
+void TestRadio433::decodeCodeWord_data()
+{
+    QTest::addColumn<QList<int> >("rawData");
+    QTest::addColumn<int>("protocol");
+    QTest::addColumn<QByteArray>("binCode");
+
+    QByteArray elroCode("000100010101000101010001");
+    QByteArray conradCode("01010011001100110011001100110011");
+
+    QList<int> brokenTimings = elroTimings(elroCode);
+    brokenTimings[5] = 350;
+
+    QTest::newRow("Tristate48") << elroTimings(elroCode) << (int)Radio433CodeWord::ProtocolTristate48 << elroCode;
+    QTest::newRow("Pwm64") << conradTimings(conradCode) << (int)Radio433CodeWord::ProtocolPwm64 << conradCode;
+    QTest::newRow("invalid symbol") << brokenTimings << (int)Radio433CodeWord::ProtocolNone << QByteArray();
+    QTest::newRow("invalid length") << elroTimings(elroCode).mid(1) << (int)Radio433CodeWord::ProtocolNone << QByteArray();
+}
+
+void TestRadio433::decodeCodeWord()
+{
+    QFETCH(QList<int>, rawData);
+    QFETCH(int, protocol);
+    QFETCH(QByteArray, binCode);
+
+    Radio433CodeWord codeWord = Radio433CodeWord::decode(rawData);
+    QCOMPARE((int)codeWord.protocol(), protocol);
+    QCOMPARE(codeWord.binCode(), binCode);
+    QCOMPARE(codeWord.bitCount(), binCode.length());
+    if (codeWord.isValid())
+        QCOMPARE(codeWord.value(), binCode.toULongLong(0, 2));
+}
+
+void TestRadio433::receiveFrames_data()
+{
+    QTest::addColumn<QList<int> >("timings");
+    QTest::addColumn<QList<QList<int> > >("frames");
+
+    QList<int> elroFrame = elroTimings("000100010101000101010001");
+    QList<int> conradFrame = conradTimings("01010011001100110011001100110011");
+
+    // the high pulse in front of the sync and the gap after a frame are no part of it
+    QList<int> elro;
+    elro << 350 << elroFrame << 350;
+
+    QList<int> interrupted;
+    interrupted << elroFrame.mid(0, 20) << 30 << elroFrame.mid(20);
+
+    QList<int> restarted;
+    restarted << elroFrame.mid(0, 20) << conradFrame;
+
+    QList<int> repeated;
+    repeated << elroFrame << elroFrame;
+
+    QTest::newRow("Tristate48") << elro << (QList<QList<int> >() << elroFrame);
+    QTest::newRow("Pwm64") << conradFrame << (QList<QList<int> >() << conradFrame);
+    QTest::newRow("no sync") << elroFrame.mid(1) << QList<QList<int> >();
+    QTest::newRow("noise") << interrupted << QList<QList<int> >();
+    QTest::newRow("sync restarts frame") << restarted << (QList<QList<int> >() << conradFrame);
+    QTest::newRow("repetitions") << repeated << (QList<QList<int> >() << elroFrame << elroFrame);
+}
+
+void TestRadio433::receiveFrames()
+{
+    QFETCH(QList<int>, timings);
+    QFETCH(QList<QList<int> >, frames);
+
+    Radio433Receiver receiver(0, 0);
+    QSignalSpy spy(&receiver, &Radio433Receiver::dataReceived);
+
+    foreach (int timing, timings)
+        receiver.processTiming(timing);
+
+    QCOMPARE(spy.count(), frames.count());
+    for (int i = 0; i < frames.count(); i++)
+        QCOMPARE(spy.at(i).first().value<QList<int> >(), frames.at(i));
+}
+
+void TestRadio433::routeRadioCodes()
+{
+    DevicePlugin *mockPlugin = 0;
+    foreach (DevicePlugin *plugin, GuhCore::instance()->deviceManager()->plugins()) {
+        if (plugin->pluginId() == mockPluginId)
+            mockPlugin = plugin;
+    }
+    QVERIFY(mockPlugin);
+
+    // the mock plugin has configured devices and only subscribed to Tristate48 codes
+    QSignalSpy spy(mockPlugin, SIGNAL(radioCodeHandled(QByteArray)));
+
+    Radio433Receiver receiver(0, 0);
+    connect(&receiver, SIGNAL(dataReceived(QList<int>)), GuhCore::instance()->deviceManager(), SLOT(radio433SignalReceived(QList<int>)));
+
+    QByteArray elroCode("000100010101000101010001");
+    foreach (int timing, conradTimings("01010011001100110011001100110011") + elroTimings(elroCode))
+        receiver.processTiming(timing);
+
+    // plugin calls might be dispatched to a worker thread
+    if (spy.isEmpty())
+        spy.wait();
+
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.first().first().toByteArray(), elroCode);
+
+    // the Pwm64 code must not show up late either
+    QTest::qWait(200);
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestRadio433::transmitEdgeValues_data()
+{
+    QTest::addColumn<int>("repetitions");
+
+    QTest::newRow("single") << 1;
+    QTest::newRow("repeated") << 3;
+}
+
+void TestRadio433::transmitEdgeValues()
+{
+    QFETCH(int, repetitions);
+
+    QTemporaryDir gpioDirectory;
+    QVERIFY(gpioDirectory.isValid());
+
+    QString valueFileName = gpioDirectory.path() + "/value";
+    QVERIFY(mkfifo(valueFileName.toLocal8Bit().constData(), 0600) == 0);
+
+    QByteArray binCode("000100010101000101010001");
+    QList<int> rawData = elroRawData(binCode);
+
+    // initial low + one write per edge of each repetition + final low
+    int expectedWrites = repetitions * rawData.count() + 2;
+
+    EdgeRecorder recorder(valueFileName, expectedWrites);
+    QVERIFY(recorder.isOpen());
+    recorder.start();
+
+    Radio433Trasmitter transmitter(0, 0);
+    QVERIFY(transmitter.startTransmitter(valueFileName));
+    transmitter.sendData(350, rawData, repetitions);
+
+    QVERIFY(recorder.wait(10000));
+    QVERIFY(transmitter.wait(10000));
+
+    // the edges have to toggle, starting with high in every repetition
+    QByteArray values = recorder.values();
+    QCOMPARE(values.count(), expectedWrites);
+    QCOMPARE(values.at(0), '0');
+    for (int i = 0; i < repetitions * rawData.count(); i++)
+        QCOMPARE(values.at(1 + i), i % 2 == 0 ? '1' : '0');
+    QCOMPARE(values.at(expectedWrites - 1), '0');
+}
+
+void TestRadio433::transmitEdgeSchedule_data()
+{
+    QTest::addColumn<int>("repetitions");
+
+    QTest::newRow("single") << 1;
+    QTest::newRow("repeated") << 3;
+}
+
+void TestRadio433::transmitEdgeSchedule()
+{
+    QFETCH(int, repetitions);
+
+    int delay = 350;
+    QByteArray binCode("000100010101000101010001");
+    QList<int> rawData = elroRawData(binCode);
+
+    ScheduleRecorder transmitter;
+    QVERIFY(transmitter.startTransmitter("/dev/null"));
+    transmitter.sendData(delay, rawData, repetitions);
+    QVERIFY(transmitter.wait(10000));
+
+    // every edge waits for its own absolute deadline
+    QList<qint64> deadlines = transmitter.deadlines();
+    QCOMPARE(deadlines.count(), repetitions * rawData.count());
+
+    // the durations between the deadlines are exactly the timings, they don't depend on when the edges got written
+    QList<int> durations;
+    for (int i = 1; i < deadlines.count(); i++)
+        durations.append(deadlines.at(i) - deadlines.at(i - 1));
+
+    for (int i = 0; i < durations.count(); i++)
+        QCOMPARE(durations.at(i), rawData.at((i + 1) % rawData.count()) * delay);
+
+    // each repetition has to be decodable again
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        QList<int> frame = durations.mid(repetition * rawData.count(), rawData.count() - 1);
+        Radio433CodeWord codeWord = Radio433CodeWord::decode(frame);
+        QCOMPARE(codeWord.protocol(), Radio433CodeWord::ProtocolTristate48);
+        QCOMPARE(codeWord.binCode(), binCode);
+    }
+}
+
+#include "testradio433.moc"
+QTEST_MAIN(TestRadio433)
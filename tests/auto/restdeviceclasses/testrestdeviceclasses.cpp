@@ -43,6 +43,7 @@ class TestRestDeviceClasses: public GuhTestBase
 
 private slots:
     void getSupportedDevices();
+    void getSupportedDevicesNotModified();
 
     void invalidMethod();
 
@@ -99,6 +100,49 @@ void TestRestDeviceClasses::getSupportedDevices()
     QCOMPARE(JsonTypes::deviceErrorToString(DeviceManager::DeviceErrorVendorNotFound), response.toMap().value("error").toString());
 }
 
+void TestRestDeviceClasses::getSupportedDevicesNotModified()
+{
+    QNetworkAccessManager nam;
+    QSignalSpy clientSpy(&nam, SIGNAL(finished(QNetworkReply*)));
+
+    QNetworkRequest request(QUrl("http://localhost:3333/api/v1/deviceclasses"));
+    QNetworkReply *reply = nam.get(request);
+    clientSpy.wait();
+    QCOMPARE(clientSpy.count(), 1);
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QByteArray etag = reply->rawHeader("ETag");
+    QVERIFY2(!etag.isEmpty(), "Missing ETag header");
+    QVERIFY(!reply->readAll().isEmpty());
+    reply->deleteLater();
+
+    // the client already has this catalog
+    clientSpy.clear();
+    request.setRawHeader("If-None-Match", etag);
+    reply = nam.get(request);
+    clientSpy.wait();
+    QCOMPARE(clientSpy.count(), 1);
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 304);
+    QCOMPARE(reply->rawHeader("ETag"), etag);
+    QVERIFY(reply->readAll().isEmpty());
+    reply->deleteLater();
+
+    // header names are case insensitive
+    clientSpy.clear();
+    QNetworkRequest lowerCaseRequest(QUrl("http://localhost:3333/api/v1/deviceclasses"));
+    lowerCaseRequest.setRawHeader("if-none-match", etag);
+    reply = nam.get(lowerCaseRequest);
+    clientSpy.wait();
+    QCOMPARE(clientSpy.count(), 1);
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 304);
+    reply->deleteLater();
+
+    // JSON-RPC and REST share the snapshot
+    QVariantMap params;
+    params.insert("etag", QString(etag).remove('"'));
+    QVariantMap response = injectAndWait("Devices.GetSupportedDevices", params).toMap().value("params").toMap();
+    QVERIFY(!response.contains("deviceClasses"));
+}
+
 void TestRestDeviceClasses::invalidMethod()
 {
     QNetworkAccessManager nam;
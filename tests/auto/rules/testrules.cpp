@@ -90,6 +90,10 @@ private slots:
 
     void testRuleActionParams_data();
     void testRuleActionParams();
+
+    void simulateStateChange();
+
+    void getChangesSince();
 };
 
 void TestRules::cleanupMockHistory() {
@@ -1814,5 +1818,177 @@ void TestRules::testRuleActionParams()
     verifyRuleError(response, error);
 }
 
+void TestRules::simulateStateChange()
+{
+    // Start below the threshold of the rule
+    QNetworkAccessManager nam;
+    QSignalSpy spy(&nam, SIGNAL(finished(QNetworkReply*)));
+    QNetworkRequest request(QUrl(QString("http://localhost:%1/setstate?%2=%3").arg(m_mockDevice1Port).arg(mockIntStateId.toString()).arg(30)));
+    QNetworkReply *reply = nam.get(request);
+    spy.wait();
+    QCOMPARE(spy.count(), 1);
+    reply->deleteLater();
+
+    QVariantMap stateDescriptor;
+    stateDescriptor.insert("deviceId", m_mockDeviceId);
+    stateDescriptor.insert("operator", JsonTypes::valueOperatorToString(Types::ValueOperatorGreaterOrEqual));
+    stateDescriptor.insert("stateTypeId", mockIntStateId);
+    stateDescriptor.insert("value", 42);
+    QVariantMap stateEvaluator;
+    stateEvaluator.insert("stateDescriptor", stateDescriptor);
+
+    QVariantMap action;
+    action.insert("actionTypeId", mockActionIdNoParams);
+    action.insert("deviceId", m_mockDeviceId);
+
+    QVariantMap addRuleParams;
+    addRuleParams.insert("name", "TestRule");
+    addRuleParams.insert("stateEvaluator", stateEvaluator);
+    addRuleParams.insert("actions", QVariantList() << action);
+    QVariant response = injectAndWait("Rules.AddRule", addRuleParams);
+    verifyRuleError(response);
+    RuleId ruleId = RuleId(response.toMap().value("params").toMap().value("ruleId").toString());
+
+    // Either an event or a state is required
+    response = injectAndWait("Rules.Simulate");
+    verifyRuleError(response, RuleEngine::RuleErrorInvalidParameter);
+
+    // A state change below the threshold does not change anything
+    QVariantMap state;
+    state.insert("deviceId", m_mockDeviceId);
+    state.insert("stateTypeId", mockIntStateId);
+    state.insert("value", 40);
+    QVariantMap params;
+    params.insert("state", state);
+    response = injectAndWait("Rules.Simulate", params);
+    verifyRuleError(response);
+    QCOMPARE(response.toMap().value("params").toMap().value("simulatedRules").toList().count(), 0);
+
+    // A state change above the threshold would activate the rule, but must not execute anything
+    state.insert("value", 50);
+    params.insert("state", state);
+    response = injectAndWait("Rules.Simulate", params);
+    verifyRuleError(response);
+    QVariantList simulatedRules = response.toMap().value("params").toMap().value("simulatedRules").toList();
+    QCOMPARE(simulatedRules.count(), 1);
+    QVariantMap simulatedRule = simulatedRules.first().toMap();
+    QCOMPARE(RuleId(simulatedRule.value("ruleId").toString()), ruleId);
+    QCOMPARE(simulatedRule.value("active").toBool(), true);
+    QCOMPARE(simulatedRule.value("actions").toList().count(), 1);
+    QCOMPARE(ActionTypeId(simulatedRule.value("actions").toList().first().toMap().value("actionTypeId").toString()), mockActionIdNoParams);
+
+    verifyRuleNotExecuted();
+
+    params.clear();
+    params.insert("ruleId", ruleId);
+    response = injectAndWait("Rules.GetRuleDetails", params);
+    QCOMPARE(response.toMap().value("params").toMap().value("rule").toMap().value("active").toBool(), false);
+
+    // The real state change has to produce the simulated result and count in the statistics
+    spy.clear();
+    request.setUrl(QUrl(QString("http://localhost:%1/setstate?%2=%3").arg(m_mockDevice1Port).arg(mockIntStateId.toString()).arg(50)));
+    reply = nam.get(request);
+    spy.wait();
+    QCOMPARE(spy.count(), 1);
+    reply->deleteLater();
+
+    verifyRuleExecuted(mockActionIdNoParams);
+
+    response = injectAndWait("Rules.GetRuleStatistics", params);
+    verifyRuleError(response);
+    QVariantList ruleStatistics = response.toMap().value("params").toMap().value("ruleStatistics").toList();
+    QCOMPARE(ruleStatistics.count(), 1);
+    QVariantMap statistics = ruleStatistics.first().toMap();
+    QCOMPARE(RuleId(statistics.value("ruleId").toString()), ruleId);
+    QVERIFY(statistics.value("evaluations").toInt() >= 1);
+    QVERIFY(statistics.value("matches").toInt() >= 1);
+    QCOMPARE(statistics.value("activations").toInt(), 1);
+    QCOMPARE(statistics.value("actions").toInt(), 1);
+
+    params.insert("ruleId", RuleId::createRuleId());
+    response = injectAndWait("Rules.GetRuleStatistics", params);
+    verifyRuleError(response, RuleEngine::RuleErrorRuleNotFound);
+}
+
+void TestRules::getChangesSince()
+{
+    // an unknown sequence requires a complete synchronisation
+    QVariantMap params;
+    params.insert("sequence", 0);
+    QVariantMap response = injectAndWait("Rules.GetChangesSince", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("resyncRequired").toBool(), true);
+    QVERIFY(response.value("ruleDescriptions").toList().isEmpty());
+    qint64 sequence = response.value("sequence").toLongLong();
+
+    // add two rules
+    QVariantMap action;
+    action.insert("actionTypeId", mockActionIdNoParams);
+    action.insert("deviceId", m_mockDeviceId);
+
+    QList<RuleId> ruleIds;
+    for (int i = 0; i < 2; i++) {
+        QVariantMap addRuleParams;
+        addRuleParams.insert("name", QString("Journal rule %1").arg(i));
+        addRuleParams.insert("eventDescriptors", QVariantList() << createEventDescriptor(m_mockDeviceId, mockEvent1Id));
+        addRuleParams.insert("actions", QVariantList() << action);
+        QVariant addResponse = injectAndWait("Rules.AddRule", addRuleParams);
+        verifyRuleError(addResponse);
+        ruleIds.append(RuleId(addResponse.toMap().value("params").toMap().value("ruleId").toString()));
+    }
+
+    params.insert("sequence", sequence);
+    response = injectAndWait("Rules.GetChangesSince", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("resyncRequired").toBool(), false);
+    QVERIFY(response.value("sequence").toLongLong() > sequence);
+    QVariantList ruleDescriptions = response.value("ruleDescriptions").toList();
+    QCOMPARE(ruleDescriptions.count(), 2);
+    QCOMPARE(RuleId(ruleDescriptions.at(0).toMap().value("id").toString()), ruleIds.at(0));
+    QCOMPARE(RuleId(ruleDescriptions.at(1).toMap().value("id").toString()), ruleIds.at(1));
+    QVERIFY(response.value("removedRuleIds").toList().isEmpty());
+    sequence = response.value("sequence").toLongLong();
+
+    // disable the first and remove the second rule
+    QVariantMap ruleParams;
+    ruleParams.insert("ruleId", ruleIds.at(0));
+    verifyRuleError(injectAndWait("Rules.DisableRule", ruleParams));
+    ruleParams.insert("ruleId", ruleIds.at(1));
+    verifyRuleError(injectAndWait("Rules.RemoveRule", ruleParams));
+
+    params.insert("sequence", sequence);
+    response = injectAndWait("Rules.GetChangesSince", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("resyncRequired").toBool(), false);
+    ruleDescriptions = response.value("ruleDescriptions").toList();
+    QCOMPARE(ruleDescriptions.count(), 1);
+    QCOMPARE(RuleId(ruleDescriptions.first().toMap().value("id").toString()), ruleIds.at(0));
+    QCOMPARE(ruleDescriptions.first().toMap().value("enabled").toBool(), false);
+    QVariantList removedRuleIds = response.value("removedRuleIds").toList();
+    QCOMPARE(removedRuleIds.count(), 1);
+    QCOMPARE(RuleId(removedRuleIds.first().toString()), ruleIds.at(1));
+    sequence = response.value("sequence").toLongLong();
+
+    // nothing changed since the last call
+    params.insert("sequence", sequence);
+    response = injectAndWait("Rules.GetChangesSince", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("resyncRequired").toBool(), false);
+    QVERIFY(response.value("ruleDescriptions").toList().isEmpty());
+    QVERIFY(response.value("removedRuleIds").toList().isEmpty());
+
+    // a sequence of the device journal belongs to another instance
+    QVariantMap deviceParams;
+    deviceParams.insert("sequence", 0);
+    qint64 deviceSequence = injectAndWait("Devices.GetChangesSince", deviceParams).toMap().value("params").toMap().value("sequence").toLongLong();
+    params.insert("sequence", deviceSequence);
+    response = injectAndWait("Rules.GetChangesSince", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("resyncRequired").toBool(), true);
+    QCOMPARE(response.value("ruleDescriptions").toList().count(), 1);
+
+    // so is a sequence from before the restart
+    restartServer();
+    params.insert("sequence", sequence);
+    response = injectAndWait("Rules.GetChangesSince", params).toMap().value("params").toMap();
+    QCOMPARE(response.value("resyncRequired").toBool(), true);
+    QCOMPARE(response.value("ruleDescriptions").toList().count(), 1);
+}
+
 #include "testrules.moc"
 QTEST_MAIN(TestRules)
@@ -0,0 +1,6 @@
+TARGET = teststartup
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += teststartup.cpp
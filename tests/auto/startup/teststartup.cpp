@@ -0,0 +1,122 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "guhtestbase.h"
+#include "guhcore.h"
+#include "devicemanager.h"
+#include "startupprofiler.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QNetworkRequest>
+
+using namespace guhserver;
+
+class TestStartup: public GuhTestBase
+{
+    Q_OBJECT
+
+private:
+    // Boot budget with the mock plugin and the synthetic devices
+    static const int s_deviceCount = 20;
+    static const int s_bootBudget = 5000;
+
+private slots:
+    void bootBudget();
+    void getStartupProfile();
+
+};
+
+void TestStartup::bootBudget()
+{
+    QList<DeviceId> deviceIds;
+    for (int i = 0; i < s_deviceCount; i++) {
+        QVariantList deviceParams;
+        QVariantMap httpportParam;
+        httpportParam.insert("paramTypeId", httpportParamTypeId);
+        httpportParam.insert("value", 7100 + i);
+        deviceParams.append(httpportParam);
+
+        QVariantMap params;
+        params.insert("deviceClassId", mockDeviceClassId);
+        params.insert("name", QString("Synthetic mock device %1").arg(i));
+        params.insert("deviceParams", deviceParams);
+
+        QVariant response = injectAndWait("Devices.AddConfiguredDevice", params);
+        verifyDeviceError(response);
+        deviceIds.append(DeviceId(response.toMap().value("params").toMap().value("deviceId").toString()));
+    }
+
+    restartServer();
+    QTRY_VERIFY(StartupProfiler::isFinished());
+
+    // the report tells where the time went, it is only of interest if the budget was exceeded
+    QVERIFY2(StartupProfiler::bootTime() < s_bootBudget, QString("Startup took %1 ms, the budget is %2 ms\n%3")
+             .arg(StartupProfiler::bootTime()).arg(s_bootBudget).arg(StartupProfiler::report().join("\n")).toLatin1().data());
+
+    foreach (const DeviceId &deviceId, deviceIds) {
+        QVariantMap params;
+        params.insert("deviceId", deviceId);
+        verifyDeviceError(injectAndWait("Devices.RemoveConfiguredDevice", params));
+    }
+}
+
+void TestStartup::getStartupProfile()
+{
+    QTRY_VERIFY(StartupProfiler::isFinished());
+
+    QVariantMap profile = injectAndWait("JSONRPC.GetStartupProfile").toMap().value("params").toMap();
+    QVERIFY(profile.value("finished").toBool());
+    QCOMPARE(profile.value("bootTime").toLongLong(), StartupProfiler::bootTime());
+
+    QStringList topLevelPhases;
+    bool mockDevicesSetup = false;
+    foreach (const QVariant &phaseVariant, profile.value("phases").toList()) {
+        QVariantMap phase = phaseVariant.toMap();
+        QVERIFY(phase.value("duration").toLongLong() >= 0);
+        QVERIFY(phase.value("start").toLongLong() + phase.value("duration").toLongLong() <= StartupProfiler::bootTime());
+        if (!phase.contains("parent"))
+            topLevelPhases.append(phase.value("name").toString());
+
+        if (phase.value("parent").toString() == "Setup devices" && phase.value("name").toString() == "Mock Devices")
+            mockDevicesSetup = true;
+    }
+    QVERIFY(topLevelPhases.contains("Log engine"));
+    QVERIFY(topLevelPhases.contains("Device manager"));
+    QVERIFY(topLevelPhases.contains("Load plugins"));
+    QVERIFY(topLevelPhases.contains("Setup devices"));
+    QVERIFY(mockDevicesSetup);
+
+    // The critical path covers the whole startup without gaps
+    qint64 end = 0;
+    foreach (const QVariant &phaseVariant, profile.value("criticalPath").toList()) {
+        QVariantMap phase = phaseVariant.toMap();
+        QCOMPARE(phase.value("start").toLongLong(), end);
+        end = phase.value("start").toLongLong() + phase.value("duration").toLongLong();
+    }
+    QCOMPARE(end, StartupProfiler::bootTime());
+
+    QVariantMap restProfile = getAndWait(QNetworkRequest(QUrl("http://localhost:3333/api/v1/system/startup"))).toMap();
+    QCOMPARE(restProfile.value("bootTime").toLongLong(), StartupProfiler::bootTime());
+    QCOMPARE(restProfile.value("criticalPath").toList().count(), profile.value("criticalPath").toList().count());
+}
+
+#include "teststartup.moc"
+QTEST_MAIN(TestStartup)
@@ -0,0 +1,238 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "guhtestbase.h"
+#include "guhcore.h"
+#include "devicemanager.h"
+#include "mocktcpserver.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QJsonDocument>
+
+using namespace guhserver;
+
+// The threaded mock plugin runs on the worker thread "mock"
+DeviceClassId threadedDeviceClassId = DeviceClassId("72cb1038-d893-4624-84bc-d915a1f8e5f9");
+ParamTypeId threadedAsyncParamTypeId = ParamTypeId("eea0ef5d-f078-4794-8fa8-b30c9e3f73b3");
+StateTypeId threadedValueStateTypeId = StateTypeId("de0a7230-408d-4ccd-abee-8c7cf9595449");
+StateTypeId threadedPostSetupStateTypeId = StateTypeId("f04abcf7-0c82-4f77-854c-90cd30190f0b");
+StateTypeId threadedWorkerThreadStateTypeId = StateTypeId("e4e24d95-f4e5-4b53-b2b2-5d69a3855108");
+ActionTypeId threadedSyncActionTypeId = ActionTypeId("24d67c0c-1b4f-43cc-8596-9d1505267f21");
+ActionTypeId threadedAsyncActionTypeId = ActionTypeId("85a82f9e-7ba6-4634-a151-1ccf718bfcd2");
+ActionTypeId threadedFailingActionTypeId = ActionTypeId("e9d92b47-9ea9-48ab-a038-36be6abd23fa");
+
+class TestThreadedPlugins: public GuhTestBase
+{
+    Q_OBJECT
+
+private:
+    DeviceId addThreadedDevice(bool async);
+    void removeDevice(const DeviceId &deviceId);
+    QVariant stateValue(const DeviceId &deviceId, const StateTypeId &stateTypeId);
+    bool configuredDevicesContain(const DeviceId &deviceId);
+
+private slots:
+    void setupDevice_data();
+    void setupDevice();
+
+    void executeAction_data();
+    void executeAction();
+
+    void setStateValue();
+
+    void removeDeviceWhileSetupPending();
+
+    void shutdownWithPendingAction();
+};
+
+DeviceId TestThreadedPlugins::addThreadedDevice(bool async)
+{
+    QVariantMap asyncParam;
+    asyncParam.insert("paramTypeId", threadedAsyncParamTypeId);
+    asyncParam.insert("value", async);
+
+    QVariantMap params;
+    params.insert("deviceClassId", threadedDeviceClassId);
+    params.insert("name", "Threaded mock device");
+    params.insert("deviceParams", QVariantList() << asyncParam);
+
+    QVariant response = injectAndWait("Devices.AddConfiguredDevice", params);
+    if (response.toMap().value("params").toMap().value("deviceError").toString() != JsonTypes::deviceErrorToString(DeviceManager::DeviceErrorNoError))
+        return DeviceId();
+
+    return DeviceId(response.toMap().value("params").toMap().value("deviceId").toString());
+}
+
+void TestThreadedPlugins::removeDevice(const DeviceId &deviceId)
+{
+    QVariantMap params;
+    params.insert("deviceId", deviceId);
+    QVariant response = injectAndWait("Devices.RemoveConfiguredDevice", params);
+    verifyDeviceError(response);
+}
+
+QVariant TestThreadedPlugins::stateValue(const DeviceId &deviceId, const StateTypeId &stateTypeId)
+{
+    QVariantMap params;
+    params.insert("deviceId", deviceId);
+    params.insert("stateTypeId", stateTypeId);
+    QVariant response = injectAndWait("Devices.GetStateValue", params);
+    return response.toMap().value("params").toMap().value("value");
+}
+
+bool TestThreadedPlugins::configuredDevicesContain(const DeviceId &deviceId)
+{
+    QVariant response = injectAndWait("Devices.GetConfiguredDevices");
+    foreach (const QVariant &device, response.toMap().value("params").toMap().value("devices").toList()) {
+        if (DeviceId(device.toMap().value("id").toString()) == deviceId)
+            return true;
+    }
+    return false;
+}
+
+void TestThreadedPlugins::setupDevice_data()
+{
+    QTest::addColumn<bool>("async");
+
+    QTest::newRow("sync setup") << false;
+    QTest::newRow("async setup") << true;
+}
+
+void TestThreadedPlugins::setupDevice()
+{
+    QFETCH(bool, async);
+
+    // a synchronous result of the plugin gets re-emitted, so both have to be reported the same way
+    DeviceId deviceId = addThreadedDevice(async);
+    QVERIFY2(!deviceId.isNull(), "Could not add threaded mock device");
+
+    QCOMPARE(stateValue(deviceId, threadedWorkerThreadStateTypeId).toBool(), true);
+
+    // postSetupDevice follows the setup on the worker thread
+    QTRY_COMPARE(stateValue(deviceId, threadedPostSetupStateTypeId).toBool(), true);
+
+    removeDevice(deviceId);
+    QVERIFY(!configuredDevicesContain(deviceId));
+}
+
+void TestThreadedPlugins::executeAction_data()
+{
+    QTest::addColumn<ActionTypeId>("actionTypeId");
+    QTest::addColumn<DeviceManager::DeviceError>("error");
+
+    QTest::newRow("sync action") << threadedSyncActionTypeId << DeviceManager::DeviceErrorNoError;
+    QTest::newRow("async action") << threadedAsyncActionTypeId << DeviceManager::DeviceErrorNoError;
+    QTest::newRow("failing action") << threadedFailingActionTypeId << DeviceManager::DeviceErrorSetupFailed;
+}
+
+void TestThreadedPlugins::executeAction()
+{
+    QFETCH(ActionTypeId, actionTypeId);
+    QFETCH(DeviceManager::DeviceError, error);
+
+    DeviceId deviceId = addThreadedDevice(false);
+    QVERIFY(!deviceId.isNull());
+
+    QVariantMap params;
+    params.insert("deviceId", deviceId);
+    params.insert("actionTypeId", actionTypeId);
+    QVariant response = injectAndWait("Actions.ExecuteAction", params);
+    verifyDeviceError(response, error);
+
+    removeDevice(deviceId);
+}
+
+void TestThreadedPlugins::setStateValue()
+{
+    DeviceId deviceId = addThreadedDevice(false);
+    QVERIFY(!deviceId.isNull());
+
+    QVariantMap valueParam;
+    valueParam.insert("paramTypeId", threadedValueStateTypeId);
+    valueParam.insert("value", 42);
+
+    QVariantMap params;
+    params.insert("deviceId", deviceId);
+    params.insert("actionTypeId", threadedValueStateTypeId);
+    params.insert("params", QVariantList() << valueParam);
+    QVariant response = injectAndWait("Actions.ExecuteAction", params);
+    verifyDeviceError(response);
+
+    // the state changes on the worker thread and gets delivered queued
+    QTRY_COMPARE(stateValue(deviceId, threadedValueStateTypeId).toInt(), 42);
+
+    removeDevice(deviceId);
+}
+
+void TestThreadedPlugins::removeDeviceWhileSetupPending()
+{
+    DeviceId deviceId = addThreadedDevice(true);
+    QVERIFY(!deviceId.isNull());
+
+    // after the restart the device is loaded, but its setup is still running on the worker thread
+    restartServer();
+    QVERIFY(configuredDevicesContain(deviceId));
+
+    removeDevice(deviceId);
+    QVERIFY(!configuredDevicesContain(deviceId));
+
+    // the abandoned setup must neither bring the device back nor block the next one
+    QTest::qWait(1000);
+    QVERIFY(!configuredDevicesContain(deviceId));
+
+    DeviceId nextDeviceId = addThreadedDevice(true);
+    QVERIFY(!nextDeviceId.isNull());
+    QTRY_COMPARE(stateValue(nextDeviceId, threadedPostSetupStateTypeId).toBool(), true);
+
+    removeDevice(nextDeviceId);
+}
+
+void TestThreadedPlugins::shutdownWithPendingAction()
+{
+    DeviceId deviceId = addThreadedDevice(false);
+    QVERIFY(!deviceId.isNull());
+
+    // shut down while the worker thread still has an action running
+    QVariantMap params;
+    params.insert("deviceId", deviceId);
+    params.insert("actionTypeId", threadedAsyncActionTypeId);
+
+    QVariantMap call;
+    call.insert("id", 4242);
+    call.insert("method", "Actions.ExecuteAction");
+    call.insert("params", params);
+    m_mockTcpServer->injectData(m_clientId, QJsonDocument::fromVariant(call).toJson());
+
+    restartServer();
+
+    // the plugin moved back and forth between the threads, the device has to work again
+    QVERIFY(configuredDevicesContain(deviceId));
+    QTRY_COMPARE(stateValue(deviceId, threadedWorkerThreadStateTypeId).toBool(), true);
+
+    params.insert("actionTypeId", threadedSyncActionTypeId);
+    QVariant response = injectAndWait("Actions.ExecuteAction", params);
+    verifyDeviceError(response);
+
+    removeDevice(deviceId);
+}
+
+#include "testthreadedplugins.moc"
+QTEST_MAIN(TestThreadedPlugins)
@@ -0,0 +1,6 @@
+TARGET = testthreadedplugins
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += testthreadedplugins.cpp
@@ -0,0 +1,282 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "guhtestbase.h"
+#include "guhcore.h"
+#include "devicemanager.h"
+#include "network/upnp/ssdpmessage.h"
+#include "network/upnp/upnpdescriptorcache.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+using namespace guhserver;
+
+class TestUpnp: public GuhTestBase
+{
+    Q_OBJECT
+
+private slots:
+    void parseSsdpMessage_data();
+    void parseSsdpMessage();
+
+    void maxAge_data();
+    void maxAge();
+
+    void cacheExpiresAfterMaxAge();
+    void cacheExtendedByAlive();
+    void cacheDeduplicatesUsn();
+    void cacheRemovesByeBye();
+
+    void routeNotifications_data();
+    void routeNotifications();
+};
+
+void TestUpnp::parseSsdpMessage_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("type");
+    QTest::addColumn<QByteArray>("usn");
+    QTest::addColumn<QByteArray>("uuid");
+    QTest::addColumn<QString>("location");
+
+    QTest::newRow("response") << QByteArray("HTTP/1.1 200 OK\r\n"
+                                            "CACHE-CONTROL: max-age=100\r\n"
+                                            "EXT:\r\n"
+                                            "LOCATION: http://10.0.0.2:80/description.xml\r\n"
+                                            "SERVER: FreeRTOS/6.0.5, UPnP/1.0, IpBridge/1.10.0\r\n"
+                                            "ST: upnp:rootdevice\r\n"
+                                            "USN: uuid:2f402f80-da50-11e1-9b23-00178817122c::upnp:rootdevice\r\n"
+                                            "\r\n")
+                              << (int)SsdpMessage::TypeResponse
+                              << QByteArray("uuid:2f402f80-da50-11e1-9b23-00178817122c::upnp:rootdevice")
+                              << QByteArray("uuid:2f402f80-da50-11e1-9b23-00178817122c")
+                              << "http://10.0.0.2:80/description.xml";
+
+    QTest::newRow("notify lower case") << QByteArray("NOTIFY * HTTP/1.1\r\n"
+                                                     "host:239.255.255.250:1900\r\n"
+                                                     "location:http://10.0.0.5:49153/setup.xml\r\n"
+                                                     "nt:urn:Belkin:service:basicevent:1\r\n"
+                                                     "nts:ssdp:alive\r\n"
+                                                     "usn:uuid:Socket-1_0-221241K0101769\r\n"
+                                                     "\r\n")
+                                       << (int)SsdpMessage::TypeNotify
+                                       << QByteArray("uuid:Socket-1_0-221241K0101769")
+                                       << QByteArray("uuid:Socket-1_0-221241K0101769")
+                                       << "http://10.0.0.5:49153/setup.xml";
+
+    QTest::newRow("search") << QByteArray("M-SEARCH * HTTP/1.1\r\n"
+                                          "HOST:239.255.255.250:1900\r\n"
+                                          "MAN:\"ssdp:discover\"\r\n"
+                                          "ST: ssdp:all\r\n\r\n")
+                            << (int)SsdpMessage::TypeSearch << QByteArray() << QByteArray() << QString();
+
+    QTest::newRow("invalid") << QByteArray("GET / HTTP/1.1\r\n\r\n")
+                             << (int)SsdpMessage::TypeInvalid << QByteArray() << QByteArray() << QString();
+}
+
+void TestUpnp::parseSsdpMessage()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, type);
+    QFETCH(QByteArray, usn);
+    QFETCH(QByteArray, uuid);
+    QFETCH(QString, location);
+
+    SsdpMessage message = SsdpMessage::parse(data);
+    QCOMPARE((int)message.type(), type);
+    QCOMPARE(message.usn(), usn);
+    QCOMPARE(message.uuid(), uuid);
+    QCOMPARE(message.location().toString(), location);
+}
+
+void TestUpnp::maxAge_data()
+{
+    QTest::addColumn<QByteArray>("cacheControl");
+    QTest::addColumn<int>("maxAge");
+
+    QTest::newRow("max-age") << QByteArray("max-age=100") << 100;
+    QTest::newRow("spaces") << QByteArray("max-age = 1900") << 1900;
+    QTest::newRow("upper case") << QByteArray("MAX-AGE=60, no-cache") << 60;
+    QTest::newRow("missing") << QByteArray("no-cache") << 1800;
+    QTest::newRow("invalid") << QByteArray("max-age=abc") << 1800;
+}
+
+void TestUpnp::maxAge()
+{
+    QFETCH(QByteArray, cacheControl);
+    QFETCH(int, maxAge);
+
+    SsdpMessage message = SsdpMessage::parse("NOTIFY * HTTP/1.1\r\nCACHE-CONTROL: " + cacheControl + "\r\n\r\n");
+    QCOMPARE(message.maxAge(), maxAge);
+}
+
+static UpnpDeviceDescriptor createDescriptor(const QUrl &location)
+{
+    UpnpDeviceDescriptor descriptor;
+    descriptor.setLocation(location);
+    descriptor.setFriendlyName("Mock device");
+    return descriptor;
+}
+
+static SsdpMessage createNotification(const QByteArray &subType, const QByteArray &location, int maxAge)
+{
+    return SsdpMessage::parse("NOTIFY * HTTP/1.1\r\n"
+                              "CACHE-CONTROL: max-age=" + QByteArray::number(maxAge) + "\r\n"
+                              "LOCATION: " + location + "\r\n"
+                              "NT: upnp:rootdevice\r\n"
+                              "NTS: " + subType + "\r\n"
+                              "USN: uuid:mock-1::upnp:rootdevice\r\n\r\n");
+}
+
+void TestUpnp::cacheExpiresAfterMaxAge()
+{
+    QUrl location("http://10.0.0.2:49153/setup.xml");
+
+    UpnpDescriptorCache cache;
+    cache.updateLocation("uuid:mock-1::upnp:rootdevice", location);
+    cache.insert(createDescriptor(location), 100, 0);
+
+    QVERIFY(cache.contains(location, 99999));
+    QCOMPARE(cache.descriptor(location).friendlyName(), QString("Mock device"));
+    QVERIFY(!cache.contains(location, 100000));
+
+    cache.purge(99999);
+    QCOMPARE(cache.count(), 1);
+    cache.purge(100000);
+    QCOMPARE(cache.count(), 0);
+
+    // the USN is forgotten as well, so a late alive message does not bring the description back
+    cache.insert(createDescriptor(location), 10, 100000);
+    cache.processNotification(createNotification("ssdp:alive", location.toEncoded(), 1800), 100000);
+    QVERIFY(!cache.contains(location, 110000));
+}
+
+void TestUpnp::cacheExtendedByAlive()
+{
+    QUrl location("http://10.0.0.2:49153/setup.xml");
+
+    UpnpDescriptorCache cache;
+    cache.updateLocation("uuid:mock-1::upnp:rootdevice", location);
+    cache.insert(createDescriptor(location), 10, 0);
+
+    cache.processNotification(createNotification("ssdp:alive", location.toEncoded(), 100), 5000);
+    QVERIFY(cache.contains(location, 104999));
+    QVERIFY(!cache.contains(location, 105000));
+
+    // an alive message for another location does not extend the old description
+    cache.processNotification(createNotification("ssdp:alive", "http://10.0.0.3:49153/setup.xml", 1800), 6000);
+    QVERIFY(!cache.contains(location, 105000));
+}
+
+void TestUpnp::cacheDeduplicatesUsn()
+{
+    QUrl location("http://10.0.0.2:49153/setup.xml");
+    QUrl newLocation("http://10.0.0.2:49154/setup.xml");
+
+    UpnpDescriptorCache cache;
+
+    // each service of a device announces the same location, the description is stored once
+    cache.updateLocation("uuid:mock-1::upnp:rootdevice", location);
+    cache.updateLocation("uuid:mock-1::urn:Belkin:service:basicevent:1", location);
+    cache.insert(createDescriptor(location), 100, 0);
+    cache.updateLocation("uuid:mock-1::upnp:rootdevice", location);
+    QCOMPARE(cache.count(), 1);
+    QVERIFY(cache.contains(location, 0));
+
+    // a device which moved has to be fetched again
+    cache.updateLocation("uuid:mock-1::upnp:rootdevice", newLocation);
+    QCOMPARE(cache.count(), 0);
+    QVERIFY(!cache.contains(location, 0));
+    QVERIFY(!cache.contains(newLocation, 0));
+}
+
+void TestUpnp::cacheRemovesByeBye()
+{
+    QUrl location("http://10.0.0.2:49153/setup.xml");
+    QUrl otherLocation("http://10.0.0.3:49153/setup.xml");
+
+    UpnpDescriptorCache cache;
+    cache.updateLocation("uuid:mock-1::upnp:rootdevice", location);
+    cache.updateLocation("uuid:mock-2::upnp:rootdevice", otherLocation);
+    cache.insert(createDescriptor(location), 100, 0);
+    cache.insert(createDescriptor(otherLocation), 100, 0);
+    QCOMPARE(cache.count(), 2);
+
+    cache.processNotification(createNotification("ssdp:byebye", QByteArray(), 0), 1000);
+    QCOMPARE(cache.count(), 1);
+    QVERIFY(!cache.contains(location, 1000));
+    QVERIFY(cache.contains(otherLocation, 1000));
+
+    // a byebye of an unknown device changes nothing
+    cache.processNotification(createNotification("ssdp:byebye", QByteArray(), 0), 1000);
+    QCOMPARE(cache.count(), 1);
+}
+
+void TestUpnp::routeNotifications_data()
+{
+    QTest::addColumn<QByteArray>("notificationType");
+    QTest::addColumn<QByteArray>("usn");
+    QTest::addColumn<bool>("routed");
+
+    QTest::newRow("exact NT") << QByteArray("urn:guh-io:device:Mock:1") << QByteArray("uuid:other::urn:guh-io:device:Mock:1") << true;
+    QTest::newRow("exact NT other case") << QByteArray("URN:GUH-IO:DEVICE:MOCK:1") << QByteArray("uuid:other::URN:GUH-IO:DEVICE:MOCK:1") << true;
+    QTest::newRow("wildcard USN") << QByteArray("upnp:rootdevice") << QByteArray("uuid:mock-1234::upnp:rootdevice") << true;
+    QTest::newRow("wildcard USN other case") << QByteArray("upnp:rootdevice") << QByteArray("UUID:MOCK-1234::upnp:rootdevice") << true;
+    QTest::newRow("not subscribed") << QByteArray("urn:schemas-upnp-org:device:MediaRenderer:1") << QByteArray("uuid:other::upnp:rootdevice") << false;
+}
+
+void TestUpnp::routeNotifications()
+{
+    QFETCH(QByteArray, notificationType);
+    QFETCH(QByteArray, usn);
+    QFETCH(bool, routed);
+
+    DevicePlugin *mockPlugin = 0;
+    foreach (DevicePlugin *plugin, GuhCore::instance()->deviceManager()->plugins()) {
+        if (plugin->pluginId() == mockPluginId)
+            mockPlugin = plugin;
+    }
+    QVERIFY(mockPlugin);
+
+    QSignalSpy spy(mockPlugin, SIGNAL(upnpNotifyHandled(QByteArray)));
+
+    SsdpMessage notification = SsdpMessage::parse("NOTIFY * HTTP/1.1\r\n"
+                                                  "HOST: 239.255.255.250:1900\r\n"
+                                                  "CACHE-CONTROL: max-age=1800\r\n"
+                                                  "LOCATION: http://10.0.0.2:49153/setup.xml\r\n"
+                                                  "NT: " + notificationType + "\r\n"
+                                                  "NTS: ssdp:alive\r\n"
+                                                  "USN: " + usn + "\r\n\r\n");
+    QVERIFY(notification.isValid());
+    QMetaObject::invokeMethod(GuhCore::instance()->deviceManager(), "upnpNotifyReceived", Q_ARG(SsdpMessage, notification));
+
+    // plugin calls might be dispatched to a worker thread
+    if (routed && spy.isEmpty())
+        spy.wait();
+
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), routed ? 1 : 0);
+    if (routed)
+        QCOMPARE(spy.first().first().toByteArray(), usn);
+}
+
+#include "testupnp.moc"
+QTEST_MAIN(TestUpnp)
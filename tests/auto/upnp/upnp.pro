@@ -0,0 +1,6 @@
+TARGET = testupnp
+
+include(../../../guh.pri)
+include(../autotests.pri)
+
+SOURCES += testupnp.cpp
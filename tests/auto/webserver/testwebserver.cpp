@@ -35,6 +35,7 @@
 #include <QMetaType>
 #include <QByteArray>
 #include <QXmlReader>
+#include <QJsonDocument>
 
 using namespace guhserver;
 
@@ -45,6 +46,8 @@ class TestWebserver: public GuhTestBase
 private slots:
     void coverageCalls();
 
+    void replySerialization();
+
     void httpVersion();
 
     void multiPackageMessage();
@@ -65,6 +68,11 @@ private slots:
 
     void getIcons_data();
     void getIcons();
+
+    void eventStream();
+
+private:
+    QByteArray readEventStream(QTcpSocket *socket, const QByteArray &expected);
 };
 
 void TestWebserver::coverageCalls()
@@ -76,6 +84,26 @@ void TestWebserver::coverageCalls()
     reply->clear();
 }
 
+void TestWebserver::replySerialization()
+{
+    HttpReply reply(HttpReply::NotFound, HttpReply::TypeSync);
+    reply.setHeader(HttpReply::ContentTypeHeader, "application/json; charset=\"utf-8\";");
+    QByteArray payload("{\"error\":\"not found\"}");
+    reply.setPayload(payload);
+
+    QByteArray header = reply.rawHeader();
+    QVERIFY(header.startsWith("HTTP/1.1 404 NotFound\r\n"));
+    QVERIFY(header.endsWith("\r\n\r\n"));
+    QVERIFY(header.contains("\r\nContent-Length: 21\r\n"));
+    QVERIFY(header.contains("\r\nContent-Type: application/json; charset=\"utf-8\";\r\n"));
+    QVERIFY(header.contains("\r\nDate: "));
+    QCOMPARE(header.count("Content-Type"), 1);
+
+    // the payload is shared with the reply, not copied into the header
+    QCOMPARE(reply.payload().constData(), payload.constData());
+    QCOMPARE(reply.data().mid(header.length()), reply.payload());
+}
+
 void TestWebserver::httpVersion()
 {
     QTcpSocket *socket = new QTcpSocket(this);
@@ -420,5 +448,128 @@ void TestWebserver::getIcons()
     reply->deleteLater();
 }
 
+QByteArray TestWebserver::readEventStream(QTcpSocket *socket, const QByteArray &expected)
+{
+    QSignalSpy readSpy(socket, SIGNAL(readyRead()));
+    QByteArray data = socket->readAll();
+    while (!data.contains(expected)) {
+        if (!readSpy.wait())
+            break;
+        data.append(socket->readAll());
+    }
+    return data;
+}
+
+void TestWebserver::eventStream()
+{
+    QTcpSocket *socket = new QTcpSocket(this);
+    socket->connectToHost(QHostAddress("127.0.0.1"), 3333);
+    QVERIFY2(socket->waitForConnected(1000), "could not connect to webserver.");
+
+    QByteArray requestData;
+    requestData.append("GET /api/v1/events?notifications=Devices.StateChanged&deviceId=" + m_mockDeviceId.toString().toUtf8() + " HTTP/1.1\r\n");
+    requestData.append("User-Agent: guh webserver test\r\n\r\n");
+    socket->write(requestData);
+
+    // the header has no content length, the stream stays open
+    QByteArray header = readEventStream(socket, "retry: ");
+    QVERIFY2(header.startsWith("HTTP/1.1 200"), header.constData());
+    QVERIFY(header.contains("Content-Type: text/event-stream"));
+    QVERIFY(!header.contains("Content-Length"));
+    QVERIFY(!header.contains("Keep-Alive: timeout"));
+
+    // change a state of the mock device
+    int newValue = 1000 + (qrand() % 1000);
+    QNetworkAccessManager nam;
+    QSignalSpy spy(&nam, SIGNAL(finished(QNetworkReply*)));
+    QNetworkRequest request(QUrl(QString("http://localhost:%1/setstate?%2=%3").arg(m_mockDevice1Port).arg(mockIntStateId.toString()).arg(newValue)));
+    QNetworkReply *reply = nam.get(request);
+    spy.wait();
+    reply->deleteLater();
+
+    QByteArray data = readEventStream(socket, "\n\n");
+    QVERIFY2(data.contains("event: Devices.StateChanged\n"), data.constData());
+    QVERIFY(!data.contains("event: Devices.DeviceChanged"));
+
+    QByteArray idLine = data.mid(data.indexOf("id: "));
+    idLine = idLine.left(idLine.indexOf('\n'));
+    bool ok = false;
+    qint64 eventId = idLine.mid(4).toLongLong(&ok);
+    QVERIFY2(ok, idLine.constData());
+
+    QByteArray json = data.mid(data.indexOf("data: ") + 6);
+    json = json.left(json.indexOf('\n'));
+    QVariantMap notification = QJsonDocument::fromJson(json).toVariant().toMap();
+    QCOMPARE(notification.value("notification").toString(), QString("Devices.StateChanged"));
+    QCOMPARE(notification.value("params").toMap().value("deviceId").toUuid(), QUuid(m_mockDeviceId));
+    QCOMPARE(notification.value("params").toMap().value("value").toInt(), newValue);
+
+    // a reconnecting client gets the missed events from the replay buffer
+    QTcpSocket *resumeSocket = new QTcpSocket(this);
+    resumeSocket->connectToHost(QHostAddress("127.0.0.1"), 3333);
+    QVERIFY2(resumeSocket->waitForConnected(1000), "could not connect to webserver.");
+
+    requestData.clear();
+    requestData.append("GET /api/v1/events?namespaces=Devices HTTP/1.1\r\n");
+    requestData.append("User-Agent: guh webserver test\r\n");
+    requestData.append("Last-Event-ID: " + QByteArray::number(eventId - 1) + "\r\n\r\n");
+    resumeSocket->write(requestData);
+
+    QByteArray replayData = readEventStream(resumeSocket, json);
+    QVERIFY2(replayData.contains("id: " + QByteArray::number(eventId) + "\n"), replayData.constData());
+    QVERIFY(!replayData.contains("ReplayIncomplete"));
+
+    // an id of another server instance is incomplete, even if it is lower than the current id
+    QTcpSocket *otherInstanceSocket = new QTcpSocket(this);
+    otherInstanceSocket->connectToHost(QHostAddress("127.0.0.1"), 3333);
+    QVERIFY2(otherInstanceSocket->waitForConnected(1000), "could not connect to webserver.");
+
+    qint64 otherInstanceEventId = (eventId & 0xffffffff) - 1;
+    requestData.clear();
+    requestData.append("GET /api/v1/events?namespaces=Devices HTTP/1.1\r\n");
+    requestData.append("User-Agent: guh webserver test\r\n");
+    requestData.append("Last-Event-ID: " + QByteArray::number(otherInstanceEventId) + "\r\n\r\n");
+    otherInstanceSocket->write(requestData);
+
+    replayData = readEventStream(otherInstanceSocket, json);
+    QVERIFY2(replayData.contains("event: ReplayIncomplete\n"), replayData.constData());
+    QVERIFY2(replayData.contains("id: " + QByteArray::number(eventId) + "\n"), replayData.constData());
+
+    // invalid filters get rejected
+    QTcpSocket *invalidSocket = new QTcpSocket(this);
+    invalidSocket->connectToHost(QHostAddress("127.0.0.1"), 3333);
+    QVERIFY2(invalidSocket->waitForConnected(1000), "could not connect to webserver.");
+    invalidSocket->write("GET /api/v1/events?deviceId=foo HTTP/1.1\r\nUser-Agent: guh webserver test\r\n\r\n");
+    QVERIFY(readEventStream(invalidSocket, "\r\n").startsWith("HTTP/1.1 400"));
+
+    socket->close();
+    socket->deleteLater();
+    resumeSocket->close();
+    resumeSocket->deleteLater();
+    invalidSocket->close();
+    invalidSocket->deleteLater();
+    otherInstanceSocket->close();
+    otherInstanceSocket->deleteLater();
+
+    // after a restart the ids of the previous instance are incomplete
+    restartServer();
+
+    QTcpSocket *restartSocket = new QTcpSocket(this);
+    restartSocket->connectToHost(QHostAddress("127.0.0.1"), 3333);
+    QVERIFY2(restartSocket->waitForConnected(1000), "could not connect to webserver.");
+
+    requestData.clear();
+    requestData.append("GET /api/v1/events HTTP/1.1\r\n");
+    requestData.append("User-Agent: guh webserver test\r\n");
+    requestData.append("Last-Event-ID: " + QByteArray::number(eventId) + "\r\n\r\n");
+    restartSocket->write(requestData);
+
+    replayData = readEventStream(restartSocket, "ReplayIncomplete");
+    QVERIFY2(replayData.contains("event: ReplayIncomplete\n"), replayData.constData());
+
+    restartSocket->close();
+    restartSocket->deleteLater();
+}
+
 #include "testwebserver.moc"
 QTEST_MAIN(TestWebserver)
@@ -0,0 +1,23 @@
+QT += testlib network sql
+
+DEFINES += TESTING_ENABLED
+
+INCLUDEPATH += $$top_srcdir/server/ \
+               $$top_srcdir/server/jsonrpc \
+               $$top_srcdir/libguh \
+               $$top_srcdir/tests/auto/ \
+               $$top_srcdir/tests/benchmarks/
+
+LIBS += -L$$top_builddir/libguh/ -lguh -L$$top_builddir/plugins/deviceplugins/mock/ \
+        -L$$top_builddir/tests/libguh-core/ -lguh-core
+
+SOURCES += $$top_srcdir/tests/auto/guhtestbase.cpp \
+    $$top_srcdir/tests/auto/mocktcpserver.cpp \
+    ../guhbenchmarkbase.cpp \
+
+HEADERS += $$top_srcdir/tests/auto/guhtestbase.h \
+    $$top_srcdir/tests/auto/mocktcpserver.h \
+    ../guhbenchmarkbase.h \
+
+target.path = /usr/tests/benchmarks
+INSTALLS += target
@@ -0,0 +1,239 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "guhbenchmarkbase.h"
+#include "guhcore.h"
+#include "devicemanager.h"
+#include "plugin/device.h"
+#include "plugin/deviceplugin.h"
+
+#include <QFile>
+#include <QThread>
+#include <QLoggingCategory>
+#include <QCoreApplication>
+
+#include <algorithm>
+
+using namespace guhserver;
+
+static void benchmarkCategoryFilter(QLoggingCategory *category)
+{
+    // Debug output of the core would dominate the measurements, keep only the reports
+    bool debugEnabled = QString(category->categoryName()) == "default";
+    category->setEnabled(QtDebugMsg, debugEnabled);
+    category->setEnabled(QtWarningMsg, true);
+}
+
+GuhBenchmarkBase::GuhBenchmarkBase(QObject *parent) :
+    GuhTestBase(parent)
+{
+    m_deviceCount = environmentValue("GUH_BENCHMARK_DEVICES", 20);
+    m_ruleCount = environmentValue("GUH_BENCHMARK_RULES", 100);
+    m_eventCount = environmentValue("GUH_BENCHMARK_EVENTS", 2000);
+    m_eventRate = environmentValue("GUH_BENCHMARK_RATE", 0);
+    m_clientCount = environmentValue("GUH_BENCHMARK_CLIENTS", 10);
+}
+
+void GuhBenchmarkBase::initTestCase()
+{
+    GuhTestBase::initTestCase();
+    QLoggingCategory::installFilter(benchmarkCategoryFilter);
+
+    qDebug() << "Load profile:" << m_deviceCount << "devices," << m_ruleCount << "rules," << m_eventCount << "events,"
+             << (m_eventRate > 0 ? QString("%1 events/s,").arg(m_eventRate) : QString("unlimited rate,")).toLatin1().data()
+             << m_clientCount << "clients";
+
+    m_deviceIds = addMockDevices(m_deviceCount);
+    QCOMPARE(m_deviceIds.count(), m_deviceCount);
+
+    m_ruleIds = addRules(m_deviceIds, m_ruleCount);
+    QCOMPARE(m_ruleIds.count(), m_ruleCount);
+}
+
+QList<DeviceId> GuhBenchmarkBase::addMockDevices(const int &count)
+{
+    QList<DeviceId> deviceIds;
+    for (int i = 0; i < count; i++) {
+        QVariantList deviceParams;
+        QVariantMap httpportParam;
+        httpportParam.insert("paramTypeId", httpportParamTypeId);
+        httpportParam.insert("value", m_mockDevice2Port + 1000 + i);
+        deviceParams.append(httpportParam);
+
+        QVariantMap params;
+        params.insert("deviceClassId", mockDeviceClassId);
+        params.insert("name", QString("Benchmark mock device %1").arg(i));
+        params.insert("deviceParams", deviceParams);
+
+        QVariant response = injectAndWait("Devices.AddConfiguredDevice", params);
+        DeviceId deviceId(response.toMap().value("params").toMap().value("deviceId").toString());
+        if (deviceId.isNull()) {
+            qWarning() << "Could not add benchmark mock device" << i << response;
+            continue;
+        }
+        deviceIds.append(deviceId);
+    }
+    return deviceIds;
+}
+
+QList<RuleId> GuhBenchmarkBase::addRules(const QList<DeviceId> &deviceIds, const int &count)
+{
+    QList<RuleId> ruleIds;
+    if (deviceIds.isEmpty())
+        return ruleIds;
+
+    for (int i = 0; i < count; i++) {
+        DeviceId deviceId = deviceIds.at(i % deviceIds.count());
+
+        // spread the thresholds, so the rules toggle at different values
+        QVariantMap stateDescriptor;
+        stateDescriptor.insert("stateTypeId", mockIntStateId);
+        stateDescriptor.insert("deviceId", deviceId);
+        stateDescriptor.insert("operator", JsonTypes::valueOperatorToString(Types::ValueOperatorGreaterOrEqual));
+        stateDescriptor.insert("value", (i * 13) % 100);
+
+        QVariantMap stateEvaluator;
+        stateEvaluator.insert("stateDescriptor", stateDescriptor);
+
+        QVariantMap action;
+        action.insert("actionTypeId", mockActionIdNoParams);
+        action.insert("deviceId", deviceId);
+
+        QVariantMap params;
+        params.insert("name", QString("Benchmark rule %1").arg(i));
+        params.insert("stateEvaluator", stateEvaluator);
+        params.insert("actions", QVariantList() << action);
+
+        QVariant response = injectAndWait("Rules.AddRule", params);
+        RuleId ruleId(response.toMap().value("params").toMap().value("ruleId").toString());
+        if (ruleId.isNull()) {
+            qWarning() << "Could not add benchmark rule" << i << response;
+            continue;
+        }
+        ruleIds.append(ruleId);
+    }
+    return ruleIds;
+}
+
+QList<QUuid> GuhBenchmarkBase::connectClients(const int &count)
+{
+    QList<QUuid> clientIds;
+    for (int i = 0; i < count; i++) {
+        QUuid clientId = QUuid::createUuid();
+        m_mockTcpServer->connectClient(clientId);
+        clientIds.append(clientId);
+    }
+    return clientIds;
+}
+
+void GuhBenchmarkBase::disconnectClients(const QList<QUuid> &clientIds)
+{
+    foreach (const QUuid &clientId, clientIds) {
+        m_mockTcpServer->disconnectClient(clientId);
+    }
+}
+
+void GuhBenchmarkBase::setState(const DeviceId &deviceId, const StateTypeId &stateTypeId, const QVariant &value)
+{
+    Device *device = GuhCore::instance()->deviceManager()->findConfiguredDevice(deviceId);
+    if (!device) {
+        qWarning() << "Could not find benchmark device" << deviceId.toString();
+        return;
+    }
+    device->setStateValue(stateTypeId, value);
+}
+
+void GuhBenchmarkBase::triggerEvent(const DeviceId &deviceId, const EventTypeId &eventTypeId)
+{
+    DevicePlugin *plugin = GuhCore::instance()->deviceManager()->plugin(mockPluginId);
+    if (!plugin) {
+        qWarning() << "Could not find the mock plugin";
+        return;
+    }
+    emit plugin->emitEvent(Event(eventTypeId, deviceId));
+}
+
+void GuhBenchmarkBase::waitForSlot(const QElapsedTimer &timer, const int &index) const
+{
+    if (m_eventRate <= 0)
+        return;
+
+    qint64 slot = index * Q_INT64_C(1000000000) / m_eventRate;
+    while (timer.nsecsElapsed() < slot) {
+        QCoreApplication::processEvents();
+        qint64 remaining = (slot - timer.nsecsElapsed()) / 1000;
+        if (remaining > 0)
+            QThread::usleep(qMin(remaining, Q_INT64_C(1000)));
+    }
+}
+
+void GuhBenchmarkBase::report(const QString &name, const QList<qint64> &latencies, const qint64 &duration, const qint64 &memoryBefore) const
+{
+    double eventsPerSecond = duration > 0 ? latencies.count() * 1000000000.0 / duration : 0;
+    qint64 memory = residentMemory();
+
+    qDebug() << qPrintable(QString("%1: %2 events in %3 ms, %4 events/s")
+                           .arg(name)
+                           .arg(latencies.count())
+                           .arg(duration / 1000000)
+                           .arg(eventsPerSecond, 0, 'f', 0));
+    qDebug() << qPrintable(QString("%1: latency p50 %2 us, p90 %3 us, p99 %4 us, max %5 us")
+                           .arg(name)
+                           .arg(percentile(latencies, 0.5) / 1000)
+                           .arg(percentile(latencies, 0.9) / 1000)
+                           .arg(percentile(latencies, 0.99) / 1000)
+                           .arg(percentile(latencies, 1) / 1000));
+    qDebug() << qPrintable(QString("%1: resident memory %2 kB (%3%4 kB)")
+                           .arg(name)
+                           .arg(memory)
+                           .arg(memory >= memoryBefore ? "+" : "")
+                           .arg(memory - memoryBefore));
+}
+
+qint64 GuhBenchmarkBase::percentile(QList<qint64> values, const double &percentile)
+{
+    if (values.isEmpty())
+        return 0;
+
+    std::sort(values.begin(), values.end());
+    int index = qMin(values.count() - 1, static_cast<int>(percentile * values.count()));
+    return values.at(index);
+}
+
+qint64 GuhBenchmarkBase::residentMemory()
+{
+    QFile statusFile("/proc/self/status");
+    if (!statusFile.open(QIODevice::ReadOnly))
+        return 0;
+
+    foreach (const QByteArray &line, statusFile.readAll().split('\n')) {
+        // VmRSS:     12345 kB
+        if (line.startsWith("VmRSS:"))
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+    }
+    return 0;
+}
+
+int GuhBenchmarkBase::environmentValue(const char *name, const int &defaultValue)
+{
+    bool ok = false;
+    int value = qgetenv(name).toInt(&ok);
+    return ok ? value : defaultValue;
+}
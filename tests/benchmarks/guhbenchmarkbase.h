@@ -0,0 +1,76 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef GUHBENCHMARKBASE_H
+#define GUHBENCHMARKBASE_H
+
+#include "guhtestbase.h"
+
+#include <QElapsedTimer>
+
+// Sets up a synthetic installation with the mock plugin and drives load into it.
+// The load profile can be changed with the environment variables:
+//   GUH_BENCHMARK_DEVICES  number of mock devices
+//   GUH_BENCHMARK_RULES    number of rules, spread over the mock devices
+//   GUH_BENCHMARK_EVENTS   number of state changes / events per run
+//   GUH_BENCHMARK_RATE     events per second, 0 drives as fast as possible
+//   GUH_BENCHMARK_CLIENTS  number of concurrent JSON-RPC clients
+class GuhBenchmarkBase : public GuhTestBase
+{
+    Q_OBJECT
+public:
+    explicit GuhBenchmarkBase(QObject *parent = 0);
+
+protected slots:
+    void initTestCase();
+
+protected:
+    QList<DeviceId> addMockDevices(const int &count);
+    QList<RuleId> addRules(const QList<DeviceId> &deviceIds, const int &count);
+
+    QList<QUuid> connectClients(const int &count);
+    void disconnectClients(const QList<QUuid> &clientIds);
+
+    // Drive the load directly into the plugin, without the HttpDaemon of the mock device
+    void setState(const DeviceId &deviceId, const StateTypeId &stateTypeId, const QVariant &value);
+    void triggerEvent(const DeviceId &deviceId, const EventTypeId &eventTypeId);
+
+    void waitForSlot(const QElapsedTimer &timer, const int &index) const;
+    void report(const QString &name, const QList<qint64> &latencies, const qint64 &duration, const qint64 &memoryBefore) const;
+
+    static qint64 percentile(QList<qint64> values, const double &percentile);
+    static qint64 residentMemory();
+
+protected:
+    int m_deviceCount;
+    int m_ruleCount;
+    int m_eventCount;
+    int m_eventRate;
+    int m_clientCount;
+
+    QList<DeviceId> m_deviceIds;
+    QList<RuleId> m_ruleIds;
+
+private:
+    static int environmentValue(const char *name, const int &defaultValue);
+
+};
+
+#endif // GUHBENCHMARKBASE_H
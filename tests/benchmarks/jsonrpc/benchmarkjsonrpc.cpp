@@ -0,0 +1,161 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "guhbenchmarkbase.h"
+#include "mocktcpserver.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+
+using namespace guhserver;
+
+class BenchmarkJsonRpc : public GuhBenchmarkBase
+{
+    Q_OBJECT
+
+private:
+    bool waitForReply(QSignalSpy &spy, int id);
+
+private slots:
+    void notificationFanOut_data();
+    void notificationFanOut();
+
+    void concurrentRequests();
+
+};
+
+void BenchmarkJsonRpc::notificationFanOut_data()
+{
+    QTest::addColumn<int>("clients");
+
+    QTest::newRow("no clients") << 0;
+    QTest::newRow("one client") << 1;
+    QTest::newRow("all clients") << m_clientCount;
+}
+
+void BenchmarkJsonRpc::notificationFanOut()
+{
+    QFETCH(int, clients);
+    QVERIFY(!m_deviceIds.isEmpty());
+
+    QList<QUuid> clientIds = connectClients(clients);
+
+    int messages = 0;
+    qint64 bytes = 0;
+    QMetaObject::Connection connection = connect(m_mockTcpServer, &MockTcpServer::outgoingData, [&messages, &bytes](const QUuid &clientId, const QByteArray &data) {
+        Q_UNUSED(clientId)
+        messages++;
+        bytes += data.size();
+    });
+
+    // Every state change gets notified to each client
+    DeviceId deviceId = m_deviceIds.first();
+    int value = 0;
+    int stateChanges = 0;
+    QBENCHMARK {
+        value = (value + 1) % 100;
+        setState(deviceId, mockIntStateId, value);
+        QCoreApplication::processEvents();
+        stateChanges++;
+    }
+
+    disconnect(connection);
+    disconnectClients(clientIds);
+
+    qDebug() << qPrintable(QString("notificationFanOut: %1 state changes sent %2 messages (%3 kB) to %4 clients")
+                           .arg(stateChanges)
+                           .arg(messages)
+                           .arg(bytes / 1024)
+                           .arg(clients));
+}
+
+void BenchmarkJsonRpc::concurrentRequests()
+{
+    QList<QUuid> clientIds = connectClients(m_clientCount);
+    QVERIFY(!clientIds.isEmpty());
+    QVERIFY(!m_deviceIds.isEmpty());
+
+    QStringList methods;
+    methods << "Devices.GetConfiguredDevices" << "Devices.GetStateValues" << "Rules.GetRules";
+
+    QList<qint64> latencies;
+    latencies.reserve(m_eventCount);
+    qint64 memoryBefore = residentMemory();
+
+    int replies = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < m_eventCount; i++) {
+        waitForSlot(timer, i);
+
+        DeviceId deviceId = m_deviceIds.at(i % m_deviceIds.count());
+
+        // the clients interleave their requests with state changes notified to all of them
+        if (i % 4 == 0)
+            setState(deviceId, mockIntStateId, (i / 4) % 100);
+
+        QString method = methods.at(i % methods.count());
+        QVariantMap params;
+        if (method.startsWith("Devices."))
+            params.insert("deviceId", deviceId);
+
+        QVariantMap call;
+        call.insert("id", i);
+        call.insert("method", method);
+        call.insert("params", params);
+        QByteArray data = QJsonDocument::fromVariant(call).toJson(QJsonDocument::Compact);
+
+        QSignalSpy spy(m_mockTcpServer, SIGNAL(outgoingData(QUuid,QByteArray)));
+        qint64 start = timer.nsecsElapsed();
+        m_mockTcpServer->injectData(clientIds.at(i % clientIds.count()), data);
+
+        // the request gets processed on a worker thread, measure until its reply went out
+        if (!waitForReply(spy, i))
+            QFAIL(qPrintable(QString("No reply for request %1 (%2)").arg(i).arg(method)));
+
+        latencies.append(timer.nsecsElapsed() - start);
+        replies++;
+    }
+    qint64 duration = timer.nsecsElapsed();
+
+    disconnectClients(clientIds);
+
+    report("concurrentRequests", latencies, duration, memoryBefore);
+    QCOMPARE(replies, m_eventCount);
+}
+
+bool BenchmarkJsonRpc::waitForReply(QSignalSpy &spy, int id)
+{
+    // notifications for the other clients may arrive before the reply
+    int i = 0;
+    while (i < spy.count() || spy.wait()) {
+        for (; i < spy.count(); i++) {
+            QVariantMap response = QJsonDocument::fromJson(spy.at(i).last().toByteArray()).toVariant().toMap();
+            if (!response.contains("notification") && response.value("id").toInt() == id)
+                return true;
+        }
+    }
+    return false;
+}
+
+#include "benchmarkjsonrpc.moc"
+QTEST_MAIN(BenchmarkJsonRpc)
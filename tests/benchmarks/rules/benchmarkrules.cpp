@@ -0,0 +1,108 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                         *
+ *  Copyright (C) 2016 Simon Stürz <simon.stuerz@guh.guru>                 *
+ *                                                                         *
+ *  This file is part of guh.                                              *
+ *                                                                         *
+ *  Guh is free software: you can redistribute it and/or modify            *
+ *  it under the terms of the GNU General Public License as published by   *
+ *  the Free Software Foundation, version 2 of the License.                *
+ *                                                                         *
+ *  Guh is distributed in the hope that it will be useful,                 *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *  GNU General Public License for more details.                           *
+ *                                                                         *
+ *  You should have received a copy of the GNU General Public License      *
+ *  along with guh. If not, see <http://www.gnu.org/licenses/>.            *
+ *                                                                         *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "guhbenchmarkbase.h"
+#include "guhcore.h"
+#include "ruleengine.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+using namespace guhserver;
+
+class BenchmarkRules : public GuhBenchmarkBase
+{
+    Q_OBJECT
+
+private slots:
+    void evaluateEvent();
+
+    void stateChangeThroughput();
+    void eventThroughput();
+
+};
+
+void BenchmarkRules::evaluateEvent()
+{
+    QVERIFY(!m_deviceIds.isEmpty());
+
+    // The cost of matching a single state change against all rules, without logging and notifications
+    RuleEngine *ruleEngine = GuhCore::instance()->ruleEngine();
+    DeviceId deviceId = m_deviceIds.first();
+    int value = 0;
+    QBENCHMARK {
+        value = (value + 1) % 100;
+        Param valueParam(ParamTypeId(mockIntStateId.toString()), value);
+        Event event(EventTypeId(mockIntStateId.toString()), deviceId, ParamList() << valueParam, true);
+        ruleEngine->evaluateEvent(event);
+    }
+}
+
+void BenchmarkRules::stateChangeThroughput()
+{
+    QVERIFY(!m_deviceIds.isEmpty());
+
+    QList<qint64> latencies;
+    latencies.reserve(m_eventCount);
+    qint64 memoryBefore = residentMemory();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < m_eventCount; i++) {
+        waitForSlot(timer, i);
+
+        // round robin over the devices, each update of a device changes its value
+        DeviceId deviceId = m_deviceIds.at(i % m_deviceIds.count());
+        int value = (i / m_deviceIds.count()) % 100;
+
+        qint64 start = timer.nsecsElapsed();
+        setState(deviceId, mockIntStateId, value);
+        QCoreApplication::processEvents();
+        latencies.append(timer.nsecsElapsed() - start);
+    }
+
+    report("stateChangeThroughput", latencies, timer.nsecsElapsed(), memoryBefore);
+}
+
+void BenchmarkRules::eventThroughput()
+{
+    QVERIFY(!m_deviceIds.isEmpty());
+
+    QList<qint64> latencies;
+    latencies.reserve(m_eventCount);
+    qint64 memoryBefore = residentMemory();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < m_eventCount; i++) {
+        waitForSlot(timer, i);
+
+        qint64 start = timer.nsecsElapsed();
+        triggerEvent(m_deviceIds.at(i % m_deviceIds.count()), mockEvent1Id);
+        QCoreApplication::processEvents();
+        latencies.append(timer.nsecsElapsed() - start);
+    }
+
+    report("eventThroughput", latencies, timer.nsecsElapsed(), memoryBefore);
+}
+
+#include "benchmarkrules.moc"
+QTEST_MAIN(BenchmarkRules)
@@ -0,0 +1,5 @@
+include(../../../guh.pri)
+include(../benchmarks.pri)
+
+TARGET = benchmarkrules
+SOURCES += benchmarkrules.cpp
@@ -1,4 +1,5 @@
 TEMPLATE = subdirs
 
-SUBDIRS = auto libguh-core
+SUBDIRS = auto benchmarks libguh-core
 auto.depends = libguh-core
+benchmarks.depends = libguh-core